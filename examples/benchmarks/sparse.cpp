@@ -40,6 +40,7 @@
 #include "viennacl/vector.hpp"
 #include "viennacl/coordinate_matrix.hpp"
 #include "viennacl/compressed_matrix.hpp"
+#include "viennacl/delta_compressed_matrix.hpp"
 #include "viennacl/ell_matrix.hpp"
 #include "viennacl/hyb_matrix.hpp"
 #include "viennacl/sliced_ell_matrix.hpp"
@@ -193,6 +194,24 @@ int run_benchmark()
   std::cout << "GPU align8 "; printOps(2.0 * static_cast<double>(ublas_matrix.nnz()), static_cast<double>(exec_time) / static_cast<double>(BENCHMARK_RUNS));
   std::cout << vcl_vec1[0] << std::endl;
 
+  if (viennacl::traits::active_handle_id(vcl_vec2) == viennacl::MAIN_MEMORY) // delta_compressed_matrix is available in host memory only
+  {
+    std::cout << "------- Matrix-Vector product with delta_compressed_matrix ----------" << std::endl;
+    viennacl::delta_compressed_matrix<ScalarType> vcl_delta_compressed_matrix(vcl_compressed_matrix_1);
+    std::cout << "Index bytes per nonzero: " << vcl_delta_compressed_matrix.index_bytes_per_nnz() << " (saved: " << vcl_delta_compressed_matrix.saved_bytes_per_nnz() << ")" << std::endl;
+
+    vcl_vec1 = viennacl::linalg::prod(vcl_delta_compressed_matrix, vcl_vec2); //startup calculation
+    timer.start();
+    for (int runs=0; runs<BENCHMARK_RUNS; ++runs)
+    {
+      vcl_vec1 = viennacl::linalg::prod(vcl_delta_compressed_matrix, vcl_vec2);
+    }
+    exec_time = timer.get();
+    std::cout << "CPU time delta: " << exec_time << std::endl;
+    std::cout << "CPU delta "; printOps(2.0 * static_cast<double>(ublas_matrix.nnz()), static_cast<double>(exec_time) / static_cast<double>(BENCHMARK_RUNS));
+    std::cout << vcl_vec1[0] << std::endl;
+  }
+
 
   std::cout << "------- Matrix-Vector product with coordinate_matrix ----------" << std::endl;
   vcl_vec1 = viennacl::linalg::prod(vcl_coordinate_matrix_128, vcl_vec2); //startup calculation
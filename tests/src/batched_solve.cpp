@@ -0,0 +1,297 @@
+/* =========================================================================
+   Copyright (c) 2010-2016, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+   Portions of this software are copyright by UChicago Argonne, LLC.
+
+                            -----------------
+                  ViennaCL - The Vienna Computing Library
+                            -----------------
+
+   Project Head:    Karl Rupp                   rupp@iue.tuwien.ac.at
+
+   (A list of authors and contributors can be found in the PDF manual)
+
+   License:         MIT (X11), see file LICENSE in the base directory
+============================================================================= */
+
+
+
+/** \file tests/src/batched_solve.cpp  Tests the batched iterative solvers for many small independent sparse systems.
+*   \test  Tests the batched iterative solvers for many small independent sparse systems.
+**/
+
+//
+// *** System
+//
+#include <iostream>
+#include <vector>
+#include <map>
+#include <cmath>
+
+
+//
+// *** ViennaCL
+//
+#include "viennacl/scalar.hpp"
+#include "viennacl/vector.hpp"
+#include "viennacl/compressed_matrix.hpp"
+#include "viennacl/batched_compressed_matrix.hpp"
+#include "viennacl/linalg/prod.hpp"
+#include "viennacl/linalg/norm_2.hpp"
+#include "viennacl/linalg/batched_solve.hpp"
+
+#include "viennacl/tools/random.hpp"
+
+#include "sparse_test_systems.hpp"
+
+//
+// -------------------------------------------------------------
+//
+
+/* Adds a nonsymmetric convection-diffusion block of size n with first row 'offset' to stl_A */
+template<typename NumericT>
+void add_convection_diffusion_block(std::vector<std::map<unsigned int, NumericT> > & stl_A, std::size_t offset, std::size_t n, NumericT convection)
+{
+  for (std::size_t i=0; i<n; ++i)
+  {
+    unsigned int row = static_cast<unsigned int>(offset + i);
+    stl_A[row][row] = NumericT(2.5);
+    if (i > 0)     stl_A[row][row - 1] = NumericT(-1) - convection;
+    if (i < n - 1) stl_A[row][row + 1] = NumericT(-1) + convection;
+  }
+}
+
+/* Returns the largest relative residual over all systems of the batch, computed from the pattern and the values of each system */
+template<typename NumericT>
+NumericT max_relative_residual(std::vector<std::vector<std::map<unsigned int, NumericT> > > const & systems,
+                               std::vector<NumericT> const & b, std::vector<NumericT> const & x)
+{
+  NumericT max_residual = 0;
+  std::size_t offset = 0;
+  for (std::size_t s=0; s<systems.size(); ++s)
+  {
+    NumericT norm_b = 0, norm_r = 0;
+    for (std::size_t i=0; i<systems[s].size(); ++i)
+    {
+      NumericT Ax = 0;
+      for (typename std::map<unsigned int, NumericT>::const_iterator it = systems[s][i].begin(); it != systems[s][i].end(); ++it)
+        Ax += it->second * x[offset + it->first];
+      norm_r += (b[offset + i] - Ax) * (b[offset + i] - Ax);
+      norm_b += b[offset + i] * b[offset + i];
+    }
+    if (norm_b > 0)
+      max_residual = std::max(max_residual, std::sqrt(norm_r / norm_b));
+    offset += systems[s].size();
+  }
+  return max_residual;
+}
+
+
+template<typename NumericT, typename Epsilon>
+int check_results(viennacl::batched_compressed_matrix<NumericT> const & A,
+                  std::vector<std::vector<std::map<unsigned int, NumericT> > > const & systems,
+                  viennacl::vector<NumericT> const & B, viennacl::vector<NumericT> const & X,
+                  viennacl::linalg::batched_solver_tag const & tag, Epsilon const & epsilon, std::string const & name)
+{
+  std::vector<NumericT> b(B.size()), x(X.size());
+  viennacl::copy(B, b);
+  viennacl::copy(X, x);
+  NumericT residual = max_relative_residual(systems, b, x);
+
+  std::cout << "  " << name << ": max iterations: " << tag.max_iters() << ", max residual: " << residual << std::endl;
+  if (residual > epsilon || tag.num_converged() != A.batch_size() || tag.max_error() > tag.tolerance())
+  {
+    std::cout << "# Error: " << name << " failed, converged: " << tag.num_converged() << " of " << A.batch_size() << std::endl;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
+
+
+//
+// -------------------------------------------------------------
+//
+template<typename NumericT, typename Epsilon>
+int test(Epsilon const& epsilon, double solver_tolerance)
+{
+  viennacl::tools::uniform_random_numbers<NumericT> randomNumber;
+
+  //
+  // Batch of SPD systems with shared pattern:
+  //
+  std::cout << "Testing batch with shared pattern" << std::endl;
+  std::size_t points_per_dim = 12;
+  std::size_t batch_size = 150;
+  std::vector<std::vector<std::map<unsigned int, NumericT> > > systems(batch_size);
+  for (std::size_t s=0; s<batch_size; ++s)
+    laplace_2d(systems[s], points_per_dim, NumericT(s % 7) / NumericT(10));
+
+  viennacl::compressed_matrix<NumericT> pattern;
+  viennacl::copy(systems[0], pattern);
+  viennacl::batched_compressed_matrix<NumericT> A_shared(pattern, batch_size);
+  for (std::size_t s=1; s<batch_size; ++s)
+  {
+    std::vector<NumericT> values;
+    for (std::size_t i=0; i<systems[s].size(); ++i)
+      for (typename std::map<unsigned int, NumericT>::const_iterator it = systems[s][i].begin(); it != systems[s][i].end(); ++it)
+        values.push_back(it->second);
+    A_shared.set_values(s, values);
+  }
+  if (A_shared.batch_size() != batch_size || A_shared.size1() != batch_size * pattern.size1() || A_shared.system_size(7) != pattern.size1() || A_shared.system_start(7) != 7 * pattern.size1())
+  {
+    std::cout << "# Error: Wrong dimensions of batch with shared pattern" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::vector<NumericT> host_b(A_shared.size1());
+  for (std::size_t i=0; i<host_b.size(); ++i)
+    host_b[i] = randomNumber();
+  for (std::size_t i=0; i<pattern.size1(); ++i) // zero right hand side for system 3
+    host_b[3 * pattern.size1() + i] = 0;
+  viennacl::vector<NumericT> B(host_b.size());
+  viennacl::copy(host_b, B);
+
+  viennacl::linalg::batched_solver_type solvers[3] = { viennacl::linalg::BATCHED_CG, viennacl::linalg::BATCHED_BICGSTAB, viennacl::linalg::BATCHED_GMRES };
+  char const * solver_names[3] = { "CG", "BiCGStab", "GMRES" };
+  viennacl::linalg::batched_precond_type preconds[3] = { viennacl::linalg::BATCHED_NO_PRECOND, viennacl::linalg::BATCHED_JACOBI, viennacl::linalg::BATCHED_ILU0 };
+  char const * precond_names[3] = { "no preconditioner", "Jacobi", "ILU0" };
+
+  for (std::size_t i=0; i<3; ++i)
+  {
+    unsigned int unpreconditioned_iterations = 0;
+    for (std::size_t j=0; j<3; ++j)
+    {
+      viennacl::linalg::batched_solver_tag tag(solvers[i], preconds[j], solver_tolerance, 1000, 30);
+      viennacl::vector<NumericT> X = viennacl::linalg::solve(A_shared, B, tag);
+      if (check_results(A_shared, systems, B, X, tag, epsilon, std::string(solver_names[i]) + " with " + precond_names[j]) != EXIT_SUCCESS)
+        return EXIT_FAILURE;
+
+      if (tag.iters(3) != 0 || tag.error(3) > 0)
+      {
+        std::cout << "# Error: Iterations for zero right hand side" << std::endl;
+        return EXIT_FAILURE;
+      }
+
+      if (j == 0)
+        unpreconditioned_iterations = tag.max_iters();
+      else if (j == 2 && tag.max_iters() >= unpreconditioned_iterations)
+      {
+        std::cout << "# Error: ILU0 does not reduce the number of iterations" << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+  }
+
+  std::cout << "Testing iteration limit" << std::endl;
+  viennacl::linalg::batched_solver_tag limited_tag(viennacl::linalg::BATCHED_CG, viennacl::linalg::BATCHED_JACOBI, solver_tolerance, 2);
+  viennacl::vector<NumericT> X_limited = viennacl::linalg::solve(A_shared, B, limited_tag);
+  if (limited_tag.num_converged() != 1 || limited_tag.converged(0) || !limited_tag.converged(3) || limited_tag.iters(0) != 2 || limited_tag.max_iters() != 2)
+  {
+    std::cout << "# Error: Wrong convergence information for iteration limit" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  //
+  // Block-diagonal batch of nonsymmetric systems of varying size:
+  //
+  std::cout << "Testing block-diagonal batch" << std::endl;
+  batch_size = 60;
+  std::vector<std::size_t> block_offsets(1, 0);
+  for (std::size_t s=0; s<batch_size; ++s)
+    block_offsets.push_back(block_offsets.back() + 20 + (s * 37) % 300);
+
+  std::vector<std::map<unsigned int, NumericT> > stl_A(block_offsets.back());
+  for (std::size_t s=0; s<batch_size; ++s)
+    add_convection_diffusion_block(stl_A, block_offsets[s], block_offsets[s+1] - block_offsets[s], NumericT(s % 5) / NumericT(5));
+
+  viennacl::compressed_matrix<NumericT> A_full;
+  viennacl::copy(stl_A, A_full);
+  viennacl::batched_compressed_matrix<NumericT> A_block(A_full, block_offsets);
+  if (A_block.batch_size() != batch_size || A_block.size1() != A_full.size1() || A_block.system_size(5) != block_offsets[6] - block_offsets[5] || A_block.system_start(5) != block_offsets[5])
+  {
+    std::cout << "# Error: Wrong dimensions of block-diagonal batch" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // reference residuals are computed with the full matrix:
+  std::vector<std::vector<std::map<unsigned int, NumericT> > > full_system(1, stl_A);
+  host_b.resize(A_block.size1());
+  for (std::size_t i=0; i<host_b.size(); ++i)
+    host_b[i] = randomNumber();
+  B.resize(host_b.size());
+  viennacl::copy(host_b, B);
+
+  for (std::size_t i=1; i<3; ++i)
+    for (std::size_t j=0; j<3; ++j)
+    {
+      viennacl::linalg::batched_solver_tag tag(solvers[i], preconds[j], solver_tolerance, 2000, 30);
+      viennacl::vector<NumericT> X = viennacl::linalg::solve(A_block, B, tag);
+      if (check_results(A_block, full_system, B, X, tag, epsilon, std::string(solver_names[i]) + " with " + precond_names[j]) != EXIT_SUCCESS)
+        return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
+
+
+//
+// -------------------------------------------------------------
+//
+int main()
+{
+  std::cout << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << "## Test :: Batched Solvers" << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << std::endl;
+
+  int retval = EXIT_SUCCESS;
+
+  std::cout << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << std::endl;
+  {
+    typedef float NumericT;
+    NumericT epsilon = static_cast<NumericT>(1E-3);
+    std::cout << "# Testing setup:" << std::endl;
+    std::cout << "  eps:     " << epsilon << std::endl;
+    std::cout << "  numeric: float" << std::endl;
+    retval = test<NumericT>(epsilon, 1e-4);
+    if ( retval == EXIT_SUCCESS )
+        std::cout << "# Test passed" << std::endl;
+    else
+        return retval;
+  }
+  std::cout << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << std::endl;
+#ifdef VIENNACL_WITH_OPENCL
+  if ( viennacl::ocl::current_device().double_support() )
+#endif
+  {
+    {
+      typedef double NumericT;
+      NumericT epsilon = 1.0E-7;
+      std::cout << "# Testing setup:" << std::endl;
+      std::cout << "  eps:     " << epsilon << std::endl;
+      std::cout << "  numeric: double" << std::endl;
+      retval = test<NumericT>(epsilon, 1e-8);
+      if ( retval == EXIT_SUCCESS )
+        std::cout << "# Test passed" << std::endl;
+      else
+        return retval;
+    }
+    std::cout << std::endl;
+    std::cout << "----------------------------------------------" << std::endl;
+    std::cout << std::endl;
+  }
+
+  std::cout << std::endl;
+  std::cout << "------- Test completed --------" << std::endl;
+  std::cout << std::endl;
+
+  return retval;
+}
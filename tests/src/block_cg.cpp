@@ -0,0 +1,247 @@
+/* =========================================================================
+   Copyright (c) 2010-2016, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+   Portions of this software are copyright by UChicago Argonne, LLC.
+
+                            -----------------
+                  ViennaCL - The Vienna Computing Library
+                            -----------------
+
+   Project Head:    Karl Rupp                   rupp@iue.tuwien.ac.at
+
+   (A list of authors and contributors can be found in the PDF manual)
+
+   License:         MIT (X11), see file LICENSE in the base directory
+============================================================================= */
+
+
+
+/** \file tests/src/block_cg.cpp  Tests the block conjugate gradient method for multiple right hand sides.
+*   \test  Tests the block conjugate gradient method for multiple right hand sides.
+**/
+
+//
+// *** System
+//
+#include <iostream>
+#include <vector>
+#include <map>
+#include <cmath>
+
+
+//
+// *** ViennaCL
+//
+#include "viennacl/scalar.hpp"
+#include "viennacl/vector.hpp"
+#include "viennacl/matrix.hpp"
+#include "viennacl/compressed_matrix.hpp"
+#include "viennacl/linalg/prod.hpp"
+#include "viennacl/linalg/norm_2.hpp"
+#include "viennacl/linalg/cg.hpp"
+#include "viennacl/linalg/block_cg.hpp"
+#include "viennacl/linalg/jacobi_precond.hpp"
+#include "viennacl/linalg/ilu.hpp"
+
+#include "viennacl/tools/random.hpp"
+
+#include "sparse_test_systems.hpp"
+
+//
+// -------------------------------------------------------------
+//
+
+/* Returns the largest relative residual ||b_j - A x_j|| / ||b_j|| over all columns with nonzero b_j. Zero columns must have zero solution. */
+template<typename NumericT, typename F>
+NumericT max_relative_residual(viennacl::compressed_matrix<NumericT> const & A, viennacl::matrix<NumericT, F> const & B, viennacl::matrix<NumericT, F> const & X)
+{
+  std::vector<std::vector<NumericT> > host_B(B.size1(), std::vector<NumericT>(B.size2()));
+  std::vector<std::vector<NumericT> > host_X(X.size1(), std::vector<NumericT>(X.size2()));
+  viennacl::copy(B, host_B);
+  viennacl::copy(X, host_X);
+
+  NumericT max_residual = 0;
+  for (std::size_t j=0; j<B.size2(); ++j)
+  {
+    std::vector<NumericT> b(B.size1()), x(X.size1());
+    for (std::size_t i=0; i<B.size1(); ++i)
+    {
+      b[i] = host_B[i][j];
+      x[i] = host_X[i][j];
+    }
+    viennacl::vector<NumericT> vcl_b(b.size()), vcl_x(x.size());
+    viennacl::copy(b, vcl_b);
+    viennacl::copy(x, vcl_x);
+
+    NumericT norm_b = viennacl::linalg::norm_2(vcl_b);
+    viennacl::vector<NumericT> residual = viennacl::linalg::prod(A, vcl_x);
+    residual = vcl_b - residual;
+    NumericT norm_residual = viennacl::linalg::norm_2(residual);
+    if (norm_b > 0)
+      max_residual = std::max(max_residual, norm_residual / norm_b);
+    else
+      max_residual = std::max(max_residual, NumericT(viennacl::linalg::norm_2(vcl_x)));
+  }
+  return max_residual;
+}
+
+
+//
+// -------------------------------------------------------------
+//
+template<typename NumericT, typename F, typename Epsilon>
+int test(Epsilon const& epsilon, double solver_tolerance)
+{
+  viennacl::tools::uniform_random_numbers<NumericT> randomNumber;
+
+  std::size_t points_per_dim = 30;
+  viennacl::compressed_matrix<NumericT> A(points_per_dim * points_per_dim, points_per_dim * points_per_dim);
+  laplace_2d(A, points_per_dim);
+
+  // right hand sides: random columns, a duplicate column, a linear combination, and a zero column
+  std::size_t N = A.size1();
+  std::size_t k = 10;
+  std::vector<std::vector<NumericT> > host_B(N, std::vector<NumericT>(k));
+  for (std::size_t i=0; i<N; ++i)
+  {
+    for (std::size_t j=0; j<7; ++j)
+      host_B[i][j] = randomNumber();
+    host_B[i][7] = host_B[i][2];
+    host_B[i][8] = host_B[i][0] - NumericT(2) * host_B[i][1];
+    host_B[i][9] = 0;
+  }
+  viennacl::matrix<NumericT, F> B(N, k);
+  viennacl::copy(host_B, B);
+
+  viennacl::linalg::block_cg_tag tag(solver_tolerance, 500);
+
+  std::cout << "Testing block CG without preconditioner" << std::endl;
+  viennacl::matrix<NumericT, F> X = viennacl::linalg::solve(A, B, tag);
+  NumericT residual = max_relative_residual(A, B, X);
+  std::cout << "  iterations: " << tag.iters() << ", final block size: " << tag.block_size() << ", residual: " << residual << std::endl;
+  if (residual > epsilon || tag.block_size() > 7)
+  {
+    std::cout << "# Error: Block CG without preconditioner failed" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // block CG needs fewer iterations than CG for a single right hand side:
+  viennacl::vector<NumericT> b(N);
+  std::vector<NumericT> host_b(N);
+  for (std::size_t i=0; i<N; ++i)
+    host_b[i] = host_B[i][0];
+  viennacl::copy(host_b, b);
+  viennacl::linalg::cg_tag single_tag(solver_tolerance, 500);
+  viennacl::vector<NumericT> x = viennacl::linalg::solve(A, b, single_tag);
+  if (tag.iters() >= single_tag.iters())
+  {
+    std::cout << "# Error: Block CG took " << tag.iters() << " iterations, CG took " << single_tag.iters() << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::cout << "Testing block CG with Jacobi preconditioner" << std::endl;
+  viennacl::linalg::jacobi_precond<viennacl::compressed_matrix<NumericT> > jacobi(A, viennacl::linalg::jacobi_tag());
+  X = viennacl::linalg::solve(A, B, tag, jacobi);
+  residual = max_relative_residual(A, B, X);
+  std::cout << "  iterations: " << tag.iters() << ", residual: " << residual << std::endl;
+  if (residual > epsilon)
+  {
+    std::cout << "# Error: Block CG with Jacobi preconditioner failed" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::cout << "Testing block CG with ILU0 preconditioner" << std::endl;
+  unsigned int unpreconditioned_iterations = tag.iters();
+  viennacl::linalg::ilu0_precond<viennacl::compressed_matrix<NumericT> > ilu0(A, viennacl::linalg::ilu0_tag());
+  X = viennacl::linalg::solve(A, B, tag, ilu0);
+  residual = max_relative_residual(A, B, X);
+  std::cout << "  iterations: " << tag.iters() << ", residual: " << residual << std::endl;
+  if (residual > epsilon || tag.iters() >= unpreconditioned_iterations)
+  {
+    std::cout << "# Error: Block CG with ILU0 preconditioner failed" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+
+//
+// -------------------------------------------------------------
+//
+int main()
+{
+  std::cout << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << "## Test :: Block Conjugate Gradient" << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << std::endl;
+
+  int retval = EXIT_SUCCESS;
+
+  std::cout << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << std::endl;
+  {
+    typedef float NumericT;
+    NumericT epsilon = static_cast<NumericT>(1E-2);
+    std::cout << "# Testing setup:" << std::endl;
+    std::cout << "  eps:     " << epsilon << std::endl;
+    std::cout << "  numeric: float" << std::endl;
+    std::cout << "  layout:  row-major" << std::endl;
+    retval = test<NumericT, viennacl::row_major>(epsilon, 1e-3);
+    if ( retval == EXIT_SUCCESS )
+        std::cout << "# Test passed" << std::endl;
+    else
+        return retval;
+  }
+  std::cout << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << std::endl;
+#ifdef VIENNACL_WITH_OPENCL
+  if ( viennacl::ocl::current_device().double_support() )
+#endif
+  {
+    {
+      typedef double NumericT;
+      NumericT epsilon = 1.0E-7;
+      std::cout << "# Testing setup:" << std::endl;
+      std::cout << "  eps:     " << epsilon << std::endl;
+      std::cout << "  numeric: double" << std::endl;
+      std::cout << "  layout:  row-major" << std::endl;
+      retval = test<NumericT, viennacl::row_major>(epsilon, 1e-8);
+      if ( retval == EXIT_SUCCESS )
+        std::cout << "# Test passed" << std::endl;
+      else
+        return retval;
+    }
+    std::cout << std::endl;
+    std::cout << "----------------------------------------------" << std::endl;
+    std::cout << std::endl;
+    {
+      typedef double NumericT;
+      NumericT epsilon = 1.0E-7;
+      std::cout << "# Testing setup:" << std::endl;
+      std::cout << "  eps:     " << epsilon << std::endl;
+      std::cout << "  numeric: double" << std::endl;
+      std::cout << "  layout:  column-major" << std::endl;
+      retval = test<NumericT, viennacl::column_major>(epsilon, 1e-8);
+      if ( retval == EXIT_SUCCESS )
+        std::cout << "# Test passed" << std::endl;
+      else
+        return retval;
+    }
+    std::cout << std::endl;
+    std::cout << "----------------------------------------------" << std::endl;
+    std::cout << std::endl;
+  }
+
+  std::cout << std::endl;
+  std::cout << "------- Test completed --------" << std::endl;
+  std::cout << std::endl;
+
+  return retval;
+}
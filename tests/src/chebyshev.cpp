@@ -0,0 +1,283 @@
+/* =========================================================================
+   Copyright (c) 2010-2016, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+   Portions of this software are copyright by UChicago Argonne, LLC.
+
+                            -----------------
+                  ViennaCL - The Vienna Computing Library
+                            -----------------
+
+   Project Head:    Karl Rupp                   rupp@iue.tuwien.ac.at
+
+   (A list of authors and contributors can be found in the PDF manual)
+
+   License:         MIT (X11), see file LICENSE in the base directory
+============================================================================= */
+
+
+
+/** \file tests/src/chebyshev.cpp  Tests the Chebyshev iteration as solver, as polynomial preconditioner, and as AMG smoother.
+*   \test  Tests the Chebyshev iteration as solver, as polynomial preconditioner, and as AMG smoother.
+**/
+
+//
+// *** System
+//
+#include <iostream>
+#include <vector>
+#include <map>
+#include <cmath>
+
+
+//
+// *** ViennaCL
+//
+#include "viennacl/scalar.hpp"
+#include "viennacl/vector.hpp"
+#include "viennacl/vector_proxy.hpp"
+#include "viennacl/compressed_matrix.hpp"
+#include "viennacl/linalg/prod.hpp"
+#include "viennacl/linalg/norm_2.hpp"
+#include "viennacl/linalg/cg.hpp"
+#include "viennacl/linalg/amg.hpp"
+#include "viennacl/linalg/chebyshev.hpp"
+
+#include "sparse_test_systems.hpp"
+
+//
+// -------------------------------------------------------------
+//
+template<typename NumericT>
+int test_sweep(NumericT epsilon)
+{
+  std::cout << "Testing Chebyshev sweep..." << std::endl;
+
+  viennacl::compressed_matrix<NumericT> A;
+  laplace_2d(A, 10);
+  std::size_t N = A.size1();
+
+  std::vector<NumericT> host_x(N), host_d(N), host_b(N);
+  for (std::size_t i=0; i<N; ++i)
+  {
+    host_x[i] = NumericT(1) + NumericT(i % 7) / NumericT(10);
+    host_d[i] = NumericT(i % 3) - NumericT(1);
+    host_b[i] = NumericT(i % 5);
+  }
+
+  viennacl::vector<NumericT> x(N), x_backup(N), d(N), b(N);
+  viennacl::copy(host_x, x);
+  viennacl::copy(host_d, d);
+  viennacl::copy(host_b, b);
+
+  NumericT alpha = NumericT(0.3);
+  NumericT beta  = NumericT(0.7);
+
+  // reference: r = b - A x, d = alpha * d + beta * r / 4, x += d
+  viennacl::vector<NumericT> r = viennacl::linalg::prod(A, x);
+  r = b - r;
+  NumericT ref_norm = viennacl::linalg::inner_prod(r, r);
+  viennacl::vector<NumericT> ref_d = alpha * d + (beta / NumericT(4)) * r;
+  viennacl::vector<NumericT> ref_x = x + ref_d;
+
+  // fused sweep (host backend) and non-fused sweep (used for OpenCL and CUDA):
+  for (int fused = 1; fused >= 0; --fused)
+  {
+    viennacl::copy(host_x, x);
+    viennacl::copy(host_d, d);
+    NumericT norm = fused ? viennacl::linalg::chebyshev_sweep(A, x, x_backup, d, b, alpha, beta)
+                          : viennacl::linalg::detail::chebyshev_sweep_unfused(A, x, x_backup, d, b, alpha, beta);
+
+    NumericT diff_x = viennacl::linalg::norm_2(ref_x - x) / viennacl::linalg::norm_2(ref_x);
+    NumericT diff_d = viennacl::linalg::norm_2(ref_d - d) / viennacl::linalg::norm_2(ref_d);
+    NumericT diff_norm = std::fabs(ref_norm - norm) / ref_norm;
+    if (diff_x > epsilon || diff_d > epsilon || diff_norm > epsilon)
+    {
+      std::cout << "# Error at operation: chebyshev_sweep(), " << (fused ? "fused" : "non-fused") << std::endl;
+      std::cout << "  diff x: " << diff_x << ", diff d: " << diff_d << ", diff norm: " << diff_norm << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  // fused sweep on strided vectors:
+  viennacl::vector<NumericT> x_strided(2 * N), x_backup_strided(3 * N), d_strided(2 * N), b_strided(3 * N);
+  viennacl::vector_slice<viennacl::vector<NumericT> > x_slice(x_strided, viennacl::slice(1, 2, N));
+  viennacl::vector_slice<viennacl::vector<NumericT> > x_backup_slice(x_backup_strided, viennacl::slice(2, 3, N));
+  viennacl::vector_slice<viennacl::vector<NumericT> > d_slice(d_strided, viennacl::slice(0, 2, N));
+  viennacl::vector_slice<viennacl::vector<NumericT> > b_slice(b_strided, viennacl::slice(1, 3, N));
+  viennacl::copy(host_x, x);
+  viennacl::copy(host_d, d);
+  x_slice = x;
+  d_slice = d;
+  b_slice = b;
+  NumericT norm = viennacl::linalg::chebyshev_sweep(A, x_slice, x_backup_slice, d_slice, b_slice, alpha, beta);
+  x = x_slice;
+  d = d_slice;
+
+  NumericT diff_x = viennacl::linalg::norm_2(ref_x - x) / viennacl::linalg::norm_2(ref_x);
+  NumericT diff_d = viennacl::linalg::norm_2(ref_d - d) / viennacl::linalg::norm_2(ref_d);
+  NumericT diff_norm = std::fabs(ref_norm - norm) / ref_norm;
+  if (diff_x > epsilon || diff_d > epsilon || diff_norm > epsilon)
+  {
+    std::cout << "# Error at operation: chebyshev_sweep() with strided vectors" << std::endl;
+    std::cout << "  diff x: " << diff_x << ", diff d: " << diff_d << ", diff norm: " << diff_norm << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+
+template<typename NumericT>
+int test_solver(NumericT epsilon, double tol)
+{
+  std::size_t points_per_dim = 30;
+  viennacl::compressed_matrix<NumericT> A;
+  laplace_2d(A, points_per_dim);
+  viennacl::vector<NumericT> b = viennacl::scalar_vector<NumericT>(A.size1(), NumericT(1));
+
+  // exact extremal eigenvalues of D^{-1} A:
+  double pi = 3.1415926535897932384626433832795;
+  double lambda_min = 1.0 - std::cos(pi / double(points_per_dim + 1));
+  double lambda_max = 1.0 + std::cos(pi / double(points_per_dim + 1));
+
+  std::cout << "Testing Chebyshev iteration with exact spectral bounds..." << std::endl;
+  viennacl::linalg::chebyshev_tag exact_tag(tol, 2000, lambda_min, lambda_max);
+  viennacl::vector<NumericT> x = viennacl::linalg::solve(A, b, exact_tag);
+  NumericT residual = relative_residual(A, b, x);
+  std::cout << "  iterations: " << exact_tag.iters() << ", relative residual: " << residual << std::endl;
+  if (residual > epsilon || exact_tag.iters() >= exact_tag.max_iterations())
+  {
+    std::cout << "# Error at operation: Chebyshev iteration with exact bounds" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::cout << "Testing Chebyshev iteration with estimated spectral bounds..." << std::endl;
+  viennacl::linalg::chebyshev_tag estimated_tag(tol, 2000);
+  x = viennacl::linalg::solve(A, b, estimated_tag);
+  residual = relative_residual(A, b, x);
+  std::cout << "  iterations: " << estimated_tag.iters() << ", relative residual: " << residual
+            << ", bounds: [" << estimated_tag.used_lambda_min() << ", " << estimated_tag.used_lambda_max() << "]" << std::endl;
+  if (residual > epsilon || estimated_tag.iters() >= estimated_tag.max_iterations())
+  {
+    std::cout << "# Error at operation: Chebyshev iteration with estimated bounds" << std::endl;
+    return EXIT_FAILURE;
+  }
+  if (estimated_tag.used_lambda_max() < lambda_max || estimated_tag.iters() > 3 * exact_tag.iters())
+  {
+    std::cout << "# Error at operation: Chebyshev spectral bound estimation" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::cout << "Testing CG with Chebyshev polynomial preconditioner..." << std::endl;
+  viennacl::linalg::cg_tag plain_cg_tag(tol, 1000);
+  x = viennacl::linalg::solve(A, b, plain_cg_tag);
+
+  viennacl::linalg::chebyshev_precond< viennacl::compressed_matrix<NumericT> > chebyshev(A, viennacl::linalg::chebyshev_precond_tag(4));
+  viennacl::linalg::cg_tag cg_tag(tol, 1000);
+  x = viennacl::linalg::solve(A, b, cg_tag, chebyshev);
+  residual = relative_residual(A, b, x);
+  std::cout << "  iterations: " << cg_tag.iters() << " (unpreconditioned: " << plain_cg_tag.iters() << "), relative residual: " << residual << std::endl;
+  if (residual > epsilon || cg_tag.iters() * 2 > plain_cg_tag.iters())
+  {
+    std::cout << "# Error at operation: CG with Chebyshev preconditioner" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::cout << "Testing CG with AMG preconditioner and Chebyshev smoother..." << std::endl;
+  viennacl::linalg::amg_tag jacobi_amg_tag;
+  jacobi_amg_tag.set_jacobi_weight(0.67);
+  viennacl::linalg::amg_precond< viennacl::compressed_matrix<NumericT> > jacobi_amg(A, jacobi_amg_tag);
+  jacobi_amg.setup();
+  viennacl::linalg::cg_tag jacobi_amg_cg_tag(tol, 1000);
+  x = viennacl::linalg::solve(A, b, jacobi_amg_cg_tag, jacobi_amg);
+
+  viennacl::linalg::amg_tag chebyshev_amg_tag;
+  chebyshev_amg_tag.set_smoother(viennacl::linalg::AMG_SMOOTHER_CHEBYSHEV);
+  viennacl::linalg::amg_precond< viennacl::compressed_matrix<NumericT> > chebyshev_amg(A, chebyshev_amg_tag);
+  chebyshev_amg.setup();
+  viennacl::linalg::cg_tag chebyshev_amg_cg_tag(tol, 1000);
+  x = viennacl::linalg::solve(A, b, chebyshev_amg_cg_tag, chebyshev_amg);
+  residual = relative_residual(A, b, x);
+  std::cout << "  iterations: " << chebyshev_amg_cg_tag.iters() << " (Jacobi smoother: " << jacobi_amg_cg_tag.iters() << "), relative residual: " << residual << std::endl;
+  if (residual > epsilon || chebyshev_amg_cg_tag.iters() > jacobi_amg_cg_tag.iters())
+  {
+    std::cout << "# Error at operation: CG with AMG preconditioner and Chebyshev smoother" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+
+template<typename NumericT>
+int test(NumericT epsilon, double tol)
+{
+  int retval = test_sweep<NumericT>(epsilon);
+  if (retval != EXIT_SUCCESS)
+    return retval;
+
+  return test_solver<NumericT>(epsilon, tol);
+}
+
+
+//
+// -------------------------------------------------------------
+//
+int main()
+{
+  std::cout << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << "## Test :: Chebyshev Iteration" << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << std::endl;
+
+  int retval = EXIT_SUCCESS;
+
+  std::cout << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << std::endl;
+  {
+    typedef float NumericT;
+    NumericT epsilon = static_cast<NumericT>(1E-3);
+    std::cout << "# Testing setup:" << std::endl;
+    std::cout << "  eps:     " << epsilon << std::endl;
+    std::cout << "  numeric: float" << std::endl;
+    retval = test<NumericT>(epsilon, 1e-4);
+    if ( retval == EXIT_SUCCESS )
+        std::cout << "# Test passed" << std::endl;
+    else
+        return retval;
+  }
+  std::cout << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << std::endl;
+#ifdef VIENNACL_WITH_OPENCL
+  if ( viennacl::ocl::current_device().double_support() )
+#endif
+  {
+    {
+      typedef double NumericT;
+      NumericT epsilon = 1.0E-9;
+      std::cout << "# Testing setup:" << std::endl;
+      std::cout << "  eps:     " << epsilon << std::endl;
+      std::cout << "  numeric: double" << std::endl;
+      retval = test<NumericT>(epsilon, 1e-10);
+      if ( retval == EXIT_SUCCESS )
+        std::cout << "# Test passed" << std::endl;
+      else
+        return retval;
+    }
+    std::cout << std::endl;
+    std::cout << "----------------------------------------------" << std::endl;
+    std::cout << std::endl;
+  }
+
+  std::cout << std::endl;
+  std::cout << "------- Test completed --------" << std::endl;
+  std::cout << std::endl;
+
+  return retval;
+}
@@ -0,0 +1,199 @@
+/* =========================================================================
+   Copyright (c) 2010-2016, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+   Portions of this software are copyright by UChicago Argonne, LLC.
+
+                            -----------------
+                  ViennaCL - The Vienna Computing Library
+                            -----------------
+
+   Project Head:    Karl Rupp                   rupp@iue.tuwien.ac.at
+
+   (A list of authors and contributors can be found in the PDF manual)
+
+   License:         MIT (X11), see file LICENSE in the base directory
+============================================================================= */
+
+
+
+/** \file tests/src/fgmres.cpp  Tests the flexible GMRES method with fixed, function, and nested preconditioners.
+*   \test  Tests the flexible GMRES method with fixed, function, and nested preconditioners.
+**/
+
+//
+// *** System
+//
+#include <iostream>
+#include <vector>
+#include <map>
+#include <cmath>
+
+
+//
+// *** ViennaCL
+//
+#include "viennacl/scalar.hpp"
+#include "viennacl/vector.hpp"
+#include "viennacl/compressed_matrix.hpp"
+#include "viennacl/linalg/prod.hpp"
+#include "viennacl/linalg/norm_2.hpp"
+#include "viennacl/linalg/cg.hpp"
+#include "viennacl/linalg/gmres.hpp"
+#include "viennacl/linalg/fgmres.hpp"
+#include "viennacl/linalg/ilu.hpp"
+
+#include "sparse_test_systems.hpp"
+
+//
+// -------------------------------------------------------------
+//
+
+/* A preconditioner given by a plain function: scaling by the inverse diagonal of the test matrices */
+template<typename NumericT>
+void scale_by_diagonal(viennacl::vector<NumericT> & v)
+{
+  v *= NumericT(0.25);
+}
+
+/* Reports the solver statistics and checks the true residual as well as the residual reported by the tag */
+template<typename NumericT>
+bool check(std::string const & name, viennacl::compressed_matrix<NumericT> const & A, viennacl::vector<NumericT> const & b, viennacl::vector<NumericT> const & x,
+           viennacl::linalg::fgmres_tag const & tag, NumericT epsilon)
+{
+  NumericT residual = relative_residual(A, b, x);
+  std::cout << "  iterations: " << tag.iters() << ", residual: " << residual << ", reported residual: " << tag.error() << std::endl;
+  if (residual > epsilon || std::fabs(residual - NumericT(tag.error())) > epsilon)
+  {
+    std::cout << "# Error: FGMRES with " << name << " failed" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+
+//
+// -------------------------------------------------------------
+//
+template<typename NumericT>
+int test(NumericT epsilon, double solver_tolerance)
+{
+  std::size_t points_per_dim = 30;
+  std::size_t N = points_per_dim * points_per_dim;
+  viennacl::vector<NumericT> b = viennacl::scalar_vector<NumericT>(N, NumericT(1));
+
+  viennacl::compressed_matrix<NumericT> A(N, N);
+  convection_diffusion_2d(A, points_per_dim, NumericT(0.25));
+
+  viennacl::linalg::fgmres_tag tag(solver_tolerance, 1000, 30);
+
+  std::cout << "Testing FGMRES without preconditioner" << std::endl;
+  viennacl::vector<NumericT> x = viennacl::linalg::solve(A, b, tag);
+  if (!check("no preconditioner", A, b, x, tag, epsilon))
+    return EXIT_FAILURE;
+  unsigned int unpreconditioned_iterations = tag.iters();
+
+  // without preconditioner, FGMRES is mathematically equivalent to GMRES (up to round-off, which accumulates over restarts):
+  viennacl::linalg::gmres_tag gmres_tag(solver_tolerance, 1000, 30);
+  viennacl::linalg::solve(A, b, gmres_tag);
+  if (10 * tag.iters() > 11 * gmres_tag.iters() || 10 * gmres_tag.iters() > 11 * tag.iters())
+  {
+    std::cout << "# Error: FGMRES took " << tag.iters() << " iterations, GMRES took " << gmres_tag.iters() << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::cout << "Testing FGMRES with function preconditioner" << std::endl;
+  x = viennacl::linalg::solve(A, b, tag, scale_by_diagonal<NumericT>);
+  if (!check("function preconditioner", A, b, x, tag, epsilon))
+    return EXIT_FAILURE;
+
+  std::cout << "Testing FGMRES with ILU0 preconditioner" << std::endl;
+  viennacl::linalg::ilu0_precond<viennacl::compressed_matrix<NumericT> > ilu0(A, viennacl::linalg::ilu0_tag());
+  x = viennacl::linalg::solve(A, b, tag, ilu0);
+  if (!check("ILU0 preconditioner", A, b, x, tag, epsilon) || tag.iters() >= unpreconditioned_iterations)
+    return EXIT_FAILURE;
+
+  std::cout << "Testing FGMRES with inner GMRES preconditioned by ILU0" << std::endl;
+  viennacl::linalg::gmres_tag inner_gmres_tag(1e-1, 10, 10);
+  viennacl::linalg::inner_solver_precond<viennacl::compressed_matrix<NumericT>,
+                                         viennacl::linalg::gmres_tag,
+                                         viennacl::linalg::ilu0_precond<viennacl::compressed_matrix<NumericT> > > inner_gmres(A, inner_gmres_tag, ilu0);
+  x = viennacl::linalg::solve(A, b, tag, inner_gmres);
+  std::cout << "  inner iterations: " << inner_gmres.total_iters() << std::endl;
+  if (!check("inner GMRES", A, b, x, tag, epsilon) || tag.iters() >= unpreconditioned_iterations)
+    return EXIT_FAILURE;
+
+  std::cout << "Testing FGMRES with inner CG on a symmetric system" << std::endl;
+  viennacl::compressed_matrix<NumericT> B(N, N);
+  convection_diffusion_2d(B, points_per_dim, NumericT(0));
+  viennacl::linalg::cg_tag inner_cg_tag(1e-1, 10);
+  viennacl::linalg::inner_solver_precond<viennacl::compressed_matrix<NumericT>, viennacl::linalg::cg_tag> inner_cg(B, inner_cg_tag);
+  x = viennacl::linalg::solve(B, b, tag, inner_cg);
+  std::cout << "  inner iterations: " << inner_cg.total_iters() << std::endl;
+  if (!check("inner CG", B, b, x, tag, epsilon))
+    return EXIT_FAILURE;
+
+  return EXIT_SUCCESS;
+}
+
+
+//
+// -------------------------------------------------------------
+//
+int main()
+{
+  std::cout << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << "## Test :: Flexible GMRES" << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << std::endl;
+
+  int retval = EXIT_SUCCESS;
+
+  std::cout << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << std::endl;
+  {
+    typedef float NumericT;
+    NumericT epsilon = static_cast<NumericT>(1E-3);
+    std::cout << "# Testing setup:" << std::endl;
+    std::cout << "  eps:     " << epsilon << std::endl;
+    std::cout << "  numeric: float" << std::endl;
+    retval = test<NumericT>(epsilon, 1e-4);
+    if ( retval == EXIT_SUCCESS )
+        std::cout << "# Test passed" << std::endl;
+    else
+        return retval;
+  }
+  std::cout << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << std::endl;
+#ifdef VIENNACL_WITH_OPENCL
+  if ( viennacl::ocl::current_device().double_support() )
+#endif
+  {
+    {
+      typedef double NumericT;
+      NumericT epsilon = 1.0E-9;
+      std::cout << "# Testing setup:" << std::endl;
+      std::cout << "  eps:     " << epsilon << std::endl;
+      std::cout << "  numeric: double" << std::endl;
+      retval = test<NumericT>(epsilon, 1e-10);
+      if ( retval == EXIT_SUCCESS )
+        std::cout << "# Test passed" << std::endl;
+      else
+        return retval;
+    }
+    std::cout << std::endl;
+    std::cout << "----------------------------------------------" << std::endl;
+    std::cout << std::endl;
+  }
+
+  std::cout << std::endl;
+  std::cout << "------- Test completed --------" << std::endl;
+  std::cout << std::endl;
+
+  return retval;
+}
@@ -0,0 +1,181 @@
+/* =========================================================================
+   Copyright (c) 2010-2016, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+   Portions of this software are copyright by UChicago Argonne, LLC.
+
+                            -----------------
+                  ViennaCL - The Vienna Computing Library
+                            -----------------
+
+   Project Head:    Karl Rupp                   rupp@iue.tuwien.ac.at
+
+   (A list of authors and contributors can be found in the PDF manual)
+
+   License:         MIT (X11), see file LICENSE in the base directory
+============================================================================= */
+
+
+
+/** \file tests/src/gcrodr.cpp  Tests GCRO-DR with subspace recycling across a sequence of slowly varying systems.
+*   \test  Tests GCRO-DR with subspace recycling across a sequence of slowly varying systems.
+**/
+
+//
+// *** System
+//
+#include <iostream>
+#include <vector>
+#include <map>
+#include <cmath>
+
+
+//
+// *** ViennaCL
+//
+#include "viennacl/scalar.hpp"
+#include "viennacl/vector.hpp"
+#include "viennacl/compressed_matrix.hpp"
+#include "viennacl/linalg/prod.hpp"
+#include "viennacl/linalg/norm_2.hpp"
+#include "viennacl/linalg/gmres.hpp"
+#include "viennacl/linalg/gcrodr.hpp"
+#include "viennacl/linalg/ilu.hpp"
+
+#include "sparse_test_systems.hpp"
+
+//
+// -------------------------------------------------------------
+//
+template<typename NumericT>
+int test(NumericT epsilon, double solver_tolerance)
+{
+  std::size_t points_per_dim = 30;
+  std::size_t N = points_per_dim * points_per_dim;
+  unsigned int krylov_dim = 20;
+  unsigned int recycle_dim = 8;
+
+  viennacl::linalg::gcrodr_solver<viennacl::vector<NumericT> > solver(viennacl::linalg::gcrodr_tag(solver_tolerance, 2000, krylov_dim, recycle_dim));
+
+  std::cout << "Testing GCRO-DR on a sequence of slowly varying systems" << std::endl;
+  for (std::size_t step = 0; step < 4; ++step)
+  {
+    viennacl::compressed_matrix<NumericT> A(N, N);
+    convection_diffusion_2d(A, points_per_dim, NumericT(0.1), NumericT(0.01) * NumericT(step));
+
+    std::vector<NumericT> host_b(N);
+    for (std::size_t i = 0; i < N; ++i)
+      host_b[i] = NumericT(1) + NumericT(0.1) * NumericT(step) * NumericT(std::sin(double(i)));
+    viennacl::vector<NumericT> b(N);
+    viennacl::copy(host_b, b);
+
+    viennacl::vector<NumericT> x = solver(A, b);
+    NumericT residual = relative_residual(A, b, x);
+
+    viennacl::linalg::gcrodr_tag single_tag(solver_tolerance, 2000, krylov_dim, recycle_dim);
+    viennacl::linalg::solve(A, b, single_tag);
+    viennacl::linalg::gmres_tag gmres_tag(solver_tolerance, 2000, krylov_dim);
+    viennacl::linalg::solve(A, b, gmres_tag);
+
+    std::cout << "  system " << step << ": iterations: " << solver.tag().iters() << " (without recycling across systems: " << single_tag.iters() << ", GMRES: " << gmres_tag.iters() << ")"
+              << ", residual: " << residual << ", recycled vectors: " << solver.recycle_size() << std::endl;
+
+    if (residual > epsilon || solver.recycle_size() > recycle_dim)
+    {
+      std::cout << "# Error: GCRO-DR failed for system " << step << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // deflation within a solve already beats restarted GMRES, recycling across systems pays off from the second system on:
+    if (single_tag.iters() >= gmres_tag.iters() || (step > 0 && solver.tag().iters() >= single_tag.iters()))
+    {
+      std::cout << "# Error: No reduction of iterations by recycling for system " << step << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  std::cout << "Testing GCRO-DR with ILU0 preconditioner" << std::endl;
+  viennacl::compressed_matrix<NumericT> A(N, N);
+  convection_diffusion_2d(A, points_per_dim, NumericT(0.1), NumericT(0));
+  viennacl::linalg::ilu0_precond<viennacl::compressed_matrix<NumericT> > ilu0(A, viennacl::linalg::ilu0_tag());
+  viennacl::vector<NumericT> b = viennacl::scalar_vector<NumericT>(N, NumericT(1));
+
+  solver.reset();
+  if (solver.recycle_size() != 0)
+  {
+    std::cout << "# Error: Recycled subspace not discarded by reset()" << std::endl;
+    return EXIT_FAILURE;
+  }
+  viennacl::vector<NumericT> x = solver(A, b, ilu0);
+  NumericT residual = relative_residual(A, b, x);
+  std::cout << "  iterations: " << solver.tag().iters() << ", residual: " << residual << std::endl;
+  if (residual > epsilon)
+  {
+    std::cout << "# Error: GCRO-DR with ILU0 preconditioner failed" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+
+//
+// -------------------------------------------------------------
+//
+int main()
+{
+  std::cout << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << "## Test :: GCRO-DR" << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << std::endl;
+
+  int retval = EXIT_SUCCESS;
+
+  std::cout << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << std::endl;
+  {
+    typedef float NumericT;
+    NumericT epsilon = static_cast<NumericT>(1E-3);
+    std::cout << "# Testing setup:" << std::endl;
+    std::cout << "  eps:     " << epsilon << std::endl;
+    std::cout << "  numeric: float" << std::endl;
+    retval = test<NumericT>(epsilon, 1e-5);
+    if ( retval == EXIT_SUCCESS )
+        std::cout << "# Test passed" << std::endl;
+    else
+        return retval;
+  }
+  std::cout << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << std::endl;
+#ifdef VIENNACL_WITH_OPENCL
+  if ( viennacl::ocl::current_device().double_support() )
+#endif
+  {
+    {
+      typedef double NumericT;
+      NumericT epsilon = 1.0E-9;
+      std::cout << "# Testing setup:" << std::endl;
+      std::cout << "  eps:     " << epsilon << std::endl;
+      std::cout << "  numeric: double" << std::endl;
+      retval = test<NumericT>(epsilon, 1e-10);
+      if ( retval == EXIT_SUCCESS )
+        std::cout << "# Test passed" << std::endl;
+      else
+        return retval;
+    }
+    std::cout << std::endl;
+    std::cout << "----------------------------------------------" << std::endl;
+    std::cout << std::endl;
+  }
+
+  std::cout << std::endl;
+  std::cout << "------- Test completed --------" << std::endl;
+  std::cout << std::endl;
+
+  return retval;
+}
@@ -0,0 +1,461 @@
+/* =========================================================================
+   Copyright (c) 2010-2016, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+   Portions of this software are copyright by UChicago Argonne, LLC.
+
+                            -----------------
+                  ViennaCL - The Vienna Computing Library
+                            -----------------
+
+   Project Head:    Karl Rupp                   rupp@iue.tuwien.ac.at
+
+   (A list of authors and contributors can be found in the PDF manual)
+
+   License:         MIT (X11), see file LICENSE in the base directory
+============================================================================= */
+
+
+
+/** \file tests/src/host_memory.cpp  Tests the management of buffers in main RAM: creation with first-touch placement, transfers, placement statistics, and the memory pool.
+*   \test  Tests the management of buffers in main RAM: creation with first-touch placement, transfers, placement statistics, and the memory pool.
+**/
+
+//
+// *** System
+//
+#include <iostream>
+#include <vector>
+#include <map>
+#include <algorithm>
+
+
+//
+// *** ViennaCL
+//
+#include "viennacl/backend/memory.hpp"
+#include "viennacl/backend/cpu_ram.hpp"
+#include "viennacl/vector.hpp"
+#include "viennacl/compressed_matrix.hpp"
+#include "viennacl/linalg/cg.hpp"
+
+//
+// -------------------------------------------------------------
+//
+
+int test_static_partition()
+{
+  std::cout << "Testing static partition" << std::endl;
+  std::size_t sizes[5] = { 0, 1, 7, 4096, 1000003 };
+  for (std::size_t i=0; i<5; ++i)
+    for (std::size_t num_threads = 1; num_threads < 10; ++num_threads)
+    {
+      std::size_t expected_begin = 0;
+      for (std::size_t thread_id = 0; thread_id < num_threads; ++thread_id)
+      {
+        std::size_t begin, end;
+        viennacl::backend::cpu_ram::detail::static_partition(sizes[i], thread_id, num_threads, begin, end);
+        if (begin != expected_begin || end < begin || end - begin > sizes[i] / num_threads + 1 || end - begin < sizes[i] / num_threads)
+        {
+          std::cout << "# Error: Wrong partition of " << sizes[i] << " items for thread " << thread_id << " of " << num_threads << std::endl;
+          return EXIT_FAILURE;
+        }
+        expected_begin = end;
+      }
+      if (expected_begin != sizes[i])
+      {
+        std::cout << "# Error: Partition of " << sizes[i] << " items into " << num_threads << " blocks incomplete" << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+  return EXIT_SUCCESS;
+}
+
+// the first-touch placement is only local if static_partition() assigns the same items to each thread as the loops with schedule(static) in the kernels:
+int test_schedule_partition()
+{
+  std::cout << "Testing static partition against OpenMP schedule" << std::endl;
+#ifdef VIENNACL_WITH_OPENMP
+  std::size_t sizes[4] = { 1, 7, 4097, 100003 };
+  for (std::size_t i=0; i<4; ++i)
+  {
+    long size = static_cast<long>(sizes[i]);
+    std::vector<int> thread_of_item(sizes[i], -1);
+    int num_threads = 1;
+
+    #pragma omp parallel
+    {
+      #pragma omp single
+      num_threads = omp_get_num_threads();
+
+      #pragma omp for schedule(static)
+      for (long j = 0; j < size; ++j)
+        thread_of_item[static_cast<std::size_t>(j)] = omp_get_thread_num();
+    }
+
+    for (int thread_id = 0; thread_id < num_threads; ++thread_id)
+    {
+      std::size_t begin, end;
+      viennacl::backend::cpu_ram::detail::static_partition(sizes[i], static_cast<std::size_t>(thread_id), static_cast<std::size_t>(num_threads), begin, end);
+      for (std::size_t j = begin; j < end; ++j)
+        if (thread_of_item[j] != thread_id)
+        {
+          std::cout << "# Error: Item " << j << " of " << sizes[i] << " processed by thread " << thread_of_item[j] << ", but placed for thread " << thread_id << std::endl;
+          return EXIT_FAILURE;
+        }
+    }
+  }
+#else
+  std::cout << "  (skipped, no OpenMP)" << std::endl;
+#endif
+  return EXIT_SUCCESS;
+}
+
+int test_csr_partition()
+{
+  std::cout << "Testing partition of CSR nonzeros" << std::endl;
+
+  // skewed rows: row i holds i % 17 + (i < 100 ? 500 : 0) nonzeros
+  std::size_t num_rows = 1000;
+  std::vector<unsigned int> row_buffer(num_rows + 1, 0);
+  for (std::size_t i=0; i<num_rows; ++i)
+    row_buffer[i+1] = row_buffer[i] + static_cast<unsigned int>(i % 17 + (i < 100 ? 500 : 0));
+
+  std::size_t bytes_per_nonzero = sizeof(double);
+  std::size_t size_in_bytes = row_buffer[num_rows] * bytes_per_nonzero;
+
+  for (std::size_t num_parts = 1; num_parts < 10; ++num_parts)
+  {
+    viennacl::backend::cpu_ram::detail::first_touch_partition partition(size_in_bytes, num_parts, &(row_buffer[0]), num_rows);
+    viennacl::backend::cpu_ram::detail::first_touch_partition byte_partition(size_in_bytes, num_parts);
+
+    std::size_t expected_begin = 0;
+    for (std::size_t part = 0; part < num_parts; ++part)
+    {
+      std::size_t row_begin, row_end;
+      viennacl::backend::cpu_ram::detail::static_partition(num_rows, part, num_parts, row_begin, row_end);
+
+      std::size_t begin, end;
+      partition.get(part, begin, end);
+      if (begin != expected_begin || begin != row_buffer[row_begin] * bytes_per_nonzero || end != row_buffer[row_end] * bytes_per_nonzero)
+      {
+        std::cout << "# Error: Nonzeros of part " << part << " of " << num_parts << " do not match rows " << row_begin << " to " << row_end << std::endl;
+        return EXIT_FAILURE;
+      }
+      expected_begin = end;
+    }
+    if (expected_begin != size_in_bytes)
+    {
+      std::cout << "# Error: Partition of nonzeros into " << num_parts << " parts incomplete" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // the skewed rows lead to a different placement than a partition of the bytes, hence the blocks must not be shared in the memory pool:
+    if (num_parts > 1 && partition.placement_key() == byte_partition.placement_key())
+    {
+      std::cout << "# Error: Same placement key for partitions of rows and bytes" << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
+
+// checks the statistics of memory_placement(). If all pages reside on a single NUMA node, all of them are local to the threads processing them.
+int check_placement_statistics(viennacl::backend::cpu_ram::memory_placement_statistics const & stats, std::size_t size_in_bytes)
+{
+  std::size_t known_pages = 0;
+  std::size_t nodes_used = 0;
+  for (std::size_t j=0; j<stats.pages_per_node.size(); ++j)
+  {
+    known_pages += stats.pages_per_node[j];
+    nodes_used += (stats.pages_per_node[j] > 0) ? 1 : 0;
+  }
+
+  std::cout << "  pages: " << stats.num_pages << ", unknown: " << stats.unknown_pages << ", local: " << stats.local_pages << ", nodes: " << stats.pages_per_node.size() << std::endl;
+  if (   stats.num_pages < (size_in_bytes - 1) / 4096 + 1
+      || known_pages + stats.unknown_pages != stats.num_pages
+      || stats.local_pages > known_pages)
+  {
+    std::cout << "# Error: Inconsistent placement statistics" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // all pages are touched in memory_create(), hence the placement is either known for all pages or not available at all:
+  if (known_pages > 0 && stats.unknown_pages > 0)
+  {
+    std::cout << "# Error: Pages not touched in memory_create()" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  if (nodes_used == 1 && stats.local_pages != known_pages)
+  {
+    std::cout << "# Error: Pages on the only NUMA node not reported as local" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int test_placement(std::size_t size_in_bytes)
+{
+  std::cout << "Testing buffer of " << size_in_bytes << " bytes" << std::endl;
+
+  std::vector<char> host_data(size_in_bytes);
+  for (std::size_t i=0; i<size_in_bytes; ++i)
+    host_data[i] = static_cast<char>(i % 127);
+
+  // initialized and uninitialized buffers:
+  viennacl::backend::mem_handle initialized;
+  viennacl::backend::memory_create(initialized, size_in_bytes, viennacl::context(viennacl::MAIN_MEMORY), &(host_data[0]));
+  viennacl::backend::mem_handle uninitialized;
+  viennacl::backend::memory_create(uninitialized, size_in_bytes, viennacl::context(viennacl::MAIN_MEMORY));
+
+  std::vector<char> result(size_in_bytes);
+  viennacl::backend::memory_read(initialized, 0, size_in_bytes, &(result[0]));
+  if (result != host_data)
+  {
+    std::cout << "# Error: Data not copied in memory_create()" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  viennacl::backend::mem_handle const * handles[2] = { &initialized, &uninitialized };
+  for (std::size_t i=0; i<2; ++i)
+  {
+    viennacl::backend::cpu_ram::memory_placement_statistics stats = viennacl::backend::cpu_ram::memory_placement(handles[i]->ram_handle(), size_in_bytes);
+    if (check_placement_statistics(stats, size_in_bytes) != EXIT_SUCCESS)
+      return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int test_csr_placement(std::size_t N)
+{
+  std::cout << "Testing placement of CSR matrix with " << N << " rows" << std::endl;
+
+  // lower triangular matrix: the number of nonzeros grows with the row index
+  std::vector<std::map<unsigned int, double> > host_A(N);
+  for (std::size_t i=0; i<N; ++i)
+    for (std::size_t j=(i > 200) ? i - 200 : 0; j<=i; ++j)
+      host_A[i][static_cast<unsigned int>(j)] = 1.0;
+
+  viennacl::compressed_matrix<double> A(N, N, viennacl::context(viennacl::MAIN_MEMORY));
+  viennacl::copy(host_A, A);
+
+  unsigned int const * row_buffer = viennacl::linalg::host_based::detail::extract_raw_pointer<unsigned int>(A.handle1());
+  std::size_t sizes[2] = { sizeof(unsigned int) * A.nnz(), sizeof(double) * A.nnz() };
+  viennacl::backend::mem_handle const * handles[2] = { &A.handle2(), &A.handle() };
+  for (std::size_t i=0; i<2; ++i)
+  {
+    viennacl::backend::cpu_ram::memory_placement_statistics stats = viennacl::backend::cpu_ram::memory_placement(handles[i]->ram_handle(), sizes[i], row_buffer, N);
+    if (check_placement_statistics(stats, sizes[i]) != EXIT_SUCCESS)
+      return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int test_transfers(std::size_t size_in_bytes)
+{
+  std::cout << "Testing transfers of " << size_in_bytes << " bytes" << std::endl;
+
+  std::vector<char> host_data(size_in_bytes + 13);
+  for (std::size_t i=0; i<host_data.size(); ++i)
+    host_data[i] = static_cast<char>(i % 251);
+
+  viennacl::backend::mem_handle src;
+  viennacl::backend::memory_create(src, host_data.size(), viennacl::context(viennacl::MAIN_MEMORY), &(host_data[0]));
+  viennacl::backend::mem_handle dst;
+  viennacl::backend::memory_create(dst, host_data.size(), viennacl::context(viennacl::MAIN_MEMORY));
+
+  // write and read with offsets:
+  std::vector<char> reference(host_data.size(), 0);
+  viennacl::backend::memory_write(dst, 0, host_data.size(), &(reference[0]));
+  viennacl::backend::memory_write(dst, 5, size_in_bytes, &(host_data[3]));
+  for (std::size_t i=0; i<size_in_bytes; ++i)
+    reference[5 + i] = host_data[3 + i];
+
+  std::vector<char> result(host_data.size());
+  viennacl::backend::memory_read(dst, 0, result.size(), &(result[0]));
+  if (result != reference)
+  {
+    std::cout << "# Error: Wrong result of memory_write() or memory_read()" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // copy between buffers with offsets:
+  viennacl::backend::memory_copy(src, dst, 7, 2, size_in_bytes);
+  for (std::size_t i=0; i<size_in_bytes; ++i)
+    reference[2 + i] = host_data[7 + i];
+  viennacl::backend::memory_read(dst, 0, result.size(), &(result[0]));
+  if (result != reference)
+  {
+    std::cout << "# Error: Wrong result of memory_copy()" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // overlapping copy within a buffer:
+  viennacl::backend::memory_copy(src, src, 0, 11, size_in_bytes);
+  for (std::size_t i=size_in_bytes; i>0; --i) // backwards, since the ranges overlap
+    host_data[11 + i - 1] = host_data[i - 1];
+  viennacl::backend::memory_read(src, 0, result.size(), &(result[0]));
+  if (result != host_data)
+  {
+    std::cout << "# Error: Wrong result of overlapping memory_copy()" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int test_memory_pool()
+{
+  std::cout << "Testing memory pool size classes" << std::endl;
+  for (std::size_t size = 1; size < 100000; size = size * 3 / 2 + 1)
+  {
+    std::size_t class_size = viennacl::backend::cpu_ram::detail::memory_pool_size_class(size);
+    if (class_size < size || class_size % 16 != 0 || (size > 64 && class_size - size > size / 4))
+    {
+      std::cout << "# Error: Bad size class " << class_size << " for size " << size << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  std::cout << "Testing reuse of released buffers" << std::endl;
+  viennacl::context host_ctx(viennacl::MAIN_MEMORY);
+  viennacl::backend::memory_pool_trim(host_ctx);
+  viennacl::backend::cpu_ram::memory_pool_reset_statistics();
+  {
+    viennacl::backend::mem_handle h;
+    viennacl::backend::memory_create(h, 100000, host_ctx);
+  }
+  {
+    viennacl::backend::mem_handle h;
+    viennacl::backend::memory_create(h, 99999, host_ctx); // same size class
+  }
+  viennacl::backend::cpu_ram::memory_pool_statistics stats = viennacl::backend::memory_pool_stats(host_ctx);
+  if (stats.misses != 1 || stats.hits != 1 || stats.bytes_in_use != 0 || stats.blocks_cached != 1 || stats.peak_bytes_in_use < 100000)
+  {
+    std::cout << "# Error: Released buffer not reused" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  viennacl::backend::memory_pool_trim(host_ctx);
+  stats = viennacl::backend::memory_pool_stats(host_ctx);
+  if (stats.bytes_cached != 0 || stats.blocks_cached != 0)
+  {
+    std::cout << "# Error: Cached blocks not released by trim" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::cout << "Testing limit on cached memory" << std::endl;
+  std::size_t old_limit = viennacl::backend::cpu_ram::memory_pool_max_bytes_cached();
+  viennacl::backend::cpu_ram::memory_pool_max_bytes_cached(150000);
+  {
+    viennacl::backend::mem_handle h1, h2;
+    viennacl::backend::memory_create(h1, 100000, host_ctx);
+    viennacl::backend::memory_create(h2, 100000, host_ctx);
+  }
+  stats = viennacl::backend::memory_pool_stats(host_ctx);
+  viennacl::backend::cpu_ram::memory_pool_max_bytes_cached(old_limit);
+  if (stats.blocks_cached != 1 || stats.bytes_cached > 150000)
+  {
+    std::cout << "# Error: Limit on cached memory exceeded" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::cout << "Testing steady state of repeated solves" << std::endl;
+  std::size_t N = 10000;
+  std::vector<std::map<unsigned int, double> > stl_A(N);
+  for (std::size_t i=0; i<N; ++i)
+  {
+    if (i > 0)
+      stl_A[i][static_cast<unsigned int>(i-1)] = -1.0;
+    stl_A[i][static_cast<unsigned int>(i)] = 2.5;
+    if (i < N-1)
+      stl_A[i][static_cast<unsigned int>(i+1)] = -1.0;
+  }
+  viennacl::compressed_matrix<double> A(N, N);
+  viennacl::copy(stl_A, A);
+  viennacl::vector<double> b = viennacl::scalar_vector<double>(N, 1.0);
+
+  for (std::size_t i=0; i<2; ++i)
+    viennacl::vector<double> x = viennacl::linalg::solve(A, b, viennacl::linalg::cg_tag());
+
+  viennacl::backend::cpu_ram::memory_pool_reset_statistics();
+  viennacl::vector<double> x = viennacl::linalg::solve(A, b, viennacl::linalg::cg_tag());
+  stats = viennacl::backend::memory_pool_stats(host_ctx);
+  if (stats.misses != 0 || stats.hits == 0)
+  {
+    std::cout << "# Error: Repeated solve allocated " << stats.misses << " buffers" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int test_vector(std::size_t size)
+{
+  std::cout << "Testing vector operations on vector of size " << size << std::endl;
+
+  std::vector<double> std_x(size);
+  for (std::size_t i=0; i<size; ++i)
+    std_x[i] = double(i);
+
+  viennacl::vector<double> x(size);
+  viennacl::copy(std_x, x);
+  viennacl::vector<double> y = 2.0 * x;
+  y -= x;
+
+  std::vector<double> std_y(size);
+  viennacl::copy(y, std_y);
+  if (std_y != std_x)
+  {
+    std::cout << "# Error: Wrong result of vector operations" << std::endl;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
+
+
+//
+// -------------------------------------------------------------
+//
+int main()
+{
+  std::cout << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << "## Test :: Host Memory" << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << std::endl;
+
+  if (test_static_partition() != EXIT_SUCCESS || test_schedule_partition() != EXIT_SUCCESS || test_csr_partition() != EXIT_SUCCESS)
+    return EXIT_FAILURE;
+
+  std::size_t sizes[4] = { 1, 4097, 65536, 3000001 };
+  for (std::size_t i=0; i<4; ++i)
+    if (test_placement(sizes[i]) != EXIT_SUCCESS)
+      return EXIT_FAILURE;
+
+  if (test_csr_placement(100) != EXIT_SUCCESS || test_csr_placement(20000) != EXIT_SUCCESS)
+    return EXIT_FAILURE;
+
+  for (std::size_t i=0; i<4; ++i)
+    if (test_transfers(sizes[i]) != EXIT_SUCCESS)
+      return EXIT_FAILURE;
+
+  if (test_memory_pool() != EXIT_SUCCESS)
+    return EXIT_FAILURE;
+
+  if (test_vector(10) != EXIT_SUCCESS || test_vector(100003) != EXIT_SUCCESS)
+    return EXIT_FAILURE;
+
+  std::cout << std::endl;
+  std::cout << "------- Test completed --------" << std::endl;
+  std::cout << std::endl;
+
+  return EXIT_SUCCESS;
+}
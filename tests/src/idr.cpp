@@ -0,0 +1,180 @@
+/* =========================================================================
+   Copyright (c) 2010-2016, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+   Portions of this software are copyright by UChicago Argonne, LLC.
+
+                            -----------------
+                  ViennaCL - The Vienna Computing Library
+                            -----------------
+
+   Project Head:    Karl Rupp                   rupp@iue.tuwien.ac.at
+
+   (A list of authors and contributors can be found in the PDF manual)
+
+   License:         MIT (X11), see file LICENSE in the base directory
+============================================================================= */
+
+
+
+/** \file tests/src/idr.cpp  Tests the IDR(s) solver on nonsymmetric systems.
+*   \test  Tests the IDR(s) solver on nonsymmetric systems.
+**/
+
+//
+// *** System
+//
+#include <iostream>
+#include <vector>
+#include <map>
+#include <cmath>
+
+
+//
+// *** ViennaCL
+//
+#include "viennacl/scalar.hpp"
+#include "viennacl/vector.hpp"
+#include "viennacl/compressed_matrix.hpp"
+#include "viennacl/linalg/prod.hpp"
+#include "viennacl/linalg/norm_2.hpp"
+#include "viennacl/linalg/bicgstab.hpp"
+#include "viennacl/linalg/idr.hpp"
+#include "viennacl/linalg/ilu.hpp"
+
+#include "sparse_test_systems.hpp"
+
+//
+// -------------------------------------------------------------
+//
+template<typename NumericT>
+int test(NumericT epsilon, double tol)
+{
+  viennacl::compressed_matrix<NumericT> A;
+  convection_diffusion_2d(A, 30, NumericT(0.8), NumericT(0));
+  viennacl::vector<NumericT> b = viennacl::scalar_vector<NumericT>(A.size1(), NumericT(1));
+
+  viennacl::linalg::bicgstab_tag bicgstab_tag(tol, 2000);
+  viennacl::vector<NumericT> x = viennacl::linalg::solve(A, b, bicgstab_tag);
+  std::cout << "BiCGStab: " << 2 * bicgstab_tag.iters() << " matrix-vector products, relative residual: " << relative_residual(A, b, x) << std::endl;
+
+  std::size_t idr4_iters = 0;
+  for (std::size_t s = 1; s <= 8; s *= 2)
+  {
+    std::cout << "Testing IDR(" << s << ")..." << std::endl;
+    viennacl::linalg::idr_tag tag(tol, 2000, s);
+    x = viennacl::linalg::solve(A, b, tag);
+    NumericT residual = relative_residual(A, b, x);
+    std::cout << "  matrix-vector products: " << tag.iters() << ", relative residual: " << residual << " (estimate: " << tag.error() << ")" << std::endl;
+    if (residual > epsilon || tag.iters() >= tag.max_iterations())
+    {
+      std::cout << "# Error at operation: IDR(" << s << ")" << std::endl;
+      return EXIT_FAILURE;
+    }
+    if (s == 4)
+      idr4_iters = tag.iters();
+  }
+
+  if (10 * idr4_iters > 12 * 2 * bicgstab_tag.iters()) // allow for the residual replacements in single precision
+  {
+    std::cout << "# Error at operation: IDR(4) needs considerably more matrix-vector products than BiCGStab" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::cout << "Testing IDR(4) with ILU0 preconditioner..." << std::endl;
+  {
+    viennacl::linalg::ilu0_precond< viennacl::compressed_matrix<NumericT> > ilu0(A, viennacl::linalg::ilu0_tag());
+    viennacl::linalg::idr_tag tag(tol, 2000, 4);
+    x = viennacl::linalg::solve(A, b, tag, ilu0);
+    NumericT residual = relative_residual(A, b, x);
+    std::cout << "  matrix-vector products: " << tag.iters() << ", relative residual: " << residual << std::endl;
+    if (residual > epsilon || tag.iters() >= idr4_iters)
+    {
+      std::cout << "# Error at operation: IDR(4) with ILU0" << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  std::cout << "Testing idr_solver with initial guess and monitor..." << std::endl;
+  {
+    viennacl::linalg::idr_tag tag(tol, 2000, 4);
+    viennacl::linalg::idr_solver< viennacl::vector<NumericT> > solver(tag);
+    monitor_data<NumericT> data;
+    solver.set_monitor(monitor<NumericT>, &data);
+
+    viennacl::vector<NumericT> guess = viennacl::scalar_vector<NumericT>(A.size1(), NumericT(0.5));
+    solver.set_initial_guess(guess);
+    x = solver(A, b);
+    NumericT residual = relative_residual(A, b, x);
+    std::cout << "  matrix-vector products: " << solver.tag().iters() << ", monitor calls: " << data.calls << ", relative residual: " << residual << std::endl;
+    if (residual > epsilon || data.calls == 0 || data.calls > solver.tag().iters() || std::fabs(data.last_residual - NumericT(solver.tag().error())) > epsilon)
+    {
+      std::cout << "# Error at operation: idr_solver" << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
+
+
+//
+// -------------------------------------------------------------
+//
+int main()
+{
+  std::cout << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << "## Test :: IDR(s)" << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << std::endl;
+
+  int retval = EXIT_SUCCESS;
+
+  std::cout << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << std::endl;
+  {
+    typedef float NumericT;
+    NumericT epsilon = static_cast<NumericT>(1E-3);
+    std::cout << "# Testing setup:" << std::endl;
+    std::cout << "  eps:     " << epsilon << std::endl;
+    std::cout << "  numeric: float" << std::endl;
+    retval = test<NumericT>(epsilon, 1e-5);
+    if ( retval == EXIT_SUCCESS )
+        std::cout << "# Test passed" << std::endl;
+    else
+        return retval;
+  }
+  std::cout << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << std::endl;
+#ifdef VIENNACL_WITH_OPENCL
+  if ( viennacl::ocl::current_device().double_support() )
+#endif
+  {
+    {
+      typedef double NumericT;
+      NumericT epsilon = 1.0E-9;
+      std::cout << "# Testing setup:" << std::endl;
+      std::cout << "  eps:     " << epsilon << std::endl;
+      std::cout << "  numeric: double" << std::endl;
+      retval = test<NumericT>(epsilon, 1e-10);
+      if ( retval == EXIT_SUCCESS )
+        std::cout << "# Test passed" << std::endl;
+      else
+        return retval;
+    }
+    std::cout << std::endl;
+    std::cout << "----------------------------------------------" << std::endl;
+    std::cout << std::endl;
+  }
+
+  std::cout << std::endl;
+  std::cout << "------- Test completed --------" << std::endl;
+  std::cout << std::endl;
+
+  return retval;
+}
@@ -0,0 +1,256 @@
+/* =========================================================================
+   Copyright (c) 2010-2016, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+   Portions of this software are copyright by UChicago Argonne, LLC.
+
+                            -----------------
+                  ViennaCL - The Vienna Computing Library
+                            -----------------
+
+   Project Head:    Karl Rupp                   rupp@iue.tuwien.ac.at
+
+   (A list of authors and contributors can be found in the PDF manual)
+
+   License:         MIT (X11), see file LICENSE in the base directory
+============================================================================= */
+
+
+
+/** \file tests/src/minres.cpp  Tests the MINRES solver and its pipelined variant on symmetric indefinite systems.
+*   \test  Tests the MINRES solver and its pipelined variant on symmetric indefinite systems.
+**/
+
+//
+// *** System
+//
+#include <iostream>
+#include <vector>
+#include <map>
+#include <cmath>
+
+
+//
+// *** ViennaCL
+//
+#include "viennacl/scalar.hpp"
+#include "viennacl/vector.hpp"
+#include "viennacl/matrix.hpp"
+#include "viennacl/compressed_matrix.hpp"
+#include "viennacl/coordinate_matrix.hpp"
+#include "viennacl/linalg/prod.hpp"
+#include "viennacl/linalg/norm_2.hpp"
+#include "viennacl/linalg/minres.hpp"
+
+#include "sparse_test_systems.hpp"
+
+//
+// -------------------------------------------------------------
+//
+
+/* Sets up the saddle point matrix [A B^T; B 0], where A is the 5-point Laplacian on a square grid and B sums over 3x3 aggregates of grid points */
+template<typename NumericT>
+void saddle_point_2d(std::vector<std::map<unsigned int, NumericT> > & stl_A, std::size_t points_per_dim)
+{
+  std::size_t N = points_per_dim * points_per_dim;
+  std::size_t aggregates_per_dim = points_per_dim / 3;
+  stl_A.clear();
+  stl_A.resize(N + aggregates_per_dim * aggregates_per_dim);
+  for (std::size_t i=0; i<points_per_dim; ++i)
+    for (std::size_t j=0; j<points_per_dim; ++j)
+    {
+      unsigned int row = static_cast<unsigned int>(i * points_per_dim + j);
+      stl_A[row][row] = NumericT(4);
+      if (i > 0)                  stl_A[row][static_cast<unsigned int>(row - points_per_dim)] = NumericT(-1);
+      if (i < points_per_dim - 1) stl_A[row][static_cast<unsigned int>(row + points_per_dim)] = NumericT(-1);
+      if (j > 0)                  stl_A[row][row - 1] = NumericT(-1);
+      if (j < points_per_dim - 1) stl_A[row][row + 1] = NumericT(-1);
+
+      unsigned int aggregate = static_cast<unsigned int>(N + (i / 3) * aggregates_per_dim + j / 3);
+      stl_A[aggregate][row] = NumericT(1);
+      stl_A[row][aggregate] = NumericT(1);
+    }
+}
+
+
+/* Block diagonal preconditioner diag(A)^{-1} for the upper block and (B diag(A)^{-1} B^T)^{-1} for the lower block, both diagonal for the aggregation operator B */
+template<typename NumericT>
+class block_diagonal_precond
+{
+public:
+  block_diagonal_precond(std::size_t points_per_dim) : inv_diag_(points_per_dim * points_per_dim + (points_per_dim / 3) * (points_per_dim / 3))
+  {
+    std::vector<NumericT> host_inv_diag(inv_diag_.size(), NumericT(4.0 / 9.0));
+    for (std::size_t i=0; i<points_per_dim * points_per_dim; ++i)
+      host_inv_diag[i] = NumericT(0.25);
+    viennacl::copy(host_inv_diag, inv_diag_);
+  }
+
+  void apply(viennacl::vector<NumericT> & vec) const
+  {
+    vec = viennacl::linalg::element_prod(vec, inv_diag_);
+  }
+
+private:
+  viennacl::vector<NumericT> inv_diag_;
+};
+
+
+//
+// -------------------------------------------------------------
+//
+template<typename NumericT>
+int test(NumericT epsilon, double tol)
+{
+  std::size_t points_per_dim = 15;
+  std::vector<std::map<unsigned int, NumericT> > stl_A;
+  saddle_point_2d(stl_A, points_per_dim);
+
+  viennacl::compressed_matrix<NumericT> A;
+  viennacl::copy(stl_A, A);
+  viennacl::coordinate_matrix<NumericT> A_coo;
+  viennacl::copy(stl_A, A_coo);
+
+  std::vector<std::vector<NumericT> > host_A_dense(stl_A.size(), std::vector<NumericT>(stl_A.size()));
+  for (std::size_t i=0; i<stl_A.size(); ++i)
+    for (typename std::map<unsigned int, NumericT>::const_iterator it = stl_A[i].begin(); it != stl_A[i].end(); ++it)
+      host_A_dense[i][it->first] = it->second;
+  viennacl::matrix<NumericT> A_dense(stl_A.size(), stl_A.size());
+  viennacl::copy(host_A_dense, A_dense);
+
+  std::vector<NumericT> host_b(A.size1());
+  for (std::size_t i=0; i<host_b.size(); ++i)
+    host_b[i] = NumericT(1) + NumericT(i % 7) / NumericT(7);
+  viennacl::vector<NumericT> b(A.size1());
+  viennacl::copy(host_b, b);
+
+  std::cout << "Testing MINRES (standard)..." << std::endl;
+  viennacl::linalg::minres_tag tag(tol, 1000);
+  viennacl::vector<NumericT> x = viennacl::linalg::solve(A_dense, b, tag);
+  NumericT residual = relative_residual(A, b, x);
+  std::cout << "  iterations: " << tag.iters() << ", relative residual: " << residual << " (estimate: " << tag.error() << ")" << std::endl;
+  if (residual > epsilon || tag.iters() >= tag.max_iterations())
+  {
+    std::cout << "# Error at operation: MINRES (standard)" << std::endl;
+    return EXIT_FAILURE;
+  }
+  std::size_t standard_iters = tag.iters();
+
+  std::cout << "Testing MINRES (pipelined, compressed_matrix)..." << std::endl;
+  viennacl::linalg::minres_tag pipelined_tag(tol, 1000);
+  x = viennacl::linalg::solve(A, b, pipelined_tag);
+  residual = relative_residual(A, b, x);
+  std::cout << "  iterations: " << pipelined_tag.iters() << ", relative residual: " << residual << " (estimate: " << pipelined_tag.error() << ")" << std::endl;
+  if (residual > epsilon || 10 * pipelined_tag.iters() > 11 * standard_iters)
+  {
+    std::cout << "# Error at operation: MINRES (pipelined, compressed_matrix)" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::cout << "Testing MINRES (pipelined, coordinate_matrix)..." << std::endl;
+  pipelined_tag = viennacl::linalg::minres_tag(tol, 1000);
+  x = viennacl::linalg::solve(A_coo, b, pipelined_tag);
+  residual = relative_residual(A, b, x);
+  std::cout << "  iterations: " << pipelined_tag.iters() << ", relative residual: " << residual << std::endl;
+  if (residual > epsilon || 10 * pipelined_tag.iters() > 11 * standard_iters)
+  {
+    std::cout << "# Error at operation: MINRES (pipelined, coordinate_matrix)" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::cout << "Testing MINRES with block diagonal preconditioner..." << std::endl;
+  {
+    block_diagonal_precond<NumericT> precond(points_per_dim);
+    viennacl::linalg::minres_tag precond_tag(tol, 1000);
+    x = viennacl::linalg::solve(A, b, precond_tag, precond);
+    residual = relative_residual(A, b, x);
+    std::cout << "  iterations: " << precond_tag.iters() << ", relative residual: " << residual << std::endl;
+    if (residual > epsilon || precond_tag.iters() >= standard_iters)
+    {
+      std::cout << "# Error at operation: MINRES with block diagonal preconditioner" << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  std::cout << "Testing minres_solver with initial guess and monitor..." << std::endl;
+  {
+    viennacl::linalg::minres_solver< viennacl::vector<NumericT> > solver(viennacl::linalg::minres_tag(tol, 1000));
+    monitor_data<NumericT> data;
+    solver.set_monitor(monitor<NumericT>, &data);
+
+    viennacl::vector<NumericT> guess = viennacl::scalar_vector<NumericT>(A.size1(), NumericT(0.5));
+    solver.set_initial_guess(guess);
+    x = solver(A, b);
+    residual = relative_residual(A, b, x);
+    std::cout << "  iterations: " << solver.tag().iters() << ", monitor calls: " << data.calls << ", relative residual: " << residual << std::endl;
+    if (residual > epsilon || data.calls != solver.tag().iters() || std::fabs(data.last_residual - NumericT(solver.tag().error())) > epsilon)
+    {
+      std::cout << "# Error at operation: minres_solver" << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
+
+
+//
+// -------------------------------------------------------------
+//
+int main()
+{
+  std::cout << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << "## Test :: MINRES" << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << std::endl;
+
+  int retval = EXIT_SUCCESS;
+
+  std::cout << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << std::endl;
+  {
+    typedef float NumericT;
+    NumericT epsilon = static_cast<NumericT>(1E-3);
+    std::cout << "# Testing setup:" << std::endl;
+    std::cout << "  eps:     " << epsilon << std::endl;
+    std::cout << "  numeric: float" << std::endl;
+    retval = test<NumericT>(epsilon, 1e-5);
+    if ( retval == EXIT_SUCCESS )
+        std::cout << "# Test passed" << std::endl;
+    else
+        return retval;
+  }
+  std::cout << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << std::endl;
+#ifdef VIENNACL_WITH_OPENCL
+  if ( viennacl::ocl::current_device().double_support() )
+#endif
+  {
+    {
+      typedef double NumericT;
+      NumericT epsilon = 1.0E-9;
+      std::cout << "# Testing setup:" << std::endl;
+      std::cout << "  eps:     " << epsilon << std::endl;
+      std::cout << "  numeric: double" << std::endl;
+      retval = test<NumericT>(epsilon, 1e-10);
+      if ( retval == EXIT_SUCCESS )
+        std::cout << "# Test passed" << std::endl;
+      else
+        return retval;
+    }
+    std::cout << std::endl;
+    std::cout << "----------------------------------------------" << std::endl;
+    std::cout << std::endl;
+  }
+
+  std::cout << std::endl;
+  std::cout << "------- Test completed --------" << std::endl;
+  std::cout << std::endl;
+
+  return retval;
+}
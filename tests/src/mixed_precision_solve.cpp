@@ -0,0 +1,176 @@
+/* =========================================================================
+   Copyright (c) 2010-2016, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+   Portions of this software are copyright by UChicago Argonne, LLC.
+
+                            -----------------
+                  ViennaCL - The Vienna Computing Library
+                            -----------------
+
+   Project Head:    Karl Rupp                   rupp@iue.tuwien.ac.at
+
+   (A list of authors and contributors can be found in the PDF manual)
+
+   License:         MIT (X11), see file LICENSE in the base directory
+============================================================================= */
+
+
+
+/** \file tests/src/mixed_precision_solve.cpp  Tests mixed precision iterative refinement with various inner solvers and preconditioners.
+*   \test  Tests mixed precision iterative refinement with various inner solvers and preconditioners.
+**/
+
+//
+// *** System
+//
+#include <iostream>
+#include <vector>
+#include <map>
+#include <cmath>
+#include <string>
+
+
+//
+// *** ViennaCL
+//
+#include "viennacl/scalar.hpp"
+#include "viennacl/vector.hpp"
+#include "viennacl/compressed_matrix.hpp"
+#include "viennacl/linalg/prod.hpp"
+#include "viennacl/linalg/norm_2.hpp"
+#include "viennacl/linalg/cg.hpp"
+#include "viennacl/linalg/bicgstab.hpp"
+#include "viennacl/linalg/gmres.hpp"
+#include "viennacl/linalg/mixed_precision_solve.hpp"
+
+#include "sparse_test_systems.hpp"
+
+//
+// -------------------------------------------------------------
+//
+
+/* Checks that the refinement reached the outer tolerance, which is beyond single precision accuracy */
+template<typename NumericT>
+int check(std::string const & name,
+          viennacl::compressed_matrix<NumericT> const & A, viennacl::vector<NumericT> const & b, viennacl::vector<NumericT> const & x,
+          viennacl::linalg::mixed_precision_tag const & tag, NumericT epsilon)
+{
+  NumericT residual = relative_residual(A, b, x);
+  std::cout << "  " << name << ": " << tag.iters() << " refinements, " << tag.inner_iters() << " inner iterations, relative residual: " << residual << " (reported: " << tag.error() << ")" << std::endl;
+  if (!(residual <= epsilon) || tag.iters() < 2 || tag.inner_iters() < tag.iters() || std::fabs(residual - NumericT(tag.error())) > epsilon)
+  {
+    std::cout << "# Error at operation: mixed precision refinement with " << name << std::endl;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
+
+
+//
+// -------------------------------------------------------------
+//
+template<typename NumericT>
+int test(NumericT epsilon)
+{
+  viennacl::compressed_matrix<NumericT> A;
+  convection_diffusion_2d(A, 40, NumericT(0));
+  viennacl::compressed_matrix<NumericT> A_nonsym;
+  convection_diffusion_2d(A_nonsym, 40, NumericT(0.5));
+
+  std::vector<NumericT> host_b(A.size1());
+  for (std::size_t i=0; i<host_b.size(); ++i)
+    host_b[i] = NumericT(1) + NumericT(i % 11) / NumericT(11);
+  viennacl::vector<NumericT> b(A.size1());
+  viennacl::copy(host_b, b);
+
+  viennacl::linalg::mixed_precision_tag tag(epsilon / 10);
+  viennacl::vector<NumericT> x;
+
+  std::cout << "Testing inner solvers without preconditioner..." << std::endl;
+  x = viennacl::linalg::mixed_precision_solve(A, b, viennacl::linalg::cg_tag(1e-3, 1000), tag);
+  if (check("CG", A, b, x, tag, epsilon) != EXIT_SUCCESS)
+    return EXIT_FAILURE;
+
+  x = viennacl::linalg::mixed_precision_solve(A_nonsym, b, viennacl::linalg::bicgstab_tag(1e-3, 1000), tag);
+  if (check("BiCGStab", A_nonsym, b, x, tag, epsilon) != EXIT_SUCCESS)
+    return EXIT_FAILURE;
+
+  x = viennacl::linalg::mixed_precision_solve(A_nonsym, b, viennacl::linalg::gmres_tag(1e-3, 1000, 30), tag);
+  if (check("GMRES", A_nonsym, b, x, tag, epsilon) != EXIT_SUCCESS)
+    return EXIT_FAILURE;
+
+  // the outer tolerance can be passed directly:
+  x = viennacl::linalg::mixed_precision_solve(A, b, viennacl::linalg::cg_tag(1e-3, 1000), epsilon / 10);
+  if (!(relative_residual(A, b, x) <= epsilon))
+  {
+    std::cout << "# Error at operation: mixed precision refinement with outer tolerance" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::cout << "Testing inner solvers with preconditioner..." << std::endl;
+  x = viennacl::linalg::mixed_precision_solve(A, b, viennacl::linalg::cg_tag(1e-3, 1000), tag, viennacl::linalg::jacobi_tag());
+  if (check("CG + Jacobi", A, b, x, tag, epsilon) != EXIT_SUCCESS)
+    return EXIT_FAILURE;
+
+  x = viennacl::linalg::mixed_precision_solve(A_nonsym, b, viennacl::linalg::bicgstab_tag(1e-3, 1000), tag, viennacl::linalg::ilut_tag());
+  if (check("BiCGStab + ILUT", A_nonsym, b, x, tag, epsilon) != EXIT_SUCCESS)
+    return EXIT_FAILURE;
+
+  x = viennacl::linalg::mixed_precision_solve(A_nonsym, b, viennacl::linalg::gmres_tag(1e-3, 1000, 30), tag, viennacl::linalg::ilu0_tag());
+  if (check("GMRES + ILU0", A_nonsym, b, x, tag, epsilon) != EXIT_SUCCESS)
+    return EXIT_FAILURE;
+
+  x = viennacl::linalg::mixed_precision_solve(A, b, viennacl::linalg::cg_tag(1e-3, 1000), tag, viennacl::linalg::amg_tag());
+  if (check("CG + AMG", A, b, x, tag, epsilon) != EXIT_SUCCESS)
+    return EXIT_FAILURE;
+
+  return EXIT_SUCCESS;
+}
+
+
+//
+// -------------------------------------------------------------
+//
+int main()
+{
+  std::cout << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << "## Test :: Mixed Precision Iterative Refinement" << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << std::endl;
+
+  int retval = EXIT_SUCCESS;
+
+  std::cout << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << std::endl;
+#ifdef VIENNACL_WITH_OPENCL
+  if ( viennacl::ocl::current_device().double_support() )
+#endif
+  {
+    {
+      typedef double NumericT;
+      NumericT epsilon = 1.0E-10;
+      std::cout << "# Testing setup:" << std::endl;
+      std::cout << "  eps:     " << epsilon << std::endl;
+      std::cout << "  numeric: double" << std::endl;
+      retval = test<NumericT>(epsilon);
+      if ( retval == EXIT_SUCCESS )
+        std::cout << "# Test passed" << std::endl;
+      else
+        return retval;
+    }
+    std::cout << std::endl;
+    std::cout << "----------------------------------------------" << std::endl;
+    std::cout << std::endl;
+  }
+
+  std::cout << std::endl;
+  std::cout << "------- Test completed --------" << std::endl;
+  std::cout << std::endl;
+
+  return retval;
+}
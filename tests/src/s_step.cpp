@@ -0,0 +1,219 @@
+/* =========================================================================
+   Copyright (c) 2010-2016, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+   Portions of this software are copyright by UChicago Argonne, LLC.
+
+                            -----------------
+                  ViennaCL - The Vienna Computing Library
+                            -----------------
+
+   Project Head:    Karl Rupp                   rupp@iue.tuwien.ac.at
+
+   (A list of authors and contributors can be found in the PDF manual)
+
+   License:         MIT (X11), see file LICENSE in the base directory
+============================================================================= */
+
+
+
+/** \file tests/src/s_step.cpp  Tests the s-step (communication-avoiding) CG and GMRES methods.
+*   \test  Tests the s-step (communication-avoiding) CG and GMRES methods.
+**/
+
+//
+// *** System
+//
+#include <iostream>
+#include <vector>
+#include <map>
+#include <cmath>
+
+
+//
+// *** ViennaCL
+//
+#include "viennacl/scalar.hpp"
+#include "viennacl/vector.hpp"
+#include "viennacl/compressed_matrix.hpp"
+#include "viennacl/linalg/prod.hpp"
+#include "viennacl/linalg/norm_2.hpp"
+#include "viennacl/linalg/cg.hpp"
+#include "viennacl/linalg/gmres.hpp"
+#include "viennacl/linalg/jacobi_precond.hpp"
+#include "viennacl/linalg/ilu.hpp"
+
+#include "sparse_test_systems.hpp"
+
+//
+// -------------------------------------------------------------
+//
+
+/* Runs CG with s = 1, 2, 4, 8 for the given preconditioner and basis. Checks the true residual and that s-step CG needs at most twice as many iterations as CG. */
+template<typename NumericT, typename PreconditionerT>
+int test_cg(viennacl::compressed_matrix<NumericT> const & A, viennacl::vector<NumericT> const & b, PreconditionerT const & precond,
+            viennacl::linalg::s_step_basis_type basis, NumericT epsilon, double solver_tolerance)
+{
+  unsigned int reference_iterations = 0;
+  for (unsigned int s = 1; s <= 8; s *= 2)
+  {
+    viennacl::linalg::cg_tag tag(solver_tolerance, 1000);
+    tag.s_steps(s);
+    tag.s_step_basis(basis);
+    viennacl::vector<NumericT> x = viennacl::linalg::solve(A, b, tag, precond);
+    NumericT residual = relative_residual(A, b, x);
+    std::cout << "  s = " << s << ": iterations: " << tag.iters() << ", breakdowns: " << tag.s_step_breakdowns() << ", residual: " << residual << std::endl;
+
+    if (s == 1)
+      reference_iterations = tag.iters();
+    if (residual > epsilon || tag.iters() > 2 * reference_iterations)
+    {
+      std::cout << "# Error: s-step CG failed for s = " << s << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+  return EXIT_SUCCESS;
+}
+
+/* Runs GMRES with s = 1, 2, 4, 8 for the given preconditioner and basis. Checks the true residual and that s-step GMRES needs at most twice as many iterations as GMRES. */
+template<typename NumericT, typename PreconditionerT>
+int test_gmres(viennacl::compressed_matrix<NumericT> const & A, viennacl::vector<NumericT> const & b, PreconditionerT const & precond,
+               viennacl::linalg::s_step_basis_type basis, NumericT epsilon, double solver_tolerance)
+{
+  unsigned int reference_iterations = 0;
+  for (unsigned int s = 1; s <= 8; s *= 2)
+  {
+    viennacl::linalg::gmres_tag tag(solver_tolerance, 1000, 30);
+    tag.s_steps(s);
+    tag.s_step_basis(basis);
+    viennacl::vector<NumericT> x = viennacl::linalg::solve(A, b, tag, precond);
+    NumericT residual = relative_residual(A, b, x);
+    std::cout << "  s = " << s << ": iterations: " << tag.iters() << ", breakdowns: " << tag.s_step_breakdowns() << ", residual: " << residual << std::endl;
+
+    if (s == 1)
+      reference_iterations = tag.iters();
+    if (residual > epsilon || tag.iters() > 2 * reference_iterations)
+    {
+      std::cout << "# Error: s-step GMRES failed for s = " << s << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+  return EXIT_SUCCESS;
+}
+
+
+//
+// -------------------------------------------------------------
+//
+template<typename NumericT>
+int test(NumericT epsilon, double solver_tolerance)
+{
+  std::size_t points_per_dim = 30;
+  std::size_t N = points_per_dim * points_per_dim;
+  viennacl::vector<NumericT> b = viennacl::scalar_vector<NumericT>(N, NumericT(1));
+
+  viennacl::compressed_matrix<NumericT> A(N, N);
+  convection_diffusion_2d(A, points_per_dim, NumericT(0));
+
+  viennacl::linalg::jacobi_precond<viennacl::compressed_matrix<NumericT> > jacobi(A, viennacl::linalg::jacobi_tag());
+  viennacl::linalg::ilu0_precond<viennacl::compressed_matrix<NumericT> > ilu0(A, viennacl::linalg::ilu0_tag());
+
+  std::cout << "Testing s-step CG with Newton basis without preconditioner" << std::endl;
+  if (test_cg(A, b, viennacl::linalg::no_precond(), viennacl::linalg::S_STEP_NEWTON_BASIS, epsilon, solver_tolerance) != EXIT_SUCCESS)
+    return EXIT_FAILURE;
+
+  std::cout << "Testing s-step CG with Chebyshev basis without preconditioner" << std::endl;
+  if (test_cg(A, b, viennacl::linalg::no_precond(), viennacl::linalg::S_STEP_CHEBYSHEV_BASIS, epsilon, solver_tolerance) != EXIT_SUCCESS)
+    return EXIT_FAILURE;
+
+  std::cout << "Testing s-step CG with Newton basis and Jacobi preconditioner" << std::endl;
+  if (test_cg(A, b, jacobi, viennacl::linalg::S_STEP_NEWTON_BASIS, epsilon, solver_tolerance) != EXIT_SUCCESS)
+    return EXIT_FAILURE;
+
+  std::cout << "Testing s-step CG with Chebyshev basis and ILU0 preconditioner" << std::endl;
+  if (test_cg(A, b, ilu0, viennacl::linalg::S_STEP_CHEBYSHEV_BASIS, epsilon, solver_tolerance) != EXIT_SUCCESS)
+    return EXIT_FAILURE;
+
+  // nonsymmetric system for GMRES:
+  viennacl::compressed_matrix<NumericT> B(N, N);
+  convection_diffusion_2d(B, points_per_dim, NumericT(0.25));
+
+  viennacl::linalg::jacobi_precond<viennacl::compressed_matrix<NumericT> > jacobi_B(B, viennacl::linalg::jacobi_tag());
+  viennacl::linalg::ilu0_precond<viennacl::compressed_matrix<NumericT> > ilu0_B(B, viennacl::linalg::ilu0_tag());
+
+  std::cout << "Testing s-step GMRES with Newton basis and Jacobi preconditioner" << std::endl;
+  if (test_gmres(B, b, jacobi_B, viennacl::linalg::S_STEP_NEWTON_BASIS, epsilon, solver_tolerance) != EXIT_SUCCESS)
+    return EXIT_FAILURE;
+
+  std::cout << "Testing s-step GMRES with Chebyshev basis and Jacobi preconditioner" << std::endl;
+  if (test_gmres(B, b, jacobi_B, viennacl::linalg::S_STEP_CHEBYSHEV_BASIS, epsilon, solver_tolerance) != EXIT_SUCCESS)
+    return EXIT_FAILURE;
+
+  std::cout << "Testing s-step GMRES with Newton basis and ILU0 preconditioner" << std::endl;
+  if (test_gmres(B, b, ilu0_B, viennacl::linalg::S_STEP_NEWTON_BASIS, epsilon, solver_tolerance) != EXIT_SUCCESS)
+    return EXIT_FAILURE;
+
+  return EXIT_SUCCESS;
+}
+
+
+//
+// -------------------------------------------------------------
+//
+int main()
+{
+  std::cout << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << "## Test :: s-step Krylov Solvers" << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << std::endl;
+
+  int retval = EXIT_SUCCESS;
+
+  std::cout << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << std::endl;
+  {
+    typedef float NumericT;
+    NumericT epsilon = static_cast<NumericT>(1E-2);
+    std::cout << "# Testing setup:" << std::endl;
+    std::cout << "  eps:     " << epsilon << std::endl;
+    std::cout << "  numeric: float" << std::endl;
+    retval = test<NumericT>(epsilon, 1e-3);
+    if ( retval == EXIT_SUCCESS )
+        std::cout << "# Test passed" << std::endl;
+    else
+        return retval;
+  }
+  std::cout << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << std::endl;
+#ifdef VIENNACL_WITH_OPENCL
+  if ( viennacl::ocl::current_device().double_support() )
+#endif
+  {
+    {
+      typedef double NumericT;
+      NumericT epsilon = 1.0E-9;
+      std::cout << "# Testing setup:" << std::endl;
+      std::cout << "  eps:     " << epsilon << std::endl;
+      std::cout << "  numeric: double" << std::endl;
+      retval = test<NumericT>(epsilon, 1e-10);
+      if ( retval == EXIT_SUCCESS )
+        std::cout << "# Test passed" << std::endl;
+      else
+        return retval;
+    }
+    std::cout << std::endl;
+    std::cout << "----------------------------------------------" << std::endl;
+    std::cout << std::endl;
+  }
+
+  std::cout << std::endl;
+  std::cout << "------- Test completed --------" << std::endl;
+  std::cout << std::endl;
+
+  return retval;
+}
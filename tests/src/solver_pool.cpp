@@ -0,0 +1,357 @@
+/* =========================================================================
+   Copyright (c) 2010-2016, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+   Portions of this software are copyright by UChicago Argonne, LLC.
+
+                            -----------------
+                  ViennaCL - The Vienna Computing Library
+                            -----------------
+
+   Project Head:    Karl Rupp                   rupp@iue.tuwien.ac.at
+
+   (A list of authors and contributors can be found in the PDF manual)
+
+   License:         MIT (X11), see file LICENSE in the base directory
+============================================================================= */
+
+
+
+/** \file tests/src/solver_pool.cpp  Tests the concurrent execution of independent solves in a solver pool.
+*   \test  Tests the concurrent execution of independent solves in a solver pool.
+**/
+
+//
+// *** System
+//
+#include <iostream>
+#include <vector>
+#include <map>
+#include <cmath>
+#include <stdexcept>
+
+#ifdef VIENNACL_WITH_OPENMP
+#include <omp.h>
+#endif
+
+
+//
+// *** ViennaCL
+//
+#include "viennacl/scalar.hpp"
+#include "viennacl/vector.hpp"
+#include "viennacl/compressed_matrix.hpp"
+#include "viennacl/linalg/prod.hpp"
+#include "viennacl/linalg/norm_2.hpp"
+#include "viennacl/linalg/cg.hpp"
+#include "viennacl/linalg/bicgstab.hpp"
+#include "viennacl/linalg/jacobi_precond.hpp"
+#include "viennacl/linalg/solver_pool.hpp"
+
+#include "sparse_test_systems.hpp"
+
+//
+// -------------------------------------------------------------
+//
+
+
+/* Identity preconditioner recording the thread budget available to the host kernels of the solve */
+class thread_budget_precond
+{
+public:
+  thread_budget_precond() : max_threads_(0) {}
+
+  template<typename VectorT>
+  void apply(VectorT &) const
+  {
+#ifdef VIENNACL_WITH_OPENMP
+    max_threads_ = omp_get_max_threads();
+#else
+    max_threads_ = 1;
+#endif
+  }
+
+  int max_threads() const { return max_threads_; }
+
+private:
+  mutable int max_threads_;
+};
+
+/* Identity preconditioner detecting concurrent calls of its apply phase, as for preconditioners with mutable work vectors */
+class exclusive_precond
+{
+public:
+  exclusive_precond() : active_(0), overlapped_(false) {}
+
+  template<typename VectorT>
+  void apply(VectorT & x) const
+  {
+#ifdef VIENNACL_WITH_OPENMP
+    #pragma omp critical (exclusive_precond)
+#endif
+    {
+      if (++active_ > 1)
+        overlapped_ = true;
+    }
+
+    // keep the apply phase busy for a while:
+    typename VectorT::cpu_value_type sum = 0;
+    for (std::size_t i=0; i<50; ++i)
+      sum += viennacl::linalg::norm_2(x);
+    if (sum <= 0)
+      x.clear();
+
+#ifdef VIENNACL_WITH_OPENMP
+    #pragma omp critical (exclusive_precond)
+#endif
+    {
+      --active_;
+    }
+  }
+
+  bool overlapped() const { return overlapped_; }
+
+private:
+  mutable int active_;
+  mutable bool overlapped_;
+};
+
+/* Preconditioner failing in its apply phase */
+class failing_precond
+{
+public:
+  template<typename VectorT>
+  void apply(VectorT &) const { throw std::runtime_error("failing_precond"); }
+};
+
+
+//
+// -------------------------------------------------------------
+//
+template<typename NumericT>
+int test(NumericT epsilon, double tol)
+{
+  typedef viennacl::compressed_matrix<NumericT>   MatrixType;
+  typedef viennacl::vector<NumericT>              VectorType;
+
+  std::size_t num_systems = 12;
+  std::vector<MatrixType> A(num_systems);
+  for (std::size_t i=0; i<num_systems; ++i)
+    laplace_2d(A[i], 30, NumericT(i) / NumericT(10));
+  VectorType b = viennacl::scalar_vector<NumericT>(A[0].size1(), NumericT(1));
+
+  std::vector< viennacl::linalg::jacobi_precond<MatrixType> > jacobi;
+  for (std::size_t i=0; i<num_systems; ++i)
+    jacobi.push_back(viennacl::linalg::jacobi_precond<MatrixType>(A[i], viennacl::linalg::jacobi_tag()));
+
+  std::cout << "Testing solves in a solver pool..." << std::endl;
+  {
+    viennacl::linalg::solver_pool pool(2);
+    std::cout << "  threads per solve: " << pool.threads_per_solve() << ", concurrent solves: " << pool.concurrent_solves() << std::endl;
+
+    std::vector< viennacl::linalg::solve_future<VectorType, viennacl::linalg::cg_tag> >       cg_futures;
+    std::vector< viennacl::linalg::solve_future<VectorType, viennacl::linalg::bicgstab_tag> > bicgstab_futures;
+    for (std::size_t i=0; i<num_systems; ++i)
+    {
+      if (i % 2)
+        cg_futures.push_back(pool.solve_async(A[i], b, viennacl::linalg::cg_tag(tol, 1000), jacobi[i]));
+      else
+        bicgstab_futures.push_back(pool.solve_async(A[i], b, viennacl::linalg::bicgstab_tag(tol, 1000)));
+    }
+
+    if (pool.pending() != num_systems || cg_futures[0].ready())
+    {
+      std::cout << "# Error at operation: solves queued in the pool" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // the first access to a result runs all queued solves:
+    VectorType x = cg_futures.back().get();
+    if (pool.pending() != 0 || !bicgstab_futures[0].ready())
+    {
+      std::cout << "# Error at operation: running the pool" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // iteration counts may differ from a synchronous solve, since the thread budget changes the summation order in reductions. Hence only the residuals are checked:
+    for (std::size_t i=0; i<num_systems; ++i)
+    {
+      NumericT residual;
+      unsigned int iters;
+      if (i % 2)
+      {
+        residual = relative_residual(A[i], b, cg_futures[i / 2].get());
+        iters = cg_futures[i / 2].tag().iters();
+      }
+      else
+      {
+        residual = relative_residual(A[i], b, bicgstab_futures[i / 2].get());
+        iters = bicgstab_futures[i / 2].tag().iters();
+      }
+      std::cout << "  system " << i << ": " << iters << " iterations, relative residual " << residual << std::endl;
+      if (residual > epsilon || iters == 0)
+      {
+        std::cout << "# Error at operation: solve of system " << i << " in the pool" << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+  }
+
+  std::cout << "Testing thread budget of the host kernels..." << std::endl;
+  {
+    viennacl::linalg::solver_pool pool(2, 4);
+    std::vector<thread_budget_precond> budget(4);
+    std::vector< viennacl::linalg::solve_future<VectorType, viennacl::linalg::cg_tag> > futures;
+    for (std::size_t i=0; i<budget.size(); ++i)
+      futures.push_back(pool.solve_async(A[i], b, viennacl::linalg::cg_tag(tol, 5), budget[i]));
+    pool.run();
+    for (std::size_t i=0; i<budget.size(); ++i)
+    {
+      std::cout << "  solve " << i << ": " << budget[i].max_threads() << " threads" << std::endl;
+#ifdef VIENNACL_WITH_OPENMP
+      if (budget[i].max_threads() != 2)
+#else
+      if (budget[i].max_threads() != 1)
+#endif
+      {
+        std::cout << "# Error at operation: thread budget" << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+  }
+
+  std::cout << "Testing solves sharing a preconditioner..." << std::endl;
+  {
+    viennacl::linalg::solver_pool pool(1, 4);
+    exclusive_precond shared;
+    std::vector< viennacl::linalg::solve_future<VectorType, viennacl::linalg::cg_tag> > futures;
+    for (std::size_t i=0; i<4; ++i)
+      futures.push_back(pool.solve_async(A[i], b, viennacl::linalg::cg_tag(tol, 20), shared));
+    pool.run();
+    if (shared.overlapped())
+    {
+      std::cout << "# Error at operation: shared preconditioner applied concurrently" << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  std::cout << "Testing default solver pool..." << std::endl;
+  {
+    viennacl::linalg::solve_future<VectorType, viennacl::linalg::cg_tag> future = viennacl::linalg::solve_async(A[3], b, viennacl::linalg::cg_tag(tol, 1000));
+    NumericT residual = relative_residual(A[3], b, future.get());
+    if (residual > epsilon || viennacl::linalg::default_solver_pool().pending() != 0)
+    {
+      std::cout << "# Error at operation: default solver pool" << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  std::cout << "Testing failing solve..." << std::endl;
+  {
+    viennacl::linalg::solver_pool pool;
+    failing_precond failing;
+    viennacl::linalg::solve_future<VectorType, viennacl::linalg::cg_tag> bad  = pool.solve_async(A[0], b, viennacl::linalg::cg_tag(tol, 1000), failing);
+    viennacl::linalg::solve_future<VectorType, viennacl::linalg::cg_tag> good = pool.solve_async(A[1], b, viennacl::linalg::cg_tag(tol, 1000));
+    bool caught = false;
+    try
+    {
+      bad.get();
+    }
+    catch (std::runtime_error const &)
+    {
+      caught = true;
+    }
+    if (!caught || relative_residual(A[1], b, good.get()) > epsilon)
+    {
+      std::cout << "# Error at operation: failing solve" << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  std::cout << "Testing destruction of a pool with pending solves..." << std::endl;
+  {
+    viennacl::linalg::solve_future<VectorType, viennacl::linalg::cg_tag> discarded;
+    {
+      viennacl::linalg::solver_pool pool;
+      discarded = pool.solve_async(A[0], b, viennacl::linalg::cg_tag(tol, 1000));
+    }
+    bool caught = false;
+    try
+    {
+      discarded.get();
+    }
+    catch (std::runtime_error const &)
+    {
+      caught = true;
+    }
+    if (!discarded.ready() || !caught)
+    {
+      std::cout << "# Error at operation: destruction of pool" << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
+
+
+//
+// -------------------------------------------------------------
+//
+int main()
+{
+  std::cout << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << "## Test :: Solver Pool" << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << std::endl;
+
+  int retval = EXIT_SUCCESS;
+
+  std::cout << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << std::endl;
+  {
+    typedef float NumericT;
+    NumericT epsilon = static_cast<NumericT>(1E-3);
+    std::cout << "# Testing setup:" << std::endl;
+    std::cout << "  eps:     " << epsilon << std::endl;
+    std::cout << "  numeric: float" << std::endl;
+    retval = test<NumericT>(epsilon, 1e-5);
+    if ( retval == EXIT_SUCCESS )
+        std::cout << "# Test passed" << std::endl;
+    else
+        return retval;
+  }
+  std::cout << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << std::endl;
+#ifdef VIENNACL_WITH_OPENCL
+  if ( viennacl::ocl::current_device().double_support() )
+#endif
+  {
+    {
+      typedef double NumericT;
+      NumericT epsilon = 1.0E-9;
+      std::cout << "# Testing setup:" << std::endl;
+      std::cout << "  eps:     " << epsilon << std::endl;
+      std::cout << "  numeric: double" << std::endl;
+      retval = test<NumericT>(epsilon, 1e-10);
+      if ( retval == EXIT_SUCCESS )
+        std::cout << "# Test passed" << std::endl;
+      else
+        return retval;
+    }
+    std::cout << std::endl;
+    std::cout << "----------------------------------------------" << std::endl;
+    std::cout << std::endl;
+  }
+
+  std::cout << std::endl;
+  std::cout << "------- Test completed --------" << std::endl;
+  std::cout << std::endl;
+
+  return retval;
+}
@@ -0,0 +1,312 @@
+/* =========================================================================
+   Copyright (c) 2010-2016, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+   Portions of this software are copyright by UChicago Argonne, LLC.
+
+                            -----------------
+                  ViennaCL - The Vienna Computing Library
+                            -----------------
+
+   Project Head:    Karl Rupp                   rupp@iue.tuwien.ac.at
+
+   (A list of authors and contributors can be found in the PDF manual)
+
+   License:         MIT (X11), see file LICENSE in the base directory
+============================================================================= */
+
+
+
+/** \file tests/src/sparse_add.cpp  Tests sums alpha * A + beta * B of sparse matrices.
+*   \test  Tests sums alpha * A + beta * B of sparse matrices.
+**/
+
+//
+// *** System
+//
+#include <iostream>
+#include <vector>
+#include <map>
+#include <cmath>
+#include <algorithm>
+
+
+//
+// *** ViennaCL
+//
+#include "viennacl/scalar.hpp"
+#include "viennacl/compressed_matrix.hpp"
+#include "viennacl/coordinate_matrix.hpp"
+#include "viennacl/linalg/sparse_matrix_operations.hpp"
+
+#include "viennacl/tools/random.hpp"
+
+#include "sparse_test_systems.hpp"
+
+//
+// -------------------------------------------------------------
+//
+
+/* Computes alpha * A + beta * B for the reference implementation. Entries of the union of the patterns are kept even if they cancel. */
+template<typename NumericT>
+std::vector<std::map<unsigned int, NumericT> > stl_add(std::vector<std::map<unsigned int, NumericT> > const & A, NumericT alpha,
+                                                       std::vector<std::map<unsigned int, NumericT> > const & B, NumericT beta)
+{
+  std::vector<std::map<unsigned int, NumericT> > C(A.size());
+  for (std::size_t i=0; i<A.size(); ++i)
+  {
+    for (typename std::map<unsigned int, NumericT>::const_iterator it = A[i].begin(); it != A[i].end(); ++it)
+      C[i][it->first] += alpha * it->second;
+    for (typename std::map<unsigned int, NumericT>::const_iterator it = B[i].begin(); it != B[i].end(); ++it)
+      C[i][it->first] += beta * it->second;
+  }
+  return C;
+}
+
+/* Fills the entries of a sparse matrix with new random values, keeping the sparsity pattern */
+template<typename NumericT>
+void randomize_values(std::vector<std::map<unsigned int, NumericT> > & A)
+{
+  viennacl::tools::uniform_random_numbers<NumericT> randomNumber;
+  for (std::size_t i=0; i<A.size(); ++i)
+    for (typename std::map<unsigned int, NumericT>::iterator it = A[i].begin(); it != A[i].end(); ++it)
+      it->second = NumericT(1) + randomNumber();
+}
+
+
+//
+// -------------------------------------------------------------
+//
+template< typename NumericT, typename Epsilon >
+int test(Epsilon const& epsilon, std::size_t N, std::size_t M, std::size_t nnz_row)
+{
+  int retval = EXIT_SUCCESS;
+
+  viennacl::tools::uniform_random_numbers<NumericT> randomNumber;
+
+  std::cout << "Matrix size: " << N << "x" << M << std::endl;
+
+  std::vector<std::map<unsigned int, NumericT> > stl_A(N);
+  std::vector<std::map<unsigned int, NumericT> > stl_B(N);
+  std::vector<std::map<unsigned int, NumericT> > stl_I(N);
+
+  for (std::size_t i=0; i<N; ++i)
+  {
+    if (i % 7 != 3) // some empty rows in A
+      for (std::size_t j=0; j<nnz_row; ++j)
+        stl_A[i][static_cast<unsigned int>(randomNumber() * NumericT(M))] = NumericT(1) + randomNumber();
+    if (i % 11 != 5) // some empty rows in B
+      for (std::size_t j=0; j<nnz_row; ++j)
+        stl_B[i][static_cast<unsigned int>(randomNumber() * NumericT(M))] = NumericT(1) + randomNumber();
+    if (i < M)
+      stl_I[i][static_cast<unsigned int>(i)] = NumericT(1);
+  }
+
+  NumericT alpha = NumericT(2.5);
+  NumericT beta  = NumericT(-0.75);
+
+  //
+  // compressed_matrix:
+  //
+  std::cout << "Testing spgeam() for compressed_matrix" << std::endl;
+  viennacl::compressed_matrix<NumericT> vcl_A(N, M);
+  viennacl::compressed_matrix<NumericT> vcl_B(N, M);
+  viennacl::compressed_matrix<NumericT> vcl_I(N, M);
+  viennacl::copy(viennacl::tools::const_sparse_matrix_adapter<NumericT>(stl_A, N, M), vcl_A);
+  viennacl::copy(viennacl::tools::const_sparse_matrix_adapter<NumericT>(stl_B, N, M), vcl_B);
+  viennacl::copy(viennacl::tools::const_sparse_matrix_adapter<NumericT>(stl_I, N, M), vcl_I);
+
+  viennacl::compressed_matrix<NumericT> vcl_C;
+  viennacl::linalg::spgeam(vcl_A, alpha, vcl_B, beta, vcl_C);
+  retval = check_sparse_matrix(vcl_C, stl_add(stl_A, alpha, stl_B, beta), epsilon, "spgeam() for compressed_matrix");
+  if (retval != EXIT_SUCCESS)
+    return retval;
+
+  std::cout << "Testing A - sigma * I for compressed_matrix" << std::endl;
+  NumericT sigma = NumericT(0.5);
+  viennacl::linalg::spgeam(vcl_A, NumericT(1), vcl_I, -sigma, vcl_C);
+  retval = check_sparse_matrix(vcl_C, stl_add(stl_A, NumericT(1), stl_I, -sigma), epsilon, "A - sigma * I for compressed_matrix");
+  if (retval != EXIT_SUCCESS)
+    return retval;
+
+  std::cout << "Testing spgeam_numeric() with reused plan for compressed_matrix" << std::endl;
+  viennacl::linalg::spgeam_plan plan = viennacl::linalg::spgeam_symbolic(vcl_A, vcl_B);
+  if (plan.patterns_equal())
+  {
+    std::cout << "# Error: Different sparsity patterns detected as equal" << std::endl;
+    return EXIT_FAILURE;
+  }
+  for (std::size_t run=0; run<2; ++run)
+  {
+    randomize_values(stl_A);
+    randomize_values(stl_B);
+    viennacl::copy(viennacl::tools::const_sparse_matrix_adapter<NumericT>(stl_A, N, M), vcl_A);
+    viennacl::copy(viennacl::tools::const_sparse_matrix_adapter<NumericT>(stl_B, N, M), vcl_B);
+    viennacl::linalg::spgeam_numeric(plan, vcl_A, alpha, vcl_B, beta, vcl_C);
+    retval = check_sparse_matrix(vcl_C, stl_add(stl_A, alpha, stl_B, beta), epsilon, "spgeam_numeric() with reused plan for compressed_matrix");
+    if (retval != EXIT_SUCCESS)
+      return retval;
+  }
+
+  std::cout << "Testing spgeam() with identical patterns for compressed_matrix" << std::endl;
+  std::vector<std::map<unsigned int, NumericT> > stl_A2 = stl_A;
+  randomize_values(stl_A2);
+  viennacl::compressed_matrix<NumericT> vcl_A2(N, M);
+  viennacl::copy(viennacl::tools::const_sparse_matrix_adapter<NumericT>(stl_A2, N, M), vcl_A2);
+  viennacl::linalg::spgeam_plan plan_equal = viennacl::linalg::spgeam_symbolic(vcl_A, vcl_A2);
+  if (!plan_equal.patterns_equal())
+  {
+    std::cout << "# Error: Identical sparsity patterns not detected" << std::endl;
+    return EXIT_FAILURE;
+  }
+  viennacl::linalg::spgeam_numeric(plan_equal, vcl_A, alpha, vcl_A2, beta, vcl_C);
+  retval = check_sparse_matrix(vcl_C, stl_add(stl_A, alpha, stl_A2, beta), epsilon, "spgeam() with identical patterns for compressed_matrix");
+  if (retval != EXIT_SUCCESS)
+    return retval;
+
+  std::cout << "Testing C = C + beta * B in place for compressed_matrix" << std::endl;
+  viennacl::linalg::spgeam_numeric(plan, vcl_A, alpha, vcl_B, beta, vcl_C);
+  std::vector<std::map<unsigned int, NumericT> > stl_C = stl_add(stl_A, alpha, stl_B, beta);
+  viennacl::linalg::spgeam_plan plan_inplace = viennacl::linalg::spgeam_symbolic(vcl_C, vcl_B);
+  char const * C_elements_before = vcl_C.handle().ram_handle().get();
+  viennacl::linalg::spgeam_numeric(plan_inplace, vcl_C, NumericT(1), vcl_B, beta, vcl_C);
+  if (vcl_C.handle().ram_handle().get() != C_elements_before)
+  {
+    std::cout << "# Error: C reallocated although it holds the pattern of the sum" << std::endl;
+    return EXIT_FAILURE;
+  }
+  retval = check_sparse_matrix(vcl_C, stl_add(stl_C, NumericT(1), stl_B, beta), epsilon, "C = C + beta * B in place for compressed_matrix");
+  if (retval != EXIT_SUCCESS)
+    return retval;
+
+  std::cout << "Testing A = alpha * A + beta * B for compressed_matrix" << std::endl;
+  viennacl::linalg::spgeam_numeric(plan, vcl_A, alpha, vcl_B, beta, vcl_A);
+  retval = check_sparse_matrix(vcl_A, stl_add(stl_A, alpha, stl_B, beta), epsilon, "A = alpha * A + beta * B for compressed_matrix");
+  if (retval != EXIT_SUCCESS)
+    return retval;
+
+  //
+  // coordinate_matrix:
+  //
+  std::cout << "Testing spgeam() for coordinate_matrix" << std::endl;
+  viennacl::coordinate_matrix<NumericT> vcl_coo_A(N, M);
+  viennacl::coordinate_matrix<NumericT> vcl_coo_B(N, M);
+  viennacl::copy(viennacl::tools::const_sparse_matrix_adapter<NumericT>(stl_A, N, M), vcl_coo_A);
+  viennacl::copy(viennacl::tools::const_sparse_matrix_adapter<NumericT>(stl_B, N, M), vcl_coo_B);
+
+  viennacl::coordinate_matrix<NumericT> vcl_coo_C;
+  viennacl::linalg::spgeam(vcl_coo_A, alpha, vcl_coo_B, beta, vcl_coo_C);
+  retval = check_sparse_matrix(vcl_coo_C, stl_add(stl_A, alpha, stl_B, beta), epsilon, "spgeam() for coordinate_matrix");
+  if (retval != EXIT_SUCCESS)
+    return retval;
+
+  std::cout << "Testing spgeam_numeric() with reused plan for coordinate_matrix" << std::endl;
+  viennacl::linalg::spgeam_plan coo_plan = viennacl::linalg::spgeam_symbolic(vcl_coo_A, vcl_coo_B);
+  randomize_values(stl_A);
+  viennacl::copy(viennacl::tools::const_sparse_matrix_adapter<NumericT>(stl_A, N, M), vcl_coo_A);
+  viennacl::linalg::spgeam_numeric(coo_plan, vcl_coo_A, alpha, vcl_coo_B, beta, vcl_coo_C);
+  retval = check_sparse_matrix(vcl_coo_C, stl_add(stl_A, alpha, stl_B, beta), epsilon, "spgeam_numeric() with reused plan for coordinate_matrix");
+  if (retval != EXIT_SUCCESS)
+    return retval;
+
+  std::cout << "Testing spgeam_numeric() for coordinate_matrix with entries in reverse order" << std::endl;
+  {
+    // reverse the order of the entries of A, which is still a valid coordinate matrix:
+    unsigned int * coords   = viennacl::linalg::host_based::detail::extract_raw_pointer<unsigned int>(vcl_coo_A.handle12());
+    NumericT     * elements = viennacl::linalg::host_based::detail::extract_raw_pointer<NumericT>(vcl_coo_A.handle());
+    for (std::size_t k=0; k<vcl_coo_A.nnz()/2; ++k)
+    {
+      std::size_t k2 = vcl_coo_A.nnz() - 1 - k;
+      std::swap(coords[2*k],   coords[2*k2]);
+      std::swap(coords[2*k+1], coords[2*k2+1]);
+      std::swap(elements[k],   elements[k2]);
+    }
+  }
+  viennacl::linalg::spgeam_plan coo_plan_reversed = viennacl::linalg::spgeam_symbolic(vcl_coo_A, vcl_coo_B);
+  char const * coo_C_elements_before = vcl_coo_C.handle().ram_handle().get();
+  for (std::size_t run=0; run<2; ++run)
+  {
+    viennacl::linalg::spgeam_numeric(coo_plan_reversed, vcl_coo_A, alpha, vcl_coo_B, beta, vcl_coo_C);
+    retval = check_sparse_matrix(vcl_coo_C, stl_add(stl_A, alpha, stl_B, beta), epsilon, "spgeam_numeric() for coordinate_matrix with entries in reverse order");
+    if (retval != EXIT_SUCCESS)
+      return retval;
+  }
+  if (vcl_coo_C.handle().ram_handle().get() != coo_C_elements_before)
+  {
+    std::cout << "# Error: Pattern of C rewritten although C holds the pattern of the sum" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return retval;
+}
+
+template< typename NumericT, typename Epsilon >
+int test(Epsilon const& epsilon)
+{
+  int retval = test<NumericT>(epsilon, 50, 70, 5);
+  if (retval != EXIT_SUCCESS)
+    return retval;
+
+  return test<NumericT>(epsilon, 20000, 15000, 10);
+}
+
+//
+// -------------------------------------------------------------
+//
+int main()
+{
+  std::cout << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << "## Test :: Sparse Matrix Sums" << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << std::endl;
+
+  int retval = EXIT_SUCCESS;
+
+  std::cout << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << std::endl;
+  {
+    typedef float NumericT;
+    NumericT epsilon = static_cast<NumericT>(1E-4);
+    std::cout << "# Testing setup:" << std::endl;
+    std::cout << "  eps:     " << epsilon << std::endl;
+    std::cout << "  numeric: float" << std::endl;
+    retval = test<NumericT>(epsilon);
+    if ( retval == EXIT_SUCCESS )
+        std::cout << "# Test passed" << std::endl;
+    else
+        return retval;
+  }
+  std::cout << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << std::endl;
+
+#ifdef VIENNACL_WITH_OPENCL
+  if ( viennacl::ocl::current_device().double_support() )
+#endif
+  {
+    typedef double NumericT;
+    NumericT epsilon = 1.0E-12;
+    std::cout << "# Testing setup:" << std::endl;
+    std::cout << "  eps:     " << epsilon << std::endl;
+    std::cout << "  numeric: double" << std::endl;
+    retval = test<NumericT>(epsilon);
+    if ( retval == EXIT_SUCCESS )
+      std::cout << "# Test passed" << std::endl;
+    else
+      return retval;
+  }
+  std::cout << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << std::endl;
+
+
+  std::cout << std::endl;
+  std::cout << "------- Test completed --------" << std::endl;
+  std::cout << std::endl;
+
+  return retval;
+}
@@ -0,0 +1,363 @@
+/* =========================================================================
+   Copyright (c) 2010-2016, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+   Portions of this software are copyright by UChicago Argonne, LLC.
+
+                            -----------------
+                  ViennaCL - The Vienna Computing Library
+                            -----------------
+
+   Project Head:    Karl Rupp                   rupp@iue.tuwien.ac.at
+
+   (A list of authors and contributors can be found in the PDF manual)
+
+   License:         MIT (X11), see file LICENSE in the base directory
+============================================================================= */
+
+
+
+/** \file tests/src/sparse_assembly.cpp  Tests the assembly of sparse matrices from (row, column, value) triplets and pattern-preserving value updates.
+*   \test  Tests the assembly of sparse matrices from (row, column, value) triplets and pattern-preserving value updates.
+**/
+
+//
+// *** System
+//
+#include <iostream>
+#include <vector>
+#include <map>
+#include <cmath>
+
+
+//
+// *** ViennaCL
+//
+#include "viennacl/scalar.hpp"
+#include "viennacl/vector.hpp"
+#include "viennacl/compressed_matrix.hpp"
+#include "viennacl/linalg/sparse_matrix_operations.hpp"
+#include "viennacl/linalg/norm_2.hpp"
+#include "viennacl/linalg/ilu.hpp"
+#include "viennacl/linalg/amg.hpp"
+
+#include "viennacl/tools/random.hpp"
+
+#include "sparse_test_systems.hpp"
+
+//
+// -------------------------------------------------------------
+//
+template< typename NumericT, typename Epsilon >
+int test(Epsilon const& epsilon, std::size_t N, std::size_t M, std::size_t triplets_per_row)
+{
+  int retval = EXIT_SUCCESS;
+
+  viennacl::tools::uniform_random_numbers<NumericT> randomNumber;
+
+  std::cout << "Matrix size: " << N << "x" << M << std::endl;
+
+  // triplets in random order with many duplicates (as in finite element assembly), some rows empty:
+  std::vector<unsigned int> rows;
+  std::vector<unsigned int> cols;
+  std::vector<NumericT>     values;
+  std::vector<std::map<unsigned int, NumericT> > stl_A(N);
+  for (std::size_t k=0; k<N * triplets_per_row; ++k)
+  {
+    unsigned int i = static_cast<unsigned int>(randomNumber() * NumericT(N));
+    if (i >= N || i % 13 == 4)
+      continue;
+    unsigned int j = static_cast<unsigned int>((i + 37 * static_cast<unsigned int>(randomNumber() * NumericT(7))) % M); // few distinct columns per row, hence many duplicates
+    NumericT value = NumericT(1) + randomNumber();
+    rows.push_back(i);
+    cols.push_back(j);
+    values.push_back(value);
+    stl_A[i][j] += value;
+  }
+  // ensure last row and column are populated so that the size can be deduced:
+  rows.push_back(static_cast<unsigned int>(N - 1)); cols.push_back(static_cast<unsigned int>(M - 1)); values.push_back(NumericT(1));
+  stl_A[N - 1][static_cast<unsigned int>(M - 1)] += NumericT(1);
+
+  std::cout << "Testing assemble_from_triplets() with given size" << std::endl;
+  viennacl::compressed_matrix<NumericT> vcl_A(N, M);
+  vcl_A.assemble_from_triplets(rows, cols, values);
+  if (vcl_A.size1() != N || vcl_A.size2() != M)
+  {
+    std::cout << "# Error: Matrix size changed" << std::endl;
+    return EXIT_FAILURE;
+  }
+  retval = check_sparse_matrix(vcl_A, stl_A, epsilon, "assemble_from_triplets() with given size");
+  if (retval != EXIT_SUCCESS)
+    return retval;
+
+  std::cout << "Testing assemble_from_triplets() with deduced size" << std::endl;
+  viennacl::compressed_matrix<NumericT> vcl_B;
+  viennacl::linalg::assemble_from_triplets(&(rows[0]), &(cols[0]), &(values[0]), values.size(), vcl_B);
+  if (vcl_B.size1() != N || vcl_B.size2() != M)
+  {
+    std::cout << "# Error: Wrong matrix size deduced: " << vcl_B.size1() << "x" << vcl_B.size2() << std::endl;
+    return EXIT_FAILURE;
+  }
+  retval = check_sparse_matrix(vcl_B, stl_A, epsilon, "assemble_from_triplets() with deduced size");
+  if (retval != EXIT_SUCCESS)
+    return retval;
+
+  std::cout << "Testing repeated assemble_from_triplets() into existing matrix" << std::endl;
+  for (std::size_t k=0; k<values.size(); ++k)
+    values[k] *= NumericT(2);
+  for (std::size_t i=0; i<N; ++i)
+    for (typename std::map<unsigned int, NumericT>::iterator it = stl_A[i].begin(); it != stl_A[i].end(); ++it)
+      it->second *= NumericT(2);
+  vcl_A.assemble_from_triplets(rows, cols, values);
+  retval = check_sparse_matrix(vcl_A, stl_A, epsilon, "repeated assemble_from_triplets()");
+  if (retval != EXIT_SUCCESS)
+    return retval;
+
+  std::cout << "Testing product with assembled matrix" << std::endl;
+  std::vector<NumericT> stl_x(M);
+  for (std::size_t j=0; j<M; ++j)
+    stl_x[j] = randomNumber();
+  viennacl::vector<NumericT> vcl_x(M);
+  viennacl::copy(stl_x, vcl_x);
+  viennacl::vector<NumericT> vcl_y = viennacl::linalg::prod(vcl_A, vcl_x);
+  std::vector<NumericT> stl_y(N);
+  viennacl::copy(vcl_y, stl_y);
+  for (std::size_t i=0; i<N; ++i)
+  {
+    NumericT ref = 0;
+    for (typename std::map<unsigned int, NumericT>::const_iterator it = stl_A[i].begin(); it != stl_A[i].end(); ++it)
+      ref += it->second * stl_x[it->first];
+    if (std::fabs(ref - stl_y[i]) / std::max(NumericT(1), std::fabs(ref)) > epsilon)
+    {
+      std::cout << "# Error at operation: product with assembled matrix" << std::endl;
+      std::cout << "  row " << i << ": " << stl_y[i] << " vs. " << ref << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  std::cout << "Testing set_values()" << std::endl;
+  std::vector<NumericT> new_values(vcl_A.nnz());
+  for (std::size_t k=0; k<new_values.size(); ++k)
+    new_values[k] = NumericT(1) + randomNumber();
+  std::size_t index = 0;
+  for (std::size_t i=0; i<N; ++i)
+    for (typename std::map<unsigned int, NumericT>::iterator it = stl_A[i].begin(); it != stl_A[i].end(); ++it)
+      it->second = new_values[index++];
+  vcl_A.set_values(&(new_values[0]));
+  retval = check_sparse_matrix(vcl_A, stl_A, epsilon, "set_values()");
+  if (retval != EXIT_SUCCESS)
+    return retval;
+
+  vcl_B.set_values(vcl_A);
+  retval = check_sparse_matrix(vcl_B, stl_A, epsilon, "set_values() from matrix");
+  if (retval != EXIT_SUCCESS)
+    return retval;
+
+  std::cout << "Testing value_update_symbolic() and value_update_numeric()" << std::endl;
+  viennacl::linalg::value_update_plan plan = viennacl::linalg::value_update_symbolic(vcl_A, &(rows[0]), &(cols[0]), values.size());
+  for (std::size_t run=0; run<2; ++run)
+  {
+    for (std::size_t i=0; i<N; ++i)
+      for (typename std::map<unsigned int, NumericT>::iterator it = stl_A[i].begin(); it != stl_A[i].end(); ++it)
+        it->second = 0;
+    for (std::size_t k=0; k<values.size(); ++k)
+    {
+      values[k] = NumericT(1) + randomNumber();
+      stl_A[rows[k]][cols[k]] += values[k];
+    }
+    viennacl::linalg::value_update_numeric(plan, &(values[0]), vcl_A);
+    retval = check_sparse_matrix(vcl_A, stl_A, epsilon, "value_update_numeric()");
+    if (retval != EXIT_SUCCESS)
+      return retval;
+  }
+
+  return retval;
+}
+
+
+/* Returns the relative difference of the results of two preconditioners applied to the same vector */
+template<typename NumericT, typename PrecondT1, typename PrecondT2>
+NumericT precond_diff(PrecondT1 const & precond1, PrecondT2 const & precond2, viennacl::vector<NumericT> const & b)
+{
+  viennacl::vector<NumericT> x1 = b;
+  viennacl::vector<NumericT> x2 = b;
+  precond1.apply(x1);
+  precond2.apply(x2);
+  return viennacl::linalg::norm_2(x1 - x2) / viennacl::linalg::norm_2(x1);
+}
+
+/* Sets up a discrete 2D Laplace operator with random perturbations of the off-diagonal entries */
+template<typename NumericT>
+void perturbed_laplace_2d(viennacl::compressed_matrix<NumericT> & A, std::size_t points_per_dim)
+{
+  viennacl::tools::uniform_random_numbers<NumericT> randomNumber;
+
+  std::vector<unsigned int> rows;
+  std::vector<unsigned int> cols;
+  std::vector<NumericT>     values;
+  for (std::size_t i=0; i<points_per_dim; ++i)
+    for (std::size_t j=0; j<points_per_dim; ++j)
+    {
+      unsigned int row = static_cast<unsigned int>(i * points_per_dim + j);
+      rows.push_back(row); cols.push_back(row); values.push_back(NumericT(4.5));
+      if (i > 0)                  { rows.push_back(row); cols.push_back(static_cast<unsigned int>(row - points_per_dim)); values.push_back(NumericT(-0.5) - randomNumber() / NumericT(2)); }
+      if (i < points_per_dim - 1) { rows.push_back(row); cols.push_back(static_cast<unsigned int>(row + points_per_dim)); values.push_back(NumericT(-0.5) - randomNumber() / NumericT(2)); }
+      if (j > 0)                  { rows.push_back(row); cols.push_back(row - 1); values.push_back(NumericT(-0.5) - randomNumber() / NumericT(2)); }
+      if (j < points_per_dim - 1) { rows.push_back(row); cols.push_back(row + 1); values.push_back(NumericT(-0.5) - randomNumber() / NumericT(2)); }
+    }
+  A.assemble_from_triplets(rows, cols, values);
+}
+
+template<typename NumericT, typename Epsilon>
+int test_refactor(Epsilon const& epsilon)
+{
+  std::size_t points_per_dim = 40;
+  viennacl::compressed_matrix<NumericT> A(points_per_dim * points_per_dim, points_per_dim * points_per_dim);
+  viennacl::compressed_matrix<NumericT> A2(points_per_dim * points_per_dim, points_per_dim * points_per_dim);
+  perturbed_laplace_2d(A, points_per_dim);
+  perturbed_laplace_2d(A2, points_per_dim); // same pattern, different values
+
+  viennacl::vector<NumericT> b = viennacl::scalar_vector<NumericT>(A.size1(), NumericT(1));
+
+  std::cout << "Testing ilu0_precond::refactor()" << std::endl;
+  for (std::size_t level_scheduling = 0; level_scheduling < 2; ++level_scheduling)
+  {
+    viennacl::linalg::ilu0_tag tag(level_scheduling > 0);
+    viennacl::linalg::ilu0_precond<viennacl::compressed_matrix<NumericT> > ilu0_refactored(A, tag);
+    ilu0_refactored.refactor(A2);
+    viennacl::linalg::ilu0_precond<viennacl::compressed_matrix<NumericT> > ilu0_reference(A2, tag);
+    NumericT diff = precond_diff(ilu0_refactored, ilu0_reference, b);
+    if (diff > epsilon)
+    {
+      std::cout << "# Error at operation: ilu0_precond::refactor(), level scheduling: " << level_scheduling << std::endl;
+      std::cout << "  diff: " << diff << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  std::cout << "Testing chow_patel_ilu_precond::refactor() and chow_patel_icc_precond::refactor()" << std::endl;
+  {
+    viennacl::linalg::chow_patel_tag tag;
+    viennacl::linalg::chow_patel_ilu_precond<viennacl::compressed_matrix<NumericT> > ilu_refactored(A, tag);
+    ilu_refactored.refactor(A2);
+    viennacl::linalg::chow_patel_ilu_precond<viennacl::compressed_matrix<NumericT> > ilu_reference(A2, tag);
+    NumericT diff = precond_diff(ilu_refactored, ilu_reference, b);
+
+    viennacl::linalg::chow_patel_icc_precond<viennacl::compressed_matrix<NumericT> > icc_refactored(A, tag);
+    icc_refactored.refactor(A2);
+    viennacl::linalg::chow_patel_icc_precond<viennacl::compressed_matrix<NumericT> > icc_reference(A2, tag);
+    diff = std::max(diff, precond_diff(icc_refactored, icc_reference, b));
+    if (diff > epsilon)
+    {
+      std::cout << "# Error at operation: chow_patel_*_precond::refactor()" << std::endl;
+      std::cout << "  diff: " << diff << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  std::cout << "Testing amg_precond::refactor()" << std::endl;
+  {
+    // AMG coarsening and interpolation are invariant under scaling of the system matrix, hence refactor(2*A) must halve the result of a V-cycle:
+    viennacl::compressed_matrix<NumericT> A_scaled(A.size1(), A.size2());
+    A_scaled = A;
+    viennacl::vector<NumericT> values(A.nnz());
+    viennacl::backend::memory_copy(A.handle(), values.handle(), 0, 0, sizeof(NumericT) * A.nnz());
+    values *= NumericT(2);
+    A_scaled.set_values(values);
+
+    // (the coarsening may be randomized, hence the same preconditioner instance is compared before and after refactor())
+    viennacl::linalg::amg_tag tag;
+    viennacl::linalg::amg_precond<viennacl::compressed_matrix<NumericT> > amg(A, tag);
+    amg.setup();
+    viennacl::vector<NumericT> x1 = b;
+    amg.apply(x1);
+    amg.refactor(A_scaled);
+    viennacl::vector<NumericT> x2 = b;
+    amg.apply(x2);
+    x2 *= NumericT(2);
+    NumericT diff = viennacl::linalg::norm_2(x1 - x2) / viennacl::linalg::norm_2(x1);
+    if (diff > epsilon)
+    {
+      std::cout << "# Error at operation: amg_precond::refactor()" << std::endl;
+      std::cout << "  diff: " << diff << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
+
+template< typename NumericT, typename Epsilon >
+int test(Epsilon const& epsilon)
+{
+  int retval = test_refactor<NumericT>(epsilon);
+  if (retval != EXIT_SUCCESS)
+    return retval;
+
+  retval = test<NumericT>(epsilon, 50, 70, 20);
+  if (retval != EXIT_SUCCESS)
+    return retval;
+
+  return test<NumericT>(epsilon, 20000, 15000, 30);
+}
+
+//
+// -------------------------------------------------------------
+//
+int main()
+{
+  std::cout << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << "## Test :: Sparse Matrix Assembly" << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << std::endl;
+
+  int retval = EXIT_SUCCESS;
+
+  std::cout << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << std::endl;
+  {
+    typedef float NumericT;
+    NumericT epsilon = static_cast<NumericT>(1E-4);
+    std::cout << "# Testing setup:" << std::endl;
+    std::cout << "  eps:     " << epsilon << std::endl;
+    std::cout << "  numeric: float" << std::endl;
+    retval = test<NumericT>(epsilon);
+    if ( retval == EXIT_SUCCESS )
+        std::cout << "# Test passed" << std::endl;
+    else
+        return retval;
+  }
+  std::cout << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << std::endl;
+
+#ifdef VIENNACL_WITH_OPENCL
+  if ( viennacl::ocl::current_device().double_support() )
+#endif
+  {
+    typedef double NumericT;
+    NumericT epsilon = 1.0E-12;
+    std::cout << "# Testing setup:" << std::endl;
+    std::cout << "  eps:     " << epsilon << std::endl;
+    std::cout << "  numeric: double" << std::endl;
+    retval = test<NumericT>(epsilon);
+    if ( retval == EXIT_SUCCESS )
+      std::cout << "# Test passed" << std::endl;
+    else
+      return retval;
+  }
+  std::cout << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << std::endl;
+
+
+  std::cout << std::endl;
+  std::cout << "------- Test completed --------" << std::endl;
+  std::cout << std::endl;
+
+  return retval;
+}
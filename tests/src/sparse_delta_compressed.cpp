@@ -0,0 +1,241 @@
+/* =========================================================================
+   Copyright (c) 2010-2016, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+   Portions of this software are copyright by UChicago Argonne, LLC.
+
+                            -----------------
+                  ViennaCL - The Vienna Computing Library
+                            -----------------
+
+   Project Head:    Karl Rupp                   rupp@iue.tuwien.ac.at
+
+   (A list of authors and contributors can be found in the PDF manual)
+
+   License:         MIT (X11), see file LICENSE in the base directory
+============================================================================= */
+
+
+
+/** \file tests/src/sparse_delta_compressed.cpp  Tests the delta_compressed_matrix format (host backend only).
+*   \test  Tests the delta_compressed_matrix format (host backend only).
+**/
+
+//
+// *** System
+//
+#include <iostream>
+#include <vector>
+#include <map>
+#include <cmath>
+
+
+//
+// *** ViennaCL
+//
+#include "viennacl/scalar.hpp"
+#include "viennacl/vector.hpp"
+#include "viennacl/vector_proxy.hpp"
+#include "viennacl/compressed_matrix.hpp"
+#include "viennacl/delta_compressed_matrix.hpp"
+#include "viennacl/linalg/prod.hpp"
+
+#include "viennacl/tools/random.hpp"
+
+//
+// -------------------------------------------------------------
+//
+
+template<typename NumericT>
+NumericT diff(viennacl::vector<NumericT> const & v1, viennacl::vector<NumericT> const & v2)
+{
+  std::vector<NumericT> std_v1(v1.size());
+  std::vector<NumericT> std_v2(v2.size());
+  viennacl::copy(v1, std_v1);
+  viennacl::copy(v2, std_v2);
+
+  NumericT error = 0;
+  for (std::size_t i=0; i<std_v1.size(); ++i)
+  {
+    NumericT current_error = std::fabs(std_v1[i] - std_v2[i]) / std::max<NumericT>(NumericT(1), std::max(std::fabs(std_v1[i]), std::fabs(std_v2[i])));
+    if (current_error > error)
+      error = current_error;
+  }
+  return error;
+}
+
+
+//
+// -------------------------------------------------------------
+//
+template< typename NumericT, typename Epsilon >
+int test(Epsilon const& epsilon)
+{
+  int retval = EXIT_SUCCESS;
+
+  viennacl::tools::uniform_random_numbers<NumericT> randomNumber;
+
+  std::size_t N = 100000;
+  std::size_t half_bandwidth = 7;
+
+  // banded matrix with a few long-range couplings (8-bit and 16-bit deltas with escapes, plus rows requiring full 32-bit deltas)
+  std::vector<std::map<unsigned int, NumericT> > stl_A(N);
+  for (std::size_t i=0; i<N; ++i)
+  {
+    if (i % 1000 == 17) // empty rows
+      continue;
+
+    for (std::size_t j = (i > half_bandwidth ? i - half_bandwidth : 0); j < std::min(N, i + half_bandwidth + 1); ++j)
+      stl_A[i][static_cast<unsigned int>(j)] = randomNumber();
+
+    if (i % 100 == 3)
+      stl_A[i][static_cast<unsigned int>((i + N / 2) % N)] = randomNumber();
+
+    if (i % 1000 == 5) // scattered row
+      for (std::size_t j=0; j<20; ++j)
+        stl_A[i][static_cast<unsigned int>(randomNumber() * NumericT(N - 1))] = randomNumber();
+  }
+
+  viennacl::compressed_matrix<NumericT> vcl_A(N, N);
+  viennacl::tools::sparse_matrix_adapter<NumericT> adapted_stl_A(stl_A, N, N);
+  viennacl::copy(adapted_stl_A, vcl_A);
+
+  viennacl::delta_compressed_matrix<NumericT> vcl_delta_A(vcl_A);
+
+  std::cout << "Index bytes per nonzero: " << vcl_delta_A.index_bytes_per_nnz() << " (saved: " << vcl_delta_A.saved_bytes_per_nnz() << ")" << std::endl;
+  if (vcl_delta_A.nnz() != vcl_A.nnz() || vcl_delta_A.size1() != N || vcl_delta_A.size2() != N)
+  {
+    std::cout << "# Error at operation: conversion to delta_compressed_matrix (size mismatch)" << std::endl;
+    retval = EXIT_FAILURE;
+  }
+  if (vcl_delta_A.index_bytes_per_nnz() > 2.0)
+  {
+    std::cout << "# Error at operation: conversion to delta_compressed_matrix (index compression ineffective)" << std::endl;
+    retval = EXIT_FAILURE;
+  }
+
+  std::vector<NumericT> std_x(N);
+  for (std::size_t i=0; i<N; ++i)
+    std_x[i] = randomNumber();
+
+  viennacl::vector<NumericT> vcl_x(N);
+  viennacl::vector<NumericT> vcl_result(N);
+  viennacl::vector<NumericT> vcl_result_ref(N);
+  viennacl::copy(std_x, vcl_x);
+
+  std::cout << "Testing y = A * x" << std::endl;
+  vcl_result_ref = viennacl::linalg::prod(vcl_A, vcl_x);
+  vcl_result     = viennacl::linalg::prod(vcl_delta_A, vcl_x);
+  if ( diff(vcl_result_ref, vcl_result) > epsilon )
+  {
+    std::cout << "# Error at operation: y = A * x" << std::endl;
+    std::cout << "  diff: " << diff(vcl_result_ref, vcl_result) << std::endl;
+    retval = EXIT_FAILURE;
+  }
+
+  std::cout << "Testing y += A * x" << std::endl;
+  vcl_result_ref += viennacl::linalg::prod(vcl_A, vcl_x);
+  vcl_result     += viennacl::linalg::prod(vcl_delta_A, vcl_x);
+  if ( diff(vcl_result_ref, vcl_result) > epsilon )
+  {
+    std::cout << "# Error at operation: y += A * x" << std::endl;
+    std::cout << "  diff: " << diff(vcl_result_ref, vcl_result) << std::endl;
+    retval = EXIT_FAILURE;
+  }
+
+  std::cout << "Testing y -= A * x" << std::endl;
+  vcl_result_ref -= viennacl::linalg::prod(vcl_A, vcl_x);
+  vcl_result     -= viennacl::linalg::prod(vcl_delta_A, vcl_x);
+  if ( diff(vcl_result_ref, vcl_result) > epsilon )
+  {
+    std::cout << "# Error at operation: y -= A * x" << std::endl;
+    std::cout << "  diff: " << diff(vcl_result_ref, vcl_result) << std::endl;
+    retval = EXIT_FAILURE;
+  }
+
+  std::cout << "Testing x = A * x" << std::endl;
+  vcl_result_ref = vcl_x;
+  vcl_result_ref = viennacl::linalg::prod(vcl_A, vcl_result_ref);
+  vcl_result     = vcl_x;
+  vcl_result     = viennacl::linalg::prod(vcl_delta_A, vcl_result);
+  if ( diff(vcl_result_ref, vcl_result) > epsilon )
+  {
+    std::cout << "# Error at operation: x = A * x" << std::endl;
+    std::cout << "  diff: " << diff(vcl_result_ref, vcl_result) << std::endl;
+    retval = EXIT_FAILURE;
+  }
+
+  std::cout << "Testing y = A * x with strided x" << std::endl;
+  viennacl::vector<NumericT> vcl_x_strided(2 * N);
+  viennacl::slice s(1, 2, N);
+  viennacl::vector_slice<viennacl::vector<NumericT> > vcl_x_slice(vcl_x_strided, s);
+  vcl_x_slice = vcl_x;
+  vcl_result_ref = viennacl::linalg::prod(vcl_A, vcl_x);
+  vcl_result     = viennacl::linalg::prod(vcl_delta_A, vcl_x_slice);
+  if ( diff(vcl_result_ref, vcl_result) > epsilon )
+  {
+    std::cout << "# Error at operation: y = A * x with strided x" << std::endl;
+    std::cout << "  diff: " << diff(vcl_result_ref, vcl_result) << std::endl;
+    retval = EXIT_FAILURE;
+  }
+
+  // --------------------------------------------------------------------------
+  return retval;
+}
+//
+// -------------------------------------------------------------
+//
+int main()
+{
+  std::cout << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << "## Test :: Delta-compressed Sparse Matrix" << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << std::endl;
+
+  int retval = EXIT_SUCCESS;
+
+  std::cout << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << std::endl;
+  {
+    typedef float NumericT;
+    NumericT epsilon = static_cast<NumericT>(1E-4);
+    std::cout << "# Testing setup:" << std::endl;
+    std::cout << "  eps:     " << epsilon << std::endl;
+    std::cout << "  numeric: float" << std::endl;
+    retval = test<NumericT>(epsilon);
+    if ( retval == EXIT_SUCCESS )
+        std::cout << "# Test passed" << std::endl;
+    else
+        return retval;
+  }
+  std::cout << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << std::endl;
+
+  {
+    typedef double NumericT;
+    NumericT epsilon = 1.0E-12;
+    std::cout << "# Testing setup:" << std::endl;
+    std::cout << "  eps:     " << epsilon << std::endl;
+    std::cout << "  numeric: double" << std::endl;
+    retval = test<NumericT>(epsilon);
+    if ( retval == EXIT_SUCCESS )
+      std::cout << "# Test passed" << std::endl;
+    else
+      return retval;
+  }
+  std::cout << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << std::endl;
+
+
+  std::cout << std::endl;
+  std::cout << "------- Test completed --------" << std::endl;
+  std::cout << std::endl;
+
+  return retval;
+}
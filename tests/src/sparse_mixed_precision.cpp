@@ -0,0 +1,273 @@
+/* =========================================================================
+   Copyright (c) 2010-2016, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+   Portions of this software are copyright by UChicago Argonne, LLC.
+
+                            -----------------
+                  ViennaCL - The Vienna Computing Library
+                            -----------------
+
+   Project Head:    Karl Rupp                   rupp@iue.tuwien.ac.at
+
+   (A list of authors and contributors can be found in the PDF manual)
+
+   License:         MIT (X11), see file LICENSE in the base directory
+============================================================================= */
+
+
+
+/** \file tests/src/sparse_mixed_precision.cpp  Tests sparse matrices with values stored in reduced precision (host backend only).
+*   \test  Tests sparse matrices with values stored in reduced precision (host backend only).
+**/
+
+//
+// *** System
+//
+#include <iostream>
+#include <vector>
+#include <map>
+#include <cmath>
+
+
+//
+// *** ViennaCL
+//
+#include "viennacl/scalar.hpp"
+#include "viennacl/vector.hpp"
+#include "viennacl/compressed_matrix.hpp"
+#include "viennacl/ell_matrix.hpp"
+#include "viennacl/mixed_compressed_matrix.hpp"
+#include "viennacl/mixed_ell_matrix.hpp"
+#include "viennacl/linalg/prod.hpp"
+#include "viennacl/linalg/norm_2.hpp"
+#include "viennacl/linalg/cg.hpp"
+#include "viennacl/linalg/mixed_precision_cg.hpp"
+#include "viennacl/linalg/amg.hpp"
+
+#include "viennacl/tools/random.hpp"
+
+#include "sparse_test_systems.hpp"
+
+//
+// -------------------------------------------------------------
+//
+
+template<typename NumericT>
+NumericT diff(viennacl::vector<NumericT> const & v1, viennacl::vector<NumericT> const & v2)
+{
+  std::vector<NumericT> std_v1(v1.size());
+  std::vector<NumericT> std_v2(v2.size());
+  viennacl::copy(v1, std_v1);
+  viennacl::copy(v2, std_v2);
+
+  NumericT error = 0;
+  for (std::size_t i=0; i<std_v1.size(); ++i)
+  {
+    NumericT current_error = std::fabs(std_v1[i] - std_v2[i]) / std::max<NumericT>(NumericT(1), std::max(std::fabs(std_v1[i]), std::fabs(std_v2[i])));
+    if (current_error > error)
+      error = current_error;
+  }
+  return error;
+}
+
+
+//
+// -------------------------------------------------------------
+//
+template< typename NumericT, typename Epsilon >
+int test(Epsilon const& epsilon)
+{
+  int retval = EXIT_SUCCESS;
+
+  viennacl::tools::uniform_random_numbers<NumericT> randomNumber;
+
+  std::size_t N = 20000;
+  std::size_t nnz_row = 13;
+
+  std::vector<std::map<unsigned int, NumericT> > stl_A(N);
+  for (std::size_t i=0; i<N; ++i)
+    for (std::size_t j=0; j<nnz_row; ++j)
+      stl_A[i][static_cast<unsigned int>(randomNumber() * NumericT(N - 1))] = NumericT(1) + randomNumber();
+
+  viennacl::compressed_matrix<NumericT> vcl_A(N, N);
+  viennacl::ell_matrix<NumericT>        vcl_ell_A;
+  viennacl::tools::sparse_matrix_adapter<NumericT> adapted_stl_A(stl_A, N, N);
+  viennacl::copy(adapted_stl_A, vcl_A);
+  viennacl::copy(adapted_stl_A, vcl_ell_A);
+
+  // reference matrix with values rounded to single precision:
+  std::vector<std::map<unsigned int, NumericT> > stl_A_rounded(stl_A);
+  for (std::size_t i=0; i<N; ++i)
+    for (typename std::map<unsigned int, NumericT>::iterator it = stl_A_rounded[i].begin(); it != stl_A_rounded[i].end(); ++it)
+      it->second = static_cast<NumericT>(static_cast<float>(it->second));
+  viennacl::compressed_matrix<NumericT> vcl_A_rounded(N, N);
+  viennacl::tools::sparse_matrix_adapter<NumericT> adapted_stl_A_rounded(stl_A_rounded, N, N);
+  viennacl::copy(adapted_stl_A_rounded, vcl_A_rounded);
+
+  viennacl::mixed_compressed_matrix<NumericT> vcl_mixed_A(vcl_A);
+  viennacl::mixed_ell_matrix<NumericT>        vcl_mixed_ell_A(vcl_ell_A);
+
+  std::vector<NumericT> std_x(N);
+  for (std::size_t i=0; i<N; ++i)
+    std_x[i] = randomNumber();
+
+  viennacl::vector<NumericT> vcl_x(N);
+  viennacl::vector<NumericT> vcl_result(N);
+  viennacl::vector<NumericT> vcl_result_ref(N);
+  viennacl::copy(std_x, vcl_x);
+
+  std::cout << "Testing y = A * x with mixed_compressed_matrix" << std::endl;
+  vcl_result_ref = viennacl::linalg::prod(vcl_A_rounded, vcl_x);
+  vcl_result     = viennacl::linalg::prod(vcl_mixed_A, vcl_x);
+  if ( diff(vcl_result_ref, vcl_result) > epsilon )
+  {
+    std::cout << "# Error at operation: y = A * x with mixed_compressed_matrix" << std::endl;
+    std::cout << "  diff: " << diff(vcl_result_ref, vcl_result) << std::endl;
+    retval = EXIT_FAILURE;
+  }
+
+  std::cout << "Testing y -= A * x with mixed_compressed_matrix" << std::endl;
+  vcl_result_ref -= viennacl::linalg::prod(vcl_A_rounded, vcl_x);
+  vcl_result     -= viennacl::linalg::prod(vcl_mixed_A, vcl_x);
+  if ( diff(vcl_result_ref, vcl_result) > epsilon )
+  {
+    std::cout << "# Error at operation: y -= A * x with mixed_compressed_matrix" << std::endl;
+    std::cout << "  diff: " << diff(vcl_result_ref, vcl_result) << std::endl;
+    retval = EXIT_FAILURE;
+  }
+
+  std::cout << "Testing y = A * x with mixed_ell_matrix" << std::endl;
+  vcl_result_ref = viennacl::linalg::prod(vcl_A_rounded, vcl_x);
+  vcl_result     = viennacl::linalg::prod(vcl_mixed_ell_A, vcl_x);
+  if ( diff(vcl_result_ref, vcl_result) > epsilon )
+  {
+    std::cout << "# Error at operation: y = A * x with mixed_ell_matrix" << std::endl;
+    std::cout << "  diff: " << diff(vcl_result_ref, vcl_result) << std::endl;
+    retval = EXIT_FAILURE;
+  }
+
+  std::cout << "Testing y += A * x with mixed_ell_matrix" << std::endl;
+  vcl_result_ref += viennacl::linalg::prod(vcl_A_rounded, vcl_x);
+  vcl_result     += viennacl::linalg::prod(vcl_mixed_ell_A, vcl_x);
+  if ( diff(vcl_result_ref, vcl_result) > epsilon )
+  {
+    std::cout << "# Error at operation: y += A * x with mixed_ell_matrix" << std::endl;
+    std::cout << "  diff: " << diff(vcl_result_ref, vcl_result) << std::endl;
+    retval = EXIT_FAILURE;
+  }
+
+  // --------------------------------------------------------------------------
+  return retval;
+}
+
+
+template<typename NumericT>
+int test_solvers()
+{
+  int retval = EXIT_SUCCESS;
+
+  std::vector<std::map<unsigned int, NumericT> > stl_A;
+  laplace_2d(stl_A, 64);
+  std::size_t N = stl_A.size();
+
+  viennacl::compressed_matrix<NumericT> vcl_A(N, N);
+  viennacl::tools::sparse_matrix_adapter<NumericT> adapted_stl_A(stl_A, N, N);
+  viennacl::copy(adapted_stl_A, vcl_A);
+
+  viennacl::vector<NumericT> vcl_rhs = viennacl::scalar_vector<NumericT>(N, NumericT(1));
+  viennacl::vector<NumericT> vcl_result(N);
+  viennacl::vector<NumericT> vcl_residual(N);
+
+  std::cout << "Testing mixed_precision_cg with mixed_compressed_matrix" << std::endl;
+  viennacl::mixed_compressed_matrix<NumericT> vcl_mixed_A(vcl_A);
+  viennacl::linalg::mixed_precision_cg_tag mixed_tag(1e-10, 2000);
+  vcl_result = viennacl::linalg::solve(vcl_mixed_A, vcl_rhs, mixed_tag);
+  vcl_residual = viennacl::linalg::prod(vcl_A, vcl_result);
+  vcl_residual -= vcl_rhs;
+  std::cout << "  iterations: " << mixed_tag.iters() << ", relative residual: " << viennacl::linalg::norm_2(vcl_residual) / viennacl::linalg::norm_2(vcl_rhs) << std::endl;
+  if (viennacl::linalg::norm_2(vcl_residual) / viennacl::linalg::norm_2(vcl_rhs) > 1e-5)
+  {
+    std::cout << "# Error at operation: mixed_precision_cg with mixed_compressed_matrix" << std::endl;
+    retval = EXIT_FAILURE;
+  }
+
+  std::cout << "Testing CG with AMG using single precision operators" << std::endl;
+  viennacl::linalg::amg_tag amg_tag;
+  amg_tag.set_reduced_precision_storage(true);
+  viennacl::linalg::amg_precond<viennacl::compressed_matrix<NumericT> > amg_precond(vcl_A, amg_tag);
+  amg_precond.setup();
+
+  viennacl::linalg::cg_tag cg_tag(1e-10, 500);
+  vcl_result = viennacl::linalg::solve(vcl_A, vcl_rhs, cg_tag, amg_precond);
+  vcl_residual = viennacl::linalg::prod(vcl_A, vcl_result);
+  vcl_residual -= vcl_rhs;
+  std::cout << "  iterations: " << cg_tag.iters() << ", relative residual: " << viennacl::linalg::norm_2(vcl_residual) / viennacl::linalg::norm_2(vcl_rhs) << std::endl;
+  if (viennacl::linalg::norm_2(vcl_residual) / viennacl::linalg::norm_2(vcl_rhs) > 1e-8 || cg_tag.iters() >= 500)
+  {
+    std::cout << "# Error at operation: CG with AMG using single precision operators" << std::endl;
+    retval = EXIT_FAILURE;
+  }
+
+  return retval;
+}
+
+//
+// -------------------------------------------------------------
+//
+int main()
+{
+  std::cout << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << "## Test :: Mixed-precision Sparse Matrices" << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << std::endl;
+
+  int retval = EXIT_SUCCESS;
+
+  std::cout << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << std::endl;
+  {
+    typedef float NumericT;
+    NumericT epsilon = static_cast<NumericT>(1E-4);
+    std::cout << "# Testing setup:" << std::endl;
+    std::cout << "  eps:     " << epsilon << std::endl;
+    std::cout << "  numeric: float" << std::endl;
+    retval = test<NumericT>(epsilon);
+    if ( retval == EXIT_SUCCESS )
+        std::cout << "# Test passed" << std::endl;
+    else
+        return retval;
+  }
+  std::cout << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << std::endl;
+
+  {
+    typedef double NumericT;
+    NumericT epsilon = 1.0E-12;
+    std::cout << "# Testing setup:" << std::endl;
+    std::cout << "  eps:     " << epsilon << std::endl;
+    std::cout << "  numeric: double" << std::endl;
+    retval = test<NumericT>(epsilon);
+    if ( retval == EXIT_SUCCESS )
+      retval = test_solvers<NumericT>();
+    if ( retval == EXIT_SUCCESS )
+      std::cout << "# Test passed" << std::endl;
+    else
+      return retval;
+  }
+  std::cout << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << std::endl;
+
+
+  std::cout << std::endl;
+  std::cout << "------- Test completed --------" << std::endl;
+  std::cout << std::endl;
+
+  return retval;
+}
@@ -0,0 +1,344 @@
+/* =========================================================================
+   Copyright (c) 2010-2016, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+   Portions of this software are copyright by UChicago Argonne, LLC.
+
+                            -----------------
+                  ViennaCL - The Vienna Computing Library
+                            -----------------
+
+   Project Head:    Karl Rupp                   rupp@iue.tuwien.ac.at
+
+   (A list of authors and contributors can be found in the PDF manual)
+
+   License:         MIT (X11), see file LICENSE in the base directory
+============================================================================= */
+
+
+
+/** \file tests/src/sparse_operator.cpp  Tests the structure statistics, the format selection, and the sparse matrix-vector products of sparse_operator.
+*   \test  Tests the structure statistics, the format selection, and the sparse matrix-vector products of sparse_operator.
+**/
+
+//
+// *** System
+//
+#include <iostream>
+#include <vector>
+#include <map>
+#include <cmath>
+
+
+//
+// *** ViennaCL
+//
+#include "viennacl/scalar.hpp"
+#include "viennacl/vector.hpp"
+#include "viennacl/compressed_matrix.hpp"
+#include "viennacl/sparse_operator.hpp"
+#include "viennacl/linalg/prod.hpp"
+#include "viennacl/linalg/norm_2.hpp"
+#include "viennacl/linalg/norm_inf.hpp"
+#include "viennacl/linalg/cg.hpp"
+
+#include "viennacl/tools/random.hpp"
+
+//
+// -------------------------------------------------------------
+//
+
+/* Returns the maximum relative deviation of y from the reference y_ref */
+template<typename NumericT>
+NumericT diff(viennacl::vector<NumericT> const & y, viennacl::vector<NumericT> const & y_ref)
+{
+  viennacl::vector<NumericT> temp = y - y_ref;
+  NumericT norm_ref = viennacl::linalg::norm_inf(y_ref);
+  NumericT norm_diff = viennacl::linalg::norm_inf(temp);
+  return norm_diff / std::max(NumericT(1), norm_ref);
+}
+
+/* Sets up a matrix with row lengths varying between min_row_length and max_row_length */
+template<typename NumericT>
+void random_matrix(viennacl::compressed_matrix<NumericT> & A, std::size_t N, std::size_t min_row_length, std::size_t max_row_length)
+{
+  viennacl::tools::uniform_random_numbers<NumericT> randomNumber;
+
+  std::vector<std::map<unsigned int, NumericT> > stl_A(N);
+  for (std::size_t i=0; i<N; ++i)
+  {
+    std::size_t row_length = min_row_length + static_cast<std::size_t>(randomNumber() * NumericT(max_row_length - min_row_length + 1));
+    row_length = std::min(row_length, max_row_length);
+    for (std::size_t k=0; stl_A[i].size() < row_length && k < 10 * row_length; ++k)
+      stl_A[i][static_cast<unsigned int>(static_cast<std::size_t>(randomNumber() * NumericT(N)) % N)] = NumericT(1) + randomNumber();
+  }
+  viennacl::copy(stl_A, A);
+}
+
+/* Sets up the tridiagonal matrix tridiag(-1, 2, -1) */
+template<typename NumericT>
+void tridiagonal_matrix(viennacl::compressed_matrix<NumericT> & A, std::size_t N)
+{
+  std::vector<std::map<unsigned int, NumericT> > stl_A(N);
+  for (std::size_t i=0; i<N; ++i)
+  {
+    if (i > 0)
+      stl_A[i][static_cast<unsigned int>(i-1)] = NumericT(-1);
+    stl_A[i][static_cast<unsigned int>(i)] = NumericT(2);
+    if (i < N-1)
+      stl_A[i][static_cast<unsigned int>(i+1)] = NumericT(-1);
+  }
+  viennacl::copy(stl_A, A);
+}
+
+/* Sets up a banded matrix with rows of alternating length 5 and 7 */
+template<typename NumericT>
+void banded_matrix(viennacl::compressed_matrix<NumericT> & A, std::size_t N)
+{
+  std::vector<std::map<unsigned int, NumericT> > stl_A(N);
+  for (std::size_t i=0; i<N; ++i)
+  {
+    std::size_t half_width = (i % 2) ? 3 : 2;
+    for (std::size_t j = (i > half_width) ? i - half_width : 0; j <= std::min(i + half_width, N - 1); ++j)
+      stl_A[i][static_cast<unsigned int>(j)] = (i == j) ? NumericT(8) : NumericT(-1);
+  }
+  viennacl::copy(stl_A, A);
+}
+
+/* Sets up a matrix with five random entries per row and 500 entries in every 200th row */
+template<typename NumericT>
+void long_rows_matrix(viennacl::compressed_matrix<NumericT> & A, std::size_t N)
+{
+  viennacl::tools::uniform_random_numbers<NumericT> randomNumber;
+
+  std::vector<std::map<unsigned int, NumericT> > stl_A(N);
+  for (std::size_t i=0; i<N; ++i)
+  {
+    std::size_t row_length = (i % 200 == 0) ? 500 : 5;
+    while (stl_A[i].size() < row_length)
+      stl_A[i][static_cast<unsigned int>(static_cast<std::size_t>(randomNumber() * NumericT(N)) % N)] = NumericT(1) + randomNumber();
+  }
+  viennacl::copy(stl_A, A);
+}
+
+
+template<typename NumericT, typename Epsilon>
+int test_prod(viennacl::compressed_matrix<NumericT> const & A, viennacl::sparse_operator<NumericT> const & op, Epsilon const & epsilon, std::string const & name)
+{
+  viennacl::tools::uniform_random_numbers<NumericT> randomNumber;
+
+  std::vector<NumericT> std_x(A.size2());
+  for (std::size_t i=0; i<std_x.size(); ++i)
+    std_x[i] = randomNumber();
+  viennacl::vector<NumericT> x(A.size2());
+  viennacl::copy(std_x, x);
+
+  viennacl::vector<NumericT> y_ref = viennacl::linalg::prod(A, x);
+  viennacl::vector<NumericT> y = viennacl::linalg::prod(op, x);
+  NumericT error = diff(y, y_ref);
+
+  // y += A * x, y -= A * (2 * x):
+  viennacl::vector<NumericT> x2 = NumericT(2) * x;
+  y += viennacl::linalg::prod(op, x);
+  y -= viennacl::linalg::prod(op, x2);
+  y_ref = NumericT(0) * y_ref;
+  error = std::max(error, diff(y, y_ref));
+
+  if (error > epsilon)
+  {
+    std::cout << "# Error at operation: " << name << std::endl;
+    std::cout << "  diff: " << error << std::endl;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
+
+
+//
+// -------------------------------------------------------------
+//
+template< typename NumericT, typename Epsilon >
+int test(Epsilon const& epsilon)
+{
+  int retval = EXIT_SUCCESS;
+
+  std::cout << "Testing statistics of tridiagonal matrix" << std::endl;
+  std::size_t N = 1000;
+  viennacl::compressed_matrix<NumericT> T(N, N);
+  tridiagonal_matrix(T, N);
+  viennacl::tools::sparse_matrix_statistics stats = viennacl::tools::compute_sparse_matrix_statistics(T);
+  if (   stats.size1 != N || stats.size2 != N || stats.nnz != 3 * N - 2
+      || stats.min_row_length != 2 || stats.max_row_length != 3 || stats.bandwidth != 1 || stats.empty_rows != 0
+      || stats.row_length_histogram.size() != 3 || stats.row_length_histogram[2] != N
+      || std::fabs(stats.ell_padding_ratio - double(3 * N) / double(3 * N - 2)) > 1e-12)
+  {
+    std::cout << "# Error: Wrong statistics for tridiagonal matrix" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::cout << "Testing format prediction" << std::endl;
+  if (viennacl::tools::predict_sparse_format(stats) != viennacl::SPARSE_FORMAT_ELL)
+  {
+    std::cout << "# Error: ELL format not predicted for tridiagonal matrix" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  viennacl::compressed_matrix<NumericT> A(N + 13, N + 13);
+  random_matrix(A, N + 13, 1, 100);
+  stats = viennacl::tools::compute_sparse_matrix_statistics(A);
+  if (stats.ell_padding_ratio < 1.5 || viennacl::tools::predict_sparse_format(stats) == viennacl::SPARSE_FORMAT_ELL)
+  {
+    std::cout << "# Error: ELL format predicted for matrix with irregular row lengths" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  viennacl::compressed_matrix<NumericT> B(N, N);
+  banded_matrix(B, N);
+  stats = viennacl::tools::compute_sparse_matrix_statistics(B);
+  if (stats.bandwidth != 3 || viennacl::tools::predict_sparse_format(stats) != viennacl::SPARSE_FORMAT_CSR)
+  {
+    std::cout << "# Error: ELL format predicted for banded matrix with padding" << std::endl;
+    return EXIT_FAILURE;
+  }
+  stats.bandwidth = N / 2; // x no longer cached: the gathers from x dominate and the same padding is tolerated
+  if (viennacl::tools::predict_sparse_format(stats, 100) != viennacl::SPARSE_FORMAT_ELL)
+  {
+    std::cout << "# Error: ELL format not predicted for matrix with large bandwidth" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  viennacl::compressed_matrix<NumericT> L(N + 13, N + 13);
+  long_rows_matrix(L, N + 13);
+  stats = viennacl::tools::compute_sparse_matrix_statistics(L);
+  if (stats.hyb_ell_width != 5 || viennacl::tools::predict_sparse_format(stats) != viennacl::SPARSE_FORMAT_HYB)
+  {
+    std::cout << "# Error: HYB format not predicted for matrix with few long rows" << std::endl;
+    return EXIT_FAILURE;
+  }
+  retval = test_prod(L, viennacl::sparse_operator<NumericT>(L), epsilon, "prod() with HYB format");
+  if (retval != EXIT_SUCCESS)
+    return retval;
+
+  std::cout << "Testing sparse matrix-vector products for all formats" << std::endl;
+  viennacl::sparse_format formats[5] = { viennacl::SPARSE_FORMAT_CSR, viennacl::SPARSE_FORMAT_COO, viennacl::SPARSE_FORMAT_ELL,
+                                         viennacl::SPARSE_FORMAT_SLICED_ELL, viennacl::SPARSE_FORMAT_HYB };
+  char const * format_names[5] = { "CSR", "COO", "ELL", "SLICED_ELL", "HYB" };
+  for (std::size_t i=0; i<5; ++i)
+  {
+    viennacl::sparse_operator<NumericT> op(A, formats[i]);
+    if (op.format() != formats[i] || op.size1() != A.size1() || op.size2() != A.size2())
+    {
+      std::cout << "# Error: Wrong format or size of sparse_operator for format " << format_names[i] << std::endl;
+      return EXIT_FAILURE;
+    }
+    retval = test_prod(A, op, epsilon, std::string("prod() with format ") + format_names[i]);
+    if (retval != EXIT_SUCCESS)
+      return retval;
+  }
+
+  std::cout << "Testing sparse matrix-vector products with predicted and timed format" << std::endl;
+  viennacl::sparse_operator<NumericT> op_predicted(T);
+  if (op_predicted.format() != viennacl::SPARSE_FORMAT_ELL)
+  {
+    std::cout << "# Error: ELL format not used for tridiagonal matrix" << std::endl;
+    return EXIT_FAILURE;
+  }
+  retval = test_prod(T, op_predicted, epsilon, "prod() with predicted format");
+  if (retval != EXIT_SUCCESS)
+    return retval;
+
+  viennacl::sparse_operator<NumericT> op_timed(A, viennacl::sparse_format_tag(true, 3));
+  retval = test_prod(A, op_timed, epsilon, "prod() with timed format");
+  if (retval != EXIT_SUCCESS)
+    return retval;
+
+  // all ELL-type formats exceed the padding limit, CSR is used:
+  viennacl::sparse_format_tag restrictive_tag(true, 3);
+  restrictive_tag.max_trial_padding(0.5);
+  viennacl::sparse_operator<NumericT> op_restricted(A, restrictive_tag);
+  if (op_restricted.format() != viennacl::SPARSE_FORMAT_CSR)
+  {
+    std::cout << "# Error: CSR format not used in timed trial without ELL-type candidates" << std::endl;
+    return EXIT_FAILURE;
+  }
+  retval = test_prod(A, op_restricted, epsilon, "prod() with timed format and no ELL-type candidates");
+  if (retval != EXIT_SUCCESS)
+    return retval;
+
+  std::cout << "Testing CG solver with sparse_operator" << std::endl;
+  viennacl::vector<NumericT> b = viennacl::scalar_vector<NumericT>(T.size1(), NumericT(1));
+  viennacl::linalg::cg_tag tag(1e-5, static_cast<unsigned int>(2 * N));
+  viennacl::vector<NumericT> x_ref = viennacl::linalg::solve(T, b, tag);
+  viennacl::vector<NumericT> x = viennacl::linalg::solve(op_predicted, b, tag);
+  NumericT error = diff(x, x_ref);
+  if (error > epsilon * NumericT(100))
+  {
+    std::cout << "# Error at operation: CG solver" << std::endl;
+    std::cout << "  diff: " << error << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return retval;
+}
+
+
+//
+// -------------------------------------------------------------
+//
+int main()
+{
+  std::cout << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << "## Test :: Sparse Operator" << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << std::endl;
+
+  int retval = EXIT_SUCCESS;
+
+  std::cout << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << std::endl;
+  {
+    typedef float NumericT;
+    NumericT epsilon = static_cast<NumericT>(1E-4);
+    std::cout << "# Testing setup:" << std::endl;
+    std::cout << "  eps:     " << epsilon << std::endl;
+    std::cout << "  numeric: float" << std::endl;
+    retval = test<NumericT>(epsilon);
+    if ( retval == EXIT_SUCCESS )
+        std::cout << "# Test passed" << std::endl;
+    else
+        return retval;
+  }
+  std::cout << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << std::endl;
+#ifdef VIENNACL_WITH_OPENCL
+  if ( viennacl::ocl::current_device().double_support() )
+#endif
+  {
+    {
+      typedef double NumericT;
+      NumericT epsilon = 1.0E-12;
+      std::cout << "# Testing setup:" << std::endl;
+      std::cout << "  eps:     " << epsilon << std::endl;
+      std::cout << "  numeric: double" << std::endl;
+      retval = test<NumericT>(epsilon);
+      if ( retval == EXIT_SUCCESS )
+        std::cout << "# Test passed" << std::endl;
+      else
+        return retval;
+    }
+    std::cout << std::endl;
+    std::cout << "----------------------------------------------" << std::endl;
+    std::cout << std::endl;
+  }
+
+  std::cout << std::endl;
+  std::cout << "------- Test completed --------" << std::endl;
+  std::cout << std::endl;
+
+  return retval;
+}
@@ -35,6 +35,7 @@
 #include "viennacl/scalar.hpp"
 #include "viennacl/compressed_matrix.hpp"
 #include "viennacl/linalg/prod.hpp"
+#include "viennacl/linalg/amg_operations.hpp"
 
 #include "viennacl/tools/random.hpp"
 
@@ -129,27 +130,24 @@ void prod(std::vector<std::map<IndexT, NumericT> > const & stl_A,
 // -------------------------------------------------------------
 //
 template< typename NumericT, typename Epsilon >
-int test(Epsilon const& epsilon)
+int test_prod(Epsilon const& epsilon, std::size_t N, std::size_t K, std::size_t M, std::size_t nnz_row_A, std::size_t nnz_row_B)
 {
   int retval = EXIT_SUCCESS;
 
   viennacl::tools::uniform_random_numbers<NumericT> randomNumber;
 
-  std::size_t N = 210;
-  std::size_t K = 300;
-  std::size_t M = 420;
-  std::size_t nnz_row = 40;
+  std::cout << "Matrix sizes: A: " << N << "x" << K << ", B: " << K << "x" << M << std::endl;
   // --------------------------------------------------------------------------
   std::vector<std::map<unsigned int, NumericT> > stl_A(N);
   std::vector<std::map<unsigned int, NumericT> > stl_B(K);
   std::vector<std::map<unsigned int, NumericT> > stl_C(N);
 
   for (std::size_t i=0; i<stl_A.size(); ++i)
-    for (std::size_t j=0; j<nnz_row; ++j)
+    for (std::size_t j=0; j<nnz_row_A; ++j)
       stl_A[i][static_cast<unsigned int>(randomNumber() * NumericT(K))] = NumericT(1.0) + NumericT();
 
   for (std::size_t i=0; i<stl_B.size(); ++i)
-    for (std::size_t j=0; j<nnz_row; ++j)
+    for (std::size_t j=0; j<nnz_row_B; ++j)
       stl_B[i][static_cast<unsigned int>(randomNumber() * NumericT(M))] = NumericT(1.0) + NumericT();
 
 
@@ -192,9 +190,254 @@ int test(Epsilon const& epsilon)
     retval = EXIT_FAILURE;
   }
 
+  // symbolic/numeric split (currently host only):
+  if (viennacl::traits::active_handle_id(vcl_A) == viennacl::MAIN_MEMORY)
+  {
+    std::cout << "Testing products: spgemm_symbolic() and spgemm_numeric()" << std::endl;
+    viennacl::linalg::spgemm_plan plan = viennacl::linalg::spgemm_symbolic(vcl_A, vcl_B);
+    viennacl::compressed_matrix<NumericT> vcl_F;
+    viennacl::linalg::spgemm_numeric(plan, vcl_A, vcl_B, vcl_F);
+    if ( std::fabs(diff(stl_C, vcl_F)) > epsilon )
+    {
+      std::cout << "# Error at operation: matrix-matrix product with spgemm_numeric() (vcl_F)" << std::endl;
+      std::cout << "  diff: " << std::fabs(diff(stl_C, vcl_F)) << std::endl;
+      retval = EXIT_FAILURE;
+    }
+
+    // new values, same sparsity pattern:
+    for (std::size_t i=0; i<stl_A.size(); ++i)
+      for (typename std::map<unsigned int, NumericT>::iterator it = stl_A[i].begin(); it != stl_A[i].end(); ++it)
+        it->second = randomNumber();
+    viennacl::copy(adapted_stl_A, vcl_A);
+    for (std::size_t i=0; i<stl_C.size(); ++i)
+      stl_C[i].clear();
+    prod(stl_A, stl_B, stl_C);
+
+    viennacl::linalg::spgemm_numeric(plan, vcl_A, vcl_B, vcl_F);
+    if ( std::fabs(diff(stl_C, vcl_F)) > epsilon )
+    {
+      std::cout << "# Error at operation: matrix-matrix product with spgemm_numeric() and updated values (vcl_F)" << std::endl;
+      std::cout << "  diff: " << std::fabs(diff(stl_C, vcl_F)) << std::endl;
+      retval = EXIT_FAILURE;
+    }
+
+    // result with the same row lengths, but different column indices than the product, hence the pattern needs to be rewritten:
+    std::vector<std::map<unsigned int, NumericT> > stl_G(stl_C.size());
+    for (std::size_t i=0; i<stl_C.size(); ++i)
+      for (typename std::map<unsigned int, NumericT>::const_iterator it = stl_C[i].begin(); it != stl_C[i].end(); ++it)
+        stl_G[i][static_cast<unsigned int>((it->first + 1) % M)] = it->second;
+    viennacl::compressed_matrix<NumericT> vcl_G(N, M);
+    viennacl::copy(viennacl::tools::const_sparse_matrix_adapter<NumericT>(stl_G, N, M), vcl_G);
+    viennacl::linalg::spgemm_numeric(plan, vcl_A, vcl_B, vcl_G);
+    if ( std::fabs(diff(stl_C, vcl_G)) > epsilon )
+    {
+      std::cout << "# Error at operation: matrix-matrix product with spgemm_numeric() into matrix with different pattern (vcl_G)" << std::endl;
+      std::cout << "  diff: " << std::fabs(diff(stl_C, vcl_G)) << std::endl;
+      retval = EXIT_FAILURE;
+    }
+  }
+
   // --------------------------------------------------------------------------
   return retval;
 }
+
+template< typename NumericT, typename Epsilon >
+int test_galerkin(Epsilon const& epsilon, std::size_t N, std::size_t M, std::size_t nnz_row_A, std::size_t nnz_row_P)
+{
+  int retval = EXIT_SUCCESS;
+
+  viennacl::tools::uniform_random_numbers<NumericT> randomNumber;
+
+  std::cout << "Galerkin product sizes: A: " << N << "x" << N << ", P: " << N << "x" << M << std::endl;
+
+  std::vector<std::map<unsigned int, NumericT> > stl_A(N);
+  std::vector<std::map<unsigned int, NumericT> > stl_P(N);
+  std::vector<std::map<unsigned int, NumericT> > stl_R(M);
+  std::vector<std::map<unsigned int, NumericT> > stl_AP(N);
+  std::vector<std::map<unsigned int, NumericT> > stl_C(M);
+
+  for (std::size_t i=0; i<N; ++i)
+  {
+    stl_A[i][static_cast<unsigned int>(i)] = NumericT(1) + randomNumber();
+    for (std::size_t j=0; j<nnz_row_A; ++j)
+      stl_A[i][static_cast<unsigned int>(randomNumber() * NumericT(N))] = randomNumber();
+    for (std::size_t j=0; j<nnz_row_P; ++j)
+      stl_P[i][static_cast<unsigned int>(randomNumber() * NumericT(M))] = randomNumber();
+  }
+  for (std::size_t i=0; i<N; ++i)
+    for (typename std::map<unsigned int, NumericT>::const_iterator it = stl_P[i].begin(); it != stl_P[i].end(); ++it)
+      stl_R[it->first][static_cast<unsigned int>(i)] = it->second;
+
+  prod(stl_A, stl_P, stl_AP);
+  prod(stl_R, stl_AP, stl_C);
+
+  viennacl::compressed_matrix<NumericT> vcl_A(N, N);
+  viennacl::compressed_matrix<NumericT> vcl_P(N, M);
+  viennacl::compressed_matrix<NumericT> vcl_R(M, N);
+  viennacl::compressed_matrix<NumericT> vcl_C;
+
+  viennacl::tools::sparse_matrix_adapter<NumericT> adapted_stl_A(stl_A, N, N);
+  viennacl::tools::sparse_matrix_adapter<NumericT> adapted_stl_P(stl_P, N, M);
+  viennacl::tools::sparse_matrix_adapter<NumericT> adapted_stl_R(stl_R, M, N);
+  viennacl::copy(adapted_stl_A, vcl_A);
+  viennacl::copy(adapted_stl_P, vcl_P);
+  viennacl::copy(adapted_stl_R, vcl_R);
+
+  if (viennacl::traits::active_handle_id(vcl_A) != viennacl::MAIN_MEMORY) // fused Galerkin product currently host only
+    return retval;
+
+  std::cout << "Testing products: galerkin_product()" << std::endl;
+  viennacl::linalg::galerkin_plan plan;
+  viennacl::linalg::detail::amg::galerkin_product(vcl_R, vcl_A, vcl_P, vcl_C, plan);
+  if ( std::fabs(diff(stl_C, vcl_C)) > epsilon )
+  {
+    std::cout << "# Error at operation: Galerkin product R * A * P" << std::endl;
+    std::cout << "  diff: " << std::fabs(diff(stl_C, vcl_C)) << std::endl;
+    retval = EXIT_FAILURE;
+  }
+  if (plan.max_row_RA_length() == 0 || plan.max_row_RA_length() > N)
+  {
+    std::cout << "# Error at operation: Galerkin product R * A * P, bound for rows of R * A: " << plan.max_row_RA_length() << std::endl;
+    retval = EXIT_FAILURE;
+  }
+
+  // new values for A, same sparsity pattern (plan is reused):
+  for (std::size_t i=0; i<N; ++i)
+    for (typename std::map<unsigned int, NumericT>::iterator it = stl_A[i].begin(); it != stl_A[i].end(); ++it)
+      it->second = NumericT(2) * it->second + randomNumber();
+  viennacl::copy(adapted_stl_A, vcl_A);
+  for (std::size_t i=0; i<N; ++i)
+    stl_AP[i].clear();
+  for (std::size_t i=0; i<M; ++i)
+    stl_C[i].clear();
+  prod(stl_A, stl_P, stl_AP);
+  prod(stl_R, stl_AP, stl_C);
+
+  unsigned int const * C_col_buffer = viennacl::linalg::host_based::detail::extract_raw_pointer<unsigned int>(vcl_C.handle2());
+  viennacl::linalg::detail::amg::galerkin_product(vcl_R, vcl_A, vcl_P, vcl_C, plan);
+  if (viennacl::linalg::host_based::detail::extract_raw_pointer<unsigned int>(vcl_C.handle2()) != C_col_buffer)
+  {
+    std::cout << "# Error at operation: Galerkin product R * A * P with updated values: pattern of result rewritten" << std::endl;
+    retval = EXIT_FAILURE;
+  }
+  if ( std::fabs(diff(stl_C, vcl_C)) > epsilon )
+  {
+    std::cout << "# Error at operation: Galerkin product R * A * P with updated values" << std::endl;
+    std::cout << "  diff: " << std::fabs(diff(stl_C, vcl_C)) << std::endl;
+    retval = EXIT_FAILURE;
+  }
+
+  return retval;
+}
+
+template< typename NumericT, typename Epsilon >
+int test_masked(Epsilon const& epsilon, std::size_t N, std::size_t K, std::size_t M)
+{
+  int retval = EXIT_SUCCESS;
+
+  viennacl::tools::uniform_random_numbers<NumericT> randomNumber;
+
+  std::cout << "Masked product sizes: A: " << N << "x" << K << ", B: " << K << "x" << M << std::endl;
+
+  std::vector<std::map<unsigned int, NumericT> > stl_A(N);
+  std::vector<std::map<unsigned int, NumericT> > stl_B(K);
+  std::vector<std::map<unsigned int, NumericT> > stl_M(N);
+  std::vector<std::map<unsigned int, NumericT> > stl_AB(N);
+
+  // rows of different lengths in B and M, such that all strategies for intersecting rows of B with rows of M are used:
+  for (std::size_t i=0; i<N; ++i)
+  {
+    for (std::size_t j=0; j<10; ++j)
+      stl_A[i][static_cast<unsigned int>(randomNumber() * NumericT(K))] = NumericT(1) + randomNumber();
+    std::size_t nnz_row_M = (i % 4 == 0) ? M / 4 : ((i % 4 == 1) ? 0 : 3);
+    for (std::size_t j=0; j<nnz_row_M; ++j)
+      stl_M[i][static_cast<unsigned int>(randomNumber() * NumericT(M))] = NumericT(1);
+  }
+  for (std::size_t i=0; i<K; ++i)
+  {
+    std::size_t nnz_row_B = (i % 3 == 0) ? M / 2 : 3;
+    for (std::size_t j=0; j<nnz_row_B; ++j)
+      stl_B[i][static_cast<unsigned int>(randomNumber() * NumericT(M))] = NumericT(1) + randomNumber();
+  }
+
+  prod(stl_A, stl_B, stl_AB);
+
+  std::vector<std::map<unsigned int, NumericT> > stl_C(N);
+  std::vector<std::map<unsigned int, NumericT> > stl_C_complement(N);
+  for (std::size_t i=0; i<N; ++i)
+    for (typename std::map<unsigned int, NumericT>::const_iterator it = stl_AB[i].begin(); it != stl_AB[i].end(); ++it)
+    {
+      if (stl_M[i].find(it->first) != stl_M[i].end())
+        stl_C[i][it->first] = it->second;
+      else
+        stl_C_complement[i][it->first] = it->second;
+    }
+
+  viennacl::compressed_matrix<NumericT> vcl_A(N, K);
+  viennacl::compressed_matrix<NumericT> vcl_B(K, M);
+  viennacl::compressed_matrix<NumericT> vcl_M(N, M);
+  viennacl::compressed_matrix<NumericT> vcl_C;
+
+  viennacl::tools::sparse_matrix_adapter<NumericT> adapted_stl_A(stl_A, N, K);
+  viennacl::tools::sparse_matrix_adapter<NumericT> adapted_stl_B(stl_B, K, M);
+  viennacl::tools::sparse_matrix_adapter<NumericT> adapted_stl_M(stl_M, N, M);
+  viennacl::copy(adapted_stl_A, vcl_A);
+  viennacl::copy(adapted_stl_B, vcl_B);
+  viennacl::copy(adapted_stl_M, vcl_M);
+
+  if (viennacl::traits::active_handle_id(vcl_A) != viennacl::MAIN_MEMORY) // masked products currently host only
+    return retval;
+
+  std::cout << "Testing products: masked_prod()" << std::endl;
+  viennacl::linalg::masked_prod(vcl_A, vcl_B, vcl_M, vcl_C);
+  if ( std::fabs(diff(stl_C, vcl_C)) > epsilon )
+  {
+    std::cout << "# Error at operation: masked product (A * B) .* M" << std::endl;
+    std::cout << "  diff: " << std::fabs(diff(stl_C, vcl_C)) << std::endl;
+    retval = EXIT_FAILURE;
+  }
+
+  std::cout << "Testing products: masked_prod() with complemented mask" << std::endl;
+  vcl_C = viennacl::linalg::masked_prod(vcl_A, vcl_B, vcl_M, true);
+  if ( std::fabs(diff(stl_C_complement, vcl_C)) > epsilon )
+  {
+    std::cout << "# Error at operation: masked product (A * B) .* !M" << std::endl;
+    std::cout << "  diff: " << std::fabs(diff(stl_C_complement, vcl_C)) << std::endl;
+    retval = EXIT_FAILURE;
+  }
+
+  return retval;
+}
+
+template< typename NumericT, typename Epsilon >
+int test(Epsilon const& epsilon)
+{
+  int retval = EXIT_SUCCESS;
+
+  // high fill-in of the result rows
+  retval = test_prod<NumericT>(epsilon, 210, 300, 420, 40, 40);
+  if (retval != EXIT_SUCCESS)
+    return retval;
+
+  // many rows of B per row of C, sparse result rows
+  retval = test_prod<NumericT>(epsilon, 210, 300, 20000, 40, 40);
+  if (retval != EXIT_SUCCESS)
+    return retval;
+
+  // few rows of B per row of C
+  retval = test_prod<NumericT>(epsilon, 210, 300, 20000, 3, 40);
+  if (retval != EXIT_SUCCESS)
+    return retval;
+
+  // coarse grid operator as in algebraic multigrid
+  retval = test_galerkin<NumericT>(epsilon, 2000, 300, 7, 3);
+  if (retval != EXIT_SUCCESS)
+    return retval;
+
+  retval = test_masked<NumericT>(epsilon, 1000, 800, 2000);
+
+  return retval;
+}
 //
 // -------------------------------------------------------------
 //
@@ -0,0 +1,148 @@
+/* =========================================================================
+   Copyright (c) 2010-2016, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+   Portions of this software are copyright by UChicago Argonne, LLC.
+
+                            -----------------
+                  ViennaCL - The Vienna Computing Library
+                            -----------------
+
+   Project Head:    Karl Rupp                   rupp@iue.tuwien.ac.at
+
+   (A list of authors and contributors can be found in the PDF manual)
+
+   License:         MIT (X11), see file LICENSE in the base directory
+============================================================================= */
+
+#ifndef TEST_SPARSE_TEST_SYSTEMS_HPP_
+#define TEST_SPARSE_TEST_SYSTEMS_HPP_
+
+/* Model problems, residual checks and comparisons with reference matrices shared by the sparse matrix and solver tests */
+
+#include <cstddef>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+
+#include "viennacl/vector.hpp"
+#include "viennacl/compressed_matrix.hpp"
+#include "viennacl/linalg/prod.hpp"
+#include "viennacl/linalg/norm_2.hpp"
+
+/* Sets up the 5-point finite difference discretization of -Laplace(u) + convection + shift * u on a square grid with homogeneous Dirichlet boundary conditions.
+   The matrix is symmetric for zero convection. */
+template<typename NumericT>
+void convection_diffusion_2d(std::vector<std::map<unsigned int, NumericT> > & stl_A, std::size_t points_per_dim, NumericT convection, NumericT shift)
+{
+  std::size_t N = points_per_dim * points_per_dim;
+  stl_A.clear();
+  stl_A.resize(N);
+  for (std::size_t i=0; i<points_per_dim; ++i)
+    for (std::size_t j=0; j<points_per_dim; ++j)
+    {
+      unsigned int row = static_cast<unsigned int>(i * points_per_dim + j);
+      stl_A[row][row] = NumericT(4) + shift;
+      if (i > 0)                  stl_A[row][static_cast<unsigned int>(row - points_per_dim)] = NumericT(-1) - convection;
+      if (i < points_per_dim - 1) stl_A[row][static_cast<unsigned int>(row + points_per_dim)] = NumericT(-1) + convection;
+      if (j > 0)                  stl_A[row][row - 1] = NumericT(-1) - convection;
+      if (j < points_per_dim - 1) stl_A[row][row + 1] = NumericT(-1) + convection;
+    }
+}
+
+/* Sets up the 5-point finite difference discretization of -Laplace(u) + convection + shift * u on a square grid in a compressed_matrix */
+template<typename NumericT>
+void convection_diffusion_2d(viennacl::compressed_matrix<NumericT> & A, std::size_t points_per_dim, NumericT convection, NumericT shift = NumericT(0))
+{
+  std::vector<std::map<unsigned int, NumericT> > stl_A;
+  convection_diffusion_2d(stl_A, points_per_dim, convection, shift);
+  viennacl::copy(stl_A, A);
+}
+
+/* Sets up the 5-point finite difference discretization of -Laplace(u) + shift * u on a square grid (symmetric positive definite for nonnegative shift) */
+template<typename NumericT>
+void laplace_2d(std::vector<std::map<unsigned int, NumericT> > & stl_A, std::size_t points_per_dim, NumericT shift = NumericT(0))
+{
+  convection_diffusion_2d(stl_A, points_per_dim, NumericT(0), shift);
+}
+
+/* Sets up the 5-point finite difference discretization of -Laplace(u) + shift * u on a square grid in a compressed_matrix */
+template<typename NumericT>
+void laplace_2d(viennacl::compressed_matrix<NumericT> & A, std::size_t points_per_dim, NumericT shift = NumericT(0))
+{
+  convection_diffusion_2d(A, points_per_dim, NumericT(0), shift);
+}
+
+/* Returns the relative residual ||b - A x|| / ||b|| */
+template<typename MatrixT, typename NumericT>
+NumericT relative_residual(MatrixT const & A, viennacl::vector<NumericT> const & b, viennacl::vector<NumericT> const & x)
+{
+  viennacl::vector<NumericT> residual = viennacl::linalg::prod(A, x);
+  residual = b - residual;
+  return viennacl::linalg::norm_2(residual) / viennacl::linalg::norm_2(b);
+}
+
+/* Data recorded by monitor() */
+template<typename NumericT>
+struct monitor_data
+{
+  monitor_data() : calls(0), last_residual(0) {}
+  std::size_t calls;
+  NumericT last_residual;
+};
+
+/* Monitor callback for the iterative solvers: counts the calls and records the last reported residual in the monitor_data passed as 'data' */
+template<typename NumericT>
+bool monitor(viennacl::vector<NumericT> const &, NumericT residual, void * data)
+{
+  monitor_data<NumericT> * d = static_cast<monitor_data<NumericT> *>(data);
+  ++d->calls;
+  d->last_residual = residual;
+  return false;
+}
+
+/* Compares a ViennaCL sparse matrix with the reference. Returns EXIT_FAILURE if the sparsity patterns differ or the values are not within the tolerance. */
+template<typename MatrixT, typename NumericT, typename Epsilon>
+int check_sparse_matrix(MatrixT const & vcl_C, std::vector<std::map<unsigned int, NumericT> > const & stl_C, Epsilon const & epsilon, std::string const & name)
+{
+  std::vector<std::map<unsigned int, NumericT> > stl_result(vcl_C.size1());
+  viennacl::copy(vcl_C, stl_result);
+
+  bool patterns_match = (stl_result.size() == stl_C.size());
+  NumericT error = 0;
+  for (std::size_t i=0; patterns_match && i<stl_C.size(); ++i)
+  {
+    if (stl_C[i].size() != stl_result[i].size())
+    {
+      patterns_match = false;
+      break;
+    }
+
+    typename std::map<unsigned int, NumericT>::const_iterator it_result = stl_result[i].begin();
+    for (typename std::map<unsigned int, NumericT>::const_iterator it = stl_C[i].begin(); it != stl_C[i].end(); ++it, ++it_result)
+    {
+      if (it->first != it_result->first)
+      {
+        patterns_match = false;
+        break;
+      }
+      error = std::max(error, std::fabs(it->second - it_result->second) / std::max(NumericT(1), std::fabs(it->second)));
+    }
+  }
+
+  if (!patterns_match || error > epsilon)
+  {
+    std::cout << "# Error at operation: " << name << std::endl;
+    if (!patterns_match)
+      std::cout << "  sparsity patterns differ" << std::endl;
+    std::cout << "  diff: " << error << std::endl;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
+
+#endif
@@ -0,0 +1,437 @@
+/* =========================================================================
+   Copyright (c) 2010-2016, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+   Portions of this software are copyright by UChicago Argonne, LLC.
+
+                            -----------------
+                  ViennaCL - The Vienna Computing Library
+                            -----------------
+
+   Project Head:    Karl Rupp                   rupp@iue.tuwien.ac.at
+
+   (A list of authors and contributors can be found in the PDF manual)
+
+   License:         MIT (X11), see file LICENSE in the base directory
+============================================================================= */
+
+
+
+/** \file tests/src/sparse_transpose.cpp  Tests the transposition of sparse matrices and products with transposed sparse matrices.
+*   \test  Tests the transposition of sparse matrices and products with transposed sparse matrices.
+**/
+
+//
+// *** System
+//
+#include <iostream>
+#include <vector>
+#include <map>
+#include <cmath>
+
+
+//
+// *** ViennaCL
+//
+#include "viennacl/scalar.hpp"
+#include "viennacl/matrix.hpp"
+#include "viennacl/compressed_matrix.hpp"
+#include "viennacl/coordinate_matrix.hpp"
+#include "viennacl/ell_matrix.hpp"
+#include "viennacl/sliced_ell_matrix.hpp"
+#include "viennacl/hyb_matrix.hpp"
+#include "viennacl/linalg/sparse_matrix_operations.hpp"
+#include "viennacl/linalg/prod.hpp"
+#include "viennacl/linalg/norm_inf.hpp"
+
+#include "viennacl/tools/random.hpp"
+
+//
+// -------------------------------------------------------------
+//
+
+/* Routine for comparing two sparse matrices entry by entry. Returns the maximum difference, or 1 if the sparsity patterns do not match. */
+template<typename NumericT>
+NumericT diff(std::vector<std::map<unsigned int, NumericT> > const & stl_A,
+              std::vector<std::map<unsigned int, NumericT> > const & stl_B)
+{
+  if (stl_A.size() != stl_B.size())
+    return NumericT(1);
+
+  NumericT error = 0;
+  for (std::size_t i=0; i<stl_A.size(); ++i)
+  {
+    if (stl_A[i].size() != stl_B[i].size())
+      return NumericT(1);
+
+    typename std::map<unsigned int, NumericT>::const_iterator it_B = stl_B[i].begin();
+    for (typename std::map<unsigned int, NumericT>::const_iterator it_A = stl_A[i].begin(); it_A != stl_A[i].end(); ++it_A, ++it_B)
+    {
+      if (it_A->first != it_B->first)
+        return NumericT(1);
+      error = std::max(error, std::fabs(it_A->second - it_B->second));
+    }
+  }
+  return error;
+}
+
+/* Checks that the column indices within each row of a compressed_matrix are strictly increasing. */
+template<typename NumericT>
+bool rows_sorted(viennacl::compressed_matrix<NumericT> const & A)
+{
+  std::vector<unsigned int> row_buffer(A.size1() + 1);
+  std::vector<unsigned int> col_buffer(A.nnz());
+  viennacl::backend::memory_read(A.handle1(), 0, sizeof(unsigned int) * row_buffer.size(), &(row_buffer[0]));
+  viennacl::backend::memory_read(A.handle2(), 0, sizeof(unsigned int) * col_buffer.size(), &(col_buffer[0]));
+
+  for (std::size_t i=0; i<A.size1(); ++i)
+    for (unsigned int k = row_buffer[i] + 1; k < row_buffer[i+1]; ++k)
+      if (col_buffer[k-1] >= col_buffer[k])
+        return false;
+  return true;
+}
+
+template<typename MatrixT, typename NumericT, typename Epsilon>
+int check(MatrixT const & vcl_At, std::vector<std::map<unsigned int, NumericT> > const & stl_At, Epsilon const & epsilon, std::string const & name)
+{
+  std::vector<std::map<unsigned int, NumericT> > stl_result(vcl_At.size1());
+  viennacl::copy(vcl_At, stl_result);
+
+  if (vcl_At.size1() != stl_At.size() || diff(stl_At, stl_result) > epsilon)
+  {
+    std::cout << "# Error at operation: transpose() for " << name << std::endl;
+    std::cout << "  diff: " << diff(stl_At, stl_result) << std::endl;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
+
+
+/* Checks y = alpha * trans(A) * x + beta * y as well as C = trans(A) * B for a compressed_matrix A without forming trans(A). */
+template<typename NumericT, typename Epsilon>
+int test_trans_prod(Epsilon const & epsilon,
+                    viennacl::compressed_matrix<NumericT> const & vcl_A,
+                    std::vector<std::map<unsigned int, NumericT> > const & stl_A)
+{
+  viennacl::tools::uniform_random_numbers<NumericT> randomNumber;
+  std::size_t N = vcl_A.size1();
+  std::size_t M = vcl_A.size2();
+
+  //
+  // matrix-vector products:
+  //
+  std::cout << "Testing prod(trans(A), x) for compressed_matrix" << std::endl;
+  std::vector<NumericT> std_x(N);
+  std::vector<NumericT> std_y(M);
+  for (std::size_t i=0; i<N; ++i)
+    std_x[i] = randomNumber();
+  for (std::size_t i=0; i<M; ++i)
+    std_y[i] = randomNumber();
+
+  std::vector<NumericT> std_Atx(M);
+  for (std::size_t i=0; i<N; ++i)
+    for (typename std::map<unsigned int, NumericT>::const_iterator it = stl_A[i].begin(); it != stl_A[i].end(); ++it)
+      std_Atx[it->first] += it->second * std_x[i];
+
+  viennacl::vector<NumericT> vcl_x(N);
+  viennacl::vector<NumericT> vcl_y(M);
+  viennacl::copy(std_x, vcl_x);
+  viennacl::copy(std_y, vcl_y);
+
+  std::vector<NumericT> std_ref(M);
+  std::vector<NumericT> std_result(M);
+  for (int variant = 0; variant < 3; ++variant)
+  {
+    viennacl::vector<NumericT> vcl_result = vcl_y;
+    NumericT sign = 1;
+    if (variant == 0)
+      vcl_result = viennacl::linalg::prod(viennacl::trans(vcl_A), vcl_x);
+    else if (variant == 1)
+      vcl_result += viennacl::linalg::prod(viennacl::trans(vcl_A), vcl_x);
+    else
+    {
+      vcl_result -= viennacl::linalg::prod(viennacl::trans(vcl_A), vcl_x);
+      sign = -1;
+    }
+
+    NumericT norm_ref = 0;
+    for (std::size_t i=0; i<M; ++i)
+    {
+      std_ref[i] = (variant == 0 ? NumericT(0) : std_y[i]) + sign * std_Atx[i];
+      norm_ref = std::max(norm_ref, std::fabs(std_ref[i]));
+    }
+    viennacl::copy(vcl_result, std_result);
+
+    NumericT error = 0;
+    for (std::size_t i=0; i<M; ++i)
+      error = std::max(error, std::fabs(std_ref[i] - std_result[i]) / norm_ref);
+    if (error > epsilon)
+    {
+      std::cout << "# Error at operation: prod(trans(A), x), variant " << variant << std::endl;
+      std::cout << "  diff: " << error << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  //
+  // matrix-matrix products:
+  //
+  std::size_t const num_cols[2] = {3, 17};
+  for (std::size_t c=0; c<2; ++c)
+  {
+    std::cout << "Testing prod(trans(A), B) for compressed_matrix with " << num_cols[c] << " columns" << std::endl;
+    std::size_t K = num_cols[c];
+
+    std::vector<std::vector<NumericT> > std_B(N, std::vector<NumericT>(K));
+    for (std::size_t i=0; i<N; ++i)
+      for (std::size_t j=0; j<K; ++j)
+        std_B[i][j] = randomNumber();
+
+    std::vector<std::vector<NumericT> > std_C_ref(M, std::vector<NumericT>(K));
+    for (std::size_t i=0; i<N; ++i)
+      for (typename std::map<unsigned int, NumericT>::const_iterator it = stl_A[i].begin(); it != stl_A[i].end(); ++it)
+        for (std::size_t j=0; j<K; ++j)
+          std_C_ref[it->first][j] += it->second * std_B[i][j];
+
+    viennacl::matrix<NumericT, viennacl::row_major>    vcl_B_row(N, K);
+    viennacl::matrix<NumericT, viennacl::column_major> vcl_B_col(N, K);
+    viennacl::copy(std_B, vcl_B_row);
+    viennacl::copy(std_B, vcl_B_col);
+
+    viennacl::matrix<NumericT, viennacl::row_major>    vcl_C_row = viennacl::linalg::prod(viennacl::trans(vcl_A), vcl_B_col);
+    viennacl::matrix<NumericT, viennacl::column_major> vcl_C_col(M, K);
+    vcl_C_col = viennacl::linalg::prod(viennacl::trans(vcl_A), vcl_B_row);
+
+    std::vector<std::vector<NumericT> > std_C_row(M, std::vector<NumericT>(K));
+    std::vector<std::vector<NumericT> > std_C_col(M, std::vector<NumericT>(K));
+    viennacl::copy(vcl_C_row, std_C_row);
+    viennacl::copy(vcl_C_col, std_C_col);
+
+    NumericT norm_ref = 0;
+    NumericT error = 0;
+    for (std::size_t i=0; i<M; ++i)
+      for (std::size_t j=0; j<K; ++j)
+        norm_ref = std::max(norm_ref, std::fabs(std_C_ref[i][j]));
+    for (std::size_t i=0; i<M; ++i)
+      for (std::size_t j=0; j<K; ++j)
+      {
+        error = std::max(error, std::fabs(std_C_ref[i][j] - std_C_row[i][j]) / norm_ref);
+        error = std::max(error, std::fabs(std_C_ref[i][j] - std_C_col[i][j]) / norm_ref);
+      }
+    if (error > epsilon)
+    {
+      std::cout << "# Error at operation: prod(trans(A), B)" << std::endl;
+      std::cout << "  diff: " << error << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
+
+
+//
+// -------------------------------------------------------------
+//
+template< typename NumericT, typename Epsilon >
+int test(Epsilon const& epsilon, std::size_t N, std::size_t M, std::size_t nnz_row)
+{
+  int retval = EXIT_SUCCESS;
+
+  viennacl::tools::uniform_random_numbers<NumericT> randomNumber;
+
+  std::cout << "Matrix size: " << N << "x" << M << std::endl;
+
+  std::vector<std::map<unsigned int, NumericT> > stl_A(N);
+  std::vector<std::map<unsigned int, NumericT> > stl_At(M);
+
+  for (std::size_t i=0; i<N; ++i)
+  {
+    if (i % 17 == 3) // empty rows
+      continue;
+
+    stl_A[i][static_cast<unsigned int>(i % M)] = NumericT(1) + randomNumber(); // ensure row is nonempty
+    for (std::size_t j=0; j<nnz_row; ++j)
+      stl_A[i][static_cast<unsigned int>(randomNumber() * NumericT(M))] = NumericT(1) + randomNumber();
+  }
+  for (std::size_t i=0; i<N; ++i)
+    for (typename std::map<unsigned int, NumericT>::const_iterator it = stl_A[i].begin(); it != stl_A[i].end(); ++it)
+      stl_At[it->first][static_cast<unsigned int>(i)] = it->second;
+
+  viennacl::tools::const_sparse_matrix_adapter<NumericT> adapted_stl_A(stl_A, N, M);
+
+  //
+  // compressed_matrix:
+  //
+  std::cout << "Testing transpose() for compressed_matrix" << std::endl;
+  viennacl::compressed_matrix<NumericT> vcl_A(N, M);
+  viennacl::copy(adapted_stl_A, vcl_A);
+
+  viennacl::compressed_matrix<NumericT> vcl_At = viennacl::linalg::transpose(vcl_A);
+  retval = check(vcl_At, stl_At, epsilon, "compressed_matrix");
+  if (retval != EXIT_SUCCESS)
+    return retval;
+  if (!rows_sorted(vcl_At))
+  {
+    std::cout << "# Error at operation: transpose() for compressed_matrix (unsorted rows)" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::cout << "Testing B = trans(A) for compressed_matrix" << std::endl;
+  viennacl::compressed_matrix<NumericT> vcl_At2 = viennacl::trans(vcl_A);
+  retval = check(vcl_At2, stl_At, epsilon, "B = trans(A)");
+  if (retval != EXIT_SUCCESS)
+    return retval;
+
+  std::cout << "Testing trans(trans(A)) for compressed_matrix" << std::endl;
+  viennacl::compressed_matrix<NumericT> vcl_A2;
+  vcl_A2 = viennacl::trans(vcl_At);
+  retval = check(vcl_A2, stl_A, epsilon, "trans(trans(A))");
+  if (retval != EXIT_SUCCESS)
+    return retval;
+
+  retval = test_trans_prod(epsilon, vcl_A, stl_A);
+  if (retval != EXIT_SUCCESS)
+    return retval;
+
+  if (viennacl::traits::active_handle_id(vcl_A) != viennacl::MAIN_MEMORY) // remaining formats are supported in host memory only
+    return retval;
+
+  //
+  // coordinate_matrix:
+  //
+  std::cout << "Testing transpose() for coordinate_matrix" << std::endl;
+  viennacl::coordinate_matrix<NumericT> vcl_coo_A(N, M);
+  viennacl::copy(adapted_stl_A, vcl_coo_A);
+  viennacl::coordinate_matrix<NumericT> vcl_coo_At;
+  viennacl::linalg::transpose(vcl_coo_A, vcl_coo_At);
+  retval = check(vcl_coo_At, stl_At, epsilon, "coordinate_matrix");
+  if (retval != EXIT_SUCCESS)
+    return retval;
+
+  //
+  // ell_matrix:
+  //
+  std::cout << "Testing transpose() for ell_matrix" << std::endl;
+  viennacl::ell_matrix<NumericT> vcl_ell_A;
+  viennacl::copy(adapted_stl_A, vcl_ell_A);
+  viennacl::ell_matrix<NumericT> vcl_ell_At;
+  viennacl::linalg::transpose(vcl_ell_A, vcl_ell_At);
+  retval = check(vcl_ell_At, stl_At, epsilon, "ell_matrix");
+  if (retval != EXIT_SUCCESS)
+    return retval;
+
+  //
+  // sliced_ell_matrix:
+  //
+  std::cout << "Testing transpose() for sliced_ell_matrix" << std::endl;
+  viennacl::sliced_ell_matrix<NumericT> vcl_sell_A;
+  viennacl::copy(adapted_stl_A, vcl_sell_A);
+  viennacl::sliced_ell_matrix<NumericT> vcl_sell_At;
+  viennacl::linalg::transpose(vcl_sell_A, vcl_sell_At);
+  {
+    // no copy to the host available for sliced_ell_matrix, hence compare matrix-vector products:
+    std::vector<NumericT> std_x(N);
+    for (std::size_t i=0; i<N; ++i)
+      std_x[i] = randomNumber();
+    viennacl::vector<NumericT> vcl_x(N);
+    viennacl::copy(std_x, vcl_x);
+
+    viennacl::vector<NumericT> vcl_y_ref = viennacl::linalg::prod(vcl_At, vcl_x);
+    viennacl::vector<NumericT> vcl_y     = viennacl::linalg::prod(vcl_sell_At, vcl_x);
+    NumericT error = viennacl::linalg::norm_inf(vcl_y_ref - vcl_y) / viennacl::linalg::norm_inf(vcl_y_ref);
+    if (vcl_sell_At.size1() != M || vcl_sell_At.size2() != N || error > epsilon)
+    {
+      std::cout << "# Error at operation: transpose() for sliced_ell_matrix" << std::endl;
+      std::cout << "  diff: " << error << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  //
+  // hyb_matrix:
+  //
+  std::cout << "Testing transpose() for hyb_matrix" << std::endl;
+  viennacl::hyb_matrix<NumericT> vcl_hyb_A;
+  viennacl::copy(adapted_stl_A, vcl_hyb_A);
+  viennacl::hyb_matrix<NumericT> vcl_hyb_At;
+  viennacl::linalg::transpose(vcl_hyb_A, vcl_hyb_At);
+  retval = check(vcl_hyb_At, stl_At, epsilon, "hyb_matrix");
+
+  return retval;
+}
+
+template< typename NumericT, typename Epsilon >
+int test(Epsilon const& epsilon)
+{
+  int retval = test<NumericT>(epsilon, 50, 70, 5);    // single chunk, one column per bucket
+  if (retval != EXIT_SUCCESS)
+    return retval;
+
+  retval = test<NumericT>(epsilon, 20000, 30000, 10);   // multiple chunks, many columns per bucket
+  if (retval != EXIT_SUCCESS)
+    return retval;
+
+  return test<NumericT>(epsilon, 20000, 150001, 2);     // many more columns than nonzeros per thread
+}
+
+//
+// -------------------------------------------------------------
+//
+int main()
+{
+  std::cout << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << "## Test :: Sparse Matrix Transposition" << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << std::endl;
+
+  int retval = EXIT_SUCCESS;
+
+  std::cout << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << std::endl;
+  {
+    typedef float NumericT;
+    NumericT epsilon = static_cast<NumericT>(1E-4);
+    std::cout << "# Testing setup:" << std::endl;
+    std::cout << "  eps:     " << epsilon << std::endl;
+    std::cout << "  numeric: float" << std::endl;
+    retval = test<NumericT>(epsilon);
+    if ( retval == EXIT_SUCCESS )
+        std::cout << "# Test passed" << std::endl;
+    else
+        return retval;
+  }
+  std::cout << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << std::endl;
+
+#ifdef VIENNACL_WITH_OPENCL
+  if ( viennacl::ocl::current_device().double_support() )
+#endif
+  {
+    typedef double NumericT;
+    NumericT epsilon = 1.0E-12;
+    std::cout << "# Testing setup:" << std::endl;
+    std::cout << "  eps:     " << epsilon << std::endl;
+    std::cout << "  numeric: double" << std::endl;
+    retval = test<NumericT>(epsilon);
+    if ( retval == EXIT_SUCCESS )
+      std::cout << "# Test passed" << std::endl;
+    else
+      return retval;
+  }
+  std::cout << std::endl;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << std::endl;
+
+
+  std::cout << std::endl;
+  std::cout << "------- Test completed --------" << std::endl;
+  std::cout << std::endl;
+
+  return retval;
+}
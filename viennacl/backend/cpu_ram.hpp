@@ -23,14 +23,29 @@
 */
 
 #include <cassert>
+#include <cstring>
 #include <vector>
+#include <map>
+#include <algorithm>
 #ifdef VIENNACL_WITH_AVX2
 #include <stdlib.h>
 #endif
+#ifdef VIENNACL_WITH_OPENMP
+#include <omp.h>
+#endif
+#if defined(__linux__)
+#include <unistd.h>
+#include <sys/syscall.h>
+#endif
 
 #include "viennacl/forwards.h"
 #include "viennacl/tools/shared_ptr.hpp"
 
+// Default limit on the memory cached by the memory pool for buffers in main RAM (in bytes):
+#ifndef VIENNACL_MEMORY_POOL_MAX_BYTES_CACHED
+  #define VIENNACL_MEMORY_POOL_MAX_BYTES_CACHED (vcl_size_t(1) << 30)
+#endif
+
 namespace viennacl
 {
 namespace backend
@@ -62,9 +77,442 @@ namespace detail
 #endif
   };
 
+  /** @brief Stride in bytes at which uninitialized buffers are touched for first-touch page placement. Not larger than the page size of any supported platform. */
+  static const vcl_size_t first_touch_stride = 4096;
+
+  /** @brief Buffers are initialized and transfers are carried out by a single thread below this size in bytes */
+  static const vcl_size_t parallel_copy_min_size = 65536;
+
+  /** @brief Computes the range [begin, end) of the 'size' items assigned to thread 'thread_id' in a static partition into 'num_threads' contiguous blocks.
+  *
+  * Block sizes differ by at most one, with the larger blocks assigned to the first threads. This is the partition used by common OpenMP implementations
+  * for loops with schedule(static), so that pages placed by memory_create() reside on the NUMA node of the thread processing them in the host-based kernels.
+  */
+  inline void static_partition(vcl_size_t size, vcl_size_t thread_id, vcl_size_t num_threads, vcl_size_t & begin, vcl_size_t & end)
+  {
+    vcl_size_t block_size = size / num_threads;
+    vcl_size_t remainder  = size % num_threads;
+    begin = thread_id * block_size + std::min(thread_id, remainder);
+    end   = begin + block_size + ((thread_id < remainder) ? 1 : 0);
+  }
+
+  /** @brief Returns the number of threads among which the pages of a new buffer of the given size are distributed. Small buffers are touched by a single thread. */
+  inline vcl_size_t first_touch_threads(vcl_size_t size_in_bytes)
+  {
+#ifdef VIENNACL_WITH_OPENMP
+    if (size_in_bytes >= parallel_copy_min_size)
+      return static_cast<vcl_size_t>(omp_get_max_threads());
+#else
+    (void)size_in_bytes;
+#endif
+    return 1;
+  }
+
+  /** @brief Partition of a buffer into contiguous parts, one per thread, which determines the first-touch placement of its pages.
+  *
+  * By default, the bytes are split by static_partition(). For the column indices and values of a CSR matrix, the rows are split by static_partition() instead,
+  * and each part holds the nonzeros of the rows of one thread. This matches the row loops with schedule(static) in the host-based sparse kernels.
+  */
+  class first_touch_partition
+  {
+  public:
+    /** @brief Static partition of the bytes of a buffer */
+    first_touch_partition(vcl_size_t size_in_bytes, vcl_size_t num_parts)
+      : size_(size_in_bytes), num_parts_(std::max<vcl_size_t>(num_parts, 1)), row_buffer_(NULL), num_rows_(0) {}
+
+    /** @brief Partition of the nonzeros of a CSR matrix according to a static partition of its rows. 'row_buffer' holds num_rows + 1 entries in main memory. */
+    first_touch_partition(vcl_size_t size_in_bytes, vcl_size_t num_parts, unsigned int const * row_buffer, vcl_size_t num_rows)
+      : size_(size_in_bytes), num_parts_(std::max<vcl_size_t>(num_parts, 1)), row_buffer_(row_buffer), num_rows_(num_rows)
+    {
+      if (!row_buffer_ || row_buffer_[num_rows_] == 0)
+        row_buffer_ = NULL;
+    }
+
+    vcl_size_t size() const { return size_; }
+    vcl_size_t num_parts() const { return num_parts_; }
+
+    /** @brief Returns the byte range [begin, end) of part 'part' */
+    void get(vcl_size_t part, vcl_size_t & begin, vcl_size_t & end) const
+    {
+      if (!row_buffer_)
+      {
+        static_partition(size_, part, num_parts_, begin, end);
+        return;
+      }
+
+      vcl_size_t row_begin, row_end;
+      static_partition(num_rows_, part, num_parts_, row_begin, row_end);
+      vcl_size_t bytes_per_nonzero = size_ / row_buffer_[num_rows_];
+      begin = row_buffer_[row_begin] * bytes_per_nonzero;
+      end   = (part + 1 == num_parts_) ? size_ : row_buffer_[row_end] * bytes_per_nonzero;
+    }
+
+    /** @brief Identifies the page placement established by first_touch(). Buffers with the same key have their pages placed on the same threads' NUMA nodes.
+    *
+    * The key is derived from the first page of each part. Buffers touched by a single thread share the key zero.
+    */
+    vcl_size_t placement_key() const
+    {
+      if (num_parts_ <= 1)
+        return 0;
+
+      vcl_size_t key = num_parts_;
+      for (vcl_size_t part = 0; part < num_parts_; ++part)
+      {
+        vcl_size_t begin, end;
+        get(part, begin, end);
+        key = key * 1000003 + begin / first_touch_stride + 1;
+      }
+      return key * 1000003 + size_ / first_touch_stride + 1;
+    }
+
+  private:
+    vcl_size_t size_;
+    vcl_size_t num_parts_;
+    unsigned int const * row_buffer_;
+    vcl_size_t num_rows_;
+  };
+
+  /** @brief Touches a newly allocated buffer such that each page is first touched by the thread which processes it.
+  *
+  * The operating system places a page on the NUMA node of the thread touching it first, hence this establishes the placement for the subsequent kernels.
+  * One byte per page and the last byte of each part are set to zero.
+  */
+  inline void first_touch(char * raw_ptr, first_touch_partition const & partition)
+  {
+    vcl_size_t num_parts = partition.num_parts();
+
+#ifdef VIENNACL_WITH_OPENMP
+    #pragma omp parallel num_threads(static_cast<int>(num_parts)) if (num_parts > 1)
+#endif
+    {
+#ifdef VIENNACL_WITH_OPENMP
+      vcl_size_t thread_id   = static_cast<vcl_size_t>(omp_get_thread_num());
+      vcl_size_t num_threads = static_cast<vcl_size_t>(omp_get_num_threads());
+#else
+      vcl_size_t thread_id   = 0;
+      vcl_size_t num_threads = 1;
+#endif
+      // the runtime may provide fewer threads than requested:
+      for (vcl_size_t part = thread_id; part < num_parts; part += num_threads)
+      {
+        vcl_size_t begin, end;
+        partition.get(part, begin, end);
+
+        for (vcl_size_t i = begin; i < end; i += first_touch_stride)
+          raw_ptr[i] = 0;
+        if (end > begin) // the last page of an unaligned part may be missed by the stride
+          raw_ptr[end - 1] = 0;
+      }
+    }
+  }
+
+  /** @brief Copies 'bytes_to_copy' bytes from 'src' to 'dst' in memcpy() calls on contiguous blocks, one block per thread.
+  *
+  * Uses the same static partition as memory_create(), so that each thread accesses the pages placed on its NUMA node.
+  * Small transfers are carried out by a single thread. Overlapping source and destination ranges are handled by a single memmove().
+  */
+  inline void parallel_copy(char * dst, const char * src, vcl_size_t bytes_to_copy)
+  {
+    if (bytes_to_copy == 0 || dst == src)
+      return;
+
+    if ((dst < src + bytes_to_copy) && (src < dst + bytes_to_copy))
+    {
+      std::memmove(dst, src, bytes_to_copy);
+      return;
+    }
+
+#ifdef VIENNACL_WITH_OPENMP
+    #pragma omp parallel if (bytes_to_copy >= parallel_copy_min_size)
+#endif
+    {
+#ifdef VIENNACL_WITH_OPENMP
+      vcl_size_t thread_id   = static_cast<vcl_size_t>(omp_get_thread_num());
+      vcl_size_t num_threads = static_cast<vcl_size_t>(omp_get_num_threads());
+#else
+      vcl_size_t thread_id   = 0;
+      vcl_size_t num_threads = 1;
+#endif
+      vcl_size_t begin, end;
+      static_partition(bytes_to_copy, thread_id, num_threads, begin, end);
+
+      std::memcpy(dst + begin, src + begin, end - begin);
+    }
+  }
+
+
+  /** @brief Allocates a block of memory in main RAM */
+  inline char * raw_allocate(vcl_size_t size_in_bytes)
+  {
+#ifdef VIENNACL_WITH_AVX2
+    // Note: aligned_alloc not available on all compilers. Consider platform-specific alternatives such as posix_memalign()
+    return reinterpret_cast<char*>(aligned_alloc(32, size_in_bytes));
+#else
+    return new char[size_in_bytes];
+#endif
+  }
+
+  /** @brief Rounds a buffer size up to the size of the blocks cached by the memory pool.
+  *
+  * Blocks are at least 64 bytes large. Above, each power of two is divided into four size classes, so at most 25 percent of a block remain unused.
+  */
+  inline vcl_size_t memory_pool_size_class(vcl_size_t size_in_bytes)
+  {
+    if (size_in_bytes <= 64)
+      return 64;
+
+    vcl_size_t octave = 64;
+    while (2 * octave < size_in_bytes)
+      octave *= 2;
+    vcl_size_t step = octave / 4;
+    return ((size_in_bytes - 1) / step + 1) * step;
+  }
+
+  /** @brief Lock protecting the memory pool. Uses OpenMP locks if available, which are also safe for threads not created by OpenMP. */
+  class memory_pool_mutex
+  {
+  public:
+#ifdef VIENNACL_WITH_OPENMP
+    memory_pool_mutex()  { omp_init_lock(&lock_); }
+    ~memory_pool_mutex() { omp_destroy_lock(&lock_); }
+    void lock()   { omp_set_lock(&lock_); }
+    void unlock() { omp_unset_lock(&lock_); }
+  private:
+    omp_lock_t lock_;
+#else
+    void lock()   {}
+    void unlock() {}
+#endif
+  };
+
+  /** @brief Locks a memory_pool_mutex for the lifetime of the object */
+  class memory_pool_lock
+  {
+  public:
+    memory_pool_lock(memory_pool_mutex & m) : mutex_(m) { mutex_.lock(); }
+    ~memory_pool_lock() { mutex_.unlock(); }
+  private:
+    memory_pool_lock(memory_pool_lock const &);
+    memory_pool_lock & operator=(memory_pool_lock const &);
+
+    memory_pool_mutex & mutex_;
+  };
+
+}
+
+/** @brief Usage statistics of the memory pool for buffers in main RAM */
+struct memory_pool_statistics
+{
+  memory_pool_statistics() : hits(0), misses(0), bytes_in_use(0), peak_bytes_in_use(0), bytes_cached(0), blocks_cached(0) {}
+
+  /** @brief Number of buffer creations served from cached blocks */
+  vcl_size_t hits;
+  /** @brief Number of buffer creations which required a heap allocation */
+  vcl_size_t misses;
+  /** @brief Bytes in blocks currently used by buffers */
+  vcl_size_t bytes_in_use;
+  /** @brief Largest value of bytes_in_use since the statistics have been reset */
+  vcl_size_t peak_bytes_in_use;
+  /** @brief Bytes in blocks released by buffers and cached for reuse */
+  vcl_size_t bytes_cached;
+  /** @brief Number of blocks cached for reuse */
+  vcl_size_t blocks_cached;
+};
+
+namespace detail
+{
+  /** @brief Size class and page placement of a block cached by the memory pool */
+  struct memory_pool_key
+  {
+    memory_pool_key(vcl_size_t size, vcl_size_t placement) : class_size(size), placement_key(placement) {}
+
+    bool operator<(memory_pool_key const & other) const
+    {
+      return class_size < other.class_size || (class_size == other.class_size && placement_key < other.placement_key);
+    }
+
+    vcl_size_t class_size;
+    vcl_size_t placement_key;
+  };
+
+  /** @brief Caches the memory of destroyed buffers in main RAM for reuse by buffers of the same size class and page placement.
+  *
+  * Temporaries created in each call of the iterative solvers, the preconditioners, and the scheduler thus do not require heap allocations
+  * once the pool holds blocks of the respective sizes. Since the first-touch placement of a page cannot be changed by touching it again,
+  * blocks are only handed out to buffers which would have been touched by the same threads (see first_touch_partition::placement_key()).
+  * At most max_bytes_cached() bytes are cached, blocks released beyond this limit are returned to the heap.
+  */
+  class memory_pool
+  {
+    typedef std::map<memory_pool_key, std::vector<char *> >   free_list_map;
+
+  public:
+    memory_pool() : enabled_(true), max_bytes_cached_(VIENNACL_MEMORY_POOL_MAX_BYTES_CACHED) {}
+
+    /** @brief Returns a block of the given size class and placement. 'recycled' is set if the block is taken from the cache. */
+    char * allocate(memory_pool_key const & key, bool & recycled)
+    {
+      vcl_size_t class_size = key.class_size;
+      {
+        memory_pool_lock guard(mutex_);
+        stats_.bytes_in_use += class_size;
+        stats_.peak_bytes_in_use = std::max(stats_.peak_bytes_in_use, stats_.bytes_in_use);
+
+        free_list_map::iterator it = free_blocks_.find(key);
+        if (it != free_blocks_.end() && it->second.size() > 0)
+        {
+          char * block = it->second.back();
+          it->second.pop_back();
+          stats_.bytes_cached  -= class_size;
+          stats_.blocks_cached -= 1;
+          stats_.hits += 1;
+          recycled = true;
+          return block;
+        }
+        stats_.misses += 1;
+      }
+
+      recycled = false;
+      return raw_allocate(class_size);
+    }
+
+    /** @brief Returns a block to the cache, or to the heap if the pool is disabled or full */
+    void release(char * block, memory_pool_key const & key)
+    {
+      vcl_size_t class_size = key.class_size;
+      {
+        memory_pool_lock guard(mutex_);
+        stats_.bytes_in_use -= class_size;
+        if (enabled_ && stats_.bytes_cached + class_size <= max_bytes_cached_)
+        {
+          free_blocks_[key].push_back(block);
+          stats_.bytes_cached  += class_size;
+          stats_.blocks_cached += 1;
+          return;
+        }
+      }
+      array_deleter<char>()(block);
+    }
+
+    /** @brief Releases cached blocks to the heap, largest first, until at most 'max_bytes_cached' bytes remain cached */
+    void trim(vcl_size_t max_bytes_cached)
+    {
+      std::vector<char *> blocks_to_free;
+      {
+        memory_pool_lock guard(mutex_);
+        for (free_list_map::reverse_iterator it = free_blocks_.rbegin(); it != free_blocks_.rend() && stats_.bytes_cached > max_bytes_cached; ++it)
+        {
+          while (it->second.size() > 0 && stats_.bytes_cached > max_bytes_cached)
+          {
+            blocks_to_free.push_back(it->second.back());
+            it->second.pop_back();
+            stats_.bytes_cached  -= it->first.class_size;
+            stats_.blocks_cached -= 1;
+          }
+        }
+      }
+      for (vcl_size_t i = 0; i < blocks_to_free.size(); ++i)
+        array_deleter<char>()(blocks_to_free[i]);
+    }
+
+    bool enabled()
+    {
+      memory_pool_lock guard(mutex_);
+      return enabled_;
+    }
+
+    void enabled(bool b)
+    {
+      {
+        memory_pool_lock guard(mutex_);
+        enabled_ = b;
+      }
+      if (!b)
+        trim(0);
+    }
+
+    vcl_size_t max_bytes_cached()
+    {
+      memory_pool_lock guard(mutex_);
+      return max_bytes_cached_;
+    }
+
+    void max_bytes_cached(vcl_size_t max_bytes)
+    {
+      {
+        memory_pool_lock guard(mutex_);
+        max_bytes_cached_ = max_bytes;
+      }
+      trim(max_bytes);
+    }
+
+    memory_pool_statistics statistics()
+    {
+      memory_pool_lock guard(mutex_);
+      return stats_;
+    }
+
+    void reset_statistics()
+    {
+      memory_pool_lock guard(mutex_);
+      stats_.hits = 0;
+      stats_.misses = 0;
+      stats_.peak_bytes_in_use = stats_.bytes_in_use;
+    }
+
+  private:
+    memory_pool(memory_pool const &);
+    memory_pool & operator=(memory_pool const &);
+
+    bool                   enabled_;
+    vcl_size_t             max_bytes_cached_;
+    memory_pool_mutex      mutex_;
+    memory_pool_statistics stats_;
+    free_list_map          free_blocks_;
+  };
+
+  /** @brief Returns the memory pool for buffers in main RAM. The pool is never destroyed, since buffers in static objects may be released at any point during program termination. */
+  inline memory_pool & get_memory_pool()
+  {
+    static memory_pool * pool = new memory_pool();
+    return *pool;
+  }
+
+  /** @brief Deleter for buffers in main RAM: Returns the block to the memory pool */
+  struct memory_pool_deleter
+  {
+    memory_pool_deleter(memory_pool_key const & key) : key_(key) {}
+    void operator()(char * block) const { get_memory_pool().release(block, key_); }
+
+    memory_pool_key key_;
+  };
+
+}
+
+namespace detail
+{
+  /** @brief Creates an array in main RAM with the page placement given by 'partition', see memory_create() */
+  inline handle_type memory_create(first_touch_partition const & partition, const void * host_ptr)
+  {
+    vcl_size_t size_in_bytes = partition.size();
+    memory_pool_key key(memory_pool_size_class(size_in_bytes), partition.placement_key());
+    bool recycled = false;
+    handle_type new_handle(get_memory_pool().allocate(key, recycled), memory_pool_deleter(key));
+
+    // place pages of new blocks on the NUMA nodes of the threads processing them (recycled blocks already have the same placement) and copy data:
+    if (!recycled)
+      first_touch(new_handle.get(), partition);
+    if (host_ptr)
+      parallel_copy(new_handle.get(), static_cast<const char *>(host_ptr), size_in_bytes);
+
+    return new_handle;
+  }
 }
 
 /** @brief Creates an array of the specified size in main RAM. If the second argument is provided, the buffer is initialized with data from that pointer.
+ *
+ * The memory is taken from the memory pool if a block of the same size class and page placement has been released before.
  *
  * @param size_in_bytes   Number of bytes to allocate
  * @param host_ptr        Pointer to data which will be copied to the new array. Must point to at least 'size_in_bytes' bytes of data.
@@ -72,29 +520,19 @@ namespace detail
  */
 inline handle_type  memory_create(vcl_size_t size_in_bytes, const void * host_ptr = NULL)
 {
-#ifdef VIENNACL_WITH_AVX2
-  // Note: aligned_alloc not available on all compilers. Consider platform-specific alternatives such as posix_memalign()
-  if (!host_ptr)
-    return handle_type(reinterpret_cast<char*>(aligned_alloc(32, size_in_bytes)), detail::array_deleter<char>());
-
-  handle_type new_handle(reinterpret_cast<char*>(aligned_alloc(32, size_in_bytes)), detail::array_deleter<char>());
-#else
-  if (!host_ptr)
-    return handle_type(new char[size_in_bytes], detail::array_deleter<char>());
-
-  handle_type new_handle(new char[size_in_bytes], detail::array_deleter<char>());
-#endif
-
-  // copy data:
-  char * raw_ptr = new_handle.get();
-  const char * data_ptr = static_cast<const char *>(host_ptr);
-#ifdef VIENNACL_WITH_OPENMP
-    #pragma omp parallel for
-#endif
-  for (long i=0; i<long(size_in_bytes); ++i)
-    raw_ptr[i] = data_ptr[i];
+  return detail::memory_create(detail::first_touch_partition(size_in_bytes, detail::first_touch_threads(size_in_bytes)), host_ptr);
+}
 
-  return new_handle;
+/** @brief Creates the array of column indices or values of a CSR matrix in main RAM. The pages holding the nonzeros of a row are placed on the NUMA node of the thread processing the row.
+ *
+ * @param size_in_bytes   Number of bytes to allocate, a multiple of the number of nonzeros
+ * @param row_buffer      The row offsets of the CSR matrix (num_rows + 1 entries)
+ * @param num_rows        Number of rows of the CSR matrix
+ * @param host_ptr        Pointer to data which will be copied to the new array. Must point to at least 'size_in_bytes' bytes of data.
+ */
+inline handle_type  memory_create(vcl_size_t size_in_bytes, unsigned int const * row_buffer, vcl_size_t num_rows, const void * host_ptr = NULL)
+{
+  return detail::memory_create(detail::first_touch_partition(size_in_bytes, detail::first_touch_threads(size_in_bytes), row_buffer, num_rows), host_ptr);
 }
 
 /** @brief Copies 'bytes_to_copy' bytes from address 'src_buffer + src_offset' to memory starting at address 'dst_buffer + dst_offset'.
@@ -114,11 +552,7 @@ inline void memory_copy(handle_type const & src_buffer,
   assert( (dst_buffer.get() != NULL) && bool("Memory not initialized!"));
   assert( (src_buffer.get() != NULL) && bool("Memory not initialized!"));
 
-#ifdef VIENNACL_WITH_OPENMP
-  #pragma omp parallel for
-#endif
-  for (long i=0; i<long(bytes_to_copy); ++i)
-    dst_buffer.get()[vcl_size_t(i)+dst_offset] = src_buffer.get()[vcl_size_t(i) + src_offset];
+  detail::parallel_copy(dst_buffer.get() + dst_offset, src_buffer.get() + src_offset, bytes_to_copy);
 }
 
 /** @brief Writes data from main RAM identified by 'ptr' to the buffer identified by 'dst_buffer'
@@ -136,11 +570,7 @@ inline void memory_write(handle_type & dst_buffer,
 {
   assert( (dst_buffer.get() != NULL) && bool("Memory not initialized!"));
 
-#ifdef VIENNACL_WITH_OPENMP
-  #pragma omp parallel for
-#endif
-  for (long i=0; i<long(bytes_to_copy); ++i)
-    dst_buffer.get()[vcl_size_t(i)+dst_offset] = static_cast<const char *>(ptr)[i];
+  detail::parallel_copy(dst_buffer.get() + dst_offset, static_cast<const char *>(ptr), bytes_to_copy);
 }
 
 /** @brief Reads data from a buffer back to main RAM.
@@ -158,11 +588,174 @@ inline void memory_read(handle_type const & src_buffer,
 {
   assert( (src_buffer.get() != NULL) && bool("Memory not initialized!"));
 
+  detail::parallel_copy(static_cast<char *>(ptr), src_buffer.get() + src_offset, bytes_to_copy);
+}
+
+
+/** @brief Returns the usage statistics of the memory pool for buffers in main RAM */
+inline memory_pool_statistics memory_pool_stats()
+{
+  return detail::get_memory_pool().statistics();
+}
+
+/** @brief Resets the counters for hits and misses and sets the peak memory usage to the current usage */
+inline void memory_pool_reset_statistics()
+{
+  detail::get_memory_pool().reset_statistics();
+}
+
+/** @brief Releases cached blocks of the memory pool to the heap until at most 'max_bytes_cached' bytes remain cached */
+inline void memory_pool_trim(vcl_size_t max_bytes_cached = 0)
+{
+  detail::get_memory_pool().trim(max_bytes_cached);
+}
+
+/** @brief Returns the maximum number of bytes cached by the memory pool. Defaults to VIENNACL_MEMORY_POOL_MAX_BYTES_CACHED. */
+inline vcl_size_t memory_pool_max_bytes_cached()
+{
+  return detail::get_memory_pool().max_bytes_cached();
+}
+
+/** @brief Sets the maximum number of bytes cached by the memory pool. Cached blocks beyond the new limit are released. */
+inline void memory_pool_max_bytes_cached(vcl_size_t max_bytes)
+{
+  detail::get_memory_pool().max_bytes_cached(max_bytes);
+}
+
+/** @brief Returns true if the memory of destroyed buffers is cached for reuse */
+inline bool memory_pool_enabled()
+{
+  return detail::get_memory_pool().enabled();
+}
+
+/** @brief Enables or disables caching of the memory of destroyed buffers. Disabling releases all cached blocks. */
+inline void memory_pool_enabled(bool b)
+{
+  detail::get_memory_pool().enabled(b);
+}
+
+/** @brief Placement of the pages of a buffer in main RAM on the NUMA nodes of the system */
+struct memory_placement_statistics
+{
+  memory_placement_statistics() : num_pages(0), unknown_pages(0), local_pages(0) {}
+
+  /** @brief Number of pages spanned by the buffer */
+  vcl_size_t num_pages;
+  /** @brief Number of pages not yet backed by physical memory or for which the placement cannot be queried */
+  vcl_size_t unknown_pages;
+  /** @brief Number of pages on the NUMA node of the thread processing them under the static partition used by memory_create() */
+  vcl_size_t local_pages;
+  /** @brief Number of pages on each NUMA node */
+  std::vector<vcl_size_t> pages_per_node;
+};
+
+namespace detail
+{
+  /** @brief Queries the NUMA placement of the pages of a buffer in main RAM, see memory_placement() */
+  inline memory_placement_statistics memory_placement(handle_type const & buffer, first_touch_partition const & partition)
+  {
+    vcl_size_t size_in_bytes = partition.size();
+    memory_placement_statistics stats;
+    if (!buffer.get() || size_in_bytes == 0)
+      return stats;
+
+#if defined(__linux__)
+    vcl_size_t page_size = static_cast<vcl_size_t>(sysconf(_SC_PAGESIZE));
+#else
+    vcl_size_t page_size = first_touch_stride;
+#endif
+    vcl_size_t misalignment = reinterpret_cast<vcl_size_t>(buffer.get()) % page_size;
+    char * first_page = buffer.get() - misalignment;
+    stats.num_pages = (size_in_bytes + misalignment - 1) / page_size + 1;
+
+#if defined(__linux__) && defined(SYS_move_pages) && defined(SYS_getcpu)
+    std::vector<int> page_nodes(stats.num_pages, -1);
+    std::vector<int> page_local(stats.num_pages, 0);
+
+    vcl_size_t num_parts = partition.num_parts();
+    #ifdef VIENNACL_WITH_OPENMP
+    #pragma omp parallel num_threads(static_cast<int>(num_parts)) if (num_parts > 1)
+    #endif
+    {
 #ifdef VIENNACL_WITH_OPENMP
-  #pragma omp parallel for
+      vcl_size_t thread_id   = static_cast<vcl_size_t>(omp_get_thread_num());
+      vcl_size_t num_threads = static_cast<vcl_size_t>(omp_get_num_threads());
+#else
+      vcl_size_t thread_id   = 0;
+      vcl_size_t num_threads = 1;
 #endif
-  for (long i=0; i<long(bytes_to_copy); ++i)
-    static_cast<char *>(ptr)[i] = src_buffer.get()[vcl_size_t(i)+src_offset];
+      unsigned int cpu = 0;
+      unsigned int thread_node = 0;
+      bool node_known = (syscall(SYS_getcpu, &cpu, &thread_node, NULL) == 0);
+
+      for (vcl_size_t part = thread_id; part < num_parts; part += num_threads)
+      {
+        vcl_size_t begin, end;
+        partition.get(part, begin, end);
+
+        // each page is assigned to the thread processing its first byte in the buffer:
+        vcl_size_t page_begin = (begin > 0) ? (begin + misalignment - 1) / page_size + 1 : 0;
+        vcl_size_t page_end   = (end   > 0) ? (end   + misalignment - 1) / page_size + 1 : 0;
+
+        std::vector<void *> pages;
+        for (vcl_size_t i = page_begin; i < page_end; ++i)
+          pages.push_back(first_page + i * page_size);
+
+        // no target nodes: only query the node of each page
+        if (pages.size() > 0 && syscall(SYS_move_pages, 0, static_cast<unsigned long>(pages.size()), &(pages[0]), NULL, &(page_nodes[page_begin]), 0) == 0)
+        {
+          for (vcl_size_t i = page_begin; i < page_end; ++i)
+            page_local[i] = (node_known && page_nodes[i] == static_cast<int>(thread_node)) ? 1 : 0;
+        }
+        else
+          std::fill(page_nodes.begin() + static_cast<long>(page_begin), page_nodes.begin() + static_cast<long>(page_end), -1);
+      }
+    }
+
+    for (vcl_size_t i = 0; i < stats.num_pages; ++i)
+    {
+      if (page_nodes[i] < 0)
+      {
+        ++stats.unknown_pages;
+        continue;
+      }
+      if (stats.pages_per_node.size() <= static_cast<vcl_size_t>(page_nodes[i]))
+        stats.pages_per_node.resize(static_cast<vcl_size_t>(page_nodes[i]) + 1);
+      stats.pages_per_node[static_cast<vcl_size_t>(page_nodes[i])] += 1;
+      stats.local_pages += static_cast<vcl_size_t>(page_local[i]);
+    }
+#else
+    (void)first_page;
+    stats.unknown_pages = stats.num_pages;
+#endif
+
+    return stats;
+  }
+}
+
+/** @brief Queries the NUMA placement of the pages of a buffer in main RAM. Intended for verifying the first-touch placement of memory_create().
+ *
+ * The placement is only available on Linux kernels with NUMA support, otherwise all pages are reported as unknown.
+ * The number of local pages refers to the threads' current NUMA nodes, so threads should be bound to cores (e.g. OMP_PROC_BIND=true) for meaningful results.
+ *
+ * @param buffer          A smart pointer to the beginning of an allocated buffer
+ * @param size_in_bytes   Size of the buffer in bytes
+ */
+inline memory_placement_statistics memory_placement(handle_type const & buffer, vcl_size_t size_in_bytes)
+{
+  return detail::memory_placement(buffer, detail::first_touch_partition(size_in_bytes, detail::first_touch_threads(size_in_bytes)));
+}
+
+/** @brief Queries the NUMA placement of the pages of the column indices or values of a CSR matrix in main RAM, see memory_create() for CSR matrices.
+ *
+ * @param buffer          A smart pointer to the beginning of an allocated buffer
+ * @param size_in_bytes   Size of the buffer in bytes
+ * @param row_buffer      The row offsets of the CSR matrix (num_rows + 1 entries)
+ * @param num_rows        Number of rows of the CSR matrix
+ */
+inline memory_placement_statistics memory_placement(handle_type const & buffer, vcl_size_t size_in_bytes, unsigned int const * row_buffer, vcl_size_t num_rows)
+{
+  return detail::memory_placement(buffer, detail::first_touch_partition(size_in_bytes, detail::first_touch_threads(size_in_bytes), row_buffer, num_rows));
 }
 
 }
@@ -118,6 +118,37 @@ namespace backend
     }
   }
 
+  /** @brief Creates the array of column indices or values of a CSR matrix. If the third argument is provided, the buffer is initialized with data from that pointer.
+  *
+  * In main memory, the pages holding the nonzeros of a row are placed on the NUMA node of the thread processing the row in the host-based kernels.
+  * This requires the row offsets to be set up already, otherwise (and in the other memory domains) the buffer is created by memory_create().
+  *
+  * @param handle          The generic wrapper handle for multiple memory domains which will hold the new buffer.
+  * @param size_in_bytes   Number of bytes to allocate, a multiple of the number of nonzeros
+  * @param ctx             Context in which the buffer is created
+  * @param row_buffer      The row offsets of the CSR matrix
+  * @param num_rows        Number of rows of the CSR matrix
+  * @param host_ptr        Pointer to data which will be copied to the new array. Must point to at least 'size_in_bytes' bytes of data.
+  */
+  inline void memory_create_csr(mem_handle & handle, vcl_size_t size_in_bytes, viennacl::context const & ctx, mem_handle const & row_buffer, vcl_size_t num_rows, const void * host_ptr = NULL)
+  {
+    memory_types memory_type = (handle.get_active_handle_id() == MEMORY_NOT_INITIALIZED) ? ctx.memory_type() : handle.get_active_handle_id();
+    if (size_in_bytes > 0 && memory_type == MAIN_MEMORY
+        && row_buffer.get_active_handle_id() == MAIN_MEMORY && row_buffer.raw_size() >= sizeof(unsigned int) * (num_rows + 1))
+    {
+      unsigned int const * row_offsets = reinterpret_cast<unsigned int const *>(row_buffer.ram_handle().get());
+      if (row_offsets[num_rows] > 0 && size_in_bytes % row_offsets[num_rows] == 0)
+      {
+        handle.switch_active_handle_id(MAIN_MEMORY);
+        handle.ram_handle() = cpu_ram::memory_create(size_in_bytes, row_offsets, num_rows, host_ptr);
+        handle.raw_size(size_in_bytes);
+        return;
+      }
+    }
+
+    memory_create(handle, size_in_bytes, ctx, host_ptr);
+  }
+
   /*
   inline void memory_create(mem_handle & handle, vcl_size_t size_in_bytes, const void * host_ptr = NULL)
   {
@@ -293,6 +324,42 @@ namespace backend
 
 
 
+  /** @brief Returns the usage statistics of the memory pool which caches the memory of destroyed buffers in the given context.
+  *
+  * Pooling is currently only available for main memory.
+  */
+  inline cpu_ram::memory_pool_statistics memory_pool_stats(viennacl::context const & ctx)
+  {
+    switch (ctx.memory_type())
+    {
+    case MAIN_MEMORY:
+      return cpu_ram::memory_pool_stats();
+    case MEMORY_NOT_INITIALIZED:
+      throw memory_exception("not initialised!");
+    default:
+      throw memory_exception("not implemented");
+    }
+  }
+
+  /** @brief Releases cached memory of destroyed buffers in the given context until at most 'max_bytes_cached' bytes remain cached.
+  *
+  * Pooling is currently only available for main memory.
+  */
+  inline void memory_pool_trim(viennacl::context const & ctx, vcl_size_t max_bytes_cached = 0)
+  {
+    switch (ctx.memory_type())
+    {
+    case MAIN_MEMORY:
+      cpu_ram::memory_pool_trim(max_bytes_cached);
+      break;
+    case MEMORY_NOT_INITIALIZED:
+      throw memory_exception("not initialised!");
+    default:
+      throw memory_exception("not implemented");
+    }
+  }
+
+
   namespace detail
   {
     template<typename T>
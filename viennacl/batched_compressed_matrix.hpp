@@ -0,0 +1,214 @@
+#ifndef VIENNACL_BATCHED_COMPRESSED_MATRIX_HPP_
+#define VIENNACL_BATCHED_COMPRESSED_MATRIX_HPP_
+
+/* =========================================================================
+   Copyright (c) 2010-2016, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+   Portions of this software are copyright by UChicago Argonne, LLC.
+
+                            -----------------
+                  ViennaCL - The Vienna Computing Library
+                            -----------------
+
+   Project Head:    Karl Rupp                   rupp@iue.tuwien.ac.at
+
+   (A list of authors and contributors can be found in the manual)
+
+   License:         MIT (X11), see file LICENSE in the base directory
+============================================================================= */
+
+/** @file viennacl/batched_compressed_matrix.hpp
+    @brief Implementation of the batched_compressed_matrix class (a batch of independent small CSR matrices, host memory only)
+*/
+
+#include <vector>
+#include <cassert>
+#include "viennacl/forwards.h"
+#include "viennacl/vector.hpp"
+#include "viennacl/compressed_matrix.hpp"
+
+namespace viennacl
+{
+
+/** @brief A batch of independent square sparse matrices in CSR format, for instance one system per cell or particle.
+*
+* Two layouts are supported:
+*  - Shared pattern: All systems have the sparsity pattern of a single compressed_matrix. Only the values are stored per system, system after system.
+*  - Block-diagonal: The systems are the diagonal blocks of a single compressed_matrix. System i consists of the rows and columns block_offsets[i], ..., block_offsets[i+1]-1.
+*
+* In both cases the right hand sides and solutions of all systems are concatenated to a single vector of size size1().
+* The data is kept in host memory, since the batched solvers process one system per thread.
+*
+* @tparam NumericT    Floating point type
+*/
+template<class NumericT>
+class batched_compressed_matrix
+{
+public:
+  typedef viennacl::backend::mem_handle                                                              handle_type;
+  typedef scalar<typename viennacl::tools::CHECK_SCALAR_TEMPLATE_ARGUMENT<NumericT>::ResultType>   value_type;
+  typedef vcl_size_t                                                                                 size_type;
+
+  /** @brief Default construction of a batch. No memory is allocated */
+  batched_compressed_matrix() : batch_size_(0), rows_(0), pattern_nnz_(0), shared_pattern_(false) {}
+
+  /** @brief Creates a batch of 'batch_size' systems with the sparsity pattern of 'pattern'. The values of all systems are initialized with the values of 'pattern'. */
+  template<unsigned int AlignmentV>
+  batched_compressed_matrix(compressed_matrix<NumericT, AlignmentV> const & pattern, vcl_size_t batch_size)
+    : batch_size_(batch_size), rows_(pattern.size1() * batch_size), pattern_nnz_(0), shared_pattern_(true)
+  {
+    assert(pattern.size1() == pattern.size2() && bool("Systems must be square"));
+
+    std::vector<unsigned int> row_buffer, col_buffer;
+    std::vector<NumericT> elements;
+    read_host_copy(pattern, row_buffer, col_buffer, elements);
+    pattern_nnz_ = col_buffer.size();
+
+    std::vector<unsigned int> offsets(batch_size_ + 1);
+    for (vcl_size_t i = 0; i <= batch_size_; ++i)
+      offsets[i] = static_cast<unsigned int>(i * pattern.size1());
+
+    std::vector<NumericT> batch_elements(pattern_nnz_ * batch_size_);
+    for (vcl_size_t i = 0; i < batch_size_; ++i)
+      std::copy(elements.begin(), elements.end(), batch_elements.begin() + static_cast<long>(i * pattern_nnz_));
+
+    create_buffers(row_buffer, col_buffer, batch_elements, offsets);
+  }
+
+  /** @brief Creates a batch from the diagonal blocks of a block-diagonal matrix A. System i consists of the rows and columns block_offsets[i], ..., block_offsets[i+1]-1. Entries outside of the diagonal blocks are not permitted. */
+  template<unsigned int AlignmentV>
+  batched_compressed_matrix(compressed_matrix<NumericT, AlignmentV> const & A, std::vector<vcl_size_t> const & block_offsets)
+    : batch_size_(block_offsets.size() > 0 ? block_offsets.size() - 1 : 0), rows_(A.size1()), pattern_nnz_(0), shared_pattern_(false)
+  {
+    assert(A.size1() == A.size2() && bool("Block-diagonal matrix must be square"));
+    assert(block_offsets.size() > 0 && block_offsets[0] == 0 && block_offsets.back() == A.size1() && bool("Block offsets must cover all rows"));
+
+    std::vector<unsigned int> row_buffer, col_buffer;
+    std::vector<NumericT> elements;
+    read_host_copy(A, row_buffer, col_buffer, elements);
+
+    std::vector<unsigned int> offsets(block_offsets.size());
+    for (vcl_size_t i = 0; i < block_offsets.size(); ++i)
+      offsets[i] = static_cast<unsigned int>(block_offsets[i]);
+
+#ifndef NDEBUG
+    for (vcl_size_t i = 0; i < batch_size_; ++i)
+      for (vcl_size_t row = offsets[i]; row < offsets[i+1]; ++row)
+        for (vcl_size_t k = row_buffer[row]; k < row_buffer[row+1]; ++k)
+          assert(col_buffer[k] >= offsets[i] && col_buffer[k] < offsets[i+1] && bool("Entry outside of the diagonal blocks"));
+#endif
+
+    create_buffers(row_buffer, col_buffer, elements, offsets);
+  }
+
+  /** @brief Overwrites the values of system i of a batch with shared pattern. 'values' holds one value per nonzero of the pattern, in the order of the pattern. */
+  void set_values(vcl_size_t i, NumericT const * values)
+  {
+    assert(shared_pattern_ && bool("Values can only be set per system for a batch with shared pattern"));
+    assert(i < batch_size_ && bool("System index out of range"));
+    if (pattern_nnz_ > 0)
+      viennacl::backend::memory_write(elements_, sizeof(NumericT) * i * pattern_nnz_, sizeof(NumericT) * pattern_nnz_, values);
+  }
+
+  /** @brief Overwrites the values of system i of a batch with shared pattern. */
+  void set_values(vcl_size_t i, std::vector<NumericT> const & values)
+  {
+    assert(values.size() == pattern_nnz_ && bool("Number of values does not match pattern"));
+    set_values(i, values.size() > 0 ? &(values[0]) : NULL);
+  }
+
+  /** @brief Returns the number of systems in the batch */
+  vcl_size_t batch_size() const { return batch_size_; }
+  /** @brief Returns the total number of rows (sum of the sizes of all systems) */
+  vcl_size_t size1() const { return rows_; }
+  /** @brief Returns the total number of columns (sum of the sizes of all systems) */
+  vcl_size_t size2() const { return rows_; }
+  /** @brief Returns true if all systems share a single sparsity pattern */
+  bool shared_pattern() const { return shared_pattern_; }
+  /** @brief Returns the number of nonzeros of the shared pattern. Zero for block-diagonal batches. */
+  vcl_size_t pattern_nnz() const { return pattern_nnz_; }
+
+  /** @brief Returns the index of the first row of system i in the concatenated vectors */
+  vcl_size_t system_start(vcl_size_t i) const { return system_offsets()[i]; }
+  /** @brief Returns the number of unknowns of system i */
+  vcl_size_t system_size(vcl_size_t i) const { return system_offsets()[i+1] - system_offsets()[i]; }
+
+  /** @brief  Returns the handle to the row index array. For a shared pattern, the row array of the pattern. For a block-diagonal batch, the row array of the full matrix. */
+  const handle_type & handle1() const { return row_buffer_; }
+  /** @brief  Returns the handle to the column index array */
+  const handle_type & handle2() const { return col_buffer_; }
+  /** @brief  Returns the handle to the array of the first row of each system (batch_size() + 1 entries) */
+  const handle_type & handle3() const { return system_offsets_; }
+  /** @brief  Returns the handle to the matrix entry array. For a shared pattern, the values of all systems one after another. */
+  const handle_type & handle() const { return elements_; }
+
+  /** @brief Returns the current memory context. Always MAIN_MEMORY once the batch is initialized. */
+  viennacl::memory_types memory_context() const
+  {
+    return row_buffer_.get_active_handle_id();
+  }
+
+private:
+  template<unsigned int AlignmentV>
+  static void read_host_copy(compressed_matrix<NumericT, AlignmentV> const & A,
+                             std::vector<unsigned int> & row_buffer, std::vector<unsigned int> & col_buffer, std::vector<NumericT> & elements)
+  {
+    viennacl::backend::typesafe_host_array<unsigned int> row_array(A.handle1(), A.size1() + 1);
+    if (A.size1() > 0)
+      viennacl::backend::memory_read(A.handle1(), 0, row_array.raw_size(), row_array.get());
+
+    row_buffer.resize(A.size1() + 1);
+    for (vcl_size_t i = 0; i < row_buffer.size(); ++i)
+      row_buffer[i] = static_cast<unsigned int>(A.size1() > 0 ? row_array[i] : 0);
+
+    vcl_size_t nnz = row_buffer.back();
+    viennacl::backend::typesafe_host_array<unsigned int> col_array(A.handle2(), nnz);
+    elements.resize(nnz);
+    if (nnz > 0)
+    {
+      viennacl::backend::memory_read(A.handle2(), 0, col_array.raw_size(), col_array.get());
+      viennacl::backend::memory_read(A.handle(), 0, sizeof(NumericT) * nnz, &(elements[0]));
+    }
+
+    col_buffer.resize(nnz);
+    for (vcl_size_t i = 0; i < nnz; ++i)
+      col_buffer[i] = static_cast<unsigned int>(col_array[i]);
+  }
+
+  void create_buffers(std::vector<unsigned int> const & row_buffer, std::vector<unsigned int> const & col_buffer,
+                      std::vector<NumericT> const & elements, std::vector<unsigned int> const & offsets)
+  {
+    viennacl::context host_ctx(viennacl::MAIN_MEMORY);
+    row_buffer_.switch_active_handle_id(viennacl::MAIN_MEMORY);
+    col_buffer_.switch_active_handle_id(viennacl::MAIN_MEMORY);
+    elements_.switch_active_handle_id(viennacl::MAIN_MEMORY);
+    system_offsets_.switch_active_handle_id(viennacl::MAIN_MEMORY);
+
+    // buffers are never empty, so that the raw pointers are always valid:
+    unsigned int zero_index = 0;
+    NumericT zero_value = 0;
+    viennacl::backend::memory_create(row_buffer_,     sizeof(unsigned int) * row_buffer.size(),                       host_ctx, &(row_buffer[0]));
+    viennacl::backend::memory_create(col_buffer_,     sizeof(unsigned int) * std::max<vcl_size_t>(col_buffer.size(), 1), host_ctx, col_buffer.size() > 0 ? &(col_buffer[0]) : &zero_index);
+    viennacl::backend::memory_create(elements_,       sizeof(NumericT)     * std::max<vcl_size_t>(elements.size(), 1),   host_ctx, elements.size() > 0 ? &(elements[0]) : &zero_value);
+    viennacl::backend::memory_create(system_offsets_, sizeof(unsigned int) * offsets.size(),                          host_ctx, &(offsets[0]));
+  }
+
+  unsigned int const * system_offsets() const
+  {
+    return reinterpret_cast<unsigned int const *>(system_offsets_.ram_handle().get());
+  }
+
+  vcl_size_t batch_size_;
+  vcl_size_t rows_;
+  vcl_size_t pattern_nnz_;
+  bool shared_pattern_;
+  handle_type row_buffer_;
+  handle_type col_buffer_;
+  handle_type elements_;
+  handle_type system_offsets_;
+};
+
+}
+
+#endif
@@ -831,6 +831,30 @@ public:
     generate_row_block_information();
   }
 
+  /** @brief Creates a compressed matrix from the transpose of another compressed_matrix (B = trans(A)). The result is located in the same memory domain as A. */
+  compressed_matrix(matrix_expression<const compressed_matrix, const compressed_matrix, op_trans> const & proxy)
+    : rows_(0), cols_(0), nonzeros_(0), row_block_num_(0)
+  {
+    viennacl::context ctx = viennacl::traits::context(proxy.lhs());
+
+    row_buffer_.switch_active_handle_id(ctx.memory_type());
+    col_buffer_.switch_active_handle_id(ctx.memory_type());
+    elements_.switch_active_handle_id(ctx.memory_type());
+    row_blocks_.switch_active_handle_id(ctx.memory_type());
+
+#ifdef VIENNACL_WITH_OPENCL
+    if (ctx.memory_type() == OPENCL_MEMORY)
+    {
+      row_buffer_.opencl_handle().context(ctx.opencl_context());
+      col_buffer_.opencl_handle().context(ctx.opencl_context());
+      elements_.opencl_handle().context(ctx.opencl_context());
+      row_blocks_.opencl_handle().context(ctx.opencl_context());
+    }
+#endif
+
+    viennacl::linalg::transpose(proxy.lhs(), *this);
+  }
+
 
   compressed_matrix(compressed_matrix const & other) :
     rows_(other.size1()), cols_(other.size2()), nonzeros_(other.nnz()), row_block_num_(other.row_block_num_)
@@ -889,6 +913,17 @@ public:
     return *this;
   }
 
+  /** @brief Assignment of the transpose of a compressed_matrix (B = trans(A)). */
+  compressed_matrix & operator=(matrix_expression<const compressed_matrix, const compressed_matrix, op_trans> const & proxy)
+  {
+    assert( (rows_ == 0 || rows_ == proxy.lhs().size2()) && bool("Size mismatch") );
+    assert( (cols_ == 0 || cols_ == proxy.lhs().size1()) && bool("Size mismatch") );
+
+    viennacl::linalg::transpose(proxy.lhs(), *this);
+
+    return *this;
+  }
+
 
   /** @brief Sets the row, column and value arrays of the compressed matrix
     *
@@ -919,10 +954,10 @@ public:
     viennacl::backend::memory_create(row_buffer_, viennacl::backend::typesafe_host_array<unsigned int>(row_buffer_).element_size() * (rows + 1), viennacl::traits::context(row_buffer_), row_jumper);
 
     //col_buffer_.switch_active_handle_id(viennacl::backend::OPENCL_MEMORY);
-    viennacl::backend::memory_create(col_buffer_, viennacl::backend::typesafe_host_array<unsigned int>(col_buffer_).element_size() * nonzeros, viennacl::traits::context(col_buffer_), col_buffer);
+    viennacl::backend::memory_create_csr(col_buffer_, viennacl::backend::typesafe_host_array<unsigned int>(col_buffer_).element_size() * nonzeros, viennacl::traits::context(col_buffer_), row_buffer_, rows, col_buffer);
 
     //elements_.switch_active_handle_id(viennacl::backend::OPENCL_MEMORY);
-    viennacl::backend::memory_create(elements_, sizeof(NumericT) * nonzeros, viennacl::traits::context(elements_), elements);
+    viennacl::backend::memory_create_csr(elements_, sizeof(NumericT) * nonzeros, viennacl::traits::context(elements_), row_buffer_, rows, elements);
 
     nonzeros_ = nonzeros;
     rows_ = rows;
@@ -932,6 +967,80 @@ public:
     generate_row_block_information();
   }
 
+  /** @brief Sets up the matrix from (row, column, value) triplets given in arbitrary order. Values of duplicate entries are summed.
+    *
+    * The triplets are sorted in parallel, no intermediate std::map or similar containers are used.
+    * If the matrix is empty, its size is deduced from the largest row and column index. Otherwise, all indices must be within the current size.
+    *
+    * @param row_indices    Pointer to an array holding the row index of each triplet. The array length is 'n'
+    * @param col_indices    Pointer to an array holding the column index of each triplet. The array length is 'n'
+    * @param values         Pointer to an array holding the value of each triplet. The array length is 'n'
+    * @param n              Number of triplets
+    */
+  void assemble_from_triplets(unsigned int const * row_indices, unsigned int const * col_indices, NumericT const * values, vcl_size_t n)
+  {
+    viennacl::linalg::assemble_from_triplets(row_indices, col_indices, values, n, *this);
+  }
+
+  /** @brief Sets up the matrix from (row, column, value) triplets given in arbitrary order. Values of duplicate entries are summed. Convenience overload for std::vector. */
+  void assemble_from_triplets(std::vector<unsigned int> const & row_indices, std::vector<unsigned int> const & col_indices, std::vector<NumericT> const & values)
+  {
+    assert( (row_indices.size() == values.size() && col_indices.size() == values.size()) && bool("Error in compressed_matrix::assemble_from_triplets(): Array sizes do not match!"));
+    if (values.size() > 0)
+      assemble_from_triplets(&(row_indices[0]), &(col_indices[0]), &(values[0]), values.size());
+  }
+
+  /** @brief Overwrites the nonzero values while keeping the sparsity pattern. No memory is reallocated.
+    *
+    * The row and column arrays as well as the row block information for CSR-adaptive products only depend on the sparsity pattern and thus remain valid.
+    * Typical use is the update of a Jacobian with fixed sparsity pattern in Newton iterations.
+    *
+    * @param values    Pointer to an array in host memory holding the new values in the order of the internal storage (row by row as given by handle1() and handle2())
+    */
+  void set_values(NumericT const * values)
+  {
+    vcl_size_t num_values = stored_nonzeros();
+    if (num_values > 0)
+      viennacl::backend::memory_write(elements_, 0, sizeof(NumericT) * num_values, values);
+  }
+
+  /** @brief Overwrites the nonzero values with the entries of a vector while keeping the sparsity pattern. The vector is not required to reside in the same memory domain. */
+  void set_values(viennacl::vector_base<NumericT> const & values)
+  {
+    vcl_size_t num_values = stored_nonzeros();
+    assert(values.size() >= num_values && values.stride() == 1 && bool("Error in compressed_matrix::set_values(): Vector too short or not contiguous!"));
+    if (num_values == 0)
+      return;
+
+    if (values.handle().get_active_handle_id() == elements_.get_active_handle_id())
+      viennacl::backend::memory_copy(values.handle(), elements_, sizeof(NumericT) * values.start(), 0, sizeof(NumericT) * num_values);
+    else
+    {
+      std::vector<NumericT> host_values(num_values);
+      viennacl::backend::memory_read(values.handle(), sizeof(NumericT) * values.start(), sizeof(NumericT) * num_values, &(host_values[0]));
+      viennacl::backend::memory_write(elements_, 0, sizeof(NumericT) * num_values, &(host_values[0]));
+    }
+  }
+
+  /** @brief Overwrites the nonzero values with the values of a matrix with identical sparsity pattern (e.g. an updated Jacobian). The other matrix is not required to reside in the same memory domain. */
+  template<unsigned int AlignmentV2>
+  void set_values(compressed_matrix<NumericT, AlignmentV2> const & other)
+  {
+    assert(other.size1() == rows_ && other.size2() == cols_ && bool("Error in compressed_matrix::set_values(): Matrix sizes do not match!"));
+    vcl_size_t num_values = stored_nonzeros();
+    if (num_values == 0)
+      return;
+
+    if (other.handle().get_active_handle_id() == elements_.get_active_handle_id())
+      viennacl::backend::memory_copy(other.handle(), elements_, 0, 0, sizeof(NumericT) * num_values);
+    else
+    {
+      std::vector<NumericT> host_values(num_values);
+      viennacl::backend::memory_read(other.handle(), 0, sizeof(NumericT) * num_values, &(host_values[0]));
+      viennacl::backend::memory_write(elements_, 0, sizeof(NumericT) * num_values, &(host_values[0]));
+    }
+  }
+
   /** @brief Allocate memory for the supplied number of nonzeros in the matrix. Old values are preserved. */
   void reserve(vcl_size_t new_nonzeros, bool preserve = true)
   {
@@ -953,9 +1062,10 @@ public:
       }
       else
       {
+        // pages are placed according to the row partition if the row offsets are set up already:
         viennacl::backend::typesafe_host_array<unsigned int> size_deducer(col_buffer_);
-        viennacl::backend::memory_create(col_buffer_, size_deducer.element_size() * new_nonzeros, viennacl::traits::context(col_buffer_));
-        viennacl::backend::memory_create(elements_,   sizeof(NumericT)            * new_nonzeros, viennacl::traits::context(elements_));
+        viennacl::backend::memory_create_csr(col_buffer_, size_deducer.element_size() * new_nonzeros, viennacl::traits::context(col_buffer_), row_buffer_, rows_);
+        viennacl::backend::memory_create_csr(elements_,   sizeof(NumericT)            * new_nonzeros, viennacl::traits::context(elements_),   row_buffer_, rows_);
       }
 
       nonzeros_ = new_nonzeros;
@@ -1112,6 +1222,16 @@ public:
 
 private:
 
+  /** @brief Returns the number of nonzeros actually stored (nnz() may exceed this number if more memory has been reserved). */
+  vcl_size_t stored_nonzeros() const
+  {
+    if (rows_ == 0)
+      return 0;
+    viennacl::backend::typesafe_host_array<unsigned int> last_row_index(row_buffer_, 1);
+    viennacl::backend::memory_read(row_buffer_, last_row_index.element_size() * rows_, last_row_index.element_size(), last_row_index.get());
+    return last_row_index[0];
+  }
+
   /** @brief Helper function for accessing the element (i,j) of the matrix. */
   vcl_size_t element_index(vcl_size_t i, vcl_size_t j)
   {
@@ -1306,6 +1426,58 @@ namespace detail
     }
   };
 
+
+  // x = trans(A) * y
+  template<typename T, unsigned int A>
+  struct op_executor<vector_base<T>, op_assign, vector_expression<const matrix_expression<const compressed_matrix<T, A>, const compressed_matrix<T, A>, op_trans>, const vector_base<T>, op_prod> >
+  {
+    static void apply(vector_base<T> & lhs, vector_expression<const matrix_expression<const compressed_matrix<T, A>, const compressed_matrix<T, A>, op_trans>, const vector_base<T>, op_prod> const & rhs)
+    {
+      // check for the special case x = trans(A) * x
+      if (viennacl::traits::handle(lhs) == viennacl::traits::handle(rhs.rhs()))
+      {
+        viennacl::vector<T> temp(rhs.rhs());
+        viennacl::linalg::prod_impl(rhs.lhs(), temp, T(1), lhs, T(0));
+      }
+      else
+        viennacl::linalg::prod_impl(rhs.lhs(), rhs.rhs(), T(1), lhs, T(0));
+    }
+  };
+
+  // x += trans(A) * y
+  template<typename T, unsigned int A>
+  struct op_executor<vector_base<T>, op_inplace_add, vector_expression<const matrix_expression<const compressed_matrix<T, A>, const compressed_matrix<T, A>, op_trans>, const vector_base<T>, op_prod> >
+  {
+    static void apply(vector_base<T> & lhs, vector_expression<const matrix_expression<const compressed_matrix<T, A>, const compressed_matrix<T, A>, op_trans>, const vector_base<T>, op_prod> const & rhs)
+    {
+      // check for the special case x += trans(A) * x
+      if (viennacl::traits::handle(lhs) == viennacl::traits::handle(rhs.rhs()))
+      {
+        viennacl::vector<T> temp(rhs.rhs());
+        viennacl::linalg::prod_impl(rhs.lhs(), temp, T(1), lhs, T(1));
+      }
+      else
+        viennacl::linalg::prod_impl(rhs.lhs(), rhs.rhs(), T(1), lhs, T(1));
+    }
+  };
+
+  // x -= trans(A) * y
+  template<typename T, unsigned int A>
+  struct op_executor<vector_base<T>, op_inplace_sub, vector_expression<const matrix_expression<const compressed_matrix<T, A>, const compressed_matrix<T, A>, op_trans>, const vector_base<T>, op_prod> >
+  {
+    static void apply(vector_base<T> & lhs, vector_expression<const matrix_expression<const compressed_matrix<T, A>, const compressed_matrix<T, A>, op_trans>, const vector_base<T>, op_prod> const & rhs)
+    {
+      // check for the special case x -= trans(A) * x
+      if (viennacl::traits::handle(lhs) == viennacl::traits::handle(rhs.rhs()))
+      {
+        viennacl::vector<T> temp(rhs.rhs());
+        viennacl::linalg::prod_impl(rhs.lhs(), temp, T(-1), lhs, T(1));
+      }
+      else
+        viennacl::linalg::prod_impl(rhs.lhs(), rhs.rhs(), T(-1), lhs, T(1));
+    }
+  };
+
 } // namespace detail
 } // namespace linalg
   /** \endcond */
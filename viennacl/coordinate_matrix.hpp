@@ -369,6 +369,11 @@ public:
   /** @brief  Returns the OpenCL handle to the group start index array */
   const handle_type & handle3() const { return group_boundaries_; }
 
+  /** @brief  Returns the OpenCL handle to the (row, column) index array */
+  handle_type & handle12() { return coord_buffer_; }
+  /** @brief  Returns the OpenCL handle to the matrix entry array */
+  handle_type & handle() { return elements_; }
+
   vcl_size_t groups() const { return group_num_; }
 
 #if defined(_MSC_VER) && _MSC_VER < 1500      //Visual Studio 2005 needs special treatment
@@ -0,0 +1,388 @@
+#ifndef VIENNACL_DELTA_COMPRESSED_MATRIX_HPP_
+#define VIENNACL_DELTA_COMPRESSED_MATRIX_HPP_
+
+/* =========================================================================
+   Copyright (c) 2010-2016, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+   Portions of this software are copyright by UChicago Argonne, LLC.
+
+                            -----------------
+                  ViennaCL - The Vienna Computing Library
+                            -----------------
+
+   Project Head:    Karl Rupp                   rupp@iue.tuwien.ac.at
+
+   (A list of authors and contributors can be found in the manual)
+
+   License:         MIT (X11), see file LICENSE in the base directory
+============================================================================= */
+
+/** @file viennacl/delta_compressed_matrix.hpp
+    @brief Implementation of the delta_compressed_matrix class (CSR format with delta-encoded column indices, host memory only)
+*/
+
+#include <vector>
+#include <cstring>
+#include "viennacl/forwards.h"
+#include "viennacl/vector.hpp"
+#include "viennacl/compressed_matrix.hpp"
+
+#include "viennacl/linalg/sparse_matrix_operations.hpp"
+
+#include "viennacl/tools/tools.hpp"
+
+#ifdef VIENNACL_WITH_OPENMP
+#include <omp.h>
+#endif
+
+namespace viennacl
+{
+namespace detail
+{
+  /** @brief Returns the number of bytes required for encoding a row with column deltas of type DeltaT. Escape codes are accounted for. */
+  template<typename DeltaT>
+  vcl_size_t delta_compressed_row_bytes(unsigned int const * cols, vcl_size_t num_cols, bool & has_escapes)
+  {
+    DeltaT const escape_code = DeltaT(~DeltaT(0));
+    vcl_size_t bytes = 1 + sizeof(unsigned int); // header plus first column index
+    has_escapes = false;
+    for (vcl_size_t k = 1; k < num_cols; ++k)
+    {
+      unsigned int delta = cols[k] - cols[k-1];
+      bytes += sizeof(DeltaT);
+      if (sizeof(DeltaT) < sizeof(unsigned int) && delta >= static_cast<unsigned int>(escape_code)) // escape code followed by full column index
+      {
+        bytes += sizeof(unsigned int);
+        has_escapes = true;
+      }
+    }
+    return bytes;
+  }
+
+  /** @brief Writes the delta-encoded column indices of a row to the byte stream. */
+  template<typename DeltaT>
+  void delta_compressed_encode_row(unsigned int const * cols, vcl_size_t num_cols, unsigned char header, unsigned char * stream)
+  {
+    DeltaT const escape_code = DeltaT(~DeltaT(0));
+    *stream = header;
+    ++stream;
+    std::memcpy(stream, cols, sizeof(unsigned int));
+    stream += sizeof(unsigned int);
+    for (vcl_size_t k = 1; k < num_cols; ++k)
+    {
+      unsigned int delta = cols[k] - cols[k-1];
+      if (sizeof(DeltaT) < sizeof(unsigned int) && delta >= static_cast<unsigned int>(escape_code))
+      {
+        std::memcpy(stream, &escape_code, sizeof(DeltaT));
+        stream += sizeof(DeltaT);
+        std::memcpy(stream, cols + k, sizeof(unsigned int));
+        stream += sizeof(unsigned int);
+      }
+      else
+      {
+        DeltaT d = static_cast<DeltaT>(delta);
+        std::memcpy(stream, &d, sizeof(DeltaT));
+        stream += sizeof(DeltaT);
+      }
+    }
+  }
+}
+
+/** @brief A sparse matrix in compressed sparse row format, where the column indices within each row are delta-encoded in 8, 16, or 32 bits.
+*
+* Sparse matrix-vector products on the host are limited by memory bandwidth. Column indices of a compressed_matrix require four bytes per nonzero,
+* which is as much as the values themselves in single precision. For matrices with a narrow band of nonzeros per row (e.g. from finite element discretizations)
+* the differences of consecutive column indices fit into one or two bytes. The width is selected per row; deltas which do not fit are stored via an escape code
+* followed by the full column index.
+*
+* The format is available for host memory (MAIN_MEMORY) only. Conversion from a compressed_matrix is a one-time operation; afterwards the matrix can be used
+* in matrix-vector products and with the iterative solvers.
+*
+* @tparam NumericT    Floating point type
+*/
+template<class NumericT>
+class delta_compressed_matrix
+{
+public:
+  typedef viennacl::backend::mem_handle                                                              handle_type;
+  typedef scalar<typename viennacl::tools::CHECK_SCALAR_TEMPLATE_ARGUMENT<NumericT>::ResultType>   value_type;
+  typedef vcl_size_t                                                                                 size_type;
+
+  /** @brief Default construction of a delta-compressed matrix. No memory is allocated */
+  delta_compressed_matrix() : rows_(0), cols_(0), nonzeros_(0), index_stream_bytes_(0) {}
+
+  /** @brief Converts a compressed_matrix to the delta-compressed format. If the compressed_matrix is not located in host memory, a temporary copy is migrated to the host. */
+  template<unsigned int AlignmentV>
+  explicit delta_compressed_matrix(compressed_matrix<NumericT, AlignmentV> const & A) : rows_(0), cols_(0), nonzeros_(0), index_stream_bytes_(0)
+  {
+    assign(A);
+  }
+
+  /** @brief Converts a compressed_matrix to the delta-compressed format. */
+  template<unsigned int AlignmentV>
+  delta_compressed_matrix & operator=(compressed_matrix<NumericT, AlignmentV> const & A)
+  {
+    assign(A);
+    return *this;
+  }
+
+  /** @brief Converts a compressed_matrix to the delta-compressed format. Column indices within each row are expected to be sorted for best compression. */
+  template<unsigned int AlignmentV>
+  void assign(compressed_matrix<NumericT, AlignmentV> const & A)
+  {
+    if (A.memory_context() != viennacl::MAIN_MEMORY)
+    {
+      compressed_matrix<NumericT, AlignmentV> A_host(A);
+      A_host.switch_memory_context(viennacl::context(viennacl::MAIN_MEMORY));
+      assign(A_host);
+      return;
+    }
+
+    viennacl::context host_ctx(viennacl::MAIN_MEMORY);
+    row_buffer_.switch_active_handle_id(viennacl::MAIN_MEMORY);
+    index_offsets_.switch_active_handle_id(viennacl::MAIN_MEMORY);
+    index_stream_.switch_active_handle_id(viennacl::MAIN_MEMORY);
+    elements_.switch_active_handle_id(viennacl::MAIN_MEMORY);
+
+    rows_ = A.size1();
+    cols_ = A.size2();
+
+    unsigned int const * A_row_buffer = reinterpret_cast<unsigned int const *>(A.handle1().ram_handle().get());
+    unsigned int const * A_col_buffer = reinterpret_cast<unsigned int const *>(A.handle2().ram_handle().get());
+
+    nonzeros_ = (rows_ > 0) ? A_row_buffer[rows_] : 0;
+
+    std::vector<unsigned int>  offsets(rows_ + 1);
+    std::vector<unsigned char> headers(rows_);
+
+    // Stage 1: pick the cheapest encoding for each row:
+#ifdef VIENNACL_WITH_OPENMP
+    #pragma omp parallel for
+#endif
+    for (long i = 0; i < static_cast<long>(rows_); ++i)
+    {
+      unsigned int const * row_cols = A_col_buffer + A_row_buffer[i];
+      vcl_size_t row_nnz = A_row_buffer[i+1] - A_row_buffer[i];
+      if (row_nnz == 0)
+      {
+        offsets[vcl_size_t(i)] = 0;
+        headers[vcl_size_t(i)] = 0;
+        continue;
+      }
+
+      bool escapes_8 = false, escapes_16 = false, escapes_32 = false;
+      vcl_size_t bytes_8  = detail::delta_compressed_row_bytes<unsigned char>(row_cols, row_nnz, escapes_8);
+      vcl_size_t bytes_16 = detail::delta_compressed_row_bytes<unsigned short>(row_cols, row_nnz, escapes_16);
+      vcl_size_t bytes_32 = detail::delta_compressed_row_bytes<unsigned int>(row_cols, row_nnz, escapes_32);
+
+      unsigned int header = DELTA_ENCODING_8BIT | (escapes_8 ? DELTA_ENCODING_HAS_ESCAPES : 0);
+      vcl_size_t bytes = bytes_8;
+      if (bytes_16 < bytes)
+      {
+        header = DELTA_ENCODING_16BIT | (escapes_16 ? DELTA_ENCODING_HAS_ESCAPES : 0);
+        bytes = bytes_16;
+      }
+      if (bytes_32 < bytes)
+      {
+        header = DELTA_ENCODING_32BIT;
+        bytes = bytes_32;
+      }
+      offsets[vcl_size_t(i)] = static_cast<unsigned int>(bytes);
+      headers[vcl_size_t(i)] = static_cast<unsigned char>(header);
+    }
+
+    // Stage 2: exclusive scan for the byte offsets of each row:
+    vcl_size_t current_offset = 0;
+    for (vcl_size_t i = 0; i < rows_; ++i)
+    {
+      vcl_size_t tmp = offsets[i];
+      offsets[i] = static_cast<unsigned int>(current_offset);
+      current_offset += tmp;
+    }
+    offsets[rows_] = static_cast<unsigned int>(current_offset);
+    index_stream_bytes_ = current_offset;
+
+    // Stage 3: encode:
+    std::vector<unsigned char> stream(std::max<vcl_size_t>(index_stream_bytes_, 1));
+#ifdef VIENNACL_WITH_OPENMP
+    #pragma omp parallel for
+#endif
+    for (long i = 0; i < static_cast<long>(rows_); ++i)
+    {
+      unsigned int const * row_cols = A_col_buffer + A_row_buffer[i];
+      vcl_size_t row_nnz = A_row_buffer[i+1] - A_row_buffer[i];
+      if (row_nnz == 0)
+        continue;
+
+      unsigned char header = headers[vcl_size_t(i)];
+      unsigned char * row_stream = &(stream[0]) + offsets[vcl_size_t(i)];
+      switch (header & DELTA_ENCODING_WIDTH_MASK)
+      {
+        case DELTA_ENCODING_8BIT:  detail::delta_compressed_encode_row<unsigned char>(row_cols, row_nnz, header, row_stream);  break;
+        case DELTA_ENCODING_16BIT: detail::delta_compressed_encode_row<unsigned short>(row_cols, row_nnz, header, row_stream); break;
+        default:                   detail::delta_compressed_encode_row<unsigned int>(row_cols, row_nnz, header, row_stream);   break;
+      }
+    }
+
+    viennacl::backend::memory_create(row_buffer_,    sizeof(unsigned int) * (rows_ + 1),                        host_ctx, A_row_buffer);
+    viennacl::backend::memory_create(index_offsets_, sizeof(unsigned int) * (rows_ + 1),                        host_ctx, &(offsets[0]));
+    viennacl::backend::memory_create(index_stream_,  stream.size(),                                             host_ctx, &(stream[0]));
+    viennacl::backend::memory_create(elements_,      sizeof(NumericT) * std::max<vcl_size_t>(nonzeros_, 1),     host_ctx, (nonzeros_ > 0) ? A.handle().ram_handle().get() : NULL);
+  }
+
+  /** @brief  Returns the number of rows */
+  const vcl_size_t & size1() const { return rows_; }
+  /** @brief  Returns the number of columns */
+  const vcl_size_t & size2() const { return cols_; }
+  /** @brief  Returns the number of nonzero entries */
+  const vcl_size_t & nnz() const { return nonzeros_; }
+
+  /** @brief  Returns the number of bytes used for storing the column indices (byte stream plus per-row offsets into the stream) */
+  vcl_size_t index_bytes() const { return index_stream_bytes_ + sizeof(unsigned int) * (rows_ + 1); }
+
+  /** @brief  Returns the average number of bytes per nonzero used for column indices */
+  double index_bytes_per_nnz() const { return nonzeros_ > 0 ? double(index_bytes()) / double(nonzeros_) : 0; }
+
+  /** @brief  Returns the average number of bytes per nonzero saved over the column index array of a compressed_matrix. Negative if the delta-encoding is more expensive. */
+  double saved_bytes_per_nnz() const { return nonzeros_ > 0 ? double(sizeof(unsigned int)) - index_bytes_per_nnz() : 0; }
+
+  /** @brief  Returns the handle to the row index array (offsets into the array of values) */
+  const handle_type & handle1() const { return row_buffer_; }
+  /** @brief  Returns the handle to the byte stream of delta-encoded column indices */
+  const handle_type & handle2() const { return index_stream_; }
+  /** @brief  Returns the handle to the array of byte offsets of each row in the column index stream */
+  const handle_type & handle3() const { return index_offsets_; }
+  /** @brief  Returns the handle to the matrix entry array */
+  const handle_type & handle() const { return elements_; }
+
+  /** @brief  Returns the handle to the row index array (offsets into the array of values) */
+  handle_type & handle1() { return row_buffer_; }
+  /** @brief  Returns the handle to the byte stream of delta-encoded column indices */
+  handle_type & handle2() { return index_stream_; }
+  /** @brief  Returns the handle to the array of byte offsets of each row in the column index stream */
+  handle_type & handle3() { return index_offsets_; }
+  /** @brief  Returns the handle to the matrix entry array */
+  handle_type & handle() { return elements_; }
+
+  /** @brief Returns the current memory context. Always MAIN_MEMORY once the matrix is initialized. */
+  viennacl::memory_types memory_context() const
+  {
+    return row_buffer_.get_active_handle_id();
+  }
+
+private:
+  vcl_size_t rows_;
+  vcl_size_t cols_;
+  vcl_size_t nonzeros_;
+  vcl_size_t index_stream_bytes_;
+  handle_type row_buffer_;
+  handle_type index_offsets_;
+  handle_type index_stream_;
+  handle_type elements_;
+};
+
+
+//
+// Specify available operations:
+//
+
+/** \cond */
+
+namespace linalg
+{
+namespace detail
+{
+  // x = A * y
+  template<typename T>
+  struct op_executor<vector_base<T>, op_assign, vector_expression<const delta_compressed_matrix<T>, const vector_base<T>, op_prod> >
+  {
+    static void apply(vector_base<T> & lhs, vector_expression<const delta_compressed_matrix<T>, const vector_base<T>, op_prod> const & rhs)
+    {
+      // check for the special case x = A * x
+      if (viennacl::traits::handle(lhs) == viennacl::traits::handle(rhs.rhs()))
+      {
+        viennacl::vector<T> temp(lhs);
+        viennacl::linalg::prod_impl(rhs.lhs(), rhs.rhs(), T(1), temp, T(0));
+        lhs = temp;
+      }
+      else
+        viennacl::linalg::prod_impl(rhs.lhs(), rhs.rhs(), T(1), lhs, T(0));
+    }
+  };
+
+  template<typename T>
+  struct op_executor<vector_base<T>, op_inplace_add, vector_expression<const delta_compressed_matrix<T>, const vector_base<T>, op_prod> >
+  {
+    static void apply(vector_base<T> & lhs, vector_expression<const delta_compressed_matrix<T>, const vector_base<T>, op_prod> const & rhs)
+    {
+      // check for the special case x += A * x
+      if (viennacl::traits::handle(lhs) == viennacl::traits::handle(rhs.rhs()))
+      {
+        viennacl::vector<T> temp(lhs);
+        viennacl::linalg::prod_impl(rhs.lhs(), rhs.rhs(), T(1), temp, T(0));
+        lhs += temp;
+      }
+      else
+        viennacl::linalg::prod_impl(rhs.lhs(), rhs.rhs(), T(1), lhs, T(1));
+    }
+  };
+
+  template<typename T>
+  struct op_executor<vector_base<T>, op_inplace_sub, vector_expression<const delta_compressed_matrix<T>, const vector_base<T>, op_prod> >
+  {
+    static void apply(vector_base<T> & lhs, vector_expression<const delta_compressed_matrix<T>, const vector_base<T>, op_prod> const & rhs)
+    {
+      // check for the special case x -= A * x
+      if (viennacl::traits::handle(lhs) == viennacl::traits::handle(rhs.rhs()))
+      {
+        viennacl::vector<T> temp(lhs);
+        viennacl::linalg::prod_impl(rhs.lhs(), rhs.rhs(), T(1), temp, T(0));
+        lhs -= temp;
+      }
+      else
+        viennacl::linalg::prod_impl(rhs.lhs(), rhs.rhs(), T(-1), lhs, T(1));
+    }
+  };
+
+
+  // x = A * vec_op
+  template<typename T, typename LHS, typename RHS, typename OP>
+  struct op_executor<vector_base<T>, op_assign, vector_expression<const delta_compressed_matrix<T>, const vector_expression<const LHS, const RHS, OP>, op_prod> >
+  {
+    static void apply(vector_base<T> & lhs, vector_expression<const delta_compressed_matrix<T>, const vector_expression<const LHS, const RHS, OP>, op_prod> const & rhs)
+    {
+      viennacl::vector<T> temp(rhs.rhs());
+      viennacl::linalg::prod_impl(rhs.lhs(), temp, T(1), lhs, T(0));
+    }
+  };
+
+  // x += A * vec_op
+  template<typename T, typename LHS, typename RHS, typename OP>
+  struct op_executor<vector_base<T>, op_inplace_add, vector_expression<const delta_compressed_matrix<T>, const vector_expression<const LHS, const RHS, OP>, op_prod> >
+  {
+    static void apply(vector_base<T> & lhs, vector_expression<const delta_compressed_matrix<T>, const vector_expression<const LHS, const RHS, OP>, op_prod> const & rhs)
+    {
+      viennacl::vector<T> temp(rhs.rhs());
+      viennacl::linalg::prod_impl(rhs.lhs(), temp, T(1), lhs, T(1));
+    }
+  };
+
+  // x -= A * vec_op
+  template<typename T, typename LHS, typename RHS, typename OP>
+  struct op_executor<vector_base<T>, op_inplace_sub, vector_expression<const delta_compressed_matrix<T>, const vector_expression<const LHS, const RHS, OP>, op_prod> >
+  {
+    static void apply(vector_base<T> & lhs, vector_expression<const delta_compressed_matrix<T>, const vector_expression<const LHS, const RHS, OP>, op_prod> const & rhs)
+    {
+      viennacl::vector<T> temp(rhs.rhs());
+      viennacl::linalg::prod_impl(rhs.lhs(), temp, T(-1), lhs, T(1));
+    }
+  };
+
+} // namespace detail
+} // namespace linalg
+
+/** \endcond */
+}
+
+#endif
@@ -374,6 +374,19 @@ namespace viennacl
     , CUDA_MEMORY
   };
 
+  /** @brief Encoding identifiers for the per-row header byte of a delta_compressed_matrix.
+    *
+    * The lower two bits hold the width of the column deltas, the third bit is set if the row contains escape codes.
+    */
+  enum delta_compressed_row_encoding
+  {
+    DELTA_ENCODING_8BIT = 0,
+    DELTA_ENCODING_16BIT = 1,
+    DELTA_ENCODING_32BIT = 2,
+    DELTA_ENCODING_WIDTH_MASK = 3,
+    DELTA_ENCODING_HAS_ESCAPES = 4
+  };
+
   namespace backend
   {
     class mem_handle;
@@ -416,6 +429,12 @@ namespace viennacl
   template<class SCALARTYPE>
   class compressed_compressed_matrix;
 
+  template<class SCALARTYPE>
+  class delta_compressed_matrix;
+
+  template<class SCALARTYPE, class STORAGETYPE = float>
+  class mixed_compressed_matrix;
+
 
   template<class SCALARTYPE, unsigned int ALIGNMENT = 128>
   class coordinate_matrix;
@@ -423,12 +442,21 @@ namespace viennacl
   template<class SCALARTYPE, unsigned int ALIGNMENT = 1>
   class ell_matrix;
 
+  template<class SCALARTYPE, class STORAGETYPE = float>
+  class mixed_ell_matrix;
+
   template<typename ScalarT, typename IndexT = unsigned int>
   class sliced_ell_matrix;
 
   template<class SCALARTYPE, unsigned int ALIGNMENT = 1>
   class hyb_matrix;
 
+  template<class NumericT>
+  class sparse_operator;
+
+  template<class NumericT>
+  class batched_compressed_matrix;
+
   template<class SCALARTYPE, unsigned int ALIGNMENT = 1>
   class circulant_matrix;
 
@@ -890,6 +918,29 @@ namespace viennacl
       static const char * name() { return "unit_upper"; }
     }; //unit upper triangular matrix
 
+    /** @brief Krylov methods available for solving a batch of independent systems with batched_solver_tag */
+    enum batched_solver_type
+    {
+      BATCHED_CG = 0,
+      BATCHED_BICGSTAB,
+      BATCHED_GMRES
+    };
+
+    /** @brief Preconditioners available for solving a batch of independent systems with batched_solver_tag */
+    enum batched_precond_type
+    {
+      BATCHED_NO_PRECOND = 0,
+      BATCHED_JACOBI,
+      BATCHED_ILU0
+    };
+
+    /** @brief Polynomial bases for the Krylov vectors generated in one block of the s-step (communication-avoiding) solvers */
+    enum s_step_basis_type
+    {
+      S_STEP_NEWTON_BASIS = 0,
+      S_STEP_CHEBYSHEV_BASIS
+    };
+
     //preconditioner tags
     class ilut_tag;
 
@@ -31,6 +31,7 @@
 #include "viennacl/linalg/prod.hpp"
 #include "viennacl/linalg/direct_solve.hpp"
 #include "viennacl/compressed_matrix.hpp"
+#include "viennacl/mixed_compressed_matrix.hpp"
 
 #include "viennacl/linalg/detail/amg/amg_base.hpp"
 #include "viennacl/linalg/sparse_matrix_operations.hpp"
@@ -38,6 +39,7 @@
 #include "viennacl/tools/timer.hpp"
 #include "viennacl/linalg/direct_solve.hpp"
 #include "viennacl/linalg/lu.hpp"
+#include "viennacl/linalg/chebyshev.hpp"
 
 #include <map>
 
@@ -68,37 +70,80 @@ private:
 namespace detail
 {
   /** @brief Sparse Galerkin product: Calculates A_coarse = trans(P)*A_fine*P = R*A_fine*P
+    *
+    * In host memory the product is computed in a fused manner without forming A_fine*P. The sparsity pattern of A_coarse is stored in 'plan' (if empty) and reused otherwise.
     *
     * @param A_fine    Operator matrix on fine grid (quadratic)
     * @param P         Prolongation/Interpolation matrix
     * @param R         Restriction matrix
     * @param A_coarse  Result matrix on coarse grid (Galerkin operator)
+    * @param plan      Sparsity pattern of A_coarse (host memory only)
     */
   template<typename NumericT>
   void amg_galerkin_prod(compressed_matrix<NumericT> & A_fine,
                          compressed_matrix<NumericT> & P,
                          compressed_matrix<NumericT> & R, //P^T
-                         compressed_matrix<NumericT> & A_coarse)
+                         compressed_matrix<NumericT> & A_coarse,
+                         viennacl::linalg::galerkin_plan & plan)
   {
-
-    compressed_matrix<NumericT> A_fine_times_P(viennacl::traits::context(A_fine));
-
     // transpose P in memory (no known way of efficiently multiplying P^T * B for CSR-matrices P and B):
     viennacl::linalg::detail::amg::amg_transpose(P, R);
 
+    if (viennacl::traits::active_handle_id(A_fine) == viennacl::MAIN_MEMORY)
+    {
+      viennacl::linalg::detail::amg::galerkin_product(R, A_fine, P, A_coarse, plan);
+      return;
+    }
+
     // compute Galerkin product using a temporary for the result of A_fine * P
+    compressed_matrix<NumericT> A_fine_times_P(viennacl::traits::context(A_fine));
     A_fine_times_P = viennacl::linalg::prod(A_fine, P);
     A_coarse = viennacl::linalg::prod(R, A_fine_times_P);
 
   }
 
 
+  /** @brief Recomputes the values of the coarse grid operator A_coarse = R*A_fine*P for an updated A_fine with unchanged sparsity pattern. P and R are kept.
+    *
+    * In host memory only the numeric stage of the fused Galerkin product is run, using the sparsity pattern stored in 'plan'. A_coarse stays in its memory domain.
+    *
+    * @param A_fine    Operator matrix on fine grid (quadratic)
+    * @param P         Prolongation/Interpolation matrix
+    * @param R         Restriction matrix
+    * @param A_coarse  Result matrix on coarse grid (Galerkin operator)
+    * @param plan      Sparsity pattern of A_coarse (host memory only)
+    */
+  template<typename NumericT>
+  void amg_galerkin_prod_numeric(compressed_matrix<NumericT> & A_fine,
+                                 compressed_matrix<NumericT> & P,
+                                 compressed_matrix<NumericT> & R,
+                                 compressed_matrix<NumericT> & A_coarse,
+                                 viennacl::linalg::galerkin_plan const & plan)
+  {
+    if (   viennacl::traits::active_handle_id(A_fine) == viennacl::MAIN_MEMORY
+        && viennacl::traits::active_handle_id(P)      == viennacl::MAIN_MEMORY
+        && viennacl::traits::active_handle_id(R)      == viennacl::MAIN_MEMORY
+        && !plan.empty())
+    {
+      viennacl::context coarse_context = viennacl::traits::context(A_coarse);
+      viennacl::linalg::detail::amg::galerkin_product_numeric(plan, R, A_fine, P, A_coarse);
+      A_coarse.switch_memory_context(coarse_context);
+      return;
+    }
+
+    compressed_matrix<NumericT> A_fine_times_P(viennacl::traits::context(A_fine));
+    A_fine_times_P = viennacl::linalg::prod(A_fine, P);
+    A_coarse = viennacl::linalg::prod(R, A_fine_times_P);
+  }
+
+
   /** @brief Setup AMG preconditioner
   *
   * @param list_of_A                  Operator matrices on all levels
   * @param list_of_P                  Prolongation/Interpolation operators on all levels
   * @param list_of_R                  Restriction operators on all levels
   * @param list_of_amg_level_context  Auxiliary datastructures for managing the grid hierarchy (coarse nodes, etc.)
+  * @param list_of_galerkin_plans     Sparsity patterns of the coarse grid operators (host memory only)
   * @param tag                        AMG preconditioner tag
   */
   template<typename NumericT, typename AMGContextListT>
@@ -106,6 +151,7 @@ namespace detail
                        std::vector<compressed_matrix<NumericT> > & list_of_P,
                        std::vector<compressed_matrix<NumericT> > & list_of_R,
                        AMGContextListT & list_of_amg_level_context,
+                       std::vector<viennacl::linalg::galerkin_plan> & list_of_galerkin_plans,
                        amg_tag & tag)
   {
     // Set number of iterations. If automatic coarse grid construction is chosen (0), then set a maximum size and stop during the process.
@@ -113,6 +159,10 @@ namespace detail
     if (iterations == 0)
       iterations = VIENNACL_AMG_MAX_LEVELS;
 
+    // coarsening determines new sparsity patterns:
+    list_of_galerkin_plans.clear();
+    list_of_galerkin_plans.resize(iterations);
+
     for (vcl_size_t i=0; i<iterations; ++i)
     {
       list_of_amg_level_context[i].switch_context(tag.get_setup_context());
@@ -140,7 +190,7 @@ namespace detail
       detail::amg::amg_interpol(list_of_A[i], list_of_P[i], list_of_amg_level_context[i], tag);
 
       // Compute coarse grid operator (A[i+1] = R * A[i] * P) with R = trans(P).
-      amg_galerkin_prod(list_of_A[i], list_of_P[i], list_of_R[i], list_of_A[i+1]);
+      amg_galerkin_prod(list_of_A[i], list_of_P[i], list_of_R[i], list_of_A[i+1], list_of_galerkin_plans[i]);
 
       // send matrices to target context:
       list_of_A[i].switch_memory_context(tag.get_target_context());
@@ -287,13 +337,60 @@ public:
   void setup()
   {
     // Start setup phase.
-    vcl_size_t num_coarse_levels = detail::amg_setup(A_list_, P_list_, R_list_, amg_context_list_, tag_);
+    vcl_size_t num_coarse_levels = detail::amg_setup(A_list_, P_list_, R_list_, amg_context_list_, galerkin_plan_list_, tag_);
 
     // Setup precondition phase (Data structures).
     detail::amg_setup_apply(result_list_, result_backup_list_, rhs_list_, residual_list_, A_list_, num_coarse_levels, tag_);
 
     // LU factorization for direct solve.
     detail::amg_lu(coarsest_op_, A_list_[num_coarse_levels], tag_);
+
+    // Spectral bounds and work vectors for the Chebyshev smoother:
+    setup_chebyshev(num_coarse_levels);
+
+    // Operators with values in single precision for the preconditioner applications (host only):
+    A_mixed_list_.clear();
+    P_mixed_list_.clear();
+    R_mixed_list_.clear();
+    if (tag_.get_reduced_precision_storage() && sizeof(NumericT) > sizeof(float) && tag_.get_target_context().memory_type() == viennacl::MAIN_MEMORY)
+    {
+      A_mixed_list_.resize(num_coarse_levels);
+      P_mixed_list_.resize(num_coarse_levels);
+      R_mixed_list_.resize(num_coarse_levels);
+      for (vcl_size_t level = 0; level < num_coarse_levels; ++level)
+      {
+        A_mixed_list_[level].assign(A_list_[level]);
+        P_mixed_list_[level].assign(P_list_[level]);
+        R_mixed_list_[level].assign(R_list_[level]);
+      }
+    }
+  }
+
+
+  /** @brief Recomputes the multigrid hierarchy for a system matrix with the same sparsity pattern as the matrix passed to the constructor, e.g. an updated Jacobian in a Newton iteration.
+  *
+  * Coarsening and interpolation operators from setup() are kept, only the coarse grid operators and the factorization on the coarsest level are recomputed.
+  * In host memory the Galerkin products reuse the sparsity patterns computed in setup(). This is much cheaper than a full setup and suited for moderate changes of the values.
+  *
+  * @param mat  Updated system matrix
+  */
+  void refactor(compressed_matrix<NumericT, AlignmentV> const & mat)
+  {
+    vcl_size_t num_coarse_levels = residual_list_.size();
+    assert(num_coarse_levels > 0 && bool("Error in amg_precond::refactor(): setup() needs to be called first!"));
+    assert(mat.size1() == A_list_[0].size1() && mat.size2() == A_list_[0].size2() && bool("Error in amg_precond::refactor(): Matrix size changed!"));
+
+    A_list_[0].set_values(mat);
+
+    for (vcl_size_t level = 0; level < num_coarse_levels; ++level)
+      detail::amg_galerkin_prod_numeric(A_list_[level], P_list_[level], R_list_[level], A_list_[level+1], galerkin_plan_list_[level]);
+
+    detail::amg_lu(coarsest_op_, A_list_[num_coarse_levels], tag_);
+
+    setup_chebyshev(num_coarse_levels);
+
+    for (vcl_size_t level = 0; level < A_mixed_list_.size(); ++level)
+      A_mixed_list_[level].assign(A_list_[level]);
   }
 
 
@@ -303,6 +400,74 @@ public:
   */
   template<typename VectorT>
   void apply(VectorT & vec) const
+  {
+    if (A_mixed_list_.size() > 0)
+      apply_cycle(vec, A_mixed_list_, P_mixed_list_, R_mixed_list_);
+    else
+      apply_cycle(vec, A_list_, P_list_, R_list_);
+  }
+
+  /** @brief Returns the total number of multigrid levels in the hierarchy including the finest level. */
+  vcl_size_t levels() const { return residual_list_.size(); }
+
+
+  /** @brief Returns the problem/operator size at the respective multigrid level
+    *
+    * @param level     Index of the multigrid level. 0 is the finest level, levels() - 1 is the coarsest level.
+    */
+  vcl_size_t size(vcl_size_t level) const
+  {
+    assert(level < levels() && bool("Level index out of bounds!"));
+    return residual_list_[level].size();
+  }
+
+  /** @brief Returns the associated preconditioner tag containing the configuration for the multigrid preconditioner. */
+  amg_tag const & tag() const { return tag_; }
+
+private:
+  /** @brief Estimates the largest eigenvalue of the Jacobi-preconditioned operator on each level if the Chebyshev smoother is selected */
+  void setup_chebyshev(vcl_size_t num_coarse_levels)
+  {
+    chebyshev_lambda_max_.clear();
+    chebyshev_direction_list_.clear();
+    if (tag_.get_smoother() != AMG_SMOOTHER_CHEBYSHEV)
+      return;
+
+    chebyshev_lambda_max_.resize(num_coarse_levels);
+    chebyshev_direction_list_.resize(num_coarse_levels);
+    for (vcl_size_t level = 0; level < num_coarse_levels; ++level)
+    {
+      double lambda_min, lambda_max;
+      viennacl::linalg::detail::chebyshev_estimate_bounds(A_list_[level], 10, lambda_min, lambda_max);
+      chebyshev_lambda_max_[level] = viennacl::linalg::detail::chebyshev_upper_bound_safety() * lambda_max;
+      chebyshev_direction_list_[level] = VectorType(A_list_[level].size1(), tag_.get_target_context());
+    }
+  }
+
+  /** @brief Applies the smoother selected in the tag to the current approximation on the respective level */
+  template<typename MatrixT>
+  void smooth(vcl_size_t steps, vcl_size_t level, MatrixT const & A) const
+  {
+    if (tag_.get_smoother() == AMG_SMOOTHER_CHEBYSHEV)
+      viennacl::linalg::detail::chebyshev_smooth(steps, A,
+                                                 result_list_[level],
+                                                 result_backup_list_[level],
+                                                 chebyshev_direction_list_[level],
+                                                 rhs_list_[level],
+                                                 chebyshev_lambda_max_[level] / tag_.get_chebyshev_ratio(),
+                                                 chebyshev_lambda_max_[level]);
+    else
+      viennacl::linalg::detail::amg::smooth_jacobi(static_cast<unsigned int>(steps),
+                                                   A,
+                                                   result_list_[level],
+                                                   result_backup_list_[level],
+                                                   rhs_list_[level],
+                                                   static_cast<NumericT>(tag_.get_jacobi_weight()));
+  }
+
+  /** @brief Runs a V-cycle using the provided operators on each level */
+  template<typename VectorT, typename MatrixListT>
+  void apply_cycle(VectorT & vec, MatrixListT const & A_list, MatrixListT const & P_list, MatrixListT const & R_list) const
   {
     vcl_size_t level;
 
@@ -315,21 +480,16 @@ public:
       result_list_[level].clear();
 
       // Apply Smoother presmooth_ times.
-      viennacl::linalg::detail::amg::smooth_jacobi(static_cast<unsigned int>(tag_.get_presmooth_steps()),
-                                                   A_list_[level],
-                                                   result_list_[level],
-                                                   result_backup_list_[level],
-                                                   rhs_list_[level],
-                                                   static_cast<NumericT>(tag_.get_jacobi_weight()));
+      smooth(tag_.get_presmooth_steps(), level, A_list[level]);
 
       // Compute residual.
       //residual[level] = rhs_[level] - viennacl::linalg::prod(A_[level], result_[level]);
-      residual_list_[level] = viennacl::linalg::prod(A_list_[level], result_list_[level]);
+      residual_list_[level] = viennacl::linalg::prod(A_list[level], result_list_[level]);
       residual_list_[level] = rhs_list_[level] - residual_list_[level];
 
       // Restrict to coarse level. Result is RHS of coarse level equation.
       //residual_coarse[level] = viennacl::linalg::prod(R[level],residual[level]);
-      rhs_list_[level+1] = viennacl::linalg::prod(R_list_[level], residual_list_[level]);
+      rhs_list_[level+1] = viennacl::linalg::prod(R_list[level], residual_list_[level]);
     }
 
     // Part 2: On highest level use direct solve to solve equation (on the CPU)
@@ -342,42 +502,24 @@ public:
       level = static_cast<vcl_size_t>(level2);
 
       // Interpolate error to fine level and correct solution.
-      result_backup_list_[level] = viennacl::linalg::prod(P_list_[level], result_list_[level+1]);
+      result_backup_list_[level] = viennacl::linalg::prod(P_list[level], result_list_[level+1]);
       result_list_[level] += result_backup_list_[level];
 
       // Apply Smoother postsmooth_ times.
-      viennacl::linalg::detail::amg::smooth_jacobi(static_cast<unsigned int>(tag_.get_postsmooth_steps()),
-                                                   A_list_[level],
-                                                   result_list_[level],
-                                                   result_backup_list_[level],
-                                                   rhs_list_[level],
-                                                   static_cast<NumericT>(tag_.get_jacobi_weight()));
+      smooth(tag_.get_postsmooth_steps(), level, A_list[level]);
     }
     vec = result_list_[0];
   }
 
-  /** @brief Returns the total number of multigrid levels in the hierarchy including the finest level. */
-  vcl_size_t levels() const { return residual_list_.size(); }
-
-
-  /** @brief Returns the problem/operator size at the respective multigrid level
-    *
-    * @param level     Index of the multigrid level. 0 is the finest level, levels() - 1 is the coarsest level.
-    */
-  vcl_size_t size(vcl_size_t level) const
-  {
-    assert(level < levels() && bool("Level index out of bounds!"));
-    return residual_list_[level].size();
-  }
-
-  /** @brief Returns the associated preconditioner tag containing the configuration for the multigrid preconditioner. */
-  amg_tag const & tag() const { return tag_; }
-
-private:
   std::vector<SparseMatrixType> A_list_;
   std::vector<SparseMatrixType> P_list_;
   std::vector<SparseMatrixType> R_list_;
   std::vector<AMGContextType>   amg_context_list_;
+  std::vector<viennacl::linalg::galerkin_plan> galerkin_plan_list_;
+
+  std::vector<viennacl::mixed_compressed_matrix<NumericT> > A_mixed_list_;
+  std::vector<viennacl::mixed_compressed_matrix<NumericT> > P_mixed_list_;
+  std::vector<viennacl::mixed_compressed_matrix<NumericT> > R_mixed_list_;
 
   viennacl::matrix<NumericT>        coarsest_op_;
 
@@ -385,6 +527,8 @@ private:
   mutable std::vector<VectorType> result_backup_list_;
   mutable std::vector<VectorType> rhs_list_;
   mutable std::vector<VectorType> residual_list_;
+  mutable std::vector<VectorType> chebyshev_direction_list_;
+  std::vector<double>             chebyshev_lambda_max_;
 
   amg_tag tag_;
 };
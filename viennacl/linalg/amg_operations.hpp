@@ -168,6 +168,67 @@ void amg_transpose(compressed_matrix<NumericT> & A,
   }
 }
 
+/** @brief Symbolic stage of the fused Galerkin product R * A * P. Currently available for matrices in host memory only. */
+template<typename NumericT>
+void galerkin_product_symbolic(compressed_matrix<NumericT> const & R,
+                               compressed_matrix<NumericT> const & A,
+                               compressed_matrix<NumericT> const & P,
+                               viennacl::linalg::galerkin_plan & plan)
+{
+  assert( (R.size2() == A.size1()) && bool("Size check failed for Galerkin product: size2(R) != size1(A)"));
+  assert( (A.size2() == P.size1()) && bool("Size check failed for Galerkin product: size2(A) != size1(P)"));
+
+  switch (viennacl::traits::handle(A).get_active_handle_id())
+  {
+    case viennacl::MAIN_MEMORY:
+      viennacl::linalg::host_based::amg::galerkin_product_symbolic(R, A, P, plan);
+      break;
+    case viennacl::MEMORY_NOT_INITIALIZED:
+      throw memory_exception("not initialised!");
+    default:
+      throw memory_exception("not implemented");
+  }
+}
+
+/** @brief Numeric stage of the fused Galerkin product A_coarse = R * A * P. Currently available for matrices in host memory only. */
+template<typename NumericT>
+void galerkin_product_numeric(viennacl::linalg::galerkin_plan const & plan,
+                              compressed_matrix<NumericT> const & R,
+                              compressed_matrix<NumericT> const & A,
+                              compressed_matrix<NumericT> const & P,
+                              compressed_matrix<NumericT> & A_coarse)
+{
+  assert( (plan.size1() == R.size1() && plan.size2() == P.size2()) && bool("Size check failed for Galerkin product: plan does not match operands"));
+
+  switch (viennacl::traits::handle(A).get_active_handle_id())
+  {
+    case viennacl::MAIN_MEMORY:
+      viennacl::linalg::host_based::amg::galerkin_product_numeric(plan, R, A, P, A_coarse);
+      break;
+    case viennacl::MEMORY_NOT_INITIALIZED:
+      throw memory_exception("not initialised!");
+    default:
+      throw memory_exception("not implemented");
+  }
+}
+
+/** @brief Computes the Galerkin product A_coarse = R * A * P row by row without forming A * P. Currently available for matrices in host memory only.
+*
+* If 'plan' is empty, the sparsity pattern of A_coarse is computed first and stored in 'plan'.
+* Otherwise 'plan' is assumed to stem from matrices with the same sparsity patterns as R, A, and P, so that only the values of A_coarse are recomputed.
+*/
+template<typename NumericT>
+void galerkin_product(compressed_matrix<NumericT> const & R,
+                      compressed_matrix<NumericT> const & A,
+                      compressed_matrix<NumericT> const & P,
+                      compressed_matrix<NumericT> & A_coarse,
+                      viennacl::linalg::galerkin_plan & plan)
+{
+  if (plan.empty())
+    galerkin_product_symbolic(R, A, P, plan);
+  galerkin_product_numeric(plan, R, A, P, A_coarse);
+}
+
 /** Assign sparse matrix A to dense matrix B */
 template<typename SparseMatrixType, typename NumericT>
 typename viennacl::enable_if< viennacl::is_any_sparse_matrix<SparseMatrixType>::value>::type
@@ -229,6 +290,26 @@ void smooth_jacobi(unsigned int iterations,
   }
 }
 
+template<typename NumericT, typename StorageT>
+void smooth_jacobi(unsigned int iterations,
+                   mixed_compressed_matrix<NumericT, StorageT> const & A,
+                   vector<NumericT> & x,
+                   vector<NumericT> & x_backup,
+                   vector<NumericT> const & rhs_smooth,
+                   NumericT weight)
+{
+  switch (viennacl::traits::handle(A).get_active_handle_id())
+  {
+    case viennacl::MAIN_MEMORY:
+      viennacl::linalg::host_based::amg::smooth_jacobi(iterations, A, x, x_backup, rhs_smooth, weight);
+      break;
+    case viennacl::MEMORY_NOT_INITIALIZED:
+      throw memory_exception("not initialised!");
+    default:
+      throw memory_exception("not implemented");
+  }
+}
+
 } //namespace amg
 } //namespace detail
 } //namespace linalg
@@ -0,0 +1,154 @@
+#ifndef VIENNACL_LINALG_BATCHED_SOLVE_HPP_
+#define VIENNACL_LINALG_BATCHED_SOLVE_HPP_
+
+/* =========================================================================
+   Copyright (c) 2010-2016, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+   Portions of this software are copyright by UChicago Argonne, LLC.
+
+                            -----------------
+                  ViennaCL - The Vienna Computing Library
+                            -----------------
+
+   Project Head:    Karl Rupp                   rupp@iue.tuwien.ac.at
+
+   (A list of authors and contributors can be found in the manual)
+
+   License:         MIT (X11), see file LICENSE in the base directory
+============================================================================= */
+
+/** @file viennacl/linalg/batched_solve.hpp
+    @brief Iterative solvers for batches of many small independent sparse systems
+*/
+
+#include <vector>
+#include <algorithm>
+
+#include "viennacl/forwards.h"
+#include "viennacl/vector.hpp"
+#include "viennacl/batched_compressed_matrix.hpp"
+#include "viennacl/traits/handle.hpp"
+#include "viennacl/traits/size.hpp"
+#include "viennacl/linalg/host_based/batched_solve.hpp"
+
+namespace viennacl
+{
+namespace linalg
+{
+
+/** @brief A tag for solving a batch of independent systems. Used for supplying solver parameters and for dispatching the solve() function.
+*
+* After the solver run, the number of iterations, the relative residual, and the convergence flag of each system are available.
+*/
+class batched_solver_tag
+{
+public:
+  /** @brief The constructor
+  *
+  * @param solver           The Krylov method: BATCHED_CG (symmetric positive definite systems), BATCHED_BICGSTAB, or BATCHED_GMRES
+  * @param precond          The preconditioner set up for each system: BATCHED_NO_PRECOND, BATCHED_JACOBI, or BATCHED_ILU0
+  * @param tol              Relative tolerance for the residual (the solver quits for system i if ||r_i|| < tol * ||b_i||)
+  * @param max_iterations   The maximum number of iterations per system
+  * @param krylov_dim       The maximum dimension of the Krylov space before restart (GMRES only)
+  */
+  batched_solver_tag(batched_solver_type solver = BATCHED_CG, batched_precond_type precond = BATCHED_JACOBI,
+                     double tol = 1e-8, unsigned int max_iterations = 300, unsigned int krylov_dim = 20)
+    : solver_(solver), precond_(precond), tol_(tol), abs_tol_(0), iterations_(max_iterations), krylov_dim_(krylov_dim) {}
+
+  /** @brief Returns the Krylov method */
+  batched_solver_type solver() const { return solver_; }
+  /** @brief Returns the preconditioner */
+  batched_precond_type preconditioner() const { return precond_; }
+
+  /** @brief Returns the relative tolerance */
+  double tolerance() const { return tol_; }
+
+  /** @brief Returns the absolute tolerance */
+  double abs_tolerance() const { return abs_tol_; }
+  /** @brief Sets the absolute tolerance */
+  void abs_tolerance(double new_tol) { if (new_tol >= 0) abs_tol_ = new_tol; }
+
+  /** @brief Returns the maximum number of iterations per system */
+  unsigned int max_iterations() const { return iterations_; }
+  /** @brief Returns the maximum dimension of the Krylov space before restart (GMRES only) */
+  unsigned int krylov_dim() const { return krylov_dim_; }
+
+  /** @brief Returns the number of iterations taken for system i */
+  unsigned int iters(vcl_size_t i) const { return iters_taken_[i]; }
+  /** @brief Returns the relative residual ||r_i|| / ||b_i|| of system i at the end of the solver run */
+  double error(vcl_size_t i) const { return last_errors_[i]; }
+  /** @brief Returns true if system i has converged */
+  bool converged(vcl_size_t i) const { return converged_[i] != 0; }
+
+  /** @brief Returns the number of systems which have converged */
+  vcl_size_t num_converged() const { return static_cast<vcl_size_t>(std::count(converged_.begin(), converged_.end(), static_cast<unsigned char>(1))); }
+  /** @brief Returns the largest number of iterations over all systems */
+  unsigned int max_iters() const { return iters_taken_.size() > 0 ? *std::max_element(iters_taken_.begin(), iters_taken_.end()) : 0; }
+  /** @brief Returns the largest relative residual over all systems */
+  double max_error() const { return last_errors_.size() > 0 ? *std::max_element(last_errors_.begin(), last_errors_.end()) : 0; }
+
+  /** @brief Resets the results for a batch with the given number of systems. Called by the solver. */
+  void init_results(vcl_size_t batch_size) const
+  {
+    iters_taken_.assign(batch_size, 0);
+    last_errors_.assign(batch_size, 0);
+    converged_.assign(batch_size, 0);
+  }
+  /** @brief Stores the results for system i. Called by the solver, possibly concurrently for different systems. */
+  void result(vcl_size_t i, unsigned int iters, double error, bool converged) const
+  {
+    iters_taken_[i] = iters;
+    last_errors_[i] = error;
+    converged_[i]   = converged ? 1 : 0;
+  }
+
+private:
+  batched_solver_type  solver_;
+  batched_precond_type precond_;
+  double tol_;
+  double abs_tol_;
+  unsigned int iterations_;
+  unsigned int krylov_dim_;
+
+  //return values from solver
+  mutable std::vector<unsigned int>  iters_taken_;
+  mutable std::vector<double>        last_errors_;
+  mutable std::vector<unsigned char> converged_;   // not std::vector<bool>, since systems are written concurrently
+};
+
+
+/** @brief Solves all systems of a batch independently. Each system is solved by a single thread without inner parallelism.
+*
+* @param A     The batch of systems
+* @param B     The concatenated right hand sides of all systems
+* @param tag   Solver configuration tag. Receives the per-system results.
+* @return The concatenated solutions of all systems
+*/
+template<typename NumericT>
+viennacl::vector<NumericT> solve(viennacl::batched_compressed_matrix<NumericT> const & A,
+                                 viennacl::vector_base<NumericT> const & B,
+                                 batched_solver_tag const & tag)
+{
+  assert(B.size() == A.size1() && bool("Size mismatch of right hand side"));
+
+  viennacl::vector<NumericT> X(B.size(), viennacl::traits::context(B));
+  tag.init_results(A.batch_size());
+
+  switch (viennacl::traits::handle(B).get_active_handle_id())
+  {
+    case viennacl::MAIN_MEMORY:
+      viennacl::linalg::host_based::batched_solve(A, B, X, tag);
+      break;
+    case viennacl::MEMORY_NOT_INITIALIZED:
+      throw memory_exception("not initialised!");
+    default:
+      throw memory_exception("not implemented");
+  }
+  return X;
+}
+
+}
+}
+
+#endif
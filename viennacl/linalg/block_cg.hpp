@@ -0,0 +1,318 @@
+#ifndef VIENNACL_LINALG_BLOCK_CG_HPP_
+#define VIENNACL_LINALG_BLOCK_CG_HPP_
+
+/* =========================================================================
+   Copyright (c) 2010-2016, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+   Portions of this software are copyright by UChicago Argonne, LLC.
+
+                            -----------------
+                  ViennaCL - The Vienna Computing Library
+                            -----------------
+
+   Project Head:    Karl Rupp                   rupp@iue.tuwien.ac.at
+
+   (A list of authors and contributors can be found in the manual)
+
+   License:         MIT (X11), see file LICENSE in the base directory
+============================================================================= */
+
+/** @file viennacl/linalg/block_cg.hpp
+    @brief The block conjugate gradient method for multiple right hand sides is implemented here
+*/
+
+#include <vector>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+#include "viennacl/forwards.h"
+#include "viennacl/vector.hpp"
+#include "viennacl/matrix.hpp"
+#include "viennacl/linalg/prod.hpp"
+#include "viennacl/linalg/norm_2.hpp"
+#include "viennacl/linalg/sparse_matrix_operations.hpp"
+#include "viennacl/linalg/detail/small_dense.hpp"
+#include "viennacl/traits/size.hpp"
+#include "viennacl/traits/context.hpp"
+
+namespace viennacl
+{
+namespace linalg
+{
+
+/** @brief A tag for the block conjugate gradient method. Used for supplying solver parameters and for dispatching the solve() function
+*/
+class block_cg_tag
+{
+public:
+  /** @brief The constructor
+  *
+  * @param tol              Relative tolerance for the residual of each right hand side (the solver quits if ||r_j|| < tol * ||b_j|| for all columns j)
+  * @param max_iterations   The maximum number of iterations
+  * @param deflation_tol    Search directions with singular values below deflation_tol times the largest singular value of the block are dropped. If zero, ten times the square root of the machine epsilon is used.
+  */
+  block_cg_tag(double tol = 1e-8, unsigned int max_iterations = 300, double deflation_tol = 0)
+    : tol_(tol), abs_tol_(0), iterations_(max_iterations), deflation_tol_(deflation_tol), iters_taken_(0), last_error_(0), last_block_size_(0) {}
+
+  /** @brief Returns the relative tolerance */
+  double tolerance() const { return tol_; }
+
+  /** @brief Returns the absolute tolerance */
+  double abs_tolerance() const { return abs_tol_; }
+  /** @brief Sets the absolute tolerance */
+  void abs_tolerance(double new_tol) { if (new_tol >= 0) abs_tol_ = new_tol; }
+
+  /** @brief Returns the maximum number of iterations */
+  unsigned int max_iterations() const { return iterations_; }
+
+  /** @brief Returns the relative threshold for dropping linearly dependent search directions (zero: automatic) */
+  double deflation_tolerance() const { return deflation_tol_; }
+  /** @brief Sets the relative threshold for dropping linearly dependent search directions (zero: automatic) */
+  void deflation_tolerance(double new_tol) { if (new_tol >= 0) deflation_tol_ = new_tol; }
+
+  /** @brief Return the number of solver iterations: */
+  unsigned int iters() const { return iters_taken_; }
+  void iters(unsigned int i) const { iters_taken_ = i; }
+
+  /** @brief Returns the largest estimated relative error over all right hand sides at the end of the solver run */
+  double error() const { return last_error_; }
+  /** @brief Sets the largest estimated relative error over all right hand sides at the end of the solver run */
+  void error(double e) const { last_error_ = e; }
+
+  /** @brief Returns the number of search directions in the last iteration. Smaller than the number of right hand sides if directions have been deflated. */
+  vcl_size_t block_size() const { return last_block_size_; }
+  /** @brief Sets the number of search directions in the last iteration */
+  void block_size(vcl_size_t s) const { last_block_size_ = s; }
+
+private:
+  double tol_;
+  double abs_tol_;
+  unsigned int iterations_;
+  double deflation_tol_;
+
+  //return values from solver
+  mutable unsigned int iters_taken_;
+  mutable double last_error_;
+  mutable vcl_size_t last_block_size_;
+};
+
+namespace detail
+{
+  /** @brief Computes an orthonormal basis P of the range of W, dropping directions with singular values below deflation_tol times the largest singular value.
+  *
+  * The singular values and right singular vectors are obtained from the Gram matrix W^T * W on the host, hence only the k x k Gram matrix is reduced over the block.
+  * Returns the number of columns of P, which is zero if W vanishes.
+  */
+  template<typename NumericT, typename F>
+  vcl_size_t block_cg_orthonormalize(viennacl::matrix<NumericT, F> const & W, double deflation_tol, viennacl::matrix<NumericT, F> & P)
+  {
+    vcl_size_t k = W.size2();
+
+    viennacl::matrix<NumericT, F> gram = viennacl::linalg::prod(trans(W), W);
+    std::vector<double> G;
+    small_dense_to_host(gram, G);
+
+    std::vector<double> V;
+    small_symmetric_eigen(G, V, k);
+
+    double lambda_max = 0;
+    for (vcl_size_t i = 0; i < k; ++i)
+      lambda_max = std::max(lambda_max, G[i + i * k]);
+
+    std::vector<vcl_size_t> kept;
+    for (vcl_size_t i = 0; i < k; ++i)
+      if (lambda_max > 0 && G[i + i * k] > deflation_tol * deflation_tol * lambda_max)
+        kept.push_back(i);
+
+    if (kept.size() == 0)
+      return 0;
+
+    // P = W * V_kept * Lambda_kept^{-1/2}:
+    std::vector<double> T(k * kept.size());
+    for (vcl_size_t j = 0; j < kept.size(); ++j)
+    {
+      double scale = 1.0 / std::sqrt(G[kept[j] + kept[j] * k]);
+      for (vcl_size_t i = 0; i < k; ++i)
+        T[i + j * k] = V[i + kept[j] * k] * scale;
+    }
+    viennacl::matrix<NumericT, F> vcl_T(k, kept.size(), viennacl::traits::context(W));
+    small_dense_from_host(T, vcl_T);
+
+    P.resize(W.size1(), kept.size(), false);
+    P = viennacl::linalg::prod(W, vcl_T);
+    return kept.size();
+  }
+
+  /** @brief Applies the preconditioner to each column of R which has not converged and writes the result to Z. Columns of converged right hand sides are set to zero. */
+  template<typename NumericT, typename F, typename PreconditionerT>
+  void block_cg_apply_precond(PreconditionerT const & precond, viennacl::matrix<NumericT, F> & R, std::vector<bool> const & converged, viennacl::matrix<NumericT, F> & Z)
+  {
+    viennacl::vector<NumericT> temp(R.size1(), viennacl::traits::context(R));
+    for (vcl_size_t j = 0; j < R.size2(); ++j)
+    {
+      vcl_size_t start, stride;
+      dense_column_layout(R, j, start, stride);
+      viennacl::vector_base<NumericT> R_j(R.handle(), R.size1(), start, stride);
+      dense_column_layout(Z, j, start, stride);
+      viennacl::vector_base<NumericT> Z_j(Z.handle(), Z.size1(), start, stride);
+
+      if (converged[j])
+        Z_j = viennacl::zero_vector<NumericT>(Z.size1(), viennacl::traits::context(Z));
+      else
+      {
+        temp = R_j;
+        precond.apply(temp);
+        Z_j = temp;
+      }
+    }
+  }
+
+  /** @brief Overload for the unpreconditioned case: Only the columns of converged right hand sides are set to zero */
+  template<typename NumericT, typename F>
+  void block_cg_apply_precond(viennacl::linalg::no_precond const &, viennacl::matrix<NumericT, F> & R, std::vector<bool> const & converged, viennacl::matrix<NumericT, F> & Z)
+  {
+    Z = R;
+    for (vcl_size_t j = 0; j < R.size2(); ++j)
+    {
+      if (!converged[j])
+        continue;
+
+      vcl_size_t start, stride;
+      dense_column_layout(Z, j, start, stride);
+      viennacl::vector_base<NumericT> Z_j(Z.handle(), Z.size1(), start, stride);
+      Z_j = viennacl::zero_vector<NumericT>(Z.size1(), viennacl::traits::context(Z));
+    }
+  }
+
+  /** @brief Computes the norms of the columns of R relative to 'norms_rhs' and updates the convergence flags. Returns the largest relative norm. */
+  template<typename NumericT, typename F>
+  double block_cg_check_convergence(viennacl::matrix<NumericT, F> & R, std::vector<double> const & norms_rhs, block_cg_tag const & tag, std::vector<bool> & converged)
+  {
+    double max_rel_residual = 0;
+    for (vcl_size_t j = 0; j < R.size2(); ++j)
+    {
+      vcl_size_t start, stride;
+      dense_column_layout(R, j, start, stride);
+      viennacl::vector_base<NumericT> R_j(R.handle(), R.size1(), start, stride);
+
+      double norm_R_j = viennacl::linalg::norm_2(R_j);
+      double rel_residual = (norms_rhs[j] > 0) ? norm_R_j / norms_rhs[j] : 0;
+      max_rel_residual = std::max(max_rel_residual, rel_residual);
+      if (rel_residual < tag.tolerance() || norm_R_j <= tag.abs_tolerance())
+        converged[j] = true;
+    }
+    return max_rel_residual;
+  }
+}
+
+
+/** @brief Implementation of the preconditioned block conjugate gradient method for a symmetric positive definite matrix and multiple right hand sides.
+*
+* Breakdown-free block CG following H. Ji and Y. Li, BIT Numer. Math. 57(2), 379-403 (2017): The search directions are orthonormalized in each iteration,
+* dropping directions which became linearly dependent, and right hand sides which have converged no longer contribute search directions.
+* The sparse matrix is applied to all search directions in a single sparse matrix-dense matrix product. The k x k systems are solved on the host.
+*
+* @param A        The system matrix
+* @param B        The right hand sides, one per column
+* @param tag      Solver configuration tag
+* @param precond  A preconditioner. Applied to each column via member function apply()
+* @return The solution vectors, one per column
+*/
+template<typename MatrixT, typename NumericT, typename F, typename PreconditionerT>
+viennacl::matrix<NumericT, F> solve(MatrixT const & A, viennacl::matrix<NumericT, F> const & B, block_cg_tag const & tag, PreconditionerT const & precond)
+{
+  viennacl::context ctx = viennacl::traits::context(B);
+  vcl_size_t n = B.size1();
+  vcl_size_t k = B.size2();
+
+  double deflation_tol = tag.deflation_tolerance();
+  if (deflation_tol <= 0)
+    deflation_tol = 10.0 * std::sqrt(static_cast<double>(std::numeric_limits<NumericT>::epsilon()));
+
+  viennacl::matrix<NumericT, F> X(n, k, ctx);
+  viennacl::matrix<NumericT, F> R(B);
+  viennacl::matrix<NumericT, F> Z(n, k, ctx);
+
+  tag.iters(0);
+  tag.error(0);
+  tag.block_size(0);
+
+  std::vector<double> norms_rhs(k);
+  std::vector<bool>   converged(k, false);
+  for (vcl_size_t j = 0; j < k; ++j)
+  {
+    vcl_size_t start, stride;
+    detail::dense_column_layout(R, j, start, stride);
+    viennacl::vector_base<NumericT> R_j(R.handle(), n, start, stride);
+    norms_rhs[j] = viennacl::linalg::norm_2(R_j);
+    converged[j] = (norms_rhs[j] <= tag.abs_tolerance()); // solution is zero
+  }
+
+  detail::block_cg_apply_precond(precond, R, converged, Z);
+
+  viennacl::matrix<NumericT, F> P;
+  vcl_size_t r = detail::block_cg_orthonormalize(Z, deflation_tol, P);
+
+  viennacl::matrix<NumericT, F> Q(n, r, ctx);
+  std::vector<double> PtQ, PtR, QtZ;
+  for (unsigned int iter = 0; iter < tag.max_iterations() && r > 0; ++iter)
+  {
+    tag.iters(iter + 1);
+    tag.block_size(r);
+
+    // Note: Q is not initialized from the expression, since the layout of the result would be taken from A
+    Q.resize(n, r, false);
+    Q = viennacl::linalg::prod(A, P);
+
+    // alpha = (P^T A P)^{-1} P^T R:
+    viennacl::matrix<NumericT, F> vcl_PtQ = viennacl::linalg::prod(trans(P), Q);
+    detail::small_dense_to_host(vcl_PtQ, PtQ);
+    viennacl::matrix<NumericT, F> vcl_PtR = viennacl::linalg::prod(trans(P), R);
+    detail::small_dense_to_host(vcl_PtR, PtR);
+    if (!detail::small_cholesky_solve(PtQ, PtR, r, k))
+      break; // matrix not positive definite on the search space
+
+    viennacl::matrix<NumericT, F> alpha(r, k, ctx);
+    detail::small_dense_from_host(PtR, alpha);
+    X += viennacl::linalg::prod(P, alpha);
+    R -= viennacl::linalg::prod(Q, alpha);
+
+    tag.error(detail::block_cg_check_convergence(R, norms_rhs, tag, converged));
+    if (std::find(converged.begin(), converged.end(), false) == converged.end())
+      break;
+
+    // new search directions: P = orth(Z - P (P^T A P)^{-1} Q^T Z)
+    detail::block_cg_apply_precond(precond, R, converged, Z);
+    viennacl::matrix<NumericT, F> vcl_QtZ = viennacl::linalg::prod(trans(Q), Z);
+    detail::small_dense_to_host(vcl_QtZ, QtZ);
+    detail::small_cholesky_solve(PtQ, QtZ, r, k);
+
+    viennacl::matrix<NumericT, F> beta(r, k, ctx);
+    detail::small_dense_from_host(QtZ, beta);
+    Z -= viennacl::linalg::prod(P, beta);
+
+    r = detail::block_cg_orthonormalize(Z, deflation_tol, P);
+  }
+
+  return X;
+}
+
+/** @brief Convenience overload of the block conjugate gradient method without preconditioner
+*
+* @param A        The system matrix
+* @param B        The right hand sides, one per column
+* @param tag      Solver configuration tag
+* @return The solution vectors, one per column
+*/
+template<typename MatrixT, typename NumericT, typename F>
+viennacl::matrix<NumericT, F> solve(MatrixT const & A, viennacl::matrix<NumericT, F> const & B, block_cg_tag const & tag)
+{
+  return solve(A, B, tag, viennacl::linalg::no_precond());
+}
+
+}
+}
+
+#endif
@@ -37,6 +37,7 @@
 #include "viennacl/traits/size.hpp"
 #include "viennacl/meta/result_of.hpp"
 #include "viennacl/linalg/iterative_operations.hpp"
+#include "viennacl/linalg/detail/s_step.hpp"
 
 namespace viennacl
 {
@@ -53,7 +54,8 @@ public:
   * @param tol              Relative tolerance for the residual (solver quits if ||r|| < tol * ||r_initial||)
   * @param max_iterations   The maximum number of iterations
   */
-  cg_tag(double tol = 1e-8, unsigned int max_iterations = 300) : tol_(tol), abs_tol_(0), iterations_(max_iterations) {}
+  cg_tag(double tol = 1e-8, unsigned int max_iterations = 300)
+    : tol_(tol), abs_tol_(0), iterations_(max_iterations), s_(1), s_step_basis_(S_STEP_NEWTON_BASIS), iters_taken_(0), last_error_(0), s_step_breakdowns_(0) {}
 
   /** @brief Returns the relative tolerance */
   double tolerance() const { return tol_; }
@@ -75,15 +77,32 @@ public:
   /** @brief Sets the estimated relative error at the end of the solver run */
   void error(double e) const { last_error_ = e; }
 
+  /** @brief Returns the number of Krylov vectors generated per global reduction. A value of one selects the standard (or pipelined) CG method. */
+  unsigned int s_steps() const { return s_; }
+  /** @brief Sets the number of Krylov vectors generated per global reduction (s-step CG, only available for ViennaCL vectors). Typical values are 2 to 8. */
+  void s_steps(unsigned int s) { if (s > 0) s_ = s; }
+
+  /** @brief Returns the polynomial basis used by s-step CG */
+  s_step_basis_type s_step_basis() const { return s_step_basis_; }
+  /** @brief Sets the polynomial basis used by s-step CG */
+  void s_step_basis(s_step_basis_type basis) { s_step_basis_ = basis; }
+
+  /** @brief Returns the number of times s-step CG detected an unstable basis or a residual gap and restarted with a smaller s */
+  unsigned int s_step_breakdowns() const { return s_step_breakdowns_; }
+  /** @brief Sets the number of s-step breakdowns (should only be modified by the solver) */
+  void s_step_breakdowns(unsigned int num) const { s_step_breakdowns_ = num; }
 
 private:
   double tol_;
   double abs_tol_;
   unsigned int iterations_;
+  unsigned int s_;
+  s_step_basis_type s_step_basis_;
 
   //return values from solver
   mutable unsigned int iters_taken_;
   mutable double last_error_;
+  mutable unsigned int s_step_breakdowns_;
 };
 
 namespace detail
@@ -110,6 +129,304 @@ namespace detail
 
 }
 
+namespace detail
+{
+
+  /** @brief Implementation of the s-step (communication-avoiding) preconditioned conjugate gradient method, specialized for ViennaCL types.
+  *
+  * Following A. T. Chronopoulos and C. W. Gear, J. Comput. Appl. Math. 25(2), 153-168 (1989), and E. Carson's thesis (UC Berkeley, 2015).
+  * Each block generates s Krylov vectors U_j (in residual space) and V_j = M^{-1} U_j with a Newton or Chebyshev basis and computes all required
+  * inner products in a single matrix-matrix product of the block with itself, so the number of global reductions is reduced by a factor of s.
+  * The search directions are A-orthogonalized block-wise against the previous block only, which is exact in exact arithmetic.
+  *
+  * The first s iterations are carried out with block size one (i.e. standard CG with one reduction per iteration) in order to obtain Ritz values for the basis.
+  * If the A-projected block matrix loses positive definiteness (unstable basis), or if the true residual deviates from the recursively updated residual at convergence,
+  * the residual is recomputed, s is halved, and the iteration is restarted. These events are counted in tag.s_step_breakdowns().
+  */
+  template<typename MatrixT, typename NumericT, typename PreconditionerT>
+  viennacl::vector<NumericT> s_step_solve(MatrixT const & A,
+                                          viennacl::vector<NumericT> const & rhs,
+                                          cg_tag const & tag,
+                                          PreconditionerT const & precond,
+                                          bool (*monitor)(viennacl::vector<NumericT> const &, NumericT, void*) = NULL,
+                                          void *monitor_data = NULL)
+  {
+    typedef viennacl::matrix<NumericT, viennacl::column_major>   DenseMatrixType;
+
+    viennacl::context ctx = viennacl::traits::context(rhs);
+    vcl_size_t n = rhs.size();
+    bool preconditioned = detail::s_step_is_preconditioned(precond);
+    double stability_tol = std::sqrt(static_cast<double>(std::numeric_limits<NumericT>::epsilon()));
+
+    viennacl::vector<NumericT> result = viennacl::zero_vector<NumericT>(n, ctx);
+    viennacl::vector<NumericT> residual(rhs);
+    viennacl::vector<NumericT> z(rhs);
+    precond.apply(z);
+
+    tag.iters(0);
+    tag.s_step_breakdowns(0);
+    tag.error(0);
+
+    double norm_rhs_squared = viennacl::linalg::inner_prod(residual, z);
+    if (std::fabs(norm_rhs_squared) <= tag.abs_tolerance() * tag.abs_tolerance()) //solution is zero if RHS norm (squared) is zero
+      return result;
+
+    vcl_size_t s_target = std::min<vcl_size_t>(tag.s_steps(), n);
+    detail::s_step_basis basis;
+    detail::s_step_monomial_basis(basis, 1);
+    std::vector<double> lanczos_alpha, lanczos_beta; // CG coefficients of the startup phase for estimating Ritz values
+    bool startup = true;
+
+    // W holds the columns [A*P_prev, V_0, ..., V_{s-1}, U_0, ..., U_s], where V and U coincide without preconditioner:
+    DenseMatrixType W(n, 1, ctx);
+    DenseMatrixType gram(1, 1, ctx);
+    DenseMatrixType P[2]  = { DenseMatrixType(n, 1, ctx), DenseMatrixType(n, 1, ctx) };
+    DenseMatrixType AP[2] = { DenseMatrixType(n, 1, ctx), DenseMatrixType(n, 1, ctx) };
+    vcl_size_t current = 0;
+    vcl_size_t s_prev = 0;             // number of columns of the previous block of search directions (zero after a restart)
+    std::vector<double> W_prev;        // P_prev^T * A * P_prev
+    viennacl::vector<NumericT> temp(n, ctx);
+
+    unsigned int iters = 0;
+    double rel_residual = 1;
+    double min_rel_residual = std::numeric_limits<double>::max();
+    double window_rel_residual = std::numeric_limits<double>::max(); // residual at the start of the current window of blocks for monitoring progress
+    unsigned int window_blocks = 0;
+    bool restart = false;
+    while (iters < tag.max_iterations())
+    {
+      if (restart) // instability detected: replace the residual by the true residual and restart with smaller s
+      {
+        temp = viennacl::linalg::prod(A, result);
+        residual = rhs - temp;
+        tag.s_step_breakdowns(tag.s_step_breakdowns() + 1);
+        s_target = std::max<vcl_size_t>(s_target / 2, 1);
+        s_prev = 0;
+        min_rel_residual = window_rel_residual = std::numeric_limits<double>::max();
+        window_blocks = 0;
+        restart = false;
+      }
+
+      vcl_size_t s = std::min<vcl_size_t>(startup ? 1 : s_target, tag.max_iterations() - iters);
+
+      //
+      // Generate basis: U_0 = r, V_j = M^{-1} U_j, U_{j+1} = (A V_j - alpha_j U_j - beta_j U_{j-1}) / gamma_j
+      //
+      vcl_size_t v_offset = s_prev;
+      vcl_size_t u_offset = s_prev + (preconditioned ? s : 0);
+      vcl_size_t num_cols = u_offset + s + 1;
+      if (W.size2() != num_cols)
+        W.resize(n, num_cols, false);
+
+      vcl_size_t stride = W.internal_size1();
+      {
+        viennacl::vector_base<NumericT> U_0(W.handle(), n, u_offset * stride, 1);
+        U_0 = residual;
+      }
+      for (vcl_size_t j = 0; j < s; ++j)
+      {
+        viennacl::vector_base<NumericT> U_j(W.handle(), n, (u_offset + j) * stride, 1);
+        viennacl::vector_base<NumericT> U_j_minus_1(W.handle(), n, (u_offset + (j > 0 ? j - 1 : 0)) * stride, 1);
+        viennacl::vector_base<NumericT> U_j_plus_1(W.handle(), n, (u_offset + j + 1) * stride, 1);
+        viennacl::vector_base<NumericT> V_j(W.handle(), n, ((preconditioned ? v_offset : u_offset) + j) * stride, 1);
+        if (preconditioned)
+        {
+          V_j = U_j;
+          detail::s_step_precondition(precond, V_j, temp);
+        }
+        U_j_plus_1 = viennacl::linalg::prod(A, V_j);
+        detail::s_step_recurrence(basis, j, U_j_plus_1, U_j, U_j_minus_1);
+      }
+      if (s_prev > 0)
+        viennacl::project(W, viennacl::range(0, n), viennacl::range(0, s_prev)) = AP[current];
+
+      //
+      // Single reduction: [A*P_prev, V]^T * [V, U] (without preconditioner: [A*P_prev, V]^T * U)
+      //
+      vcl_size_t gram_rows = s_prev + s;
+      vcl_size_t gram_cols = num_cols - s_prev;
+      gram.resize(gram_rows, gram_cols, false);
+      gram = viennacl::linalg::prod(trans(viennacl::project(W, viennacl::range(0, n), viennacl::range(0, gram_rows))),
+                                    viennacl::project(W, viennacl::range(0, n), viennacl::range(s_prev, num_cols)));
+      std::vector<double> G;
+      detail::small_dense_to_host(gram, G);
+
+      vcl_size_t u_col = gram_cols - (s + 1);
+      std::vector<double> VtU(s * (s + 1));  // V^T * U
+      for (vcl_size_t j = 0; j <= s; ++j)
+        for (vcl_size_t i = 0; i < s; ++i)
+          VtU[i + j * s] = G[s_prev + i + (u_col + j) * gram_rows];
+
+      //
+      // Check for convergence using r^T z = U_0^T V_0:
+      //
+      double ip_rz = VtU[0];
+      rel_residual = std::sqrt(std::fabs(ip_rz / norm_rhs_squared));
+      if (monitor && monitor(result, NumericT(rel_residual), monitor_data))
+        break;
+      if (rel_residual < tag.tolerance() || std::fabs(ip_rz) < tag.abs_tolerance() * tag.abs_tolerance())
+      {
+        // stability check: compare with the true residual
+        temp = viennacl::linalg::prod(A, result);
+        residual = rhs - temp;
+        z = residual;
+        precond.apply(z);
+        double true_ip_rz = viennacl::linalg::inner_prod(residual, z);
+        rel_residual = std::sqrt(std::fabs(true_ip_rz / norm_rhs_squared));
+        if (startup || s_target == 1 || rel_residual < 10.0 * tag.tolerance() || std::fabs(true_ip_rz) < tag.abs_tolerance() * tag.abs_tolerance())
+          break;
+
+        restart = true;
+        continue;
+      }
+      // stability check: the residual must neither grow by an order of magnitude, nor stall over four blocks once it is small (attainable accuracy of the basis reached)
+      min_rel_residual = std::min(min_rel_residual, rel_residual);
+      bool stalled = false;
+      if (++window_blocks > 3)
+      {
+        stalled = (min_rel_residual < std::sqrt(stability_tol) && min_rel_residual > 0.5 * window_rel_residual);
+        window_rel_residual = min_rel_residual;
+        window_blocks = 0;
+      }
+      if (!startup && s > 1 && (rel_residual > 10.0 * min_rel_residual || stalled))
+      {
+        restart = true;
+        continue;
+      }
+
+      //
+      // Small dense computations on the host
+      //
+      std::vector<double> T = detail::s_step_change_of_basis(basis, s);
+      std::vector<double> W_new(s * s, 0.0);   // V^T A V = V^T U T
+      for (vcl_size_t j = 0; j < s; ++j)
+        for (vcl_size_t l = 0; l <= s; ++l)
+          for (vcl_size_t i = 0; i < s; ++i)
+            W_new[i + j * s] += VtU[i + l * s] * T[l + j * (s + 1)];
+
+      std::vector<double> B(s_prev * s); // B = W_prev^{-1} * (A P_prev)^T V
+      bool stable = true;
+      if (s_prev > 0)
+      {
+        for (vcl_size_t j = 0; j < s; ++j)
+          for (vcl_size_t i = 0; i < s_prev; ++i)
+            B[i + j * s_prev] = G[i + j * gram_rows];
+        std::vector<double> C(B);
+        stable = detail::small_cholesky_solve(W_prev, B, s_prev, s);
+
+        for (vcl_size_t j = 0; j < s; ++j)   // P^T A P = V^T A V - C^T B
+          for (vcl_size_t i = 0; i < s; ++i)
+            for (vcl_size_t l = 0; l < s_prev; ++l)
+              W_new[i + j * s] -= C[l + i * s_prev] * B[l + j * s_prev];
+      }
+      for (vcl_size_t j = 0; j < s; ++j)
+        for (vcl_size_t i = 0; i < j; ++i)
+          W_new[i + j * s] = W_new[j + i * s] = 0.5 * (W_new[i + j * s] + W_new[j + i * s]);
+
+      // stability check: the basis (its Gram matrix V^T U = V^T M V) and the projected matrix P^T A P must be numerically positive definite
+      std::vector<double> basis_gram(VtU.begin(), VtU.begin() + static_cast<long>(s * s));
+      for (vcl_size_t j = 0; j < s; ++j)
+        for (vcl_size_t i = 0; i < j; ++i)
+          basis_gram[i + j * s] = basis_gram[j + i * s] = 0.5 * (basis_gram[i + j * s] + basis_gram[j + i * s]);
+      std::vector<double> W_factor(W_new);
+      if (stable)
+        stable = (detail::small_cholesky_factor(basis_gram, s, stability_tol) == s) && (detail::small_cholesky_factor(W_factor, s, stability_tol) == s);
+      if (!stable)
+      {
+        if (s == 1) // breakdown of CG itself: A or M not positive definite, or exact solution found
+          break;
+        restart = true;
+        continue;
+      }
+
+      std::vector<double> a(s); // step lengths: (P^T A P)^{-1} P^T r with P^T r = V^T r
+      for (vcl_size_t i = 0; i < s; ++i)
+        a[i] = VtU[i];
+      detail::small_cholesky_solve(W_new, a, s, 1);
+
+      if (startup)
+      {
+        if (s_prev > 0)
+          lanczos_beta.push_back(-B[0]);
+        lanczos_alpha.push_back(a[0]);
+      }
+
+      //
+      // Update search directions and iterates: P = V - P_prev B, A P = U T - A P_prev B, x += P a, r -= A P a
+      //
+      vcl_size_t next = 1 - current;
+      P[next].resize(n, s, false);
+      AP[next].resize(n, s, false);
+
+      DenseMatrixType vcl_T(s + 1, s, ctx);
+      detail::small_dense_from_host(T, vcl_T);
+      AP[next] = viennacl::linalg::prod(viennacl::project(W, viennacl::range(0, n), viennacl::range(u_offset, u_offset + s + 1)), vcl_T);
+      P[next] = viennacl::project(W, viennacl::range(0, n), viennacl::range(preconditioned ? v_offset : u_offset, (preconditioned ? v_offset : u_offset) + s));
+      if (s_prev > 0)
+      {
+        for (vcl_size_t i = 0; i < B.size(); ++i)
+          B[i] = -B[i];
+        DenseMatrixType vcl_B(s_prev, s, ctx);
+        detail::small_dense_from_host(B, vcl_B);
+        P[next]  += viennacl::linalg::prod(P[current], vcl_B);
+        AP[next] += viennacl::linalg::prod(AP[current], vcl_B);
+      }
+
+      viennacl::vector<NumericT> vcl_a(s, ctx);
+      std::vector<NumericT> host_a(a.begin(), a.end());
+      viennacl::fast_copy(host_a.begin(), host_a.end(), vcl_a.begin());
+      result   += viennacl::linalg::prod(P[next], vcl_a);
+      residual -= viennacl::linalg::prod(AP[next], vcl_a);
+
+      current = next;
+      s_prev  = s;
+      W_prev  = W_new;
+      iters  += static_cast<unsigned int>(s);
+      tag.iters(iters);
+
+      //
+      // After the startup phase, set up the basis from the Ritz values of the Lanczos matrix of the CG coefficients:
+      //
+      if (startup && (lanczos_alpha.size() == s_target || s_target == 1))
+      {
+        vcl_size_t k = lanczos_alpha.size();
+        std::vector<double> lanczos_T(k * k, 0.0);
+        for (vcl_size_t j = 0; j < k; ++j)
+        {
+          lanczos_T[j + j * k] = 1.0 / lanczos_alpha[j] + ((j > 0) ? lanczos_beta[j - 1] / lanczos_alpha[j - 1] : 0.0);
+          if (j + 1 < k)
+            lanczos_T[j + (j + 1) * k] = lanczos_T[j + 1 + j * k] = std::sqrt(std::fabs(lanczos_beta[j])) / lanczos_alpha[j];
+        }
+        detail::s_step_setup_basis(basis, detail::s_step_ritz_values(lanczos_T, k), tag.s_step_basis(), s_target);
+        startup = false;
+        s_prev = 0; // the first block would need to be A-orthogonalized against the last s directions, hence restart
+        min_rel_residual = window_rel_residual = std::numeric_limits<double>::max();
+        window_blocks = 0;
+      }
+    }
+
+    //store last error estimate:
+    tag.error(rel_residual);
+
+    return result;
+  }
+
+  /** @brief Dispatches to s-step CG for ViennaCL vectors. Returns false for all other vector types, which are solved with the standard method. */
+  template<typename MatrixT, typename VectorT, typename PreconditionerT, typename MonitorT>
+  bool s_step_dispatch(MatrixT const &, VectorT const &, VectorT &, cg_tag const &, PreconditionerT const &, MonitorT, void *)
+  {
+    return false;
+  }
+
+  template<typename MatrixT, typename NumericT, typename PreconditionerT, typename MonitorT>
+  bool s_step_dispatch(MatrixT const & A, viennacl::vector<NumericT> const & rhs, viennacl::vector<NumericT> & result, cg_tag const & tag, PreconditionerT const & precond, MonitorT monitor, void *monitor_data)
+  {
+    result = detail::s_step_solve(A, rhs, tag, precond, monitor, monitor_data);
+    return true;
+  }
+
+}
+
 namespace detail
 {
 
@@ -135,6 +452,9 @@ namespace detail
   {
     typedef typename viennacl::vector<NumericT>::difference_type   difference_type;
 
+    if (tag.s_steps() > 1)
+      return detail::s_step_solve(A, rhs, tag, viennacl::linalg::no_precond(), monitor, monitor_data);
+
     viennacl::vector<NumericT> result(rhs);
     viennacl::traits::clear(result);
 
@@ -268,6 +588,9 @@ namespace detail
     VectorT result = rhs;
     viennacl::traits::clear(result);
 
+    if (tag.s_steps() > 1 && detail::s_step_dispatch(matrix, rhs, result, tag, precond, monitor, monitor_data))
+      return result;
+
     VectorT residual = rhs;
     VectorT tmp = rhs;
     detail::z_handler<VectorT, PreconditionerT> zhandler(residual);
@@ -0,0 +1,434 @@
+#ifndef VIENNACL_LINALG_CHEBYSHEV_HPP_
+#define VIENNACL_LINALG_CHEBYSHEV_HPP_
+
+/* =========================================================================
+   Copyright (c) 2010-2016, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+   Portions of this software are copyright by UChicago Argonne, LLC.
+
+                            -----------------
+                  ViennaCL - The Vienna Computing Library
+                            -----------------
+
+   Project Head:    Karl Rupp                   rupp@iue.tuwien.ac.at
+
+   (A list of authors and contributors can be found in the manual)
+
+   License:         MIT (X11), see file LICENSE in the base directory
+============================================================================= */
+
+/** @file viennacl/linalg/chebyshev.hpp
+    @brief The Chebyshev iteration as a solver, as a polynomial preconditioner, and as a smoother for algebraic multigrid.
+
+    The Chebyshev iteration for the Jacobi-preconditioned system D^{-1} A x = D^{-1} b only requires bounds [lambda_min, lambda_max] for the spectrum of D^{-1} A.
+    In contrast to CG or BiCGStab no inner products are needed in the iteration, hence each step is a single sweep over the matrix with the residual computation and the vector updates fused into the matrix-vector product.
+    If no bounds are supplied by the user, they are estimated once from a few steps of the Jacobi-preconditioned Lanczos process.
+    The method requires the spectrum of D^{-1} A to be real and positive, e.g. for symmetric positive definite systems.
+    See Saad, Iterative Methods for Sparse Linear Systems, 2nd edition, Algorithm 12.1.
+*/
+
+#include <vector>
+#include <cmath>
+#include <limits>
+
+#include "viennacl/forwards.h"
+#include "viennacl/vector.hpp"
+#include "viennacl/compressed_matrix.hpp"
+#include "viennacl/linalg/prod.hpp"
+#include "viennacl/linalg/inner_prod.hpp"
+#include "viennacl/linalg/norm_2.hpp"
+#include "viennacl/linalg/jacobi_precond.hpp"
+#include "viennacl/linalg/iterative_operations.hpp"
+#include "viennacl/linalg/detail/s_step.hpp"
+
+namespace viennacl
+{
+namespace linalg
+{
+
+/** @brief A tag for the Chebyshev iteration. Used for supplying solver parameters and for dispatching the solve() function
+*/
+class chebyshev_tag
+{
+public:
+  /** @brief The constructor
+  *
+  * @param tol              Relative tolerance for the residual (solver quits if ||r|| < tol * ||r_initial||)
+  * @param max_iterations   The maximum number of iterations
+  * @param lambda_min       Lower bound for the eigenvalues of D^{-1} A, where D is the diagonal of A. Estimated by the solver if zero.
+  * @param lambda_max       Upper bound for the eigenvalues of D^{-1} A, where D is the diagonal of A. Estimated by the solver if zero.
+  */
+  chebyshev_tag(double tol = 1e-8, unsigned int max_iterations = 1000, double lambda_min = 0, double lambda_max = 0)
+    : tol_(tol), iterations_(max_iterations), lambda_min_(lambda_min), lambda_max_(lambda_max),
+      estimation_steps_(20), check_interval_(10), iters_taken_(0), last_error_(0), used_lambda_min_(0), used_lambda_max_(0) {}
+
+  /** @brief Returns the relative tolerance */
+  double tolerance() const { return tol_; }
+
+  /** @brief Returns the maximum number of iterations */
+  unsigned int max_iterations() const { return iterations_; }
+
+  /** @brief Returns the user-supplied lower bound for the spectrum of D^{-1} A. Zero if the bound is to be estimated. */
+  double lambda_min() const { return lambda_min_; }
+  /** @brief Returns the user-supplied upper bound for the spectrum of D^{-1} A. Zero if the bound is to be estimated. */
+  double lambda_max() const { return lambda_max_; }
+
+  /** @brief Returns the number of Lanczos steps used for estimating the spectral bounds */
+  unsigned int estimation_steps() const { return estimation_steps_; }
+  /** @brief Sets the number of Lanczos steps used for estimating the spectral bounds */
+  void estimation_steps(unsigned int steps) { if (steps > 0) estimation_steps_ = steps; }
+
+  /** @brief Returns the number of iterations after which the residual norm is checked for convergence and divergence */
+  unsigned int check_interval() const { return check_interval_; }
+  /** @brief Sets the number of iterations after which the residual norm is checked for convergence and divergence */
+  void check_interval(unsigned int interval) { if (interval > 0) check_interval_ = interval; }
+
+  /** @brief Return the number of solver iterations: */
+  unsigned int iters() const { return iters_taken_; }
+  void iters(unsigned int i) const { iters_taken_ = i; }
+
+  /** @brief Returns the estimated relative error at the end of the solver run */
+  double error() const { return last_error_; }
+  /** @brief Sets the estimated relative error at the end of the solver run */
+  void error(double e) const { last_error_ = e; }
+
+  /** @brief Returns the lower spectral bound used in the last solver run. May be smaller than the supplied or estimated bound if the solver detected divergence. */
+  double used_lambda_min() const { return used_lambda_min_; }
+  /** @brief Returns the upper spectral bound used in the last solver run. */
+  double used_lambda_max() const { return used_lambda_max_; }
+  /** @brief Sets the spectral bounds used in the last solver run (should only be modified by the solver) */
+  void used_bounds(double lambda_min, double lambda_max) const { used_lambda_min_ = lambda_min; used_lambda_max_ = lambda_max; }
+
+private:
+  double tol_;
+  unsigned int iterations_;
+  double lambda_min_;
+  double lambda_max_;
+  unsigned int estimation_steps_;
+  unsigned int check_interval_;
+
+  //return values from solver
+  mutable unsigned int iters_taken_;
+  mutable double last_error_;
+  mutable double used_lambda_min_;
+  mutable double used_lambda_max_;
+};
+
+
+/** @brief A tag for the Chebyshev polynomial preconditioner.
+*/
+class chebyshev_precond_tag
+{
+public:
+  /** @brief The constructor
+  *
+  * For a low polynomial degree it does not pay off to target the whole spectrum of D^{-1} A. Instead, the polynomial damps the error components with eigenvalues in [lambda_max / ratio, lambda_max], which is the same approach as for smoothers in multigrid.
+  *
+  * @param degree        Degree of the Chebyshev polynomial, i.e. the number of sweeps over the matrix per preconditioner application
+  * @param ratio         Ratio lambda_max / lambda_min of the interval targeted by the polynomial
+  * @param lambda_max    Upper bound for the eigenvalues of D^{-1} A, where D is the diagonal of A. Estimated if zero.
+  */
+  chebyshev_precond_tag(unsigned int degree = 3, double ratio = 10.0, double lambda_max = 0)
+    : degree_(degree), ratio_(ratio > 1 ? ratio : 10.0), lambda_max_(lambda_max), estimation_steps_(10) {}
+
+  /** @brief Returns the degree of the Chebyshev polynomial */
+  unsigned int degree() const { return degree_; }
+
+  /** @brief Returns the ratio lambda_max / lambda_min of the interval targeted by the polynomial */
+  double ratio() const { return ratio_; }
+
+  /** @brief Returns the user-supplied upper bound for the spectrum of D^{-1} A. Zero if the bound is to be estimated. */
+  double lambda_max() const { return lambda_max_; }
+
+  /** @brief Returns the number of Lanczos steps used for estimating the upper spectral bound */
+  unsigned int estimation_steps() const { return estimation_steps_; }
+  /** @brief Sets the number of Lanczos steps used for estimating the upper spectral bound */
+  void estimation_steps(unsigned int steps) { if (steps > 0) estimation_steps_ = steps; }
+
+private:
+  unsigned int degree_;
+  double ratio_;
+  double lambda_max_;
+  unsigned int estimation_steps_;
+};
+
+
+namespace detail
+{
+
+  /** @brief Safety factor applied to the largest Ritz value: the Chebyshev polynomial grows rapidly beyond the upper bound, hence the bound must not be underestimated. */
+  inline double chebyshev_upper_bound_safety() { return 1.1; }
+
+  /** @brief Estimates the extremal eigenvalues of D^{-1} A, where D is the diagonal of the symmetric matrix A, from 'steps' steps of the Jacobi-preconditioned Lanczos process.
+  *
+  * The Lanczos coefficients are obtained from the recurrences of preconditioned CG started with a fixed pseudo-random right hand side.
+  * The Ritz values are interior to the spectrum, hence lambda_min is an upper bound for the smallest and lambda_max a lower bound for the largest eigenvalue.
+  */
+  template<typename NumericT, unsigned int AlignmentV>
+  void chebyshev_estimate_bounds(viennacl::compressed_matrix<NumericT, AlignmentV> const & A, vcl_size_t steps,
+                                 double & lambda_min, double & lambda_max)
+  {
+    vcl_size_t n = A.size1();
+    steps = std::min(steps, n);
+
+    viennacl::linalg::jacobi_precond< viennacl::compressed_matrix<NumericT, AlignmentV> > jacobi(A, viennacl::linalg::jacobi_tag());
+
+    // fixed pseudo-random start vector for reproducible bounds:
+    std::vector<NumericT> host_r(n);
+    unsigned long state = 12345;
+    for (vcl_size_t i = 0; i < n; ++i)
+    {
+      state = (state * 1103515245UL + 12345UL) % 2147483648UL;
+      host_r[i] = NumericT(0.5) + NumericT(state) / NumericT(2147483648.0);
+    }
+
+    viennacl::vector<NumericT> r(n, viennacl::traits::context(A));
+    viennacl::copy(host_r, r);
+    viennacl::vector<NumericT> z = r;
+    jacobi.apply(z);
+    viennacl::vector<NumericT> p = z;
+    viennacl::vector<NumericT> Ap(n, viennacl::traits::context(A));
+
+    std::vector<double> alphas;
+    std::vector<double> betas;
+
+    double rz = viennacl::linalg::inner_prod(r, z);
+    double rz_0 = rz;
+    for (vcl_size_t j = 0; j < steps; ++j)
+    {
+      Ap = viennacl::linalg::prod(A, p);
+      double pAp = viennacl::linalg::inner_prod(p, Ap);
+      if (pAp <= 0 || rz <= 0) // (numerically) indefinite or converged
+        break;
+
+      double alpha = rz / pAp;
+      r -= NumericT(alpha) * Ap;
+      z = r;
+      jacobi.apply(z);
+      double rz_new = viennacl::linalg::inner_prod(r, z);
+      double beta = rz_new / rz;
+      p = z + NumericT(beta) * p;
+
+      alphas.push_back(alpha);
+      betas.push_back(beta);
+      rz = rz_new;
+
+      if (rz <= 1e-24 * rz_0) // invariant subspace found
+        break;
+    }
+
+    vcl_size_t k = alphas.size();
+    if (k == 0)
+    {
+      lambda_min = lambda_max = 1.0;
+      return;
+    }
+
+    // Lanczos matrix from the CG coefficients:
+    std::vector<double> T(k * k, 0.0);
+    for (vcl_size_t j = 0; j < k; ++j)
+    {
+      T[j + j * k] = 1.0 / alphas[j] + ((j > 0) ? betas[j-1] / alphas[j-1] : 0.0);
+      if (j + 1 < k)
+      {
+        T[j + 1 + j * k] = std::sqrt(betas[j]) / alphas[j];
+        T[j + (j + 1) * k] = T[j + 1 + j * k];
+      }
+    }
+
+    std::vector<double> ritz = viennacl::linalg::detail::s_step_ritz_values(T, k);
+    lambda_min = ritz.front();
+    lambda_max = ritz.back();
+  }
+
+
+  /** @brief Coefficients of the three-term recurrence of the Chebyshev iteration for the interval [lambda_min, lambda_max] */
+  class chebyshev_recurrence
+  {
+  public:
+    chebyshev_recurrence(double lambda_min, double lambda_max)
+      : theta_(0.5 * (lambda_max + lambda_min)), delta_(0.5 * (lambda_max - lambda_min)), rho_(0), first_(true)
+    {
+      if (delta_ <= 0) // degenerate interval: Richardson iteration with optimal step size
+        delta_ = 1e-8 * theta_;
+      sigma_ = theta_ / delta_;
+    }
+
+    /** @brief Restarts the recurrence, e.g. after changing the current iterate or the right hand side. */
+    void restart() { first_ = true; }
+
+    /** @brief Returns the coefficients alpha and beta for the update d = alpha * d + beta * D^{-1} r of the next step. */
+    void next(double & alpha, double & beta)
+    {
+      if (first_)
+      {
+        rho_   = 1.0 / sigma_;
+        alpha  = 0;
+        beta   = 1.0 / theta_;
+        first_ = false;
+        return;
+      }
+
+      double rho_new = 1.0 / (2.0 * sigma_ - rho_);
+      alpha = rho_new * rho_;
+      beta  = 2.0 * rho_new / delta_;
+      rho_  = rho_new;
+    }
+
+  private:
+    double theta_;
+    double delta_;
+    double sigma_;
+    double rho_;
+    bool first_;
+  };
+
+
+  /** @brief Applies 'steps' steps of the Chebyshev iteration for the interval [lambda_min, lambda_max] to the current iterate 'x' of A x = rhs. Returns the squared norm of the residual before the last step.
+  *
+  * Used as smoother in algebraic multigrid and as polynomial preconditioner. The vectors 'x_backup' and 'd' are used as temporary storage.
+  */
+  template<typename MatrixT, typename NumericT>
+  NumericT chebyshev_smooth(vcl_size_t steps, MatrixT const & A,
+                            viennacl::vector_base<NumericT> & x, viennacl::vector_base<NumericT> & x_backup, viennacl::vector_base<NumericT> & d,
+                            viennacl::vector_base<NumericT> const & rhs,
+                            double lambda_min, double lambda_max)
+  {
+    chebyshev_recurrence recurrence(lambda_min, lambda_max);
+    NumericT residual_norm_squared = 0;
+    for (vcl_size_t i = 0; i < steps; ++i)
+    {
+      double alpha, beta;
+      recurrence.next(alpha, beta);
+      residual_norm_squared = viennacl::linalg::chebyshev_sweep(A, x, x_backup, d, rhs, NumericT(alpha), NumericT(beta));
+    }
+    return residual_norm_squared;
+  }
+
+} //namespace detail
+
+
+/** @brief Implementation of the Jacobi-preconditioned Chebyshev iteration for compressed_matrix
+*
+* If the residual norm grows between two convergence checks, the lower spectral bound is halved and the recurrence is restarted from the current iterate.
+*
+* @param A          The system matrix
+* @param rhs        The load vector
+* @param tag        Solver configuration tag
+* @return The result vector
+*/
+template<typename NumericT, unsigned int AlignmentV>
+viennacl::vector<NumericT> solve(viennacl::compressed_matrix<NumericT, AlignmentV> const & A, viennacl::vector<NumericT> const & rhs, chebyshev_tag const & tag)
+{
+  viennacl::vector<NumericT> result = viennacl::zero_vector<NumericT>(rhs.size(), viennacl::traits::context(rhs));
+  viennacl::vector<NumericT> result_backup(rhs.size(), viennacl::traits::context(rhs));
+  viennacl::vector<NumericT> d(rhs.size(), viennacl::traits::context(rhs));
+
+  tag.iters(0);
+  tag.error(0);
+
+  double norm_rhs = viennacl::linalg::norm_2(rhs);
+  if (norm_rhs <= 0) // solution is zero if RHS norm is zero
+    return result;
+
+  double lambda_min = tag.lambda_min();
+  double lambda_max = tag.lambda_max();
+  if (lambda_max <= 0 || lambda_min <= 0)
+  {
+    double ritz_min, ritz_max;
+    viennacl::linalg::detail::chebyshev_estimate_bounds(A, tag.estimation_steps(), ritz_min, ritz_max);
+    if (lambda_min <= 0)
+      lambda_min = ritz_min;
+    if (lambda_max <= 0)
+      lambda_max = viennacl::linalg::detail::chebyshev_upper_bound_safety() * ritz_max;
+  }
+
+  viennacl::linalg::detail::chebyshev_recurrence recurrence(lambda_min, lambda_max);
+
+  double last_check_norm = norm_rhs;
+  double residual_norm = norm_rhs;
+  unsigned int i = 0;
+  for (; i < tag.max_iterations(); ++i)
+  {
+    double alpha, beta;
+    recurrence.next(alpha, beta);
+    residual_norm = std::sqrt(static_cast<double>(viennacl::linalg::chebyshev_sweep(A, result, result_backup, d, rhs, NumericT(alpha), NumericT(beta))));
+
+    if (residual_norm <= tag.tolerance() * norm_rhs) // residual before the last update, hence the returned result is slightly more accurate
+      break;
+
+    if ((i + 1) % tag.check_interval() == 0)
+    {
+      if (residual_norm > last_check_norm) // lower bound was overestimated, low-frequency error components grow
+      {
+        lambda_min *= 0.5;
+        recurrence = viennacl::linalg::detail::chebyshev_recurrence(lambda_min, lambda_max);
+      }
+      last_check_norm = residual_norm;
+    }
+  }
+
+  tag.iters(std::min(i + 1, tag.max_iterations()));
+  tag.error(residual_norm / norm_rhs);
+  tag.used_bounds(lambda_min, lambda_max);
+
+  return result;
+}
+
+
+/** @brief Polynomial preconditioner based on a fixed number of Chebyshev iterations with zero initial guess.
+*
+* Each application is a fixed linear operator, hence the preconditioner can be used with CG. For symmetric positive definite systems the preconditioner is positive definite as long as the upper spectral bound is not underestimated.
+* The upper spectral bound is estimated once in the constructor if not supplied through the tag. The system matrix is referenced, not copied, hence it needs to outlive the preconditioner.
+*/
+template<typename MatrixT>
+class chebyshev_precond {};
+
+/** @brief Chebyshev polynomial preconditioner for compressed_matrix */
+template<typename NumericT, unsigned int AlignmentV>
+class chebyshev_precond< viennacl::compressed_matrix<NumericT, AlignmentV> >
+{
+  typedef viennacl::compressed_matrix<NumericT, AlignmentV>  MatrixType;
+
+public:
+  chebyshev_precond(MatrixType const & A, chebyshev_precond_tag const & tag)
+    : A_(A), tag_(tag), lambda_max_(tag.lambda_max()),
+      rhs_(A.size1(), viennacl::traits::context(A)), x_backup_(A.size1(), viennacl::traits::context(A)), d_(A.size1(), viennacl::traits::context(A))
+  {
+    if (lambda_max_ <= 0)
+    {
+      double ritz_min, ritz_max;
+      viennacl::linalg::detail::chebyshev_estimate_bounds(A, tag.estimation_steps(), ritz_min, ritz_max);
+      lambda_max_ = viennacl::linalg::detail::chebyshev_upper_bound_safety() * ritz_max;
+    }
+    lambda_min_ = lambda_max_ / tag.ratio();
+  }
+
+  template<typename VectorT>
+  void apply(VectorT & vec) const
+  {
+    rhs_ = vec;
+    vec.clear();
+    viennacl::linalg::detail::chebyshev_smooth(tag_.degree(), A_, vec, x_backup_, d_, rhs_, lambda_min_, lambda_max_);
+  }
+
+  /** @brief Returns the lower spectral bound of D^{-1} A used by the preconditioner */
+  double lambda_min() const { return lambda_min_; }
+  /** @brief Returns the upper spectral bound of D^{-1} A used by the preconditioner */
+  double lambda_max() const { return lambda_max_; }
+
+private:
+  MatrixType const & A_;
+  chebyshev_precond_tag tag_;
+  double lambda_min_;
+  double lambda_max_;
+  mutable viennacl::vector<NumericT> rhs_;
+  mutable viennacl::vector<NumericT> x_backup_;
+  mutable viennacl::vector<NumericT> d_;
+};
+
+}
+}
+
+#endif
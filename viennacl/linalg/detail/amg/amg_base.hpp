@@ -58,6 +58,13 @@ enum amg_interpolation_method
   AMG_INTERPOLATION_METHOD_SMOOTHED_AGGREGATION
 };
 
+/** @brief Enumeration of smoothers for algebraic multigrid. */
+enum amg_smoother_type
+{
+  AMG_SMOOTHER_JACOBI = 1,
+  AMG_SMOOTHER_CHEBYSHEV
+};
+
 
 /** @brief A tag for algebraic multigrid (AMG). Used to transport information from the user to the implementation.
 */
@@ -69,17 +76,20 @@ public:
     * Default coarsening routine: Aggreggation based on maximum independent sets of distance (MIS-2)
     * Default interpolation routine: Smoothed aggregation
     * Default threshold for strong connections: 0.1 (customizations are recommeded!)
+    * Default smoother: Damped Jacobi
     * Default weight for Jacobi smoother: 1.0
+    * Default ratio of the largest and the smallest eigenvalue targeted by the Chebyshev smoother: 10
     * Default number of pre-smooth operations: 2
     * Default number of post-smooth operations: 2
     * Default number of coarse levels: 0 (this indicates that as many coarse levels as needed are constructed until the cutoff is reached)
     * Default coarse grid size for direct solver (coarsening cutoff): 50
+    * Default storage of the operators for the preconditioner applications: Full precision
     */
   amg_tag()
   : coarsening_method_(AMG_COARSENING_METHOD_MIS2_AGGREGATION), interpolation_method_(AMG_INTERPOLATION_METHOD_AGGREGATION),
-    strong_connection_threshold_(0.1), jacobi_weight_(1.0),
+    strong_connection_threshold_(0.1), smoother_(AMG_SMOOTHER_JACOBI), jacobi_weight_(1.0), chebyshev_ratio_(10.0),
     presmooth_steps_(2), postsmooth_steps_(2),
-    coarse_levels_(0), coarse_cutoff_(50) {}
+    coarse_levels_(0), coarse_cutoff_(50), reduced_precision_storage_(false) {}
 
   // Getter-/Setter-Functions
   /** @brief Sets the strategy used for constructing coarse grids  */
@@ -112,6 +122,20 @@ public:
   /** @brief Returns the Jacobi smoother weight (damping). */
   double get_jacobi_weight() const { return jacobi_weight_; }
 
+  /** @brief Sets the smoother applied on each level before restriction and after interpolation. */
+  void set_smoother(amg_smoother_type s) { smoother_ = s; }
+  /** @brief Returns the smoother applied on each level before restriction and after interpolation. */
+  amg_smoother_type get_smoother() const { return smoother_; }
+
+  /** @brief Sets the ratio lambda_max / lambda_min of the interval [lambda_min, lambda_max] damped by the Chebyshev smoother.
+    *
+    * The largest eigenvalue lambda_max of the Jacobi-preconditioned operator is estimated on each level during setup, the smallest one is not needed for smoothing.
+    * The smoother then damps all error components with eigenvalues in [lambda_max / ratio, lambda_max]. The number of pre- and post-smooth steps is the polynomial degree.
+    */
+  void set_chebyshev_ratio(double ratio) { if (ratio > 1) chebyshev_ratio_ = ratio; }
+  /** @brief Returns the ratio lambda_max / lambda_min of the interval damped by the Chebyshev smoother. */
+  double get_chebyshev_ratio() const { return chebyshev_ratio_; }
+
   /** @brief Sets the number of smoother applications on the fine level before restriction to the coarser level. */
   void set_presmooth_steps(vcl_size_t steps) { presmooth_steps_ = steps; }
   /** @brief Returns the number of smoother applications on the fine level before restriction to the coarser level. */
@@ -149,12 +173,24 @@ public:
   /** @brief Returns the ViennaCL context for the solver cycle stage (i.e. preconditioner applications). */
   viennacl::context const & get_target_context() const { return target_ctx_; }
 
+  /** @brief Sets whether the operators of the hierarchy are stored in single precision for the preconditioner applications.
+    *
+    * All computations are still carried out in the precision of the system matrix, only the memory traffic is reduced.
+    * Only has an effect for double precision system matrices with a host target context.
+    */
+  void set_reduced_precision_storage(bool b) { reduced_precision_storage_ = b; }
+  /** @brief Returns whether the operators of the hierarchy are stored in single precision for the preconditioner applications. */
+  bool get_reduced_precision_storage() const { return reduced_precision_storage_; }
+
 private:
   amg_coarsening_method coarsening_method_;
   amg_interpolation_method interpolation_method_;
-  double strong_connection_threshold_, jacobi_weight_;
+  double strong_connection_threshold_;
+  amg_smoother_type smoother_;
+  double jacobi_weight_, chebyshev_ratio_;
   vcl_size_t presmooth_steps_, postsmooth_steps_, coarse_levels_, coarse_cutoff_;
   viennacl::context setup_ctx_, target_ctx_;
+  bool reduced_precision_storage_;
 };
 
 
@@ -68,6 +68,20 @@ private:
 
 namespace detail
 {
+  /** @brief Resets the row array of a matrix to zero, which is required by the extraction of L and U. Memory is only allocated if the size of the matrix changes. */
+  template<typename NumericT>
+  void chow_patel_reset_row_buffer(viennacl::compressed_matrix<NumericT> & M, vcl_size_t size1, vcl_size_t size2)
+  {
+    if (M.size1() != size1 || M.size2() != size2)
+    {
+      M.resize(size1, size2, false); // initializes the row array to zero
+      return;
+    }
+
+    viennacl::backend::typesafe_host_array<unsigned int> zeros(M.handle1(), size1 + 1);
+    viennacl::backend::memory_write(M.handle1(), 0, zeros.raw_size(), zeros.get());
+  }
+
   /** @brief Implementation of the parallel ICC0 factorization, Algorithm 3 in Chow-Patel paper.
    *
    *  Rather than dealing with a column-major upper triangular matrix U, we use the lower-triangular matrix L such that A is approximately given by LL^T.
@@ -80,10 +94,10 @@ namespace detail
                     viennacl::compressed_matrix<NumericT>       & L_trans,
                     chow_patel_tag const & tag)
   {
-    // make sure L and U have correct dimensions:
-    L.resize(A.size1(), A.size2(), false);
+    // make sure L has correct dimensions. Memory of a previous factorization of the same size is reused:
+    chow_patel_reset_row_buffer(L, A.size1(), A.size2());
 
-    // initialize L and U from values in A:
+    // initialize L from values in A:
     viennacl::linalg::extract_L(A, L);
 
     // diagonally scale values from A in L:
@@ -114,9 +128,9 @@ namespace detail
                     viennacl::vector<NumericT>                  & diag_U,
                     chow_patel_tag const & tag)
   {
-    // make sure L and U have correct dimensions:
-    L.resize(A.size1(), A.size2(), false);
-    U.resize(A.size1(), A.size2(), false);
+    // make sure L and U have correct dimensions. Memory of a previous factorization of the same size is reused:
+    chow_patel_reset_row_buffer(L, A.size1(), A.size2());
+    chow_patel_reset_row_buffer(U, A.size1(), A.size2());
 
     // initialize L and U from values in A:
     viennacl::linalg::extract_LU(A, L, U);
@@ -182,6 +196,12 @@ public:
     viennacl::linalg::detail::precondition(A, L_, diag_L_, L_trans_, tag_);
   }
 
+  /** @brief Recomputes the factorization for a matrix with the same size, e.g. an updated Jacobian in a Newton iteration. Memory of the previous factorization is reused. */
+  void refactor(viennacl::compressed_matrix<NumericT, AlignmentV> const & A)
+  {
+    viennacl::linalg::detail::precondition(A, L_, diag_L_, L_trans_, tag_);
+  }
+
   /** @brief Preconditioner application: LL^Tx = b, computed via Ly = b, L^Tx = y using Jacobi iterations.
     *
     * L contains (I - D_L^{-1}L), L_trans contains (I - D_L^{-1}L^T) where D denotes the respective diagonal matrix
@@ -261,6 +281,12 @@ public:
     viennacl::linalg::detail::precondition(A, L_, diag_L_, U_, diag_U_, tag_);
   }
 
+  /** @brief Recomputes the factorization for a matrix with the same size, e.g. an updated Jacobian in a Newton iteration. Memory of the previous factorization is reused. */
+  void refactor(viennacl::compressed_matrix<NumericT, AlignmentV> const & A)
+  {
+    viennacl::linalg::detail::precondition(A, L_, diag_L_, U_, diag_U_, tag_);
+  }
+
   /** @brief Preconditioner application: LUx = b, computed via Ly = b, Ux = y using Jacobi iterations.
     *
     * L_ contains (I - D_L^{-1}L), U_ contains (I - D_U^{-1}U) where D denotes the respective diagonal matrix
@@ -217,6 +217,72 @@ void level_scheduling_setup_U(viennacl::compressed_matrix<NumericT, AlignmentV>
 }
 
 
+//
+// Update of the values after a numeric refactorization with unchanged sparsity pattern:
+//
+
+/** @brief Writes the values of LU to the element buffers set up by level_scheduling_setup_impl() for the same sparsity pattern. The index buffers remain valid and are not touched. */
+template<typename NumericT, unsigned int AlignmentV>
+void level_scheduling_update_values_impl(viennacl::compressed_matrix<NumericT, AlignmentV> const & LU,
+                                         viennacl::vector<NumericT> const & diagonal_LU,
+                                         std::list<viennacl::backend::mem_handle> & element_buffers,
+                                         bool setup_U)
+{
+  NumericT     const * diagonal_buf = viennacl::linalg::host_based::detail::extract_raw_pointer<NumericT>(diagonal_LU.handle());
+  NumericT     const * elements     = viennacl::linalg::host_based::detail::extract_raw_pointer<NumericT>(LU.handle());
+  unsigned int const * row_buffer   = viennacl::linalg::host_based::detail::extract_raw_pointer<unsigned int>(LU.handle1());
+  unsigned int const * col_buffer   = viennacl::linalg::host_based::detail::extract_raw_pointer<unsigned int>(LU.handle2());
+
+  //
+  // Step 1: Determine row elimination order for each row (same as in level_scheduling_setup_impl())
+  //
+  std::vector<vcl_size_t> row_elimination(LU.size1());
+  vcl_size_t max_elimination_runs = 0;
+  for (vcl_size_t row2 = 0; row2 < LU.size1(); ++row2)
+  {
+    vcl_size_t row = setup_U ? (LU.size1() - row2) - 1 : row2;
+
+    vcl_size_t elimination_index = 0;
+    for (vcl_size_t i = row_buffer[row]; i < row_buffer[row+1]; ++i)
+    {
+      unsigned int col = col_buffer[i];
+      if ( (!setup_U && col < row) || (setup_U && col > row) )
+        elimination_index = std::max<vcl_size_t>(elimination_index, row_elimination[col]);
+    }
+    row_elimination[row] = elimination_index + 1;
+    max_elimination_runs = std::max<vcl_size_t>(max_elimination_runs, elimination_index + 1);
+  }
+
+  //
+  // Step 2: Collect values for each elimination step. Rows are traversed in increasing order, which matches the ordering in level_scheduling_setup_impl()
+  //
+  std::vector<std::vector<NumericT> > elim_elements(max_elimination_runs + 1);
+  for (vcl_size_t row = 0; row < LU.size1(); ++row)
+  {
+    for (vcl_size_t i = row_buffer[row]; i < row_buffer[row+1]; ++i)
+    {
+      unsigned int col = col_buffer[i];
+      if ( (!setup_U && col < row) || (setup_U && col > row) ) //entry of L/U
+        elim_elements[row_elimination[col]].push_back(setup_U ? elements[i] / diagonal_buf[row] : elements[i]);
+    }
+  }
+
+  //
+  // Step 3: Write to buffers (only elimination steps with entries have buffers)
+  //
+  typename std::list<viennacl::backend::mem_handle>::iterator it = element_buffers.begin();
+  for (vcl_size_t elimination_run = 1; elimination_run <= max_elimination_runs; ++elimination_run)
+  {
+    if (elim_elements[elimination_run].size() == 0)
+      continue;
+
+    assert(it != element_buffers.end() && bool("Sparsity pattern changed since level scheduling setup!"));
+    viennacl::backend::memory_write(*it, 0, sizeof(NumericT) * elim_elements[elimination_run].size(), &(elim_elements[elimination_run][0]));
+    ++it;
+  }
+}
+
+
 //
 // Multifrontal substitution (both L and U). Will partly be moved to single_threaded/opencl/cuda implementations
 //
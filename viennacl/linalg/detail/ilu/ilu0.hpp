@@ -167,6 +167,12 @@ public:
     viennacl::linalg::host_based::detail::csr_inplace_solve<NumericType>(row_buffer, col_buffer, elements, vec, LU_.size2(), upper_tag());
   }
 
+  /** @brief Recomputes the factorization for a matrix with the same sparsity pattern, e.g. an updated Jacobian in a Newton iteration. */
+  void refactor(MatrixT const & mat)
+  {
+    init(mat);
+  }
+
 private:
   void init(MatrixT const & mat)
   {
@@ -266,6 +272,31 @@ public:
 
   vcl_size_t levels() const { return multifrontal_L_row_index_arrays_.size(); }
 
+  /** @brief Recomputes the factorization for a matrix with the same sparsity pattern as the matrix passed to the constructor, e.g. an updated Jacobian in a Newton iteration.
+    *
+    * No memory is reallocated. With level scheduling, the elimination levels are reused and only the values in the elimination buffers are updated.
+    */
+  void refactor(MatrixType const & mat)
+  {
+    assert(mat.size1() == LU_.size1() && mat.size2() == LU_.size2() && bool("Error in ilu0_precond::refactor(): Matrix size changed!"));
+
+    LU_.set_values(mat);
+    viennacl::linalg::precondition(LU_, tag_);
+
+    if (!tag_.use_level_scheduling())
+      return;
+
+    viennacl::context host_context(viennacl::MAIN_MEMORY);
+    viennacl::context old_context = viennacl::traits::context(multifrontal_U_diagonal_);
+    viennacl::switch_memory_context(multifrontal_U_diagonal_, host_context);
+    host_based::detail::row_info(LU_, multifrontal_U_diagonal_, viennacl::linalg::detail::SPARSE_ROW_DIAGONAL);
+
+    detail::level_scheduling_update_values_impl(LU_, multifrontal_U_diagonal_, multifrontal_L_element_buffers_, false);
+    detail::level_scheduling_update_values_impl(LU_, multifrontal_U_diagonal_, multifrontal_U_element_buffers_, true);
+
+    viennacl::switch_memory_context(multifrontal_U_diagonal_, old_context);
+  }
+
 private:
   void init(MatrixType const & mat)
   {
@@ -0,0 +1,220 @@
+#ifndef VIENNACL_LINALG_DETAIL_S_STEP_HPP_
+#define VIENNACL_LINALG_DETAIL_S_STEP_HPP_
+
+/* =========================================================================
+   Copyright (c) 2010-2016, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+   Portions of this software are copyright by UChicago Argonne, LLC.
+
+                            -----------------
+                  ViennaCL - The Vienna Computing Library
+                            -----------------
+
+   Project Head:    Karl Rupp                   rupp@iue.tuwien.ac.at
+
+   (A list of authors and contributors can be found in the manual)
+
+   License:         MIT (X11), see file LICENSE in the base directory
+============================================================================= */
+
+/** @file viennacl/linalg/detail/s_step.hpp
+    @brief Polynomial bases and helper routines shared by the s-step (communication-avoiding) CG and GMRES solvers
+
+    The s-step solvers generate s Krylov vectors per block by the three-term recurrence
+      op(v_j) = gamma_j * v_{j+1} + alpha_j * v_j + beta_j * v_{j-1},
+    where op is the (preconditioned) system matrix, and orthogonalize the whole block using a single Gram matrix computed by one matrix-matrix product.
+    The monomial basis (alpha = beta = 0, gamma = 1) becomes ill-conditioned quickly, hence the Newton and Chebyshev bases are set up from Ritz value estimates.
+*/
+
+#include <vector>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+#include "viennacl/forwards.h"
+#include "viennacl/vector.hpp"
+#include "viennacl/matrix.hpp"
+#include "viennacl/matrix_proxy.hpp"
+#include "viennacl/linalg/prod.hpp"
+#include "viennacl/linalg/detail/small_dense.hpp"
+
+namespace viennacl
+{
+namespace linalg
+{
+namespace detail
+{
+
+  /** @brief The coefficients of the three-term recurrence op(v_j) = gamma_j * v_{j+1} + alpha_j * v_j + beta_j * v_{j-1} of a polynomial basis */
+  struct s_step_basis
+  {
+    std::vector<double> alpha;
+    std::vector<double> beta;
+    std::vector<double> gamma;
+  };
+
+  /** @brief Sets up the monomial basis of length s. Used until Ritz values are available. */
+  inline void s_step_monomial_basis(s_step_basis & basis, vcl_size_t s)
+  {
+    basis.alpha.assign(s, 0.0);
+    basis.beta.assign(s, 0.0);
+    basis.gamma.assign(s, 1.0);
+  }
+
+  /** @brief Returns the eigenvalues of the symmetric part of the small k x k matrix T (column-major) in ascending order.
+  *
+  * For the Lanczos matrix of CG these are the Ritz values. For the Hessenberg matrix of GMRES the real parts of the (possibly complex) Ritz values are replaced by the eigenvalues of the symmetric part, which span the real part of the field of values of the projected operator.
+  */
+  inline std::vector<double> s_step_ritz_values(std::vector<double> T, vcl_size_t k)
+  {
+    for (vcl_size_t j = 0; j < k; ++j)
+      for (vcl_size_t i = 0; i < j; ++i)
+      {
+        double sym = 0.5 * (T[i + j * k] + T[j + i * k]);
+        T[i + j * k] = sym;
+        T[j + i * k] = sym;
+      }
+
+    std::vector<double> V;
+    small_symmetric_eigen(T, V, k);
+
+    std::vector<double> ritz(k);
+    for (vcl_size_t i = 0; i < k; ++i)
+      ritz[i] = T[i + i * k];
+    std::sort(ritz.begin(), ritz.end());
+    return ritz;
+  }
+
+  /** @brief Sets up a Newton or Chebyshev basis of length s from the Ritz values 'ritz' (ascending order).
+  *
+  * The Newton basis uses the Ritz values in Leja ordering as shifts, scaled by the capacity of the spectral interval.
+  * The Chebyshev basis uses the scaled and shifted Chebyshev polynomials of the first kind for the spectral interval.
+  */
+  inline void s_step_setup_basis(s_step_basis & basis, std::vector<double> const & ritz, viennacl::linalg::s_step_basis_type type, vcl_size_t s)
+  {
+    if (ritz.size() == 0)
+    {
+      s_step_monomial_basis(basis, s);
+      return;
+    }
+
+    double lambda_min = ritz.front();
+    double lambda_max = ritz.back();
+    double width = lambda_max - lambda_min;
+    double scale = std::max(std::fabs(lambda_min), std::fabs(lambda_max));
+    if (scale <= 0)
+      scale = 1.0;
+
+    basis.alpha.resize(s);
+    basis.beta.resize(s);
+    basis.gamma.resize(s);
+
+    if (type == viennacl::linalg::S_STEP_CHEBYSHEV_BASIS)
+    {
+      // the Ritz values are interior to the spectrum, hence enlarge the interval slightly:
+      double center    = 0.5 * (lambda_max + lambda_min);
+      double halfwidth = std::max(0.55 * width, 1e-3 * scale);
+      for (vcl_size_t j = 0; j < s; ++j)
+      {
+        basis.alpha[j] = center;
+        basis.beta[j]  = (j > 0) ? 0.5 * halfwidth : 0.0;
+        basis.gamma[j] = (j > 0) ? 0.5 * halfwidth : halfwidth;
+      }
+      return;
+    }
+
+    // Newton basis: Leja ordering of the Ritz values
+    std::vector<double> shifts;
+    std::vector<bool> used(ritz.size(), false);
+    for (vcl_size_t j = 0; j < s; ++j)
+    {
+      if (shifts.size() == ritz.size()) // fewer Ritz values than basis vectors: reuse in Leja order
+      {
+        shifts.push_back(shifts[j % ritz.size()]);
+        continue;
+      }
+
+      vcl_size_t best = 0;
+      double best_value = -std::numeric_limits<double>::max();
+      for (vcl_size_t i = 0; i < ritz.size(); ++i)
+      {
+        if (used[i])
+          continue;
+
+        double value = 0; // logarithm of the product of distances to the shifts chosen so far
+        if (shifts.size() == 0)
+          value = std::fabs(ritz[i]);
+        else
+          for (vcl_size_t l = 0; l < shifts.size(); ++l)
+            value += std::log(std::fabs(ritz[i] - shifts[l]) + 1e-14 * scale);
+        if (value > best_value)
+        {
+          best_value = value;
+          best = i;
+        }
+      }
+      used[best] = true;
+      shifts.push_back(ritz[best]);
+    }
+
+    double capacity = std::max(0.25 * width, 1e-3 * scale);
+    for (vcl_size_t j = 0; j < s; ++j)
+    {
+      basis.alpha[j] = shifts[j];
+      basis.beta[j]  = 0;
+      basis.gamma[j] = capacity;
+    }
+  }
+
+  /** @brief Returns the (s+1) x s change-of-basis matrix T (column-major) with op(V_{0:s-1}) = V_{0:s} * T for the first s vectors of the basis */
+  inline std::vector<double> s_step_change_of_basis(s_step_basis const & basis, vcl_size_t s)
+  {
+    std::vector<double> T((s + 1) * s, 0.0);
+    for (vcl_size_t j = 0; j < s; ++j)
+    {
+      T[j + 1 + j * (s + 1)] = basis.gamma[j];
+      T[j     + j * (s + 1)] = basis.alpha[j];
+      if (j > 0)
+        T[j - 1 + j * (s + 1)] = basis.beta[j];
+    }
+    return T;
+  }
+
+  /** @brief Computes v_{j+1} = (y - alpha_j * v_j - beta_j * v_{j-1}) / gamma_j in place of y = op(v_j) */
+  template<typename NumericT>
+  void s_step_recurrence(s_step_basis const & basis, vcl_size_t j,
+                         viennacl::vector_base<NumericT> & y, viennacl::vector_base<NumericT> const & v_j, viennacl::vector_base<NumericT> const & v_j_minus_1)
+  {
+    if (basis.alpha[j] > 0 || basis.alpha[j] < 0)
+      y -= NumericT(basis.alpha[j]) * v_j;
+    if (j > 0 && (basis.beta[j] > 0 || basis.beta[j] < 0))
+      y -= NumericT(basis.beta[j]) * v_j_minus_1;
+    if (basis.gamma[j] < 1.0 || basis.gamma[j] > 1.0)
+      y /= NumericT(basis.gamma[j]);
+  }
+
+  /** @brief Applies the preconditioner to 'v', which may reference a column of a dense matrix */
+  template<typename NumericT, typename PreconditionerT>
+  void s_step_precondition(PreconditionerT const & precond, viennacl::vector_base<NumericT> & v, viennacl::vector<NumericT> & temp)
+  {
+    temp = v;
+    precond.apply(temp);
+    v = temp;
+  }
+
+  /** @brief Overload for the unpreconditioned case: nothing to do */
+  template<typename NumericT>
+  void s_step_precondition(viennacl::linalg::no_precond const &, viennacl::vector_base<NumericT> &, viennacl::vector<NumericT> &) {}
+
+  /** @brief Returns true if the preconditioner is not the identity, i.e. if preconditioned and unpreconditioned Krylov vectors need to be stored separately */
+  template<typename PreconditionerT>
+  bool s_step_is_preconditioned(PreconditionerT const &) { return true; }
+
+  inline bool s_step_is_preconditioned(viennacl::linalg::no_precond const &) { return false; }
+
+} //namespace detail
+} //namespace linalg
+} //namespace viennacl
+
+#endif
@@ -0,0 +1,193 @@
+#ifndef VIENNACL_LINALG_DETAIL_SMALL_DENSE_HPP_
+#define VIENNACL_LINALG_DETAIL_SMALL_DENSE_HPP_
+
+/* =========================================================================
+   Copyright (c) 2010-2016, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+   Portions of this software are copyright by UChicago Argonne, LLC.
+
+                            -----------------
+                  ViennaCL - The Vienna Computing Library
+                            -----------------
+
+   Project Head:    Karl Rupp                   rupp@iue.tuwien.ac.at
+
+   (A list of authors and contributors can be found in the manual)
+
+   License:         MIT (X11), see file LICENSE in the base directory
+============================================================================= */
+
+/** @file viennacl/linalg/detail/small_dense.hpp
+    @brief Host routines for the small dense matrices (Gram matrices, projected systems) arising in block and s-step Krylov methods
+*/
+
+#include <vector>
+#include <cmath>
+
+#include "viennacl/forwards.h"
+#include "viennacl/matrix.hpp"
+
+namespace viennacl
+{
+namespace linalg
+{
+namespace detail
+{
+  /** @brief Returns the offset and stride of column j of a dense matrix for setting up a vector_base referencing the column */
+  template<typename NumericT, typename F>
+  void dense_column_layout(viennacl::matrix<NumericT, F> const & M, vcl_size_t j, vcl_size_t & start, vcl_size_t & stride)
+  {
+    start  = F::mem_index(0, j, M.internal_size1(), M.internal_size2());
+    stride = F::mem_index(1, j, M.internal_size1(), M.internal_size2()) - start;
+  }
+
+  /** @brief Copies a small dense matrix to a column-major array on the host */
+  template<typename NumericT, typename F>
+  void small_dense_to_host(viennacl::matrix<NumericT, F> const & M, std::vector<double> & host_M)
+  {
+    std::vector<NumericT> temp(M.internal_size());
+    if (temp.size() > 0)
+      viennacl::backend::memory_read(M.handle(), 0, sizeof(NumericT) * temp.size(), &(temp[0]));
+
+    host_M.resize(M.size1() * M.size2());
+    for (vcl_size_t j = 0; j < M.size2(); ++j)
+      for (vcl_size_t i = 0; i < M.size1(); ++i)
+        host_M[i + j * M.size1()] = static_cast<double>(temp[F::mem_index(i, j, M.internal_size1(), M.internal_size2())]);
+  }
+
+  /** @brief Copies a column-major array with the dimensions of M from the host to M */
+  template<typename NumericT, typename F>
+  void small_dense_from_host(std::vector<double> const & host_M, viennacl::matrix<NumericT, F> & M)
+  {
+    std::vector<NumericT> temp(M.internal_size());
+    for (vcl_size_t j = 0; j < M.size2(); ++j)
+      for (vcl_size_t i = 0; i < M.size1(); ++i)
+        temp[F::mem_index(i, j, M.internal_size1(), M.internal_size2())] = static_cast<NumericT>(host_M[i + j * M.size1()]);
+
+    if (temp.size() > 0)
+      viennacl::backend::memory_write(M.handle(), 0, sizeof(NumericT) * temp.size(), &(temp[0]));
+  }
+
+  /** @brief Computes the eigenvalues and eigenvectors of a small symmetric matrix on the host using the cyclic Jacobi method.
+  *
+  * @param G    Symmetric k x k matrix (column-major). Holds the eigenvalues on the diagonal on return.
+  * @param V    Orthogonal k x k matrix (column-major) of eigenvectors on return
+  * @param k    Size of the matrix
+  */
+  inline void small_symmetric_eigen(std::vector<double> & G, std::vector<double> & V, vcl_size_t k)
+  {
+    V.assign(k * k, 0.0);
+    for (vcl_size_t i = 0; i < k; ++i)
+      V[i + i * k] = 1.0;
+
+    for (vcl_size_t sweep = 0; sweep < 50; ++sweep)
+    {
+      double off_diag = 0;
+      double diag     = 0;
+      for (vcl_size_t j = 0; j < k; ++j)
+      {
+        diag += G[j + j * k] * G[j + j * k];
+        for (vcl_size_t i = 0; i < j; ++i)
+          off_diag += G[i + j * k] * G[i + j * k];
+      }
+      if (off_diag <= 1e-30 * diag)
+        return;
+
+      for (vcl_size_t p = 0; p < k; ++p)
+        for (vcl_size_t q = p + 1; q < k; ++q)
+        {
+          double g_pq = G[p + q * k];
+          if (std::fabs(g_pq) <= 1e-300)
+            continue;
+
+          // rotation annihilating G(p,q):
+          double theta = (G[q + q * k] - G[p + p * k]) / (2.0 * g_pq);
+          double t = ((theta >= 0) ? 1.0 : -1.0) / (std::fabs(theta) + std::sqrt(theta * theta + 1.0));
+          double c = 1.0 / std::sqrt(t * t + 1.0);
+          double s = t * c;
+
+          for (vcl_size_t i = 0; i < k; ++i) // columns p, q
+          {
+            double g_ip = G[i + p * k];
+            double g_iq = G[i + q * k];
+            G[i + p * k] = c * g_ip - s * g_iq;
+            G[i + q * k] = s * g_ip + c * g_iq;
+          }
+          for (vcl_size_t i = 0; i < k; ++i) // rows p, q
+          {
+            double g_pi = G[p + i * k];
+            double g_qi = G[q + i * k];
+            G[p + i * k] = c * g_pi - s * g_qi;
+            G[q + i * k] = s * g_pi + c * g_qi;
+          }
+          for (vcl_size_t i = 0; i < k; ++i)
+          {
+            double v_ip = V[i + p * k];
+            double v_iq = V[i + q * k];
+            V[i + p * k] = c * v_ip - s * v_iq;
+            V[i + q * k] = s * v_ip + c * v_iq;
+          }
+        }
+    }
+  }
+
+  /** @brief Computes the Cholesky factorization G = L * L^T of a small symmetric matrix G (r x r, column-major) on the host. L is stored in the lower triangle of G.
+  *
+  * The factorization stops at the first column j for which the remaining pivot is not larger than rel_tol times the diagonal entry G(j,j) on input.
+  * Returns the number of columns successfully factored, which is r if G is positive definite (with respect to rel_tol).
+  */
+  inline vcl_size_t small_cholesky_factor(std::vector<double> & G, vcl_size_t r, double rel_tol = 0)
+  {
+    for (vcl_size_t j = 0; j < r; ++j)
+    {
+      double d = G[j + j * r];
+      for (vcl_size_t l = 0; l < j; ++l)
+        d -= G[j + l * r] * G[j + l * r];
+      if (d <= 0 || d <= rel_tol * G[j + j * r])
+        return j;
+      d = std::sqrt(d);
+      G[j + j * r] = d;
+
+      for (vcl_size_t i = j + 1; i < r; ++i)
+      {
+        double v = G[i + j * r];
+        for (vcl_size_t l = 0; l < j; ++l)
+          v -= G[i + l * r] * G[j + l * r];
+        G[i + j * r] = v / d;
+      }
+    }
+    return r;
+  }
+
+  /** @brief Solves G * X = B on the host for a small symmetric positive definite matrix G (r x r) and B (r x k) using a Cholesky factorization. B is overwritten with X. Returns false if G is not positive definite. */
+  inline bool small_cholesky_solve(std::vector<double> G, std::vector<double> & B, vcl_size_t r, vcl_size_t k)
+  {
+    if (small_cholesky_factor(G, r) < r)
+      return false;
+
+    for (vcl_size_t col = 0; col < k; ++col)
+    {
+      double * b = &(B[col * r]);
+      for (vcl_size_t i = 0; i < r; ++i) // forward substitution
+      {
+        for (vcl_size_t l = 0; l < i; ++l)
+          b[i] -= G[i + l * r] * b[l];
+        b[i] /= G[i + i * r];
+      }
+      for (vcl_size_t i2 = 0; i2 < r; ++i2) // backward substitution
+      {
+        vcl_size_t i = r - 1 - i2;
+        for (vcl_size_t l = i + 1; l < r; ++l)
+          b[i] -= G[l + i * r] * b[l];
+        b[i] /= G[i + i * r];
+      }
+    }
+    return true;
+  }
+
+} //namespace detail
+} //namespace linalg
+} //namespace viennacl
+
+#endif
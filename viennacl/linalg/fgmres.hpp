@@ -0,0 +1,343 @@
+#ifndef VIENNACL_LINALG_FGMRES_HPP_
+#define VIENNACL_LINALG_FGMRES_HPP_
+
+/* =========================================================================
+   Copyright (c) 2010-2016, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+   Portions of this software are copyright by UChicago Argonne, LLC.
+
+                            -----------------
+                  ViennaCL - The Vienna Computing Library
+                            -----------------
+
+   Project Head:    Karl Rupp                   rupp@iue.tuwien.ac.at
+
+   (A list of authors and contributors can be found in the manual)
+
+   License:         MIT (X11), see file LICENSE in the base directory
+============================================================================= */
+
+/** @file viennacl/linalg/fgmres.hpp
+    @brief Implementation of the flexible GMRES method (FGMRES), which allows for a different preconditioner in each iteration
+*/
+
+#include <vector>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+#include "viennacl/forwards.h"
+#include "viennacl/vector.hpp"
+#include "viennacl/backend/memory.hpp"
+#include "viennacl/linalg/prod.hpp"
+#include "viennacl/linalg/norm_2.hpp"
+#include "viennacl/linalg/iterative_operations.hpp"
+#include "viennacl/traits/context.hpp"
+
+namespace viennacl
+{
+namespace linalg
+{
+
+/** @brief A tag for the flexible GMRES method. Used for supplying solver parameters and for dispatching the solve() function
+*/
+class fgmres_tag
+{
+public:
+  /** @brief The constructor
+  *
+  * @param tol            Relative tolerance for the residual (solver quits if ||b - Ax|| < tol * ||b||)
+  * @param max_iterations The maximum number of iterations (including restarts)
+  * @param krylov_dim     The maximum dimension of the Krylov space before restart. Two basis vectors are stored per dimension.
+  */
+  fgmres_tag(double tol = 1e-10, unsigned int max_iterations = 300, unsigned int krylov_dim = 20)
+   : tol_(tol), abs_tol_(0), iterations_(max_iterations), krylov_dim_(krylov_dim), iters_taken_(0), last_error_(0) {}
+
+  /** @brief Returns the relative tolerance */
+  double tolerance() const { return tol_; }
+
+  /** @brief Returns the absolute tolerance */
+  double abs_tolerance() const { return abs_tol_; }
+  /** @brief Sets the absolute tolerance */
+  void abs_tolerance(double new_tol) { if (new_tol >= 0) abs_tol_ = new_tol; }
+
+  /** @brief Returns the maximum number of iterations */
+  unsigned int max_iterations() const { return iterations_; }
+  /** @brief Returns the maximum dimension of the Krylov space before restart */
+  unsigned int krylov_dim() const { return krylov_dim_; }
+
+  /** @brief Return the number of solver iterations: */
+  unsigned int iters() const { return iters_taken_; }
+  /** @brief Set the number of solver iterations (should only be modified by the solver) */
+  void iters(unsigned int i) const { iters_taken_ = i; }
+
+  /** @brief Returns the relative residual at the end of the solver run. Unlike GMRES, this is the residual of the unpreconditioned system. */
+  double error() const { return last_error_; }
+  /** @brief Sets the relative residual at the end of the solver run */
+  void error(double e) const { last_error_ = e; }
+
+private:
+  double tol_;
+  double abs_tol_;
+  unsigned int iterations_;
+  unsigned int krylov_dim_;
+
+  //return values from solver
+  mutable unsigned int iters_taken_;
+  mutable double last_error_;
+};
+
+
+/** @brief A preconditioner which approximately solves the system with an inner iterative solver, e.g. a few CG iterations with a loose tolerance, which are in turn preconditioned by 'precond' (e.g. AMG).
+*
+* The resulting preconditioner changes from one application to the next, hence it must only be used with flexible methods such as FGMRES.
+* The inner solver is selected by the type of the tag, i.e. the header of the inner solver needs to be included.
+* The system matrix and the inner preconditioner are referenced, not copied.
+*/
+template<typename MatrixT, typename SolverTagT, typename PreconditionerT = viennacl::linalg::no_precond>
+class inner_solver_precond
+{
+public:
+  inner_solver_precond(MatrixT const & A, SolverTagT const & tag, PreconditionerT const & precond) : A_(A), tag_(tag), precond_(precond), total_iters_(0) {}
+
+  template<typename VectorT>
+  void apply(VectorT & vec) const
+  {
+    vec = solve(A_, vec, tag_, precond_);
+    total_iters_ += tag_.iters();
+  }
+
+  /** @brief Returns the solver tag of the inner solver, providing the statistics of the last application */
+  SolverTagT const & tag() const { return tag_; }
+
+  /** @brief Returns the total number of inner iterations over all applications */
+  vcl_size_t total_iters() const { return total_iters_; }
+
+private:
+  MatrixT const & A_;
+  SolverTagT tag_;
+  PreconditionerT const & precond_;
+  mutable vcl_size_t total_iters_;
+};
+
+/** @brief Specialization of the inner solver preconditioner for an unpreconditioned inner solver */
+template<typename MatrixT, typename SolverTagT>
+class inner_solver_precond<MatrixT, SolverTagT, viennacl::linalg::no_precond>
+{
+public:
+  inner_solver_precond(MatrixT const & A, SolverTagT const & tag) : A_(A), tag_(tag), total_iters_(0) {}
+
+  template<typename VectorT>
+  void apply(VectorT & vec) const
+  {
+    vec = solve(A_, vec, tag_);
+    total_iters_ += tag_.iters();
+  }
+
+  /** @brief Returns the solver tag of the inner solver, providing the statistics of the last application */
+  SolverTagT const & tag() const { return tag_; }
+
+  /** @brief Returns the total number of inner iterations over all applications */
+  vcl_size_t total_iters() const { return total_iters_; }
+
+private:
+  MatrixT const & A_;
+  SolverTagT tag_;
+  mutable vcl_size_t total_iters_;
+};
+
+
+namespace detail
+{
+  /** @brief Applies a preconditioner with member function apply() to 'vec' */
+  template<typename VectorT, typename PreconditionerT>
+  void fgmres_apply_precond(PreconditionerT const & precond, VectorT & vec)
+  {
+    precond.apply(vec);
+  }
+
+  /** @brief Applies a preconditioner given by a plain function to 'vec' */
+  template<typename VectorT>
+  void fgmres_apply_precond(void (*precond)(VectorT &), VectorT & vec)
+  {
+    precond(vec);
+  }
+}
+
+
+/** @brief Implementation of the restarted flexible GMRES method with right preconditioning (Saad, SIAM J. Sci. Comput. 14(2), 1993).
+*
+* Since the preconditioner may change in every iteration, the preconditioned basis vectors z_k are stored in addition to the orthonormal basis vectors v_k, and the solution is updated from the z_k.
+* The orthogonalization uses the kernels of pipelined GMRES, i.e. classical Gram-Schmidt against all previous basis vectors in a single fused pass.
+*
+* @param A        The system matrix
+* @param rhs      The load vector
+* @param tag      Solver configuration tag
+* @param precond  A (possibly variable) preconditioner: Either an object providing a member function apply(), or a function void(viennacl::vector<NumericT> &)
+* @return The result vector
+*/
+template<typename MatrixT, typename NumericT, typename PreconditionerT>
+viennacl::vector<NumericT> solve(MatrixT const & A, viennacl::vector<NumericT> const & rhs, fgmres_tag const & tag, PreconditionerT const & precond)
+{
+  viennacl::context ctx = viennacl::traits::context(rhs);
+  vcl_size_t n = rhs.size();
+  vcl_size_t internal_size = rhs.internal_size();
+
+  viennacl::vector<NumericT> result = viennacl::zero_vector<NumericT>(n, ctx);
+  viennacl::vector<NumericT> residual(n, ctx);
+  viennacl::vector<NumericT> temp(n, ctx);
+
+  tag.iters(0);
+  tag.error(0);
+
+  double norm_rhs = viennacl::linalg::norm_2(rhs);
+  if (norm_rhs <= tag.abs_tolerance()) //solution is zero if RHS norm is zero
+    return result;
+
+  vcl_size_t krylov_dim = std::min<vcl_size_t>(tag.krylov_dim(), n);
+  vcl_size_t ld = krylov_dim + 1;  // leading dimension of the Hessenberg matrix
+
+  // column k of R holds <v_i, A z_{k-1}> in rows 0..k-1 and ||v_k|| (before normalization) in row k, i.e. column k-1 of the Hessenberg matrix:
+  vcl_size_t buffer_size_per_vector = 128;
+  viennacl::vector<NumericT> device_krylov_basis = viennacl::zero_vector<NumericT>(internal_size * ld, ctx); // not using viennacl::matrix here because of spurious padding in column number
+  viennacl::vector<NumericT> device_precond_basis = viennacl::zero_vector<NumericT>(internal_size * krylov_dim, ctx);
+  viennacl::vector<NumericT> device_buffer_R = viennacl::zero_vector<NumericT>(ld * ld, ctx);
+  viennacl::vector<NumericT> device_inner_prod_buffer = viennacl::zero_vector<NumericT>(3 * buffer_size_per_vector, ctx);
+  viennacl::vector<NumericT> device_vi_in_vk_buffer   = viennacl::zero_vector<NumericT>(buffer_size_per_vector * ld, ctx);
+  viennacl::vector<NumericT> device_r_dot_vk_buffer   = viennacl::zero_vector<NumericT>(buffer_size_per_vector * ld, ctx);
+
+  std::vector<NumericT> host_R_column(ld);
+  std::vector<double> H(ld * krylov_dim); // Hessenberg matrix after Givens rotations
+  std::vector<double> givens_c(krylov_dim), givens_s(krylov_dim);
+  std::vector<double> g(ld);
+
+  double rel_residual = 1;
+  while (tag.iters() < tag.max_iterations())
+  {
+    //
+    // (Re-)Initialize residual: r = b - A*x (without temporary for the result of A*x)
+    //
+    residual = viennacl::linalg::prod(A, result);
+    residual = rhs - residual;
+
+    double rho_0 = viennacl::linalg::norm_2(residual);
+    rel_residual = rho_0 / norm_rhs;
+    if (rel_residual < tag.tolerance() || rho_0 < tag.abs_tolerance())
+      break;
+
+    std::fill(g.begin(), g.end(), 0.0);
+    g[0] = rho_0;
+
+    vcl_size_t k = 0;   // number of columns of the Hessenberg matrix
+    for (vcl_size_t j = 0; j <= krylov_dim; ++j)
+    {
+      viennacl::vector_range<viennacl::vector<NumericT> > v_j(device_krylov_basis, viennacl::range(j * internal_size, j * internal_size + n));
+      if (j == 0)
+        v_j = residual;
+      else
+      {
+        // z_{j-1} = M_{j-1}^{-1} v_{j-1}, v_j = A z_{j-1}
+        viennacl::vector_range<viennacl::vector<NumericT> > v_j_minus_1(device_krylov_basis, viennacl::range((j-1) * internal_size, (j-1) * internal_size + n));
+        viennacl::vector_range<viennacl::vector<NumericT> > z_j_minus_1(device_precond_basis, viennacl::range((j-1) * internal_size, (j-1) * internal_size + n));
+        temp = v_j_minus_1;
+        detail::fgmres_apply_precond(precond, temp);
+        z_j_minus_1 = temp;
+        v_j = viennacl::linalg::prod(A, temp);
+      }
+
+      //
+      // Gram-Schmidt: v_j -= sum_i <v_i, v_j> v_i, storing <v_i, v_j> and ||v_j|| in column j of R. Then normalize v_j.
+      //
+      if (j > 0)
+        viennacl::linalg::pipelined_gmres_gram_schmidt_stage1(device_krylov_basis, n, internal_size, j, device_vi_in_vk_buffer, buffer_size_per_vector);
+      viennacl::linalg::pipelined_gmres_gram_schmidt_stage2(device_krylov_basis, n, internal_size, j,
+                                                            device_vi_in_vk_buffer,
+                                                            device_buffer_R, ld,
+                                                            device_inner_prod_buffer, buffer_size_per_vector);
+      viennacl::linalg::pipelined_gmres_normalize_vk(v_j, residual,
+                                                     device_buffer_R, j * ld + j,
+                                                     device_inner_prod_buffer, device_r_dot_vk_buffer,
+                                                     buffer_size_per_vector, j * buffer_size_per_vector);
+      if (j == 0)
+        continue;
+
+      //
+      // Apply previous Givens rotations to the new column of the Hessenberg matrix and compute the new rotation:
+      //
+      vcl_size_t col = j - 1;
+      viennacl::backend::memory_read(device_buffer_R.handle(), sizeof(NumericT) * (j * ld), sizeof(NumericT) * (j + 1), &(host_R_column[0]));
+      for (vcl_size_t i = 0; i <= j; ++i)
+        H[i + col * ld] = host_R_column[i];
+
+      for (vcl_size_t i = 0; i < col; ++i)
+      {
+        double h_i  = H[i     + col * ld];
+        double h_i1 = H[i + 1 + col * ld];
+        H[i     + col * ld] =  givens_c[i] * h_i + givens_s[i] * h_i1;
+        H[i + 1 + col * ld] = -givens_s[i] * h_i + givens_c[i] * h_i1;
+      }
+      double h_diag = H[col + col * ld];
+      double h_sub  = H[j   + col * ld];
+      double norm_h = std::sqrt(h_diag * h_diag + h_sub * h_sub);
+      givens_c[col] = (norm_h > 0) ? h_diag / norm_h : 1.0;
+      givens_s[col] = (norm_h > 0) ? h_sub  / norm_h : 0.0;
+      H[col + col * ld] = norm_h;
+      H[j   + col * ld] = 0;
+      g[j]   = -givens_s[col] * g[col];
+      g[col] =  givens_c[col] * g[col];
+
+      k = j;
+      tag.iters(tag.iters() + 1);
+
+      // converged, happy breakdown (v_j is not a valid basis vector then), or iteration limit reached:
+      if (std::fabs(g[j]) < tag.tolerance() * norm_rhs || std::fabs(g[j]) < tag.abs_tolerance() || !(h_sub > 0) || tag.iters() >= tag.max_iterations())
+        break;
+    }
+
+    if (k == 0)
+      break;
+
+    //
+    // Solve the least squares problem and update the result: x += Z y
+    //
+    std::vector<double> y(k);
+    for (vcl_size_t i2 = 0; i2 < k; ++i2)
+    {
+      vcl_size_t i = k - 1 - i2;
+      double value = g[i];
+      for (vcl_size_t j = i + 1; j < k; ++j)
+        value -= H[i + j * ld] * y[j];
+      y[i] = (H[i + i * ld] > 0 || H[i + i * ld] < 0) ? value / H[i + i * ld] : 0.0;
+    }
+
+    for (vcl_size_t j = 0; j < k; ++j)
+    {
+      viennacl::vector_range<viennacl::vector<NumericT> > z_j(device_precond_basis, viennacl::range(j * internal_size, j * internal_size + n));
+      result += NumericT(y[j]) * z_j;
+    }
+
+    rel_residual = std::fabs(g[k]) / norm_rhs;
+  }
+
+  //
+  // Report the true residual, since the estimate may be inaccurate for strongly varying preconditioners:
+  //
+  residual = viennacl::linalg::prod(A, result);
+  residual = rhs - residual;
+  tag.error(viennacl::linalg::norm_2(residual) / norm_rhs);
+
+  return result;
+}
+
+/** @brief Convenience overload of the flexible GMRES method without preconditioner (mathematically equivalent to GMRES) */
+template<typename MatrixT, typename NumericT>
+viennacl::vector<NumericT> solve(MatrixT const & A, viennacl::vector<NumericT> const & rhs, fgmres_tag const & tag)
+{
+  return viennacl::linalg::solve(A, rhs, tag, viennacl::linalg::no_precond());
+}
+
+}
+}
+
+#endif
@@ -0,0 +1,638 @@
+#ifndef VIENNACL_LINALG_GCRODR_HPP_
+#define VIENNACL_LINALG_GCRODR_HPP_
+
+/* =========================================================================
+   Copyright (c) 2010-2016, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+   Portions of this software are copyright by UChicago Argonne, LLC.
+
+                            -----------------
+                  ViennaCL - The Vienna Computing Library
+                            -----------------
+
+   Project Head:    Karl Rupp                   rupp@iue.tuwien.ac.at
+
+   (A list of authors and contributors can be found in the manual)
+
+   License:         MIT (X11), see file LICENSE in the base directory
+============================================================================= */
+
+/** @file viennacl/linalg/gcrodr.hpp
+    @brief Implementation of GCRO-DR, a restarted GMRES variant which recycles a deflation subspace across restarts and across sequences of linear systems
+*/
+
+#include <vector>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+#include "viennacl/forwards.h"
+#include "viennacl/vector.hpp"
+#include "viennacl/matrix.hpp"
+#include "viennacl/matrix_proxy.hpp"
+#include "viennacl/linalg/prod.hpp"
+#include "viennacl/linalg/norm_2.hpp"
+#include "viennacl/linalg/detail/small_dense.hpp"
+#include "viennacl/traits/context.hpp"
+
+namespace viennacl
+{
+namespace linalg
+{
+
+/** @brief A tag for the GCRO-DR method. Used for supplying solver parameters and for dispatching the solve() function
+*/
+class gcrodr_tag
+{
+public:
+  /** @brief The constructor
+  *
+  * @param tol            Relative tolerance for the (preconditioned) residual (solver quits if ||M^{-1} r|| < tol * ||M^{-1} b||)
+  * @param max_iterations The maximum number of iterations (including restarts)
+  * @param krylov_dim     The dimension of the search space per cycle, including the recycled subspace
+  * @param recycle_dim    The dimension of the recycled deflation subspace. Must be smaller than krylov_dim.
+  */
+  gcrodr_tag(double tol = 1e-10, unsigned int max_iterations = 300, unsigned int krylov_dim = 30, unsigned int recycle_dim = 10)
+   : tol_(tol), abs_tol_(0), iterations_(max_iterations), krylov_dim_(krylov_dim), recycle_dim_(recycle_dim), iters_taken_(0), last_error_(0) {}
+
+  /** @brief Returns the relative tolerance */
+  double tolerance() const { return tol_; }
+
+  /** @brief Returns the absolute tolerance */
+  double abs_tolerance() const { return abs_tol_; }
+  /** @brief Sets the absolute tolerance */
+  void abs_tolerance(double new_tol) { if (new_tol >= 0) abs_tol_ = new_tol; }
+
+  /** @brief Returns the maximum number of iterations */
+  unsigned int max_iterations() const { return iterations_; }
+  /** @brief Returns the dimension of the search space per cycle */
+  unsigned int krylov_dim() const { return krylov_dim_; }
+  /** @brief Returns the dimension of the recycled subspace */
+  unsigned int recycle_dim() const { return recycle_dim_; }
+
+  /** @brief Return the number of solver iterations: */
+  unsigned int iters() const { return iters_taken_; }
+  /** @brief Set the number of solver iterations (should only be modified by the solver) */
+  void iters(unsigned int i) const { iters_taken_ = i; }
+
+  /** @brief Returns the estimated relative error at the end of the solver run */
+  double error() const { return last_error_; }
+  /** @brief Sets the estimated relative error at the end of the solver run */
+  void error(double e) const { last_error_ = e; }
+
+private:
+  double tol_;
+  double abs_tol_;
+  unsigned int iterations_;
+  unsigned int krylov_dim_;
+  unsigned int recycle_dim_;
+
+  //return values from solver
+  mutable unsigned int iters_taken_;
+  mutable double last_error_;
+};
+
+namespace detail
+{
+  /** @brief Returns the columns first, ..., last-1 of a column-major matrix */
+  template<typename NumericT>
+  viennacl::matrix_range<viennacl::matrix<NumericT, viennacl::column_major> > gcrodr_columns(viennacl::matrix<NumericT, viennacl::column_major> & M, vcl_size_t first, vcl_size_t last)
+  {
+    return viennacl::matrix_range<viennacl::matrix<NumericT, viennacl::column_major> >(M, viennacl::range(0, M.size1()), viennacl::range(first, last));
+  }
+
+  /** @brief Computes the inverse of the upper triangular factor R = L^T of a Cholesky factorization, where L is stored in the lower triangle of the r x r matrix 'L' (column-major). Only the leading k x k block is used. */
+  inline std::vector<double> gcrodr_cholesky_r_inverse(std::vector<double> const & L, vcl_size_t r, vcl_size_t k)
+  {
+    std::vector<double> R_inv(k * k, 0.0);
+    for (vcl_size_t j = 0; j < k; ++j)
+    {
+      R_inv[j + j * k] = 1.0 / L[j + j * r];
+      for (vcl_size_t i2 = 0; i2 < j; ++i2)
+      {
+        vcl_size_t i = j - 1 - i2;
+        double value = 0;
+        for (vcl_size_t l = i + 1; l <= j; ++l)
+          value -= L[l + i * r] * R_inv[l + j * k];
+        R_inv[i + j * k] = value / L[i + i * r];
+      }
+    }
+    return R_inv;
+  }
+
+  /** @brief Computes M(:, 0:cols) = M(:, 0:rows) * T for a small matrix T (rows x cols, column-major, on the host), using 'temp' as intermediate storage */
+  template<typename NumericT>
+  void gcrodr_transform_columns(viennacl::matrix<NumericT, viennacl::column_major> & M, std::vector<double> const & T, vcl_size_t rows, vcl_size_t cols,
+                                viennacl::matrix<NumericT, viennacl::column_major> & temp)
+  {
+    typedef viennacl::matrix<NumericT, viennacl::column_major>   DenseMatrixType;
+
+    DenseMatrixType vcl_T(rows, cols, viennacl::traits::context(M));
+    small_dense_from_host(T, vcl_T);
+    temp.resize(M.size1(), cols, false);
+    temp = viennacl::linalg::prod(gcrodr_columns(M, 0, rows), vcl_T);
+    gcrodr_columns(M, 0, cols) = temp;
+  }
+
+  /** @brief Computes C = M^{-1} A U for a new system matrix and orthonormalizes C by a Cholesky QR factorization C = Q R, setting C = Q and U = U R^{-1}.
+  *
+  * C is stored in the first columns of W. Returns the number of recycled vectors kept, which is smaller than k if A U is numerically rank deficient.
+  */
+  template<typename MatrixT, typename NumericT, typename PreconditionerT>
+  vcl_size_t gcrodr_setup_recycle_space(MatrixT const & A, PreconditionerT const & precond,
+                                        viennacl::matrix<NumericT, viennacl::column_major> & U, vcl_size_t k,
+                                        viennacl::matrix<NumericT, viennacl::column_major> & W,
+                                        viennacl::vector<NumericT> & temp)
+  {
+    typedef viennacl::matrix<NumericT, viennacl::column_major>   DenseMatrixType;
+
+    for (vcl_size_t i = 0; i < k; ++i)
+    {
+      viennacl::vector_base<NumericT> U_i(U.handle(), U.size1(), i * U.internal_size1(), 1);
+      viennacl::vector_base<NumericT> C_i(W.handle(), W.size1(), i * W.internal_size1(), 1);
+      temp = viennacl::linalg::prod(A, U_i);
+      precond.apply(temp);
+      C_i = temp;
+    }
+
+    DenseMatrixType gram(k, k, viennacl::traits::context(W));
+    gram = viennacl::linalg::prod(trans(gcrodr_columns(W, 0, k)), gcrodr_columns(W, 0, k));
+    std::vector<double> L;
+    small_dense_to_host(gram, L);
+    vcl_size_t kept = small_cholesky_factor(L, k, 1e2 * std::numeric_limits<NumericT>::epsilon());
+    if (kept == 0)
+      return 0;
+
+    std::vector<double> R_inv = gcrodr_cholesky_r_inverse(L, k, kept);
+    DenseMatrixType block_temp;
+    gcrodr_transform_columns(W, R_inv, kept, kept, block_temp);
+    gcrodr_transform_columns(U, R_inv, kept, kept, block_temp);
+    return kept;
+  }
+
+  /** @brief Computes the new recycle space from the search space of the last cycle.
+  *
+  * The search space is V_hat = [U, V] with M^{-1} A V_hat = W G, where W = [C, V, v_{m+1}] has orthonormal columns.
+  * Parks et al. use harmonic Ritz vectors, which requires a nonsymmetric generalized eigenproblem. Here, the vectors z minimizing ||G z|| / ||V_hat z||,
+  * i.e. the generalized right singular vectors for the smallest singular values of the operator restricted to the search space, are used instead.
+  * These only need a symmetric eigensolver and coincide with the harmonic Ritz vectors for the smallest eigenvalues in magnitude if the operator is symmetric.
+  *
+  * On return, U holds the new recycle space Y R^{-1} and the first columns of W hold C = W G P R^{-1}, where W G P = Q R.
+  * Returns the dimension of the new recycle space, or k if no update is possible.
+  */
+  template<typename NumericT>
+  vcl_size_t gcrodr_update_recycle_space(viennacl::matrix<NumericT, viennacl::column_major> & U, vcl_size_t k,
+                                         viennacl::matrix<NumericT, viennacl::column_major> & W, vcl_size_t m,
+                                         std::vector<double> const & G, vcl_size_t ld, vcl_size_t recycle_dim)
+  {
+    typedef viennacl::matrix<NumericT, viennacl::column_major>   DenseMatrixType;
+
+    viennacl::context ctx = viennacl::traits::context(W);
+    vcl_size_t n = W.size1();
+    vcl_size_t k_new = std::min(recycle_dim, m);
+    if (k_new == 0)
+      return k;
+
+    //
+    // S = V_hat^T V_hat, where V is orthonormal and orthogonal to C:
+    //
+    std::vector<double> S(m * m, 0.0);
+    for (vcl_size_t i = 0; i < m; ++i)
+      S[i + i * m] = 1.0;
+    if (k > 0)
+    {
+      DenseMatrixType UtU(k, k, ctx);
+      UtU = viennacl::linalg::prod(trans(gcrodr_columns(U, 0, k)), gcrodr_columns(U, 0, k));
+      DenseMatrixType UtV(k, m - k, ctx);
+      UtV = viennacl::linalg::prod(trans(gcrodr_columns(U, 0, k)), gcrodr_columns(W, k, m));
+      std::vector<double> host_UtU, host_UtV;
+      small_dense_to_host(UtU, host_UtU);
+      small_dense_to_host(UtV, host_UtV);
+      for (vcl_size_t j = 0; j < k; ++j)
+        for (vcl_size_t i = 0; i < k; ++i)
+          S[i + j * m] = host_UtU[i + j * k];
+      for (vcl_size_t j = 0; j < m - k; ++j)
+        for (vcl_size_t i = 0; i < k; ++i)
+        {
+          S[i + (k + j) * m] = host_UtV[i + j * k];
+          S[(k + j) + i * m] = host_UtV[i + j * k];
+        }
+    }
+    if (small_cholesky_factor(S, m, 1e2 * std::numeric_limits<NumericT>::epsilon()) < m)
+      return k;
+
+    //
+    // Symmetric eigenproblem L^{-1} G^T G L^{-T} w = sigma^2 w:
+    //
+    std::vector<double> T(m * m, 0.0);
+    for (vcl_size_t j = 0; j < m; ++j)
+      for (vcl_size_t i = 0; i <= j; ++i)
+      {
+        double value = 0;
+        for (vcl_size_t l = 0; l <= m; ++l)
+          value += G[l + i * ld] * G[l + j * ld];
+        T[i + j * m] = value;
+        T[j + i * m] = value;
+      }
+    for (vcl_size_t pass = 0; pass < 2; ++pass) // T = L^{-1} T, then transposed, twice yields L^{-1} T L^{-T}
+    {
+      for (vcl_size_t j = 0; j < m; ++j)
+        for (vcl_size_t i = 0; i < m; ++i)
+        {
+          for (vcl_size_t l = 0; l < i; ++l)
+            T[i + j * m] -= S[i + l * m] * T[l + j * m];
+          T[i + j * m] /= S[i + i * m];
+        }
+      for (vcl_size_t j = 0; j < m; ++j)
+        for (vcl_size_t i = 0; i < j; ++i)
+          std::swap(T[i + j * m], T[j + i * m]);
+    }
+    std::vector<double> Z;
+    small_symmetric_eigen(T, Z, m);
+
+    std::vector<std::pair<double, vcl_size_t> > eigenvalues(m);
+    for (vcl_size_t i = 0; i < m; ++i)
+      eigenvalues[i] = std::make_pair(T[i + i * m], i);
+    std::sort(eigenvalues.begin(), eigenvalues.end());
+
+    // P = L^{-T} Z_k:
+    std::vector<double> P(m * k_new);
+    for (vcl_size_t j = 0; j < k_new; ++j)
+    {
+      double * p = &(P[j * m]);
+      for (vcl_size_t i = 0; i < m; ++i)
+        p[i] = Z[i + eigenvalues[j].second * m];
+      for (vcl_size_t i2 = 0; i2 < m; ++i2)
+      {
+        vcl_size_t i = m - 1 - i2;
+        for (vcl_size_t l = i + 1; l < m; ++l)
+          p[i] -= S[l + i * m] * p[l];
+        p[i] /= S[i + i * m];
+      }
+    }
+
+    //
+    // G P = Q R by modified Gram-Schmidt:
+    //
+    std::vector<double> Q((m + 1) * k_new, 0.0);
+    std::vector<double> R(k_new * k_new, 0.0);
+    for (vcl_size_t j = 0; j < k_new; ++j)
+    {
+      double * q = &(Q[j * (m + 1)]);
+      for (vcl_size_t l = 0; l < m; ++l)
+        for (vcl_size_t i = 0; i <= m; ++i)
+          q[i] += G[i + l * ld] * P[l + j * m];
+      for (vcl_size_t l = 0; l < j; ++l)
+      {
+        double dot = 0;
+        for (vcl_size_t i = 0; i <= m; ++i)
+          dot += Q[i + l * (m + 1)] * q[i];
+        for (vcl_size_t i = 0; i <= m; ++i)
+          q[i] -= dot * Q[i + l * (m + 1)];
+        R[l + j * k_new] = dot;
+      }
+      double norm = 0;
+      for (vcl_size_t i = 0; i <= m; ++i)
+        norm += q[i] * q[i];
+      norm = std::sqrt(norm);
+      if (!(norm > 0))
+        return k;
+      for (vcl_size_t i = 0; i <= m; ++i)
+        q[i] /= norm;
+      R[j + j * k_new] = norm;
+    }
+
+    // P = P R^{-1} (in place, column by column):
+    for (vcl_size_t j = 0; j < k_new; ++j)
+      for (vcl_size_t i = 0; i < m; ++i)
+      {
+        double value = P[i + j * m];
+        for (vcl_size_t l = 0; l < j; ++l)
+          value -= P[i + l * m] * R[l + j * k_new];
+        P[i + j * m] = value / R[j + j * k_new];
+      }
+
+    //
+    // U = V_hat P R^{-1} = U P(0:k, :) + V P(k:m, :), and C = W Q:
+    //
+    DenseMatrixType U_new(n, k_new, ctx);
+    if (k > 0)
+    {
+      std::vector<double> P_U(k * k_new);
+      for (vcl_size_t j = 0; j < k_new; ++j)
+        for (vcl_size_t i = 0; i < k; ++i)
+          P_U[i + j * k] = P[i + j * m];
+      DenseMatrixType vcl_P_U(k, k_new, ctx);
+      small_dense_from_host(P_U, vcl_P_U);
+      U_new = viennacl::linalg::prod(gcrodr_columns(U, 0, k), vcl_P_U);
+    }
+    else
+      U_new.clear();
+
+    std::vector<double> P_V((m - k) * k_new);
+    for (vcl_size_t j = 0; j < k_new; ++j)
+      for (vcl_size_t i = 0; i < m - k; ++i)
+        P_V[i + j * (m - k)] = P[k + i + j * m];
+    DenseMatrixType vcl_P_V(m - k, k_new, ctx);
+    small_dense_from_host(P_V, vcl_P_V);
+    U_new += viennacl::linalg::prod(gcrodr_columns(W, k, m), vcl_P_V);
+
+    DenseMatrixType block_temp;
+    gcrodr_transform_columns(W, Q, m + 1, k_new, block_temp);
+
+    U.resize(n, k_new, false);
+    U = U_new;
+    return k_new;
+  }
+
+
+  /** @brief Implementation of the GCRO-DR method (Parks, de Sturler, Mackey, Johnson, Maiti, SIAM J. Sci. Comput. 28(5), 2006) with left preconditioning.
+  *
+  * Each cycle minimizes the residual over the recycled subspace U and a Krylov space of the operator projected orthogonally to C = M^{-1} A U.
+  * At the end of each cycle, the recycled subspace is updated from the search space of the cycle. If U holds 'recycle_size' > 0 columns on entry,
+  * e.g. from the solution of a previous system in a sequence, the subspace is reused for the current system.
+  * On return, U and recycle_size hold the subspace for the next system, hence memory is bounded by recycle_dim vectors plus the Krylov basis.
+  */
+  template<typename MatrixT, typename NumericT, typename PreconditionerT>
+  viennacl::vector<NumericT> gcrodr_solve(MatrixT const & A,
+                                          viennacl::vector<NumericT> const & rhs,
+                                          gcrodr_tag const & tag,
+                                          PreconditionerT const & precond,
+                                          viennacl::matrix<NumericT, viennacl::column_major> & U,
+                                          vcl_size_t & recycle_size,
+                                          bool (*monitor)(viennacl::vector<NumericT> const &, NumericT, void*) = NULL,
+                                          void *monitor_data = NULL)
+  {
+    typedef viennacl::matrix<NumericT, viennacl::column_major>   DenseMatrixType;
+
+    viennacl::context ctx = viennacl::traits::context(rhs);
+    vcl_size_t n = rhs.size();
+
+    viennacl::vector<NumericT> result = viennacl::zero_vector<NumericT>(n, ctx);
+    viennacl::vector<NumericT> residual(rhs);
+    viennacl::vector<NumericT> temp(n, ctx);
+
+    tag.iters(0);
+    tag.error(0);
+
+    precond.apply(residual);
+    double norm_rhs = viennacl::linalg::norm_2(residual);
+    if (norm_rhs <= tag.abs_tolerance()) //solution is zero if RHS norm is zero
+      return result;
+
+    vcl_size_t m = std::min<vcl_size_t>(tag.krylov_dim(), n);
+    vcl_size_t max_recycle_dim = std::min<vcl_size_t>(tag.recycle_dim(), m - 1);
+    vcl_size_t ld = m + 1;  // leading dimension of G
+
+    DenseMatrixType W(n, m + 1, ctx);   // [C, V]
+
+    // Reuse the recycled subspace from a previous system: C = M^{-1} A U, orthonormalized
+    vcl_size_t k = (U.size1() == n) ? std::min(recycle_size, max_recycle_dim) : 0;
+    if (k > 0)
+      k = gcrodr_setup_recycle_space(A, precond, U, k, W, temp);
+
+    std::vector<double> G(ld * m), HR(ld * m);
+    std::vector<double> givens_c(m), givens_s(m);
+    std::vector<double> g(ld);
+    std::vector<NumericT> host_h(ld);
+
+    double rel_residual = 1;
+    while (true)
+    {
+      //
+      // Residual r = M^{-1} (b - A x), minimized over the recycled subspace: x += U C^T r, r -= C C^T r.
+      // The residual is recomputed in every cycle in order to avoid a drift of the recursively updated residual in single precision.
+      //
+      residual = viennacl::linalg::prod(A, result);
+      residual = rhs - residual;
+      precond.apply(residual);
+      if (k > 0)
+      {
+        viennacl::vector<NumericT> coeffs = viennacl::linalg::prod(trans(gcrodr_columns(W, 0, k)), residual);
+        result   += viennacl::linalg::prod(gcrodr_columns(U, 0, k), coeffs);
+        residual -= viennacl::linalg::prod(gcrodr_columns(W, 0, k), coeffs);
+      }
+
+      double beta = viennacl::linalg::norm_2(residual);
+      rel_residual = beta / norm_rhs;
+      if (rel_residual < tag.tolerance() || beta < tag.abs_tolerance() || tag.iters() >= tag.max_iterations())
+        break;
+
+      //
+      // Arnoldi process for (I - C C^T) M^{-1} A, starting with v_0 = r / ||r||:
+      // M^{-1} A [U, V] = [C, V, v_{m+1}] G with G = [I, C^T M^{-1} A V; 0, H]
+      //
+      std::fill(G.begin(), G.end(), 0.0);
+      std::fill(HR.begin(), HR.end(), 0.0);
+      std::fill(g.begin(), g.end(), 0.0);
+      for (vcl_size_t i = 0; i < k; ++i)
+      {
+        G[i + i * ld]  = 1.0;
+        HR[i + i * ld] = 1.0;
+      }
+      g[k] = beta;
+
+      {
+        viennacl::vector_base<NumericT> v_0(W.handle(), W.size1(), k * W.internal_size1(), 1);
+        v_0 = residual / NumericT(beta);
+      }
+
+      vcl_size_t p = 0;   // number of Arnoldi steps in this cycle
+      for (vcl_size_t j = k; j < m; ++j)
+      {
+        viennacl::vector_base<NumericT> v_j(W.handle(), W.size1(), j * W.internal_size1(), 1);
+        viennacl::vector_base<NumericT> v_j_plus_1(W.handle(), W.size1(), (j + 1) * W.internal_size1(), 1);
+        temp = viennacl::linalg::prod(A, v_j);
+        precond.apply(temp);
+
+        // classical Gram-Schmidt against [C, V] with reorthogonalization:
+        viennacl::vector<NumericT> h = viennacl::linalg::prod(trans(gcrodr_columns(W, 0, j + 1)), temp);
+        temp -= viennacl::linalg::prod(gcrodr_columns(W, 0, j + 1), h);
+        viennacl::vector<NumericT> h2 = viennacl::linalg::prod(trans(gcrodr_columns(W, 0, j + 1)), temp);
+        temp -= viennacl::linalg::prod(gcrodr_columns(W, 0, j + 1), h2);
+        h += h2;
+
+        double h_sub = viennacl::linalg::norm_2(temp);
+        if (h_sub > 0)
+          v_j_plus_1 = temp / NumericT(h_sub);
+
+        viennacl::fast_copy(h.begin(), h.end(), host_h.begin());
+        for (vcl_size_t i = 0; i <= j; ++i)
+          G[i + j * ld] = host_h[i];
+        G[j + 1 + j * ld] = h_sub;
+
+        //
+        // Givens rotations on the Arnoldi part, the identity block for C needs no elimination:
+        //
+        for (vcl_size_t i = 0; i <= j + 1; ++i)
+          HR[i + j * ld] = G[i + j * ld];
+        for (vcl_size_t i = k; i < j; ++i)
+        {
+          double h_i  = HR[i     + j * ld];
+          double h_i1 = HR[i + 1 + j * ld];
+          HR[i     + j * ld] =  givens_c[i] * h_i + givens_s[i] * h_i1;
+          HR[i + 1 + j * ld] = -givens_s[i] * h_i + givens_c[i] * h_i1;
+        }
+        double h_diag = HR[j + j * ld];
+        double norm_h = std::sqrt(h_diag * h_diag + h_sub * h_sub);
+        givens_c[j] = (norm_h > 0) ? h_diag / norm_h : 1.0;
+        givens_s[j] = (norm_h > 0) ? h_sub  / norm_h : 0.0;
+        HR[j     + j * ld] = norm_h;
+        HR[j + 1 + j * ld] = 0;
+        g[j + 1] = -givens_s[j] * g[j];
+        g[j]     =  givens_c[j] * g[j];
+
+        ++p;
+        tag.iters(tag.iters() + 1);
+        if (std::fabs(g[j + 1]) < tag.tolerance() * norm_rhs || std::fabs(g[j + 1]) < tag.abs_tolerance() || !(h_sub > 0) || tag.iters() >= tag.max_iterations())
+          break;
+      }
+
+      vcl_size_t m_cycle = k + p;
+
+      //
+      // Least squares solution y, update x += [U, V] y:
+      //
+      std::vector<double> y(m_cycle);
+      for (vcl_size_t i2 = 0; i2 < m_cycle; ++i2)
+      {
+        vcl_size_t i = m_cycle - 1 - i2;
+        double value = g[i];
+        for (vcl_size_t j = i + 1; j < m_cycle; ++j)
+          value -= HR[i + j * ld] * y[j];
+        y[i] = (HR[i + i * ld] > 0 || HR[i + i * ld] < 0) ? value / HR[i + i * ld] : 0.0;
+      }
+
+      std::vector<NumericT> host_y_U(k), host_y_V(p);
+      for (vcl_size_t i = 0; i < k; ++i)
+        host_y_U[i] = NumericT(y[i]);
+      for (vcl_size_t i = 0; i < p; ++i)
+        host_y_V[i] = NumericT(y[k + i]);
+
+      if (k > 0)
+      {
+        viennacl::vector<NumericT> y_U(k, ctx);
+        viennacl::fast_copy(host_y_U.begin(), host_y_U.end(), y_U.begin());
+        result += viennacl::linalg::prod(gcrodr_columns(U, 0, k), y_U);
+      }
+      viennacl::vector<NumericT> y_V(p, ctx);
+      viennacl::fast_copy(host_y_V.begin(), host_y_V.end(), y_V.begin());
+      result += viennacl::linalg::prod(gcrodr_columns(W, k, m_cycle), y_V);
+
+      //
+      // Update the recycled subspace from the search space of this cycle:
+      //
+      if (max_recycle_dim > 0)
+        k = gcrodr_update_recycle_space(U, k, W, m_cycle, G, ld, max_recycle_dim);
+
+      if (monitor && monitor(result, NumericT(std::fabs(g[m_cycle]) / norm_rhs), monitor_data))
+        break;
+    }
+
+    recycle_size = k;
+    tag.error(rel_residual);
+
+    return result;
+  }
+}
+
+
+/** @brief Solves a single system with GCRO-DR. The recycled subspace is only kept across restarts. Use gcrodr_solver for recycling across a sequence of systems.
+*
+* @param A        The system matrix
+* @param rhs      The load vector
+* @param tag      Solver configuration tag
+* @param precond  A preconditioner. Precondition operation is done via member function apply()
+* @return The result vector
+*/
+template<typename MatrixT, typename NumericT, typename PreconditionerT>
+viennacl::vector<NumericT> solve(MatrixT const & A, viennacl::vector<NumericT> const & rhs, gcrodr_tag const & tag, PreconditionerT const & precond)
+{
+  viennacl::matrix<NumericT, viennacl::column_major> U;
+  vcl_size_t recycle_size = 0;
+  return detail::gcrodr_solve(A, rhs, tag, precond, U, recycle_size);
+}
+
+/** @brief Convenience overload for the unpreconditioned GCRO-DR method */
+template<typename MatrixT, typename NumericT>
+viennacl::vector<NumericT> solve(MatrixT const & A, viennacl::vector<NumericT> const & rhs, gcrodr_tag const & tag)
+{
+  return viennacl::linalg::solve(A, rhs, tag, viennacl::linalg::no_precond());
+}
+
+
+/** @brief A GCRO-DR solver object for sequences of linear systems, e.g. from transient simulations.
+*
+* The deflation subspace computed while solving one system is kept in the solver object and reused for the next system, where the system matrix may change slightly.
+* The memory for the subspace is bounded by recycle_dim() vectors. Only viennacl::vector is supported as vector type.
+*/
+template<typename VectorT>
+class gcrodr_solver
+{
+public:
+  typedef typename viennacl::result_of::cpu_value_type<VectorT>::type   numeric_type;
+
+  gcrodr_solver(gcrodr_tag const & tag) : tag_(tag), recycle_size_(0), monitor_callback_(NULL), user_data_(NULL) {}
+
+  /** @brief Solves the system and updates the recycled subspace for the next call */
+  template<typename MatrixT, typename PreconditionerT>
+  VectorT operator()(MatrixT const & A, VectorT const & b, PreconditionerT const & precond)
+  {
+    if (viennacl::traits::size(init_guess_) > 0) // take initial guess into account
+    {
+      VectorT mod_rhs = viennacl::linalg::prod(A, init_guess_);
+      mod_rhs = b - mod_rhs;
+      VectorT y = detail::gcrodr_solve(A, mod_rhs, tag_, precond, U_, recycle_size_, monitor_callback_, user_data_);
+      return init_guess_ + y;
+    }
+    return detail::gcrodr_solve(A, b, tag_, precond, U_, recycle_size_, monitor_callback_, user_data_);
+  }
+
+
+  template<typename MatrixT>
+  VectorT operator()(MatrixT const & A, VectorT const & b)
+  {
+    return operator()(A, b, viennacl::linalg::no_precond());
+  }
+
+  /** @brief Specifies an initial guess for the iterative solver.
+    *
+    * An iterative solver for Ax = b with initial guess x_0 is equivalent to an iterative solver for Ay = b' := b - Ax_0, where x = x_0 + y.
+    */
+  void set_initial_guess(VectorT const & x) { init_guess_ = x; }
+
+  /** @brief Sets a monitor function pointer to be called at the end of each cycle. Set to NULL to run without monitor.
+   *
+   *  The monitor function is called with the current guess for the result as first argument and the current relative residual estimate as second argument.
+   *  The third argument is a pointer to user-defined data, through which additional information can be passed.
+   *  If the montior function returns true, the solver terminates (either convergence or divergence).
+   */
+  void set_monitor(bool (*monitor_fun)(VectorT const &, numeric_type, void *), void *user_data)
+  {
+    monitor_callback_ = monitor_fun;
+    user_data_ = user_data;
+  }
+
+  /** @brief Returns the dimension of the subspace recycled for the next system */
+  vcl_size_t recycle_size() const { return recycle_size_; }
+
+  /** @brief Discards the recycled subspace, e.g. if the next system is unrelated to the previous ones */
+  void reset() { recycle_size_ = 0; }
+
+  /** @brief Returns the solver tag containing basic configuration such as tolerances, etc. */
+  gcrodr_tag const & tag() const { return tag_; }
+
+private:
+  gcrodr_tag  tag_;
+  VectorT     init_guess_;
+  viennacl::matrix<numeric_type, viennacl::column_major> U_;
+  vcl_size_t  recycle_size_;
+  bool       (*monitor_callback_)(VectorT const &, numeric_type, void *);
+  void       *user_data_;
+};
+
+}
+}
+
+#endif
@@ -37,6 +37,7 @@
 
 #include "viennacl/linalg/iterative_operations.hpp"
 #include "viennacl/vector_proxy.hpp"
+#include "viennacl/linalg/detail/s_step.hpp"
 
 
 namespace viennacl
@@ -56,7 +57,7 @@ public:
   * @param krylov_dim     The maximum dimension of the Krylov space before restart (number of restarts is found by max_iterations / krylov_dim)
   */
   gmres_tag(double tol = 1e-10, unsigned int max_iterations = 300, unsigned int krylov_dim = 20)
-   : tol_(tol), abs_tol_(0), iterations_(max_iterations), krylov_dim_(krylov_dim), iters_taken_(0) {}
+   : tol_(tol), abs_tol_(0), iterations_(max_iterations), krylov_dim_(krylov_dim), s_(1), s_step_basis_(S_STEP_NEWTON_BASIS), iters_taken_(0), last_error_(0), s_step_breakdowns_(0) {}
 
   /** @brief Returns the relative tolerance */
   double tolerance() const { return tol_; }
@@ -89,15 +90,33 @@ public:
   /** @brief Sets the estimated relative error at the end of the solver run */
   void error(double e) const { last_error_ = e; }
 
+  /** @brief Returns the number of Krylov vectors generated per global reduction. A value of one selects the standard (or pipelined) GMRES method. */
+  unsigned int s_steps() const { return s_; }
+  /** @brief Sets the number of Krylov vectors generated per global reduction (s-step GMRES, only available for ViennaCL vectors). Should not exceed the Krylov dimension. */
+  void s_steps(unsigned int s) { if (s > 0) s_ = s; }
+
+  /** @brief Returns the polynomial basis used by s-step GMRES */
+  s_step_basis_type s_step_basis() const { return s_step_basis_; }
+  /** @brief Sets the polynomial basis used by s-step GMRES */
+  void s_step_basis(s_step_basis_type basis) { s_step_basis_ = basis; }
+
+  /** @brief Returns the number of times s-step GMRES detected a numerically dependent block or a residual gap and reduced s */
+  unsigned int s_step_breakdowns() const { return s_step_breakdowns_; }
+  /** @brief Sets the number of s-step breakdowns (should only be modified by the solver) */
+  void s_step_breakdowns(unsigned int num) const { s_step_breakdowns_ = num; }
+
 private:
   double tol_;
   double abs_tol_;
   unsigned int iterations_;
   unsigned int krylov_dim_;
+  unsigned int s_;
+  s_step_basis_type s_step_basis_;
 
   //return values from solver
   mutable unsigned int iters_taken_;
   mutable double last_error_;
+  mutable unsigned int s_step_breakdowns_;
 };
 
 namespace detail
@@ -166,6 +185,297 @@ namespace detail
   }
 
 
+  /** @brief Implementation of the s-step (communication-avoiding) GMRES method with left preconditioning, specialized for ViennaCL types.
+  *
+  * Following M. Hoemmen's thesis (UC Berkeley, 2010): Each block generates s Krylov vectors starting from the last orthonormal basis vector with a Newton or Chebyshev basis.
+  * The block is orthogonalized against the previous basis vectors by block classical Gram-Schmidt and internally by a Cholesky QR factorization,
+  * where all inner products are obtained from a single matrix-matrix product, so the number of global reductions is reduced by a factor of s.
+  * The least squares problem is formulated for the (upper Hessenberg) coefficient matrix of the basis recurrence in terms of the orthonormal basis and solved with Givens rotations.
+  *
+  * The first s iterations are carried out with block size one in order to obtain Ritz value estimates for the basis.
+  * If the Cholesky QR factorization of a block detects a numerically rank-deficient block, the block is truncated and s is halved.
+  * If the true residual at a restart deviates from the estimate of the previous cycle, s is halved as well. These events are counted in tag.s_step_breakdowns().
+  */
+  template<typename MatrixT, typename NumericT, typename PreconditionerT>
+  viennacl::vector<NumericT> s_step_solve(MatrixT const & A,
+                                          viennacl::vector<NumericT> const & rhs,
+                                          gmres_tag const & tag,
+                                          PreconditionerT const & precond,
+                                          bool (*monitor)(viennacl::vector<NumericT> const &, NumericT, void*) = NULL,
+                                          void *monitor_data = NULL)
+  {
+    typedef viennacl::matrix<NumericT, viennacl::column_major>   DenseMatrixType;
+
+    viennacl::context ctx = viennacl::traits::context(rhs);
+    vcl_size_t n = rhs.size();
+    double stability_tol = std::sqrt(static_cast<double>(std::numeric_limits<NumericT>::epsilon()));
+
+    viennacl::vector<NumericT> result = viennacl::zero_vector<NumericT>(n, ctx);
+    viennacl::vector<NumericT> residual(rhs);
+    viennacl::vector<NumericT> temp(n, ctx);
+
+    tag.iters(0);
+    tag.s_step_breakdowns(0);
+    tag.error(0);
+
+    double norm_rhs = viennacl::linalg::norm_2(rhs);
+    if (norm_rhs <= tag.abs_tolerance()) //solution is zero if RHS norm is zero
+      return result;
+
+    vcl_size_t krylov_dim = std::min<vcl_size_t>(tag.krylov_dim(), n);
+    vcl_size_t s_target   = std::min<vcl_size_t>(tag.s_steps(), krylov_dim);
+    detail::s_step_basis basis;
+    detail::s_step_monomial_basis(basis, 1);
+    bool startup = true;
+
+    vcl_size_t ld = krylov_dim + 1;         // leading dimension of the small matrices on the host
+    DenseMatrixType Q(n, krylov_dim + 1, ctx);
+    DenseMatrixType gram(1, 1, ctx);
+    DenseMatrixType block_temp(n, 1, ctx);
+    vcl_size_t stride = Q.internal_size1();
+
+    unsigned int iters = 0;
+    double rel_residual = 1;
+    double estimated_rel_residual = 0;
+    for (unsigned int restart_count = 0; iters < tag.max_iterations(); ++restart_count)
+    {
+      //
+      // (Re-)Initialize residual: r = M^{-1} (b - A*x)
+      //
+      residual = viennacl::linalg::prod(A, result);
+      residual = rhs - residual;
+      precond.apply(residual);
+
+      double rho_0 = viennacl::linalg::norm_2(residual);
+      rel_residual = rho_0 / norm_rhs;
+      if (rel_residual < tag.tolerance() || rho_0 < tag.abs_tolerance())
+        break;
+
+      // stability check: the true residual must agree with the estimate of the previous cycle
+      if (restart_count > 0 && s_target > 1 && rel_residual > 10.0 * estimated_rel_residual && rel_residual > tag.tolerance())
+      {
+        tag.s_step_breakdowns(tag.s_step_breakdowns() + 1);
+        s_target = std::max<vcl_size_t>(s_target / 2, 1);
+      }
+
+      {
+        viennacl::vector_base<NumericT> Q_0(Q.handle(), n, 0, 1);
+        Q_0 = residual / NumericT(rho_0);
+      }
+
+      std::vector<double> H(ld * krylov_dim, 0.0);   // op(V) = Q H, where V are the vectors the operator is applied to
+      std::vector<double> HR(ld * krylov_dim, 0.0);  // H after Givens rotations
+      std::vector<double> V_coeffs(ld * krylov_dim, 0.0); // V = Q V_coeffs
+      std::vector<double> givens_c(krylov_dim), givens_s(krylov_dim);
+      std::vector<double> g(ld, 0.0);
+      g[0] = rho_0;
+
+      vcl_size_t k = 0;   // number of iterations in this cycle, i.e. Q_0, ..., Q_k are orthonormal
+      bool cycle_done = false;
+      while (!cycle_done && k < krylov_dim && iters < tag.max_iterations())
+      {
+        vcl_size_t s = std::min<vcl_size_t>(std::min<vcl_size_t>(startup ? 1 : s_target, krylov_dim - k), tag.max_iterations() - iters);
+
+        //
+        // Generate basis: V_0 = Q_k, V_{j+1} = (M^{-1} A V_j - alpha_j V_j - beta_j V_{j-1}) / gamma_j
+        //
+        for (vcl_size_t j = 0; j < s; ++j)
+        {
+          viennacl::vector_base<NumericT> V_j(Q.handle(), n, (k + j) * stride, 1);
+          viennacl::vector_base<NumericT> V_j_minus_1(Q.handle(), n, (k + (j > 0 ? j - 1 : 0)) * stride, 1);
+          viennacl::vector_base<NumericT> V_j_plus_1(Q.handle(), n, (k + j + 1) * stride, 1);
+          V_j_plus_1 = viennacl::linalg::prod(A, V_j);
+          detail::s_step_precondition(precond, V_j_plus_1, temp);
+          detail::s_step_recurrence(basis, j, V_j_plus_1, V_j, V_j_minus_1);
+        }
+
+        //
+        // Single reduction: [Q_0, ..., Q_k, V_1, ..., V_s]^T * [V_1, ..., V_s]
+        //
+        gram.resize(k + s + 1, s, false);
+        gram = viennacl::linalg::prod(trans(viennacl::project(Q, viennacl::range(0, n), viennacl::range(0, k + s + 1))),
+                                      viennacl::project(Q, viennacl::range(0, n), viennacl::range(k + 1, k + s + 1)));
+        std::vector<double> G;
+        detail::small_dense_to_host(gram, G);
+
+        // block classical Gram-Schmidt with C = Q^T V, followed by Cholesky QR: (V - Q C)^T (V - Q C) = V^T V - C^T C = R^T R
+        vcl_size_t rows = k + s + 1;
+        std::vector<double> R(s * s);
+        for (vcl_size_t j = 0; j < s; ++j)
+          for (vcl_size_t i = 0; i < s; ++i)
+          {
+            double value = G[k + 1 + i + j * rows];
+            for (vcl_size_t l = 0; l <= k; ++l)
+              value -= G[l + i * rows] * G[l + j * rows];
+            R[i + j * s] = value;
+          }
+        for (vcl_size_t j = 0; j < s; ++j)
+          for (vcl_size_t i = 0; i < j; ++i)
+            R[i + j * s] = R[j + i * s] = 0.5 * (R[i + j * s] + R[j + i * s]);
+
+        // stability check: truncate the block at the first numerically dependent vector
+        vcl_size_t s_valid = detail::small_cholesky_factor(R, s, stability_tol);
+        if (s_valid < s)
+        {
+          if (s > 1)
+          {
+            tag.s_step_breakdowns(tag.s_step_breakdowns() + 1);
+            s_target = std::max<vcl_size_t>(s_target / 2, 1);
+          }
+          cycle_done = true;   // happy breakdown for s = 1, otherwise restart with the smaller block size
+          if (s_valid == 0)
+            break;
+        }
+
+        //
+        // Orthonormalize the block on the device: Q_new = (V - Q C) R^{-1}
+        //
+        std::vector<double> minus_C((k + 1) * s_valid);
+        for (vcl_size_t j = 0; j < s_valid; ++j)
+          for (vcl_size_t i = 0; i <= k; ++i)
+            minus_C[i + j * (k + 1)] = -G[i + j * rows];
+
+        std::vector<double> R_inv(s_valid * s_valid, 0.0); // inverse of the upper triangular R = L^T, where L is stored in the lower triangle of 'R'
+        for (vcl_size_t j = 0; j < s_valid; ++j)
+        {
+          R_inv[j + j * s_valid] = 1.0 / R[j + j * s];
+          for (vcl_size_t i2 = 0; i2 < j; ++i2)
+          {
+            vcl_size_t i = j - 1 - i2;
+            double value = 0;
+            for (vcl_size_t l = i + 1; l <= j; ++l)
+              value -= R[l + i * s] * R_inv[l + j * s_valid];
+            R_inv[i + j * s_valid] = value / R[i + i * s];
+          }
+        }
+
+        DenseMatrixType vcl_minus_C(k + 1, s_valid, ctx);
+        detail::small_dense_from_host(minus_C, vcl_minus_C);
+        DenseMatrixType vcl_R_inv(s_valid, s_valid, ctx);
+        detail::small_dense_from_host(R_inv, vcl_R_inv);
+
+        viennacl::matrix_range<DenseMatrixType> V_block(Q, viennacl::range(0, n), viennacl::range(k + 1, k + 1 + s_valid));
+        V_block += viennacl::linalg::prod(viennacl::project(Q, viennacl::range(0, n), viennacl::range(0, k + 1)), vcl_minus_C);
+        block_temp.resize(n, s_valid, false);
+        block_temp = viennacl::linalg::prod(V_block, vcl_R_inv);
+        V_block = block_temp;
+
+        //
+        // Coefficients of V_j in terms of Q, and op(V_j) = gamma_j V_{j+1} + alpha_j V_j + beta_j V_{j-1} in terms of Q:
+        //
+        std::vector<double> coeffs(ld * (s_valid + 1), 0.0);
+        coeffs[k] = 1.0;
+        for (vcl_size_t j = 1; j <= s_valid; ++j)
+        {
+          for (vcl_size_t i = 0; i <= k; ++i)
+            coeffs[i + j * ld] = G[i + (j - 1) * rows];
+          for (vcl_size_t i = 0; i < j; ++i)
+            coeffs[k + 1 + i + j * ld] = R[(j - 1) + i * s];
+        }
+
+        for (vcl_size_t j = 0; j < s_valid; ++j)
+        {
+          vcl_size_t col = k + j;
+          for (vcl_size_t i = 0; i < ld; ++i)
+          {
+            V_coeffs[i + col * ld] = coeffs[i + j * ld];
+            H[i + col * ld] = basis.gamma[j] * coeffs[i + (j + 1) * ld] + basis.alpha[j] * coeffs[i + j * ld] + ((j > 0) ? basis.beta[j] * coeffs[i + (j - 1) * ld] : 0.0);
+            HR[i + col * ld] = H[i + col * ld];
+          }
+
+          // apply previous Givens rotations and compute the new one:
+          for (vcl_size_t i = 0; i < col; ++i)
+          {
+            double h_i  = HR[i     + col * ld];
+            double h_i1 = HR[i + 1 + col * ld];
+            HR[i     + col * ld] =  givens_c[i] * h_i + givens_s[i] * h_i1;
+            HR[i + 1 + col * ld] = -givens_s[i] * h_i + givens_c[i] * h_i1;
+          }
+          double h_diag = HR[col + col * ld];
+          double h_sub  = HR[col + 1 + col * ld];
+          double norm_h = std::sqrt(h_diag * h_diag + h_sub * h_sub);
+          givens_c[col] = (norm_h > 0) ? h_diag / norm_h : 1.0;
+          givens_s[col] = (norm_h > 0) ? h_sub  / norm_h : 0.0;
+          HR[col     + col * ld] = norm_h;
+          HR[col + 1 + col * ld] = 0;
+          g[col + 1] = -givens_s[col] * g[col];
+          g[col]     =  givens_c[col] * g[col];
+
+          ++iters;
+          tag.iters(iters);
+          if (std::fabs(g[col + 1]) / norm_rhs < tag.tolerance() || std::fabs(g[col + 1]) < tag.abs_tolerance())
+          {
+            s_valid = j + 1;
+            cycle_done = true;
+            break;
+          }
+        }
+        k += s_valid;
+
+        //
+        // After the startup phase, set up the basis from the Ritz values of the Hessenberg matrix:
+        //
+        if (startup && (k >= s_target || cycle_done))
+        {
+          std::vector<double> H_square(k * k);
+          for (vcl_size_t j = 0; j < k; ++j)
+            for (vcl_size_t i = 0; i < k; ++i)
+              H_square[i + j * k] = H[i + j * ld];
+          detail::s_step_setup_basis(basis, detail::s_step_ritz_values(H_square, k), tag.s_step_basis(), s_target);
+          startup = false;
+        }
+      }
+
+      if (k == 0) // no progress possible
+        break;
+
+      //
+      // Solve the least squares problem and update the result: x += Q V_coeffs y
+      //
+      std::vector<double> y(k);
+      for (vcl_size_t i2 = 0; i2 < k; ++i2)
+      {
+        vcl_size_t i = k - 1 - i2;
+        double value = g[i];
+        for (vcl_size_t j = i + 1; j < k; ++j)
+          value -= HR[i + j * ld] * y[j];
+        y[i] = value / HR[i + i * ld];
+      }
+      std::vector<NumericT> update(k, 0);
+      for (vcl_size_t j = 0; j < k; ++j)
+        for (vcl_size_t i = 0; i <= j; ++i)
+          update[i] += NumericT(V_coeffs[i + j * ld] * y[j]);
+
+      viennacl::vector<NumericT> vcl_update(k, ctx);
+      viennacl::fast_copy(update.begin(), update.end(), vcl_update.begin());
+      result += viennacl::linalg::prod(viennacl::project(Q, viennacl::range(0, n), viennacl::range(0, k)), vcl_update);
+
+      estimated_rel_residual = std::fabs(g[k]) / norm_rhs;
+      rel_residual = estimated_rel_residual;
+      if (monitor && monitor(result, NumericT(estimated_rel_residual), monitor_data))
+        break;
+    }
+
+    tag.error(rel_residual);
+
+    return result;
+  }
+
+  /** @brief Dispatches to s-step GMRES for ViennaCL vectors. Returns false for all other vector types, which are solved with the standard method. */
+  template<typename MatrixT, typename VectorT, typename PreconditionerT, typename MonitorT>
+  bool s_step_dispatch(MatrixT const &, VectorT const &, VectorT &, gmres_tag const &, PreconditionerT const &, MonitorT, void *)
+  {
+    return false;
+  }
+
+  template<typename MatrixT, typename NumericT, typename PreconditionerT, typename MonitorT>
+  bool s_step_dispatch(MatrixT const & A, viennacl::vector<NumericT> const & rhs, viennacl::vector<NumericT> & result, gmres_tag const & tag, PreconditionerT const & precond, MonitorT monitor, void *monitor_data)
+  {
+    result = detail::s_step_solve(A, rhs, tag, precond, monitor, monitor_data);
+    return true;
+  }
+
+
   /** @brief Implementation of a pipelined GMRES solver without preconditioner
   *
   * Following algorithm 2.1 proposed by Walker in "A Simpler GMRES", but uses classical Gram-Schmidt instead of modified Gram-Schmidt for better parallelization.
@@ -186,6 +496,9 @@ namespace detail
                                                bool (*monitor)(viennacl::vector<ScalarType> const &, ScalarType, void*) = NULL,
                                                void *monitor_data = NULL)
   {
+    if (tag.s_steps() > 1)
+      return detail::s_step_solve(A, rhs, tag, viennacl::linalg::no_precond(), monitor, monitor_data);
+
     viennacl::vector<ScalarType> residual(rhs);
     viennacl::vector<ScalarType> result = viennacl::zero_vector<ScalarType>(rhs.size(), viennacl::traits::context(rhs));
 
@@ -461,6 +774,9 @@ namespace detail
     VectorT result = rhs;
     viennacl::traits::clear(result);
 
+    if (tag.s_steps() > 1 && detail::s_step_dispatch(matrix, rhs, result, tag, precond, monitor, monitor_data))
+      return result;
+
     vcl_size_t krylov_dim = static_cast<vcl_size_t>(tag.krylov_dim());
     if (problem_size < krylov_dim)
       krylov_dim = problem_size; //A Krylov space larger than the matrix would lead to seg-faults (mathematically, error is certain to be zero already)
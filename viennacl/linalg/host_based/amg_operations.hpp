@@ -25,9 +25,13 @@
 #include <cstdlib>
 #include <cmath>
 #include "viennacl/linalg/detail/amg/amg_base.hpp"
+#include "viennacl/linalg/spgemm_plan.hpp"
+#include "viennacl/linalg/host_based/sparse_matrix_operations.hpp"
 
 #include <map>
 #include <set>
+#include <vector>
+#include <algorithm>
 #include <functional>
 #ifdef VIENNACL_WITH_OPENMP
 #include <omp.h>
@@ -1369,125 +1373,12 @@ void amg_interpol(MatrixT const & A,
 }
 
 
-/** @brief Computes B = trans(A).
-  *
-  * To be replaced by native functionality in ViennaCL.
-  */
+/** @brief Computes B = trans(A). */
 template<typename NumericT>
 void amg_transpose(compressed_matrix<NumericT> const & A,
                    compressed_matrix<NumericT> & B)
 {
-  NumericT     const * A_elements   = viennacl::linalg::host_based::detail::extract_raw_pointer<NumericT>(A.handle());
-  unsigned int const * A_row_buffer = viennacl::linalg::host_based::detail::extract_raw_pointer<unsigned int>(A.handle1());
-  unsigned int const * A_col_buffer = viennacl::linalg::host_based::detail::extract_raw_pointer<unsigned int>(A.handle2());
-
-  // initialize datastructures for B:
-  B = compressed_matrix<NumericT>(A.size2(), A.size1(), A.nnz(), viennacl::traits::context(A));
-
-  NumericT     * B_elements   = viennacl::linalg::host_based::detail::extract_raw_pointer<NumericT>(B.handle());
-  unsigned int * B_row_buffer = viennacl::linalg::host_based::detail::extract_raw_pointer<unsigned int>(B.handle1());
-  unsigned int * B_col_buffer = viennacl::linalg::host_based::detail::extract_raw_pointer<unsigned int>(B.handle2());
-
-#ifdef VIENNACL_WITH_OPENMP
-  int threads = 8;
-#else
-  int threads = 1;
-#endif
-  std::size_t scratchpad_size = threads * (B.size1()+1); //column-oriented matrix with 'threads' columns
-  unsigned int * scratchpad = (unsigned int *)malloc(sizeof(unsigned int) * scratchpad_size);
-
-  // prepare uninitialized scratchpad:
-#ifdef VIENNACL_WITH_OPENMP
-  #pragma omp parallel for
-#endif
-  for (std::size_t i = 0; i < scratchpad_size; ++i)
-    scratchpad[i] = 0;
-
-  //
-  // Stage 1: Compute pattern for B
-  //
-#ifdef VIENNACL_WITH_OPENMP
-  #pragma omp parallel for num_threads(threads)
-#endif
-  for (std::size_t row = 0; row < A.size1(); ++row)
-  {
-    unsigned int thread_id = 0;
-#ifdef VIENNACL_WITH_OPENMP
-    thread_id = omp_get_thread_num();
-#endif
-
-    unsigned int row_start = A_row_buffer[row];
-    unsigned int row_stop  = A_row_buffer[row+1];
-
-    for (unsigned int nnz_index = row_start; nnz_index < row_stop; ++nnz_index)
-      scratchpad[thread_id * (B.size1()+1) + A_col_buffer[nnz_index]] += 1;
-  }
-
-#ifdef VIENNACL_WITH_OPENMP
-  #pragma omp parallel for
-#endif
-  for (std::size_t row = 0; row < B.size1(); ++row)
-  {
-    unsigned int offset = scratchpad[row];
-    for (std::size_t i = 1; i<static_cast<std::size_t>(threads); ++i)
-    {
-      unsigned int tmp = scratchpad[i*(B.size1()+1) + row];
-      scratchpad[i*(B.size1()+1) + row] = offset;
-      offset += tmp;
-    }
-    scratchpad[row] = offset;
-  }
-
-  //
-  // Stage 2: Bring row-start array in place using exclusive-scan:
-  //
-  viennacl::vector_base<unsigned int> helper_vec(scratchpad, viennacl::MAIN_MEMORY, B.size1()+1);
-  viennacl::linalg::host_based::exclusive_scan(helper_vec, helper_vec);
-
-  // propagate offsets and copy CSR datastructure over to B:
-#ifdef VIENNACL_WITH_OPENMP
-  #pragma omp parallel for
-#endif
-  for (std::size_t row = 0; row < B.size1(); ++row)
-  {
-    unsigned int row_offset = scratchpad[row];
-    B_row_buffer[row] = row_offset;
-    for (std::size_t i = 1; i<std::size_t(threads); ++i)
-      scratchpad[i*(B.size1()+1) + row] += row_offset;
-  }
-  B_row_buffer[B.size1()] = scratchpad[B.size1()];
-
-  //
-  // Stage 3: Fill with data
-  //
-#ifdef VIENNACL_WITH_OPENMP
-  #pragma omp parallel for num_threads(threads)
-#endif
-  for (std::size_t row = 0; row < A.size1(); ++row)
-  {
-    unsigned int thread_id = 0;
-#ifdef VIENNACL_WITH_OPENMP
-    thread_id = omp_get_thread_num();
-#endif
-    //std::cout << "Row " << row << ": ";
-    unsigned int row_start = A_row_buffer[row];
-    unsigned int row_stop  = A_row_buffer[row+1];
-
-    for (unsigned int nnz_index = row_start; nnz_index < row_stop; ++nnz_index)
-    {
-      unsigned int col_in_A = A_col_buffer[nnz_index];
-      unsigned int array_index = thread_id * static_cast<unsigned int>(B.size1()+1) + col_in_A;
-      unsigned int B_nnz_index = scratchpad[array_index];
-      scratchpad[array_index] += 1;
-      B_col_buffer[B_nnz_index] = static_cast<unsigned int>(row);
-      B_elements[B_nnz_index] = A_elements[nnz_index];
-    }
-  }
-
-  // Step 3: Make datastructure consistent (row blocks!)
-  B.generate_row_block_information();
-
-  free(scratchpad);
+  viennacl::linalg::host_based::transpose(A, B);
 }
 
 /** Assign sparse matrix A to dense matrix B */
@@ -1514,6 +1405,54 @@ void assign_to_dense(viennacl::compressed_matrix<NumericT, AlignmentV> const & A
 
 }
 
+namespace detail
+{
+  /** @brief Damped Jacobi Smoother for CSR arrays with values of type StorageT. Arithmetic is carried out in NumericT. */
+  template<typename NumericT, typename StorageT>
+  void smooth_jacobi_impl(unsigned int iterations,
+                          vcl_size_t num_rows,
+                          unsigned int const * A_row_buffer,
+                          unsigned int const * A_col_buffer,
+                          StorageT const * A_elements,
+                          vector<NumericT> & x,
+                          vector<NumericT> & x_backup,
+                          vector<NumericT> const & rhs_smooth,
+                          NumericT weight)
+  {
+    NumericT     const * rhs_elements = viennacl::linalg::host_based::detail::extract_raw_pointer<NumericT>(rhs_smooth.handle());
+
+    NumericT           * x_elements     = viennacl::linalg::host_based::detail::extract_raw_pointer<NumericT>(x.handle());
+    NumericT     const * x_old_elements = viennacl::linalg::host_based::detail::extract_raw_pointer<NumericT>(x_backup.handle());
+
+    for (unsigned int i=0; i<iterations; ++i)
+    {
+      x_backup = x;
+
+      #ifdef VIENNACL_WITH_OPENMP
+      #pragma omp parallel for
+      #endif
+      for (long row2 = 0; row2 < static_cast<long>(num_rows); ++row2)
+      {
+        unsigned int row = static_cast<unsigned int>(row2);
+        unsigned int col_end   = A_row_buffer[row+1];
+
+        NumericT sum  = NumericT(0);
+        NumericT diag = NumericT(1);
+        for (unsigned int index = A_row_buffer[row]; index != col_end; ++index)
+        {
+          unsigned int col = A_col_buffer[index];
+          if (col == row)
+            diag = static_cast<NumericT>(A_elements[index]);
+          else
+            sum += static_cast<NumericT>(A_elements[index]) * x_old_elements[col];
+        }
+
+        x_elements[row] = weight * (rhs_elements[row] - sum) / diag + (NumericT(1) - weight) * x_old_elements[row];
+      }
+    }
+  }
+}
+
 /** @brief Damped Jacobi Smoother (CUDA version)
 *
 * @param iterations  Number of smoother iterations
@@ -1531,41 +1470,317 @@ void smooth_jacobi(unsigned int iterations,
                    vector<NumericT> const & rhs_smooth,
                    NumericT weight)
 {
+  detail::smooth_jacobi_impl(iterations, A.size1(),
+                             viennacl::linalg::host_based::detail::extract_raw_pointer<unsigned int>(A.handle1()),
+                             viennacl::linalg::host_based::detail::extract_raw_pointer<unsigned int>(A.handle2()),
+                             viennacl::linalg::host_based::detail::extract_raw_pointer<NumericT>(A.handle()),
+                             x, x_backup, rhs_smooth, weight);
+}
 
+/** @brief Damped Jacobi Smoother for operators with values stored in reduced precision
+*
+* @param iterations  Number of smoother iterations
+* @param A           Operator matrix for the smoothing
+* @param x           The vector smoothing is applied to
+* @param x_backup    (Different) Vector holding the same values as x
+* @param rhs_smooth  The right hand side of the equation for the smoother
+* @param weight      Damping factor. 0: No effect of smoother. 1: Undamped Jacobi iteration
+*/
+template<typename NumericT, typename StorageT>
+void smooth_jacobi(unsigned int iterations,
+                   mixed_compressed_matrix<NumericT, StorageT> const & A,
+                   vector<NumericT> & x,
+                   vector<NumericT> & x_backup,
+                   vector<NumericT> const & rhs_smooth,
+                   NumericT weight)
+{
+  detail::smooth_jacobi_impl(iterations, A.size1(),
+                             viennacl::linalg::host_based::detail::extract_raw_pointer<unsigned int>(A.handle1()),
+                             viennacl::linalg::host_based::detail::extract_raw_pointer<unsigned int>(A.handle2()),
+                             viennacl::linalg::host_based::detail::extract_raw_pointer<StorageT>(A.handle()),
+                             x, x_backup, rhs_smooth, weight);
+}
+
+
+namespace detail
+{
+  /** @brief Collects the column indices of row 'row' of the product R * A in 'fine_list'. Returns the number of column indices.
+  *
+  * @param fine_flags   Work array of size2(A) entries, all zero. Entries in 'fine_list' are set on return.
+  */
+  inline unsigned int galerkin_row_RA_pattern(unsigned int row,
+                                              unsigned int const * R_row_buffer, unsigned int const * R_col_buffer,
+                                              unsigned int const * A_row_buffer, unsigned int const * A_col_buffer,
+                                              unsigned char * fine_flags, unsigned int * fine_list)
+  {
+    unsigned int num_fine = 0;
+    for (unsigned int k = R_row_buffer[row]; k < R_row_buffer[row+1]; ++k)
+    {
+      unsigned int row_A = R_col_buffer[k];
+      for (unsigned int l = A_row_buffer[row_A]; l < A_row_buffer[row_A+1]; ++l)
+      {
+        unsigned int col = A_col_buffer[l];
+        if (!fine_flags[col])
+        {
+          fine_flags[col] = 1;
+          fine_list[num_fine++] = col;
+        }
+      }
+    }
+    return num_fine;
+  }
+
+  /** @brief Writes the (unsorted) column indices of row 'row' of the product R * A * P to 'coarse_list'. Returns the number of column indices.
+  *
+  * @param fine_flags     Work array of size2(A) entries, all zero. Reset on return.
+  * @param fine_list      Work array of size2(A) entries
+  * @param coarse_flags   Work array of size2(P) entries, all zero. Reset on return.
+  */
+  inline unsigned int galerkin_row_pattern(unsigned int row,
+                                           unsigned int const * R_row_buffer, unsigned int const * R_col_buffer,
+                                           unsigned int const * A_row_buffer, unsigned int const * A_col_buffer,
+                                           unsigned int const * P_row_buffer, unsigned int const * P_col_buffer,
+                                           unsigned char * fine_flags, unsigned int * fine_list,
+                                           unsigned char * coarse_flags, unsigned int * coarse_list)
+  {
+    unsigned int num_fine = galerkin_row_RA_pattern(row, R_row_buffer, R_col_buffer, A_row_buffer, A_col_buffer, fine_flags, fine_list);
+
+    unsigned int num_coarse = 0;
+    for (unsigned int i = 0; i < num_fine; ++i)
+    {
+      unsigned int row_P = fine_list[i];
+      fine_flags[row_P] = 0;
+      for (unsigned int k = P_row_buffer[row_P]; k < P_row_buffer[row_P+1]; ++k)
+      {
+        unsigned int col = P_col_buffer[k];
+        if (!coarse_flags[col])
+        {
+          coarse_flags[col] = 1;
+          coarse_list[num_coarse++] = col;
+        }
+      }
+    }
+
+    for (unsigned int i = 0; i < num_coarse; ++i)
+      coarse_flags[coarse_list[i]] = 0;
+
+    return num_coarse;
+  }
+}
+
+/** @brief Symbolic stage of the Galerkin product A_coarse = R * A * P: Computes the sparsity pattern of A_coarse.
+*
+* Rows of A_coarse are computed one after another from the corresponding row of R * A, which is never stored as a whole.
+*
+* @param R     Restriction operator
+* @param A     Operator on the fine grid
+* @param P     Prolongation operator
+* @param plan  The plan to be set up
+*/
+template<typename NumericT>
+void galerkin_product_symbolic(compressed_matrix<NumericT> const & R,
+                               compressed_matrix<NumericT> const & A,
+                               compressed_matrix<NumericT> const & P,
+                               viennacl::linalg::galerkin_plan & plan)
+{
+  unsigned int const * R_row_buffer = viennacl::linalg::host_based::detail::extract_raw_pointer<unsigned int>(R.handle1());
+  unsigned int const * R_col_buffer = viennacl::linalg::host_based::detail::extract_raw_pointer<unsigned int>(R.handle2());
+  unsigned int const * A_row_buffer = viennacl::linalg::host_based::detail::extract_raw_pointer<unsigned int>(A.handle1());
+  unsigned int const * A_col_buffer = viennacl::linalg::host_based::detail::extract_raw_pointer<unsigned int>(A.handle2());
+  unsigned int const * P_row_buffer = viennacl::linalg::host_based::detail::extract_raw_pointer<unsigned int>(P.handle1());
+  unsigned int const * P_col_buffer = viennacl::linalg::host_based::detail::extract_raw_pointer<unsigned int>(P.handle2());
+
+  vcl_size_t fine_size   = A.size2();
+  vcl_size_t coarse_size = P.size2();
+
+  plan.set_sizes(R.size1(), P.size2(), R_row_buffer[R.size1()], A_row_buffer[A.size1()], P_row_buffer[P.size1()]);
+
+#ifdef VIENNACL_WITH_OPENMP
+  unsigned int max_threads = omp_get_max_threads();
+#else
+  unsigned int max_threads = 1;
+#endif
+
+  std::vector<unsigned char> fine_flags(max_threads * fine_size);
+  std::vector<unsigned int>  fine_list(max_threads * fine_size);
+  std::vector<unsigned char> coarse_flags(max_threads * coarse_size);
+  std::vector<unsigned int>  coarse_list(max_threads * coarse_size);
+
+  // Stage 1: Row lengths of the product and bound for the row lengths of R * A
+  std::vector<unsigned int> & C_row_buffer = plan.C_row_buffer();
+  C_row_buffer.resize(R.size1() + 1);
+  std::vector<vcl_size_t> max_row_RA_length(max_threads);
+#ifdef VIENNACL_WITH_OPENMP
+  #pragma omp parallel for
+#endif
+  for (long i = 0; i < long(R.size1()); ++i)
+  {
+    unsigned int thread_id = 0;
+#ifdef VIENNACL_WITH_OPENMP
+    thread_id = omp_get_thread_num();
+#endif
+    vcl_size_t row_RA_length = 0;
+    for (unsigned int k = R_row_buffer[i]; k < R_row_buffer[i+1]; ++k)
+      row_RA_length += A_row_buffer[R_col_buffer[k] + 1] - A_row_buffer[R_col_buffer[k]];
+    max_row_RA_length[thread_id] = std::max(max_row_RA_length[thread_id], std::min(row_RA_length, fine_size));
+
+    C_row_buffer[vcl_size_t(i)] = detail::galerkin_row_pattern(static_cast<unsigned int>(i),
+                                                               R_row_buffer, R_col_buffer, A_row_buffer, A_col_buffer, P_row_buffer, P_col_buffer,
+                                                               &(fine_flags[thread_id * fine_size]),     &(fine_list[thread_id * fine_size]),
+                                                               &(coarse_flags[thread_id * coarse_size]), &(coarse_list[thread_id * coarse_size]));
+  }
+
+  // exclusive scan:
+  unsigned int current_offset = 0;
+  for (vcl_size_t i = 0; i < R.size1(); ++i)
+  {
+    unsigned int tmp = C_row_buffer[i];
+    C_row_buffer[i] = current_offset;
+    current_offset += tmp;
+  }
+  C_row_buffer[R.size1()] = current_offset;
+  plan.max_row_RA_length(*std::max_element(max_row_RA_length.begin(), max_row_RA_length.end()));
+
+  // Stage 2: Column indices
+  std::vector<unsigned int> & C_col_buffer = plan.C_col_buffer();
+  C_col_buffer.resize(current_offset);
+#ifdef VIENNACL_WITH_OPENMP
+  #pragma omp parallel for
+#endif
+  for (long i = 0; i < long(R.size1()); ++i)
+  {
+    unsigned int thread_id = 0;
+#ifdef VIENNACL_WITH_OPENMP
+    thread_id = omp_get_thread_num();
+#endif
+    if (C_row_buffer[vcl_size_t(i)] == C_row_buffer[vcl_size_t(i)+1])
+      continue;
+
+    unsigned int * row_C_begin = &(C_col_buffer[C_row_buffer[vcl_size_t(i)]]);
+    unsigned int num_coarse = detail::galerkin_row_pattern(static_cast<unsigned int>(i),
+                                                           R_row_buffer, R_col_buffer, A_row_buffer, A_col_buffer, P_row_buffer, P_col_buffer,
+                                                           &(fine_flags[thread_id * fine_size]),     &(fine_list[thread_id * fine_size]),
+                                                           &(coarse_flags[thread_id * coarse_size]), row_C_begin);
+    std::sort(row_C_begin, row_C_begin + num_coarse);
+  }
+}
+
+/** @brief Numeric stage of the Galerkin product A_coarse = R * A * P using the sparsity pattern from galerkin_product_symbolic().
+*
+* For each row of A_coarse, the row of R * A is accumulated in a hash table and then multiplied with P. The intermediate A * P is not formed.
+* The hash tables are sized by the bound for the row lengths of R * A in the plan, so their size is independent of the size of the fine grid.
+* Only the values of A_coarse are written if it holds the pattern of the plan already, i.e. when recomputing A_coarse for new values of R, A, and P.
+*
+* @param plan      The plan obtained from galerkin_product_symbolic() for matrices with the same sparsity patterns as R, A, and P
+* @param R         Restriction operator
+* @param A         Operator on the fine grid
+* @param P         Prolongation operator
+* @param A_coarse  Result matrix (Galerkin operator)
+*/
+template<typename NumericT>
+void galerkin_product_numeric(viennacl::linalg::galerkin_plan const & plan,
+                              compressed_matrix<NumericT> const & R,
+                              compressed_matrix<NumericT> const & A,
+                              compressed_matrix<NumericT> const & P,
+                              compressed_matrix<NumericT> & A_coarse)
+{
+  NumericT     const * R_elements   = viennacl::linalg::host_based::detail::extract_raw_pointer<NumericT>(R.handle());
+  unsigned int const * R_row_buffer = viennacl::linalg::host_based::detail::extract_raw_pointer<unsigned int>(R.handle1());
+  unsigned int const * R_col_buffer = viennacl::linalg::host_based::detail::extract_raw_pointer<unsigned int>(R.handle2());
   NumericT     const * A_elements   = viennacl::linalg::host_based::detail::extract_raw_pointer<NumericT>(A.handle());
   unsigned int const * A_row_buffer = viennacl::linalg::host_based::detail::extract_raw_pointer<unsigned int>(A.handle1());
   unsigned int const * A_col_buffer = viennacl::linalg::host_based::detail::extract_raw_pointer<unsigned int>(A.handle2());
-  NumericT     const * rhs_elements = viennacl::linalg::host_based::detail::extract_raw_pointer<NumericT>(rhs_smooth.handle());
+  NumericT     const * P_elements   = viennacl::linalg::host_based::detail::extract_raw_pointer<NumericT>(P.handle());
+  unsigned int const * P_row_buffer = viennacl::linalg::host_based::detail::extract_raw_pointer<unsigned int>(P.handle1());
+  unsigned int const * P_col_buffer = viennacl::linalg::host_based::detail::extract_raw_pointer<unsigned int>(P.handle2());
+
+  // write sparsity pattern of A_coarse unless set up by a previous call. Memory is only allocated if A_coarse is too small:
+  bool pattern_set = viennacl::linalg::host_based::detail::csr_pattern_equal(A_coarse, plan.size1(), plan.size2(), plan.C_row_buffer(), plan.C_col_buffer());
+  if (!pattern_set)
+  {
+    if (A_coarse.handle1().get_active_handle_id() != viennacl::MAIN_MEMORY)
+      A_coarse.switch_memory_context(viennacl::context(viennacl::MAIN_MEMORY));
+    A_coarse.resize(plan.size1(), plan.size2(), false);
+    std::copy(plan.C_row_buffer().begin(), plan.C_row_buffer().end(), viennacl::linalg::host_based::detail::extract_raw_pointer<unsigned int>(A_coarse.handle1()));
+    A_coarse.reserve(plan.nnz(), false); // row offsets first, so that new memory is placed according to the row partition
+    std::copy(plan.C_col_buffer().begin(), plan.C_col_buffer().end(), viennacl::linalg::host_based::detail::extract_raw_pointer<unsigned int>(A_coarse.handle2()));
+  }
 
-  NumericT           * x_elements     = viennacl::linalg::host_based::detail::extract_raw_pointer<NumericT>(x.handle());
-  NumericT     const * x_old_elements = viennacl::linalg::host_based::detail::extract_raw_pointer<NumericT>(x_backup.handle());
+  NumericT           * C_elements   = viennacl::linalg::host_based::detail::extract_raw_pointer<NumericT>(A_coarse.handle());
+  unsigned int const * C_row_buffer = &(plan.C_row_buffer()[0]);
+  unsigned int const * C_col_buffer = plan.nnz() > 0 ? &(plan.C_col_buffer()[0]) : NULL;
 
-  for (unsigned int i=0; i<iterations; ++i)
+#ifdef VIENNACL_WITH_OPENMP
+  unsigned int max_threads = omp_get_max_threads();
+#else
+  unsigned int max_threads = 1;
+#endif
+
+  // one hash table per thread for the rows of R * A:
+  unsigned int table_size = spgemm_hash_table_size(static_cast<unsigned int>(plan.max_row_RA_length()));
+  unsigned int table_mask = table_size - 1;
+  std::vector<unsigned int> table_keys(max_threads * table_size, spgemm_hash_empty_key);
+  std::vector<NumericT>     table_values(max_threads * table_size);
+  std::vector<unsigned int> table_slots(max_threads * table_size / 2); // occupied slots, at most half of the table
+
+#ifdef VIENNACL_WITH_OPENMP
+  #pragma omp parallel for
+#endif
+  for (long i = 0; i < long(R.size1()); ++i)
   {
-    x_backup = x;
+    unsigned int thread_id = 0;
+#ifdef VIENNACL_WITH_OPENMP
+    thread_id = omp_get_thread_num();
+#endif
+    unsigned int * row_RA_keys   = &(table_keys[thread_id * table_size]);
+    NumericT     * row_RA_values = &(table_values[thread_id * table_size]);
+    unsigned int * row_RA_slots  = &(table_slots[thread_id * table_size / 2]);
 
-    #ifdef VIENNACL_WITH_OPENMP
-    #pragma omp parallel for
-    #endif
-    for (long row2 = 0; row2 < static_cast<long>(A.size1()); ++row2)
-    {
-      unsigned int row = static_cast<unsigned int>(row2);
-      unsigned int col_end   = A_row_buffer[row+1];
+    unsigned int row_C_start = C_row_buffer[i];
+    unsigned int row_C_stop  = C_row_buffer[i+1];
+    if (row_C_start == row_C_stop)
+      continue;
+
+    for (unsigned int k = row_C_start; k < row_C_stop; ++k)
+      C_elements[k] = 0;
 
-      NumericT sum  = NumericT(0);
-      NumericT diag = NumericT(1);
-      for (unsigned int index = A_row_buffer[row]; index != col_end; ++index)
+    // row of R * A:
+    unsigned int num_slots = 0;
+    for (unsigned int k = R_row_buffer[i]; k < R_row_buffer[i+1]; ++k)
+    {
+      NumericT val_R = R_elements[k];
+      unsigned int row_A = R_col_buffer[k];
+      for (unsigned int l = A_row_buffer[row_A]; l < A_row_buffer[row_A+1]; ++l)
       {
-        unsigned int col = A_col_buffer[index];
-        if (col == row)
-          diag = A_elements[index];
+        bool is_new;
+        unsigned int slot = spgemm_hash_find_or_insert(row_RA_keys, table_mask, A_col_buffer[l], is_new);
+        if (is_new)
+        {
+          row_RA_values[slot] = val_R * A_elements[l];
+          row_RA_slots[num_slots++] = slot;
+        }
         else
-          sum += A_elements[index] * x_old_elements[col];
+          row_RA_values[slot] += val_R * A_elements[l];
       }
+    }
 
-      x_elements[row] = weight * (rhs_elements[row] - sum) / diag + (NumericT(1) - weight) * x_old_elements[row];
+    // multiply with P, the column indices in the row of A_coarse are sorted:
+    unsigned int const * row_C_begin = C_col_buffer + row_C_start;
+    unsigned int const * row_C_end   = C_col_buffer + row_C_stop;
+    for (unsigned int j = 0; j < num_slots; ++j)
+    {
+      unsigned int slot  = row_RA_slots[j];
+      unsigned int row_P = row_RA_keys[slot];
+      row_RA_keys[slot] = spgemm_hash_empty_key;
+
+      NumericT val_RA = row_RA_values[slot];
+      for (unsigned int k = P_row_buffer[row_P]; k < P_row_buffer[row_P+1]; ++k)
+        C_elements[std::lower_bound(row_C_begin, row_C_end, P_col_buffer[k]) - C_col_buffer] += val_RA * P_elements[k];
     }
   }
+
+  if (!pattern_set)
+    A_coarse.generate_row_block_information();
 }
 
 } //namespace amg
@@ -0,0 +1,543 @@
+#ifndef VIENNACL_LINALG_HOST_BASED_BATCHED_SOLVE_HPP_
+#define VIENNACL_LINALG_HOST_BASED_BATCHED_SOLVE_HPP_
+
+/* =========================================================================
+   Copyright (c) 2010-2016, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+   Portions of this software are copyright by UChicago Argonne, LLC.
+
+                            -----------------
+                  ViennaCL - The Vienna Computing Library
+                            -----------------
+
+   Project Head:    Karl Rupp                   rupp@iue.tuwien.ac.at
+
+   (A list of authors and contributors can be found in the manual)
+
+   License:         MIT (X11), see file LICENSE in the base directory
+============================================================================= */
+
+/** @file viennacl/linalg/host_based/batched_solve.hpp
+    @brief Implementations of the iterative solvers for batches of small independent sparse systems using OpenMP on the CPU
+*/
+
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+#include "viennacl/forwards.h"
+#include "viennacl/batched_compressed_matrix.hpp"
+#include "viennacl/traits/size.hpp"
+#include "viennacl/traits/start.hpp"
+#include "viennacl/traits/stride.hpp"
+#include "viennacl/linalg/host_based/common.hpp"
+
+#ifdef VIENNACL_WITH_OPENMP
+#include <omp.h>
+#endif
+
+namespace viennacl
+{
+namespace linalg
+{
+namespace host_based
+{
+namespace detail
+{
+  /** @brief View of a single system of a batched_compressed_matrix */
+  template<typename NumericT>
+  struct batched_system
+  {
+    vcl_size_t           size;
+    unsigned int const * row_buffer;   // size + 1 entries, offsets into col_buffer and elements
+    unsigned int const * col_buffer;
+    NumericT     const * elements;
+    unsigned int         col_offset;   // first column of the system, subtracted from the column indices
+  };
+
+  /** @brief Returns the view of system i of the batch A */
+  template<typename NumericT>
+  batched_system<NumericT> get_batched_system(viennacl::batched_compressed_matrix<NumericT> const & A, vcl_size_t i)
+  {
+    unsigned int const * row_buffer = detail::extract_raw_pointer<unsigned int>(A.handle1());
+    unsigned int const * offsets    = detail::extract_raw_pointer<unsigned int>(A.handle3());
+
+    batched_system<NumericT> system;
+    system.size       = offsets[i+1] - offsets[i];
+    system.col_buffer = detail::extract_raw_pointer<unsigned int>(A.handle2());
+    system.elements   = detail::extract_raw_pointer<NumericT>(A.handle());
+    if (A.shared_pattern())
+    {
+      system.row_buffer = row_buffer;
+      system.elements  += i * A.pattern_nnz();
+      system.col_offset = 0;
+    }
+    else
+    {
+      system.row_buffer = row_buffer + offsets[i];
+      system.col_offset = offsets[i];
+    }
+    return system;
+  }
+
+  /** @brief Computes y = A * x for a single system */
+  template<typename NumericT>
+  void batched_prod(batched_system<NumericT> const & A, NumericT const * x, NumericT * y)
+  {
+    for (vcl_size_t row = 0; row < A.size; ++row)
+    {
+      NumericT sum = 0;
+      for (unsigned int k = A.row_buffer[row]; k < A.row_buffer[row+1]; ++k)
+        sum += A.elements[k] * x[A.col_buffer[k] - A.col_offset];
+      y[row] = sum;
+    }
+  }
+
+  template<typename NumericT>
+  NumericT batched_inner_prod(vcl_size_t n, NumericT const * x, NumericT const * y)
+  {
+    NumericT sum = 0;
+    for (vcl_size_t i = 0; i < n; ++i)
+      sum += x[i] * y[i];
+    return sum;
+  }
+
+  /** @brief Jacobi or ILU0 preconditioner for a single system of a batch. Reused by a thread for all its systems, so that the buffers are only allocated once. */
+  template<typename NumericT>
+  class batched_precond
+  {
+  public:
+    batched_precond() : type_(viennacl::linalg::BATCHED_NO_PRECOND) {}
+
+    /** @brief Sets up the preconditioner for system A. ILU0 expects the column indices within each row to be sorted. */
+    void init(viennacl::linalg::batched_precond_type type, batched_system<NumericT> const & A)
+    {
+      type_ = type;
+      A_    = A;
+
+      if (type_ == viennacl::linalg::BATCHED_JACOBI)
+      {
+        diag_.resize(A.size);
+        for (vcl_size_t row = 0; row < A.size; ++row)
+        {
+          diag_[row] = NumericT(1);
+          for (unsigned int k = A.row_buffer[row]; k < A.row_buffer[row+1]; ++k)
+            if (A.col_buffer[k] - A.col_offset == row && (A.elements[k] < 0 || A.elements[k] > 0))
+              diag_[row] = NumericT(1) / A.elements[k];
+        }
+      }
+      else if (type_ == viennacl::linalg::BATCHED_ILU0)
+        init_ilu0();
+    }
+
+    /** @brief Applies the preconditioner to x in place */
+    void apply(NumericT * x) const
+    {
+      if (type_ == viennacl::linalg::BATCHED_JACOBI)
+      {
+        for (vcl_size_t i = 0; i < A_.size; ++i)
+          x[i] *= diag_[i];
+      }
+      else if (type_ == viennacl::linalg::BATCHED_ILU0)
+      {
+        unsigned int base = A_.row_buffer[0];
+
+        // forward substitution with unit lower triangular L:
+        for (vcl_size_t row = 0; row < A_.size; ++row)
+        {
+          NumericT sum = x[row];
+          for (unsigned int k = A_.row_buffer[row]; k < diag_pos_[row]; ++k)
+            sum -= lu_[k - base] * x[A_.col_buffer[k] - A_.col_offset];
+          x[row] = sum;
+        }
+
+        // backward substitution with U:
+        for (vcl_size_t row2 = 0; row2 < A_.size; ++row2)
+        {
+          vcl_size_t row = A_.size - row2 - 1;
+          NumericT sum = x[row];
+          for (unsigned int k = diag_pos_[row]; k < A_.row_buffer[row+1]; ++k)
+            if (A_.col_buffer[k] - A_.col_offset > row)
+              sum -= lu_[k - base] * x[A_.col_buffer[k] - A_.col_offset];
+          x[row] = sum * diag_[row];
+        }
+      }
+    }
+
+  private:
+    /** @brief Incomplete LU factorization without fill-in in the IKJ variant. diag_ holds the inverse diagonal of U. */
+    void init_ilu0()
+    {
+      unsigned int base = A_.row_buffer[0];
+      lu_.assign(A_.elements + base, A_.elements + A_.row_buffer[A_.size]);
+      diag_.resize(A_.size);
+      diag_pos_.resize(A_.size);
+      position_.assign(A_.size, -1);
+
+      for (vcl_size_t row = 0; row < A_.size; ++row)
+      {
+        unsigned int row_begin = A_.row_buffer[row];
+        unsigned int row_end   = A_.row_buffer[row+1];
+
+        diag_pos_[row] = row_end;
+        for (unsigned int k = row_end; k > row_begin; --k)
+        {
+          vcl_size_t col = A_.col_buffer[k-1] - A_.col_offset;
+          position_[col] = long(k - 1 - base);
+          if (col >= row)
+            diag_pos_[row] = k - 1;
+        }
+
+        // eliminate entries left of the diagonal, in the order of increasing column index:
+        for (unsigned int k = row_begin; k < diag_pos_[row]; ++k)
+        {
+          vcl_size_t col = A_.col_buffer[k] - A_.col_offset;
+          NumericT factor = lu_[k - base] * diag_[col];
+          lu_[k - base] = factor;
+          for (unsigned int j = diag_pos_[col]; j < A_.row_buffer[col+1]; ++j)
+          {
+            long pos = position_[A_.col_buffer[j] - A_.col_offset];
+            if (A_.col_buffer[j] - A_.col_offset > col && pos >= 0)
+              lu_[vcl_size_t(pos)] -= factor * lu_[j - base];
+          }
+        }
+
+        bool has_diagonal = (diag_pos_[row] < row_end && A_.col_buffer[diag_pos_[row]] - A_.col_offset == row);
+        NumericT pivot = has_diagonal ? lu_[diag_pos_[row] - base] : NumericT(0);
+        diag_[row] = (pivot < 0 || pivot > 0) ? NumericT(1) / pivot : NumericT(1);
+
+        for (unsigned int k = row_begin; k < row_end; ++k)
+          position_[A_.col_buffer[k] - A_.col_offset] = -1;
+      }
+    }
+
+    viennacl::linalg::batched_precond_type type_;
+    batched_system<NumericT>  A_;
+    std::vector<NumericT>     diag_;
+    std::vector<NumericT>     lu_;
+    std::vector<unsigned int> diag_pos_;    // first entry of each row on or right of the diagonal
+    std::vector<long>         position_;
+  };
+
+  /** @brief Work vectors of a thread. Only grow, so that no allocations take place once the largest system has been processed. */
+  template<typename NumericT>
+  struct batched_workspace
+  {
+    std::vector<NumericT> b, x, r, z, p, q, s, t;
+    std::vector<NumericT> krylov_basis, hessenberg, rotation_cos, rotation_sin, g;
+  };
+
+  /** @brief Preconditioned CG for a single system with initial guess zero. Returns the number of iterations. */
+  template<typename NumericT, typename TagT>
+  unsigned int batched_cg(batched_system<NumericT> const & A, batched_precond<NumericT> const & precond, TagT const & tag,
+                          batched_workspace<NumericT> & ws, double & residual_norm, double threshold)
+  {
+    vcl_size_t n = A.size;
+    NumericT * x = &(ws.x[0]); NumericT * r = &(ws.r[0]); NumericT * z = &(ws.z[0]);
+    NumericT * p = &(ws.p[0]); NumericT * q = &(ws.q[0]);
+
+    std::fill(x, x + n, NumericT(0));
+    std::copy(ws.b.begin(), ws.b.begin() + long(n), r);
+    std::copy(r, r + n, z);
+    precond.apply(z);
+    std::copy(z, z + n, p);
+    NumericT rz = batched_inner_prod(n, r, z);
+
+    unsigned int iters = 0;
+    while (iters < tag.max_iterations() && residual_norm > threshold)
+    {
+      ++iters;
+      batched_prod(A, p, q);
+      NumericT pq = batched_inner_prod(n, p, q);
+      if (pq <= 0 && pq >= 0) // breakdown
+        break;
+
+      NumericT alpha = rz / pq;
+      for (vcl_size_t i = 0; i < n; ++i)
+      {
+        x[i] += alpha * p[i];
+        r[i] -= alpha * q[i];
+      }
+      residual_norm = std::sqrt(static_cast<double>(batched_inner_prod(n, r, r)));
+      if (residual_norm <= threshold)
+        break;
+
+      std::copy(r, r + n, z);
+      precond.apply(z);
+      NumericT rz_new = batched_inner_prod(n, r, z);
+      NumericT beta = rz_new / rz;
+      rz = rz_new;
+      for (vcl_size_t i = 0; i < n; ++i)
+        p[i] = z[i] + beta * p[i];
+    }
+    return iters;
+  }
+
+  /** @brief Right-preconditioned BiCGStab for a single system with initial guess zero. Returns the number of iterations. */
+  template<typename NumericT, typename TagT>
+  unsigned int batched_bicgstab(batched_system<NumericT> const & A, batched_precond<NumericT> const & precond, TagT const & tag,
+                                batched_workspace<NumericT> & ws, double & residual_norm, double threshold)
+  {
+    vcl_size_t n = A.size;
+    NumericT * x = &(ws.x[0]); NumericT * r = &(ws.r[0]); NumericT * r0star = &(ws.z[0]);
+    NumericT * p = &(ws.p[0]); NumericT * v = &(ws.q[0]); NumericT * s = &(ws.s[0]); NumericT * t = &(ws.t[0]);
+    NumericT * p_hat = &(ws.krylov_basis[0]); NumericT * s_hat = &(ws.krylov_basis[n]);
+
+    std::fill(x, x + n, NumericT(0));
+    std::copy(ws.b.begin(), ws.b.begin() + long(n), r);
+    std::copy(r, r + n, r0star);
+    std::copy(r, r + n, p);
+    NumericT rho = batched_inner_prod(n, r0star, r);
+
+    unsigned int iters = 0;
+    while (iters < tag.max_iterations() && residual_norm > threshold)
+    {
+      ++iters;
+
+      std::copy(p, p + n, p_hat);
+      precond.apply(p_hat);
+      batched_prod(A, p_hat, v);
+      NumericT r0star_v = batched_inner_prod(n, r0star, v);
+      if (r0star_v <= 0 && r0star_v >= 0) // breakdown
+        break;
+
+      NumericT alpha = rho / r0star_v;
+      for (vcl_size_t i = 0; i < n; ++i)
+        s[i] = r[i] - alpha * v[i];
+
+      double norm_s = std::sqrt(static_cast<double>(batched_inner_prod(n, s, s)));
+      if (norm_s <= threshold)
+      {
+        for (vcl_size_t i = 0; i < n; ++i)
+          x[i] += alpha * p_hat[i];
+        residual_norm = norm_s;
+        break;
+      }
+
+      std::copy(s, s + n, s_hat);
+      precond.apply(s_hat);
+      batched_prod(A, s_hat, t);
+      NumericT tt = batched_inner_prod(n, t, t);
+      NumericT omega = (tt > 0) ? batched_inner_prod(n, t, s) / tt : NumericT(0);
+
+      for (vcl_size_t i = 0; i < n; ++i)
+      {
+        x[i] += alpha * p_hat[i] + omega * s_hat[i];
+        r[i]  = s[i] - omega * t[i];
+      }
+      residual_norm = std::sqrt(static_cast<double>(batched_inner_prod(n, r, r)));
+      if (residual_norm <= threshold || (omega <= 0 && omega >= 0))
+        break;
+
+      NumericT rho_new = batched_inner_prod(n, r0star, r);
+      if (rho_new <= 0 && rho_new >= 0) // breakdown
+        break;
+      NumericT beta = (rho_new / rho) * (alpha / omega);
+      rho = rho_new;
+      for (vcl_size_t i = 0; i < n; ++i)
+        p[i] = r[i] + beta * (p[i] - omega * v[i]);
+    }
+    return iters;
+  }
+
+  /** @brief Right-preconditioned restarted GMRES for a single system with initial guess zero. Returns the number of iterations (Krylov vectors built). */
+  template<typename NumericT, typename TagT>
+  unsigned int batched_gmres(batched_system<NumericT> const & A, batched_precond<NumericT> const & precond, TagT const & tag,
+                             batched_workspace<NumericT> & ws, double & residual_norm, double threshold)
+  {
+    vcl_size_t n = A.size;
+    vcl_size_t m = std::max<vcl_size_t>(std::min<vcl_size_t>(tag.krylov_dim(), n), 1);
+    NumericT * x = &(ws.x[0]); NumericT * r = &(ws.r[0]); NumericT * z = &(ws.z[0]); NumericT * w = &(ws.q[0]);
+    NumericT * V = &(ws.krylov_basis[0]);            // (m+1) basis vectors of size n
+    NumericT * H = &(ws.hessenberg[0]);              // column-major, (m+1) x m
+    NumericT * c = &(ws.rotation_cos[0]);
+    NumericT * s = &(ws.rotation_sin[0]);
+    NumericT * g = &(ws.g[0]);
+
+    std::fill(x, x + n, NumericT(0));
+    std::copy(ws.b.begin(), ws.b.begin() + long(n), r);
+
+    unsigned int iters = 0;
+    while (iters < tag.max_iterations() && residual_norm > threshold)
+    {
+      // Arnoldi process with modified Gram-Schmidt, Givens rotations for the least squares problem:
+      for (vcl_size_t i = 0; i < n; ++i)
+        V[i] = r[i] / NumericT(residual_norm);
+      std::fill(g, g + m + 1, NumericT(0));
+      g[0] = NumericT(residual_norm);
+
+      vcl_size_t k = 0;
+      bool breakdown = false;
+      while (k < m && iters < tag.max_iterations())
+      {
+        ++iters;
+        NumericT * h = H + k * (m + 1);
+
+        std::copy(V + k * n, V + (k + 1) * n, z);
+        precond.apply(z);
+        batched_prod(A, z, w);
+        for (vcl_size_t i = 0; i <= k; ++i)
+        {
+          h[i] = batched_inner_prod(n, w, V + i * n);
+          for (vcl_size_t j = 0; j < n; ++j)
+            w[j] -= h[i] * V[i * n + j];
+        }
+        h[k+1] = std::sqrt(batched_inner_prod(n, w, w));
+        if (h[k+1] > 0)
+          for (vcl_size_t j = 0; j < n; ++j)
+            V[(k + 1) * n + j] = w[j] / h[k+1];
+        else
+          breakdown = true; // Krylov space is invariant, solution is exact
+
+        for (vcl_size_t i = 0; i < k; ++i)
+        {
+          NumericT temp = c[i] * h[i] + s[i] * h[i+1];
+          h[i+1] = -s[i] * h[i] + c[i] * h[i+1];
+          h[i] = temp;
+        }
+        NumericT denom = std::sqrt(h[k] * h[k] + h[k+1] * h[k+1]);
+        if (denom <= 0) // singular system
+        {
+          breakdown = true;
+          break;
+        }
+        c[k] = h[k] / denom;
+        s[k] = h[k+1] / denom;
+        h[k] = denom;
+        h[k+1] = 0;
+        g[k+1] = -s[k] * g[k];
+        g[k]   =  c[k] * g[k];
+        ++k;
+
+        if (std::fabs(static_cast<double>(g[k])) <= threshold || breakdown)
+          break;
+      }
+
+      // x += M^{-1} V y with H y = g:
+      for (vcl_size_t i2 = 0; i2 < k; ++i2)
+      {
+        vcl_size_t i = k - i2 - 1;
+        for (vcl_size_t j = i + 1; j < k; ++j)
+          g[i] -= H[j * (m + 1) + i] * g[j];
+        g[i] /= H[i * (m + 1) + i];
+      }
+      std::fill(z, z + n, NumericT(0));
+      for (vcl_size_t i = 0; i < k; ++i)
+        for (vcl_size_t j = 0; j < n; ++j)
+          z[j] += g[i] * V[i * n + j];
+      precond.apply(z);
+      for (vcl_size_t j = 0; j < n; ++j)
+        x[j] += z[j];
+
+      // true residual for the restart and the convergence check:
+      batched_prod(A, x, r);
+      for (vcl_size_t j = 0; j < n; ++j)
+        r[j] = ws.b[j] - r[j];
+      residual_norm = std::sqrt(static_cast<double>(batched_inner_prod(n, r, r)));
+
+      if (breakdown && k == 0)
+        break;
+    }
+    return iters;
+  }
+}
+
+
+/** @brief Solves all systems of a batch independently, one system per thread.
+*
+* The right hand sides and solutions of all systems are concatenated in b and x. Threads pick systems dynamically, since the cost varies with the size and the number of iterations of each system.
+*
+* @param A     The batch of systems
+* @param b     The concatenated right hand sides
+* @param x     The concatenated solutions (output)
+* @param tag   Solver, preconditioner and tolerances. Receives the number of iterations, the relative residual, and the convergence flag of each system.
+*/
+template<typename NumericT, typename TagT>
+void batched_solve(viennacl::batched_compressed_matrix<NumericT> const & A,
+                   viennacl::vector_base<NumericT> const & b,
+                   viennacl::vector_base<NumericT> & x,
+                   TagT const & tag)
+{
+  NumericT const * b_buf = detail::extract_raw_pointer<NumericT>(b.handle());
+  NumericT       * x_buf = detail::extract_raw_pointer<NumericT>(x.handle());
+  vcl_size_t b_start = viennacl::traits::start(b), b_inc = viennacl::traits::stride(b);
+  vcl_size_t x_start = viennacl::traits::start(x), x_inc = viennacl::traits::stride(x);
+
+  long batch_size = static_cast<long>(A.batch_size());
+
+#ifdef VIENNACL_WITH_OPENMP
+  #pragma omp parallel
+#endif
+  {
+    detail::batched_workspace<NumericT> ws;
+    detail::batched_precond<NumericT>   precond;
+
+#ifdef VIENNACL_WITH_OPENMP
+    #pragma omp for schedule(dynamic)
+#endif
+    for (long i = 0; i < batch_size; ++i)
+    {
+      detail::batched_system<NumericT> system = detail::get_batched_system(A, vcl_size_t(i));
+      vcl_size_t n     = system.size;
+      vcl_size_t start = A.system_start(vcl_size_t(i));
+      vcl_size_t m     = std::max<vcl_size_t>(std::min<vcl_size_t>(tag.krylov_dim(), n), 1);
+
+      if (n == 0)
+      {
+        tag.result(vcl_size_t(i), 0, 0, true);
+        continue;
+      }
+
+      // buffers only grow, hence only few allocations per thread:
+      if (ws.b.size() < n)
+      {
+        ws.b.resize(n); ws.x.resize(n); ws.r.resize(n); ws.z.resize(n);
+        ws.p.resize(n); ws.q.resize(n); ws.s.resize(n); ws.t.resize(n);
+      }
+      vcl_size_t basis_size = (tag.solver() == viennacl::linalg::BATCHED_GMRES) ? (m + 1) * n : 2 * n;
+      if (tag.solver() != viennacl::linalg::BATCHED_CG && ws.krylov_basis.size() < basis_size)
+        ws.krylov_basis.resize(basis_size);
+      if (tag.solver() == viennacl::linalg::BATCHED_GMRES && ws.hessenberg.size() < (m + 1) * m)
+      {
+        ws.hessenberg.resize((m + 1) * m);
+        ws.rotation_cos.resize(m + 1);
+        ws.rotation_sin.resize(m + 1);
+        ws.g.resize(m + 1);
+      }
+
+      for (vcl_size_t j = 0; j < n; ++j)
+        ws.b[j] = b_buf[b_start + (start + j) * b_inc];
+
+      double norm_b = std::sqrt(static_cast<double>(detail::batched_inner_prod(n, &(ws.b[0]), &(ws.b[0]))));
+      double threshold = std::max(tag.tolerance() * norm_b, tag.abs_tolerance());
+      double residual_norm = norm_b;
+      unsigned int iters = 0;
+
+      if (norm_b > threshold)
+      {
+        precond.init(tag.preconditioner(), system);
+        switch (tag.solver())
+        {
+          case viennacl::linalg::BATCHED_BICGSTAB: iters = detail::batched_bicgstab(system, precond, tag, ws, residual_norm, threshold); break;
+          case viennacl::linalg::BATCHED_GMRES:    iters = detail::batched_gmres(system, precond, tag, ws, residual_norm, threshold);    break;
+          default:                                 iters = detail::batched_cg(system, precond, tag, ws, residual_norm, threshold);       break;
+        }
+      }
+      else
+        std::fill(ws.x.begin(), ws.x.begin() + long(n), NumericT(0));
+
+      for (vcl_size_t j = 0; j < n; ++j)
+        x_buf[x_start + (start + j) * x_inc] = ws.x[j];
+
+      tag.result(vcl_size_t(i), iters, (norm_b > 0) ? residual_norm / norm_b : 0, residual_norm <= threshold);
+    }
+  }
+}
+
+} // namespace host_based
+} //namespace linalg
+} //namespace viennacl
+
+
+#endif
@@ -54,6 +54,7 @@ namespace detail
     * This routines computes for a matrix A and vectors 'p', 'Ap', and 'r0':
     *   Ap = prod(A, p);
     * and computes the two reduction stages for computing inner_prod(p,Ap), inner_prod(Ap,Ap), inner_prod(Ap, r0)
+    * If 'with_inner_prod_pp' is set, inner_prod(p,p) is written to the first entry of the buffer.
     */
   template<typename NumericT>
   void pipelined_prod_impl(compressed_matrix<NumericT> const & A,
@@ -62,7 +63,8 @@ namespace detail
                            NumericT const * r0star,
                            vector_base<NumericT> & inner_prod_buffer,
                            vcl_size_t buffer_chunk_size,
-                           vcl_size_t buffer_chunk_offset)
+                           vcl_size_t buffer_chunk_offset,
+                           bool with_inner_prod_pp = false)
   {
     typedef NumericT        value_type;
 
@@ -76,9 +78,10 @@ namespace detail
     value_type inner_prod_ApAp = 0;
     value_type inner_prod_pAp = 0;
     value_type inner_prod_Ap_r0star = 0;
+    value_type inner_prod_pp = 0;
 
 #ifdef VIENNACL_WITH_OPENMP
-    #pragma omp parallel for reduction(+: inner_prod_ApAp, inner_prod_pAp, inner_prod_Ap_r0star)
+    #pragma omp parallel for schedule(static) reduction(+: inner_prod_ApAp, inner_prod_pAp, inner_prod_Ap_r0star, inner_prod_pp)
 #endif
     for (long row = 0; row < static_cast<long>(A.size1()); ++row)
     {
@@ -93,6 +96,7 @@ namespace detail
       Ap_buf[static_cast<vcl_size_t>(row)] = dot_prod;
       inner_prod_ApAp += dot_prod * dot_prod;
       inner_prod_pAp  += val_p_diag * dot_prod;
+      inner_prod_pp   += val_p_diag * val_p_diag;
       inner_prod_Ap_r0star += r0star ? dot_prod * r0star[static_cast<vcl_size_t>(row)] : value_type(0);
     }
 
@@ -100,6 +104,8 @@ namespace detail
     data_buffer[2 * buffer_chunk_size] = inner_prod_pAp;
     if (r0star)
       data_buffer[buffer_chunk_offset] = inner_prod_Ap_r0star;
+    if (with_inner_prod_pp)
+      data_buffer[0] = inner_prod_pp;
   }
 
 
@@ -109,6 +115,7 @@ namespace detail
     * This routines computes for a matrix A and vectors 'p', 'Ap', and 'r0':
     *   Ap = prod(A, p);
     * and computes the two reduction stages for computing inner_prod(p,Ap), inner_prod(Ap,Ap), inner_prod(Ap, r0)
+    * If 'with_inner_prod_pp' is set, inner_prod(p,p) is written to the first entry of the buffer.
     */
   template<typename NumericT>
   void pipelined_prod_impl(coordinate_matrix<NumericT> const & A,
@@ -117,7 +124,8 @@ namespace detail
                            NumericT const * r0star,
                            vector_base<NumericT> & inner_prod_buffer,
                            vcl_size_t buffer_chunk_size,
-                           vcl_size_t buffer_chunk_offset)
+                           vcl_size_t buffer_chunk_offset,
+                           bool with_inner_prod_pp = false)
   {
     typedef NumericT        value_type;
 
@@ -140,6 +148,7 @@ namespace detail
     value_type inner_prod_ApAp = 0;
     value_type inner_prod_pAp = 0;
     value_type inner_prod_Ap_r0star = 0;
+    value_type inner_prod_pp = 0;
     for (vcl_size_t i = 0; i<Ap.size(); ++i)
     {
       NumericT value_Ap = Ap_buf[i];
@@ -147,6 +156,7 @@ namespace detail
 
       inner_prod_ApAp += value_Ap * value_Ap;
       inner_prod_pAp  += value_Ap * value_p;
+      inner_prod_pp   += value_p * value_p;
       inner_prod_Ap_r0star += r0star ? value_Ap * r0star[i] : value_type(0);
     }
 
@@ -154,6 +164,8 @@ namespace detail
     data_buffer[2 * buffer_chunk_size] = inner_prod_pAp;
     if (r0star)
       data_buffer[buffer_chunk_offset] = inner_prod_Ap_r0star;
+    if (with_inner_prod_pp)
+      data_buffer[0] = inner_prod_pp;
   }
 
 
@@ -162,6 +174,7 @@ namespace detail
     * This routines computes for a matrix A and vectors 'p', 'Ap', and 'r0':
     *   Ap = prod(A, p);
     * and computes the two reduction stages for computing inner_prod(p,Ap), inner_prod(Ap,Ap), inner_prod(Ap, r0)
+    * If 'with_inner_prod_pp' is set, inner_prod(p,p) is written to the first entry of the buffer.
     */
   template<typename NumericT>
   void pipelined_prod_impl(ell_matrix<NumericT> const & A,
@@ -170,7 +183,8 @@ namespace detail
                            NumericT const * r0star,
                            vector_base<NumericT> & inner_prod_buffer,
                            vcl_size_t buffer_chunk_size,
-                           vcl_size_t buffer_chunk_offset)
+                           vcl_size_t buffer_chunk_offset,
+                           bool with_inner_prod_pp = false)
   {
     typedef NumericT     value_type;
 
@@ -183,9 +197,10 @@ namespace detail
     value_type inner_prod_ApAp = 0;
     value_type inner_prod_pAp = 0;
     value_type inner_prod_Ap_r0star = 0;
+    value_type inner_prod_pp = 0;
 
 #ifdef VIENNACL_WITH_OPENMP
-    #pragma omp parallel for reduction(+: inner_prod_ApAp, inner_prod_pAp, inner_prod_Ap_r0star)
+    #pragma omp parallel for schedule(static) reduction(+: inner_prod_ApAp, inner_prod_pAp, inner_prod_Ap_r0star, inner_prod_pp)
 #endif
     for (vcl_size_t row = 0; row < A.size1(); ++row)
     {
@@ -204,6 +219,7 @@ namespace detail
       Ap_buf[row] = sum;
       inner_prod_ApAp += sum * sum;
       inner_prod_pAp  += val_p_diag * sum;
+      inner_prod_pp   += val_p_diag * val_p_diag;
       inner_prod_Ap_r0star += r0star ? sum * r0star[row] : value_type(0);
     }
 
@@ -211,6 +227,8 @@ namespace detail
     data_buffer[2 * buffer_chunk_size] = inner_prod_pAp;
     if (r0star)
       data_buffer[buffer_chunk_offset] = inner_prod_Ap_r0star;
+    if (with_inner_prod_pp)
+      data_buffer[0] = inner_prod_pp;
   }
 
 
@@ -219,6 +237,7 @@ namespace detail
     * This routines computes for a matrix A and vectors 'p', 'Ap', and 'r0':
     *   Ap = prod(A, p);
     * and computes the two reduction stages for computing inner_prod(p,Ap), inner_prod(Ap,Ap), inner_prod(Ap, r0)
+    * If 'with_inner_prod_pp' is set, inner_prod(p,p) is written to the first entry of the buffer.
     */
   template<typename NumericT, typename IndexT>
   void pipelined_prod_impl(sliced_ell_matrix<NumericT, IndexT> const & A,
@@ -227,7 +246,8 @@ namespace detail
                            NumericT const * r0star,
                            vector_base<NumericT> & inner_prod_buffer,
                            vcl_size_t buffer_chunk_size,
-                           vcl_size_t buffer_chunk_offset)
+                           vcl_size_t buffer_chunk_offset,
+                           bool with_inner_prod_pp = false)
   {
     typedef NumericT     value_type;
 
@@ -239,14 +259,15 @@ namespace detail
     IndexT     const * block_start       = detail::extract_raw_pointer<IndexT>(A.handle3());
     value_type         * data_buffer     = detail::extract_raw_pointer<value_type>(inner_prod_buffer);
 
-    vcl_size_t num_blocks = A.size1() / A.rows_per_block() + 1;
+    vcl_size_t num_blocks = (A.size1() > 0) ? (A.size1() - 1) / A.rows_per_block() + 1 : 0;
 
     value_type inner_prod_ApAp = 0;
     value_type inner_prod_pAp = 0;
     value_type inner_prod_Ap_r0star = 0;
+    value_type inner_prod_pp = 0;
 
 #ifdef VIENNACL_WITH_OPENMP
-    #pragma omp parallel for reduction(+: inner_prod_ApAp, inner_prod_pAp, inner_prod_Ap_r0star)
+    #pragma omp parallel for schedule(static) reduction(+: inner_prod_ApAp, inner_prod_pAp, inner_prod_Ap_r0star, inner_prod_pp)
 #endif
     for (vcl_size_t block_idx = 0; block_idx < num_blocks; ++block_idx)
     {
@@ -280,6 +301,7 @@ namespace detail
           Ap_buf[row] = row_result;
           inner_prod_ApAp += row_result * row_result;
           inner_prod_pAp  += p_buf[row] * row_result;
+          inner_prod_pp   += p_buf[row] * p_buf[row];
           inner_prod_Ap_r0star += r0star ? row_result * r0star[row] : value_type(0);
         }
       }
@@ -289,6 +311,8 @@ namespace detail
     data_buffer[2 * buffer_chunk_size] = inner_prod_pAp;
     if (r0star)
       data_buffer[buffer_chunk_offset] = inner_prod_Ap_r0star;
+    if (with_inner_prod_pp)
+      data_buffer[0] = inner_prod_pp;
   }
 
 
@@ -297,6 +321,7 @@ namespace detail
     * This routines computes for a matrix A and vectors 'p', 'Ap', and 'r0':
     *   Ap = prod(A, p);
     * and computes the two reduction stages for computing inner_prod(p,Ap), inner_prod(Ap,Ap), inner_prod(Ap, r0)
+    * If 'with_inner_prod_pp' is set, inner_prod(p,p) is written to the first entry of the buffer.
     */
   template<typename NumericT>
   void pipelined_prod_impl(hyb_matrix<NumericT> const & A,
@@ -305,7 +330,8 @@ namespace detail
                            NumericT const * r0star,
                            vector_base<NumericT> & inner_prod_buffer,
                            vcl_size_t buffer_chunk_size,
-                           vcl_size_t buffer_chunk_offset)
+                           vcl_size_t buffer_chunk_offset,
+                           bool with_inner_prod_pp = false)
   {
     typedef NumericT     value_type;
     typedef unsigned int index_type;
@@ -322,9 +348,10 @@ namespace detail
     value_type inner_prod_ApAp = 0;
     value_type inner_prod_pAp = 0;
     value_type inner_prod_Ap_r0star = 0;
+    value_type inner_prod_pp = 0;
 
 #ifdef VIENNACL_WITH_OPENMP
-    #pragma omp parallel for reduction(+: inner_prod_ApAp, inner_prod_pAp, inner_prod_Ap_r0star)
+    #pragma omp parallel for schedule(static) reduction(+: inner_prod_ApAp, inner_prod_pAp, inner_prod_Ap_r0star, inner_prod_pp)
 #endif
     for (vcl_size_t row = 0; row < A.size1(); ++row)
     {
@@ -355,6 +382,7 @@ namespace detail
       Ap_buf[row] = sum;
       inner_prod_ApAp += sum * sum;
       inner_prod_pAp  += val_p_diag * sum;
+      inner_prod_pp   += val_p_diag * val_p_diag;
       inner_prod_Ap_r0star += r0star ? sum * r0star[row] : value_type(0);
     }
 
@@ -362,6 +390,8 @@ namespace detail
     data_buffer[2 * buffer_chunk_size] = inner_prod_pAp;
     if (r0star)
       data_buffer[buffer_chunk_offset] = inner_prod_Ap_r0star;
+    if (with_inner_prod_pp)
+      data_buffer[0] = inner_prod_pp;
   }
 
 } // namespace detail
@@ -397,7 +427,7 @@ void pipelined_cg_vector_update(vector_base<NumericT> & result,
 
   value_type inner_prod_r = 0;
 #ifdef VIENNACL_WITH_OPENMP
-    #pragma omp parallel for reduction(+: inner_prod_r)
+    #pragma omp parallel for schedule(static) reduction(+: inner_prod_r)
 #endif
   for (long i = 0; i < static_cast<long>(size); ++i)
   {
@@ -505,6 +535,22 @@ void pipelined_cg_prod(hyb_matrix<NumericT> const & A,
   viennacl::linalg::host_based::detail::pipelined_prod_impl(A, p, Ap, PtrType(NULL), inner_prod_buffer, inner_prod_buffer.size() / 3, 0);
 }
 
+/** @brief Performs a fused matrix-vector product for an efficient pipelined MINRES algorithm.
+  *
+  * This routines computes for a sparse matrix A and vectors 'p' and 'Ap':
+  *   Ap = prod(A, p);
+  * and computes the reduction stages for computing inner_prod(p,p), inner_prod(p,Ap), inner_prod(Ap,Ap)
+  */
+template<typename MatrixT, typename NumericT>
+void pipelined_minres_prod(MatrixT const & A,
+                           vector_base<NumericT> const & p,
+                           vector_base<NumericT> & Ap,
+                           vector_base<NumericT> & inner_prod_buffer)
+{
+  typedef NumericT const *    PtrType;
+  viennacl::linalg::host_based::detail::pipelined_prod_impl(A, p, Ap, PtrType(NULL), inner_prod_buffer, inner_prod_buffer.size() / 3, 0, true);
+}
+
 //////////////////////////
 
 
@@ -547,7 +593,7 @@ void pipelined_bicgstab_update_s(vector_base<NumericT> & s,
   value_type inner_prod_s = 0;
 
 #ifdef VIENNACL_WITH_OPENMP
-    #pragma omp parallel for reduction(+: inner_prod_s)
+    #pragma omp parallel for schedule(static) reduction(+: inner_prod_s)
 #endif
   for (long i = 0; i < static_cast<long>(size); ++i)
   {
@@ -593,7 +639,7 @@ void pipelined_bicgstab_update_s(vector_base<NumericT> & s,
    value_type inner_prod_r_r0star = 0;
 
 #ifdef VIENNACL_WITH_OPENMP
-    #pragma omp parallel for reduction(+: inner_prod_r_r0star)
+    #pragma omp parallel for schedule(static) reduction(+: inner_prod_r_r0star)
 #endif
    for (long i = 0; i < static_cast<long>(size); ++i)
    {
@@ -763,7 +809,7 @@ void pipelined_gmres_normalize_vk(vector_base<T> & v_k,
   value_type inner_prod_r_dot_vk = 0;
 
 #ifdef VIENNACL_WITH_OPENMP
-    #pragma omp parallel for reduction(+: inner_prod_r_dot_vk)
+    #pragma omp parallel for schedule(static) reduction(+: inner_prod_r_dot_vk)
 #endif
   for (long i = 0; i < static_cast<long>(size); ++i)
   {
@@ -817,9 +863,9 @@ void pipelined_gmres_gram_schmidt_stage1(vector_base<T> const & device_krylov_ba
     thread_count = static_cast<long>(omp_get_num_threads());
 #endif
 
-    long work_per_thread = long(v_k_size - 1) / thread_count;
+    long work_per_thread = long(v_k_size - 1) / thread_count + 1;
     long thread_start = work_per_thread * thread_id;
-    long thread_stop  = std::min<long>(work_per_thread * (thread_id + 1), long(v_k_size));
+    long thread_stop  = std::min<long>(thread_start + work_per_thread, long(v_k_size));
 
     T *thread_scratchpad = &(scratchpad[k * thread_id]);
 
@@ -873,7 +919,7 @@ void pipelined_gmres_gram_schmidt_stage2(vector_base<T> & device_krylov_basis,
   // Step 2: Compute v_k -= <v_i, v_k> v_i and reduction on ||v_k||:
   value_type norm_vk = 0;
 #ifdef VIENNACL_WITH_OPENMP
-  #pragma omp parallel for reduction(+: norm_vk)
+  #pragma omp parallel for schedule(static) reduction(+: norm_vk)
 #endif
   for (vcl_size_t i = 0; i < v_k_size; ++i)
   {
@@ -911,7 +957,7 @@ void pipelined_gmres_update_result(vector_base<T> & result,
   value_type const * data_coefficients = detail::extract_raw_pointer<value_type>(coefficients);
 
 #ifdef VIENNACL_WITH_OPENMP
-  #pragma omp parallel for
+  #pragma omp parallel for schedule(static)
 #endif
   for (vcl_size_t i = 0; i < v_k_size; ++i)
   {
@@ -937,6 +983,112 @@ void pipelined_gmres_prod(MatrixType const & A,
 }
 
 
+namespace detail
+{
+  /** @brief Implementation of one Jacobi-preconditioned Chebyshev step for CSR arrays with values of type StorageT. Arithmetic is carried out in NumericT.
+    *
+    * Computes in a single sweep over the rows, with x_old = x:
+    *   r = rhs - A * x_old;
+    *   d = alpha * d + beta * D^{-1} r;
+    *   x = x_old + d;
+    * and returns inner_prod(r, r).
+    */
+  template<typename NumericT, typename StorageT>
+  NumericT chebyshev_sweep_impl(vcl_size_t num_rows,
+                                unsigned int const * row_buffer,
+                                unsigned int const * col_buffer,
+                                StorageT const * elements,
+                                vector_base<NumericT> & x,
+                                vector_base<NumericT> & x_backup,
+                                vector_base<NumericT> & d,
+                                vector_base<NumericT> const & rhs,
+                                NumericT alpha,
+                                NumericT beta)
+  {
+    x_backup = x;
+
+    NumericT       * x_buf     = detail::extract_raw_pointer<NumericT>(x.handle()) + viennacl::traits::start(x);
+    NumericT const * x_old_buf = detail::extract_raw_pointer<NumericT>(x_backup.handle()) + viennacl::traits::start(x_backup);
+    NumericT       * d_buf     = detail::extract_raw_pointer<NumericT>(d.handle()) + viennacl::traits::start(d);
+    NumericT const * rhs_buf   = detail::extract_raw_pointer<NumericT>(rhs.handle()) + viennacl::traits::start(rhs);
+
+    vcl_size_t x_inc     = viennacl::traits::stride(x);
+    vcl_size_t x_old_inc = viennacl::traits::stride(x_backup);
+    vcl_size_t d_inc     = viennacl::traits::stride(d);
+    vcl_size_t rhs_inc   = viennacl::traits::stride(rhs);
+
+    bool first_step = !(alpha > 0 || alpha < 0); // d may hold garbage from a previous run, hence do not touch it
+
+    NumericT inner_prod_r = 0;
+#ifdef VIENNACL_WITH_OPENMP
+    #pragma omp parallel for schedule(static) reduction(+: inner_prod_r)
+#endif
+    for (long row2 = 0; row2 < static_cast<long>(num_rows); ++row2)
+    {
+      vcl_size_t row = static_cast<vcl_size_t>(row2);
+      vcl_size_t row_end = row_buffer[row+1];
+
+      NumericT sum  = 0;
+      NumericT diag = 1;
+      for (vcl_size_t i = row_buffer[row]; i < row_end; ++i)
+      {
+        NumericT value = static_cast<NumericT>(elements[i]);
+        sum += value * x_old_buf[col_buffer[i] * x_old_inc];
+        if (col_buffer[i] == row)
+          diag = value;
+      }
+
+      NumericT r = rhs_buf[row * rhs_inc] - sum;
+      NumericT d_new = first_step ? beta * r / diag : alpha * d_buf[row * d_inc] + beta * r / diag;
+
+      d_buf[row * d_inc] = d_new;
+      x_buf[row * x_inc] = x_old_buf[row * x_old_inc] + d_new;
+      inner_prod_r += r * r;
+    }
+
+    return inner_prod_r;
+  }
+} // namespace detail
+
+/** @brief Performs one step of the Jacobi-preconditioned Chebyshev iteration for a compressed_matrix, fusing the residual computation and the vector updates into the matrix-vector product.
+  *
+  * Computes r = rhs - A * x, d = alpha * d + beta * D^{-1} r, x += d, where D is the diagonal of A, and returns inner_prod(r, r).
+  * The vector 'x_backup' is used as temporary storage.
+  */
+template<typename NumericT, unsigned int AlignmentV>
+NumericT chebyshev_sweep(compressed_matrix<NumericT, AlignmentV> const & A,
+                         vector_base<NumericT> & x,
+                         vector_base<NumericT> & x_backup,
+                         vector_base<NumericT> & d,
+                         vector_base<NumericT> const & rhs,
+                         NumericT alpha,
+                         NumericT beta)
+{
+  return detail::chebyshev_sweep_impl(A.size1(),
+                                      detail::extract_raw_pointer<unsigned int>(A.handle1()),
+                                      detail::extract_raw_pointer<unsigned int>(A.handle2()),
+                                      detail::extract_raw_pointer<NumericT>(A.handle()),
+                                      x, x_backup, d, rhs, alpha, beta);
+}
+
+/** @brief Performs one step of the Jacobi-preconditioned Chebyshev iteration for a matrix with values stored in reduced precision. See chebyshev_sweep() for compressed_matrix. */
+template<typename NumericT, typename StorageT>
+NumericT chebyshev_sweep(mixed_compressed_matrix<NumericT, StorageT> const & A,
+                         vector_base<NumericT> & x,
+                         vector_base<NumericT> & x_backup,
+                         vector_base<NumericT> & d,
+                         vector_base<NumericT> const & rhs,
+                         NumericT alpha,
+                         NumericT beta)
+{
+  return detail::chebyshev_sweep_impl(A.size1(),
+                                      detail::extract_raw_pointer<unsigned int>(A.handle1()),
+                                      detail::extract_raw_pointer<unsigned int>(A.handle2()),
+                                      detail::extract_raw_pointer<StorageT>(A.handle()),
+                                      x, x_backup, d, rhs, alpha, beta);
+}
+
+
 } //namespace host_based
 } //namespace linalg
 } //namespace viennacl
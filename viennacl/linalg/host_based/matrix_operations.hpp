@@ -1294,31 +1294,32 @@ namespace detail
         //  C(block_idx_i, block_idx_i) += A(block_idx_i, block_idx_k) * B(block_idx_k, block_idx_j)
         for (vcl_size_t block_idx_k=0; block_idx_k<num_blocks_A2; ++block_idx_k)
         {
-          // flush buffers:
-          std::fill(buffer_A.begin(), buffer_A.end(), NumericT(0));
-          std::fill(buffer_B.begin(), buffer_B.end(), NumericT(0));
-
           vcl_size_t offset_k = block_idx_k*blocksize;
 
+          // extents of the current blocks (smaller than blocksize at the boundary, e.g. for tall and skinny matrices):
+          vcl_size_t block_size_i = std::min(offset_i + blocksize, C_size1) - offset_i;
+          vcl_size_t block_size_j = std::min(offset_j + blocksize, C_size2) - offset_j;
+          vcl_size_t block_size_k = std::min(offset_k + blocksize, A_size2) - offset_k;
+
           // load current data:
-          for (vcl_size_t i = offset_i; i < std::min(offset_i + blocksize, C_size1); ++i)
-            for (vcl_size_t k = offset_k; k < std::min(offset_k + blocksize, A_size2); ++k)
+          for (vcl_size_t i = offset_i; i < offset_i + block_size_i; ++i)
+            for (vcl_size_t k = offset_k; k < offset_k + block_size_k; ++k)
               buffer_A[(i - offset_i) * blocksize + (k - offset_k)] = A(i, k);
 
-          for (vcl_size_t j = offset_j; j < std::min(offset_j + blocksize, C_size2); ++j)
-            for (vcl_size_t k = offset_k; k < std::min(offset_k + blocksize, A_size2); ++k)
+          for (vcl_size_t j = offset_j; j < offset_j + block_size_j; ++j)
+            for (vcl_size_t k = offset_k; k < offset_k + block_size_k; ++k)
               buffer_B[(k - offset_k) + (j - offset_j) * blocksize] = B(k, j);
 
           // multiply (this is the hot spot in terms of flops)
-          for (vcl_size_t i = 0; i < blocksize; ++i)
+          for (vcl_size_t i = 0; i < block_size_i; ++i)
           {
             NumericT const * ptrA = &(buffer_A[i*blocksize]);
-            for (vcl_size_t j = 0; j < blocksize; ++j)
+            for (vcl_size_t j = 0; j < block_size_j; ++j)
             {
               NumericT const * ptrB = &(buffer_B[j*blocksize]);
 
               NumericT temp = NumericT(0);
-              for (vcl_size_t k = 0; k < blocksize; ++k)
+              for (vcl_size_t k = 0; k < block_size_k; ++k)
                 temp += ptrA[k] * ptrB[k];  // buffer_A[i*blocksize + k] * buffer_B[k + j*blocksize];
 
               buffer_C[i*blocksize + j] += temp;
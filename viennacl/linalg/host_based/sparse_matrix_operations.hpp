@@ -26,17 +26,26 @@
 #include "viennacl/scalar.hpp"
 #include "viennacl/vector.hpp"
 #include "viennacl/tools/tools.hpp"
+#include "viennacl/tools/adapter.hpp"
 #include "viennacl/linalg/host_based/common.hpp"
 #include "viennacl/linalg/host_based/vector_operations.hpp"
 
 #include "viennacl/linalg/host_based/spgemm_vector.hpp"
+#include "viennacl/linalg/host_based/spgemm_accumulator.hpp"
+#include "viennacl/linalg/spgemm_plan.hpp"
 
 #include <vector>
+#include <cstring>
+#include <algorithm>
 
 #ifdef VIENNACL_WITH_OPENMP
 #include <omp.h>
 #endif
 
+#ifdef VIENNACL_WITH_AVX2
+#include "immintrin.h"
+#endif
+
 namespace viennacl
 {
 namespace linalg
@@ -119,7 +128,7 @@ void prod_impl(const viennacl::compressed_matrix<NumericT, AlignmentV> & mat,
   unsigned int const * col_buffer = detail::extract_raw_pointer<unsigned int>(mat.handle2());
 
 #ifdef VIENNACL_WITH_OPENMP
-  #pragma omp parallel for
+  #pragma omp parallel for schedule(static)
 #endif
   for (long row = 0; row < static_cast<long>(mat.size1()); ++row)
   {
@@ -165,7 +174,7 @@ void prod_impl(const viennacl::compressed_matrix<NumericT, AlignmentV> & mat,
   unsigned int const * col_buffer = detail::extract_raw_pointer<unsigned int>(mat.handle2());
 
 #ifdef VIENNACL_WITH_OPENMP
-  #pragma omp parallel for
+  #pragma omp parallel for schedule(static)
 #endif
   for (long row = 0; row < static_cast<long>(mat.size1()); ++row)
   {
@@ -362,7 +371,10 @@ void prod_impl(const viennacl::compressed_matrix<NumericT, AlignmentV> & sp_mat,
 /** @brief Carries out sparse_matrix-sparse_matrix multiplication for CSR matrices
 *
 * Implementation of the convenience expression C = prod(A, B);
-* Based on computing C(i, :) = A(i, :) * B via merging the respective rows of B
+* Each row C(i, :) = A(i, :) * B is computed with one of three accumulators, picked from the number of rows of B involved and an upper bound for the row length:
+*  - merging the respective rows of B (few rows of B),
+*  - a hash table with linear probing (many rows of B, sparse result row),
+*  - a dense work array (result row with high fill ratio).
 *
 * @param A     Left factor
 * @param B     Right factor
@@ -385,6 +397,8 @@ void prod_impl(viennacl::compressed_matrix<NumericT, AlignmentV> const & A,
   C.resize(A.size1(), B.size2(), false);
   unsigned int * C_row_buffer = detail::extract_raw_pointer<unsigned int>(C.handle1());
 
+  unsigned int B_size2 = static_cast<unsigned int>(B.size2());
+
 #if defined(VIENNACL_WITH_OPENMP)
   unsigned int block_factor = 10;
   unsigned int max_threads = omp_get_max_threads();
@@ -392,13 +406,21 @@ void prod_impl(viennacl::compressed_matrix<NumericT, AlignmentV> const & A,
 #else
   unsigned int max_threads = 1;
 #endif
-  std::vector<unsigned int> max_length_row_C(max_threads);
+  std::vector<unsigned int> max_length_row_C(max_threads);   // longest row handled by merging
+  std::vector<unsigned int> max_length_hash_C(max_threads);  // longest row handled by hashing
+  std::vector<unsigned char> uses_dense(max_threads);        // whether any row requires the dense accumulator
+  std::vector<unsigned int> row_C_upper_bounds(A.size1());
+  std::vector<unsigned char> row_C_strategies(A.size1());
   std::vector<unsigned int *> row_C_temp_index_buffers(max_threads);
   std::vector<NumericT *>     row_C_temp_value_buffers(max_threads);
+  std::vector<unsigned int *> hash_key_buffers(max_threads);
+  std::vector<NumericT *>     hash_value_buffers(max_threads);
+  std::vector<unsigned char *> dense_flag_buffers(max_threads);
+  std::vector<NumericT *>      dense_value_buffers(max_threads);
 
 
   /*
-   * Stage 1: Determine maximum length of work buffers:
+   * Stage 1: Determine accumulator and maximum length of work buffers:
    */
 
 #if defined(VIENNACL_WITH_OPENMP)
@@ -417,6 +439,7 @@ void prod_impl(viennacl::compressed_matrix<NumericT, AlignmentV> const & A,
       unsigned int entries_in_row = B_row_buffer[row_B+1] - B_row_buffer[row_B];
       row_C_upper_bound_row += entries_in_row;
     }
+    row_C_upper_bound_row = std::min(row_C_upper_bound_row, B_size2);
 
 #ifdef VIENNACL_WITH_OPENMP
     unsigned int thread_id = omp_get_thread_num();
@@ -424,16 +447,35 @@ void prod_impl(viennacl::compressed_matrix<NumericT, AlignmentV> const & A,
     unsigned int thread_id = 0;
 #endif
 
-    max_length_row_C[thread_id] = std::max(max_length_row_C[thread_id], std::min(row_C_upper_bound_row, static_cast<unsigned int>(B.size2())));
+    spgemm_row_strategy strategy = spgemm_select_row_strategy(row_end_A - row_start_A, row_C_upper_bound_row, B_size2);
+    row_C_upper_bounds[i] = row_C_upper_bound_row;
+    row_C_strategies[i]   = static_cast<unsigned char>(strategy);
+
+    if (strategy == SPGEMM_ROW_MERGE)
+      max_length_row_C[thread_id] = std::max(max_length_row_C[thread_id], row_C_upper_bound_row);
+    else if (strategy == SPGEMM_ROW_HASH)
+      max_length_hash_C[thread_id] = std::max(max_length_hash_C[thread_id], row_C_upper_bound_row);
+    else
+      uses_dense[thread_id] = 1;
   }
 
   // determine global maximum row length
   for (std::size_t i=1; i<max_length_row_C.size(); ++i)
-    max_length_row_C[0] = std::max(max_length_row_C[0], max_length_row_C[i]);
+  {
+    max_length_row_C[0]  = std::max(max_length_row_C[0],  max_length_row_C[i]);
+    max_length_hash_C[0] = std::max(max_length_hash_C[0], max_length_hash_C[i]);
+    uses_dense[0]        = std::max(uses_dense[0],        uses_dense[i]);
+  }
+  unsigned int hash_table_size = spgemm_hash_table_size(max_length_hash_C[0]);
 
   // allocate work vectors:
   for (unsigned int i=0; i<max_threads; ++i)
+  {
     row_C_temp_index_buffers[i] = (unsigned int *)malloc(sizeof(unsigned int)*3*max_length_row_C[0]);
+    hash_key_buffers[i]         = (unsigned int *)malloc(sizeof(unsigned int)*hash_table_size);
+    std::fill(hash_key_buffers[i], hash_key_buffers[i] + hash_table_size, spgemm_hash_empty_key);
+    dense_flag_buffers[i]       = uses_dense[0] ? (unsigned char *)calloc(B_size2, sizeof(unsigned char)) : NULL;
+  }
 
 
   /*
@@ -449,18 +491,34 @@ void prod_impl(viennacl::compressed_matrix<NumericT, AlignmentV> const & A,
   #ifdef VIENNACL_WITH_OPENMP
     thread_id = omp_get_thread_num();
   #endif
-    unsigned int buffer_len = max_length_row_C[0];
-
-    unsigned int *row_C_vector_1 = row_C_temp_index_buffers[thread_id];
-    unsigned int *row_C_vector_2 = row_C_vector_1 + buffer_len;
-    unsigned int *row_C_vector_3 = row_C_vector_2 + buffer_len;
-
     unsigned int row_start_A = A_row_buffer[i];
     unsigned int row_end_A   = A_row_buffer[i+1];
 
-    C_row_buffer[i] = row_C_scan_symbolic_vector(row_start_A, row_end_A, A_col_buffer,
-                                                 B_row_buffer, B_col_buffer, static_cast<unsigned int>(B.size2()),
-                                                 row_C_vector_1, row_C_vector_2, row_C_vector_3);
+    switch (row_C_strategies[i])
+    {
+    case SPGEMM_ROW_MERGE:
+      {
+        unsigned int buffer_len = max_length_row_C[0];
+
+        unsigned int *row_C_vector_1 = row_C_temp_index_buffers[thread_id];
+        unsigned int *row_C_vector_2 = row_C_vector_1 + buffer_len;
+        unsigned int *row_C_vector_3 = row_C_vector_2 + buffer_len;
+
+        C_row_buffer[i] = row_C_scan_symbolic_vector(row_start_A, row_end_A, A_col_buffer,
+                                                     B_row_buffer, B_col_buffer, B_size2,
+                                                     row_C_vector_1, row_C_vector_2, row_C_vector_3);
+      }
+      break;
+    case SPGEMM_ROW_HASH:
+      C_row_buffer[i] = row_C_scan_symbolic_hash(row_start_A, row_end_A, A_col_buffer,
+                                                 B_row_buffer, B_col_buffer, row_C_upper_bounds[i],
+                                                 hash_key_buffers[thread_id]);
+      break;
+    default:
+      C_row_buffer[i] = row_C_scan_symbolic_dense(row_start_A, row_end_A, A_col_buffer,
+                                                  B_row_buffer, B_col_buffer,
+                                                  dense_flag_buffers[thread_id]);
+    }
   }
 
   // exclusive scan to obtain row start indices:
@@ -476,7 +534,11 @@ void prod_impl(viennacl::compressed_matrix<NumericT, AlignmentV> const & A,
 
   // allocate work vectors:
   for (unsigned int i=0; i<max_threads; ++i)
+  {
     row_C_temp_value_buffers[i] = (NumericT *)malloc(sizeof(NumericT)*3*max_length_row_C[0]);
+    hash_value_buffers[i]       = (NumericT *)malloc(sizeof(NumericT)*hash_table_size);
+    dense_value_buffers[i]      = uses_dense[0] ? (NumericT *)malloc(sizeof(NumericT)*B_size2) : NULL;
+  }
 
   /*
    * Stage 3: Compute product (code similar, maybe pull out into a separate function to avoid code duplication?)
@@ -501,20 +563,38 @@ void prod_impl(viennacl::compressed_matrix<NumericT, AlignmentV> const & A,
     unsigned int thread_id = 0;
 #endif
 
-    unsigned int *row_C_vector_1 = row_C_temp_index_buffers[thread_id];
-    unsigned int *row_C_vector_2 = row_C_vector_1 + max_length_row_C[0];
-    unsigned int *row_C_vector_3 = row_C_vector_2 + max_length_row_C[0];
-
-    NumericT *row_C_vector_1_values = row_C_temp_value_buffers[thread_id];
-    NumericT *row_C_vector_2_values = row_C_vector_1_values + max_length_row_C[0];
-    NumericT *row_C_vector_3_values = row_C_vector_2_values + max_length_row_C[0];
-
-    row_C_scan_numeric_vector(row_start_A, row_end_A, A_col_buffer, A_elements,
-                              B_row_buffer, B_col_buffer, B_elements, static_cast<unsigned int>(B.size2()),
+    switch (row_C_strategies[i])
+    {
+    case SPGEMM_ROW_MERGE:
+      {
+        unsigned int *row_C_vector_1 = row_C_temp_index_buffers[thread_id];
+        unsigned int *row_C_vector_2 = row_C_vector_1 + max_length_row_C[0];
+        unsigned int *row_C_vector_3 = row_C_vector_2 + max_length_row_C[0];
+
+        NumericT *row_C_vector_1_values = row_C_temp_value_buffers[thread_id];
+        NumericT *row_C_vector_2_values = row_C_vector_1_values + max_length_row_C[0];
+        NumericT *row_C_vector_3_values = row_C_vector_2_values + max_length_row_C[0];
+
+        row_C_scan_numeric_vector(row_start_A, row_end_A, A_col_buffer, A_elements,
+                                  B_row_buffer, B_col_buffer, B_elements, B_size2,
+                                  row_C_buffer_start, row_C_buffer_end, C_col_buffer, C_elements,
+                                  row_C_vector_1, row_C_vector_1_values,
+                                  row_C_vector_2, row_C_vector_2_values,
+                                  row_C_vector_3, row_C_vector_3_values);
+      }
+      break;
+    case SPGEMM_ROW_HASH:
+      row_C_scan_numeric_hash(row_start_A, row_end_A, A_col_buffer, A_elements,
+                              B_row_buffer, B_col_buffer, B_elements, row_C_upper_bounds[i],
                               row_C_buffer_start, row_C_buffer_end, C_col_buffer, C_elements,
-                              row_C_vector_1, row_C_vector_1_values,
-                              row_C_vector_2, row_C_vector_2_values,
-                              row_C_vector_3, row_C_vector_3_values);
+                              hash_key_buffers[thread_id], hash_value_buffers[thread_id]);
+      break;
+    default:
+      row_C_scan_numeric_dense(row_start_A, row_end_A, A_col_buffer, A_elements,
+                               B_row_buffer, B_col_buffer, B_elements,
+                               row_C_buffer_start, C_col_buffer, C_elements,
+                               dense_flag_buffers[thread_id], dense_value_buffers[thread_id]);
+    }
   }
 
   // clean up at the end:
@@ -522,10 +602,498 @@ void prod_impl(viennacl::compressed_matrix<NumericT, AlignmentV> const & A,
   {
     free(row_C_temp_index_buffers[i]);
     free(row_C_temp_value_buffers[i]);
+    free(hash_key_buffers[i]);
+    free(hash_value_buffers[i]);
+    free(dense_flag_buffers[i]);
+    free(dense_value_buffers[i]);
+  }
+
+}
+
+
+
+
+namespace detail
+{
+  /** @brief Returns true if C is a CSR matrix in host memory with the given sparsity pattern, in which case only its values need to be written.
+  *
+  * Comparing the pattern only reads the index arrays of C, which is cheaper than rewriting them, and allows C to be updated in place.
+  */
+  template<typename NumericT, unsigned int AlignmentV>
+  bool csr_pattern_equal(viennacl::compressed_matrix<NumericT, AlignmentV> const & C, vcl_size_t size1, vcl_size_t size2,
+                         std::vector<unsigned int> const & row_buffer, std::vector<unsigned int> const & col_buffer)
+  {
+    if (   C.handle1().get_active_handle_id() != viennacl::MAIN_MEMORY
+        || C.size1() != size1 || C.size2() != size2 || C.nnz() < col_buffer.size() || row_buffer.size() != size1 + 1)
+      return false;
+
+    unsigned int const * C_row_buffer = extract_raw_pointer<unsigned int>(C.handle1());
+    unsigned int const * C_col_buffer = extract_raw_pointer<unsigned int>(C.handle2());
+    if (C_row_buffer[size1] != col_buffer.size())
+      return false;
+
+    long mismatches = 0;
+#ifdef VIENNACL_WITH_OPENMP
+    #pragma omp parallel for reduction(+: mismatches)
+#endif
+    for (long i = 0; i < static_cast<long>(size1); ++i)
+    {
+      if (C_row_buffer[i] != row_buffer[vcl_size_t(i)])
+        ++mismatches;
+      else
+        for (unsigned int k = row_buffer[vcl_size_t(i)]; k < row_buffer[vcl_size_t(i) + 1]; ++k)
+          if (C_col_buffer[k] != col_buffer[k])
+          {
+            ++mismatches;
+            break;
+          }
+    }
+    return mismatches == 0;
+  }
+}
+
+/** @brief Symbolic stage of a sparse matrix-matrix product for CSR matrices: Computes the sparsity pattern of C = A * B and the position in C of each product A(i,k) * B(k,j).
+*
+* @param A     Left factor
+* @param B     Right factor
+* @param plan  The plan to be set up
+*/
+template<typename NumericT, unsigned int AlignmentV>
+void spgemm_symbolic(viennacl::compressed_matrix<NumericT, AlignmentV> const & A,
+                     viennacl::compressed_matrix<NumericT, AlignmentV> const & B,
+                     viennacl::linalg::spgemm_plan & plan)
+{
+  unsigned int const * A_row_buffer = detail::extract_raw_pointer<unsigned int>(A.handle1());
+  unsigned int const * A_col_buffer = detail::extract_raw_pointer<unsigned int>(A.handle2());
+
+  unsigned int const * B_row_buffer = detail::extract_raw_pointer<unsigned int>(B.handle1());
+  unsigned int const * B_col_buffer = detail::extract_raw_pointer<unsigned int>(B.handle2());
+
+  // sparsity pattern of C from a full product (one-time cost):
+  viennacl::compressed_matrix<NumericT, AlignmentV> C(viennacl::context(viennacl::MAIN_MEMORY));
+  prod_impl(A, B, C);
+
+  unsigned int const * C_row_buffer = detail::extract_raw_pointer<unsigned int>(C.handle1());
+  unsigned int const * C_col_buffer = detail::extract_raw_pointer<unsigned int>(C.handle2());
+  vcl_size_t C_nnz = C_row_buffer[A.size1()];
+
+  plan.set_sizes(A.size1(), B.size2(), A_row_buffer[A.size1()], B_row_buffer[B.size1()]);
+  plan.C_row_buffer().assign(C_row_buffer, C_row_buffer + A.size1() + 1);
+  plan.C_col_buffer().assign(C_col_buffer, C_col_buffer + C_nnz);
+
+  // number of products per row, followed by an exclusive scan:
+  std::vector<vcl_size_t> & product_offsets = plan.product_offsets();
+  product_offsets.resize(A.size1() + 1);
+#ifdef VIENNACL_WITH_OPENMP
+  #pragma omp parallel for
+#endif
+  for (long i = 0; i < long(A.size1()); ++i)
+  {
+    vcl_size_t num_products = 0;
+    for (unsigned int j = A_row_buffer[i]; j < A_row_buffer[i+1]; ++j)
+      num_products += B_row_buffer[A_col_buffer[j] + 1] - B_row_buffer[A_col_buffer[j]];
+    product_offsets[vcl_size_t(i)] = num_products;
+  }
+
+  vcl_size_t current_offset = 0;
+  for (vcl_size_t i = 0; i < A.size1(); ++i)
+  {
+    vcl_size_t tmp = product_offsets[i];
+    product_offsets[i] = current_offset;
+    current_offset += tmp;
+  }
+  product_offsets[A.size1()] = current_offset;
+
+  // position of each product in C:
+  std::vector<unsigned int> & product_targets = plan.product_targets();
+  product_targets.resize(current_offset);
+#ifdef VIENNACL_WITH_OPENMP
+  #pragma omp parallel for
+#endif
+  for (long i = 0; i < long(A.size1()); ++i)
+  {
+    unsigned int const * row_C_begin = C_col_buffer + C_row_buffer[i];
+    unsigned int const * row_C_end   = C_col_buffer + C_row_buffer[i+1];
+
+    vcl_size_t index = product_offsets[vcl_size_t(i)];
+    for (unsigned int j = A_row_buffer[i]; j < A_row_buffer[i+1]; ++j)
+    {
+      unsigned int row_B = A_col_buffer[j];
+      for (unsigned int k = B_row_buffer[row_B]; k < B_row_buffer[row_B+1]; ++k)
+        product_targets[index++] = static_cast<unsigned int>(std::lower_bound(row_C_begin, row_C_end, B_col_buffer[k]) - C_col_buffer);
+    }
+  }
+}
+
+/** @brief Numeric stage of a sparse matrix-matrix product for CSR matrices: Computes the values of C = A * B using the plan from spgemm_symbolic().
+*
+* If C already holds the sparsity pattern of the plan, e.g. when C is the result of a previous call, only the values are written.
+* Otherwise, the pattern of the plan is copied to C, for which memory is only allocated if C does not provide enough capacity. C must not be A or B.
+*
+* @param plan  The plan obtained from spgemm_symbolic() for matrices with the same sparsity patterns as A and B
+* @param A     Left factor
+* @param B     Right factor
+* @param C     Result matrix
+*/
+template<typename NumericT, unsigned int AlignmentV>
+void spgemm_numeric(viennacl::linalg::spgemm_plan const & plan,
+                    viennacl::compressed_matrix<NumericT, AlignmentV> const & A,
+                    viennacl::compressed_matrix<NumericT, AlignmentV> const & B,
+                    viennacl::compressed_matrix<NumericT, AlignmentV> & C)
+{
+  NumericT     const * A_elements   = detail::extract_raw_pointer<NumericT>(A.handle());
+  unsigned int const * A_row_buffer = detail::extract_raw_pointer<unsigned int>(A.handle1());
+  unsigned int const * A_col_buffer = detail::extract_raw_pointer<unsigned int>(A.handle2());
+
+  NumericT     const * B_elements   = detail::extract_raw_pointer<NumericT>(B.handle());
+  unsigned int const * B_row_buffer = detail::extract_raw_pointer<unsigned int>(B.handle1());
+
+  // write sparsity pattern of C unless set up by a previous call. Memory is only allocated if C is too small:
+  bool pattern_set = detail::csr_pattern_equal(C, plan.size1(), plan.size2(), plan.C_row_buffer(), plan.C_col_buffer());
+  if (!pattern_set)
+  {
+    if (C.handle1().get_active_handle_id() != viennacl::MAIN_MEMORY)
+      C.switch_memory_context(viennacl::context(viennacl::MAIN_MEMORY));
+    C.resize(plan.size1(), plan.size2(), false);
+    std::copy(plan.C_row_buffer().begin(), plan.C_row_buffer().end(), detail::extract_raw_pointer<unsigned int>(C.handle1()));
+    C.reserve(plan.nnz(), false); // row offsets first, so that new memory is placed according to the row partition
+    std::copy(plan.C_col_buffer().begin(), plan.C_col_buffer().end(), detail::extract_raw_pointer<unsigned int>(C.handle2()));
+  }
+
+  NumericT           * C_elements   = detail::extract_raw_pointer<NumericT>(C.handle());
+  unsigned int const * C_row_buffer = &(plan.C_row_buffer()[0]);
+  vcl_size_t   const * product_offsets = &(plan.product_offsets()[0]);
+  unsigned int const * product_targets = plan.num_products() > 0 ? &(plan.product_targets()[0]) : NULL;
+
+#ifdef VIENNACL_WITH_OPENMP
+  #pragma omp parallel for
+#endif
+  for (long i = 0; i < long(A.size1()); ++i)
+  {
+    for (unsigned int k = C_row_buffer[i]; k < C_row_buffer[i+1]; ++k)
+      C_elements[k] = 0;
+
+    unsigned int const * targets = product_targets + product_offsets[i];
+    for (unsigned int j = A_row_buffer[i]; j < A_row_buffer[i+1]; ++j)
+    {
+      NumericT val_A = A_elements[j];
+      unsigned int row_B = A_col_buffer[j];
+      for (unsigned int k = B_row_buffer[row_B]; k < B_row_buffer[row_B+1]; ++k)
+        C_elements[*targets++] += val_A * B_elements[k];
+    }
+  }
+}
+
+
+
+//
+// Masked sparse matrix-matrix products
+//
+
+namespace detail
+{
+  /** @brief Replaces the first 'n' entries of 'v' by their exclusive scan and writes the total to v[n]. */
+  inline void exclusive_scan_inplace(std::vector<unsigned int> & v, vcl_size_t n)
+  {
+    unsigned int offset = 0;
+    for (vcl_size_t i = 0; i < n; ++i)
+    {
+      unsigned int tmp = v[i];
+      v[i] = offset;
+      offset += tmp;
+    }
+    v[n] = offset;
+  }
+
+  /** @brief Returns the number of bits needed to represent n, i.e. the cost of a binary search in a range of length n */
+  inline unsigned int masked_prod_log2(unsigned int n)
+  {
+    unsigned int bits = 1;
+    while (n >> bits)
+      ++bits;
+    return bits;
+  }
+
+  /** @brief Adds val_A * B(k,:) to the accumulator at the positions of a mask row. Both the row of B and the mask row have sorted column indices.
+  *
+  * Picks the cheapest of merging both rows, searching each mask entry in the row of B, or searching each entry of the row of B in the mask row.
+  * Hence the work is bounded by the length of the mask row (up to a logarithmic factor) rather than by the length of the row of B.
+  *
+  * @param mask_cols   Column indices of the mask row
+  * @param acc_values  Accumulated values, one for each entry of the mask row
+  * @param acc_flags   Set for each entry of the mask row which received a contribution
+  */
+  template<typename NumericT>
+  void masked_row_accumulate(unsigned int const * mask_cols, unsigned int mask_len,
+                             unsigned int const * B_cols, NumericT const * B_elements, unsigned int B_len,
+                             NumericT val_A,
+                             NumericT * acc_values, unsigned char * acc_flags)
+  {
+    if (mask_len == 0 || B_len == 0)
+      return;
+
+    if (mask_len * masked_prod_log2(B_len) < B_len) // search mask entries in row of B
+    {
+      unsigned int const * B_ptr = B_cols;
+      unsigned int const * B_end = B_cols + B_len;
+      for (unsigned int m = 0; m < mask_len && B_ptr < B_end; ++m)
+      {
+        B_ptr = std::lower_bound(B_ptr, B_end, mask_cols[m]);
+        if (B_ptr < B_end && *B_ptr == mask_cols[m])
+        {
+          acc_values[m] += val_A * B_elements[B_ptr - B_cols];
+          acc_flags[m] = 1;
+        }
+      }
+    }
+    else if (B_len * masked_prod_log2(mask_len) < mask_len) // search entries of B in mask row
+    {
+      unsigned int const * mask_ptr = mask_cols;
+      unsigned int const * mask_end = mask_cols + mask_len;
+      for (unsigned int k = 0; k < B_len && mask_ptr < mask_end; ++k)
+      {
+        mask_ptr = std::lower_bound(mask_ptr, mask_end, B_cols[k]);
+        if (mask_ptr < mask_end && *mask_ptr == B_cols[k])
+        {
+          acc_values[mask_ptr - mask_cols] += val_A * B_elements[k];
+          acc_flags[mask_ptr - mask_cols] = 1;
+        }
+      }
+    }
+    else // merge
+    {
+      unsigned int m = 0;
+      unsigned int k = 0;
+      while (m < mask_len && k < B_len)
+      {
+        if (mask_cols[m] < B_cols[k])
+          ++m;
+        else if (B_cols[k] < mask_cols[m])
+          ++k;
+        else
+        {
+          acc_values[m] += val_A * B_elements[k];
+          acc_flags[m] = 1;
+          ++m;
+          ++k;
+        }
+      }
+    }
+  }
+
+  /** @brief Computes C = (A * B) .* M, keeping only entries of the pattern of M. Work and temporary memory are bounded by the number of nonzeros of M. */
+  template<typename NumericT, unsigned int AlignmentV>
+  void masked_prod_impl(viennacl::compressed_matrix<NumericT, AlignmentV> const & A,
+                        viennacl::compressed_matrix<NumericT, AlignmentV> const & B,
+                        viennacl::compressed_matrix<NumericT, AlignmentV> const & M,
+                        viennacl::compressed_matrix<NumericT, AlignmentV> & C)
+  {
+    NumericT     const * A_elements   = extract_raw_pointer<NumericT>(A.handle());
+    unsigned int const * A_row_buffer = extract_raw_pointer<unsigned int>(A.handle1());
+    unsigned int const * A_col_buffer = extract_raw_pointer<unsigned int>(A.handle2());
+
+    NumericT     const * B_elements   = extract_raw_pointer<NumericT>(B.handle());
+    unsigned int const * B_row_buffer = extract_raw_pointer<unsigned int>(B.handle1());
+    unsigned int const * B_col_buffer = extract_raw_pointer<unsigned int>(B.handle2());
+
+    unsigned int const * M_row_buffer = extract_raw_pointer<unsigned int>(M.handle1());
+    unsigned int const * M_col_buffer = extract_raw_pointer<unsigned int>(M.handle2());
+    vcl_size_t M_nnz = M_row_buffer[M.size1()];
+
+    // accumulate at the positions of the mask:
+    std::vector<NumericT>      acc_values(std::max<vcl_size_t>(M_nnz, 1));
+    std::vector<unsigned char> acc_flags(std::max<vcl_size_t>(M_nnz, 1));
+    std::vector<unsigned int>  C_row_lengths(A.size1() + 1);
+
+#ifdef VIENNACL_WITH_OPENMP
+    #pragma omp parallel for schedule(dynamic, 64)
+#endif
+    for (long i = 0; i < static_cast<long>(A.size1()); ++i)
+    {
+      unsigned int mask_begin = M_row_buffer[i];
+      unsigned int mask_len   = M_row_buffer[i+1] - mask_begin;
+      if (mask_len == 0)
+        continue;
+
+      for (unsigned int j = A_row_buffer[i]; j < A_row_buffer[i+1]; ++j)
+      {
+        unsigned int row_B = A_col_buffer[j];
+        masked_row_accumulate(M_col_buffer + mask_begin, mask_len,
+                              B_col_buffer + B_row_buffer[row_B], B_elements + B_row_buffer[row_B], B_row_buffer[row_B+1] - B_row_buffer[row_B],
+                              A_elements[j],
+                              &(acc_values[0]) + mask_begin, &(acc_flags[0]) + mask_begin);
+      }
+
+      unsigned int row_length = 0;
+      for (unsigned int m = mask_begin; m < mask_begin + mask_len; ++m)
+        row_length += acc_flags[m];
+      C_row_lengths[vcl_size_t(i)] = row_length;
+    }
+    exclusive_scan_inplace(C_row_lengths, A.size1());
+
+    // compact to C:
+    C.resize(A.size1(), B.size2(), false);
+    C.reserve(C_row_lengths[A.size1()], false);
+
+    unsigned int * C_row_buffer = extract_raw_pointer<unsigned int>(C.handle1());
+    unsigned int * C_col_buffer = extract_raw_pointer<unsigned int>(C.handle2());
+    NumericT     * C_elements   = extract_raw_pointer<NumericT>(C.handle());
+
+#ifdef VIENNACL_WITH_OPENMP
+    #pragma omp parallel for
+#endif
+    for (long i = 0; i < static_cast<long>(A.size1()); ++i)
+    {
+      unsigned int index_C = C_row_lengths[vcl_size_t(i)];
+      C_row_buffer[i] = index_C;
+      for (unsigned int m = M_row_buffer[i]; m < M_row_buffer[i+1]; ++m)
+      {
+        if (acc_flags[m])
+        {
+          C_col_buffer[index_C] = M_col_buffer[m];
+          C_elements[index_C]   = acc_values[m];
+          ++index_C;
+        }
+      }
+    }
+    C_row_buffer[A.size1()] = C_row_lengths[A.size1()];
   }
 
+  /** @brief Computes C = (A * B) .* !M, keeping only entries outside the pattern of M. Uses a dense accumulator of length size2(B) per thread. */
+  template<typename NumericT, unsigned int AlignmentV>
+  void masked_prod_complement_impl(viennacl::compressed_matrix<NumericT, AlignmentV> const & A,
+                                   viennacl::compressed_matrix<NumericT, AlignmentV> const & B,
+                                   viennacl::compressed_matrix<NumericT, AlignmentV> const & M,
+                                   viennacl::compressed_matrix<NumericT, AlignmentV> & C)
+  {
+    NumericT     const * A_elements   = extract_raw_pointer<NumericT>(A.handle());
+    unsigned int const * A_row_buffer = extract_raw_pointer<unsigned int>(A.handle1());
+    unsigned int const * A_col_buffer = extract_raw_pointer<unsigned int>(A.handle2());
+
+    NumericT     const * B_elements   = extract_raw_pointer<NumericT>(B.handle());
+    unsigned int const * B_row_buffer = extract_raw_pointer<unsigned int>(B.handle1());
+    unsigned int const * B_col_buffer = extract_raw_pointer<unsigned int>(B.handle2());
+
+    unsigned int const * M_row_buffer = extract_raw_pointer<unsigned int>(M.handle1());
+    unsigned int const * M_col_buffer = extract_raw_pointer<unsigned int>(M.handle2());
+
+    std::vector<unsigned int> C_row_lengths(A.size1() + 1);
+    unsigned int * C_row_buffer = NULL;
+    unsigned int * C_col_buffer = NULL;
+    NumericT     * C_elements   = NULL;
+
+    // flags: 0 - no entry, 1 - masked out, 2 - entry of C
+    for (int pass = 0; pass < 2; ++pass)
+    {
+#ifdef VIENNACL_WITH_OPENMP
+      #pragma omp parallel
+#endif
+      {
+        std::vector<unsigned char> flags(B.size2());
+        std::vector<NumericT>      values(pass == 0 ? 0 : B.size2());
+
+#ifdef VIENNACL_WITH_OPENMP
+        #pragma omp for schedule(dynamic, 64)
+#endif
+        for (long i = 0; i < static_cast<long>(A.size1()); ++i)
+        {
+          for (unsigned int m = M_row_buffer[i]; m < M_row_buffer[i+1]; ++m)
+            flags[M_col_buffer[m]] = 1;
+
+          unsigned int row_length = 0;
+          unsigned int min_col = ~0u;
+          unsigned int max_col = 0;
+          for (unsigned int j = A_row_buffer[i]; j < A_row_buffer[i+1]; ++j)
+          {
+            unsigned int row_B = A_col_buffer[j];
+            NumericT val_A = A_elements[j];
+            for (unsigned int k = B_row_buffer[row_B]; k < B_row_buffer[row_B+1]; ++k)
+            {
+              unsigned int col = B_col_buffer[k];
+              if (flags[col] == 1)
+                continue;
+              if (flags[col] == 0)
+              {
+                flags[col] = 2;
+                ++row_length;
+                min_col = std::min(min_col, col);
+                max_col = std::max(max_col, col);
+                if (pass == 1)
+                  values[col] = val_A * B_elements[k];
+              }
+              else if (pass == 1)
+                values[col] += val_A * B_elements[k];
+            }
+          }
+
+          if (pass == 0)
+            C_row_lengths[vcl_size_t(i)] = row_length;
+
+          // write sorted output in the second pass and reset flags:
+          unsigned int index_C = (pass == 1) ? C_row_buffer[i] : 0;
+          for (unsigned int col = min_col; row_length > 0 && col <= max_col; ++col)
+          {
+            if (flags[col] == 2)
+            {
+              if (pass == 1)
+              {
+                C_col_buffer[index_C] = col;
+                C_elements[index_C]   = values[col];
+                ++index_C;
+              }
+              flags[col] = 0;
+            }
+          }
+          for (unsigned int m = M_row_buffer[i]; m < M_row_buffer[i+1]; ++m)
+            flags[M_col_buffer[m]] = 0;
+        }
+      }
+
+      if (pass == 0)
+      {
+        exclusive_scan_inplace(C_row_lengths, A.size1());
+
+        C.resize(A.size1(), B.size2(), false);
+        C.reserve(C_row_lengths[A.size1()], false);
+
+        C_row_buffer = extract_raw_pointer<unsigned int>(C.handle1());
+        C_col_buffer = extract_raw_pointer<unsigned int>(C.handle2());
+        C_elements   = extract_raw_pointer<NumericT>(C.handle());
+        std::copy(C_row_lengths.begin(), C_row_lengths.end(), C_row_buffer);
+      }
+    }
+  }
 }
 
+/** @brief Carries out the masked sparse matrix-matrix product C = (A * B) .* M for CSR matrices. Only the sparsity pattern of M is used, its values are ignored.
+*
+* Entries of A * B are only computed at the positions of M (or, if complement is set, at the positions not in M).
+* Positions of M which do not receive any contribution from A * B are not stored in C.
+* Without complement, work and temporary memory are bounded by the number of nonzeros of M rather than by the number of nonzeros of A * B.
+* Column indices in each row of B and M are required to be sorted.
+*
+* @param A           Left factor
+* @param B           Right factor
+* @param M           The mask
+* @param C           Result matrix. Must not be A, B, or M.
+* @param complement  If true, entries of A * B are computed at all positions not in the pattern of M.
+*/
+template<typename NumericT, unsigned int AlignmentV>
+void masked_prod(viennacl::compressed_matrix<NumericT, AlignmentV> const & A,
+                 viennacl::compressed_matrix<NumericT, AlignmentV> const & B,
+                 viennacl::compressed_matrix<NumericT, AlignmentV> const & M,
+                 viennacl::compressed_matrix<NumericT, AlignmentV> & C,
+                 bool complement)
+{
+  if (C.handle1().get_active_handle_id() != viennacl::MAIN_MEMORY)
+    C.switch_memory_context(viennacl::context(viennacl::MAIN_MEMORY));
+
+  if (complement)
+    detail::masked_prod_complement_impl(A, B, M, C);
+  else
+    detail::masked_prod_impl(A, B, M, C);
+  C.generate_row_block_information();
+}
 
 
 
@@ -1128,7 +1696,7 @@ void prod_impl(const viennacl::compressed_compressed_matrix<NumericT> & mat,
   }
 
 #ifdef VIENNACL_WITH_OPENMP
-  #pragma omp parallel for
+  #pragma omp parallel for schedule(static)
 #endif
   for (long i = 0; i < static_cast<long>(mat.nnz1()); ++i)
   {
@@ -1146,42 +1714,404 @@ void prod_impl(const viennacl::compressed_compressed_matrix<NumericT> & mat,
 }
 
 
-
 //
-// Coordinate Matrix
+// Delta-compressed Matrix
 //
 
 namespace detail
 {
-  template<typename NumericT, unsigned int AlignmentV>
-  void row_info(coordinate_matrix<NumericT, AlignmentV> const & mat,
-                vector_base<NumericT> & vec,
-                viennacl::linalg::detail::row_info_types info_selector)
+  /** @brief Decodes the column deltas of a row without escape codes by a running sum and accumulates the dot product of the row with the vector.
+  *
+  * @param stream    Column deltas of entries 1, ..., row_nnz-1 of the row
+  * @param elements  Values of the row
+  * @param row_nnz   Number of nonzeros in the row
+  * @param col       Column index of the first entry of the row
+  * @param dot_prod  Partial dot product (first entry of the row), the remaining entries are added
+  */
+  template<typename DeltaT, typename NumericT>
+  NumericT delta_compressed_row_dot_no_escapes(unsigned char const * stream, NumericT const * elements, vcl_size_t row_nnz, unsigned int col, NumericT dot_prod,
+                                               NumericT const * vec_buf, vcl_size_t vec_start, vcl_size_t vec_inc)
   {
-    NumericT           * result_buf   = detail::extract_raw_pointer<NumericT>(vec.handle());
-    NumericT     const * elements     = detail::extract_raw_pointer<NumericT>(mat.handle());
-    unsigned int const * coord_buffer = detail::extract_raw_pointer<unsigned int>(mat.handle12());
-
-    NumericT value = 0;
-    unsigned int last_row = 0;
-
-    for (vcl_size_t i = 0; i < mat.nnz(); ++i)
+    for (vcl_size_t k = 1; k < row_nnz; ++k)
     {
-      unsigned int current_row = coord_buffer[2*i];
+      DeltaT delta;
+      std::memcpy(&delta, stream + (k - 1) * sizeof(DeltaT), sizeof(DeltaT));
+      col += delta;
+      dot_prod += elements[k] * vec_buf[col * vec_inc + vec_start];
+    }
+    return dot_prod;
+  }
 
-      if (current_row != last_row)
-      {
-        if (info_selector == viennacl::linalg::detail::SPARSE_ROW_NORM_2)
-          value = std::sqrt(value);
+#ifdef VIENNACL_WITH_AVX2
+  /** @brief Loads four column deltas and widens them to 32 bit. */
+  template<typename DeltaT>
+  __m128i delta_compressed_load_deltas(unsigned char const * stream);
 
-        result_buf[last_row] = value;
-        value = 0;
-        last_row = current_row;
-      }
+  template<>
+  inline __m128i delta_compressed_load_deltas<unsigned char>(unsigned char const * stream)
+  {
+    int deltas;
+    std::memcpy(&deltas, stream, sizeof(int));
+    return _mm_cvtepu8_epi32(_mm_cvtsi32_si128(deltas));
+  }
 
-      switch (info_selector)
-      {
-        case viennacl::linalg::detail::SPARSE_ROW_NORM_INF: //inf-norm
+  template<>
+  inline __m128i delta_compressed_load_deltas<unsigned short>(unsigned char const * stream)
+  {
+    return _mm_cvtepu16_epi32(_mm_loadl_epi64(reinterpret_cast<__m128i const *>(stream)));
+  }
+
+  template<>
+  inline __m128i delta_compressed_load_deltas<unsigned int>(unsigned char const * stream)
+  {
+    return _mm_loadu_si128(reinterpret_cast<__m128i const *>(stream));
+  }
+
+  /** @brief Decodes four column indices from their deltas by a prefix sum. 'col' holds the column index preceding the deltas on entry and the last decoded column index on exit. */
+  template<typename DeltaT>
+  __m128i delta_compressed_decode_cols(unsigned char const * stream, unsigned int & col)
+  {
+    __m128i cols = delta_compressed_load_deltas<DeltaT>(stream);
+    cols = _mm_add_epi32(cols, _mm_slli_si128(cols, 4));
+    cols = _mm_add_epi32(cols, _mm_slli_si128(cols, 8));
+    cols = _mm_add_epi32(cols, _mm_set1_epi32(static_cast<int>(col)));
+    col = static_cast<unsigned int>(_mm_extract_epi32(cols, 3));
+    return cols;
+  }
+
+  /** @brief Vectorized version of delta_compressed_row_dot_no_escapes() for double precision and unit vector stride. Decodes four column indices per iteration and gathers the vector entries. */
+  template<typename DeltaT>
+  double delta_compressed_row_dot_no_escapes(unsigned char const * stream, double const * elements, vcl_size_t row_nnz, unsigned int col, double dot_prod,
+                                             double const * vec_buf, vcl_size_t vec_start, vcl_size_t vec_inc)
+  {
+    if (vec_inc != 1)
+      return delta_compressed_row_dot_no_escapes<DeltaT, double>(stream, elements, row_nnz, col, dot_prod, vec_buf, vec_start, vec_inc);
+
+    double const * x = vec_buf + vec_start;
+    __m256d avx_sum = _mm256_setzero_pd();
+    vcl_size_t k = 1;
+    for (; k + 4 <= row_nnz; k += 4)
+    {
+      __m128i avx_cols = delta_compressed_decode_cols<DeltaT>(stream + (k - 1) * sizeof(DeltaT), col);
+      avx_sum = _mm256_add_pd(avx_sum, _mm256_mul_pd(_mm256_loadu_pd(elements + k), _mm256_i32gather_pd(x, avx_cols, 8)));
+    }
+
+    double partial_sums[4];
+    _mm256_storeu_pd(partial_sums, avx_sum);
+    dot_prod += (partial_sums[0] + partial_sums[1]) + (partial_sums[2] + partial_sums[3]);
+    for (; k < row_nnz; ++k)
+    {
+      DeltaT delta;
+      std::memcpy(&delta, stream + (k - 1) * sizeof(DeltaT), sizeof(DeltaT));
+      col += delta;
+      dot_prod += elements[k] * x[col];
+    }
+    return dot_prod;
+  }
+
+  /** @brief Vectorized version of delta_compressed_row_dot_no_escapes() for single precision and unit vector stride. Decodes eight column indices per iteration and gathers the vector entries. */
+  template<typename DeltaT>
+  float delta_compressed_row_dot_no_escapes(unsigned char const * stream, float const * elements, vcl_size_t row_nnz, unsigned int col, float dot_prod,
+                                            float const * vec_buf, vcl_size_t vec_start, vcl_size_t vec_inc)
+  {
+    if (vec_inc != 1)
+      return delta_compressed_row_dot_no_escapes<DeltaT, float>(stream, elements, row_nnz, col, dot_prod, vec_buf, vec_start, vec_inc);
+
+    float const * x = vec_buf + vec_start;
+    __m256 avx_sum = _mm256_setzero_ps();
+    vcl_size_t k = 1;
+    for (; k + 8 <= row_nnz; k += 8)
+    {
+      __m128i avx_cols_lo = delta_compressed_decode_cols<DeltaT>(stream + (k - 1) * sizeof(DeltaT), col);
+      __m128i avx_cols_hi = delta_compressed_decode_cols<DeltaT>(stream + (k + 3) * sizeof(DeltaT), col);
+      __m256i avx_cols    = _mm256_inserti128_si256(_mm256_castsi128_si256(avx_cols_lo), avx_cols_hi, 1);
+      avx_sum = _mm256_add_ps(avx_sum, _mm256_mul_ps(_mm256_loadu_ps(elements + k), _mm256_i32gather_ps(x, avx_cols, 4)));
+    }
+
+    float partial_sums[8];
+    _mm256_storeu_ps(partial_sums, avx_sum);
+    dot_prod += ((partial_sums[0] + partial_sums[1]) + (partial_sums[2] + partial_sums[3])) + ((partial_sums[4] + partial_sums[5]) + (partial_sums[6] + partial_sums[7]));
+    for (; k < row_nnz; ++k)
+    {
+      DeltaT delta;
+      std::memcpy(&delta, stream + (k - 1) * sizeof(DeltaT), sizeof(DeltaT));
+      col += delta;
+      dot_prod += elements[k] * x[col];
+    }
+    return dot_prod;
+  }
+#endif
+
+  /** @brief Decodes the delta-encoded column indices of a row on the fly and returns the dot product of the row with the vector.
+  *
+  * Rows without escape codes are decoded by a running sum over the deltas, which keeps the inner loop free of branches.
+  * With VIENNACL_WITH_AVX2, these rows are decoded by vectorized prefix sums and the vector entries are gathered.
+  */
+  template<typename DeltaT, typename NumericT>
+  NumericT delta_compressed_row_dot(unsigned char const * stream, bool has_escapes,
+                                    NumericT const * elements, vcl_size_t row_nnz,
+                                    NumericT const * vec_buf, vcl_size_t vec_start, vcl_size_t vec_inc)
+  {
+    DeltaT const escape_code = DeltaT(~DeltaT(0));
+    unsigned int col;
+    std::memcpy(&col, stream, sizeof(unsigned int));
+    stream += sizeof(unsigned int);
+
+    NumericT dot_prod = elements[0] * vec_buf[col * vec_inc + vec_start];
+    if (!has_escapes)
+      return delta_compressed_row_dot_no_escapes<DeltaT>(stream, elements, row_nnz, col, dot_prod, vec_buf, vec_start, vec_inc);
+
+    for (vcl_size_t k = 1; k < row_nnz; ++k)
+    {
+      DeltaT delta;
+      std::memcpy(&delta, stream, sizeof(DeltaT));
+      stream += sizeof(DeltaT);
+      if (delta == escape_code)
+      {
+        std::memcpy(&col, stream, sizeof(unsigned int));
+        stream += sizeof(unsigned int);
+      }
+      else
+        col += delta;
+      dot_prod += elements[k] * vec_buf[col * vec_inc + vec_start];
+    }
+    return dot_prod;
+  }
+}
+
+/** @brief Carries out matrix-vector multiplication with a delta_compressed_matrix
+*
+* Implementation of the convenience expression result = prod(mat, vec);
+*
+* @param mat    The matrix
+* @param vec    The vector
+* @param alpha  Scaling factor for the product
+* @param result The result vector
+* @param beta   Scaling factor for the initial values in the result vector
+*/
+template<typename NumericT>
+void prod_impl(const viennacl::delta_compressed_matrix<NumericT> & mat,
+               const viennacl::vector_base<NumericT> & vec,
+               NumericT alpha,
+                     viennacl::vector_base<NumericT> & result,
+               NumericT beta)
+{
+  NumericT            * result_buf    = detail::extract_raw_pointer<NumericT>(result.handle());
+  NumericT      const * vec_buf       = detail::extract_raw_pointer<NumericT>(vec.handle());
+  NumericT      const * elements      = detail::extract_raw_pointer<NumericT>(mat.handle());
+  unsigned int  const * row_buffer    = detail::extract_raw_pointer<unsigned int>(mat.handle1());
+  unsigned char const * index_stream  = detail::extract_raw_pointer<unsigned char>(mat.handle2());
+  unsigned int  const * index_offsets = detail::extract_raw_pointer<unsigned int>(mat.handle3());
+
+  vcl_size_t vec_start = vec.start();
+  vcl_size_t vec_inc   = vec.stride();
+
+#ifdef VIENNACL_WITH_OPENMP
+  #pragma omp parallel for schedule(static)
+#endif
+  for (long row = 0; row < static_cast<long>(mat.size1()); ++row)
+  {
+    NumericT dot_prod = 0;
+    vcl_size_t row_start = row_buffer[row];
+    vcl_size_t row_nnz   = row_buffer[row+1] - row_start;
+
+    if (row_nnz > 0)
+    {
+      unsigned char const * row_stream = index_stream + index_offsets[row];
+      bool has_escapes = (row_stream[0] & viennacl::DELTA_ENCODING_HAS_ESCAPES) != 0;
+      switch (row_stream[0] & viennacl::DELTA_ENCODING_WIDTH_MASK)
+      {
+      case viennacl::DELTA_ENCODING_8BIT:
+        dot_prod = detail::delta_compressed_row_dot<unsigned char>(row_stream + 1, has_escapes, elements + row_start, row_nnz, vec_buf, vec_start, vec_inc);
+        break;
+      case viennacl::DELTA_ENCODING_16BIT:
+        dot_prod = detail::delta_compressed_row_dot<unsigned short>(row_stream + 1, has_escapes, elements + row_start, row_nnz, vec_buf, vec_start, vec_inc);
+        break;
+      default:
+        dot_prod = detail::delta_compressed_row_dot<unsigned int>(row_stream + 1, false, elements + row_start, row_nnz, vec_buf, vec_start, vec_inc);
+      }
+    }
+
+    vcl_size_t index = static_cast<vcl_size_t>(row) * result.stride() + result.start();
+    if (beta < 0 || beta > 0)
+      result_buf[index] = alpha * dot_prod + beta * result_buf[index];
+    else
+      result_buf[index] = alpha * dot_prod;
+  }
+}
+
+
+//
+// Mixed-precision Matrices
+//
+
+namespace detail
+{
+  /** @brief Computes the dot product of a CSR row with reduced-precision values and the vector. Values are converted to NumericT on the fly. */
+  template<typename NumericT, typename StorageT>
+  NumericT mixed_csr_row_dot(StorageT const * elements, unsigned int const * cols, vcl_size_t row_nnz,
+                             NumericT const * vec_buf, vcl_size_t vec_start, vcl_size_t vec_inc)
+  {
+    NumericT dot_prod = 0;
+    for (vcl_size_t k = 0; k < row_nnz; ++k)
+      dot_prod += static_cast<NumericT>(elements[k]) * vec_buf[cols[k] * vec_inc + vec_start];
+    return dot_prod;
+  }
+
+#ifdef VIENNACL_WITH_AVX2
+  /** @brief AVX2 version for single precision values and double precision accumulation: Four values are widened and multiplied with four gathered vector entries per iteration. */
+  inline double mixed_csr_row_dot(float const * elements, unsigned int const * cols, vcl_size_t row_nnz,
+                                  double const * vec_buf, vcl_size_t vec_start, vcl_size_t vec_inc)
+  {
+    if (vec_inc != 1)
+      return mixed_csr_row_dot<double, float>(elements, cols, row_nnz, vec_buf, vec_start, vec_inc);
+
+    double const * x = vec_buf + vec_start;
+    __m256d avx_sum = _mm256_setzero_pd();
+    vcl_size_t k = 0;
+    for (; k + 4 <= row_nnz; k += 4)
+    {
+      __m256d avx_values = _mm256_cvtps_pd(_mm_loadu_ps(elements + k));
+      __m256d avx_x      = _mm256_i32gather_pd(x, _mm_loadu_si128(reinterpret_cast<__m128i const *>(cols + k)), 8);
+      avx_sum = _mm256_add_pd(avx_sum, _mm256_mul_pd(avx_values, avx_x));
+    }
+
+    double partial_sums[4];
+    _mm256_storeu_pd(partial_sums, avx_sum);
+    double dot_prod = (partial_sums[0] + partial_sums[1]) + (partial_sums[2] + partial_sums[3]);
+    for (; k < row_nnz; ++k)
+      dot_prod += static_cast<double>(elements[k]) * x[cols[k]];
+    return dot_prod;
+  }
+#endif
+}
+
+/** @brief Carries out matrix-vector multiplication with a mixed_compressed_matrix
+*
+* Implementation of the convenience expression result = prod(mat, vec);
+* Values are stored as StorageT, all arithmetic is carried out in NumericT.
+*
+* @param mat    The matrix
+* @param vec    The vector
+* @param alpha  Scaling factor for the product
+* @param result The result vector
+* @param beta   Scaling factor for the initial values in the result vector
+*/
+template<typename NumericT, typename StorageT>
+void prod_impl(const viennacl::mixed_compressed_matrix<NumericT, StorageT> & mat,
+               const viennacl::vector_base<NumericT> & vec,
+               NumericT alpha,
+                     viennacl::vector_base<NumericT> & result,
+               NumericT beta)
+{
+  NumericT           * result_buf = detail::extract_raw_pointer<NumericT>(result.handle());
+  NumericT     const * vec_buf    = detail::extract_raw_pointer<NumericT>(vec.handle());
+  StorageT     const * elements   = detail::extract_raw_pointer<StorageT>(mat.handle());
+  unsigned int const * row_buffer = detail::extract_raw_pointer<unsigned int>(mat.handle1());
+  unsigned int const * col_buffer = detail::extract_raw_pointer<unsigned int>(mat.handle2());
+
+#ifdef VIENNACL_WITH_OPENMP
+  #pragma omp parallel for schedule(static)
+#endif
+  for (long row = 0; row < static_cast<long>(mat.size1()); ++row)
+  {
+    vcl_size_t row_start = row_buffer[row];
+    NumericT dot_prod = detail::mixed_csr_row_dot(elements + row_start, col_buffer + row_start, row_buffer[row+1] - row_start,
+                                                  vec_buf, vec.start(), vec.stride());
+
+    vcl_size_t index = static_cast<vcl_size_t>(row) * result.stride() + result.start();
+    if (beta < 0 || beta > 0)
+      result_buf[index] = alpha * dot_prod + beta * result_buf[index];
+    else
+      result_buf[index] = alpha * dot_prod;
+  }
+}
+
+/** @brief Carries out matrix-vector multiplication with a mixed_ell_matrix
+*
+* Implementation of the convenience expression result = prod(mat, vec);
+* Values are stored as StorageT, all arithmetic is carried out in NumericT.
+*
+* @param mat    The matrix
+* @param vec    The vector
+* @param alpha  Scaling factor for the product
+* @param result The result vector
+* @param beta   Scaling factor for the initial values in the result vector
+*/
+template<typename NumericT, typename StorageT>
+void prod_impl(const viennacl::mixed_ell_matrix<NumericT, StorageT> & mat,
+               const viennacl::vector_base<NumericT> & vec,
+               NumericT alpha,
+                     viennacl::vector_base<NumericT> & result,
+               NumericT beta)
+{
+  NumericT           * result_buf   = detail::extract_raw_pointer<NumericT>(result.handle());
+  NumericT     const * vec_buf      = detail::extract_raw_pointer<NumericT>(vec.handle());
+  StorageT     const * elements     = detail::extract_raw_pointer<StorageT>(mat.handle());
+  unsigned int const * coords       = detail::extract_raw_pointer<unsigned int>(mat.handle2());
+
+#ifdef VIENNACL_WITH_OPENMP
+  #pragma omp parallel for schedule(static)
+#endif
+  for (long row = 0; row < static_cast<long>(mat.size1()); ++row)
+  {
+    NumericT sum = 0;
+
+    for (vcl_size_t item_id = 0; item_id < mat.internal_maxnnz(); ++item_id)
+    {
+      vcl_size_t offset = static_cast<vcl_size_t>(row) + item_id * mat.internal_size1();
+      NumericT val = static_cast<NumericT>(elements[offset]);
+
+      if (val > 0 || val < 0)
+        sum += vec_buf[coords[offset] * vec.stride() + vec.start()] * val;
+    }
+
+    vcl_size_t index = static_cast<vcl_size_t>(row) * result.stride() + result.start();
+    if (beta < 0 || beta > 0)
+      result_buf[index] = alpha * sum + beta * result_buf[index];
+    else
+      result_buf[index] = alpha * sum;
+  }
+}
+
+
+
+
+//
+// Coordinate Matrix
+//
+
+namespace detail
+{
+  template<typename NumericT, unsigned int AlignmentV>
+  void row_info(coordinate_matrix<NumericT, AlignmentV> const & mat,
+                vector_base<NumericT> & vec,
+                viennacl::linalg::detail::row_info_types info_selector)
+  {
+    NumericT           * result_buf   = detail::extract_raw_pointer<NumericT>(vec.handle());
+    NumericT     const * elements     = detail::extract_raw_pointer<NumericT>(mat.handle());
+    unsigned int const * coord_buffer = detail::extract_raw_pointer<unsigned int>(mat.handle12());
+
+    NumericT value = 0;
+    unsigned int last_row = 0;
+
+    for (vcl_size_t i = 0; i < mat.nnz(); ++i)
+    {
+      unsigned int current_row = coord_buffer[2*i];
+
+      if (current_row != last_row)
+      {
+        if (info_selector == viennacl::linalg::detail::SPARSE_ROW_NORM_2)
+          value = std::sqrt(value);
+
+        result_buf[last_row] = value;
+        value = 0;
+        last_row = current_row;
+      }
+
+      switch (info_selector)
+      {
+        case viennacl::linalg::detail::SPARSE_ROW_NORM_INF: //inf-norm
           value = std::max<NumericT>(value, std::fabs(elements[i]));
           break;
 
@@ -1511,8 +2441,12 @@ void prod_impl(const viennacl::ell_matrix<NumericT, AlignmentV> & mat,
   NumericT     const * elements     = detail::extract_raw_pointer<NumericT>(mat.handle());
   unsigned int const * coords       = detail::extract_raw_pointer<unsigned int>(mat.handle2());
 
-  for (vcl_size_t row = 0; row < mat.size1(); ++row)
+#ifdef VIENNACL_WITH_OPENMP
+  #pragma omp parallel for schedule(static)
+#endif
+  for (long row2 = 0; row2 < static_cast<long>(mat.size1()); ++row2)
   {
+    vcl_size_t row = static_cast<vcl_size_t>(row2);
     NumericT sum = 0;
 
     for (unsigned int item_id = 0; item_id < mat.internal_maxnnz(); ++item_id)
@@ -1807,51 +2741,58 @@ void prod_impl(const viennacl::sliced_ell_matrix<NumericT, IndexT> & mat,
   IndexT   const * column_indices    = detail::extract_raw_pointer<IndexT>(mat.handle2());
   IndexT   const * block_start       = detail::extract_raw_pointer<IndexT>(mat.handle3());
 
-  vcl_size_t num_blocks = mat.size1() / mat.rows_per_block() + 1;
+  vcl_size_t num_blocks = (mat.size1() > 0) ? (mat.size1() - 1) / mat.rows_per_block() + 1 : 0;
 
 #ifdef VIENNACL_WITH_OPENMP
-  #pragma omp parallel for
+  #pragma omp parallel
 #endif
-  for (long block_idx2 = 0; block_idx2 < static_cast<long>(num_blocks); ++block_idx2)
   {
-    vcl_size_t block_idx = static_cast<vcl_size_t>(block_idx2);
-    vcl_size_t current_columns_per_block = columns_per_block[block_idx];
-
     std::vector<NumericT> result_values(mat.rows_per_block());
 
-    for (IndexT column_entry_index = 0;
-                column_entry_index < current_columns_per_block;
-              ++column_entry_index)
+#ifdef VIENNACL_WITH_OPENMP
+    #pragma omp for schedule(static)
+#endif
+    for (long block_idx2 = 0; block_idx2 < static_cast<long>(num_blocks); ++block_idx2)
     {
-      vcl_size_t stride_start = block_start[block_idx] + column_entry_index * mat.rows_per_block();
-      // Note: This for-loop may be unrolled by hand for exploiting vectorization
-      //       Careful benchmarking recommended first, memory channels may be saturated already!
-      for (IndexT row_in_block = 0; row_in_block < mat.rows_per_block(); ++row_in_block)
+      vcl_size_t block_idx = static_cast<vcl_size_t>(block_idx2);
+      vcl_size_t current_columns_per_block = columns_per_block[block_idx];
+
+      std::fill(result_values.begin(), result_values.end(), NumericT(0));
+
+      for (IndexT column_entry_index = 0;
+                  column_entry_index < current_columns_per_block;
+                ++column_entry_index)
       {
-        NumericT val = elements[stride_start + row_in_block];
+        vcl_size_t stride_start = block_start[block_idx] + column_entry_index * mat.rows_per_block();
+        // Note: This for-loop may be unrolled by hand for exploiting vectorization
+        //       Careful benchmarking recommended first, memory channels may be saturated already!
+        for (IndexT row_in_block = 0; row_in_block < mat.rows_per_block(); ++row_in_block)
+        {
+          NumericT val = elements[stride_start + row_in_block];
 
-        result_values[row_in_block] += (val > 0 || val < 0) ? vec_buf[column_indices[stride_start + row_in_block] * vec.stride() + vec.start()] * val : 0;
+          result_values[row_in_block] += (val > 0 || val < 0) ? vec_buf[column_indices[stride_start + row_in_block] * vec.stride() + vec.start()] * val : 0;
+        }
       }
-    }
 
-    vcl_size_t first_row_in_matrix = block_idx * mat.rows_per_block();
-    if (beta < 0 || beta > 0)
-    {
-      for (IndexT row_in_block = 0; row_in_block < mat.rows_per_block(); ++row_in_block)
+      vcl_size_t first_row_in_matrix = block_idx * mat.rows_per_block();
+      if (beta < 0 || beta > 0)
       {
-        if (first_row_in_matrix + row_in_block < result.size())
+        for (IndexT row_in_block = 0; row_in_block < mat.rows_per_block(); ++row_in_block)
         {
-          vcl_size_t index = (first_row_in_matrix + row_in_block) * result.stride() + result.start();
-          result_buf[index] = alpha * result_values[row_in_block] + beta * result_buf[index];
+          if (first_row_in_matrix + row_in_block < result.size())
+          {
+            vcl_size_t index = (first_row_in_matrix + row_in_block) * result.stride() + result.start();
+            result_buf[index] = alpha * result_values[row_in_block] + beta * result_buf[index];
+          }
         }
       }
-    }
-    else
-    {
-      for (IndexT row_in_block = 0; row_in_block < mat.rows_per_block(); ++row_in_block)
+      else
       {
-        if (first_row_in_matrix + row_in_block < result.size())
-          result_buf[(first_row_in_matrix + row_in_block) * result.stride() + result.start()] = alpha * result_values[row_in_block];
+        for (IndexT row_in_block = 0; row_in_block < mat.rows_per_block(); ++row_in_block)
+        {
+          if (first_row_in_matrix + row_in_block < result.size())
+            result_buf[(first_row_in_matrix + row_in_block) * result.stride() + result.start()] = alpha * result_values[row_in_block];
+        }
       }
     }
   }
@@ -1885,8 +2826,12 @@ void prod_impl(const viennacl::hyb_matrix<NumericT, AlignmentV> & mat,
   unsigned int const * csr_col_buffer = detail::extract_raw_pointer<unsigned int>(mat.handle4());
 
 
-  for (vcl_size_t row = 0; row < mat.size1(); ++row)
+#ifdef VIENNACL_WITH_OPENMP
+  #pragma omp parallel for schedule(static)
+#endif
+  for (long row2 = 0; row2 < static_cast<long>(mat.size1()); ++row2)
   {
+    vcl_size_t row = static_cast<vcl_size_t>(row2);
     NumericT sum = 0;
 
     //
@@ -2117,6 +3062,1337 @@ void prod_impl(const viennacl::hyb_matrix<NumericT, AlignmentV> & mat,
 }
 
 
+//
+// Transposition
+//
+namespace detail
+{
+  /** @brief Transposes a sparse matrix given by its nonzeros in row-wise order into CSR arrays of the transpose.
+  *
+  * Bucketed counting sort on the column index: Each thread counts the nonzeros of a contiguous chunk of the input per bucket of columns
+  * and scatters them into a bucket-ordered temporary. Each bucket is then sorted by column independently, so that the scatter writes stay within a cache-sized window.
+  * The memory for the counters is proportional to the number of buckets (at most 1024) per thread, not to the matrix size per thread.
+  * The order of entries within each column is preserved, hence rows of the transpose are sorted if the rows of A are sorted.
+  *
+  * @param A_size1           Number of rows of A
+  * @param A_size2           Number of columns of A
+  * @param A_nnz             Number of nonzeros of A
+  * @param A_row_buffer      CSR row array of A, or NULL if row indices are provided via A_row_indices
+  * @param A_row_indices     Row index of each nonzero (with stride A_index_stride), or NULL if A_row_buffer is provided
+  * @param A_col_indices     Column index of each nonzero (with stride A_index_stride)
+  * @param A_index_stride    Stride for A_row_indices and A_col_indices (2 for interleaved coordinate storage, 1 otherwise)
+  * @param A_elements        Value of each nonzero
+  * @param B_row_buffer      CSR row array of the transpose (A_size2 + 1 entries)
+  * @param B_col_indices     Column index of each nonzero of the transpose (with stride B_col_stride)
+  * @param B_col_stride      Stride for B_col_indices
+  * @param B_elements        Value of each nonzero of the transpose
+  */
+  template<typename NumericT>
+  void csr_transpose_impl(vcl_size_t A_size1, vcl_size_t A_size2, vcl_size_t A_nnz,
+                          unsigned int const * A_row_buffer, unsigned int const * A_row_indices, unsigned int const * A_col_indices, vcl_size_t A_index_stride,
+                          NumericT const * A_elements,
+                          unsigned int * B_row_buffer, unsigned int * B_col_indices, vcl_size_t B_col_stride, NumericT * B_elements)
+  {
+    // radix of the bucket sort: high bits of the column index, at most 1024 buckets
+    unsigned int bucket_shift = 0;
+    while ((A_size2 >> bucket_shift) >= 1024)
+      ++bucket_shift;
+    vcl_size_t bucket_width = vcl_size_t(1) << bucket_shift;
+    vcl_size_t num_buckets  = (A_size2 + bucket_width - 1) / bucket_width;
+
+    if (A_nnz == 0 || num_buckets == 0)
+    {
+      for (vcl_size_t i = 0; i <= A_size2; ++i)
+        B_row_buffer[i] = 0;
+      return;
+    }
+
+#ifdef VIENNACL_WITH_OPENMP
+    vcl_size_t num_chunks = (A_nnz < 16384) ? 1 : vcl_size_t(omp_get_max_threads());
+#else
+    vcl_size_t num_chunks = 1;
+#endif
+
+    std::vector<vcl_size_t> bucket_offsets(num_chunks * num_buckets); // chunk-major
+
+    //
+    // Stage 1: Count nonzeros per bucket in each chunk
+    //
+#ifdef VIENNACL_WITH_OPENMP
+    #pragma omp parallel for
+#endif
+    for (long chunk = 0; chunk < long(num_chunks); ++chunk)
+    {
+      vcl_size_t * counts = &(bucket_offsets[vcl_size_t(chunk) * num_buckets]);
+      vcl_size_t chunk_begin = (A_nnz *  vcl_size_t(chunk))      / num_chunks;
+      vcl_size_t chunk_end   = (A_nnz * (vcl_size_t(chunk) + 1)) / num_chunks;
+      for (vcl_size_t k = chunk_begin; k < chunk_end; ++k)
+        counts[A_col_indices[k * A_index_stride] >> bucket_shift] += 1;
+    }
+
+    // exclusive scan in bucket-major order, so that entries of a bucket are ordered by chunk:
+    std::vector<vcl_size_t> bucket_start(num_buckets + 1);
+    vcl_size_t offset = 0;
+    for (vcl_size_t b = 0; b < num_buckets; ++b)
+    {
+      bucket_start[b] = offset;
+      for (vcl_size_t chunk = 0; chunk < num_chunks; ++chunk)
+      {
+        vcl_size_t tmp = bucket_offsets[chunk * num_buckets + b];
+        bucket_offsets[chunk * num_buckets + b] = offset;
+        offset += tmp;
+      }
+    }
+    bucket_start[num_buckets] = offset;
+
+    //
+    // Stage 2: Scatter (row, col, value) into buckets
+    //
+    std::vector<unsigned int> temp_rows(A_nnz);
+    std::vector<unsigned int> temp_cols(A_nnz);
+    std::vector<NumericT>     temp_elements(A_nnz);
+
+#ifdef VIENNACL_WITH_OPENMP
+    #pragma omp parallel for
+#endif
+    for (long chunk = 0; chunk < long(num_chunks); ++chunk)
+    {
+      vcl_size_t * offsets = &(bucket_offsets[vcl_size_t(chunk) * num_buckets]);
+      vcl_size_t chunk_begin = (A_nnz *  vcl_size_t(chunk))      / num_chunks;
+      vcl_size_t chunk_end   = (A_nnz * (vcl_size_t(chunk) + 1)) / num_chunks;
+
+      unsigned int row = 0;
+      if (A_row_buffer) // first row with entries in this chunk
+        row = static_cast<unsigned int>(std::upper_bound(A_row_buffer, A_row_buffer + A_size1 + 1, static_cast<unsigned int>(chunk_begin)) - A_row_buffer - 1);
+
+      for (vcl_size_t k = chunk_begin; k < chunk_end; ++k)
+      {
+        if (A_row_buffer)
+        {
+          while (k >= A_row_buffer[row+1])
+            ++row;
+        }
+        else
+          row = A_row_indices[k * A_index_stride];
+
+        unsigned int col = A_col_indices[k * A_index_stride];
+        vcl_size_t index = offsets[col >> bucket_shift]++;
+        temp_rows[index]     = row;
+        temp_cols[index]     = col;
+        temp_elements[index] = A_elements[k];
+      }
+    }
+
+    //
+    // Stage 3: Counting sort within each bucket, writes rows of B
+    //
+#ifdef VIENNACL_WITH_OPENMP
+    #pragma omp parallel
+#endif
+    {
+      std::vector<unsigned int> col_offsets(bucket_width + 1);
+
+#ifdef VIENNACL_WITH_OPENMP
+      #pragma omp for schedule(dynamic)
+#endif
+      for (long b = 0; b < long(num_buckets); ++b)
+      {
+        vcl_size_t col_begin = vcl_size_t(b) << bucket_shift;
+        vcl_size_t col_end   = std::min(col_begin + bucket_width, A_size2);
+
+        std::fill(col_offsets.begin(), col_offsets.end(), 0);
+        for (vcl_size_t k = bucket_start[vcl_size_t(b)]; k < bucket_start[vcl_size_t(b)+1]; ++k)
+          col_offsets[temp_cols[k] - col_begin] += 1;
+
+        unsigned int col_offset = static_cast<unsigned int>(bucket_start[vcl_size_t(b)]);
+        for (vcl_size_t col = col_begin; col < col_end; ++col)
+        {
+          unsigned int tmp = col_offsets[col - col_begin];
+          col_offsets[col - col_begin] = col_offset;
+          B_row_buffer[col] = col_offset;
+          col_offset += tmp;
+        }
+
+        for (vcl_size_t k = bucket_start[vcl_size_t(b)]; k < bucket_start[vcl_size_t(b)+1]; ++k)
+        {
+          unsigned int index = col_offsets[temp_cols[k] - col_begin]++;
+          B_col_indices[index * B_col_stride] = temp_rows[k];
+          B_elements[index] = temp_elements[k];
+        }
+      }
+    }
+    B_row_buffer[A_size2] = static_cast<unsigned int>(A_nnz);
+  }
+
+  /** @brief Extracts the nonzeros of an ell_matrix to CSR arrays. Padding entries (value zero) are skipped. */
+  template<typename NumericT, unsigned int AlignmentV>
+  void sparse_to_csr_arrays(viennacl::ell_matrix<NumericT, AlignmentV> const & A,
+                            std::vector<unsigned int> & row_buffer, std::vector<unsigned int> & col_buffer, std::vector<NumericT> & elements)
+  {
+    NumericT     const * A_elements = extract_raw_pointer<NumericT>(A.handle());
+    unsigned int const * A_coords   = extract_raw_pointer<unsigned int>(A.handle2());
+
+    row_buffer.resize(A.size1() + 1);
+#ifdef VIENNACL_WITH_OPENMP
+    #pragma omp parallel for
+#endif
+    for (long row = 0; row < long(A.size1()); ++row)
+    {
+      unsigned int num_entries = 0;
+      for (vcl_size_t item_id = 0; item_id < A.maxnnz(); ++item_id)
+      {
+        NumericT val = A_elements[vcl_size_t(row) + item_id * A.internal_size1()];
+        if (val > 0 || val < 0)
+          ++num_entries;
+      }
+      row_buffer[vcl_size_t(row)] = num_entries;
+    }
+    exclusive_scan_inplace(row_buffer, A.size1());
+
+    col_buffer.resize(row_buffer[A.size1()]);
+    elements.resize(row_buffer[A.size1()]);
+#ifdef VIENNACL_WITH_OPENMP
+    #pragma omp parallel for
+#endif
+    for (long row = 0; row < long(A.size1()); ++row)
+    {
+      unsigned int index = row_buffer[vcl_size_t(row)];
+      for (vcl_size_t item_id = 0; item_id < A.maxnnz(); ++item_id)
+      {
+        vcl_size_t offset = vcl_size_t(row) + item_id * A.internal_size1();
+        NumericT val = A_elements[offset];
+        if (val > 0 || val < 0)
+        {
+          col_buffer[index] = A_coords[offset];
+          elements[index]   = val;
+          ++index;
+        }
+      }
+    }
+  }
+
+  /** @brief Extracts the nonzeros of a sliced_ell_matrix to CSR arrays. Padding entries (value zero) are skipped. */
+  template<typename NumericT, typename IndexT>
+  void sparse_to_csr_arrays(viennacl::sliced_ell_matrix<NumericT, IndexT> const & A,
+                            std::vector<unsigned int> & row_buffer, std::vector<unsigned int> & col_buffer, std::vector<NumericT> & elements)
+  {
+    NumericT const * A_elements          = extract_raw_pointer<NumericT>(A.handle());
+    IndexT   const * A_columns_per_block = extract_raw_pointer<IndexT>(A.handle1());
+    IndexT   const * A_column_indices    = extract_raw_pointer<IndexT>(A.handle2());
+    IndexT   const * A_block_start       = extract_raw_pointer<IndexT>(A.handle3());
+
+    vcl_size_t rows_per_block = A.rows_per_block();
+
+    row_buffer.resize(A.size1() + 1);
+    for (int pass = 0; pass < 2; ++pass) // pass 0: count, pass 1: fill
+    {
+      if (pass == 1)
+      {
+        exclusive_scan_inplace(row_buffer, A.size1());
+        col_buffer.resize(row_buffer[A.size1()]);
+        elements.resize(row_buffer[A.size1()]);
+      }
+
+#ifdef VIENNACL_WITH_OPENMP
+      #pragma omp parallel for
+#endif
+      for (long row = 0; row < long(A.size1()); ++row)
+      {
+        vcl_size_t block_idx    = vcl_size_t(row) / rows_per_block;
+        vcl_size_t row_in_block = vcl_size_t(row) % rows_per_block;
+        unsigned int index = (pass == 1) ? row_buffer[vcl_size_t(row)] : 0;
+        for (vcl_size_t item_id = 0; item_id < vcl_size_t(A_columns_per_block[block_idx]); ++item_id)
+        {
+          vcl_size_t offset = A_block_start[block_idx] + item_id * rows_per_block + row_in_block;
+          NumericT val = A_elements[offset];
+          if (val > 0 || val < 0)
+          {
+            if (pass == 1)
+            {
+              col_buffer[index] = static_cast<unsigned int>(A_column_indices[offset]);
+              elements[index]   = val;
+            }
+            ++index;
+          }
+        }
+        if (pass == 0)
+          row_buffer[vcl_size_t(row)] = index;
+      }
+    }
+  }
+
+  /** @brief Extracts the nonzeros of a hyb_matrix (ELL part followed by CSR part for each row) to CSR arrays. Padding entries (value zero) are skipped. */
+  template<typename NumericT, unsigned int AlignmentV>
+  void sparse_to_csr_arrays(viennacl::hyb_matrix<NumericT, AlignmentV> const & A,
+                            std::vector<unsigned int> & row_buffer, std::vector<unsigned int> & col_buffer, std::vector<NumericT> & elements)
+  {
+    NumericT     const * A_elements       = extract_raw_pointer<NumericT>(A.handle());
+    unsigned int const * A_coords         = extract_raw_pointer<unsigned int>(A.handle2());
+    unsigned int const * A_csr_row_buffer = extract_raw_pointer<unsigned int>(A.handle3());
+    unsigned int const * A_csr_col_buffer = extract_raw_pointer<unsigned int>(A.handle4());
+    NumericT     const * A_csr_elements   = extract_raw_pointer<NumericT>(A.handle5());
+
+    row_buffer.resize(A.size1() + 1);
+    for (int pass = 0; pass < 2; ++pass) // pass 0: count, pass 1: fill
+    {
+      if (pass == 1)
+      {
+        exclusive_scan_inplace(row_buffer, A.size1());
+        col_buffer.resize(row_buffer[A.size1()]);
+        elements.resize(row_buffer[A.size1()]);
+      }
+
+#ifdef VIENNACL_WITH_OPENMP
+      #pragma omp parallel for
+#endif
+      for (long row = 0; row < long(A.size1()); ++row)
+      {
+        unsigned int index = (pass == 1) ? row_buffer[vcl_size_t(row)] : 0;
+        for (vcl_size_t item_id = 0; item_id < A.ell_nnz(); ++item_id)
+        {
+          vcl_size_t offset = vcl_size_t(row) + item_id * A.internal_size1();
+          NumericT val = A_elements[offset];
+          if (val > 0 || val < 0)
+          {
+            if (pass == 1)
+            {
+              col_buffer[index] = A_coords[offset];
+              elements[index]   = val;
+            }
+            ++index;
+          }
+        }
+        for (unsigned int k = A_csr_row_buffer[row]; k < A_csr_row_buffer[row+1]; ++k)
+        {
+          if (pass == 1)
+          {
+            col_buffer[index] = A_csr_col_buffer[k];
+            elements[index]   = A_csr_elements[k];
+          }
+          ++index;
+        }
+        if (pass == 0)
+          row_buffer[vcl_size_t(row)] = index;
+      }
+    }
+  }
+
+  /** @brief Sorts the entries of a coordinate matrix given by interleaved (row, column) coordinates to CSR arrays with sorted column indices in each row.
+  *
+  * The values are moved along with the column indices. These are the values of the matrix or, for a permutation, the indices of the entries.
+  */
+  template<typename ValueT>
+  void coo_to_csr_arrays(vcl_size_t size1, vcl_size_t size2, vcl_size_t nnz, unsigned int const * coords, ValueT const * values,
+                         std::vector<unsigned int> & row_buffer, std::vector<unsigned int> & col_buffer, std::vector<ValueT> & csr_values)
+  {
+    row_buffer.resize(size1 + 1);
+    col_buffer.resize(std::max<vcl_size_t>(nnz, 1));
+    csr_values.resize(std::max<vcl_size_t>(nnz, 1));
+
+    // stable counting sort by row index, i.e. the transposition of trans(A):
+    csr_transpose_impl(size2, size1, nnz,
+                       static_cast<unsigned int const *>(NULL), coords + 1, coords, 2, values,
+                       &(row_buffer[0]), &(col_buffer[0]), 1, &(csr_values[0]));
+
+    // entries keep their relative order within each row, hence sort rows if A is not stored in row-major order:
+#ifdef VIENNACL_WITH_OPENMP
+    #pragma omp parallel for
+#endif
+    for (long row = 0; row < static_cast<long>(size1); ++row)
+    {
+      unsigned int row_begin = row_buffer[vcl_size_t(row)];
+      unsigned int row_end   = row_buffer[vcl_size_t(row) + 1];
+      for (unsigned int k = row_begin + 1; k < row_end; ++k) // insertion sort, rows are short
+      {
+        unsigned int col = col_buffer[k];
+        ValueT       val = csr_values[k];
+        unsigned int j = k;
+        for (; j > row_begin && col_buffer[j-1] > col; --j)
+        {
+          col_buffer[j] = col_buffer[j-1];
+          csr_values[j] = csr_values[j-1];
+        }
+        col_buffer[j] = col;
+        csr_values[j] = val;
+      }
+    }
+  }
+
+  /** @brief Extracts the nonzeros of a coordinate_matrix to CSR arrays with sorted column indices in each row. The entries of A may be stored in any order. */
+  template<typename NumericT, unsigned int AlignmentV>
+  void sparse_to_csr_arrays(viennacl::coordinate_matrix<NumericT, AlignmentV> const & A,
+                            std::vector<unsigned int> & row_buffer, std::vector<unsigned int> & col_buffer, std::vector<NumericT> & elements)
+  {
+    coo_to_csr_arrays(A.size1(), A.size2(), A.nnz(), extract_raw_pointer<unsigned int>(A.handle12()), extract_raw_pointer<NumericT>(A.handle()),
+                      row_buffer, col_buffer, elements);
+  }
+
+  /** @brief Extracts the sparsity pattern of a coordinate_matrix to CSR arrays like sparse_to_csr_arrays(). 'permutation' holds the index of the entry of A for each entry of the CSR arrays. */
+  template<typename NumericT, unsigned int AlignmentV>
+  void sparse_to_csr_pattern(viennacl::coordinate_matrix<NumericT, AlignmentV> const & A,
+                             std::vector<unsigned int> & row_buffer, std::vector<unsigned int> & col_buffer, std::vector<unsigned int> & permutation)
+  {
+    std::vector<unsigned int> entry_indices(std::max<vcl_size_t>(A.nnz(), 1));
+    for (vcl_size_t k = 0; k < A.nnz(); ++k)
+      entry_indices[k] = static_cast<unsigned int>(k);
+
+    coo_to_csr_arrays(A.size1(), A.size2(), A.nnz(), extract_raw_pointer<unsigned int>(A.handle12()), &(entry_indices[0]),
+                      row_buffer, col_buffer, permutation);
+  }
+
+  /** @brief Transposes an ELL-type matrix via CSR arrays. The result is set up using viennacl::copy(), hence keeps the format parameters of B (e.g. block size).
+  *
+  *  B must be empty or of size size2(A) times size1(A), and must not be A.
+  */
+  template<typename SparseMatrixT>
+  void ell_type_transpose(SparseMatrixT const & A, SparseMatrixT & B)
+  {
+    typedef typename viennacl::result_of::cpu_value_type<typename SparseMatrixT::value_type>::type   NumericT;
+
+    std::vector<unsigned int> A_row_buffer, A_col_buffer;
+    std::vector<NumericT>     A_elements;
+    sparse_to_csr_arrays(A, A_row_buffer, A_col_buffer, A_elements);
+
+    vcl_size_t nnz = A_col_buffer.size();
+    std::vector<unsigned int> B_row_buffer(A.size2() + 1);
+    std::vector<unsigned int> B_col_buffer(std::max<vcl_size_t>(nnz, 1));
+    std::vector<NumericT>     B_elements(std::max<vcl_size_t>(nnz, 1));
+    csr_transpose_impl(A.size1(), A.size2(), nnz,
+                       &(A_row_buffer[0]), static_cast<unsigned int const *>(NULL), nnz > 0 ? &(A_col_buffer[0]) : NULL, 1,
+                       nnz > 0 ? &(A_elements[0]) : NULL,
+                       &(B_row_buffer[0]), &(B_col_buffer[0]), 1, &(B_elements[0]));
+
+    // found via argument-dependent lookup, since the sparse matrix types are only forward-declared here:
+    copy(viennacl::tools::const_csr_matrix_adapter<NumericT>(&(B_row_buffer[0]), &(B_col_buffer[0]), &(B_elements[0]), A.size2(), A.size1()), B);
+  }
+}
+
+/** @brief Computes B = trans(A) for a compressed_matrix. B is resized as needed and must not be A.
+*
+* @param A   The matrix to be transposed
+* @param B   The result matrix
+*/
+template<typename NumericT, unsigned int AlignmentV>
+void transpose(viennacl::compressed_matrix<NumericT, AlignmentV> const & A,
+               viennacl::compressed_matrix<NumericT, AlignmentV>       & B)
+{
+  unsigned int const * A_row_buffer = detail::extract_raw_pointer<unsigned int>(A.handle1());
+  unsigned int const * A_col_buffer = detail::extract_raw_pointer<unsigned int>(A.handle2());
+  NumericT     const * A_elements   = detail::extract_raw_pointer<NumericT>(A.handle());
+  vcl_size_t A_nnz = (A.size1() > 0) ? A_row_buffer[A.size1()] : 0;
+
+  if (B.handle1().get_active_handle_id() != viennacl::MAIN_MEMORY)
+    B.switch_memory_context(viennacl::context(viennacl::MAIN_MEMORY));
+  B.resize(A.size2(), A.size1(), false);
+  B.reserve(A_nnz, false);
+
+  detail::csr_transpose_impl(A.size1(), A.size2(), A_nnz,
+                             A_row_buffer, static_cast<unsigned int const *>(NULL), A_col_buffer, 1, A_elements,
+                             detail::extract_raw_pointer<unsigned int>(B.handle1()),
+                             detail::extract_raw_pointer<unsigned int>(B.handle2()), 1,
+                             detail::extract_raw_pointer<NumericT>(B.handle()));
+
+  B.generate_row_block_information();
+}
+
+/** @brief Computes B = trans(A) for a coordinate_matrix. The nonzeros of B are ordered by row. B must be empty or of size size2(A) times size1(A), and must not be A.
+*
+* @param A   The matrix to be transposed
+* @param B   The result matrix
+*/
+template<typename NumericT, unsigned int AlignmentV>
+void transpose(viennacl::coordinate_matrix<NumericT, AlignmentV> const & A,
+               viennacl::coordinate_matrix<NumericT, AlignmentV>       & B)
+{
+  unsigned int const * A_coords   = detail::extract_raw_pointer<unsigned int>(A.handle12());
+  NumericT     const * A_elements = detail::extract_raw_pointer<NumericT>(A.handle());
+  vcl_size_t nnz = A.nnz();
+
+  std::vector<unsigned int> B_row_buffer(A.size2() + 1);
+  std::vector<unsigned int> B_col_buffer(std::max<vcl_size_t>(nnz, 1));
+  std::vector<NumericT>     B_elements(std::max<vcl_size_t>(nnz, 1));
+  detail::csr_transpose_impl(A.size1(), A.size2(), nnz,
+                             static_cast<unsigned int const *>(NULL), A_coords, A_coords + 1, 2, A_elements,
+                             &(B_row_buffer[0]), &(B_col_buffer[0]), 1, &(B_elements[0]));
+
+  // found via argument-dependent lookup, since the sparse matrix types are only forward-declared here:
+  copy(viennacl::tools::const_csr_matrix_adapter<NumericT>(&(B_row_buffer[0]), &(B_col_buffer[0]), &(B_elements[0]), A.size2(), A.size1()), B);
+}
+
+/** @brief Computes B = trans(A) for an ell_matrix. B must be empty or of size size2(A) times size1(A), and must not be A. */
+template<typename NumericT, unsigned int AlignmentV>
+void transpose(viennacl::ell_matrix<NumericT, AlignmentV> const & A,
+               viennacl::ell_matrix<NumericT, AlignmentV>       & B)
+{
+  detail::ell_type_transpose(A, B);
+}
+
+/** @brief Computes B = trans(A) for a sliced_ell_matrix. B must be empty or of size size2(A) times size1(A), and must not be A. */
+template<typename NumericT, typename IndexT>
+void transpose(viennacl::sliced_ell_matrix<NumericT, IndexT> const & A,
+               viennacl::sliced_ell_matrix<NumericT, IndexT>       & B)
+{
+  detail::ell_type_transpose(A, B);
+}
+
+/** @brief Computes B = trans(A) for a hyb_matrix. B must be empty or of size size2(A) times size1(A), and must not be A. */
+template<typename NumericT, unsigned int AlignmentV>
+void transpose(viennacl::hyb_matrix<NumericT, AlignmentV> const & A,
+               viennacl::hyb_matrix<NumericT, AlignmentV>       & B)
+{
+  detail::ell_type_transpose(A, B);
+}
+
+
+//
+// Products with the transpose of a compressed matrix
+//
+
+namespace detail
+{
+  /** @brief Returns true if per-thread partial results (size2 entries per thread) are cheaper than atomic updates for scattering nnz products. */
+  inline bool trans_prod_use_partial_results(vcl_size_t size2, vcl_size_t nnz, vcl_size_t num_threads)
+  {
+    // merging the partial results costs size2 * num_threads loads, an atomic update costs several times a plain store:
+    return size2 * num_threads <= 4 * nnz;
+  }
+
+  /** @brief Computes y += alpha * trans(A) * x for a CSR matrix A by scattering the rows of A to y. Runs in parallel with either per-thread partial results or atomic updates.
+  *
+  * @param size1   Number of rows of A (entries of x)
+  * @param size2   Number of columns of A (entries of y)
+  */
+  template<typename NumericT>
+  void csr_trans_prod_scatter(unsigned int const * A_row_buffer, unsigned int const * A_col_buffer, NumericT const * A_elements,
+                              vcl_size_t size1, vcl_size_t size2,
+                              NumericT const * x, vcl_size_t x_start, vcl_size_t x_inc,
+                              NumericT alpha,
+                              NumericT       * y, vcl_size_t y_start, vcl_size_t y_inc)
+  {
+    vcl_size_t A_nnz = A_row_buffer[size1];
+
+#ifdef VIENNACL_WITH_OPENMP
+    vcl_size_t num_threads = static_cast<vcl_size_t>(omp_get_max_threads());
+    if (num_threads > 1 && A_nnz >= 16384)
+    {
+      if (trans_prod_use_partial_results(size2, A_nnz, num_threads))
+      {
+        std::vector<std::vector<NumericT> > partial_results(num_threads);
+
+        #pragma omp parallel
+        {
+          std::vector<NumericT> & y_partial = partial_results[static_cast<vcl_size_t>(omp_get_thread_num())];
+          y_partial.resize(size2); // zero-initialized by the owning thread
+
+          #pragma omp for
+          for (long row = 0; row < static_cast<long>(size1); ++row)
+          {
+            NumericT x_row = x[static_cast<vcl_size_t>(row) * x_inc + x_start];
+            for (unsigned int k = A_row_buffer[row]; k < A_row_buffer[row+1]; ++k)
+              y_partial[A_col_buffer[k]] += A_elements[k] * x_row;
+          }
+
+          #pragma omp for
+          for (long col = 0; col < static_cast<long>(size2); ++col)
+          {
+            NumericT sum = 0;
+            for (vcl_size_t t = 0; t < partial_results.size(); ++t)
+              if (partial_results[t].size() > 0)
+                sum += partial_results[t][static_cast<vcl_size_t>(col)];
+            y[static_cast<vcl_size_t>(col) * y_inc + y_start] += alpha * sum;
+          }
+        }
+      }
+      else
+      {
+        #pragma omp parallel for
+        for (long row = 0; row < static_cast<long>(size1); ++row)
+        {
+          NumericT x_row = alpha * x[static_cast<vcl_size_t>(row) * x_inc + x_start];
+          for (unsigned int k = A_row_buffer[row]; k < A_row_buffer[row+1]; ++k)
+          {
+            NumericT & y_entry = y[static_cast<vcl_size_t>(A_col_buffer[k]) * y_inc + y_start];
+            NumericT update = A_elements[k] * x_row;
+            #pragma omp atomic
+            y_entry += update;
+          }
+        }
+      }
+      return;
+    }
+#else
+    (void)A_nnz;
+#endif
+
+    for (vcl_size_t row = 0; row < size1; ++row)
+    {
+      NumericT x_row = alpha * x[row * x_inc + x_start];
+      for (unsigned int k = A_row_buffer[row]; k < A_row_buffer[row+1]; ++k)
+        y[static_cast<vcl_size_t>(A_col_buffer[k]) * y_inc + y_start] += A_elements[k] * x_row;
+    }
+  }
+
+  /** @brief Computes C = trans(A) * B for a CSR matrix A and dense matrices B, C by scattering the rows of A.
+  *
+  * The columns of C are split into blocks processed by different threads, so no synchronization is needed if there are at least as many columns as threads.
+  * Otherwise, all threads work on all columns and use atomic updates.
+  */
+  template<typename NumericT, typename BWrapperT, typename CWrapperT>
+  void csr_trans_prod_dense(unsigned int const * A_row_buffer, unsigned int const * A_col_buffer, NumericT const * A_elements,
+                            vcl_size_t size1, vcl_size_t size2, vcl_size_t num_cols,
+                            BWrapperT B, CWrapperT C)
+  {
+#ifdef VIENNACL_WITH_OPENMP
+    #pragma omp parallel for
+#endif
+    for (long row = 0; row < static_cast<long>(size2); ++row)
+      for (vcl_size_t col = 0; col < num_cols; ++col)
+        C(static_cast<vcl_size_t>(row), col) = NumericT(0);
+
+    vcl_size_t num_blocks = 1;
+#ifdef VIENNACL_WITH_OPENMP
+    num_blocks = static_cast<vcl_size_t>(omp_get_max_threads());
+    if (num_blocks > 1 && num_cols < num_blocks && A_row_buffer[size1] >= 16384)
+    {
+      #pragma omp parallel for
+      for (long row = 0; row < static_cast<long>(size1); ++row)
+        for (unsigned int k = A_row_buffer[row]; k < A_row_buffer[row+1]; ++k)
+          for (vcl_size_t col = 0; col < num_cols; ++col)
+          {
+            NumericT & C_entry = C(static_cast<vcl_size_t>(A_col_buffer[k]), col);
+            NumericT update = A_elements[k] * B(static_cast<vcl_size_t>(row), col);
+            #pragma omp atomic
+            C_entry += update;
+          }
+      return;
+    }
+    num_blocks = std::max<vcl_size_t>(1, std::min(num_blocks, num_cols));
+#endif
+
+#ifdef VIENNACL_WITH_OPENMP
+    #pragma omp parallel for
+#endif
+    for (long block = 0; block < static_cast<long>(num_blocks); ++block)
+    {
+      vcl_size_t col_start = (num_cols *  static_cast<vcl_size_t>(block))      / num_blocks;
+      vcl_size_t col_end   = (num_cols * (static_cast<vcl_size_t>(block) + 1)) / num_blocks;
+
+      for (vcl_size_t row = 0; row < size1; ++row)
+        for (unsigned int k = A_row_buffer[row]; k < A_row_buffer[row+1]; ++k)
+        {
+          vcl_size_t row_C = A_col_buffer[k];
+          NumericT   val_A = A_elements[k];
+          for (vcl_size_t col = col_start; col < col_end; ++col)
+            C(row_C, col) += val_A * B(row, col);
+        }
+    }
+  }
+}
+
+/** @brief Carries out matrix-vector multiplication with the transpose of a compressed_matrix without forming the transpose explicitly.
+*
+* Implementation of the convenience expression result = prod(trans(mat), vec);
+* The rows of the matrix are scattered to the result either into per-thread partial results (if the result vector is short compared to the number of nonzeros) or via atomic updates.
+*
+* @param proxy  The transposed matrix
+* @param vec    The vector
+* @param alpha  Scaling factor for the product
+* @param result The result vector
+* @param beta   Scaling factor for the previous result
+*/
+template<typename NumericT, unsigned int AlignmentV>
+void prod_impl(viennacl::matrix_expression<const viennacl::compressed_matrix<NumericT, AlignmentV>,
+                                           const viennacl::compressed_matrix<NumericT, AlignmentV>,
+                                           viennacl::op_trans> const & proxy,
+               viennacl::vector_base<NumericT> const & vec,
+               NumericT alpha,
+               viennacl::vector_base<NumericT> & result,
+               NumericT beta)
+{
+  viennacl::compressed_matrix<NumericT, AlignmentV> const & A = proxy.lhs();
+
+  NumericT           * result_buf = detail::extract_raw_pointer<NumericT>(result.handle());
+  NumericT     const * vec_buf    = detail::extract_raw_pointer<NumericT>(vec.handle());
+  NumericT     const * elements   = detail::extract_raw_pointer<NumericT>(A.handle());
+  unsigned int const * row_buffer = detail::extract_raw_pointer<unsigned int>(A.handle1());
+  unsigned int const * col_buffer = detail::extract_raw_pointer<unsigned int>(A.handle2());
+
+  vcl_size_t result_start = result.start();
+  vcl_size_t result_inc   = result.stride();
+
+  bool beta_is_zero = (beta <= NumericT(0) && beta >= NumericT(0));
+#ifdef VIENNACL_WITH_OPENMP
+  #pragma omp parallel for
+#endif
+  for (long col = 0; col < static_cast<long>(A.size2()); ++col)
+  {
+    vcl_size_t index = static_cast<vcl_size_t>(col) * result_inc + result_start;
+    result_buf[index] = beta_is_zero ? NumericT(0) : beta * result_buf[index];
+  }
+
+  if (A.size1() == 0)
+    return;
+
+  detail::csr_trans_prod_scatter(row_buffer, col_buffer, elements, A.size1(), A.size2(),
+                                 vec_buf, vec.start(), vec.stride(),
+                                 alpha,
+                                 result_buf, result_start, result_inc);
+}
+
+/** @brief Carries out sparse_matrix-matrix multiplication with the transpose of a compressed_matrix without forming the transpose explicitly.
+*
+* Implementation of the convenience expression result = prod(trans(sp_mat), d_mat);
+*
+* @param proxy      The transposed sparse matrix
+* @param d_mat      The dense matrix
+* @param result     The result matrix
+*/
+template<typename NumericT, unsigned int AlignmentV>
+void prod_impl(viennacl::matrix_expression<const viennacl::compressed_matrix<NumericT, AlignmentV>,
+                                           const viennacl::compressed_matrix<NumericT, AlignmentV>,
+                                           viennacl::op_trans> const & proxy,
+               viennacl::matrix_base<NumericT> const & d_mat,
+               viennacl::matrix_base<NumericT>       & result)
+{
+  viennacl::compressed_matrix<NumericT, AlignmentV> const & sp_mat = proxy.lhs();
+
+  NumericT     const * sp_mat_elements   = detail::extract_raw_pointer<NumericT>(sp_mat.handle());
+  unsigned int const * sp_mat_row_buffer = detail::extract_raw_pointer<unsigned int>(sp_mat.handle1());
+  unsigned int const * sp_mat_col_buffer = detail::extract_raw_pointer<unsigned int>(sp_mat.handle2());
+
+  NumericT const * d_mat_data  = detail::extract_raw_pointer<NumericT>(d_mat);
+  NumericT       * result_data = detail::extract_raw_pointer<NumericT>(result);
+
+  detail::matrix_array_wrapper<NumericT const, row_major, false>
+      d_mat_wrapper_row(d_mat_data, viennacl::traits::start1(d_mat), viennacl::traits::start2(d_mat),
+                        viennacl::traits::stride1(d_mat), viennacl::traits::stride2(d_mat),
+                        viennacl::traits::internal_size1(d_mat), viennacl::traits::internal_size2(d_mat));
+  detail::matrix_array_wrapper<NumericT const, column_major, false>
+      d_mat_wrapper_col(d_mat_data, viennacl::traits::start1(d_mat), viennacl::traits::start2(d_mat),
+                        viennacl::traits::stride1(d_mat), viennacl::traits::stride2(d_mat),
+                        viennacl::traits::internal_size1(d_mat), viennacl::traits::internal_size2(d_mat));
+
+  detail::matrix_array_wrapper<NumericT, row_major, false>
+      result_wrapper_row(result_data, viennacl::traits::start1(result), viennacl::traits::start2(result),
+                         viennacl::traits::stride1(result), viennacl::traits::stride2(result),
+                         viennacl::traits::internal_size1(result), viennacl::traits::internal_size2(result));
+  detail::matrix_array_wrapper<NumericT, column_major, false>
+      result_wrapper_col(result_data, viennacl::traits::start1(result), viennacl::traits::start2(result),
+                         viennacl::traits::stride1(result), viennacl::traits::stride2(result),
+                         viennacl::traits::internal_size1(result), viennacl::traits::internal_size2(result));
+
+  if (d_mat.row_major() && result.row_major())
+    detail::csr_trans_prod_dense(sp_mat_row_buffer, sp_mat_col_buffer, sp_mat_elements, sp_mat.size1(), sp_mat.size2(), d_mat.size2(), d_mat_wrapper_row, result_wrapper_row);
+  else if (d_mat.row_major())
+    detail::csr_trans_prod_dense(sp_mat_row_buffer, sp_mat_col_buffer, sp_mat_elements, sp_mat.size1(), sp_mat.size2(), d_mat.size2(), d_mat_wrapper_row, result_wrapper_col);
+  else if (result.row_major())
+    detail::csr_trans_prod_dense(sp_mat_row_buffer, sp_mat_col_buffer, sp_mat_elements, sp_mat.size1(), sp_mat.size2(), d_mat.size2(), d_mat_wrapper_col, result_wrapper_row);
+  else
+    detail::csr_trans_prod_dense(sp_mat_row_buffer, sp_mat_col_buffer, sp_mat_elements, sp_mat.size1(), sp_mat.size2(), d_mat.size2(), d_mat_wrapper_col, result_wrapper_col);
+}
+
+
+
+//
+// Sparse matrix sums C = alpha * A + beta * B
+//
+
+namespace detail
+{
+  /** @brief Returns the number of distinct column indices in the two sorted index ranges [a, a_end) and [b, b_end) */
+  inline unsigned int spgeam_row_length(unsigned int const * a, unsigned int const * a_end,
+                                        unsigned int const * b, unsigned int const * b_end)
+  {
+    unsigned int row_length = 0;
+    while (a < a_end && b < b_end)
+    {
+      if (*a < *b)
+        ++a;
+      else if (*b < *a)
+        ++b;
+      else
+      {
+        ++a;
+        ++b;
+      }
+      ++row_length;
+    }
+    return row_length + static_cast<unsigned int>(a_end - a) + static_cast<unsigned int>(b_end - b);
+  }
+
+  /** @brief Writes the union of the two sorted index ranges [a, a_end) and [b, b_end) to c */
+  inline void spgeam_row_pattern(unsigned int const * a, unsigned int const * a_end,
+                                 unsigned int const * b, unsigned int const * b_end,
+                                 unsigned int * c)
+  {
+    while (a < a_end && b < b_end)
+    {
+      if (*a < *b)
+        *c++ = *a++;
+      else if (*b < *a)
+        *c++ = *b++;
+      else
+      {
+        *c++ = *a++;
+        ++b;
+      }
+    }
+    c = std::copy(a, a_end, c);
+    std::copy(b, b_end, c);
+  }
+
+  /** @brief Symbolic stage of C = alpha * A + beta * B for CSR arrays with sorted column indices in each row. */
+  inline void csr_spgeam_symbolic(vcl_size_t size1, vcl_size_t size2,
+                                  unsigned int const * A_row_buffer, unsigned int const * A_col_buffer,
+                                  unsigned int const * B_row_buffer, unsigned int const * B_col_buffer,
+                                  viennacl::linalg::spgeam_plan & plan)
+  {
+    vcl_size_t A_nnz = A_row_buffer[size1];
+    vcl_size_t B_nnz = B_row_buffer[size1];
+
+    plan.set_sizes(size1, size2, A_nnz, B_nnz);
+    plan.A_targets().clear();
+    plan.B_targets().clear();
+    plan.patterns_equal(   A_nnz == B_nnz
+                        && std::equal(A_row_buffer, A_row_buffer + size1 + 1, B_row_buffer)
+                        && std::equal(A_col_buffer, A_col_buffer + A_nnz, B_col_buffer));
+
+    std::vector<unsigned int> & C_row_buffer = plan.C_row_buffer();
+    std::vector<unsigned int> & C_col_buffer = plan.C_col_buffer();
+
+    if (plan.patterns_equal())
+    {
+      C_row_buffer.assign(A_row_buffer, A_row_buffer + size1 + 1);
+      C_col_buffer.assign(A_col_buffer, A_col_buffer + A_nnz);
+      return;
+    }
+
+    // Pass 1: row lengths of C, followed by an exclusive scan:
+    C_row_buffer.resize(size1 + 1);
+#ifdef VIENNACL_WITH_OPENMP
+    #pragma omp parallel for
+#endif
+    for (long i = 0; i < static_cast<long>(size1); ++i)
+      C_row_buffer[vcl_size_t(i)] = spgeam_row_length(A_col_buffer + A_row_buffer[i], A_col_buffer + A_row_buffer[i+1],
+                                                      B_col_buffer + B_row_buffer[i], B_col_buffer + B_row_buffer[i+1]);
+    exclusive_scan_inplace(C_row_buffer, size1);
+
+    // Pass 2: column indices of C:
+    C_col_buffer.resize(C_row_buffer[size1]);
+#ifdef VIENNACL_WITH_OPENMP
+    #pragma omp parallel for
+#endif
+    for (long i = 0; i < static_cast<long>(size1); ++i)
+      if (C_row_buffer[vcl_size_t(i)] < C_row_buffer[vcl_size_t(i) + 1])
+        spgeam_row_pattern(A_col_buffer + A_row_buffer[i], A_col_buffer + A_row_buffer[i+1],
+                           B_col_buffer + B_row_buffer[i], B_col_buffer + B_row_buffer[i+1],
+                           &(C_col_buffer[0]) + C_row_buffer[vcl_size_t(i)]);
+  }
+
+  /** @brief Numeric stage of C = alpha * A + beta * B for CSR arrays. The pattern of C is taken from the plan. */
+  template<typename NumericT>
+  void csr_spgeam_numeric(viennacl::linalg::spgeam_plan const & plan,
+                          unsigned int const * A_row_buffer, unsigned int const * A_col_buffer, NumericT const * A_elements, NumericT alpha,
+                          unsigned int const * B_row_buffer, unsigned int const * B_col_buffer, NumericT const * B_elements, NumericT beta,
+                          NumericT * C_elements)
+  {
+    if (plan.patterns_equal())
+    {
+#ifdef VIENNACL_WITH_OPENMP
+      #pragma omp parallel for
+#endif
+      for (long k = 0; k < static_cast<long>(plan.nnz()); ++k)
+        C_elements[k] = alpha * A_elements[k] + beta * B_elements[k];
+      return;
+    }
+
+    unsigned int const * C_row_buffer = &(plan.C_row_buffer()[0]);
+    unsigned int const * C_col_buffer = plan.nnz() > 0 ? &(plan.C_col_buffer()[0]) : NULL;
+
+#ifdef VIENNACL_WITH_OPENMP
+    #pragma omp parallel for
+#endif
+    for (long i = 0; i < static_cast<long>(plan.size1()); ++i)
+    {
+      unsigned int index_A = A_row_buffer[i];
+      unsigned int index_B = B_row_buffer[i];
+      unsigned int row_end_A = A_row_buffer[i+1];
+      unsigned int row_end_B = B_row_buffer[i+1];
+
+      for (unsigned int k = C_row_buffer[i]; k < C_row_buffer[i+1]; ++k)
+      {
+        unsigned int col = C_col_buffer[k];
+        NumericT value = 0;
+        if (index_A < row_end_A && A_col_buffer[index_A] == col)
+          value += alpha * A_elements[index_A++];
+        if (index_B < row_end_B && B_col_buffer[index_B] == col)
+          value += beta * B_elements[index_B++];
+        C_elements[k] = value;
+      }
+    }
+  }
+
+  /** @brief Sets the index into the value array of C for each entry of a summand from the CSR pattern of the summand and the index of the entry for each position in the pattern. */
+  inline void spgeam_targets(viennacl::linalg::spgeam_plan const & plan,
+                             std::vector<unsigned int> const & row_buffer, std::vector<unsigned int> const & col_buffer, std::vector<unsigned int> const & permutation,
+                             std::vector<unsigned int> & targets)
+  {
+    unsigned int const * C_row_buffer = &(plan.C_row_buffer()[0]);
+    unsigned int const * C_col_buffer = plan.nnz() > 0 ? &(plan.C_col_buffer()[0]) : NULL;
+
+    targets.resize(row_buffer[plan.size1()]);
+#ifdef VIENNACL_WITH_OPENMP
+    #pragma omp parallel for
+#endif
+    for (long i = 0; i < static_cast<long>(plan.size1()); ++i)
+    {
+      // the pattern of the summand is a subsequence of the pattern of C in each row:
+      unsigned int index_C = C_row_buffer[i];
+      for (unsigned int j = row_buffer[vcl_size_t(i)]; j < row_buffer[vcl_size_t(i) + 1]; ++j)
+      {
+        while (C_col_buffer[index_C] != col_buffer[j])
+          ++index_C;
+        targets[permutation[j]] = index_C;
+      }
+    }
+  }
+
+  /** @brief Returns true if C is a coordinate matrix in host memory holding the sparsity pattern of the plan in row-major order, in which case only its values need to be written. */
+  template<typename NumericT, unsigned int AlignmentV>
+  bool coo_pattern_equal(viennacl::coordinate_matrix<NumericT, AlignmentV> const & C, viennacl::linalg::spgeam_plan const & plan)
+  {
+    if (   C.handle12().get_active_handle_id() != viennacl::MAIN_MEMORY
+        || C.size1() != plan.size1() || C.size2() != plan.size2() || C.nnz() != plan.nnz())
+      return false;
+
+    unsigned int const * C_coords     = extract_raw_pointer<unsigned int>(C.handle12());
+    unsigned int const * C_row_buffer = &(plan.C_row_buffer()[0]);
+    unsigned int const * C_col_buffer = plan.nnz() > 0 ? &(plan.C_col_buffer()[0]) : NULL;
+
+    long mismatches = 0;
+#ifdef VIENNACL_WITH_OPENMP
+    #pragma omp parallel for reduction(+: mismatches)
+#endif
+    for (long i = 0; i < static_cast<long>(plan.size1()); ++i)
+      for (unsigned int k = C_row_buffer[i]; k < C_row_buffer[i+1]; ++k)
+        if (C_coords[2*k] != static_cast<unsigned int>(i) || C_coords[2*k+1] != C_col_buffer[k])
+        {
+          ++mismatches;
+          break;
+        }
+    return mismatches == 0;
+  }
+}
+
+/** @brief Symbolic stage of the sparse matrix sum C = alpha * A + beta * B for CSR matrices: Computes the sparsity pattern of C.
+*
+* The column indices in each row of A and B are required to be sorted, which is the case for matrices set up via viennacl::copy() or obtained from sparse matrix products.
+*
+* @param A     First summand
+* @param B     Second summand
+* @param plan  The plan to be set up
+*/
+template<typename NumericT, unsigned int AlignmentV>
+void spgeam_symbolic(viennacl::compressed_matrix<NumericT, AlignmentV> const & A,
+                     viennacl::compressed_matrix<NumericT, AlignmentV> const & B,
+                     viennacl::linalg::spgeam_plan & plan)
+{
+  detail::csr_spgeam_symbolic(A.size1(), A.size2(),
+                              detail::extract_raw_pointer<unsigned int>(A.handle1()), detail::extract_raw_pointer<unsigned int>(A.handle2()),
+                              detail::extract_raw_pointer<unsigned int>(B.handle1()), detail::extract_raw_pointer<unsigned int>(B.handle2()),
+                              plan);
+}
+
+/** @brief Numeric stage of the sparse matrix sum C = alpha * A + beta * B for CSR matrices using the plan from spgeam_symbolic().
+*
+* If C already holds the sparsity pattern of the plan, e.g. when C is the result of a previous call, only the values are written.
+* In this case, C may also be A or B and is updated in place. Otherwise, the pattern of the plan is copied to C first.
+*
+* @param plan   The plan obtained from spgeam_symbolic() for matrices with the same sparsity patterns as A and B
+* @param A      First summand
+* @param alpha  Scaling factor for A
+* @param B      Second summand
+* @param beta   Scaling factor for B
+* @param C      Result matrix
+*/
+template<typename NumericT, unsigned int AlignmentV>
+void spgeam_numeric(viennacl::linalg::spgeam_plan const & plan,
+                    viennacl::compressed_matrix<NumericT, AlignmentV> const & A, NumericT alpha,
+                    viennacl::compressed_matrix<NumericT, AlignmentV> const & B, NumericT beta,
+                    viennacl::compressed_matrix<NumericT, AlignmentV> & C)
+{
+  bool pattern_set = detail::csr_pattern_equal(C, plan.size1(), plan.size2(), plan.C_row_buffer(), plan.C_col_buffer());
+
+  // C is a summand with a smaller pattern than the sum, hence needs to be reallocated anyway:
+  if (!pattern_set && (&C == &A || &C == &B))
+  {
+    viennacl::compressed_matrix<NumericT, AlignmentV> temp(viennacl::context(viennacl::MAIN_MEMORY));
+    viennacl::linalg::host_based::spgeam_numeric(plan, A, alpha, B, beta, temp);
+    C = temp;
+    return;
+  }
+
+  // write sparsity pattern of C. Memory is only allocated if C is too small:
+  if (!pattern_set)
+  {
+    if (C.handle1().get_active_handle_id() != viennacl::MAIN_MEMORY)
+      C.switch_memory_context(viennacl::context(viennacl::MAIN_MEMORY));
+    C.resize(plan.size1(), plan.size2(), false);
+    std::copy(plan.C_row_buffer().begin(), plan.C_row_buffer().end(), detail::extract_raw_pointer<unsigned int>(C.handle1()));
+    C.reserve(plan.nnz(), false); // row offsets first, so that new memory is placed according to the row partition
+    std::copy(plan.C_col_buffer().begin(), plan.C_col_buffer().end(), detail::extract_raw_pointer<unsigned int>(C.handle2()));
+  }
+
+  // in place for C == A: if C holds the pattern of the sum, the pattern of A is the pattern of C, so each value of A is read before it is overwritten
+  detail::csr_spgeam_numeric(plan,
+                             detail::extract_raw_pointer<unsigned int>(A.handle1()), detail::extract_raw_pointer<unsigned int>(A.handle2()), detail::extract_raw_pointer<NumericT>(A.handle()), alpha,
+                             detail::extract_raw_pointer<unsigned int>(B.handle1()), detail::extract_raw_pointer<unsigned int>(B.handle2()), detail::extract_raw_pointer<NumericT>(B.handle()), beta,
+                             detail::extract_raw_pointer<NumericT>(C.handle()));
+  if (!pattern_set)
+    C.generate_row_block_information();
+}
+
+/** @brief Symbolic stage of the sparse matrix sum C = alpha * A + beta * B for coordinate matrices: Computes the sparsity pattern of C and the position in C of each entry of A and B.
+*
+* The entries of A and B may be stored in any order, but must not contain duplicates. The sorting of the entries is only carried out here, not in the numeric stage.
+*
+* @param A     First summand
+* @param B     Second summand
+* @param plan  The plan to be set up
+*/
+template<typename NumericT, unsigned int AlignmentV>
+void spgeam_symbolic(viennacl::coordinate_matrix<NumericT, AlignmentV> const & A,
+                     viennacl::coordinate_matrix<NumericT, AlignmentV> const & B,
+                     viennacl::linalg::spgeam_plan & plan)
+{
+  std::vector<unsigned int> A_row_buffer, A_col_buffer, A_permutation;
+  std::vector<unsigned int> B_row_buffer, B_col_buffer, B_permutation;
+  detail::sparse_to_csr_pattern(A, A_row_buffer, A_col_buffer, A_permutation);
+  detail::sparse_to_csr_pattern(B, B_row_buffer, B_col_buffer, B_permutation);
+
+  detail::csr_spgeam_symbolic(A.size1(), A.size2(), &(A_row_buffer[0]), &(A_col_buffer[0]), &(B_row_buffer[0]), &(B_col_buffer[0]), plan);
+  detail::spgeam_targets(plan, A_row_buffer, A_col_buffer, A_permutation, plan.A_targets());
+  detail::spgeam_targets(plan, B_row_buffer, B_col_buffer, B_permutation, plan.B_targets());
+}
+
+/** @brief Numeric stage of the sparse matrix sum C = alpha * A + beta * B for coordinate matrices using the plan from spgeam_symbolic().
+*
+* The entries of A and B are added to their positions in C as recorded in the plan, so A and B are not sorted again.
+* If C already holds the sparsity pattern of the plan, e.g. when C is the result of a previous call, only the values are written.
+* Otherwise, the entries of C are stored in row-major order. C must not be A or B.
+*
+* @param plan   The plan obtained from spgeam_symbolic() for matrices with the same sparsity patterns as A and B
+* @param A      First summand
+* @param alpha  Scaling factor for A
+* @param B      Second summand
+* @param beta   Scaling factor for B
+* @param C      Result matrix
+*/
+template<typename NumericT, unsigned int AlignmentV>
+void spgeam_numeric(viennacl::linalg::spgeam_plan const & plan,
+                    viennacl::coordinate_matrix<NumericT, AlignmentV> const & A, NumericT alpha,
+                    viennacl::coordinate_matrix<NumericT, AlignmentV> const & B, NumericT beta,
+                    viennacl::coordinate_matrix<NumericT, AlignmentV> & C)
+{
+  assert( (plan.A_targets().size() == A.nnz() && plan.B_targets().size() == B.nnz()) && bool("Plan for sparse matrix sum not set up for coordinate matrices"));
+
+  bool pattern_set = detail::coo_pattern_equal(C, plan);
+
+  std::vector<NumericT> C_values;
+  if (!pattern_set)
+    C_values.resize(std::max<vcl_size_t>(plan.nnz(), 1));
+  NumericT * C_elements = pattern_set ? detail::extract_raw_pointer<NumericT>(C.handle()) : &(C_values[0]);
+
+  NumericT     const * A_elements = detail::extract_raw_pointer<NumericT>(A.handle());
+  NumericT     const * B_elements = detail::extract_raw_pointer<NumericT>(B.handle());
+  unsigned int const * A_targets  = A.nnz() > 0 ? &(plan.A_targets()[0]) : NULL;
+  unsigned int const * B_targets  = B.nnz() > 0 ? &(plan.B_targets()[0]) : NULL;
+
+  // each entry of A and B has its own target, so the scatter of each summand is free of conflicts:
+#ifdef VIENNACL_WITH_OPENMP
+  #pragma omp parallel
+#endif
+  {
+#ifdef VIENNACL_WITH_OPENMP
+    #pragma omp for
+#endif
+    for (long k = 0; k < static_cast<long>(plan.nnz()); ++k)
+      C_elements[k] = 0;
+
+#ifdef VIENNACL_WITH_OPENMP
+    #pragma omp for
+#endif
+    for (long k = 0; k < static_cast<long>(A.nnz()); ++k)
+      C_elements[A_targets[k]] += alpha * A_elements[k];
+
+#ifdef VIENNACL_WITH_OPENMP
+    #pragma omp for
+#endif
+    for (long k = 0; k < static_cast<long>(B.nnz()); ++k)
+      C_elements[B_targets[k]] += beta * B_elements[k];
+  }
+
+  if (!pattern_set)
+  {
+    std::vector<unsigned int> const & C_col_buffer = plan.C_col_buffer();
+    // found via argument-dependent lookup, since the sparse matrix types are only forward-declared here:
+    copy(viennacl::tools::const_csr_matrix_adapter<NumericT>(&(plan.C_row_buffer()[0]), plan.nnz() > 0 ? &(C_col_buffer[0]) : NULL, &(C_values[0]), plan.size1(), plan.size2()), C);
+  }
+}
+
+
+//
+// Assembly of CSR matrices from (row, column, value) triplets
+//
+
+namespace detail
+{
+  /** @brief Returns the largest row and column index of the triplets plus one, i.e. the smallest matrix size holding all triplets. */
+  inline void triplet_index_bounds(unsigned int const * row_indices, unsigned int const * col_indices, vcl_size_t n,
+                                   vcl_size_t & size1, vcl_size_t & size2)
+  {
+    unsigned int max_row = 0;
+    unsigned int max_col = 0;
+#ifdef VIENNACL_WITH_OPENMP
+    #pragma omp parallel if (n > 16384)
+#endif
+    {
+      unsigned int thread_max_row = 0;
+      unsigned int thread_max_col = 0;
+#ifdef VIENNACL_WITH_OPENMP
+      #pragma omp for nowait
+#endif
+      for (long k = 0; k < static_cast<long>(n); ++k)
+      {
+        thread_max_row = std::max(thread_max_row, row_indices[k]);
+        thread_max_col = std::max(thread_max_col, col_indices[k]);
+      }
+#ifdef VIENNACL_WITH_OPENMP
+      #pragma omp critical
+#endif
+      {
+        max_row = std::max(max_row, thread_max_row);
+        max_col = std::max(max_col, thread_max_col);
+      }
+    }
+    size1 = (n > 0) ? vcl_size_t(max_row) + 1 : 0;
+    size2 = (n > 0) ? vcl_size_t(max_col) + 1 : 0;
+  }
+}
+
+/** @brief Sets up a compressed_matrix from (row, column, value) triplets given in arbitrary order. Values of duplicate entries are summed.
+*
+* The triplets are first grouped by row with the parallel bucketed counting sort also used for transposition.
+* Each row is then sorted by column index, duplicates are summed, and the compacted rows are written to A. No maps or other intermediate containers per entry are used.
+*
+* @param row_indices  Row index of each triplet
+* @param col_indices  Column index of each triplet
+* @param values       Value of each triplet
+* @param n            Number of triplets
+* @param size1        Number of rows of A. All row indices must be smaller.
+* @param size2        Number of columns of A. All column indices must be smaller.
+* @param A            The matrix to be set up
+*/
+template<typename NumericT, unsigned int AlignmentV>
+void assemble_from_triplets(unsigned int const * row_indices, unsigned int const * col_indices, NumericT const * values, vcl_size_t n,
+                            vcl_size_t size1, vcl_size_t size2,
+                            viennacl::compressed_matrix<NumericT, AlignmentV> & A)
+{
+  // Stage 1: group by row (stable counting sort on the row index, i.e. transposition with the roles of row and column indices swapped):
+  std::vector<unsigned int> row_buffer(size1 + 1);
+  std::vector<unsigned int> col_buffer(std::max<vcl_size_t>(n, 1));
+  std::vector<NumericT>     elements(std::max<vcl_size_t>(n, 1));
+  detail::csr_transpose_impl(size2, size1, n,
+                             static_cast<unsigned int const *>(NULL), col_indices, row_indices, 1, values,
+                             &(row_buffer[0]), &(col_buffer[0]), 1, &(elements[0]));
+
+  // Stage 2: sort each row by column index and sum duplicates in place:
+  std::vector<unsigned int> row_lengths(size1 + 1);
+#ifdef VIENNACL_WITH_OPENMP
+  #pragma omp parallel
+#endif
+  {
+    std::vector<std::pair<unsigned int, NumericT> > row_entries;
+
+#ifdef VIENNACL_WITH_OPENMP
+    #pragma omp for schedule(dynamic, 64)
+#endif
+    for (long row = 0; row < static_cast<long>(size1); ++row)
+    {
+      unsigned int row_begin = row_buffer[vcl_size_t(row)];
+      unsigned int row_end   = row_buffer[vcl_size_t(row) + 1];
+
+      bool is_sorted = true;
+      for (unsigned int k = row_begin + 1; k < row_end; ++k)
+        if (col_buffer[k-1] > col_buffer[k])
+        {
+          is_sorted = false;
+          break;
+        }
+
+      if (!is_sorted)
+      {
+        row_entries.resize(row_end - row_begin);
+        for (unsigned int k = row_begin; k < row_end; ++k)
+          row_entries[k - row_begin] = std::make_pair(col_buffer[k], elements[k]);
+        std::sort(row_entries.begin(), row_entries.end());
+        for (unsigned int k = row_begin; k < row_end; ++k)
+        {
+          col_buffer[k] = row_entries[k - row_begin].first;
+          elements[k]   = row_entries[k - row_begin].second;
+        }
+      }
+
+      unsigned int index = row_begin;
+      for (unsigned int k = row_begin; k < row_end; ++k)
+      {
+        if (k > row_begin && col_buffer[k] == col_buffer[index - 1])
+          elements[index - 1] += elements[k];
+        else
+        {
+          col_buffer[index] = col_buffer[k];
+          elements[index]   = elements[k];
+          ++index;
+        }
+      }
+      row_lengths[vcl_size_t(row)] = index - row_begin;
+    }
+  }
+  detail::exclusive_scan_inplace(row_lengths, size1);
+
+  // Stage 3: write compacted rows to A:
+  if (A.handle1().get_active_handle_id() != viennacl::MAIN_MEMORY)
+    A.switch_memory_context(viennacl::context(viennacl::MAIN_MEMORY));
+  A.resize(size1, size2, false);
+  A.reserve(row_lengths[size1], false);
+
+  unsigned int * A_row_buffer = detail::extract_raw_pointer<unsigned int>(A.handle1());
+  unsigned int * A_col_buffer = detail::extract_raw_pointer<unsigned int>(A.handle2());
+  NumericT     * A_elements   = detail::extract_raw_pointer<NumericT>(A.handle());
+
+#ifdef VIENNACL_WITH_OPENMP
+  #pragma omp parallel for
+#endif
+  for (long row = 0; row < static_cast<long>(size1); ++row)
+  {
+    unsigned int src = row_buffer[vcl_size_t(row)];
+    unsigned int dst = row_lengths[vcl_size_t(row)];
+    unsigned int len = row_lengths[vcl_size_t(row) + 1] - dst;
+    A_row_buffer[row] = dst;
+    std::copy(col_buffer.begin() + src, col_buffer.begin() + src + len, A_col_buffer + dst);
+    std::copy(elements.begin()   + src, elements.begin()   + src + len, A_elements   + dst);
+  }
+  A_row_buffer[size1] = row_lengths[size1];
+  A.generate_row_block_information();
+}
+
+
+//
+// Pattern-preserving value updates from (row, column, value) triplets
+//
+
+namespace detail
+{
+  /** @brief Sums the values of the triplets mapped to each nonzero by the plan and writes the sums to 'result' (plan.nnz() entries). Nonzeros without triplets are set to zero. */
+  template<typename NumericT>
+  void value_update_sum(viennacl::linalg::value_update_plan const & plan, NumericT const * values, NumericT * result)
+  {
+    unsigned int const * offsets         = &(plan.offsets()[0]);
+    unsigned int const * triplet_indices = plan.num_triplets() > 0 ? &(plan.triplet_indices()[0]) : NULL;
+
+#ifdef VIENNACL_WITH_OPENMP
+    #pragma omp parallel for
+#endif
+    for (long i = 0; i < static_cast<long>(plan.nnz()); ++i)
+    {
+      NumericT sum = 0;
+      for (unsigned int j = offsets[i]; j < offsets[i+1]; ++j)
+        sum += values[triplet_indices[j]];
+      result[i] = sum;
+    }
+  }
+}
+
+/** @brief Determines the position of each (row, column) triplet in the value array of A and groups the triplets by position.
+*
+* Within each row, the column index is located by binary search if the row is sorted, and by linear search otherwise. All triplets must refer to nonzeros of A.
+*
+* @param A            The matrix with fixed sparsity pattern
+* @param row_indices  Row index of each triplet
+* @param col_indices  Column index of each triplet
+* @param n            Number of triplets
+* @param plan         The plan to be set up
+*/
+template<typename NumericT, unsigned int AlignmentV>
+void value_update_symbolic(viennacl::compressed_matrix<NumericT, AlignmentV> const & A,
+                           unsigned int const * row_indices, unsigned int const * col_indices, vcl_size_t n,
+                           viennacl::linalg::value_update_plan & plan)
+{
+  unsigned int const * A_row_buffer = detail::extract_raw_pointer<unsigned int>(A.handle1());
+  unsigned int const * A_col_buffer = detail::extract_raw_pointer<unsigned int>(A.handle2());
+  unsigned int A_nnz = A_row_buffer[A.size1()];
+
+  // position of each triplet in the value array of A:
+  std::vector<unsigned int> positions(n);
+#ifdef VIENNACL_WITH_OPENMP
+  #pragma omp parallel for
+#endif
+  for (long k = 0; k < static_cast<long>(n); ++k)
+  {
+    unsigned int row = row_indices[k];
+    unsigned int col = col_indices[k];
+    assert(row < A.size1() && bool("Error in value_update_symbolic(): Row index out of range!"));
+
+    unsigned int const * row_begin = A_col_buffer + A_row_buffer[row];
+    unsigned int const * row_end   = A_col_buffer + A_row_buffer[row+1];
+    unsigned int const * it = std::lower_bound(row_begin, row_end, col);
+    if (it == row_end || *it != col) // row not sorted or entry not in pattern
+      it = std::find(row_begin, row_end, col);
+    assert(it != row_end && bool("Error in value_update_symbolic(): Triplet does not refer to a nonzero of the matrix!"));
+
+    positions[vcl_size_t(k)] = (it != row_end) ? static_cast<unsigned int>(it - A_col_buffer) : A_nnz; // triplets outside the pattern are dropped
+  }
+
+  // group triplets by position (counting sort):
+  std::vector<unsigned int> & offsets = plan.offsets();
+  offsets.assign(vcl_size_t(A_nnz) + 2, 0);
+  for (vcl_size_t k = 0; k < n; ++k)
+    ++offsets[positions[k]];
+  detail::exclusive_scan_inplace(offsets, vcl_size_t(A_nnz) + 1);
+
+  std::vector<unsigned int> & triplet_indices = plan.triplet_indices();
+  triplet_indices.resize(n);
+  for (vcl_size_t k = 0; k < n; ++k)
+  {
+    if (positions[k] < A_nnz)
+      triplet_indices[offsets[positions[k]]++] = static_cast<unsigned int>(k);
+  }
+
+  // restore offsets (shifted by one entry during the scatter) and drop the bucket of dropped triplets:
+  for (vcl_size_t i = A_nnz; i > 0; --i)
+    offsets[i] = offsets[i-1];
+  offsets[0] = 0;
+  offsets.resize(vcl_size_t(A_nnz) + 1);
+  triplet_indices.resize(offsets[A_nnz]);
+
+  plan.set_sizes(A.size1(), A.size2());
+}
+
+/** @brief Overwrites the values of A with the sums of the triplet values mapped to each nonzero by the plan. The sparsity pattern of A is not modified.
+*
+* @param plan     Plan obtained from value_update_symbolic() for A and the row and column indices of the triplets
+* @param values   Value of each triplet
+* @param A        The matrix to be updated
+*/
+template<typename NumericT, unsigned int AlignmentV>
+void value_update_numeric(viennacl::linalg::value_update_plan const & plan,
+                          NumericT const * values,
+                          viennacl::compressed_matrix<NumericT, AlignmentV> & A)
+{
+  detail::value_update_sum(plan, values, detail::extract_raw_pointer<NumericT>(A.handle()));
+}
+
+
 } // namespace host_based
 } //namespace linalg
 } //namespace viennacl
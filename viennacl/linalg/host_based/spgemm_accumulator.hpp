@@ -0,0 +1,262 @@
+#ifndef VIENNACL_LINALG_HOST_BASED_SPGEMM_ACCUMULATOR_HPP_
+#define VIENNACL_LINALG_HOST_BASED_SPGEMM_ACCUMULATOR_HPP_
+
+/* =========================================================================
+   Copyright (c) 2010-2016, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+   Portions of this software are copyright by UChicago Argonne, LLC.
+
+                            -----------------
+                  ViennaCL - The Vienna Computing Library
+                            -----------------
+
+   Project Head:    Karl Rupp                   rupp@iue.tuwien.ac.at
+
+   (A list of authors and contributors can be found in the manual)
+
+   License:         MIT (X11), see file LICENSE in the base directory
+============================================================================= */
+
+/** @file viennacl/linalg/host_based/spgemm_accumulator.hpp
+    @brief Hash-based and dense row accumulators for sparse matrix-matrix products on the CPU. Complements the row-merge kernels in spgemm_vector.hpp.
+*/
+
+#include <algorithm>
+
+#include "viennacl/forwards.h"
+#include "viennacl/linalg/host_based/common.hpp"
+
+namespace viennacl
+{
+namespace linalg
+{
+namespace host_based
+{
+
+/** @brief Accumulation strategy used for computing a row of C = A * B */
+enum spgemm_row_strategy
+{
+  SPGEMM_ROW_MERGE = 0,  // merge the rows of B (spgemm_vector.hpp). Best for few rows of B per row of C.
+  SPGEMM_ROW_HASH,       // hash table with linear probing. Best for many rows of B with moderate fill-in.
+  SPGEMM_ROW_DENSE       // dense work array of length size2(B). Best for rows of C with high fill ratio.
+};
+
+/** @brief Picks the accumulator for a row of C = A * B from the number of nonzeros in the row of A and the upper bound for the row length of C.
+*
+* @param nnz_row_A             Number of nonzeros in the row of A (i.e. number of rows of B to be combined)
+* @param row_C_upper_bound     Sum of the row lengths of B referenced by the row of A
+* @param B_size2               Number of columns of B
+*/
+inline spgemm_row_strategy spgemm_select_row_strategy(unsigned int nnz_row_A, unsigned int row_C_upper_bound, unsigned int B_size2)
+{
+  if (nnz_row_A <= 4)
+    return SPGEMM_ROW_MERGE;
+  if (row_C_upper_bound >= B_size2 / 4)
+    return SPGEMM_ROW_DENSE;
+  return SPGEMM_ROW_HASH;
+}
+
+/** @brief Returns the size of the hash table (a power of two with load factor at most 1/2) for a row with the given upper bound for the number of entries */
+inline unsigned int spgemm_hash_table_size(unsigned int row_C_upper_bound)
+{
+  unsigned int table_size = 16;
+  while (table_size < 2 * row_C_upper_bound)
+    table_size *= 2;
+  return table_size;
+}
+
+/** @brief Marks unused slots in the hash table. */
+static const unsigned int spgemm_hash_empty_key = ~0u;
+
+/** @brief Returns the slot of column index 'col' in the hash table, inserting it if not present. 'is_new' is set if the key was inserted. */
+inline unsigned int spgemm_hash_find_or_insert(unsigned int *table_keys, unsigned int table_mask, unsigned int col, bool & is_new)
+{
+  unsigned int slot = (col * 2654435761u) & table_mask; // multiplicative hashing (Knuth)
+  while (true)
+  {
+    unsigned int key = table_keys[slot];
+    if (key == col)
+    {
+      is_new = false;
+      return slot;
+    }
+    if (key == spgemm_hash_empty_key)
+    {
+      table_keys[slot] = col;
+      is_new = true;
+      return slot;
+    }
+    slot = (slot + 1) & table_mask;
+  }
+}
+
+/** @brief Returns the slot of column index 'col' in the hash table. The key must be present. */
+inline unsigned int spgemm_hash_find(unsigned int const *table_keys, unsigned int table_mask, unsigned int col)
+{
+  unsigned int slot = (col * 2654435761u) & table_mask;
+  while (table_keys[slot] != col)
+    slot = (slot + 1) & table_mask;
+  return slot;
+}
+
+
+/** @brief Computes the number of nonzeros in a row of C = A * B using a hash table.
+*
+* @param table_keys   Work array of at least spgemm_hash_table_size(row_C_upper_bound) entries, all set to spgemm_hash_empty_key. Reset on return.
+*/
+inline unsigned int row_C_scan_symbolic_hash(unsigned int row_start_A, unsigned int row_end_A, unsigned int const *A_col_buffer,
+                                             unsigned int const *B_row_buffer, unsigned int const *B_col_buffer,
+                                             unsigned int row_C_upper_bound,
+                                             unsigned int *table_keys)
+{
+  unsigned int table_size = spgemm_hash_table_size(row_C_upper_bound);
+  unsigned int table_mask = table_size - 1;
+
+  unsigned int row_C_len = 0;
+  for (unsigned int j = row_start_A; j < row_end_A; ++j)
+  {
+    unsigned int row_B = A_col_buffer[j];
+    for (unsigned int k = B_row_buffer[row_B]; k < B_row_buffer[row_B+1]; ++k)
+    {
+      bool is_new;
+      spgemm_hash_find_or_insert(table_keys, table_mask, B_col_buffer[k], is_new);
+      if (is_new)
+        ++row_C_len;
+    }
+  }
+
+  std::fill(table_keys, table_keys + table_size, spgemm_hash_empty_key);
+  return row_C_len;
+}
+
+/** @brief Computes a row of C = A * B using a hash table. The row length in C must have been determined by row_C_scan_symbolic_hash() before.
+*
+* @param table_keys     Work array of at least spgemm_hash_table_size(row_C_upper_bound) entries, all set to spgemm_hash_empty_key. Reset on return.
+* @param table_values   Work array of at least spgemm_hash_table_size(row_C_upper_bound) entries
+*/
+template<typename NumericT>
+void row_C_scan_numeric_hash(unsigned int row_start_A, unsigned int row_end_A, unsigned int const *A_col_buffer, NumericT const *A_elements,
+                             unsigned int const *B_row_buffer, unsigned int const *B_col_buffer, NumericT const *B_elements,
+                             unsigned int row_C_upper_bound,
+                             unsigned int row_start_C, unsigned int row_end_C, unsigned int *C_col_buffer, NumericT *C_elements,
+                             unsigned int *table_keys, NumericT *table_values)
+{
+  unsigned int table_size = spgemm_hash_table_size(row_C_upper_bound);
+  unsigned int table_mask = table_size - 1;
+
+  unsigned int *C_col_ptr = C_col_buffer + row_start_C;
+  for (unsigned int j = row_start_A; j < row_end_A; ++j)
+  {
+    unsigned int row_B = A_col_buffer[j];
+    NumericT val_A = A_elements[j];
+    for (unsigned int k = B_row_buffer[row_B]; k < B_row_buffer[row_B+1]; ++k)
+    {
+      bool is_new;
+      unsigned int slot = spgemm_hash_find_or_insert(table_keys, table_mask, B_col_buffer[k], is_new);
+      if (is_new)
+      {
+        table_values[slot] = val_A * B_elements[k];
+        *C_col_ptr++ = B_col_buffer[k];
+      }
+      else
+        table_values[slot] += val_A * B_elements[k];
+    }
+  }
+
+  // write sorted output:
+  std::sort(C_col_buffer + row_start_C, C_col_buffer + row_end_C);
+  for (unsigned int k = row_start_C; k < row_end_C; ++k)
+  {
+    unsigned int slot = spgemm_hash_find(table_keys, table_mask, C_col_buffer[k]);
+    C_elements[k] = table_values[slot];
+  }
+
+  std::fill(table_keys, table_keys + table_size, spgemm_hash_empty_key);
+}
+
+
+/** @brief Computes the number of nonzeros in a row of C = A * B using a dense marker array.
+*
+* @param dense_flags   Work array of size2(B) entries, all zero. Reset on return.
+*/
+inline unsigned int row_C_scan_symbolic_dense(unsigned int row_start_A, unsigned int row_end_A, unsigned int const *A_col_buffer,
+                                              unsigned int const *B_row_buffer, unsigned int const *B_col_buffer,
+                                              unsigned char *dense_flags)
+{
+  unsigned int row_C_len = 0;
+  unsigned int min_col = ~0u;
+  unsigned int max_col = 0;
+  for (unsigned int j = row_start_A; j < row_end_A; ++j)
+  {
+    unsigned int row_B = A_col_buffer[j];
+    for (unsigned int k = B_row_buffer[row_B]; k < B_row_buffer[row_B+1]; ++k)
+    {
+      unsigned int col = B_col_buffer[k];
+      row_C_len += 1 - dense_flags[col];
+      dense_flags[col] = 1;
+      min_col = std::min(min_col, col);
+      max_col = std::max(max_col, col);
+    }
+  }
+
+  if (row_C_len > 0)
+    std::fill(dense_flags + min_col, dense_flags + max_col + 1, static_cast<unsigned char>(0));
+  return row_C_len;
+}
+
+/** @brief Computes a row of C = A * B using a dense work array. The row length in C must have been determined by row_C_scan_symbolic_dense() before.
+*
+* @param dense_flags    Work array of size2(B) entries, all zero. Reset on return.
+* @param dense_values   Work array of size2(B) entries
+*/
+template<typename NumericT>
+void row_C_scan_numeric_dense(unsigned int row_start_A, unsigned int row_end_A, unsigned int const *A_col_buffer, NumericT const *A_elements,
+                              unsigned int const *B_row_buffer, unsigned int const *B_col_buffer, NumericT const *B_elements,
+                              unsigned int row_start_C, unsigned int *C_col_buffer, NumericT *C_elements,
+                              unsigned char *dense_flags, NumericT *dense_values)
+{
+  unsigned int min_col = ~0u;
+  unsigned int max_col = 0;
+  for (unsigned int j = row_start_A; j < row_end_A; ++j)
+  {
+    unsigned int row_B = A_col_buffer[j];
+    NumericT val_A = A_elements[j];
+    for (unsigned int k = B_row_buffer[row_B]; k < B_row_buffer[row_B+1]; ++k)
+    {
+      unsigned int col = B_col_buffer[k];
+      if (dense_flags[col])
+        dense_values[col] += val_A * B_elements[k];
+      else
+      {
+        dense_values[col] = val_A * B_elements[k];
+        dense_flags[col] = 1;
+      }
+      min_col = std::min(min_col, col);
+      max_col = std::max(max_col, col);
+    }
+  }
+
+  if (min_col > max_col) // empty row
+    return;
+
+  // scanning the dense array yields sorted output:
+  unsigned int index_C = row_start_C;
+  for (unsigned int col = min_col; col <= max_col; ++col)
+  {
+    if (dense_flags[col])
+    {
+      C_col_buffer[index_C] = col;
+      C_elements[index_C]   = dense_values[col];
+      dense_flags[col] = 0;
+      ++index_C;
+    }
+  }
+}
+
+} // namespace host_based
+} //namespace linalg
+} //namespace viennacl
+
+
+#endif
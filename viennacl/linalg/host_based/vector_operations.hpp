@@ -78,7 +78,7 @@ void convert(vector_base<DestNumericT> & dest, vector_base<SrcNumericT> const &
   vcl_size_t inc_src   = viennacl::traits::stride(src);
 
 #ifdef VIENNACL_WITH_OPENMP
-  #pragma omp parallel for if (size_dest > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
+  #pragma omp parallel for schedule(static) if (size_dest > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
 #endif
   for (long i = 0; i < static_cast<long>(size_dest); ++i)
     data_dest[static_cast<vcl_size_t>(i)*inc_dest+start_dest] = static_cast<DestNumericT>(data_src[static_cast<vcl_size_t>(i)*inc_src+start_src]);
@@ -107,7 +107,7 @@ void av(vector_base<NumericT> & vec1,
   if (reciprocal_alpha)
   {
 #ifdef VIENNACL_WITH_OPENMP
-    #pragma omp parallel for if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
+    #pragma omp parallel for schedule(static) if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
 #endif
     for (long i = 0; i < static_cast<long>(size1); ++i)
       data_vec1[static_cast<vcl_size_t>(i)*inc1+start1] = data_vec2[static_cast<vcl_size_t>(i)*inc2+start2] / data_alpha;
@@ -115,7 +115,7 @@ void av(vector_base<NumericT> & vec1,
   else
   {
 #ifdef VIENNACL_WITH_OPENMP
-    #pragma omp parallel for if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
+    #pragma omp parallel for schedule(static) if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
 #endif
     for (long i = 0; i < static_cast<long>(size1); ++i)
       data_vec1[static_cast<vcl_size_t>(i)*inc1+start1] = data_vec2[static_cast<vcl_size_t>(i)*inc2+start2] * data_alpha;
@@ -157,7 +157,7 @@ void avbv(vector_base<NumericT> & vec1,
     if (reciprocal_beta)
     {
 #ifdef VIENNACL_WITH_OPENMP
-      #pragma omp parallel for if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
+      #pragma omp parallel for schedule(static) if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
 #endif
       for (long i = 0; i < static_cast<long>(size1); ++i)
         data_vec1[static_cast<vcl_size_t>(i)*inc1+start1] = data_vec2[static_cast<vcl_size_t>(i)*inc2+start2] / data_alpha + data_vec3[static_cast<vcl_size_t>(i)*inc3+start3] / data_beta;
@@ -165,7 +165,7 @@ void avbv(vector_base<NumericT> & vec1,
     else
     {
 #ifdef VIENNACL_WITH_OPENMP
-      #pragma omp parallel for if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
+      #pragma omp parallel for schedule(static) if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
 #endif
       for (long i = 0; i < static_cast<long>(size1); ++i)
         data_vec1[static_cast<vcl_size_t>(i)*inc1+start1] = data_vec2[static_cast<vcl_size_t>(i)*inc2+start2] / data_alpha + data_vec3[static_cast<vcl_size_t>(i)*inc3+start3] * data_beta;
@@ -176,7 +176,7 @@ void avbv(vector_base<NumericT> & vec1,
     if (reciprocal_beta)
     {
 #ifdef VIENNACL_WITH_OPENMP
-      #pragma omp parallel for if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
+      #pragma omp parallel for schedule(static) if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
 #endif
       for (long i = 0; i < static_cast<long>(size1); ++i)
         data_vec1[static_cast<vcl_size_t>(i)*inc1+start1] = data_vec2[static_cast<vcl_size_t>(i)*inc2+start2] * data_alpha + data_vec3[static_cast<vcl_size_t>(i)*inc3+start3] / data_beta;
@@ -184,7 +184,7 @@ void avbv(vector_base<NumericT> & vec1,
     else
     {
 #ifdef VIENNACL_WITH_OPENMP
-      #pragma omp parallel for if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
+      #pragma omp parallel for schedule(static) if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
 #endif
       for (long i = 0; i < static_cast<long>(size1); ++i)
         data_vec1[static_cast<vcl_size_t>(i)*inc1+start1] = data_vec2[static_cast<vcl_size_t>(i)*inc2+start2] * data_alpha + data_vec3[static_cast<vcl_size_t>(i)*inc3+start3] * data_beta;
@@ -227,7 +227,7 @@ void avbv_v(vector_base<NumericT> & vec1,
     if (reciprocal_beta)
     {
 #ifdef VIENNACL_WITH_OPENMP
-      #pragma omp parallel for if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
+      #pragma omp parallel for schedule(static) if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
 #endif
       for (long i = 0; i < static_cast<long>(size1); ++i)
         data_vec1[static_cast<vcl_size_t>(i)*inc1+start1] += data_vec2[static_cast<vcl_size_t>(i)*inc2+start2] / data_alpha + data_vec3[static_cast<vcl_size_t>(i)*inc3+start3] / data_beta;
@@ -235,7 +235,7 @@ void avbv_v(vector_base<NumericT> & vec1,
     else
     {
 #ifdef VIENNACL_WITH_OPENMP
-      #pragma omp parallel for if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
+      #pragma omp parallel for schedule(static) if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
 #endif
       for (long i = 0; i < static_cast<long>(size1); ++i)
         data_vec1[static_cast<vcl_size_t>(i)*inc1+start1] += data_vec2[static_cast<vcl_size_t>(i)*inc2+start2] / data_alpha + data_vec3[static_cast<vcl_size_t>(i)*inc3+start3] * data_beta;
@@ -246,7 +246,7 @@ void avbv_v(vector_base<NumericT> & vec1,
     if (reciprocal_beta)
     {
 #ifdef VIENNACL_WITH_OPENMP
-      #pragma omp parallel for if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
+      #pragma omp parallel for schedule(static) if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
 #endif
       for (long i = 0; i < static_cast<long>(size1); ++i)
         data_vec1[static_cast<vcl_size_t>(i)*inc1+start1] += data_vec2[static_cast<vcl_size_t>(i)*inc2+start2] * data_alpha + data_vec3[static_cast<vcl_size_t>(i)*inc3+start3] / data_beta;
@@ -254,7 +254,7 @@ void avbv_v(vector_base<NumericT> & vec1,
     else
     {
 #ifdef VIENNACL_WITH_OPENMP
-      #pragma omp parallel for if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
+      #pragma omp parallel for schedule(static) if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
 #endif
       for (long i = 0; i < static_cast<long>(size1); ++i)
         data_vec1[static_cast<vcl_size_t>(i)*inc1+start1] += data_vec2[static_cast<vcl_size_t>(i)*inc2+start2] * data_alpha + data_vec3[static_cast<vcl_size_t>(i)*inc3+start3] * data_beta;
@@ -286,7 +286,7 @@ void vector_assign(vector_base<NumericT> & vec1, const NumericT & alpha, bool up
   value_type data_alpha = static_cast<value_type>(alpha);
 
 #ifdef VIENNACL_WITH_OPENMP
-  #pragma omp parallel for if (loop_bound > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
+  #pragma omp parallel for schedule(static) if (loop_bound > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
 #endif
   for (long i = 0; i < static_cast<long>(loop_bound); ++i)
     data_vec1[static_cast<vcl_size_t>(i)*inc1+start1] = data_alpha;
@@ -314,7 +314,7 @@ void vector_swap(vector_base<NumericT> & vec1, vector_base<NumericT> & vec2)
   vcl_size_t inc2   = viennacl::traits::stride(vec2);
 
 #ifdef VIENNACL_WITH_OPENMP
-  #pragma omp parallel for if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
+  #pragma omp parallel for schedule(static) if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
 #endif
   for (long i = 0; i < static_cast<long>(size1); ++i)
   {
@@ -354,7 +354,7 @@ void element_op(vector_base<NumericT> & vec1,
   vcl_size_t inc3   = viennacl::traits::stride(proxy.rhs());
 
 #ifdef VIENNACL_WITH_OPENMP
-  #pragma omp parallel for if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
+  #pragma omp parallel for schedule(static) if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
 #endif
   for (long i = 0; i < static_cast<long>(size1); ++i)
     OpFunctor::apply(data_vec1[static_cast<vcl_size_t>(i)*inc1+start1], data_vec2[static_cast<vcl_size_t>(i)*inc2+start2], data_vec3[static_cast<vcl_size_t>(i)*inc3+start3]);
@@ -383,7 +383,7 @@ void element_op(vector_base<NumericT> & vec1,
   vcl_size_t inc2   = viennacl::traits::stride(proxy.lhs());
 
 #ifdef VIENNACL_WITH_OPENMP
-  #pragma omp parallel for if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
+  #pragma omp parallel for schedule(static) if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
 #endif
   for (long i = 0; i < static_cast<long>(size1); ++i)
     OpFunctor::apply(data_vec1[static_cast<vcl_size_t>(i)*inc1+start1], data_vec2[static_cast<vcl_size_t>(i)*inc2+start2], proxy.rhs());
@@ -412,7 +412,7 @@ void element_op(vector_base<NumericT> & vec1,
   vcl_size_t inc3   = viennacl::traits::stride(proxy.rhs());
 
 #ifdef VIENNACL_WITH_OPENMP
-  #pragma omp parallel for if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
+  #pragma omp parallel for schedule(static) if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
 #endif
   for (long i = 0; i < static_cast<long>(size1); ++i)
     OpFunctor::apply(data_vec1[static_cast<vcl_size_t>(i)*inc1+start1], proxy.lhs(), data_vec3[static_cast<vcl_size_t>(i)*inc3+start3]);
@@ -443,7 +443,7 @@ void element_op(vector_base<NumericT> & vec1,
   vcl_size_t inc2   = viennacl::traits::stride(proxy.lhs());
 
 #ifdef VIENNACL_WITH_OPENMP
-  #pragma omp parallel for if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
+  #pragma omp parallel for schedule(static) if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
 #endif
   for (long i = 0; i < static_cast<long>(size1); ++i)
     OpFunctor::apply(data_vec1[static_cast<vcl_size_t>(i)*inc1+start1], data_vec2[static_cast<vcl_size_t>(i)*inc2+start2]);
@@ -476,13 +476,13 @@ namespace detail
 // char
 VIENNACL_INNER_PROD_IMPL_1(char, int)
 #ifdef VIENNACL_WITH_OPENMP
-  #pragma omp parallel for reduction(+: temp) if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
+  #pragma omp parallel for schedule(static) reduction(+: temp) if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
 #endif
 VIENNACL_INNER_PROD_IMPL_2(char)
 
 VIENNACL_INNER_PROD_IMPL_1(unsigned char, int)
 #ifdef VIENNACL_WITH_OPENMP
-  #pragma omp parallel for reduction(+: temp) if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
+  #pragma omp parallel for schedule(static) reduction(+: temp) if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
 #endif
 VIENNACL_INNER_PROD_IMPL_2(unsigned char)
 
@@ -490,13 +490,13 @@ VIENNACL_INNER_PROD_IMPL_2(unsigned char)
 // short
 VIENNACL_INNER_PROD_IMPL_1(short, int)
 #ifdef VIENNACL_WITH_OPENMP
-  #pragma omp parallel for reduction(+: temp) if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
+  #pragma omp parallel for schedule(static) reduction(+: temp) if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
 #endif
 VIENNACL_INNER_PROD_IMPL_2(short)
 
 VIENNACL_INNER_PROD_IMPL_1(unsigned short, int)
 #ifdef VIENNACL_WITH_OPENMP
-  #pragma omp parallel for reduction(+: temp) if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
+  #pragma omp parallel for schedule(static) reduction(+: temp) if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
 #endif
 VIENNACL_INNER_PROD_IMPL_2(unsigned short)
 
@@ -504,13 +504,13 @@ VIENNACL_INNER_PROD_IMPL_2(unsigned short)
 // int
 VIENNACL_INNER_PROD_IMPL_1(int, int)
 #ifdef VIENNACL_WITH_OPENMP
-  #pragma omp parallel for reduction(+: temp) if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
+  #pragma omp parallel for schedule(static) reduction(+: temp) if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
 #endif
 VIENNACL_INNER_PROD_IMPL_2(int)
 
 VIENNACL_INNER_PROD_IMPL_1(unsigned int, unsigned int)
 #ifdef VIENNACL_WITH_OPENMP
-  #pragma omp parallel for reduction(+: temp) if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
+  #pragma omp parallel for schedule(static) reduction(+: temp) if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
 #endif
 VIENNACL_INNER_PROD_IMPL_2(unsigned int)
 
@@ -518,13 +518,13 @@ VIENNACL_INNER_PROD_IMPL_2(unsigned int)
 // long
 VIENNACL_INNER_PROD_IMPL_1(long, long)
 #ifdef VIENNACL_WITH_OPENMP
-  #pragma omp parallel for reduction(+: temp) if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
+  #pragma omp parallel for schedule(static) reduction(+: temp) if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
 #endif
 VIENNACL_INNER_PROD_IMPL_2(long)
 
 VIENNACL_INNER_PROD_IMPL_1(unsigned long, unsigned long)
 #ifdef VIENNACL_WITH_OPENMP
-  #pragma omp parallel for reduction(+: temp) if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
+  #pragma omp parallel for schedule(static) reduction(+: temp) if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
 #endif
 VIENNACL_INNER_PROD_IMPL_2(unsigned long)
 
@@ -532,14 +532,14 @@ VIENNACL_INNER_PROD_IMPL_2(unsigned long)
 // float
 VIENNACL_INNER_PROD_IMPL_1(float, float)
 #ifdef VIENNACL_WITH_OPENMP
-  #pragma omp parallel for reduction(+: temp) if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
+  #pragma omp parallel for schedule(static) reduction(+: temp) if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
 #endif
 VIENNACL_INNER_PROD_IMPL_2(float)
 
 // double
 VIENNACL_INNER_PROD_IMPL_1(double, double)
 #ifdef VIENNACL_WITH_OPENMP
-  #pragma omp parallel for reduction(+: temp) if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
+  #pragma omp parallel for schedule(static) reduction(+: temp) if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
 #endif
 VIENNACL_INNER_PROD_IMPL_2(double)
 
@@ -628,26 +628,26 @@ namespace detail
 // char
 VIENNACL_NORM_1_IMPL_1(char, int)
 #ifdef VIENNACL_WITH_OPENMP
-  #pragma omp parallel for reduction(+: temp) if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
+  #pragma omp parallel for schedule(static) reduction(+: temp) if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
 #endif
 VIENNACL_NORM_1_IMPL_2(char, int)
 
 VIENNACL_NORM_1_IMPL_1(unsigned char, int)
 #ifdef VIENNACL_WITH_OPENMP
-  #pragma omp parallel for reduction(+: temp) if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
+  #pragma omp parallel for schedule(static) reduction(+: temp) if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
 #endif
 VIENNACL_NORM_1_IMPL_2(unsigned char, int)
 
 // short
 VIENNACL_NORM_1_IMPL_1(short, int)
 #ifdef VIENNACL_WITH_OPENMP
-  #pragma omp parallel for reduction(+: temp) if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
+  #pragma omp parallel for schedule(static) reduction(+: temp) if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
 #endif
 VIENNACL_NORM_1_IMPL_2(short, int)
 
 VIENNACL_NORM_1_IMPL_1(unsigned short, int)
 #ifdef VIENNACL_WITH_OPENMP
-  #pragma omp parallel for reduction(+: temp) if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
+  #pragma omp parallel for schedule(static) reduction(+: temp) if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
 #endif
 VIENNACL_NORM_1_IMPL_2(unsigned short, int)
 
@@ -655,13 +655,13 @@ VIENNACL_NORM_1_IMPL_2(unsigned short, int)
 // int
 VIENNACL_NORM_1_IMPL_1(int, int)
 #ifdef VIENNACL_WITH_OPENMP
-  #pragma omp parallel for reduction(+: temp) if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
+  #pragma omp parallel for schedule(static) reduction(+: temp) if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
 #endif
 VIENNACL_NORM_1_IMPL_2(int, int)
 
 VIENNACL_NORM_1_IMPL_1(unsigned int, unsigned int)
 #ifdef VIENNACL_WITH_OPENMP
-  #pragma omp parallel for reduction(+: temp) if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
+  #pragma omp parallel for schedule(static) reduction(+: temp) if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
 #endif
 VIENNACL_NORM_1_IMPL_2(unsigned int, unsigned int)
 
@@ -669,13 +669,13 @@ VIENNACL_NORM_1_IMPL_2(unsigned int, unsigned int)
 // long
 VIENNACL_NORM_1_IMPL_1(long, long)
 #ifdef VIENNACL_WITH_OPENMP
-  #pragma omp parallel for reduction(+: temp) if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
+  #pragma omp parallel for schedule(static) reduction(+: temp) if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
 #endif
 VIENNACL_NORM_1_IMPL_2(long, long)
 
 VIENNACL_NORM_1_IMPL_1(unsigned long, unsigned long)
 #ifdef VIENNACL_WITH_OPENMP
-  #pragma omp parallel for reduction(+: temp) if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
+  #pragma omp parallel for schedule(static) reduction(+: temp) if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
 #endif
 VIENNACL_NORM_1_IMPL_2(unsigned long, unsigned long)
 
@@ -683,14 +683,14 @@ VIENNACL_NORM_1_IMPL_2(unsigned long, unsigned long)
 // float
 VIENNACL_NORM_1_IMPL_1(float, float)
 #ifdef VIENNACL_WITH_OPENMP
-  #pragma omp parallel for reduction(+: temp) if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
+  #pragma omp parallel for schedule(static) reduction(+: temp) if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
 #endif
 VIENNACL_NORM_1_IMPL_2(float, float)
 
 // double
 VIENNACL_NORM_1_IMPL_1(double, double)
 #ifdef VIENNACL_WITH_OPENMP
-  #pragma omp parallel for reduction(+: temp) if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
+  #pragma omp parallel for schedule(static) reduction(+: temp) if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
 #endif
 VIENNACL_NORM_1_IMPL_2(double, double)
 
@@ -739,13 +739,13 @@ namespace detail
 // char
 VIENNACL_NORM_2_IMPL_1(char, int)
 #ifdef VIENNACL_WITH_OPENMP
-  #pragma omp parallel for reduction(+: temp) if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
+  #pragma omp parallel for schedule(static) reduction(+: temp) if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
 #endif
 VIENNACL_NORM_2_IMPL_2(char, int)
 
 VIENNACL_NORM_2_IMPL_1(unsigned char, int)
 #ifdef VIENNACL_WITH_OPENMP
-  #pragma omp parallel for reduction(+: temp) if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
+  #pragma omp parallel for schedule(static) reduction(+: temp) if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
 #endif
 VIENNACL_NORM_2_IMPL_2(unsigned char, int)
 
@@ -753,13 +753,13 @@ VIENNACL_NORM_2_IMPL_2(unsigned char, int)
 // short
 VIENNACL_NORM_2_IMPL_1(short, int)
 #ifdef VIENNACL_WITH_OPENMP
-  #pragma omp parallel for reduction(+: temp) if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
+  #pragma omp parallel for schedule(static) reduction(+: temp) if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
 #endif
 VIENNACL_NORM_2_IMPL_2(short, int)
 
 VIENNACL_NORM_2_IMPL_1(unsigned short, int)
 #ifdef VIENNACL_WITH_OPENMP
-  #pragma omp parallel for reduction(+: temp) if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
+  #pragma omp parallel for schedule(static) reduction(+: temp) if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
 #endif
 VIENNACL_NORM_2_IMPL_2(unsigned short, int)
 
@@ -767,13 +767,13 @@ VIENNACL_NORM_2_IMPL_2(unsigned short, int)
 // int
 VIENNACL_NORM_2_IMPL_1(int, int)
 #ifdef VIENNACL_WITH_OPENMP
-  #pragma omp parallel for reduction(+: temp) if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
+  #pragma omp parallel for schedule(static) reduction(+: temp) if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
 #endif
 VIENNACL_NORM_2_IMPL_2(int, int)
 
 VIENNACL_NORM_2_IMPL_1(unsigned int, unsigned int)
 #ifdef VIENNACL_WITH_OPENMP
-  #pragma omp parallel for reduction(+: temp) if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
+  #pragma omp parallel for schedule(static) reduction(+: temp) if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
 #endif
 VIENNACL_NORM_2_IMPL_2(unsigned int, unsigned int)
 
@@ -781,13 +781,13 @@ VIENNACL_NORM_2_IMPL_2(unsigned int, unsigned int)
 // long
 VIENNACL_NORM_2_IMPL_1(long, long)
 #ifdef VIENNACL_WITH_OPENMP
-  #pragma omp parallel for reduction(+: temp) if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
+  #pragma omp parallel for schedule(static) reduction(+: temp) if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
 #endif
 VIENNACL_NORM_2_IMPL_2(long, long)
 
 VIENNACL_NORM_2_IMPL_1(unsigned long, unsigned long)
 #ifdef VIENNACL_WITH_OPENMP
-  #pragma omp parallel for reduction(+: temp) if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
+  #pragma omp parallel for schedule(static) reduction(+: temp) if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
 #endif
 VIENNACL_NORM_2_IMPL_2(unsigned long, unsigned long)
 
@@ -795,14 +795,14 @@ VIENNACL_NORM_2_IMPL_2(unsigned long, unsigned long)
 // float
 VIENNACL_NORM_2_IMPL_1(float, float)
 #ifdef VIENNACL_WITH_OPENMP
-  #pragma omp parallel for reduction(+: temp) if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
+  #pragma omp parallel for schedule(static) reduction(+: temp) if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
 #endif
 VIENNACL_NORM_2_IMPL_2(float, float)
 
 // double
 VIENNACL_NORM_2_IMPL_1(double, double)
 #ifdef VIENNACL_WITH_OPENMP
-  #pragma omp parallel for reduction(+: temp) if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
+  #pragma omp parallel for schedule(static) reduction(+: temp) if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
 #endif
 VIENNACL_NORM_2_IMPL_2(double, double)
 
@@ -1059,7 +1059,7 @@ void sum_impl(vector_base<NumericT> const & vec1,
 
   value_type temp = 0;
 #ifdef VIENNACL_WITH_OPENMP
-  #pragma omp parallel for reduction(+:temp) if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
+  #pragma omp parallel for schedule(static) reduction(+:temp) if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
 #endif
   for (long i = 0; i < static_cast<long>(size1); ++i)
     temp += data_vec1[static_cast<vcl_size_t>(i)*inc1+start1];
@@ -1097,7 +1097,7 @@ void plane_rotation(vector_base<NumericT> & vec1,
   value_type data_beta  = beta;
 
 #ifdef VIENNACL_WITH_OPENMP
-  #pragma omp parallel for if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
+  #pragma omp parallel for schedule(static) if (size1 > VIENNACL_OPENMP_VECTOR_MIN_SIZE)
 #endif
   for (long i = 0; i < static_cast<long>(size1); ++i)
   {
@@ -0,0 +1,453 @@
+#ifndef VIENNACL_LINALG_IDR_HPP_
+#define VIENNACL_LINALG_IDR_HPP_
+
+/* =========================================================================
+   Copyright (c) 2010-2016, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+   Portions of this software are copyright by UChicago Argonne, LLC.
+
+                            -----------------
+                  ViennaCL - The Vienna Computing Library
+                            -----------------
+
+   Project Head:    Karl Rupp                   rupp@iue.tuwien.ac.at
+
+   (A list of authors and contributors can be found in the manual)
+
+   License:         MIT (X11), see file LICENSE in the base directory
+============================================================================= */
+
+/** @file viennacl/linalg/idr.hpp
+    @brief Implementation of the induced dimension reduction method IDR(s) with biorthogonalization
+
+    Following M. B. van Gijzen and P. Sonneveld, "Algorithm 913: An Elegant IDR(s) Variant that Efficiently Exploits Biorthogonality Properties", ACM TOMS 38(1), 2011.
+    The projections onto the s-dimensional shadow space are computed with a single multi-inner-product kernel call each.
+    IDR(1) is mathematically equivalent to BiCGStab, larger values of s typically reduce the number of iterations for nonsymmetric systems at the cost of 2s+1 additional vectors.
+*/
+
+#include <vector>
+#include <map>
+#include <cmath>
+
+#include "viennacl/forwards.h"
+#include "viennacl/vector.hpp"
+#include "viennacl/vector_proxy.hpp"
+#include "viennacl/compressed_matrix.hpp"
+#include "viennacl/tools/tools.hpp"
+#include "viennacl/linalg/prod.hpp"
+#include "viennacl/linalg/inner_prod.hpp"
+#include "viennacl/linalg/norm_2.hpp"
+#include "viennacl/traits/size.hpp"
+#include "viennacl/meta/result_of.hpp"
+
+namespace viennacl
+{
+namespace linalg
+{
+
+/** @brief A tag for the induced dimension reduction method IDR(s). Used for supplying solver parameters and for dispatching the solve() function
+*/
+class idr_tag
+{
+public:
+  /** @brief The constructor
+  *
+  * @param tol              Relative tolerance for the residual (solver quits if ||r|| < tol * ||r_initial||)
+  * @param max_iters        The maximum number of iterations, i.e. matrix-vector products
+  * @param s                Dimension of the shadow space. Typical values are 2 to 8.
+  */
+  idr_tag(double tol = 1e-8, vcl_size_t max_iters = 400, vcl_size_t s = 4)
+    : tol_(tol), abs_tol_(0), iterations_(max_iters), s_(s > 0 ? s : 1), omega_threshold_(0.7), iters_taken_(0), last_error_(0) {}
+
+  /** @brief Returns the relative tolerance */
+  double tolerance() const { return tol_; }
+
+  /** @brief Returns the absolute tolerance */
+  double abs_tolerance() const { return abs_tol_; }
+  /** @brief Sets the absolute tolerance */
+  void abs_tolerance(double new_tol) { if (new_tol >= 0) abs_tol_ = new_tol; }
+
+  /** @brief Returns the maximum number of iterations, i.e. matrix-vector products */
+  vcl_size_t max_iterations() const { return iterations_; }
+
+  /** @brief Returns the dimension of the shadow space */
+  vcl_size_t s() const { return s_; }
+
+  /** @brief Returns the threshold for the 'maintaining the convergence' strategy used for choosing omega. Zero selects the minimal residual step. */
+  double omega_threshold() const { return omega_threshold_; }
+  /** @brief Sets the threshold for the 'maintaining the convergence' strategy used for choosing omega. Zero selects the minimal residual step. */
+  void omega_threshold(double kappa) { if (kappa >= 0 && kappa < 1) omega_threshold_ = kappa; }
+
+  /** @brief Return the number of solver iterations, i.e. matrix-vector products: */
+  vcl_size_t iters() const { return iters_taken_; }
+  void iters(vcl_size_t i) const { iters_taken_ = i; }
+
+  /** @brief Returns the estimated relative error at the end of the solver run */
+  double error() const { return last_error_; }
+  /** @brief Sets the estimated relative error at the end of the solver run */
+  void error(double e) const { last_error_ = e; }
+
+private:
+  double tol_;
+  double abs_tol_;
+  vcl_size_t iterations_;
+  vcl_size_t s_;
+  double omega_threshold_;
+
+  //return values from solver
+  mutable vcl_size_t iters_taken_;
+  mutable double last_error_;
+};
+
+
+namespace detail
+{
+  /** @brief Sets up s orthonormal shadow vectors from a fixed pseudo-random sequence, so that the iteration is reproducible */
+  template<typename NumericT>
+  void idr_shadow_space(std::vector< viennacl::vector<NumericT> > & P, vcl_size_t n, vcl_size_t s, viennacl::context ctx)
+  {
+    P.resize(s);
+    std::vector<NumericT> host_p(n);
+    unsigned long state = 4711;
+    for (vcl_size_t k = 0; k < s; ++k)
+    {
+      for (vcl_size_t i = 0; i < n; ++i)
+      {
+        state = (state * 1103515245UL + 12345UL) % 2147483648UL;
+        host_p[i] = NumericT(state) / NumericT(2147483648.0) - NumericT(0.5);
+      }
+      P[k] = viennacl::vector<NumericT>(n, ctx);
+      viennacl::copy(host_p, P[k]);
+
+      for (vcl_size_t j = 0; j < k; ++j)
+        P[k] -= viennacl::linalg::inner_prod(P[j], P[k]) * P[j];
+      P[k] /= viennacl::linalg::norm_2(P[k]);
+    }
+  }
+
+  /** @brief Computes the inner products of 'x' with the shadow vectors P[first], ..., P[s-1] in a single pass and writes them to 'result' */
+  template<typename NumericT>
+  void idr_project(std::vector< viennacl::vector<NumericT> > const & P, vcl_size_t first,
+                   viennacl::vector<NumericT> const & x, viennacl::vector<NumericT> & buffer, std::vector<NumericT> & result)
+  {
+    vcl_size_t s = P.size();
+    std::vector<viennacl::vector_base<NumericT> const *> vecs(s - first);
+    for (vcl_size_t i = first; i < s; ++i)
+      vecs[i - first] = &(P[i]);
+
+    if (vecs.size() == 1)
+      result[0] = viennacl::linalg::inner_prod(x, P[first]);
+    else
+    {
+      viennacl::project(buffer, viennacl::range(0, s - first)) = viennacl::linalg::inner_prod(x, viennacl::vector_tuple<NumericT>(vecs));
+      viennacl::backend::memory_read(buffer.handle(), 0, sizeof(NumericT) * (s - first), &(result[0]));
+    }
+  }
+
+  /** @brief Replaces the recursively updated residual by the true residual once the former indicates convergence. Returns true if the true residual satisfies the tolerances.
+  *
+  * Rounding errors in the biorthogonalization cause a gap between the recursively updated and the true residual, which is most pronounced in single precision.
+  */
+  template<typename MatrixT, typename NumericT>
+  bool idr_replace_residual(MatrixT const & A, viennacl::vector<NumericT> const & rhs, viennacl::vector<NumericT> const & result,
+                            viennacl::vector<NumericT> & residual, NumericT & residual_norm, NumericT norm_rhs, idr_tag const & tag)
+  {
+    residual = viennacl::linalg::prod(A, result);
+    residual = rhs - residual;
+    residual_norm = viennacl::linalg::norm_2(residual);
+    return residual_norm / norm_rhs < tag.tolerance() || residual_norm < tag.abs_tolerance();
+  }
+
+  /** @brief Implementation of the (right-)preconditioned IDR(s) method with biorthogonalization
+  *
+  * @param A            The system matrix
+  * @param rhs          The load vector
+  * @param tag          Solver configuration tag
+  * @param precond      A preconditioner. Precondition operation is done via member function apply()
+  * @param monitor      A callback routine which is called after each residual update
+  * @param monitor_data Data pointer to be passed to the callback routine to pass on user-specific data
+  * @return The result vector
+  */
+  template<typename MatrixT, typename NumericT, typename PreconditionerT>
+  viennacl::vector<NumericT> solve_impl(MatrixT const & A,
+                                        viennacl::vector<NumericT> const & rhs,
+                                        idr_tag const & tag,
+                                        PreconditionerT const & precond,
+                                        bool (*monitor)(viennacl::vector<NumericT> const &, NumericT, void*) = NULL,
+                                        void *monitor_data = NULL)
+  {
+    vcl_size_t n = rhs.size();
+    vcl_size_t s = std::min(tag.s(), n);
+    viennacl::context ctx = viennacl::traits::context(rhs);
+
+    viennacl::vector<NumericT> result = viennacl::zero_vector<NumericT>(n, ctx);
+    viennacl::vector<NumericT> residual = rhs;
+    viennacl::vector<NumericT> v(n, ctx);
+    viennacl::vector<NumericT> t(n, ctx);
+    viennacl::vector<NumericT> projection_buffer(s, ctx);
+
+    tag.iters(0);
+    tag.error(0);
+
+    NumericT norm_rhs_host = viennacl::linalg::norm_2(residual);
+    NumericT residual_norm = norm_rhs_host;
+    if (norm_rhs_host <= tag.abs_tolerance()) //solution is zero if RHS norm is zero
+      return result;
+
+    std::vector< viennacl::vector<NumericT> > P;
+    idr_shadow_space(P, n, s, ctx);
+
+    std::vector< viennacl::vector<NumericT> > G(s);
+    std::vector< viennacl::vector<NumericT> > U(s);
+    for (vcl_size_t k = 0; k < s; ++k)
+    {
+      G[k] = viennacl::zero_vector<NumericT>(n, ctx);
+      U[k] = viennacl::zero_vector<NumericT>(n, ctx);
+    }
+
+    std::vector<NumericT> M(s * s, NumericT(0)); // M = P^T G, lower triangular after biorthogonalization (column-major)
+    for (vcl_size_t k = 0; k < s; ++k)
+      M[k + k * s] = NumericT(1);
+
+    std::vector<NumericT> f(s);
+    std::vector<NumericT> c(s);
+    std::vector<NumericT> m_column(s);
+    NumericT omega = 1;
+
+    // for the reliable updating strategy of van der Vorst and Ye: the residual gap grows with the largest intermediate residual
+    NumericT max_residual_norm = norm_rhs_host;
+    NumericT replaced_residual_norm = norm_rhs_host;
+
+    vcl_size_t iters = 0;
+    bool converged = false;
+    while (iters < tag.max_iterations() && !converged)
+    {
+      // f = P^T r
+      idr_project(P, 0, residual, projection_buffer, f);
+
+      for (vcl_size_t k = 0; k < s && iters < tag.max_iterations(); ++k)
+      {
+        // solve the lower triangular system M(k:s,k:s) c = f(k:s)
+        for (vcl_size_t i = k; i < s; ++i)
+        {
+          NumericT value = f[i];
+          for (vcl_size_t j = k; j < i; ++j)
+            value -= M[i + j * s] * c[j];
+          c[i] = value / M[i + i * s];
+        }
+
+        // v = r - G(:,k:s) c, preconditioned
+        v = residual;
+        for (vcl_size_t i = k; i < s; ++i)
+          v -= c[i] * G[i];
+        precond.apply(v);
+
+        // U(:,k) = U(:,k:s) c + omega v
+        U[k] *= c[k];
+        for (vcl_size_t i = k + 1; i < s; ++i)
+          U[k] += c[i] * U[i];
+        U[k] += omega * v;
+
+        G[k] = viennacl::linalg::prod(A, U[k]);
+        ++iters;
+
+        // biorthogonalize the new G(:,k) against P(:,0:k-1)
+        for (vcl_size_t i = 0; i < k; ++i)
+        {
+          NumericT alpha = viennacl::linalg::inner_prod(P[i], G[k]) / M[i + i * s];
+          G[k] -= alpha * G[i];
+          U[k] -= alpha * U[i];
+        }
+
+        // new column of M = P^T G
+        idr_project(P, k, G[k], projection_buffer, m_column);
+        for (vcl_size_t i = k; i < s; ++i)
+          M[i + k * s] = m_column[i - k];
+
+        if (M[k + k * s] <= 0 && M[k + k * s] >= 0) // breakdown: restart with a new residual projection
+          break;
+
+        // make r orthogonal to P(:,k) and update the result accordingly
+        NumericT beta = f[k] / M[k + k * s];
+        residual -= beta * G[k];
+        result   += beta * U[k];
+
+        residual_norm = viennacl::linalg::norm_2(residual);
+        max_residual_norm = std::max(max_residual_norm, residual_norm);
+        if (monitor && monitor(result, std::fabs(residual_norm / norm_rhs_host), monitor_data))
+        {
+          converged = true;
+          break;
+        }
+        if (residual_norm / norm_rhs_host < tag.tolerance() || residual_norm < tag.abs_tolerance())
+        {
+          converged = idr_replace_residual(A, rhs, result, residual, residual_norm, norm_rhs_host, tag);
+          ++iters;
+          break; // not converged: restart the cycle with the true residual
+        }
+
+        for (vcl_size_t i = k + 1; i < s; ++i)
+          f[i] -= beta * M[i + k * s];
+      }
+
+      if (converged || iters >= tag.max_iterations())
+        break;
+
+      // dimension reduction step: enter the next Sonneveld subspace
+      v = residual;
+      precond.apply(v);
+      t = viennacl::linalg::prod(A, v);
+      ++iters;
+
+      NumericT norm_t = viennacl::linalg::norm_2(t);
+      NumericT t_dot_r = viennacl::linalg::inner_prod(t, residual);
+      omega = t_dot_r / (norm_t * norm_t);
+      NumericT rho = std::fabs(t_dot_r / (norm_t * residual_norm));
+      if (rho < NumericT(tag.omega_threshold())) // maintaining the convergence, see Sleijpen and van der Vorst
+        omega *= NumericT(tag.omega_threshold()) / rho;
+      if (omega <= 0 && omega >= 0) // stagnation in the minimal residual step
+        break;
+
+      residual -= omega * t;
+      result   += omega * v;
+
+      residual_norm = viennacl::linalg::norm_2(residual);
+      max_residual_norm = std::max(max_residual_norm, residual_norm);
+      if (monitor && monitor(result, std::fabs(residual_norm / norm_rhs_host), monitor_data))
+        break;
+      if (residual_norm / norm_rhs_host < tag.tolerance() || residual_norm < tag.abs_tolerance())
+      {
+        converged = idr_replace_residual(A, rhs, result, residual, residual_norm, norm_rhs_host, tag);
+        ++iters;
+      }
+      else if (residual_norm < NumericT(1e-2) * max_residual_norm && max_residual_norm > replaced_residual_norm)
+      {
+        // residual dropped by two orders of magnitude after a peak: replace it before the gap dominates
+        idr_replace_residual(A, rhs, result, residual, residual_norm, norm_rhs_host, tag);
+        ++iters;
+        max_residual_norm = replaced_residual_norm = residual_norm;
+      }
+    }
+
+    //store last error estimate:
+    tag.iters(iters);
+    tag.error(residual_norm / norm_rhs_host);
+
+    return result;
+  }
+
+}
+
+
+/** @brief Entry point for the preconditioned IDR(s) method.
+ *
+ *  @param matrix    The system matrix
+ *  @param rhs       Right hand side vector (load vector)
+ *  @param tag       An IDR(s) tag providing relative tolerances, the dimension of the shadow space, etc.
+ *  @param precond   A preconditioner. Precondition operation is done via member function apply()
+ */
+template<typename MatrixT, typename NumericT, typename PreconditionerT>
+viennacl::vector<NumericT> solve(MatrixT const & matrix, viennacl::vector<NumericT> const & rhs, idr_tag const & tag, PreconditionerT const & precond)
+{
+  return detail::solve_impl(matrix, rhs, tag, precond);
+}
+
+
+/** @brief Convenience overload for calling the preconditioned IDR(s) solver using types from the C++ STL.
+  *
+  * A std::vector<std::map<T, U> > matrix is convenient for e.g. finite element assembly.
+  * It is not the fastest option for setting up a system, but often it is fast enough - particularly for just trying things out.
+  */
+template<typename IndexT, typename NumericT, typename PreconditionerT>
+std::vector<NumericT> solve(std::vector< std::map<IndexT, NumericT> > const & A, std::vector<NumericT> const & rhs, idr_tag const & tag, PreconditionerT const & precond)
+{
+  viennacl::compressed_matrix<NumericT> vcl_A;
+  viennacl::copy(A, vcl_A);
+
+  viennacl::vector<NumericT> vcl_rhs(rhs.size());
+  viennacl::copy(rhs, vcl_rhs);
+
+  viennacl::vector<NumericT> vcl_result = solve(vcl_A, vcl_rhs, tag, precond);
+
+  std::vector<NumericT> result(vcl_result.size());
+  viennacl::copy(vcl_result, result);
+  return result;
+}
+
+/** @brief Entry point for the unpreconditioned IDR(s) method.
+ *
+ *  @param matrix    The system matrix
+ *  @param rhs       Right hand side vector (load vector)
+ *  @param tag       An IDR(s) tag providing relative tolerances, the dimension of the shadow space, etc.
+ */
+template<typename MatrixT, typename VectorT>
+VectorT solve(MatrixT const & matrix, VectorT const & rhs, idr_tag const & tag)
+{
+  return solve(matrix, rhs, tag, viennacl::linalg::no_precond());
+}
+
+
+
+template<typename VectorT>
+class idr_solver
+{
+public:
+  typedef typename viennacl::result_of::cpu_value_type<VectorT>::type   numeric_type;
+
+  idr_solver(idr_tag const & tag) : tag_(tag), monitor_callback_(NULL), user_data_(NULL) {}
+
+  template<typename MatrixT, typename PreconditionerT>
+  VectorT operator()(MatrixT const & A, VectorT const & b, PreconditionerT const & precond) const
+  {
+    if (viennacl::traits::size(init_guess_) > 0) // take initial guess into account
+    {
+      VectorT mod_rhs = viennacl::linalg::prod(A, init_guess_);
+      mod_rhs = b - mod_rhs;
+      VectorT y = detail::solve_impl(A, mod_rhs, tag_, precond, monitor_callback_, user_data_);
+      return init_guess_ + y;
+    }
+    return detail::solve_impl(A, b, tag_, precond, monitor_callback_, user_data_);
+  }
+
+
+  template<typename MatrixT>
+  VectorT operator()(MatrixT const & A, VectorT const & b) const
+  {
+    return operator()(A, b, viennacl::linalg::no_precond());
+  }
+
+  /** @brief Specifies an initial guess for the iterative solver.
+    *
+    * An iterative solver for Ax = b with initial guess x_0 is equivalent to an iterative solver for Ay = b' := b - Ax_0, where x = x_0 + y.
+    */
+  void set_initial_guess(VectorT const & x) { init_guess_ = x; }
+
+  /** @brief Sets a monitor function pointer to be called in each iteration. Set to NULL to run without monitor.
+   *
+   *  The monitor function is called with the current guess for the result as first argument and the current relative residual estimate as second argument.
+   *  The third argument is a pointer to user-defined data, through which additional information can be passed.
+   *  This pointer needs to be set with set_monitor_data. If not set, NULL is passed.
+   *  If the montior function returns true, the solver terminates (either convergence or divergence).
+   */
+  void set_monitor(bool (*monitor_fun)(VectorT const &, numeric_type, void *), void *user_data)
+  {
+    monitor_callback_ = monitor_fun;
+    user_data_ = user_data;
+  }
+
+  /** @brief Returns the solver tag containing basic configuration such as tolerances, etc. */
+  idr_tag const & tag() const { return tag_; }
+
+private:
+  idr_tag       tag_;
+  VectorT       init_guess_;
+  bool          (*monitor_callback_)(VectorT const &, numeric_type, void *);
+  void          *user_data_;
+};
+
+
+}
+}
+
+#endif
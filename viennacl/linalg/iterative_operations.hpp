@@ -32,6 +32,10 @@
 #include "viennacl/traits/start.hpp"
 #include "viennacl/traits/handle.hpp"
 #include "viennacl/traits/stride.hpp"
+#include "viennacl/traits/context.hpp"
+#include "viennacl/backend/memory.hpp"
+#include "viennacl/linalg/vector_operations.hpp"
+#include "viennacl/linalg/sparse_matrix_operations.hpp"
 #include "viennacl/linalg/host_based/iterative_operations.hpp"
 
 #ifdef VIENNACL_WITH_OPENCL
@@ -121,6 +125,56 @@ void pipelined_cg_prod(MatrixT const & A,
   }
 }
 
+namespace detail
+{
+  /** @brief Writes inner_prod(p,p) to the first entry of the inner product buffer. Used for backends without a fused kernel in pipelined_minres_prod(). */
+  template<typename NumericT>
+  void pipelined_minres_store_pp(vector_base<NumericT> const & p,
+                                 vector_base<NumericT> & inner_prod_buffer)
+  {
+    viennacl::scalar<NumericT> inner_prod_pp(0, viennacl::traits::context(p));
+    viennacl::linalg::inner_prod_impl(p, p, inner_prod_pp);
+    viennacl::backend::memory_copy(inner_prod_pp.handle(), inner_prod_buffer.handle(), 0, 0, sizeof(NumericT));
+  }
+}
+
+/** @brief Performs a fused matrix-vector product for an efficient pipelined MINRES algorithm.
+  *
+  * This routines computes for a sparse matrix A and vectors 'p' and 'Ap':
+  *   Ap = prod(A, p);
+  * and computes the reduction stages for computing inner_prod(p,Ap), inner_prod(Ap,Ap) as in pipelined_cg_prod(). In addition, inner_prod(p,p) is written to the first entry of the buffer.
+  * The OpenCL and CUDA backends compute inner_prod(p,p) in a separate reduction.
+  */
+template<typename MatrixT, typename NumericT>
+void pipelined_minres_prod(MatrixT const & A,
+                           vector_base<NumericT> const & p,
+                           vector_base<NumericT> & Ap,
+                           vector_base<NumericT> & inner_prod_buffer)
+{
+  switch (viennacl::traits::handle(p).get_active_handle_id())
+  {
+  case viennacl::MAIN_MEMORY:
+    viennacl::linalg::host_based::pipelined_minres_prod(A, p, Ap, inner_prod_buffer);
+    break;
+#ifdef VIENNACL_WITH_OPENCL
+  case viennacl::OPENCL_MEMORY:
+    viennacl::linalg::opencl::pipelined_cg_prod(A, p, Ap, inner_prod_buffer);
+    detail::pipelined_minres_store_pp(p, inner_prod_buffer);
+    break;
+#endif
+#ifdef VIENNACL_WITH_CUDA
+  case viennacl::CUDA_MEMORY:
+    viennacl::linalg::cuda::pipelined_cg_prod(A, p, Ap, inner_prod_buffer);
+    detail::pipelined_minres_store_pp(p, inner_prod_buffer);
+    break;
+#endif
+  case viennacl::MEMORY_NOT_INITIALIZED:
+    throw memory_exception("not initialised!");
+  default:
+    throw memory_exception("not implemented");
+  }
+}
+
 ////////////////////////////////////////////
 
 /** @brief Performs a joint vector update operation needed for an efficient pipelined CG algorithm.
@@ -417,6 +471,87 @@ void pipelined_gmres_prod(MatrixType const & A,
   }
 }
 
+namespace detail
+{
+  /** @brief Non-fused version of chebyshev_sweep() composed of a sparse matrix-vector product and vector operations. Used for the backends without a fused kernel. */
+  template<typename MatrixT, typename NumericT>
+  NumericT chebyshev_sweep_unfused(MatrixT const & A,
+                                   vector_base<NumericT> & x,
+                                   vector_base<NumericT> & x_backup,
+                                   vector_base<NumericT> & d,
+                                   vector_base<NumericT> const & rhs,
+                                   NumericT alpha,
+                                   NumericT beta)
+  {
+    viennacl::vector<NumericT> diag(A.size1(), viennacl::traits::context(x));
+    viennacl::linalg::detail::row_info(A, diag, viennacl::linalg::detail::SPARSE_ROW_DIAGONAL);
+
+    // residual r = rhs - A * x, stored in x_backup:
+    x_backup = rhs;
+    viennacl::linalg::prod_impl(A, x, NumericT(-1), x_backup, NumericT(1));
+    NumericT inner_prod_r = viennacl::linalg::inner_prod(x_backup, x_backup);
+
+    x_backup = viennacl::linalg::element_div(x_backup, diag);
+    if (alpha > 0 || alpha < 0)
+      d = alpha * d + beta * x_backup;
+    else
+      d = beta * x_backup; // d may hold garbage from a previous run
+    x += d;
+
+    return inner_prod_r;
+  }
+
+  /** @brief Matrices with reduced precision storage reside in host memory only, hence there is no need for a non-fused version. */
+  template<typename NumericT, typename StorageT>
+  NumericT chebyshev_sweep_unfused(mixed_compressed_matrix<NumericT, StorageT> const &,
+                                   vector_base<NumericT> &,
+                                   vector_base<NumericT> &,
+                                   vector_base<NumericT> &,
+                                   vector_base<NumericT> const &,
+                                   NumericT,
+                                   NumericT)
+  {
+    throw memory_exception("not implemented");
+  }
+}
+
+/** @brief Performs one step of the Jacobi-preconditioned Chebyshev iteration, fusing the residual computation and the vector updates into the sparse matrix-vector product.
+  *
+  * This routine computes for a sparse matrix A with diagonal D and vectors 'x', 'd', 'rhs':
+  *   r  = rhs - prod(A, x);
+  *   d  = alpha * d + beta * D^{-1} r;
+  *   x += d;
+  * and returns inner_prod(r, r). The vector 'x_backup' is used as temporary storage. For alpha = 0 the previous content of 'd' is ignored.
+  * The OpenCL and CUDA backends run the non-fused sequence of operations above.
+  */
+template<typename MatrixT, typename NumericT>
+NumericT chebyshev_sweep(MatrixT const & A,
+                         vector_base<NumericT> & x,
+                         vector_base<NumericT> & x_backup,
+                         vector_base<NumericT> & d,
+                         vector_base<NumericT> const & rhs,
+                         NumericT alpha,
+                         NumericT beta)
+{
+  switch (viennacl::traits::handle(x).get_active_handle_id())
+  {
+  case viennacl::MAIN_MEMORY:
+    return viennacl::linalg::host_based::chebyshev_sweep(A, x, x_backup, d, rhs, alpha, beta);
+#ifdef VIENNACL_WITH_OPENCL
+  case viennacl::OPENCL_MEMORY:
+    return detail::chebyshev_sweep_unfused(A, x, x_backup, d, rhs, alpha, beta);
+#endif
+#ifdef VIENNACL_WITH_CUDA
+  case viennacl::CUDA_MEMORY:
+    return detail::chebyshev_sweep_unfused(A, x, x_backup, d, rhs, alpha, beta);
+#endif
+  case viennacl::MEMORY_NOT_INITIALIZED:
+    throw memory_exception("not initialised!");
+  default:
+    throw memory_exception("not implemented");
+  }
+}
+
 
 } //namespace linalg
 } //namespace viennacl
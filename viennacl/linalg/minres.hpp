@@ -0,0 +1,506 @@
+#ifndef VIENNACL_LINALG_MINRES_HPP_
+#define VIENNACL_LINALG_MINRES_HPP_
+
+/* =========================================================================
+   Copyright (c) 2010-2016, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+   Portions of this software are copyright by UChicago Argonne, LLC.
+
+                            -----------------
+                  ViennaCL - The Vienna Computing Library
+                            -----------------
+
+   Project Head:    Karl Rupp                   rupp@iue.tuwien.ac.at
+
+   (A list of authors and contributors can be found in the manual)
+
+   License:         MIT (X11), see file LICENSE in the base directory
+============================================================================= */
+
+/** @file viennacl/linalg/minres.hpp
+    @brief The minimal residual method (MINRES) for symmetric, possibly indefinite systems is implemented here
+
+    MINRES minimizes the residual over the Krylov subspace using the short recurrences of the Lanczos process, hence the memory requirements are constant.
+    The preconditioner must be symmetric positive definite.
+*/
+
+#include <vector>
+#include <map>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+#include "viennacl/forwards.h"
+#include "viennacl/tools/tools.hpp"
+#include "viennacl/linalg/prod.hpp"
+#include "viennacl/linalg/inner_prod.hpp"
+#include "viennacl/linalg/norm_2.hpp"
+#include "viennacl/traits/clear.hpp"
+#include "viennacl/traits/size.hpp"
+#include "viennacl/meta/result_of.hpp"
+#include "viennacl/linalg/iterative_operations.hpp"
+
+namespace viennacl
+{
+namespace linalg
+{
+
+/** @brief A tag for the minimal residual method (MINRES). Used for supplying solver parameters and for dispatching the solve() function
+*/
+class minres_tag
+{
+public:
+  /** @brief The constructor
+  *
+  * @param tol              Relative tolerance for the residual (solver quits if ||r|| < tol * ||r_initial||). With preconditioner, the norm induced by the inverse preconditioner is used.
+  * @param max_iterations   The maximum number of iterations
+  */
+  minres_tag(double tol = 1e-8, unsigned int max_iterations = 300) : tol_(tol), abs_tol_(0), iterations_(max_iterations), iters_taken_(0), last_error_(0) {}
+
+  /** @brief Returns the relative tolerance */
+  double tolerance() const { return tol_; }
+
+  /** @brief Returns the absolute tolerance */
+  double abs_tolerance() const { return abs_tol_; }
+  /** @brief Sets the absolute tolerance */
+  void abs_tolerance(double new_tol) { if (new_tol >= 0) abs_tol_ = new_tol; }
+
+  /** @brief Returns the maximum number of iterations */
+  unsigned int max_iterations() const { return iterations_; }
+
+  /** @brief Return the number of solver iterations: */
+  unsigned int iters() const { return iters_taken_; }
+  void iters(unsigned int i) const { iters_taken_ = i; }
+
+  /** @brief Returns the estimated relative error at the end of the solver run */
+  double error() const { return last_error_; }
+  /** @brief Sets the estimated relative error at the end of the solver run */
+  void error(double e) const { last_error_ = e; }
+
+private:
+  double tol_;
+  double abs_tol_;
+  unsigned int iterations_;
+
+  //return values from solver
+  mutable unsigned int iters_taken_;
+  mutable double last_error_;
+};
+
+namespace detail
+{
+
+  /** @brief Givens rotation state of MINRES, which updates the QR factorization of the tridiagonal Lanczos matrix by one column per iteration */
+  template<typename NumericT>
+  struct minres_rotation
+  {
+    minres_rotation(NumericT phibar_init) : cs(-1), sn(0), cs_old(-1), sn_old(0), phibar(phibar_init) {}
+
+    /** @brief Appends the column with super-diagonal entry 'beta', diagonal entry 'alpha', and sub-diagonal entry 'beta_next' and eliminates the latter.
+    *
+    * Returns the coefficients for the new search direction w = (v - epsilon_old * w_{k-2} - delta * w_{k-1}) / gamma and the step length phi.
+    */
+    void apply(NumericT beta, NumericT alpha, NumericT beta_next, NumericT & epsilon_old, NumericT & delta, NumericT & gamma, NumericT & phi)
+    {
+      // apply the previous two rotations to the new column:
+      epsilon_old   = sn_old * beta;
+      NumericT dbar = -cs_old * beta;
+      delta         = cs * dbar + sn * alpha;
+      NumericT gbar = sn * dbar - cs * alpha;
+
+      // new rotation eliminating the sub-diagonal entry:
+      cs_old = cs;
+      sn_old = sn;
+      gamma = std::sqrt(gbar * gbar + beta_next * beta_next);
+      gamma = std::max(gamma, std::numeric_limits<NumericT>::epsilon());
+      cs = gbar / gamma;
+      sn = beta_next / gamma;
+      phi    = cs * phibar;
+      phibar = sn * phibar;
+    }
+
+    NumericT cs;
+    NumericT sn;
+    NumericT cs_old;
+    NumericT sn_old;
+    NumericT phibar;  // norm of the current residual
+  };
+
+
+  /** @brief Implementation of a pipelined MINRES algorithm (no preconditioner), specialized for ViennaCL types.
+  *
+  * The next Lanczos vector u is normalized lazily: <u, u> and <u, Au> are computed in the same fused kernel as the matrix-vector product Au (see pipelined_minres_prod()),
+  * and both are transferred to the host at once, hence there is a single synchronization point per iteration.
+  * The vectors u and Au are never rescaled. Instead, their norm enters the coefficients of the next Lanczos recurrence and of the search direction update.
+  * (Deriving the norm from <Au, Au> instead avoids the extra reduction, but cancellation quickly destroys the local orthogonality of the Lanczos vectors.)
+  *
+  * @param A            The system matrix
+  * @param rhs          The load vector
+  * @param tag          Solver configuration tag
+  * @param monitor      A callback routine which is called in each iteration
+  * @param monitor_data Data pointer to be passed to the callback routine to pass on user-specific data
+  * @return The result vector
+  */
+  template<typename MatrixT, typename NumericT>
+  viennacl::vector<NumericT> pipelined_solve(MatrixT const & A,
+                                             viennacl::vector<NumericT> const & rhs,
+                                             minres_tag const & tag,
+                                             viennacl::linalg::no_precond,
+                                             bool (*monitor)(viennacl::vector<NumericT> const &, NumericT, void*) = NULL,
+                                             void *monitor_data = NULL)
+  {
+    typedef typename viennacl::vector<NumericT>::difference_type   difference_type;
+
+    viennacl::context ctx = viennacl::traits::context(rhs);
+    viennacl::vector<NumericT> result = viennacl::zero_vector<NumericT>(rhs.size(), ctx);
+
+    viennacl::vector<NumericT> v = rhs;
+    viennacl::vector<NumericT> v_prev = viennacl::zero_vector<NumericT>(rhs.size(), ctx);
+    viennacl::vector<NumericT> Av(rhs.size(), ctx);
+    viennacl::vector<NumericT> w  = viennacl::zero_vector<NumericT>(rhs.size(), ctx);
+    viennacl::vector<NumericT> w1 = viennacl::zero_vector<NumericT>(rhs.size(), ctx);
+    viennacl::vector<NumericT> w2 = viennacl::zero_vector<NumericT>(rhs.size(), ctx);
+    viennacl::vector<NumericT> inner_prod_buffer = viennacl::zero_vector<NumericT>(3*256, ctx); // temporary buffer
+    std::vector<NumericT>      host_inner_prod_buffer(inner_prod_buffer.size());
+    difference_type            buffer_offset_per_vector = static_cast<difference_type>(inner_prod_buffer.size() / 3);
+
+    tag.iters(0);
+    tag.error(0);
+
+    NumericT norm_rhs = viennacl::linalg::norm_2(rhs);
+    if (norm_rhs <= tag.abs_tolerance()) //solution is zero if RHS norm is zero
+      return result;
+
+    minres_rotation<NumericT> rotation(norm_rhs);
+
+    // Av = A * v together with <v, Av>. The Lanczos vector is v / scale, the previous one v_prev / scale_prev:
+    viennacl::linalg::pipelined_cg_prod(A, v, Av, inner_prod_buffer);
+    viennacl::fast_copy(inner_prod_buffer.begin(), inner_prod_buffer.end(), host_inner_prod_buffer.begin());
+    NumericT scale      = norm_rhs;
+    NumericT scale_prev = 1;
+    NumericT alpha = std::accumulate(host_inner_prod_buffer.begin() + 2 * buffer_offset_per_vector, host_inner_prod_buffer.begin() + 3 * buffer_offset_per_vector, NumericT(0)) / (scale * scale);
+    NumericT beta  = 0;
+
+    for (unsigned int i = 0; i < tag.max_iterations(); ++i)
+    {
+      tag.iters(i+1);
+
+      // unnormalized next Lanczos vector u = (Av - alpha v) / scale - beta v_prev / scale_prev (stored in v_prev):
+      v_prev = (NumericT(1) / scale) * Av - (beta / scale_prev) * v_prev;
+      v_prev -= (alpha / scale) * v;
+
+      // Au = A * u together with <u, u> and <u, Au>:
+      viennacl::linalg::pipelined_minres_prod(A, v_prev, Av, inner_prod_buffer);
+
+      // bring back the partial results to the host:
+      viennacl::fast_copy(inner_prod_buffer.begin(), inner_prod_buffer.end(), host_inner_prod_buffer.begin());
+      NumericT inner_prod_uu   = std::accumulate(host_inner_prod_buffer.begin(),                                host_inner_prod_buffer.begin() +     buffer_offset_per_vector, NumericT(0));
+      NumericT inner_prod_uAu  = std::accumulate(host_inner_prod_buffer.begin() + 2 * buffer_offset_per_vector, host_inner_prod_buffer.begin() + 3 * buffer_offset_per_vector, NumericT(0));
+      NumericT beta_next = std::sqrt(inner_prod_uu);
+
+      NumericT epsilon_old, delta, gamma, phi;
+      rotation.apply(beta, alpha, beta_next, epsilon_old, delta, gamma, phi);
+
+      // new search direction and update of the result:
+      w1.fast_swap(w2);
+      w2.fast_swap(w);
+      w = (NumericT(1) / (scale * gamma)) * v - (epsilon_old / gamma) * w1;
+      w -= (delta / gamma) * w2;
+      result += phi * w;
+
+      NumericT residual_norm = std::fabs(rotation.phibar);
+      tag.error(residual_norm / norm_rhs);
+      if (monitor && monitor(result, residual_norm / norm_rhs, monitor_data))
+        break;
+      if (residual_norm / norm_rhs < tag.tolerance() || residual_norm < tag.abs_tolerance() || beta_next <= 0)
+        break;
+
+      // u becomes the current Lanczos vector, normalized lazily through 'scale':
+      v.fast_swap(v_prev);
+      scale_prev = scale;
+      scale      = beta_next;
+      alpha = inner_prod_uAu / (beta_next * beta_next);
+      beta  = beta_next;
+    }
+
+    return result;
+  }
+
+
+  /** @brief Overload for the pipelined MINRES implementation for the ViennaCL sparse matrix types */
+  template<typename NumericT>
+  viennacl::vector<NumericT> solve_impl(viennacl::compressed_matrix<NumericT> const & A,
+                                        viennacl::vector<NumericT> const & rhs,
+                                        minres_tag const & tag,
+                                        viennacl::linalg::no_precond,
+                                        bool (*monitor)(viennacl::vector<NumericT> const &, NumericT, void*) = NULL,
+                                        void *monitor_data = NULL)
+  {
+    return detail::pipelined_solve(A, rhs, tag, viennacl::linalg::no_precond(), monitor, monitor_data);
+  }
+
+
+  /** @brief Overload for the pipelined MINRES implementation for the ViennaCL sparse matrix types */
+  template<typename NumericT>
+  viennacl::vector<NumericT> solve_impl(viennacl::coordinate_matrix<NumericT> const & A,
+                                        viennacl::vector<NumericT> const & rhs,
+                                        minres_tag const & tag,
+                                        viennacl::linalg::no_precond,
+                                        bool (*monitor)(viennacl::vector<NumericT> const &, NumericT, void*) = NULL,
+                                        void *monitor_data = NULL)
+  {
+    return detail::pipelined_solve(A, rhs, tag, viennacl::linalg::no_precond(), monitor, monitor_data);
+  }
+
+
+  /** @brief Overload for the pipelined MINRES implementation for the ViennaCL sparse matrix types */
+  template<typename NumericT>
+  viennacl::vector<NumericT> solve_impl(viennacl::ell_matrix<NumericT> const & A,
+                                        viennacl::vector<NumericT> const & rhs,
+                                        minres_tag const & tag,
+                                        viennacl::linalg::no_precond,
+                                        bool (*monitor)(viennacl::vector<NumericT> const &, NumericT, void*) = NULL,
+                                        void *monitor_data = NULL)
+  {
+    return detail::pipelined_solve(A, rhs, tag, viennacl::linalg::no_precond(), monitor, monitor_data);
+  }
+
+
+  /** @brief Overload for the pipelined MINRES implementation for the ViennaCL sparse matrix types */
+  template<typename NumericT>
+  viennacl::vector<NumericT> solve_impl(viennacl::sliced_ell_matrix<NumericT> const & A,
+                                        viennacl::vector<NumericT> const & rhs,
+                                        minres_tag const & tag,
+                                        viennacl::linalg::no_precond,
+                                        bool (*monitor)(viennacl::vector<NumericT> const &, NumericT, void*) = NULL,
+                                        void *monitor_data = NULL)
+  {
+    return detail::pipelined_solve(A, rhs, tag, viennacl::linalg::no_precond(), monitor, monitor_data);
+  }
+
+
+  /** @brief Overload for the pipelined MINRES implementation for the ViennaCL sparse matrix types */
+  template<typename NumericT>
+  viennacl::vector<NumericT> solve_impl(viennacl::hyb_matrix<NumericT> const & A,
+                                        viennacl::vector<NumericT> const & rhs,
+                                        minres_tag const & tag,
+                                        viennacl::linalg::no_precond,
+                                        bool (*monitor)(viennacl::vector<NumericT> const &, NumericT, void*) = NULL,
+                                        void *monitor_data = NULL)
+  {
+    return detail::pipelined_solve(A, rhs, tag, viennacl::linalg::no_precond(), monitor, monitor_data);
+  }
+
+
+  /** @brief Implementation of the preconditioned MINRES method, generic implementation.
+  *
+  * Following C. C. Paige and M. A. Saunders, "Solution of Sparse Indefinite Systems of Linear Equations", SIAM J. Numer. Anal. 12(4), 617-629 (1975)
+  *
+  * @param matrix       The system matrix
+  * @param rhs          The load vector
+  * @param tag          Solver configuration tag
+  * @param precond      A symmetric positive definite preconditioner. Precondition operation is done via member function apply()
+  * @param monitor      A callback routine which is called in each iteration
+  * @param monitor_data Data pointer to be passed to the callback routine to pass on user-specific data
+  * @return The result vector
+  */
+  template<typename MatrixT, typename VectorT, typename PreconditionerT>
+  VectorT solve_impl(MatrixT const & matrix,
+                     VectorT const & rhs,
+                     minres_tag const & tag,
+                     PreconditionerT const & precond,
+                     bool (*monitor)(VectorT const &, typename viennacl::result_of::cpu_value_type<typename viennacl::result_of::value_type<VectorT>::type>::type, void*) = NULL,
+                     void *monitor_data = NULL)
+  {
+    typedef typename viennacl::result_of::value_type<VectorT>::type           NumericType;
+    typedef typename viennacl::result_of::cpu_value_type<NumericType>::type   CPU_NumericType;
+
+    VectorT result = rhs;
+    viennacl::traits::clear(result);
+
+    tag.iters(0);
+    tag.error(0);
+
+    // Lanczos vectors r1, r2 (unnormalized, preconditioned versions y) and search directions w, w1, w2
+    VectorT r1 = rhs;
+    VectorT r2 = rhs;
+    VectorT y  = rhs;
+    precond.apply(y);
+    VectorT v  = rhs;
+    VectorT w  = result;
+    VectorT w1 = result;
+    VectorT w2 = result;
+
+    CPU_NumericType beta1 = viennacl::linalg::inner_prod(r1, y);
+    if (beta1 < 0)
+      throw std::runtime_error("MINRES: preconditioner is not positive definite");
+    beta1 = std::sqrt(beta1);
+    if (beta1 <= tag.abs_tolerance()) //solution is zero if RHS norm is zero
+      return result;
+
+    minres_rotation<CPU_NumericType> rotation(beta1);
+    CPU_NumericType beta = beta1;
+    CPU_NumericType beta_old = 0;
+
+    for (unsigned int i = 0; i < tag.max_iterations(); ++i)
+    {
+      tag.iters(i+1);
+
+      v = y;
+      v /= beta;
+      y = viennacl::linalg::prod(matrix, v);
+      if (i > 0)
+        y -= (beta / beta_old) * r1;
+
+      CPU_NumericType alpha = viennacl::linalg::inner_prod(v, y);
+      y -= (alpha / beta) * r2;
+      r1 = r2;
+      r2 = y;
+      precond.apply(y);
+
+      beta_old = beta;
+      beta = viennacl::linalg::inner_prod(r2, y);
+      if (beta < 0)
+        throw std::runtime_error("MINRES: preconditioner is not positive definite");
+      beta = std::sqrt(beta);
+
+      CPU_NumericType epsilon_old, delta, gamma, phi;
+      rotation.apply(i > 0 ? beta_old : CPU_NumericType(0), alpha, beta, epsilon_old, delta, gamma, phi);
+
+      w1 = w2;
+      w2 = w;
+      w = v - epsilon_old * w1;
+      w -= delta * w2;
+      w /= gamma;
+      result += phi * w;
+
+      CPU_NumericType residual_norm = std::fabs(rotation.phibar);
+      tag.error(residual_norm / beta1);
+      if (monitor && monitor(result, residual_norm / beta1, monitor_data))
+        break;
+      if (residual_norm / beta1 < tag.tolerance() || residual_norm < tag.abs_tolerance() || beta <= 0)
+        break;
+    }
+
+    return result;
+  }
+
+}
+
+
+
+/** @brief Implementation of the MINRES solver.
+*
+* For ViennaCL sparse matrices without preconditioner the pipelined variant with a single synchronization point per iteration is used.
+*
+* @param matrix     The system matrix (symmetric, possibly indefinite)
+* @param rhs        The load vector
+* @param tag        Solver configuration tag
+* @param precond    A symmetric positive definite preconditioner. Precondition operation is done via member function apply()
+* @return The result vector
+*/
+template<typename MatrixT, typename VectorT, typename PreconditionerT>
+VectorT solve(MatrixT const & matrix, VectorT const & rhs, minres_tag const & tag, PreconditionerT const & precond)
+{
+  return detail::solve_impl(matrix, rhs, tag, precond);
+}
+
+/** @brief Convenience overload for calling the MINRES solver using types from the C++ STL.
+  *
+  * A std::vector<std::map<T, U> > matrix is convenient for e.g. finite element assembly.
+  * It is not the fastest option for setting up a system, but often it is fast enough - particularly for just trying things out.
+  */
+template<typename IndexT, typename NumericT, typename PreconditionerT>
+std::vector<NumericT> solve(std::vector< std::map<IndexT, NumericT> > const & A, std::vector<NumericT> const & rhs, minres_tag const & tag, PreconditionerT const & precond)
+{
+  viennacl::compressed_matrix<NumericT> vcl_A;
+  viennacl::copy(A, vcl_A);
+
+  viennacl::vector<NumericT> vcl_rhs(rhs.size());
+  viennacl::copy(rhs, vcl_rhs);
+
+  viennacl::vector<NumericT> vcl_result = solve(vcl_A, vcl_rhs, tag, precond);
+
+  std::vector<NumericT> result(vcl_result.size());
+  viennacl::copy(vcl_result, result);
+  return result;
+}
+
+/** @brief Entry point for the unpreconditioned MINRES method.
+ *
+ *  @param matrix    The system matrix
+ *  @param rhs       Right hand side vector (load vector)
+ *  @param tag       A MINRES tag providing relative tolerances, etc.
+ */
+template<typename MatrixT, typename VectorT>
+VectorT solve(MatrixT const & matrix, VectorT const & rhs, minres_tag const & tag)
+{
+  return solve(matrix, rhs, tag, viennacl::linalg::no_precond());
+}
+
+
+
+template<typename VectorT>
+class minres_solver
+{
+public:
+  typedef typename viennacl::result_of::cpu_value_type<VectorT>::type   numeric_type;
+
+  minres_solver(minres_tag const & tag) : tag_(tag), monitor_callback_(NULL), user_data_(NULL) {}
+
+  template<typename MatrixT, typename PreconditionerT>
+  VectorT operator()(MatrixT const & A, VectorT const & b, PreconditionerT const & precond) const
+  {
+    if (viennacl::traits::size(init_guess_) > 0) // take initial guess into account
+    {
+      VectorT mod_rhs = viennacl::linalg::prod(A, init_guess_);
+      mod_rhs = b - mod_rhs;
+      VectorT y = detail::solve_impl(A, mod_rhs, tag_, precond, monitor_callback_, user_data_);
+      return init_guess_ + y;
+    }
+    return detail::solve_impl(A, b, tag_, precond, monitor_callback_, user_data_);
+  }
+
+
+  template<typename MatrixT>
+  VectorT operator()(MatrixT const & A, VectorT const & b) const
+  {
+    return operator()(A, b, viennacl::linalg::no_precond());
+  }
+
+  /** @brief Specifies an initial guess for the iterative solver.
+    *
+    * An iterative solver for Ax = b with initial guess x_0 is equivalent to an iterative solver for Ay = b' := b - Ax_0, where x = x_0 + y.
+    */
+  void set_initial_guess(VectorT const & x) { init_guess_ = x; }
+
+  /** @brief Sets a monitor function pointer to be called in each iteration. Set to NULL to run without monitor.
+   *
+   *  The monitor function is called with the current guess for the result as first argument and the current relative residual estimate as second argument.
+   *  The third argument is a pointer to user-defined data, through which additional information can be passed.
+   *  This pointer needs to be set with set_monitor_data. If not set, NULL is passed.
+   *  If the montior function returns true, the solver terminates (either convergence or divergence).
+   */
+  void set_monitor(bool (*monitor_fun)(VectorT const &, numeric_type, void *), void *user_data)
+  {
+    monitor_callback_ = monitor_fun;
+    user_data_ = user_data;
+  }
+
+  /** @brief Returns the solver tag containing basic configuration such as tolerances, etc. */
+  minres_tag const & tag() const { return tag_; }
+
+private:
+  minres_tag    tag_;
+  VectorT       init_guess_;
+  bool          (*monitor_callback_)(VectorT const &, numeric_type, void *);
+  void          *user_data_;
+};
+
+
+}
+}
+
+#endif
@@ -53,7 +53,7 @@ namespace viennacl
         * @param max_iterations   The maximum number of iterations
         * @param inner_tol        Inner tolerance for the low-precision iterations
         */
-        mixed_precision_cg_tag(double tol = 1e-8, unsigned int max_iterations = 300, float inner_tol = 1e-2f) : tol_(tol), iterations_(max_iterations), inner_tol_(inner_tol) {}
+        mixed_precision_cg_tag(double tol = 1e-8, unsigned int max_iterations = 300, float inner_tol = 1e-2f) : tol_(tol), iterations_(max_iterations), inner_tol_(inner_tol), iters_taken_(0), last_error_(0) {}
 
         /** @brief Returns the relative tolerance */
         double tolerance() const { return tol_; }
@@ -83,6 +83,66 @@ namespace viennacl
     };
 
 
+    namespace detail
+    {
+      /** @brief Fills the single precision matrix used for the inner iterations from a compressed_matrix. */
+      template<typename NumericT, unsigned int AlignmentV>
+      void mixed_precision_cg_copy_low_precision(viennacl::compressed_matrix<NumericT, AlignmentV> const & matrix,
+                                                 viennacl::compressed_matrix<float> & matrix_low_precision)
+      {
+        viennacl::backend::memory_copy(matrix.handle1(), const_cast<viennacl::backend::mem_handle &>(matrix_low_precision.handle1()), 0, 0, matrix_low_precision.handle1().raw_size() );
+        viennacl::backend::memory_copy(matrix.handle2(), const_cast<viennacl::backend::mem_handle &>(matrix_low_precision.handle2()), 0, 0, matrix_low_precision.handle2().raw_size() );
+
+        viennacl::vector_base<NumericT> matrix_elements_high_precision(const_cast<viennacl::backend::mem_handle &>(matrix.handle()), matrix.nnz(), 0, 1);
+        viennacl::vector_base<float>    matrix_elements_low_precision(matrix_low_precision.handle(), matrix.nnz(), 0, 1);
+        matrix_elements_low_precision = matrix_elements_high_precision;
+        matrix_low_precision.generate_row_block_information();
+      }
+
+      /** @brief Fills the single precision matrix used for the inner iterations from a mixed_compressed_matrix with single precision storage. The values are copied without conversion. */
+      template<typename NumericT>
+      void mixed_precision_cg_copy_low_precision(viennacl::mixed_compressed_matrix<NumericT, float> const & matrix,
+                                                 viennacl::compressed_matrix<float> & matrix_low_precision)
+      {
+        viennacl::backend::memory_copy(matrix.handle1(), const_cast<viennacl::backend::mem_handle &>(matrix_low_precision.handle1()), 0, 0, matrix_low_precision.handle1().raw_size() );
+        viennacl::backend::memory_copy(matrix.handle2(), const_cast<viennacl::backend::mem_handle &>(matrix_low_precision.handle2()), 0, 0, matrix_low_precision.handle2().raw_size() );
+        viennacl::backend::memory_copy(matrix.handle(),  const_cast<viennacl::backend::mem_handle &>(matrix_low_precision.handle()),  0, 0, sizeof(float) * matrix.nnz() );
+        matrix_low_precision.generate_row_block_information();
+      }
+
+      /** @brief Fills the single precision matrix used for the inner iterations from a mixed_ell_matrix with single precision storage. Padding entries of the ELL format are dropped. */
+      template<typename NumericT>
+      void mixed_precision_cg_copy_low_precision(viennacl::mixed_ell_matrix<NumericT, float> const & matrix,
+                                                 viennacl::compressed_matrix<float> & matrix_low_precision)
+      {
+        float        const * elements = reinterpret_cast<float const *>(matrix.handle().ram_handle().get());
+        unsigned int const * coords   = reinterpret_cast<unsigned int const *>(matrix.handle2().ram_handle().get());
+
+        std::vector<unsigned int> row_buffer(matrix.size1() + 1);
+        std::vector<unsigned int> col_buffer;
+        std::vector<float>        values;
+        col_buffer.reserve(matrix.nnz());
+        values.reserve(matrix.nnz());
+        for (vcl_size_t row = 0; row < matrix.size1(); ++row)
+        {
+          row_buffer[row] = static_cast<unsigned int>(col_buffer.size());
+          for (vcl_size_t item_id = 0; item_id < matrix.internal_maxnnz(); ++item_id)
+          {
+            vcl_size_t offset = row + item_id * matrix.internal_size1();
+            if (elements[offset] > 0 || elements[offset] < 0)
+            {
+              col_buffer.push_back(coords[offset]);
+              values.push_back(elements[offset]);
+            }
+          }
+        }
+        row_buffer[matrix.size1()] = static_cast<unsigned int>(col_buffer.size());
+
+        matrix_low_precision.set(&(row_buffer[0]), col_buffer.size() ? &(col_buffer[0]) : NULL, values.size() ? &(values[0]) : NULL,
+                                 matrix.size1(), matrix.size2(), values.size());
+      }
+    }
+
     /** @brief Implementation of the conjugate gradient solver without preconditioner
     *
     * Following the algorithm in the book by Y. Saad "Iterative Methods for sparse linear systems"
@@ -128,13 +188,7 @@ namespace viennacl
 
       // transfer matrix to single precision:
       viennacl::compressed_matrix<float> matrix_low_precision(matrix.size1(), matrix.size2(), matrix.nnz(), viennacl::traits::context(rhs));
-      viennacl::backend::memory_copy(matrix.handle1(), const_cast<viennacl::backend::mem_handle &>(matrix_low_precision.handle1()), 0, 0, matrix_low_precision.handle1().raw_size() );
-      viennacl::backend::memory_copy(matrix.handle2(), const_cast<viennacl::backend::mem_handle &>(matrix_low_precision.handle2()), 0, 0, matrix_low_precision.handle2().raw_size() );
-
-      viennacl::vector_base<CPU_ScalarType> matrix_elements_high_precision(const_cast<viennacl::backend::mem_handle &>(matrix.handle()), matrix.nnz(), 0, 1);
-      viennacl::vector_base<float>          matrix_elements_low_precision(matrix_low_precision.handle(), matrix.nnz(), 0, 1);
-      matrix_elements_low_precision = matrix_elements_high_precision;
-      matrix_low_precision.generate_row_block_information();
+      detail::mixed_precision_cg_copy_low_precision(matrix, matrix_low_precision);
 
       for (unsigned int i = 0; i < tag.max_iterations(); ++i)
       {
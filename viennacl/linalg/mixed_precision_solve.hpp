@@ -0,0 +1,266 @@
+#ifndef VIENNACL_LINALG_MIXED_PRECISION_SOLVE_HPP_
+#define VIENNACL_LINALG_MIXED_PRECISION_SOLVE_HPP_
+
+/* =========================================================================
+   Copyright (c) 2010-2016, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+   Portions of this software are copyright by UChicago Argonne, LLC.
+
+                            -----------------
+                  ViennaCL - The Vienna Computing Library
+                            -----------------
+
+   Project Head:    Karl Rupp                   rupp@iue.tuwien.ac.at
+
+   (A list of authors and contributors can be found in the manual)
+
+   License:         MIT (X11), see file LICENSE in the base directory
+============================================================================= */
+
+/** @file viennacl/linalg/mixed_precision_solve.hpp
+    @brief Mixed precision iterative refinement for arbitrary iterative solvers: The correction equations are solved in single precision, residuals are computed in the precision of the system.
+
+    The inner solver is selected by the type of its tag, i.e. the header of the inner solver needs to be included.
+*/
+
+#include <vector>
+#include <cmath>
+
+#include "viennacl/forwards.h"
+#include "viennacl/vector.hpp"
+#include "viennacl/compressed_matrix.hpp"
+#include "viennacl/linalg/prod.hpp"
+#include "viennacl/linalg/norm_2.hpp"
+#include "viennacl/linalg/mixed_precision_cg.hpp"
+#include "viennacl/linalg/fgmres.hpp"
+#include "viennacl/linalg/jacobi_precond.hpp"
+#include "viennacl/linalg/ilu.hpp"
+#include "viennacl/linalg/ichol.hpp"
+#include "viennacl/linalg/amg.hpp"
+#include "viennacl/linalg/chebyshev.hpp"
+#include "viennacl/traits/context.hpp"
+
+namespace viennacl
+{
+namespace linalg
+{
+
+/** @brief A tag for mixed precision iterative refinement. Used for supplying the parameters of the outer iteration and for returning its statistics.
+*/
+class mixed_precision_tag
+{
+public:
+  /** @brief The constructor
+  *
+  * @param tol              Relative tolerance for the residual evaluated in high precision (refinement quits if ||r|| < tol * ||rhs||)
+  * @param max_refinements  The maximum number of refinement steps, each consisting of one single precision solve
+  */
+  mixed_precision_tag(double tol = 1e-10, unsigned int max_refinements = 30) : tol_(tol), max_refinements_(max_refinements), iters_taken_(0), inner_iters_taken_(0), last_error_(0) {}
+
+  /** @brief Returns the relative tolerance */
+  double tolerance() const { return tol_; }
+
+  /** @brief Returns the maximum number of refinement steps */
+  unsigned int max_refinements() const { return max_refinements_; }
+
+  /** @brief Return the number of refinement steps */
+  unsigned int iters() const { return iters_taken_; }
+  void iters(unsigned int i) const { iters_taken_ = i; }
+
+  /** @brief Return the total number of iterations of the inner solver over all refinement steps */
+  vcl_size_t inner_iters() const { return inner_iters_taken_; }
+  void inner_iters(vcl_size_t i) const { inner_iters_taken_ = i; }
+
+  /** @brief Returns the relative residual at the end of the solver run, evaluated in high precision */
+  double error() const { return last_error_; }
+  /** @brief Sets the relative residual at the end of the solver run */
+  void error(double e) const { last_error_ = e; }
+
+private:
+  double tol_;
+  unsigned int max_refinements_;
+
+  //return values from solver
+  mutable unsigned int iters_taken_;
+  mutable vcl_size_t inner_iters_taken_;
+  mutable double last_error_;
+};
+
+
+namespace detail
+{
+  /** @brief Maps a preconditioner tag to the preconditioner built for the single precision copy of the system matrix.
+  *
+  * Preconditioners requiring a setup phase after construction (AMG) run it in setup().
+  */
+  template<typename PrecondTagT>
+  struct mixed_precision_precond;
+
+  template<>
+  struct mixed_precision_precond<viennacl::linalg::jacobi_tag>
+  {
+    typedef viennacl::linalg::jacobi_precond< viennacl::compressed_matrix<float> >   type;
+    static void setup(type &) {}
+  };
+
+  template<>
+  struct mixed_precision_precond<viennacl::linalg::ilu0_tag>
+  {
+    typedef viennacl::linalg::ilu0_precond< viennacl::compressed_matrix<float> >     type;
+    static void setup(type &) {}
+  };
+
+  template<>
+  struct mixed_precision_precond<viennacl::linalg::ilut_tag>
+  {
+    typedef viennacl::linalg::ilut_precond< viennacl::compressed_matrix<float> >     type;
+    static void setup(type &) {}
+  };
+
+  template<>
+  struct mixed_precision_precond<viennacl::linalg::ichol0_tag>
+  {
+    typedef viennacl::linalg::ichol0_precond< viennacl::compressed_matrix<float> >   type;
+    static void setup(type &) {}
+  };
+
+  template<>
+  struct mixed_precision_precond<viennacl::linalg::chebyshev_precond_tag>
+  {
+    typedef viennacl::linalg::chebyshev_precond< viennacl::compressed_matrix<float> > type;
+    static void setup(type &) {}
+  };
+
+  template<>
+  struct mixed_precision_precond<viennacl::linalg::amg_tag>
+  {
+    typedef viennacl::linalg::amg_precond< viennacl::compressed_matrix<float> >      type;
+    static void setup(type & precond) { precond.setup(); }
+  };
+
+
+  /** @brief Implementation of mixed precision iterative refinement.
+  *
+  * In each step the residual is scaled to unit norm (keeping clear of the range limits of single precision), the correction equation is solved by the single precision inner solver,
+  * and the correction is added to the result in high precision. The true residual is then evaluated in high precision.
+  * Refinement stops if the residual does not decrease anymore, i.e. if the system is too ill-conditioned for single precision. The last correction is discarded in this case, so the iterate with the smallest residual is returned.
+  *
+  * @param A             The system matrix in high precision
+  * @param rhs           The load vector
+  * @param inner_solver  The single precision inner solver, which solves in place through apply() and counts its iterations in total_iters()
+  * @param tag           Configuration of the refinement
+  * @return The result vector
+  */
+  template<typename MatrixT, typename NumericT, typename InnerSolverT>
+  viennacl::vector<NumericT> mixed_precision_refinement(MatrixT const & A,
+                                                        viennacl::vector<NumericT> const & rhs,
+                                                        InnerSolverT const & inner_solver,
+                                                        mixed_precision_tag const & tag)
+  {
+    viennacl::context ctx = viennacl::traits::context(rhs);
+    viennacl::vector<NumericT> result = viennacl::zero_vector<NumericT>(rhs.size(), ctx);
+    viennacl::vector<NumericT> new_result(rhs.size(), ctx);
+    viennacl::vector<NumericT> residual = rhs;
+    viennacl::vector<float>    residual_low_precision(rhs.size(), ctx);
+
+    tag.iters(0);
+    tag.inner_iters(0);
+    tag.error(0);
+
+    NumericT norm_rhs = viennacl::linalg::norm_2(rhs);
+    if (norm_rhs <= 0) //solution is zero if RHS norm is zero
+      return result;
+
+    NumericT norm_residual = norm_rhs;
+    tag.error(1);
+    for (unsigned int i = 0; i < tag.max_refinements(); ++i)
+    {
+      tag.iters(i+1);
+
+      // correction equation in low precision:
+      residual /= norm_residual;
+      residual_low_precision = residual;
+      inner_solver.apply(residual_low_precision);
+      residual = residual_low_precision; // reusing residual vector as temporary buffer for conversion. Overwritten below anyway
+      new_result = result + norm_residual * residual;
+
+      // residual = b - Ax in high precision (without introducing a temporary)
+      residual = viennacl::linalg::prod(A, new_result);
+      residual = rhs - residual;
+
+      NumericT new_norm_residual = viennacl::linalg::norm_2(residual);
+      if (!(new_norm_residual < norm_residual)) // correction did not improve the result (also catches a breakdown of the inner solver): keep the previous iterate
+        break;
+
+      result.fast_swap(new_result);
+      norm_residual = new_norm_residual;
+      tag.error(norm_residual / norm_rhs);
+      if (norm_residual < tag.tolerance() * norm_rhs)
+        break;
+    }
+
+    tag.inner_iters(inner_solver.total_iters());
+    return result;
+  }
+}
+
+
+/** @brief Solves the system by mixed precision iterative refinement without preconditioner.
+*
+* A single precision copy of the system matrix is kept, on which the inner solver runs. Hence the memory traffic of the inner iterations is about halved compared to double precision.
+*
+* @param A          The system matrix: compressed_matrix, or mixed_compressed_matrix/mixed_ell_matrix with single precision storage
+* @param rhs        The load vector
+* @param inner_tag  Tag of the inner solver (e.g. cg_tag, bicgstab_tag, gmres_tag). Its tolerance is the residual reduction per refinement step.
+* @param tag        Configuration of the refinement. A double is converted implicitly and taken as the outer tolerance.
+* @return The result vector
+*/
+template<typename MatrixT, typename NumericT, typename InnerTagT>
+viennacl::vector<NumericT> mixed_precision_solve(MatrixT const & A,
+                                                 viennacl::vector<NumericT> const & rhs,
+                                                 InnerTagT const & inner_tag,
+                                                 mixed_precision_tag const & tag)
+{
+  viennacl::compressed_matrix<float> A_low_precision(A.size1(), A.size2(), A.nnz(), viennacl::traits::context(rhs));
+  detail::mixed_precision_cg_copy_low_precision(A, A_low_precision);
+
+  viennacl::linalg::inner_solver_precond<viennacl::compressed_matrix<float>, InnerTagT> inner_solver(A_low_precision, inner_tag);
+  return detail::mixed_precision_refinement(A, rhs, inner_solver, tag);
+}
+
+/** @brief Solves the system by mixed precision iterative refinement with a preconditioned inner solver.
+*
+* The preconditioner is set up from the single precision copy of the system matrix once and reused for all refinement steps.
+*
+* @param A            The system matrix: compressed_matrix, or mixed_compressed_matrix/mixed_ell_matrix with single precision storage
+* @param rhs          The load vector
+* @param inner_tag    Tag of the inner solver (e.g. cg_tag, bicgstab_tag, gmres_tag). Its tolerance is the residual reduction per refinement step.
+* @param tag          Configuration of the refinement. A double is converted implicitly and taken as the outer tolerance.
+* @param precond_tag  Tag of the preconditioner: jacobi_tag, ilu0_tag, ilut_tag, ichol0_tag, chebyshev_precond_tag, or amg_tag
+* @return The result vector
+*/
+template<typename MatrixT, typename NumericT, typename InnerTagT, typename PrecondTagT>
+viennacl::vector<NumericT> mixed_precision_solve(MatrixT const & A,
+                                                 viennacl::vector<NumericT> const & rhs,
+                                                 InnerTagT const & inner_tag,
+                                                 mixed_precision_tag const & tag,
+                                                 PrecondTagT const & precond_tag)
+{
+  typedef detail::mixed_precision_precond<PrecondTagT>   PrecondTraits;
+  typedef typename PrecondTraits::type                   PrecondType;
+
+  viennacl::compressed_matrix<float> A_low_precision(A.size1(), A.size2(), A.nnz(), viennacl::traits::context(rhs));
+  detail::mixed_precision_cg_copy_low_precision(A, A_low_precision);
+
+  PrecondType precond(A_low_precision, precond_tag);
+  PrecondTraits::setup(precond);
+
+  viennacl::linalg::inner_solver_precond<viennacl::compressed_matrix<float>, InnerTagT, PrecondType> inner_solver(A_low_precision, inner_tag, precond);
+  return detail::mixed_precision_refinement(A, rhs, inner_solver, tag);
+}
+
+}
+}
+
+#endif
@@ -347,6 +347,25 @@ namespace viennacl
                                          op_prod >(A, B);
     }
 
+    /** @brief Product of the transpose of a compressed_matrix with a dense matrix. The transpose is not formed explicitly in host memory. */
+    template<typename NumericT, unsigned int AlignmentV>
+    viennacl::matrix_expression<const viennacl::matrix_expression<const compressed_matrix<NumericT, AlignmentV>,
+                                                                  const compressed_matrix<NumericT, AlignmentV>,
+                                                                  op_trans>,
+                                const viennacl::matrix_base<NumericT>,
+                                op_prod >
+    prod(viennacl::matrix_expression<const compressed_matrix<NumericT, AlignmentV>,
+                                     const compressed_matrix<NumericT, AlignmentV>,
+                                     op_trans> const & A,
+         viennacl::matrix_base<NumericT> const & B)
+    {
+      return viennacl::matrix_expression<const viennacl::matrix_expression<const compressed_matrix<NumericT, AlignmentV>,
+                                                                           const compressed_matrix<NumericT, AlignmentV>,
+                                                                           op_trans>,
+                                         const viennacl::matrix_base<NumericT>,
+                                         op_prod >(A, B);
+    }
+
     /** @brief Generic matrix-vector product with user-provided sparse matrix type */
     template<typename SparseMatrixType, typename NumericT>
     vector_expression<const SparseMatrixType,
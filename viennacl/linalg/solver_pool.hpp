@@ -0,0 +1,368 @@
+#ifndef VIENNACL_LINALG_SOLVER_POOL_HPP_
+#define VIENNACL_LINALG_SOLVER_POOL_HPP_
+
+/* =========================================================================
+   Copyright (c) 2010-2016, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+   Portions of this software are copyright by UChicago Argonne, LLC.
+
+                            -----------------
+                  ViennaCL - The Vienna Computing Library
+                            -----------------
+
+   Project Head:    Karl Rupp                   rupp@iue.tuwien.ac.at
+
+   (A list of authors and contributors can be found in the manual)
+
+   License:         MIT (X11), see file LICENSE in the base directory
+============================================================================= */
+
+/** @file viennacl/linalg/solver_pool.hpp
+    @brief A pool for running many independent solves concurrently, each with a bounded number of threads for the host kernels.
+
+    Solves are queued with solve_async(), which returns a solve_future. Queued solves are executed all at once when the pool is run, either explicitly or by the first call to get() on one of the futures.
+    Solves still queued when the pool is destroyed are discarded, and their futures report an error.
+    The solver is selected by the type of the tag, i.e. the header of the solver needs to be included.
+*/
+
+#include <vector>
+#include <map>
+#include <string>
+#include <stdexcept>
+#include <algorithm>
+
+#include "viennacl/forwards.h"
+#include "viennacl/tools/shared_ptr.hpp"
+#include "viennacl/traits/handle.hpp"
+
+#ifdef VIENNACL_WITH_OPENMP
+#include <omp.h>
+#endif
+
+namespace viennacl
+{
+namespace linalg
+{
+
+class solver_pool;
+
+namespace detail
+{
+  /** @brief Result of a queued solve, shared by the queued task and the future */
+  template<typename VectorT, typename TagT>
+  struct async_solve_state
+  {
+    async_solve_state(TagT const & solver_tag) : tag(solver_tag), done(false) {}
+
+    VectorT     result;
+    TagT        tag;           // holds the iteration statistics once done
+    bool        done;
+    std::string error_message; // non-empty if the solver threw
+  };
+
+  /** @brief Interface of a queued solve */
+  class async_solve_task_base
+  {
+  public:
+    virtual ~async_solve_task_base() {}
+
+    /** @brief Runs the solve. Must not throw, since it is called from within a parallel region. */
+    virtual void run() = 0;
+
+    /** @brief Marks the solve as failed without running it */
+    virtual void cancel(std::string const & reason) = 0;
+
+    /** @brief Returns true if all data resides in main memory, so that the task may run concurrently with other tasks */
+    virtual bool host_based() const = 0;
+
+    /** @brief Returns the address of the preconditioner, or NULL if the task has no state shared with other tasks */
+    virtual void const * shared_precond() const = 0;
+  };
+
+  /** @brief Returns the address of a preconditioner, which identifies tasks sharing it */
+  template<typename PrecondT>
+  void const * async_solve_precond_address(PrecondT const & precond) { return &precond; }
+
+  /** @brief The stateless no_precond may be shared freely */
+  inline void const * async_solve_precond_address(viennacl::linalg::no_precond const &) { return NULL; }
+
+  /** @brief A queued solve. The right hand side and the tag are copied, the system matrix and the preconditioner are referenced. */
+  template<typename MatrixT, typename VectorT, typename TagT, typename PrecondT>
+  class async_solve_task : public async_solve_task_base
+  {
+  public:
+    async_solve_task(MatrixT const & A, VectorT const & rhs, PrecondT const & precond, viennacl::tools::shared_ptr<async_solve_state<VectorT, TagT> > const & state)
+      : A_(A), rhs_(rhs), precond_(precond), state_(state) {}
+
+    void run()
+    {
+      try
+      {
+        state_->result = solve(A_, rhs_, state_->tag, precond_);
+      }
+      catch (std::exception const & e)
+      {
+        state_->error_message = std::string(e.what());
+      }
+      catch (...)
+      {
+        state_->error_message = "unknown exception";
+      }
+      state_->done = true;
+    }
+
+    void cancel(std::string const & reason)
+    {
+      state_->error_message = reason;
+      state_->done = true;
+    }
+
+    bool host_based() const { return viennacl::traits::active_handle_id(rhs_) == viennacl::MAIN_MEMORY; }
+
+    void const * shared_precond() const { return async_solve_precond_address(precond_); }
+
+  private:
+    MatrixT const & A_;
+    VectorT rhs_;
+    PrecondT const & precond_;
+    viennacl::tools::shared_ptr<async_solve_state<VectorT, TagT> > state_;
+  };
+}
+
+
+/** @brief Handle to the result of a solve queued in a solver_pool, cf. std::future.
+*
+* The result becomes available once the pool has been run. Calling get() or wait() runs the pool if the result is not available yet.
+*/
+template<typename VectorT, typename TagT>
+class solve_future
+{
+  typedef detail::async_solve_state<VectorT, TagT>   StateType;
+
+public:
+  solve_future() : pool_(NULL) {}
+  solve_future(solver_pool * pool, viennacl::tools::shared_ptr<StateType> const & state) : pool_(pool), state_(state) {}
+
+  /** @brief Returns true if the future refers to a queued solve */
+  bool valid() const { return state_.get() != NULL; }
+
+  /** @brief Returns true if the result is available without running the pool */
+  bool ready() const { return valid() && state_->done; }
+
+  /** @brief Waits for the result, running all solves queued in the pool if necessary. Throws a std::runtime_error if the solver threw. */
+  void wait() const;
+
+  /** @brief Returns the result, running all solves queued in the pool if necessary */
+  VectorT const & get() const
+  {
+    wait();
+    return state_->result;
+  }
+
+  /** @brief Returns the solver tag holding the iteration statistics of the solve */
+  TagT const & tag() const
+  {
+    wait();
+    return state_->tag;
+  }
+
+private:
+  solver_pool * pool_;
+  viennacl::tools::shared_ptr<StateType> state_;
+};
+
+
+/** @brief A pool running independent solves concurrently.
+*
+* The available threads are split into groups of threads_per_solve() threads. Each group takes the next queued solve as soon as it has finished its previous one,
+* and the host kernels within a solve use only the threads of their group (through nested OpenMP parallelism).
+* This avoids the oversubscription of cores when many small solves each open parallel regions for all cores.
+*
+* Only solves with all data in main memory are run concurrently. If a queued solve uses the OpenCL or CUDA backend, all solves are run one after another.
+* The system matrices and preconditioners are referenced, not copied, hence they need to outlive the execution of the pool.
+* Solves not run by the time the pool is destroyed are discarded, i.e. the pool needs to be run (explicitly or through a future) before it goes out of scope.
+* Since several preconditioners (e.g. AMG, ILUT, Chebyshev) use mutable work vectors in their apply phase, solves sharing a preconditioner object are run one after another.
+*/
+class solver_pool
+{
+public:
+  /** @brief The constructor
+  *
+  * @param threads_per_solve  Number of threads for the host kernels within a single solve
+  * @param num_threads        Total number of threads. The default is the maximum number of OpenMP threads.
+  */
+  explicit solver_pool(vcl_size_t threads_per_solve = 1, vcl_size_t num_threads = 0) : threads_per_solve_(std::max<vcl_size_t>(threads_per_solve, 1)), num_threads_(num_threads)
+  {
+#ifdef VIENNACL_WITH_OPENMP
+    if (num_threads_ == 0)
+      num_threads_ = static_cast<vcl_size_t>(omp_get_max_threads());
+#endif
+    num_threads_ = std::max<vcl_size_t>(num_threads_, threads_per_solve_);
+  }
+
+  /** @brief Discards all solves still pending. Their futures report an error on access.
+  *
+  * Pending solves are not run here, since the referenced system matrices and preconditioners may already be destroyed (e.g. for the default pool, which is destroyed at program exit).
+  */
+  ~solver_pool()
+  {
+    for (vcl_size_t i=0; i<tasks_.size(); ++i)
+      tasks_[i]->cancel("solver pool destroyed before the solve was run");
+  }
+
+  /** @brief Returns the number of threads for the host kernels within a single solve */
+  vcl_size_t threads_per_solve() const { return threads_per_solve_; }
+  /** @brief Sets the number of threads for the host kernels within a single solve. Applies to the next run of the pool. */
+  void threads_per_solve(vcl_size_t num) { threads_per_solve_ = std::max<vcl_size_t>(num, 1); num_threads_ = std::max(num_threads_, threads_per_solve_); }
+
+  /** @brief Returns the total number of threads */
+  vcl_size_t num_threads() const { return num_threads_; }
+
+  /** @brief Returns the number of solves run concurrently */
+  vcl_size_t concurrent_solves() const { return num_threads_ / threads_per_solve_; }
+
+  /** @brief Returns the number of queued solves not run yet */
+  vcl_size_t pending() const { return tasks_.size(); }
+
+  /** @brief Queues the solution of A x = rhs with the solver selected by 'tag' and the preconditioner 'precond'.
+  *
+  * @param A        The system matrix, referenced
+  * @param rhs      The right hand side, copied
+  * @param tag      The solver tag, copied. The copy holding the iteration statistics is available through solve_future::tag().
+  * @param precond  The preconditioner, referenced
+  * @return A future providing the result once the pool has been run
+  */
+  template<typename MatrixT, typename VectorT, typename TagT, typename PrecondT>
+  solve_future<VectorT, TagT> solve_async(MatrixT const & A, VectorT const & rhs, TagT const & tag, PrecondT const & precond)
+  {
+    typedef detail::async_solve_state<VectorT, TagT>                   StateType;
+    typedef detail::async_solve_task<MatrixT, VectorT, TagT, PrecondT> TaskType;
+
+    viennacl::tools::shared_ptr<StateType> state(new StateType(tag));
+    tasks_.push_back(viennacl::tools::shared_ptr<detail::async_solve_task_base>(new TaskType(A, rhs, precond, state)));
+    return solve_future<VectorT, TagT>(this, state);
+  }
+
+  /** @brief Queues the solution of A x = rhs with the solver selected by 'tag' without preconditioner */
+  template<typename MatrixT, typename VectorT, typename TagT>
+  solve_future<VectorT, TagT> solve_async(MatrixT const & A, VectorT const & rhs, TagT const & tag)
+  {
+    return solve_async(A, rhs, tag, no_precond_);
+  }
+
+  /** @brief Runs all queued solves and returns once all of them have finished */
+  void run()
+  {
+    // take the queue, so that solves queued meanwhile (or a nested call through a future) do not interfere:
+    std::vector<viennacl::tools::shared_ptr<detail::async_solve_task_base> > tasks;
+    tasks.swap(tasks_);
+    if (tasks.empty())
+      return;
+
+    bool concurrent = true;
+    for (vcl_size_t i=0; i<tasks.size(); ++i)
+      concurrent = concurrent && tasks[i]->host_based();
+
+#ifdef VIENNACL_WITH_OPENMP
+    // chains of tasks run one after another: tasks sharing a preconditioner are put into the same chain
+    std::vector<std::vector<vcl_size_t> > chains;
+    std::map<void const *, vcl_size_t> chain_of_precond;
+    for (vcl_size_t i=0; i<tasks.size(); ++i)
+    {
+      void const * precond = tasks[i]->shared_precond();
+      if (!precond)
+      {
+        chains.push_back(std::vector<vcl_size_t>(1, i));
+        continue;
+      }
+
+      std::map<void const *, vcl_size_t>::const_iterator it = chain_of_precond.find(precond);
+      if (it == chain_of_precond.end())
+      {
+        chain_of_precond[precond] = chains.size();
+        chains.push_back(std::vector<vcl_size_t>(1, i));
+      }
+      else
+        chains[it->second].push_back(i);
+    }
+
+    vcl_size_t num_groups = std::min(concurrent_solves(), chains.size());
+    if (concurrent && (num_groups > 1 || threads_per_solve_ < static_cast<vcl_size_t>(omp_get_max_threads())))
+    {
+      int old_max_active_levels = omp_get_max_active_levels();
+      omp_set_max_active_levels(std::max(old_max_active_levels, omp_get_level() + 2));
+
+      long num_chains = static_cast<long>(chains.size());
+      int threads_per_solve = static_cast<int>(threads_per_solve_);
+      #pragma omp parallel num_threads(static_cast<int>(num_groups))
+      {
+        // thread budget of the nested parallel regions opened by the host kernels of this thread:
+        omp_set_num_threads(threads_per_solve);
+
+        #pragma omp for schedule(dynamic, 1)
+        for (long i = 0; i < num_chains; ++i)
+        {
+          std::vector<vcl_size_t> const & chain = chains[static_cast<vcl_size_t>(i)];
+          for (vcl_size_t j=0; j<chain.size(); ++j)
+            tasks[chain[j]]->run();
+        }
+      }
+
+      omp_set_max_active_levels(old_max_active_levels);
+      return;
+    }
+#endif
+
+    for (vcl_size_t i=0; i<tasks.size(); ++i)
+      tasks[i]->run();
+  }
+
+private:
+  solver_pool(solver_pool const &);
+  solver_pool & operator=(solver_pool const &);
+
+  vcl_size_t threads_per_solve_;
+  vcl_size_t num_threads_;
+  viennacl::linalg::no_precond no_precond_;
+  std::vector<viennacl::tools::shared_ptr<detail::async_solve_task_base> > tasks_;
+};
+
+
+template<typename VectorT, typename TagT>
+void solve_future<VectorT, TagT>::wait() const
+{
+  if (!valid())
+    throw std::runtime_error("solve_future: no solve associated");
+  if (!state_->done && pool_)
+    pool_->run();
+  if (!state_->error_message.empty())
+    throw std::runtime_error("Asynchronous solve failed: " + state_->error_message);
+}
+
+
+/** @brief Returns the pool used by the free solve_async() functions. Its number of threads per solve can be adjusted through solver_pool::threads_per_solve(). */
+inline solver_pool & default_solver_pool()
+{
+  static solver_pool pool;
+  return pool;
+}
+
+/** @brief Queues a solve in the default solver pool. See solver_pool::solve_async(). */
+template<typename MatrixT, typename VectorT, typename TagT, typename PrecondT>
+solve_future<VectorT, TagT> solve_async(MatrixT const & A, VectorT const & rhs, TagT const & tag, PrecondT const & precond)
+{
+  return default_solver_pool().solve_async(A, rhs, tag, precond);
+}
+
+/** @brief Queues a solve without preconditioner in the default solver pool. See solver_pool::solve_async(). */
+template<typename MatrixT, typename VectorT, typename TagT>
+solve_future<VectorT, TagT> solve_async(MatrixT const & A, VectorT const & rhs, TagT const & tag)
+{
+  return default_solver_pool().solve_async(A, rhs, tag);
+}
+
+}
+}
+
+#endif
@@ -27,6 +27,7 @@
 #include "viennacl/vector.hpp"
 #include "viennacl/matrix.hpp"
 #include "viennacl/tools/tools.hpp"
+#include "viennacl/linalg/spgemm_plan.hpp"
 #include "viennacl/linalg/host_based/sparse_matrix_operations.hpp"
 
 #ifdef VIENNACL_WITH_OPENCL
@@ -120,6 +121,98 @@ namespace viennacl
       }
     }
 
+    /** @brief Carries out matrix-vector multiplication involving a delta_compressed_matrix. The format is only available in host memory.
+    *
+    * Implementation of the convenience expression result = prod(mat, vec);
+    *
+    * @param mat    The matrix
+    * @param vec    The vector
+    * @param result The result vector
+    */
+    template<typename NumericT>
+    void prod_impl(const viennacl::delta_compressed_matrix<NumericT> & mat,
+                   const viennacl::vector_base<NumericT> & vec,
+                   NumericT alpha,
+                         viennacl::vector_base<NumericT> & result,
+                   NumericT beta)
+    {
+      assert( (mat.size1() == result.size()) && bool("Size check failed for compressed matrix-vector product: size1(mat) != size(result)"));
+      assert( (mat.size2() == vec.size())    && bool("Size check failed for compressed matrix-vector product: size2(mat) != size(x)"));
+
+      switch (viennacl::traits::handle(mat).get_active_handle_id())
+      {
+        case viennacl::MAIN_MEMORY:
+          viennacl::linalg::host_based::prod_impl(mat, vec, alpha, result, beta);
+          break;
+        case viennacl::MEMORY_NOT_INITIALIZED:
+          throw memory_exception("not initialised!");
+        default:
+          throw memory_exception("not implemented");
+      }
+    }
+
+
+    /** @brief Carries out matrix-vector multiplication involving a mixed_compressed_matrix. The format is only available in host memory.
+    *
+    * Implementation of the convenience expression result = prod(mat, vec);
+    *
+    * @param mat    The matrix
+    * @param vec    The vector
+    * @param result The result vector
+    */
+    template<typename NumericT, typename StorageT>
+    void prod_impl(const viennacl::mixed_compressed_matrix<NumericT, StorageT> & mat,
+                   const viennacl::vector_base<NumericT> & vec,
+                   NumericT alpha,
+                         viennacl::vector_base<NumericT> & result,
+                   NumericT beta)
+    {
+      assert( (mat.size1() == result.size()) && bool("Size check failed for compressed matrix-vector product: size1(mat) != size(result)"));
+      assert( (mat.size2() == vec.size())    && bool("Size check failed for compressed matrix-vector product: size2(mat) != size(x)"));
+
+      switch (viennacl::traits::handle(mat).get_active_handle_id())
+      {
+        case viennacl::MAIN_MEMORY:
+          viennacl::linalg::host_based::prod_impl(mat, vec, alpha, result, beta);
+          break;
+        case viennacl::MEMORY_NOT_INITIALIZED:
+          throw memory_exception("not initialised!");
+        default:
+          throw memory_exception("not implemented");
+      }
+    }
+
+
+    /** @brief Carries out matrix-vector multiplication involving a mixed_ell_matrix. The format is only available in host memory.
+    *
+    * Implementation of the convenience expression result = prod(mat, vec);
+    *
+    * @param mat    The matrix
+    * @param vec    The vector
+    * @param result The result vector
+    */
+    template<typename NumericT, typename StorageT>
+    void prod_impl(const viennacl::mixed_ell_matrix<NumericT, StorageT> & mat,
+                   const viennacl::vector_base<NumericT> & vec,
+                   NumericT alpha,
+                         viennacl::vector_base<NumericT> & result,
+                   NumericT beta)
+    {
+      assert( (mat.size1() == result.size()) && bool("Size check failed for compressed matrix-vector product: size1(mat) != size(result)"));
+      assert( (mat.size2() == vec.size())    && bool("Size check failed for compressed matrix-vector product: size2(mat) != size(x)"));
+
+      switch (viennacl::traits::handle(mat).get_active_handle_id())
+      {
+        case viennacl::MAIN_MEMORY:
+          viennacl::linalg::host_based::prod_impl(mat, vec, alpha, result, beta);
+          break;
+        case viennacl::MEMORY_NOT_INITIALIZED:
+          throw memory_exception("not initialised!");
+        default:
+          throw memory_exception("not implemented");
+      }
+    }
+
 
     // A * B
     /** @brief Carries out matrix-matrix multiplication first matrix being sparse
@@ -247,6 +340,572 @@ namespace viennacl
     }
 
 
+    /** @brief Symbolic stage of the sparse matrix-matrix product C = A * B for CSR matrices.
+    *
+    * Returns a plan holding the sparsity pattern of C and the position in C of each scalar product.
+    * Pass the plan to spgemm_numeric() to recompute C for new values of A and B with unchanged sparsity patterns.
+    * Currently only available for matrices in host memory.
+    *
+    * @param A     Left factor
+    * @param B     Right factor
+    */
+    template<typename NumericT>
+    viennacl::linalg::spgemm_plan
+    spgemm_symbolic(const viennacl::compressed_matrix<NumericT> & A,
+                    const viennacl::compressed_matrix<NumericT> & B)
+    {
+      assert( (A.size2() == B.size1()) && bool("Size check failed for sparse matrix-matrix product: size2(A) != size1(B)"));
+
+      viennacl::linalg::spgemm_plan plan;
+      switch (viennacl::traits::handle(A).get_active_handle_id())
+      {
+        case viennacl::MAIN_MEMORY:
+          viennacl::linalg::host_based::spgemm_symbolic(A, B, plan);
+          break;
+        case viennacl::MEMORY_NOT_INITIALIZED:
+          throw memory_exception("not initialised!");
+        default:
+          throw memory_exception("not implemented");
+      }
+      return plan;
+    }
+
+    /** @brief Numeric stage of the sparse matrix-matrix product C = A * B for CSR matrices.
+    *
+    * Only recomputes the values of C. If C already holds the sparsity pattern of the product, e.g. when C is the result of a previous call, only its values are written.
+    * Otherwise, no memory is allocated if C provides sufficient capacity. C must not be A or B.
+    *
+    * @param plan  Plan obtained from spgemm_symbolic() for matrices with the same sparsity patterns as A and B
+    * @param A     Left factor
+    * @param B     Right factor
+    * @param C     Result matrix
+    */
+    template<typename NumericT>
+    void spgemm_numeric(viennacl::linalg::spgemm_plan const & plan,
+                        const viennacl::compressed_matrix<NumericT> & A,
+                        const viennacl::compressed_matrix<NumericT> & B,
+                              viennacl::compressed_matrix<NumericT> & C)
+    {
+      assert( (A.size1() == plan.size1() && B.size2() == plan.size2()) && bool("Size check failed for sparse matrix-matrix product: Plan does not match factors"));
+      assert( (A.size2() == B.size1())                                  && bool("Size check failed for sparse matrix-matrix product: size2(A) != size1(B)"));
+
+      switch (viennacl::traits::handle(A).get_active_handle_id())
+      {
+        case viennacl::MAIN_MEMORY:
+          viennacl::linalg::host_based::spgemm_numeric(plan, A, B, C);
+          break;
+        case viennacl::MEMORY_NOT_INITIALIZED:
+          throw memory_exception("not initialised!");
+        default:
+          throw memory_exception("not implemented");
+      }
+    }
+
+
+    /** @brief Carries out the masked sparse matrix-matrix product C = (A * B) .* M for CSR matrices
+    *
+    * Only the sparsity pattern of the mask M is used. Entries of A * B are computed at the positions of M only, or at all other positions if complement is set.
+    * Without complement, work and memory are bounded by the number of nonzeros of M, which makes the product suitable for e.g. triangle counting with M = A.
+    * Currently only available for matrices in host memory.
+    *
+    * @param A           Left factor
+    * @param B           Right factor
+    * @param M           The mask
+    * @param C           Result matrix
+    * @param complement  If true, use the complement of the pattern of M as mask
+    */
+    template<typename NumericT, unsigned int AlignmentV>
+    void masked_prod(const viennacl::compressed_matrix<NumericT, AlignmentV> & A,
+                     const viennacl::compressed_matrix<NumericT, AlignmentV> & B,
+                     const viennacl::compressed_matrix<NumericT, AlignmentV> & M,
+                           viennacl::compressed_matrix<NumericT, AlignmentV> & C,
+                     bool complement = false)
+    {
+      assert( (A.size2() == B.size1())                          && bool("Size check failed for masked sparse matrix-matrix product: size2(A) != size1(B)"));
+      assert( (M.size1() == A.size1() && M.size2() == B.size2()) && bool("Size check failed for masked sparse matrix-matrix product: size(M) != size(A * B)"));
+
+      if (&C == &A || &C == &B || &C == &M)
+      {
+        viennacl::compressed_matrix<NumericT, AlignmentV> temp(viennacl::traits::context(A));
+        masked_prod(A, B, M, temp, complement);
+        C = temp;
+        return;
+      }
+
+      switch (viennacl::traits::handle(A).get_active_handle_id())
+      {
+        case viennacl::MAIN_MEMORY:
+          viennacl::linalg::host_based::masked_prod(A, B, M, C, complement);
+          break;
+        case viennacl::MEMORY_NOT_INITIALIZED:
+          throw memory_exception("not initialised!");
+        default:
+          throw memory_exception("not implemented");
+      }
+    }
+
+    /** @brief Returns the masked sparse matrix-matrix product (A * B) .* M for CSR matrices. See the overload with result argument for details. */
+    template<typename NumericT, unsigned int AlignmentV>
+    viennacl::compressed_matrix<NumericT, AlignmentV> masked_prod(const viennacl::compressed_matrix<NumericT, AlignmentV> & A,
+                                                                  const viennacl::compressed_matrix<NumericT, AlignmentV> & B,
+                                                                  const viennacl::compressed_matrix<NumericT, AlignmentV> & M,
+                                                                  bool complement = false)
+    {
+      viennacl::compressed_matrix<NumericT, AlignmentV> C(viennacl::traits::context(A));
+      masked_prod(A, B, M, C, complement);
+      return C;
+    }
+
+
+    /** @brief Sets up a compressed_matrix from (row, column, value) triplets given in arbitrary order, e.g. from finite element assembly. Values of duplicate entries are summed.
+    *
+    * If A is empty, its size is deduced from the largest row and column index. Otherwise, A keeps its size and all indices must be within range.
+    * The triplets are sorted in parallel in host memory, the result is transferred to the memory domain of A afterwards.
+    *
+    * @param row_indices  Row index of each triplet
+    * @param col_indices  Column index of each triplet
+    * @param values       Value of each triplet
+    * @param n            Number of triplets
+    * @param A            The matrix to be set up
+    */
+    template<typename NumericT, unsigned int AlignmentV>
+    void assemble_from_triplets(unsigned int const * row_indices, unsigned int const * col_indices, NumericT const * values, vcl_size_t n,
+                                viennacl::compressed_matrix<NumericT, AlignmentV> & A)
+    {
+      vcl_size_t size1 = A.size1();
+      vcl_size_t size2 = A.size2();
+      if (size1 == 0 || size2 == 0)
+        viennacl::linalg::host_based::detail::triplet_index_bounds(row_indices, col_indices, n, size1, size2);
+      if (size1 == 0 || size2 == 0) // no triplets, nothing to do
+        return;
+
+      viennacl::context ctx = viennacl::traits::context(A);
+      if (ctx.memory_type() == viennacl::MAIN_MEMORY)
+        viennacl::linalg::host_based::assemble_from_triplets(row_indices, col_indices, values, n, size1, size2, A);
+      else
+      {
+        viennacl::compressed_matrix<NumericT, AlignmentV> A_host(viennacl::context(viennacl::MAIN_MEMORY));
+        viennacl::linalg::host_based::assemble_from_triplets(row_indices, col_indices, values, n, size1, size2, A_host);
+        A_host.switch_memory_context(ctx);
+        A = A_host;
+      }
+    }
+
+
+    /** @brief Determines the positions of (row, column) triplets in the value array of A for subsequent value updates with value_update_numeric(). The sparsity pattern of A is not modified.
+    *
+    * Typical use is the repeated assembly of a Jacobian with fixed sparsity pattern: The symbolic stage is run once, each numeric stage then writes the summed triplet values into A without any reallocation.
+    *
+    * @param A            The matrix with fixed sparsity pattern. All triplets must refer to nonzeros of A.
+    * @param row_indices  Row index of each triplet
+    * @param col_indices  Column index of each triplet
+    * @param n            Number of triplets
+    * @return             Plan holding the positions of the triplets (in host memory)
+    */
+    template<typename NumericT, unsigned int AlignmentV>
+    viennacl::linalg::value_update_plan value_update_symbolic(viennacl::compressed_matrix<NumericT, AlignmentV> const & A,
+                                                              unsigned int const * row_indices, unsigned int const * col_indices, vcl_size_t n)
+    {
+      viennacl::linalg::value_update_plan plan;
+      if (viennacl::traits::active_handle_id(A) == viennacl::MAIN_MEMORY)
+        viennacl::linalg::host_based::value_update_symbolic(A, row_indices, col_indices, n, plan);
+      else
+      {
+        viennacl::compressed_matrix<NumericT, AlignmentV> A_host(A);
+        A_host.switch_memory_context(viennacl::context(viennacl::MAIN_MEMORY));
+        viennacl::linalg::host_based::value_update_symbolic(A_host, row_indices, col_indices, n, plan);
+      }
+      return plan;
+    }
+
+    /** @brief Overwrites the values of A with the triplet values according to a plan obtained from value_update_symbolic(). Values of duplicate triplets are summed, nonzeros without triplets are set to zero.
+    *
+    * @param plan     Plan obtained from value_update_symbolic() for A
+    * @param values   Value of each triplet (host memory)
+    * @param A        The matrix to be updated
+    */
+    template<typename NumericT, unsigned int AlignmentV>
+    void value_update_numeric(viennacl::linalg::value_update_plan const & plan,
+                              NumericT const * values,
+                              viennacl::compressed_matrix<NumericT, AlignmentV> & A)
+    {
+      assert(plan.size1() == A.size1() && plan.size2() == A.size2() && bool("Error in value_update_numeric(): Plan does not match matrix size!"));
+      if (plan.nnz() == 0)
+        return;
+
+      if (viennacl::traits::active_handle_id(A) == viennacl::MAIN_MEMORY)
+        viennacl::linalg::host_based::value_update_numeric(plan, values, A);
+      else
+      {
+        std::vector<NumericT> new_values(plan.nnz());
+        viennacl::linalg::host_based::detail::value_update_sum(plan, values, &(new_values[0]));
+        A.set_values(&(new_values[0]));
+      }
+    }
+
+
+    // C = alpha * A + beta * B with both A and B sparse
+
+    namespace detail
+    {
+      /** @brief Dispatches the symbolic stage of a sparse matrix sum. Currently only available in host memory. */
+      template<typename SparseMatrixT>
+      void spgeam_symbolic(SparseMatrixT const & A, SparseMatrixT const & B, viennacl::linalg::spgeam_plan & plan)
+      {
+        assert( (A.size1() == B.size1() && A.size2() == B.size2()) && bool("Size check failed for sparse matrix sum: size(A) != size(B)"));
+
+        switch (viennacl::traits::handle(A).get_active_handle_id())
+        {
+          case viennacl::MAIN_MEMORY:
+            viennacl::linalg::host_based::spgeam_symbolic(A, B, plan);
+            break;
+          case viennacl::MEMORY_NOT_INITIALIZED:
+            throw memory_exception("not initialised!");
+          default:
+            throw memory_exception("not implemented");
+        }
+      }
+
+      /** @brief Dispatches the numeric stage of a sparse matrix sum. Currently only available in host memory. */
+      template<typename SparseMatrixT, typename NumericT>
+      void spgeam_numeric(viennacl::linalg::spgeam_plan const & plan,
+                          SparseMatrixT const & A, NumericT alpha,
+                          SparseMatrixT const & B, NumericT beta,
+                          SparseMatrixT & C)
+      {
+        assert( (A.size1() == plan.size1() && A.size2() == plan.size2()) && bool("Size check failed for sparse matrix sum: Plan does not match summands"));
+        assert( (A.size1() == B.size1() && A.size2() == B.size2())       && bool("Size check failed for sparse matrix sum: size(A) != size(B)"));
+
+        switch (viennacl::traits::handle(A).get_active_handle_id())
+        {
+          case viennacl::MAIN_MEMORY:
+            viennacl::linalg::host_based::spgeam_numeric(plan, A, alpha, B, beta, C);
+            break;
+          case viennacl::MEMORY_NOT_INITIALIZED:
+            throw memory_exception("not initialised!");
+          default:
+            throw memory_exception("not implemented");
+        }
+      }
+    }
+
+    /** @brief Symbolic stage of the sparse matrix sum C = alpha * A + beta * B for CSR matrices.
+    *
+    * Returns a plan holding the sparsity pattern of C. Pass the plan to spgeam_numeric() to recompute C for new values of A and B with unchanged sparsity patterns.
+    * Identical sparsity patterns of A and B are detected and result in a plain update of the nonzero values in the numeric stage.
+    * The column indices in each row of A and B are required to be sorted. Currently only available for matrices in host memory.
+    *
+    * @param A     First summand
+    * @param B     Second summand
+    */
+    template<typename NumericT, unsigned int AlignmentV>
+    viennacl::linalg::spgeam_plan
+    spgeam_symbolic(const viennacl::compressed_matrix<NumericT, AlignmentV> & A,
+                    const viennacl::compressed_matrix<NumericT, AlignmentV> & B)
+    {
+      viennacl::linalg::spgeam_plan plan;
+      detail::spgeam_symbolic(A, B, plan);
+      return plan;
+    }
+
+    /** @brief Numeric stage of the sparse matrix sum C = alpha * A + beta * B for CSR matrices.
+    *
+    * Only recomputes the values of C. If C already holds the sparsity pattern of the sum, e.g. when C is the result of a previous call, only its values are written.
+    * C may be one of the summands, in which case it is updated in place if its pattern is the pattern of the sum (e.g. A + sigma * I for A with a full diagonal).
+    *
+    * @param plan   Plan obtained from spgeam_symbolic() for matrices with the same sparsity patterns as A and B
+    * @param A      First summand
+    * @param alpha  Scaling factor for A
+    * @param B      Second summand
+    * @param beta   Scaling factor for B
+    * @param C      Result matrix
+    */
+    template<typename NumericT, unsigned int AlignmentV>
+    void spgeam_numeric(viennacl::linalg::spgeam_plan const & plan,
+                        const viennacl::compressed_matrix<NumericT, AlignmentV> & A, NumericT alpha,
+                        const viennacl::compressed_matrix<NumericT, AlignmentV> & B, NumericT beta,
+                              viennacl::compressed_matrix<NumericT, AlignmentV> & C)
+    {
+      detail::spgeam_numeric(plan, A, alpha, B, beta, C);
+    }
+
+    /** @brief Computes the sparse matrix sum C = alpha * A + beta * B for CSR matrices.
+    *
+    * Typical uses are shifts A - sigma * I and linear combinations of mass and stiffness matrices.
+    * If the sum is computed repeatedly for the same sparsity patterns, use spgeam_symbolic() once and spgeam_numeric() for each update instead.
+    *
+    * @param A      First summand
+    * @param alpha  Scaling factor for A
+    * @param B      Second summand
+    * @param beta   Scaling factor for B
+    * @param C      Result matrix
+    */
+    template<typename NumericT, unsigned int AlignmentV>
+    void spgeam(const viennacl::compressed_matrix<NumericT, AlignmentV> & A, NumericT alpha,
+                const viennacl::compressed_matrix<NumericT, AlignmentV> & B, NumericT beta,
+                      viennacl::compressed_matrix<NumericT, AlignmentV> & C)
+    {
+      spgeam_numeric(spgeam_symbolic(A, B), A, alpha, B, beta, C);
+    }
+
+    /** @brief Symbolic stage of the sparse matrix sum C = alpha * A + beta * B for coordinate matrices. See the overload for compressed_matrix for details.
+    *
+    * The entries of A and B may be stored in any order, but must not contain duplicates. Only available for matrices in host memory.
+    *
+    * @param A     First summand
+    * @param B     Second summand
+    */
+    template<typename NumericT, unsigned int AlignmentV>
+    viennacl::linalg::spgeam_plan
+    spgeam_symbolic(const viennacl::coordinate_matrix<NumericT, AlignmentV> & A,
+                    const viennacl::coordinate_matrix<NumericT, AlignmentV> & B)
+    {
+      viennacl::linalg::spgeam_plan plan;
+      detail::spgeam_symbolic(A, B, plan);
+      return plan;
+    }
+
+    /** @brief Numeric stage of the sparse matrix sum C = alpha * A + beta * B for coordinate matrices. C must not be A or B.
+    *
+    * @param plan   Plan obtained from spgeam_symbolic() for matrices with the same sparsity patterns as A and B
+    * @param A      First summand
+    * @param alpha  Scaling factor for A
+    * @param B      Second summand
+    * @param beta   Scaling factor for B
+    * @param C      Result matrix
+    */
+    template<typename NumericT, unsigned int AlignmentV>
+    void spgeam_numeric(viennacl::linalg::spgeam_plan const & plan,
+                        const viennacl::coordinate_matrix<NumericT, AlignmentV> & A, NumericT alpha,
+                        const viennacl::coordinate_matrix<NumericT, AlignmentV> & B, NumericT beta,
+                              viennacl::coordinate_matrix<NumericT, AlignmentV> & C)
+    {
+      assert( (&C != &A && &C != &B) && bool("Result of sparse matrix sum must not be one of the summands"));
+      detail::spgeam_numeric(plan, A, alpha, B, beta, C);
+    }
+
+    /** @brief Computes the sparse matrix sum C = alpha * A + beta * B for coordinate matrices. C must not be A or B.
+    *
+    * @param A      First summand
+    * @param alpha  Scaling factor for A
+    * @param B      Second summand
+    * @param beta   Scaling factor for B
+    * @param C      Result matrix
+    */
+    template<typename NumericT, unsigned int AlignmentV>
+    void spgeam(const viennacl::coordinate_matrix<NumericT, AlignmentV> & A, NumericT alpha,
+                const viennacl::coordinate_matrix<NumericT, AlignmentV> & B, NumericT beta,
+                      viennacl::coordinate_matrix<NumericT, AlignmentV> & C)
+    {
+      spgeam_numeric(spgeam_symbolic(A, B), A, alpha, B, beta, C);
+    }
+
+
+    /** @brief Computes B = trans(A) for a compressed_matrix.
+    *
+    * The transposition is carried out in host memory. Matrices in OpenCL or CUDA memory are transferred to the host and back.
+    *
+    * @param A   The matrix to be transposed
+    * @param B   The result matrix (resized as needed)
+    */
+    template<typename NumericT, unsigned int AlignmentV>
+    void transpose(const viennacl::compressed_matrix<NumericT, AlignmentV> & A,
+                         viennacl::compressed_matrix<NumericT, AlignmentV> & B)
+    {
+      if (&A == &B)
+      {
+        viennacl::compressed_matrix<NumericT, AlignmentV> temp(A);
+        transpose(temp, B);
+        return;
+      }
+
+      switch (viennacl::traits::handle(A).get_active_handle_id())
+      {
+        case viennacl::MAIN_MEMORY:
+          viennacl::linalg::host_based::transpose(A, B);
+          break;
+#ifdef VIENNACL_WITH_OPENCL
+        case viennacl::OPENCL_MEMORY:
+#endif
+#ifdef VIENNACL_WITH_CUDA
+        case viennacl::CUDA_MEMORY:
+#endif
+#if defined(VIENNACL_WITH_OPENCL) || defined(VIENNACL_WITH_CUDA)
+        {
+          viennacl::context orig_ctx = viennacl::traits::context(A);
+          viennacl::context cpu_ctx(viennacl::MAIN_MEMORY);
+          viennacl::compressed_matrix<NumericT, AlignmentV> A_host(A);
+          A_host.switch_memory_context(cpu_ctx);
+          viennacl::linalg::host_based::transpose(A_host, B);
+          B.switch_memory_context(orig_ctx);
+          break;
+        }
+#endif
+        case viennacl::MEMORY_NOT_INITIALIZED:
+          throw memory_exception("not initialised!");
+        default:
+          throw memory_exception("not implemented");
+      }
+    }
+
+    /** @brief Returns trans(A) for a compressed_matrix. The result is located in the same memory domain as A. */
+    template<typename NumericT, unsigned int AlignmentV>
+    viennacl::compressed_matrix<NumericT, AlignmentV> transpose(const viennacl::compressed_matrix<NumericT, AlignmentV> & A)
+    {
+      viennacl::compressed_matrix<NumericT, AlignmentV> B(viennacl::traits::context(A));
+      transpose(A, B);
+      return B;
+    }
+
+    namespace detail
+    {
+      /** @brief Dispatches the transposition of sparse matrix types available for host memory only. */
+      template<typename SparseMatrixT>
+      void host_only_transpose(SparseMatrixT const & A, SparseMatrixT & B)
+      {
+        assert( (&A != &B) && bool("In-place transposition not supported for this sparse matrix type"));
+
+        switch (viennacl::traits::handle(A).get_active_handle_id())
+        {
+          case viennacl::MAIN_MEMORY:
+            viennacl::linalg::host_based::transpose(A, B);
+            break;
+          case viennacl::MEMORY_NOT_INITIALIZED:
+            throw memory_exception("not initialised!");
+          default:
+            throw memory_exception("not implemented");
+        }
+      }
+    }
+
+    /** @brief Computes B = trans(A) for a coordinate_matrix (host memory only). B must be empty or of size size2(A) times size1(A). */
+    template<typename NumericT, unsigned int AlignmentV>
+    void transpose(const viennacl::coordinate_matrix<NumericT, AlignmentV> & A,
+                         viennacl::coordinate_matrix<NumericT, AlignmentV> & B)
+    {
+      detail::host_only_transpose(A, B);
+    }
+
+    /** @brief Computes B = trans(A) for an ell_matrix (host memory only). B must be empty or of size size2(A) times size1(A). */
+    template<typename NumericT, unsigned int AlignmentV>
+    void transpose(const viennacl::ell_matrix<NumericT, AlignmentV> & A,
+                         viennacl::ell_matrix<NumericT, AlignmentV> & B)
+    {
+      detail::host_only_transpose(A, B);
+    }
+
+    /** @brief Computes B = trans(A) for a sliced_ell_matrix (host memory only). B must be empty or of size size2(A) times size1(A). */
+    template<typename NumericT, typename IndexT>
+    void transpose(const viennacl::sliced_ell_matrix<NumericT, IndexT> & A,
+                         viennacl::sliced_ell_matrix<NumericT, IndexT> & B)
+    {
+      detail::host_only_transpose(A, B);
+    }
+
+    /** @brief Computes B = trans(A) for a hyb_matrix (host memory only). B must be empty or of size size2(A) times size1(A). */
+    template<typename NumericT, unsigned int AlignmentV>
+    void transpose(const viennacl::hyb_matrix<NumericT, AlignmentV> & A,
+                         viennacl::hyb_matrix<NumericT, AlignmentV> & B)
+    {
+      detail::host_only_transpose(A, B);
+    }
+
+
+    // trans(A) * x and trans(A) * B
+
+    /** @brief Carries out matrix-vector multiplication with the transpose of a compressed_matrix
+    *
+    * Implementation of the convenience expression result = prod(trans(mat), vec);
+    * In host memory the transpose is not formed. For OpenCL and CUDA, the transpose is computed explicitly.
+    *
+    * @param mat    The transposed matrix
+    * @param vec    The vector
+    * @param alpha  Scaling factor for the product
+    * @param result The result vector
+    * @param beta   Scaling factor for the previous result
+    */
+    template<typename NumericT, unsigned int AlignmentV>
+    void prod_impl(const viennacl::matrix_expression<const viennacl::compressed_matrix<NumericT, AlignmentV>,
+                                                     const viennacl::compressed_matrix<NumericT, AlignmentV>,
+                                                     viennacl::op_trans> & mat,
+                   const viennacl::vector_base<NumericT> & vec,
+                   NumericT alpha,
+                         viennacl::vector_base<NumericT> & result,
+                   NumericT beta)
+    {
+      assert( (mat.size1() == result.size()) && bool("Size check failed for transposed compressed matrix-vector product: size1(trans(mat)) != size(result)"));
+      assert( (mat.size2() == vec.size())    && bool("Size check failed for transposed compressed matrix-vector product: size2(trans(mat)) != size(x)"));
+
+      switch (viennacl::traits::handle(mat.lhs()).get_active_handle_id())
+      {
+        case viennacl::MAIN_MEMORY:
+          viennacl::linalg::host_based::prod_impl(mat, vec, alpha, result, beta);
+          break;
+#ifdef VIENNACL_WITH_OPENCL
+        case viennacl::OPENCL_MEMORY:
+#endif
+#ifdef VIENNACL_WITH_CUDA
+        case viennacl::CUDA_MEMORY:
+#endif
+#if defined(VIENNACL_WITH_OPENCL) || defined(VIENNACL_WITH_CUDA)
+        {
+          viennacl::compressed_matrix<NumericT, AlignmentV> A_trans = viennacl::linalg::transpose(mat.lhs());
+          viennacl::linalg::prod_impl(A_trans, vec, alpha, result, beta);
+          break;
+        }
+#endif
+        case viennacl::MEMORY_NOT_INITIALIZED:
+          throw memory_exception("not initialised!");
+        default:
+          throw memory_exception("not implemented");
+      }
+    }
+
+    /** @brief Carries out matrix-matrix multiplication with the transpose of a compressed_matrix and a dense matrix
+    *
+    * Implementation of the convenience expression result = prod(trans(sp_mat), d_mat);
+    * In host memory the transpose is not formed. For OpenCL and CUDA, the transpose is computed explicitly.
+    *
+    * @param sp_mat   The transposed sparse matrix
+    * @param d_mat    The dense matrix
+    * @param result   The result matrix (dense)
+    */
+    template<typename NumericT, unsigned int AlignmentV>
+    void prod_impl(const viennacl::matrix_expression<const viennacl::compressed_matrix<NumericT, AlignmentV>,
+                                                     const viennacl::compressed_matrix<NumericT, AlignmentV>,
+                                                     viennacl::op_trans> & sp_mat,
+                   const viennacl::matrix_base<NumericT> & d_mat,
+                         viennacl::matrix_base<NumericT> & result)
+    {
+      assert( (sp_mat.size1() == result.size1()) && bool("Size check failed for transposed compressed matrix - dense matrix product: size1(trans(sp_mat)) != size1(result)"));
+      assert( (sp_mat.size2() == d_mat.size1())  && bool("Size check failed for transposed compressed matrix - dense matrix product: size2(trans(sp_mat)) != size1(d_mat)"));
+
+      switch (viennacl::traits::handle(sp_mat.lhs()).get_active_handle_id())
+      {
+        case viennacl::MAIN_MEMORY:
+          viennacl::linalg::host_based::prod_impl(sp_mat, d_mat, result);
+          break;
+#ifdef VIENNACL_WITH_OPENCL
+        case viennacl::OPENCL_MEMORY:
+#endif
+#ifdef VIENNACL_WITH_CUDA
+        case viennacl::CUDA_MEMORY:
+#endif
+#if defined(VIENNACL_WITH_OPENCL) || defined(VIENNACL_WITH_CUDA)
+        {
+          viennacl::compressed_matrix<NumericT, AlignmentV> A_trans = viennacl::linalg::transpose(sp_mat.lhs());
+          viennacl::linalg::prod_impl(A_trans, d_mat, result);
+          break;
+        }
+#endif
+        case viennacl::MEMORY_NOT_INITIALIZED:
+          throw memory_exception("not initialised!");
+        default:
+          throw memory_exception("not implemented");
+      }
+    }
+
+
     /** @brief Carries out triangular inplace solves
     *
     * @param mat    The matrix
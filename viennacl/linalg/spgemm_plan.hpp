@@ -0,0 +1,275 @@
+#ifndef VIENNACL_LINALG_SPGEMM_PLAN_HPP_
+#define VIENNACL_LINALG_SPGEMM_PLAN_HPP_
+
+/* =========================================================================
+   Copyright (c) 2010-2016, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+   Portions of this software are copyright by UChicago Argonne, LLC.
+
+                            -----------------
+                  ViennaCL - The Vienna Computing Library
+                            -----------------
+
+   Project Head:    Karl Rupp                   rupp@iue.tuwien.ac.at
+
+   (A list of authors and contributors can be found in the manual)
+
+   License:         MIT (X11), see file LICENSE in the base directory
+============================================================================= */
+
+/** @file viennacl/linalg/spgemm_plan.hpp
+    @brief Holds the results of the symbolic stages of sparse matrix-matrix products (A * B and Galerkin products R * A * P) of sparse matrix sums (alpha * A + beta * B), and of value updates from triplets for reuse in subsequent numeric stages.
+*/
+
+#include <vector>
+#include "viennacl/forwards.h"
+
+namespace viennacl
+{
+namespace linalg
+{
+
+/** @brief Sparsity pattern of C = A * B together with the position in C of each product A(i,k) * B(k,j).
+*
+* Obtained from spgemm_symbolic() and consumed by spgemm_numeric(). The plan remains valid as long as the sparsity patterns of A and B do not change.
+* Memory requirements are one index per scalar product A(i,k) * B(k,j), i.e. proportional to the number of floating point operations of the product.
+* Plans are currently only available for matrices in host memory.
+*/
+class spgemm_plan
+{
+public:
+  spgemm_plan() : size1_(0), size2_(0), A_nnz_(0), B_nnz_(0) {}
+
+  /** @brief Number of rows of the product */
+  vcl_size_t size1() const { return size1_; }
+  /** @brief Number of columns of the product */
+  vcl_size_t size2() const { return size2_; }
+  /** @brief Number of nonzeros of the product */
+  vcl_size_t nnz() const { return C_col_buffer_.size(); }
+  /** @brief Number of scalar products A(i,k) * B(k,j) accumulated in the numeric stage */
+  vcl_size_t num_products() const { return product_targets_.size(); }
+
+  /** @brief Number of nonzeros of the left factor for which the plan has been set up */
+  vcl_size_t A_nnz() const { return A_nnz_; }
+  /** @brief Number of nonzeros of the right factor for which the plan has been set up */
+  vcl_size_t B_nnz() const { return B_nnz_; }
+
+  /** @brief Returns true if the plan has not been set up */
+  bool empty() const { return C_row_buffer_.size() == 0; }
+
+  /** @brief Row array of the CSR pattern of the product (size1() + 1 entries) */
+  std::vector<unsigned int>       & C_row_buffer()       { return C_row_buffer_; }
+  std::vector<unsigned int> const & C_row_buffer() const { return C_row_buffer_; }
+
+  /** @brief Column array of the CSR pattern of the product (nnz() entries) */
+  std::vector<unsigned int>       & C_col_buffer()       { return C_col_buffer_; }
+  std::vector<unsigned int> const & C_col_buffer() const { return C_col_buffer_; }
+
+  /** @brief Offsets of the products of each row of C in product_targets() (size1() + 1 entries) */
+  std::vector<vcl_size_t>       & product_offsets()       { return product_offsets_; }
+  std::vector<vcl_size_t> const & product_offsets() const { return product_offsets_; }
+
+  /** @brief Index into the value array of C for each product, ordered by row of A, entry in row of A, entry in row of B */
+  std::vector<unsigned int>       & product_targets()       { return product_targets_; }
+  std::vector<unsigned int> const & product_targets() const { return product_targets_; }
+
+  /** @brief Sets the sizes of the product and the number of nonzeros of the factors */
+  void set_sizes(vcl_size_t new_size1, vcl_size_t new_size2, vcl_size_t new_A_nnz, vcl_size_t new_B_nnz)
+  {
+    size1_ = new_size1;
+    size2_ = new_size2;
+    A_nnz_ = new_A_nnz;
+    B_nnz_ = new_B_nnz;
+  }
+
+private:
+  vcl_size_t size1_;
+  vcl_size_t size2_;
+  vcl_size_t A_nnz_;
+  vcl_size_t B_nnz_;
+  std::vector<unsigned int> C_row_buffer_;
+  std::vector<unsigned int> C_col_buffer_;
+  std::vector<vcl_size_t>   product_offsets_;
+  std::vector<unsigned int> product_targets_;
+};
+
+/** @brief Sparsity pattern of the Galerkin product R * A * P as computed in the setup of algebraic multigrid.
+*
+* Obtained from galerkin_product_symbolic() and consumed by galerkin_product_numeric(). Only the pattern of the result and a bound for the row lengths of R * A are stored,
+* hence memory requirements are the same as for the result. The plan remains valid as long as the sparsity patterns of R, A, and P do not change.
+*/
+class galerkin_plan
+{
+public:
+  galerkin_plan() : size1_(0), size2_(0), R_nnz_(0), A_nnz_(0), P_nnz_(0), max_row_RA_length_(0) {}
+
+  /** @brief Number of rows of the product */
+  vcl_size_t size1() const { return size1_; }
+  /** @brief Number of columns of the product */
+  vcl_size_t size2() const { return size2_; }
+  /** @brief Number of nonzeros of the product */
+  vcl_size_t nnz() const { return C_col_buffer_.size(); }
+
+  /** @brief Number of nonzeros of the restriction operator for which the plan has been set up */
+  vcl_size_t R_nnz() const { return R_nnz_; }
+  /** @brief Number of nonzeros of the fine grid operator for which the plan has been set up */
+  vcl_size_t A_nnz() const { return A_nnz_; }
+  /** @brief Number of nonzeros of the prolongation operator for which the plan has been set up */
+  vcl_size_t P_nnz() const { return P_nnz_; }
+
+  /** @brief Returns true if the plan has not been set up */
+  bool empty() const { return C_row_buffer_.size() == 0; }
+
+  /** @brief Row array of the CSR pattern of the product (size1() + 1 entries) */
+  std::vector<unsigned int>       & C_row_buffer()       { return C_row_buffer_; }
+  std::vector<unsigned int> const & C_row_buffer() const { return C_row_buffer_; }
+
+  /** @brief Column array of the CSR pattern of the product (nnz() entries, sorted within each row) */
+  std::vector<unsigned int>       & C_col_buffer()       { return C_col_buffer_; }
+  std::vector<unsigned int> const & C_col_buffer() const { return C_col_buffer_; }
+
+  /** @brief Upper bound for the number of nonzeros in a row of R * A, which determines the size of the row accumulators in the numeric stage */
+  vcl_size_t max_row_RA_length() const { return max_row_RA_length_; }
+  /** @brief Sets the upper bound for the number of nonzeros in a row of R * A */
+  void max_row_RA_length(vcl_size_t length) { max_row_RA_length_ = length; }
+
+  /** @brief Sets the sizes of the product and the number of nonzeros of the factors */
+  void set_sizes(vcl_size_t new_size1, vcl_size_t new_size2, vcl_size_t new_R_nnz, vcl_size_t new_A_nnz, vcl_size_t new_P_nnz)
+  {
+    size1_ = new_size1;
+    size2_ = new_size2;
+    R_nnz_ = new_R_nnz;
+    A_nnz_ = new_A_nnz;
+    P_nnz_ = new_P_nnz;
+  }
+
+private:
+  vcl_size_t size1_;
+  vcl_size_t size2_;
+  vcl_size_t R_nnz_;
+  vcl_size_t A_nnz_;
+  vcl_size_t P_nnz_;
+  vcl_size_t max_row_RA_length_;
+  std::vector<unsigned int> C_row_buffer_;
+  std::vector<unsigned int> C_col_buffer_;
+};
+
+/** @brief Sparsity pattern of the sum C = alpha * A + beta * B of two sparse matrices.
+*
+* Obtained from spgeam_symbolic() and consumed by spgeam_numeric(). The pattern of the result is stored, for coordinate matrices also the position in the result of each entry of A and B.
+* If A and B share the same sparsity pattern, this is detected in the symbolic stage and the numeric stage reduces to a vector update of the nonzero values.
+* The plan remains valid as long as the sparsity patterns of A and B do not change.
+*/
+class spgeam_plan
+{
+public:
+  spgeam_plan() : size1_(0), size2_(0), A_nnz_(0), B_nnz_(0), patterns_equal_(false) {}
+
+  /** @brief Number of rows of the sum */
+  vcl_size_t size1() const { return size1_; }
+  /** @brief Number of columns of the sum */
+  vcl_size_t size2() const { return size2_; }
+  /** @brief Number of nonzeros of the sum */
+  vcl_size_t nnz() const { return C_col_buffer_.size(); }
+
+  /** @brief Number of nonzeros of the first summand for which the plan has been set up */
+  vcl_size_t A_nnz() const { return A_nnz_; }
+  /** @brief Number of nonzeros of the second summand for which the plan has been set up */
+  vcl_size_t B_nnz() const { return B_nnz_; }
+
+  /** @brief Returns true if the plan has not been set up */
+  bool empty() const { return C_row_buffer_.size() == 0; }
+
+  /** @brief Returns true if both summands have identical sparsity patterns, in which case the pattern of the sum is the pattern of the summands */
+  bool patterns_equal() const { return patterns_equal_; }
+  /** @brief Sets whether both summands have identical sparsity patterns */
+  void patterns_equal(bool b) { patterns_equal_ = b; }
+
+  /** @brief Row array of the CSR pattern of the sum (size1() + 1 entries) */
+  std::vector<unsigned int>       & C_row_buffer()       { return C_row_buffer_; }
+  std::vector<unsigned int> const & C_row_buffer() const { return C_row_buffer_; }
+
+  /** @brief Column array of the CSR pattern of the sum (nnz() entries, sorted within each row) */
+  std::vector<unsigned int>       & C_col_buffer()       { return C_col_buffer_; }
+  std::vector<unsigned int> const & C_col_buffer() const { return C_col_buffer_; }
+
+  /** @brief Index into the value array of the sum for each entry of the first summand in the order of storage. Only set up for coordinate matrices. */
+  std::vector<unsigned int>       & A_targets()       { return A_targets_; }
+  std::vector<unsigned int> const & A_targets() const { return A_targets_; }
+
+  /** @brief Index into the value array of the sum for each entry of the second summand in the order of storage. Only set up for coordinate matrices. */
+  std::vector<unsigned int>       & B_targets()       { return B_targets_; }
+  std::vector<unsigned int> const & B_targets() const { return B_targets_; }
+
+  /** @brief Sets the sizes of the sum and the number of nonzeros of the summands */
+  void set_sizes(vcl_size_t new_size1, vcl_size_t new_size2, vcl_size_t new_A_nnz, vcl_size_t new_B_nnz)
+  {
+    size1_ = new_size1;
+    size2_ = new_size2;
+    A_nnz_ = new_A_nnz;
+    B_nnz_ = new_B_nnz;
+  }
+
+private:
+  vcl_size_t size1_;
+  vcl_size_t size2_;
+  vcl_size_t A_nnz_;
+  vcl_size_t B_nnz_;
+  bool       patterns_equal_;
+  std::vector<unsigned int> C_row_buffer_;
+  std::vector<unsigned int> C_col_buffer_;
+  std::vector<unsigned int> A_targets_;
+  std::vector<unsigned int> B_targets_;
+};
+
+/** @brief Positions of (row, column, value) triplets in the value array of a compressed_matrix with fixed sparsity pattern.
+*
+* Obtained from value_update_symbolic() and consumed by value_update_numeric(). The triplets are grouped by their target position,
+* so the numeric stage sums duplicate entries without atomics and writes each value of the matrix exactly once.
+* The plan remains valid as long as the sparsity pattern of the matrix and the row and column indices of the triplets do not change.
+*/
+class value_update_plan
+{
+public:
+  value_update_plan() : size1_(0), size2_(0) {}
+
+  /** @brief Number of rows of the matrix */
+  vcl_size_t size1() const { return size1_; }
+  /** @brief Number of columns of the matrix */
+  vcl_size_t size2() const { return size2_; }
+  /** @brief Number of nonzeros of the matrix */
+  vcl_size_t nnz() const { return offsets_.size() > 0 ? offsets_.size() - 1 : 0; }
+  /** @brief Number of triplets for which the plan has been set up */
+  vcl_size_t num_triplets() const { return triplet_indices_.size(); }
+
+  /** @brief Returns true if the plan has not been set up */
+  bool empty() const { return offsets_.size() == 0; }
+
+  /** @brief Offsets of the triplets contributing to each nonzero of the matrix in triplet_indices() (nnz() + 1 entries) */
+  std::vector<unsigned int>       & offsets()       { return offsets_; }
+  std::vector<unsigned int> const & offsets() const { return offsets_; }
+
+  /** @brief Triplet indices, grouped by the position of the triplet in the value array of the matrix */
+  std::vector<unsigned int>       & triplet_indices()       { return triplet_indices_; }
+  std::vector<unsigned int> const & triplet_indices() const { return triplet_indices_; }
+
+  /** @brief Sets the size of the matrix */
+  void set_sizes(vcl_size_t new_size1, vcl_size_t new_size2)
+  {
+    size1_ = new_size1;
+    size2_ = new_size2;
+  }
+
+private:
+  vcl_size_t size1_;
+  vcl_size_t size2_;
+  std::vector<unsigned int> offsets_;
+  std::vector<unsigned int> triplet_indices_;
+};
+
+} //namespace linalg
+} //namespace viennacl
+
+
+#endif
@@ -358,6 +358,24 @@ struct is_any_sparse_matrix<viennacl::compressed_compressed_matrix<ScalarType> >
   enum { value = true };
 };
 
+template<typename ScalarType>
+struct is_any_sparse_matrix<viennacl::delta_compressed_matrix<ScalarType> >
+{
+  enum { value = true };
+};
+
+template<typename ScalarType, typename StorageType>
+struct is_any_sparse_matrix<viennacl::mixed_compressed_matrix<ScalarType, StorageType> >
+{
+  enum { value = true };
+};
+
+template<typename ScalarType, typename StorageType>
+struct is_any_sparse_matrix<viennacl::mixed_ell_matrix<ScalarType, StorageType> >
+{
+  enum { value = true };
+};
+
 template<typename ScalarType, unsigned int AlignmentV>
 struct is_any_sparse_matrix<viennacl::coordinate_matrix<ScalarType, AlignmentV> >
 {
@@ -382,6 +400,12 @@ struct is_any_sparse_matrix<viennacl::hyb_matrix<ScalarType, AlignmentV> >
   enum { value = true };
 };
 
+template<typename ScalarType>
+struct is_any_sparse_matrix<viennacl::sparse_operator<ScalarType> >
+{
+  enum { value = true };
+};
+
 template<typename T>
 struct is_any_sparse_matrix<const T>
 {
@@ -432,6 +432,24 @@ struct cpu_value_type<viennacl::compressed_compressed_matrix<T> >
   typedef typename cpu_value_type<T>::type    type;
 };
 
+template<typename T>
+struct cpu_value_type<viennacl::delta_compressed_matrix<T> >
+{
+  typedef typename cpu_value_type<T>::type    type;
+};
+
+template<typename T, typename S>
+struct cpu_value_type<viennacl::mixed_compressed_matrix<T, S> >
+{
+  typedef typename cpu_value_type<T>::type    type;
+};
+
+template<typename T, typename S>
+struct cpu_value_type<viennacl::mixed_ell_matrix<T, S> >
+{
+  typedef typename cpu_value_type<T>::type    type;
+};
+
 template<typename T, unsigned int AlignmentV>
 struct cpu_value_type<viennacl::coordinate_matrix<T, AlignmentV> >
 {
@@ -456,6 +474,12 @@ struct cpu_value_type<viennacl::hyb_matrix<T, AlignmentV> >
   typedef typename cpu_value_type<T>::type    type;
 };
 
+template<typename T>
+struct cpu_value_type<viennacl::sparse_operator<T> >
+{
+  typedef typename cpu_value_type<T>::type    type;
+};
+
 template<typename T, unsigned int AlignmentV>
 struct cpu_value_type<viennacl::circulant_matrix<T, AlignmentV> >
 {
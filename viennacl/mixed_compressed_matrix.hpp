@@ -0,0 +1,256 @@
+#ifndef VIENNACL_MIXED_COMPRESSED_MATRIX_HPP_
+#define VIENNACL_MIXED_COMPRESSED_MATRIX_HPP_
+
+/* =========================================================================
+   Copyright (c) 2010-2016, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+   Portions of this software are copyright by UChicago Argonne, LLC.
+
+                            -----------------
+                  ViennaCL - The Vienna Computing Library
+                            -----------------
+
+   Project Head:    Karl Rupp                   rupp@iue.tuwien.ac.at
+
+   (A list of authors and contributors can be found in the manual)
+
+   License:         MIT (X11), see file LICENSE in the base directory
+============================================================================= */
+
+/** @file viennacl/mixed_compressed_matrix.hpp
+    @brief Implementation of the mixed_compressed_matrix class (CSR format with values stored in reduced precision, host memory only)
+*/
+
+#include <vector>
+#include "viennacl/forwards.h"
+#include "viennacl/vector.hpp"
+#include "viennacl/compressed_matrix.hpp"
+
+#include "viennacl/linalg/sparse_matrix_operations.hpp"
+
+#include "viennacl/tools/tools.hpp"
+
+#ifdef VIENNACL_WITH_OPENMP
+#include <omp.h>
+#endif
+
+namespace viennacl
+{
+
+/** @brief A sparse matrix in compressed sparse row format with nonzero values stored in a type different from the type used for computations.
+*
+* Typical use is NumericT = double with StorageT = float: Values are stored in single precision, which reduces the memory traffic of sparse matrix-vector products
+* by about one third, while all products are accumulated in double precision. This is useful for operators which only need to be applied approximately,
+* e.g. within preconditioners or on the coarse levels of a multigrid hierarchy.
+*
+* The format is available for host memory (MAIN_MEMORY) only.
+*
+* @tparam NumericT    Floating point type used for computations (and for the vectors the matrix is applied to)
+* @tparam StorageT    Floating point type used for storing the nonzero values
+*/
+template<class NumericT, class StorageT /* see forwards.h for default argument */>
+class mixed_compressed_matrix
+{
+public:
+  typedef viennacl::backend::mem_handle                                                              handle_type;
+  typedef scalar<typename viennacl::tools::CHECK_SCALAR_TEMPLATE_ARGUMENT<NumericT>::ResultType>   value_type;
+  typedef StorageT                                                                                   storage_type;
+  typedef vcl_size_t                                                                                 size_type;
+
+  /** @brief Default construction of a mixed-precision compressed matrix. No memory is allocated */
+  mixed_compressed_matrix() : rows_(0), cols_(0), nonzeros_(0) {}
+
+  /** @brief Converts a compressed_matrix to reduced-precision storage. If the compressed_matrix is not located in host memory, a temporary copy is migrated to the host. */
+  template<unsigned int AlignmentV>
+  explicit mixed_compressed_matrix(compressed_matrix<NumericT, AlignmentV> const & A) : rows_(0), cols_(0), nonzeros_(0)
+  {
+    assign(A);
+  }
+
+  /** @brief Converts a compressed_matrix to reduced-precision storage. */
+  template<unsigned int AlignmentV>
+  mixed_compressed_matrix & operator=(compressed_matrix<NumericT, AlignmentV> const & A)
+  {
+    assign(A);
+    return *this;
+  }
+
+  /** @brief Converts a compressed_matrix to reduced-precision storage. The sparsity pattern is taken over unchanged. */
+  template<unsigned int AlignmentV>
+  void assign(compressed_matrix<NumericT, AlignmentV> const & A)
+  {
+    if (A.memory_context() != viennacl::MAIN_MEMORY)
+    {
+      compressed_matrix<NumericT, AlignmentV> A_host(A);
+      A_host.switch_memory_context(viennacl::context(viennacl::MAIN_MEMORY));
+      assign(A_host);
+      return;
+    }
+
+    viennacl::context host_ctx(viennacl::MAIN_MEMORY);
+    row_buffer_.switch_active_handle_id(viennacl::MAIN_MEMORY);
+    col_buffer_.switch_active_handle_id(viennacl::MAIN_MEMORY);
+    elements_.switch_active_handle_id(viennacl::MAIN_MEMORY);
+
+    rows_ = A.size1();
+    cols_ = A.size2();
+
+    unsigned int const * A_row_buffer = reinterpret_cast<unsigned int const *>(A.handle1().ram_handle().get());
+    unsigned int const * A_col_buffer = reinterpret_cast<unsigned int const *>(A.handle2().ram_handle().get());
+    NumericT     const * A_elements   = reinterpret_cast<NumericT     const *>(A.handle().ram_handle().get());
+
+    nonzeros_ = (rows_ > 0) ? A_row_buffer[rows_] : 0;
+
+    viennacl::backend::memory_create(row_buffer_, sizeof(unsigned int) * (rows_ + 1),                   host_ctx, A_row_buffer);
+    viennacl::backend::memory_create(col_buffer_, sizeof(unsigned int) * std::max<vcl_size_t>(nonzeros_, 1), host_ctx, (nonzeros_ > 0) ? A_col_buffer : NULL);
+    viennacl::backend::memory_create(elements_,   sizeof(StorageT) * std::max<vcl_size_t>(nonzeros_, 1),     host_ctx);
+
+    StorageT * elements = reinterpret_cast<StorageT *>(elements_.ram_handle().get());
+#ifdef VIENNACL_WITH_OPENMP
+    #pragma omp parallel for
+#endif
+    for (long i = 0; i < static_cast<long>(nonzeros_); ++i)
+      elements[i] = static_cast<StorageT>(A_elements[i]);
+  }
+
+  /** @brief  Returns the number of rows */
+  const vcl_size_t & size1() const { return rows_; }
+  /** @brief  Returns the number of columns */
+  const vcl_size_t & size2() const { return cols_; }
+  /** @brief  Returns the number of nonzero entries */
+  const vcl_size_t & nnz() const { return nonzeros_; }
+
+  /** @brief  Returns the handle to the row index array */
+  const handle_type & handle1() const { return row_buffer_; }
+  /** @brief  Returns the handle to the column index array */
+  const handle_type & handle2() const { return col_buffer_; }
+  /** @brief  Returns the handle to the matrix entry array (of type StorageT) */
+  const handle_type & handle() const { return elements_; }
+
+  /** @brief  Returns the handle to the row index array */
+  handle_type & handle1() { return row_buffer_; }
+  /** @brief  Returns the handle to the column index array */
+  handle_type & handle2() { return col_buffer_; }
+  /** @brief  Returns the handle to the matrix entry array (of type StorageT) */
+  handle_type & handle() { return elements_; }
+
+  /** @brief Returns the current memory context. Always MAIN_MEMORY once the matrix is initialized. */
+  viennacl::memory_types memory_context() const
+  {
+    return row_buffer_.get_active_handle_id();
+  }
+
+private:
+  vcl_size_t rows_;
+  vcl_size_t cols_;
+  vcl_size_t nonzeros_;
+  handle_type row_buffer_;
+  handle_type col_buffer_;
+  handle_type elements_;
+};
+
+
+//
+// Specify available operations:
+//
+
+/** \cond */
+
+namespace linalg
+{
+namespace detail
+{
+  // x = A * y
+  template<typename T, typename S>
+  struct op_executor<vector_base<T>, op_assign, vector_expression<const mixed_compressed_matrix<T, S>, const vector_base<T>, op_prod> >
+  {
+    static void apply(vector_base<T> & lhs, vector_expression<const mixed_compressed_matrix<T, S>, const vector_base<T>, op_prod> const & rhs)
+    {
+      // check for the special case x = A * x
+      if (viennacl::traits::handle(lhs) == viennacl::traits::handle(rhs.rhs()))
+      {
+        viennacl::vector<T> temp(lhs);
+        viennacl::linalg::prod_impl(rhs.lhs(), rhs.rhs(), T(1), temp, T(0));
+        lhs = temp;
+      }
+      else
+        viennacl::linalg::prod_impl(rhs.lhs(), rhs.rhs(), T(1), lhs, T(0));
+    }
+  };
+
+  template<typename T, typename S>
+  struct op_executor<vector_base<T>, op_inplace_add, vector_expression<const mixed_compressed_matrix<T, S>, const vector_base<T>, op_prod> >
+  {
+    static void apply(vector_base<T> & lhs, vector_expression<const mixed_compressed_matrix<T, S>, const vector_base<T>, op_prod> const & rhs)
+    {
+      // check for the special case x += A * x
+      if (viennacl::traits::handle(lhs) == viennacl::traits::handle(rhs.rhs()))
+      {
+        viennacl::vector<T> temp(lhs);
+        viennacl::linalg::prod_impl(rhs.lhs(), rhs.rhs(), T(1), temp, T(0));
+        lhs += temp;
+      }
+      else
+        viennacl::linalg::prod_impl(rhs.lhs(), rhs.rhs(), T(1), lhs, T(1));
+    }
+  };
+
+  template<typename T, typename S>
+  struct op_executor<vector_base<T>, op_inplace_sub, vector_expression<const mixed_compressed_matrix<T, S>, const vector_base<T>, op_prod> >
+  {
+    static void apply(vector_base<T> & lhs, vector_expression<const mixed_compressed_matrix<T, S>, const vector_base<T>, op_prod> const & rhs)
+    {
+      // check for the special case x -= A * x
+      if (viennacl::traits::handle(lhs) == viennacl::traits::handle(rhs.rhs()))
+      {
+        viennacl::vector<T> temp(lhs);
+        viennacl::linalg::prod_impl(rhs.lhs(), rhs.rhs(), T(1), temp, T(0));
+        lhs -= temp;
+      }
+      else
+        viennacl::linalg::prod_impl(rhs.lhs(), rhs.rhs(), T(-1), lhs, T(1));
+    }
+  };
+
+
+  // x = A * vec_op
+  template<typename T, typename S, typename LHS, typename RHS, typename OP>
+  struct op_executor<vector_base<T>, op_assign, vector_expression<const mixed_compressed_matrix<T, S>, const vector_expression<const LHS, const RHS, OP>, op_prod> >
+  {
+    static void apply(vector_base<T> & lhs, vector_expression<const mixed_compressed_matrix<T, S>, const vector_expression<const LHS, const RHS, OP>, op_prod> const & rhs)
+    {
+      viennacl::vector<T> temp(rhs.rhs());
+      viennacl::linalg::prod_impl(rhs.lhs(), temp, T(1), lhs, T(0));
+    }
+  };
+
+  // x += A * vec_op
+  template<typename T, typename S, typename LHS, typename RHS, typename OP>
+  struct op_executor<vector_base<T>, op_inplace_add, vector_expression<const mixed_compressed_matrix<T, S>, const vector_expression<const LHS, const RHS, OP>, op_prod> >
+  {
+    static void apply(vector_base<T> & lhs, vector_expression<const mixed_compressed_matrix<T, S>, const vector_expression<const LHS, const RHS, OP>, op_prod> const & rhs)
+    {
+      viennacl::vector<T> temp(rhs.rhs());
+      viennacl::linalg::prod_impl(rhs.lhs(), temp, T(1), lhs, T(1));
+    }
+  };
+
+  // x -= A * vec_op
+  template<typename T, typename S, typename LHS, typename RHS, typename OP>
+  struct op_executor<vector_base<T>, op_inplace_sub, vector_expression<const mixed_compressed_matrix<T, S>, const vector_expression<const LHS, const RHS, OP>, op_prod> >
+  {
+    static void apply(vector_base<T> & lhs, vector_expression<const mixed_compressed_matrix<T, S>, const vector_expression<const LHS, const RHS, OP>, op_prod> const & rhs)
+    {
+      viennacl::vector<T> temp(rhs.rhs());
+      viennacl::linalg::prod_impl(rhs.lhs(), temp, T(-1), lhs, T(1));
+    }
+  };
+
+} // namespace detail
+} // namespace linalg
+
+/** \endcond */
+}
+
+#endif
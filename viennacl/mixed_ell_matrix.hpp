@@ -0,0 +1,255 @@
+#ifndef VIENNACL_MIXED_ELL_MATRIX_HPP_
+#define VIENNACL_MIXED_ELL_MATRIX_HPP_
+
+/* =========================================================================
+   Copyright (c) 2010-2016, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+   Portions of this software are copyright by UChicago Argonne, LLC.
+
+                            -----------------
+                  ViennaCL - The Vienna Computing Library
+                            -----------------
+
+   Project Head:    Karl Rupp                   rupp@iue.tuwien.ac.at
+
+   (A list of authors and contributors can be found in the manual)
+
+   License:         MIT (X11), see file LICENSE in the base directory
+============================================================================= */
+
+/** @file viennacl/mixed_ell_matrix.hpp
+    @brief Implementation of the mixed_ell_matrix class (ELL format with values stored in reduced precision, host memory only)
+*/
+
+#include "viennacl/forwards.h"
+#include "viennacl/vector.hpp"
+#include "viennacl/ell_matrix.hpp"
+
+#include "viennacl/linalg/sparse_matrix_operations.hpp"
+
+#include "viennacl/tools/tools.hpp"
+
+#ifdef VIENNACL_WITH_OPENMP
+#include <omp.h>
+#endif
+
+namespace viennacl
+{
+
+/** @brief A sparse matrix in ELLPACK format with nonzero values stored in a type different from the type used for computations.
+*
+* The memory layout of the column indices and the values is the same as for ell_matrix, only the values are stored as StorageT.
+* All products are accumulated in NumericT. See mixed_compressed_matrix for the CSR counterpart.
+*
+* The format is available for host memory (MAIN_MEMORY) only.
+*
+* @tparam NumericT    Floating point type used for computations (and for the vectors the matrix is applied to)
+* @tparam StorageT    Floating point type used for storing the nonzero values
+*/
+template<class NumericT, class StorageT /* see forwards.h for default argument */>
+class mixed_ell_matrix
+{
+public:
+  typedef viennacl::backend::mem_handle                                                              handle_type;
+  typedef scalar<typename viennacl::tools::CHECK_SCALAR_TEMPLATE_ARGUMENT<NumericT>::ResultType>   value_type;
+  typedef StorageT                                                                                   storage_type;
+  typedef vcl_size_t                                                                                 size_type;
+
+  /** @brief Default construction of a mixed-precision ELL matrix. No memory is allocated */
+  mixed_ell_matrix() : rows_(0), cols_(0), maxnnz_(0), internal_size1_(0), internal_maxnnz_(0) {}
+
+  /** @brief Converts an ell_matrix to reduced-precision storage. If the ell_matrix is not located in host memory, its entries are read back to the host. */
+  template<unsigned int AlignmentV>
+  explicit mixed_ell_matrix(ell_matrix<NumericT, AlignmentV> const & A) : rows_(0), cols_(0), maxnnz_(0), internal_size1_(0), internal_maxnnz_(0)
+  {
+    assign(A);
+  }
+
+  /** @brief Converts an ell_matrix to reduced-precision storage. */
+  template<unsigned int AlignmentV>
+  mixed_ell_matrix & operator=(ell_matrix<NumericT, AlignmentV> const & A)
+  {
+    assign(A);
+    return *this;
+  }
+
+  /** @brief Converts an ell_matrix to reduced-precision storage. The padded layout of the ell_matrix is taken over unchanged. */
+  template<unsigned int AlignmentV>
+  void assign(ell_matrix<NumericT, AlignmentV> const & A)
+  {
+    viennacl::context host_ctx(viennacl::MAIN_MEMORY);
+    coords_.switch_active_handle_id(viennacl::MAIN_MEMORY);
+    elements_.switch_active_handle_id(viennacl::MAIN_MEMORY);
+
+    rows_            = A.size1();
+    cols_            = A.size2();
+    maxnnz_          = A.maxnnz();
+    internal_size1_  = A.internal_size1();
+    internal_maxnnz_ = A.internal_maxnnz();
+
+    vcl_size_t internal_nnz = internal_size1_ * internal_maxnnz_;
+    if (internal_nnz == 0)
+      return;
+
+    // ell_matrix may use a different index type on OpenCL devices, hence read through a typesafe host array:
+    viennacl::backend::typesafe_host_array<unsigned int> A_coords(A.handle2(), internal_nnz);
+    std::vector<NumericT> A_elements(internal_nnz);
+    viennacl::backend::memory_read(A.handle2(), 0, A_coords.raw_size(),                  A_coords.get());
+    viennacl::backend::memory_read(A.handle(),  0, sizeof(NumericT) * internal_nnz,      &(A_elements[0]));
+
+    std::vector<unsigned int> coords(internal_nnz);
+    std::vector<StorageT>     elements(internal_nnz);
+#ifdef VIENNACL_WITH_OPENMP
+    #pragma omp parallel for
+#endif
+    for (long i = 0; i < static_cast<long>(internal_nnz); ++i)
+    {
+      coords[vcl_size_t(i)]   = static_cast<unsigned int>(A_coords[vcl_size_t(i)]);
+      elements[vcl_size_t(i)] = static_cast<StorageT>(A_elements[vcl_size_t(i)]);
+    }
+
+    viennacl::backend::memory_create(coords_,   sizeof(unsigned int) * internal_nnz, host_ctx, &(coords[0]));
+    viennacl::backend::memory_create(elements_, sizeof(StorageT) * internal_nnz,     host_ctx, &(elements[0]));
+  }
+
+  vcl_size_t internal_size1() const { return internal_size1_; }
+
+  vcl_size_t size1() const { return rows_; }
+  vcl_size_t size2() const { return cols_; }
+
+  vcl_size_t internal_maxnnz() const { return internal_maxnnz_; }
+  vcl_size_t maxnnz() const { return maxnnz_; }
+
+  vcl_size_t nnz() const { return rows_ * maxnnz_; }
+  vcl_size_t internal_nnz() const { return internal_size1_ * internal_maxnnz_; }
+
+  /** @brief  Returns the handle to the matrix entry array (of type StorageT) */
+  handle_type & handle()       { return elements_; }
+  const handle_type & handle() const { return elements_; }
+
+  /** @brief  Returns the handle to the column index array */
+  handle_type & handle2()       { return coords_; }
+  const handle_type & handle2() const { return coords_; }
+
+  /** @brief Returns the current memory context. Always MAIN_MEMORY once the matrix is initialized. */
+  viennacl::memory_types memory_context() const
+  {
+    return coords_.get_active_handle_id();
+  }
+
+private:
+  vcl_size_t rows_;
+  vcl_size_t cols_;
+  vcl_size_t maxnnz_;
+  vcl_size_t internal_size1_;
+  vcl_size_t internal_maxnnz_;
+
+  handle_type coords_;
+  handle_type elements_;
+};
+
+
+//
+// Specify available operations:
+//
+
+/** \cond */
+
+namespace linalg
+{
+namespace detail
+{
+  // x = A * y
+  template<typename T, typename S>
+  struct op_executor<vector_base<T>, op_assign, vector_expression<const mixed_ell_matrix<T, S>, const vector_base<T>, op_prod> >
+  {
+    static void apply(vector_base<T> & lhs, vector_expression<const mixed_ell_matrix<T, S>, const vector_base<T>, op_prod> const & rhs)
+    {
+      // check for the special case x = A * x
+      if (viennacl::traits::handle(lhs) == viennacl::traits::handle(rhs.rhs()))
+      {
+        viennacl::vector<T> temp(lhs);
+        viennacl::linalg::prod_impl(rhs.lhs(), rhs.rhs(), T(1), temp, T(0));
+        lhs = temp;
+      }
+      else
+        viennacl::linalg::prod_impl(rhs.lhs(), rhs.rhs(), T(1), lhs, T(0));
+    }
+  };
+
+  template<typename T, typename S>
+  struct op_executor<vector_base<T>, op_inplace_add, vector_expression<const mixed_ell_matrix<T, S>, const vector_base<T>, op_prod> >
+  {
+    static void apply(vector_base<T> & lhs, vector_expression<const mixed_ell_matrix<T, S>, const vector_base<T>, op_prod> const & rhs)
+    {
+      // check for the special case x += A * x
+      if (viennacl::traits::handle(lhs) == viennacl::traits::handle(rhs.rhs()))
+      {
+        viennacl::vector<T> temp(lhs);
+        viennacl::linalg::prod_impl(rhs.lhs(), rhs.rhs(), T(1), temp, T(0));
+        lhs += temp;
+      }
+      else
+        viennacl::linalg::prod_impl(rhs.lhs(), rhs.rhs(), T(1), lhs, T(1));
+    }
+  };
+
+  template<typename T, typename S>
+  struct op_executor<vector_base<T>, op_inplace_sub, vector_expression<const mixed_ell_matrix<T, S>, const vector_base<T>, op_prod> >
+  {
+    static void apply(vector_base<T> & lhs, vector_expression<const mixed_ell_matrix<T, S>, const vector_base<T>, op_prod> const & rhs)
+    {
+      // check for the special case x -= A * x
+      if (viennacl::traits::handle(lhs) == viennacl::traits::handle(rhs.rhs()))
+      {
+        viennacl::vector<T> temp(lhs);
+        viennacl::linalg::prod_impl(rhs.lhs(), rhs.rhs(), T(1), temp, T(0));
+        lhs -= temp;
+      }
+      else
+        viennacl::linalg::prod_impl(rhs.lhs(), rhs.rhs(), T(-1), lhs, T(1));
+    }
+  };
+
+
+  // x = A * vec_op
+  template<typename T, typename S, typename LHS, typename RHS, typename OP>
+  struct op_executor<vector_base<T>, op_assign, vector_expression<const mixed_ell_matrix<T, S>, const vector_expression<const LHS, const RHS, OP>, op_prod> >
+  {
+    static void apply(vector_base<T> & lhs, vector_expression<const mixed_ell_matrix<T, S>, const vector_expression<const LHS, const RHS, OP>, op_prod> const & rhs)
+    {
+      viennacl::vector<T> temp(rhs.rhs());
+      viennacl::linalg::prod_impl(rhs.lhs(), temp, T(1), lhs, T(0));
+    }
+  };
+
+  // x += A * vec_op
+  template<typename T, typename S, typename LHS, typename RHS, typename OP>
+  struct op_executor<vector_base<T>, op_inplace_add, vector_expression<const mixed_ell_matrix<T, S>, const vector_expression<const LHS, const RHS, OP>, op_prod> >
+  {
+    static void apply(vector_base<T> & lhs, vector_expression<const mixed_ell_matrix<T, S>, const vector_expression<const LHS, const RHS, OP>, op_prod> const & rhs)
+    {
+      viennacl::vector<T> temp(rhs.rhs());
+      viennacl::linalg::prod_impl(rhs.lhs(), temp, T(1), lhs, T(1));
+    }
+  };
+
+  // x -= A * vec_op
+  template<typename T, typename S, typename LHS, typename RHS, typename OP>
+  struct op_executor<vector_base<T>, op_inplace_sub, vector_expression<const mixed_ell_matrix<T, S>, const vector_expression<const LHS, const RHS, OP>, op_prod> >
+  {
+    static void apply(vector_base<T> & lhs, vector_expression<const mixed_ell_matrix<T, S>, const vector_expression<const LHS, const RHS, OP>, op_prod> const & rhs)
+    {
+      viennacl::vector<T> temp(rhs.rhs());
+      viennacl::linalg::prod_impl(rhs.lhs(), temp, T(-1), lhs, T(1));
+    }
+  };
+
+} // namespace detail
+} // namespace linalg
+
+/** \endcond */
+}
+
+#endif
@@ -0,0 +1,581 @@
+#ifndef VIENNACL_SPARSE_OPERATOR_HPP_
+#define VIENNACL_SPARSE_OPERATOR_HPP_
+
+/* =========================================================================
+   Copyright (c) 2010-2016, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+   Portions of this software are copyright by UChicago Argonne, LLC.
+
+                            -----------------
+                  ViennaCL - The Vienna Computing Library
+                            -----------------
+
+   Project Head:    Karl Rupp                   rupp@iue.tuwien.ac.at
+
+   (A list of authors and contributors can be found in the manual)
+
+   License:         MIT (X11), see file LICENSE in the base directory
+============================================================================= */
+
+/** @file viennacl/sparse_operator.hpp
+    @brief Implementation of the sparse_operator class, a type-erased sparse matrix with automatic selection of the storage format from the matrix structure.
+*/
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+#include "viennacl/forwards.h"
+#include "viennacl/vector.hpp"
+#include "viennacl/compressed_matrix.hpp"
+#include "viennacl/coordinate_matrix.hpp"
+#include "viennacl/ell_matrix.hpp"
+#include "viennacl/sliced_ell_matrix.hpp"
+#include "viennacl/hyb_matrix.hpp"
+
+#include "viennacl/linalg/sparse_matrix_operations.hpp"
+
+#include "viennacl/tools/adapter.hpp"
+#include "viennacl/tools/shared_ptr.hpp"
+#include "viennacl/tools/timer.hpp"
+
+namespace viennacl
+{
+
+/** @brief Storage formats available for sparse_operator */
+enum sparse_format
+{
+  SPARSE_FORMAT_CSR = 0,     // compressed_matrix
+  SPARSE_FORMAT_COO,         // coordinate_matrix
+  SPARSE_FORMAT_ELL,         // ell_matrix
+  SPARSE_FORMAT_SLICED_ELL,  // sliced_ell_matrix
+  SPARSE_FORMAT_HYB          // hyb_matrix
+};
+
+namespace tools
+{
+
+/** @brief Structure statistics of a sparse matrix which determine the performance of the sparse matrix-vector product in the different storage formats. */
+struct sparse_matrix_statistics
+{
+  sparse_matrix_statistics() : size1(0), size2(0), nnz(0), empty_rows(0), min_row_length(0), max_row_length(0), mean_row_length(0), row_length_stddev(0),
+                               bandwidth(0), ell_padding_ratio(1), sliced_ell_padding_ratio(1), hyb_ell_width(0), hyb_padding_ratio(1) {}
+
+  vcl_size_t size1;
+  vcl_size_t size2;
+  vcl_size_t nnz;
+
+  vcl_size_t empty_rows;
+  vcl_size_t min_row_length;
+  vcl_size_t max_row_length;
+  double     mean_row_length;
+  double     row_length_stddev;
+
+  /** @brief Number of rows in each row length class: Entry 0 holds the number of empty rows, entry k > 0 the number of rows with length in [2^(k-1), 2^k) */
+  std::vector<vcl_size_t> row_length_histogram;
+
+  /** @brief Largest distance |i - j| of a nonzero (i,j) from the diagonal */
+  vcl_size_t bandwidth;
+
+  /** @brief Stored entries (including padding) per nonzero for the ELL format */
+  double ell_padding_ratio;
+  /** @brief Stored entries (including padding) per nonzero for the sliced ELL format */
+  double sliced_ell_padding_ratio;
+  /** @brief Width of the ELL part of the HYB format (same rule as used by hyb_matrix) */
+  vcl_size_t hyb_ell_width;
+  /** @brief Stored entries (including padding) per nonzero for the HYB format */
+  double hyb_padding_ratio;
+};
+
+namespace detail
+{
+  /** @brief Computes the structure statistics from CSR arrays in host memory. */
+  inline sparse_matrix_statistics compute_sparse_matrix_statistics(unsigned int const * row_buffer, unsigned int const * col_buffer,
+                                                                   vcl_size_t size1, vcl_size_t size2, vcl_size_t slice_size, double hyb_threshold)
+  {
+    sparse_matrix_statistics stats;
+    stats.size1 = size1;
+    stats.size2 = size2;
+    stats.nnz   = (size1 > 0) ? row_buffer[size1] : 0;
+    if (size1 == 0)
+      return stats;
+
+    stats.min_row_length = row_buffer[1] - row_buffer[0];
+    double sum_squares = 0;
+    std::vector<vcl_size_t> row_length_counts;
+    vcl_size_t sliced_ell_entries = 0;
+    for (vcl_size_t i = 0; i < size1; ++i)
+    {
+      vcl_size_t row_length = row_buffer[i+1] - row_buffer[i];
+
+      stats.min_row_length = std::min(stats.min_row_length, row_length);
+      stats.max_row_length = std::max(stats.max_row_length, row_length);
+      sum_squares += double(row_length) * double(row_length);
+
+      vcl_size_t histogram_bin = 0;
+      while ((vcl_size_t(1) << histogram_bin) <= row_length)
+        ++histogram_bin;
+      if (stats.row_length_histogram.size() <= histogram_bin)
+        stats.row_length_histogram.resize(histogram_bin + 1);
+      stats.row_length_histogram[histogram_bin] += 1;
+
+      if (row_length_counts.size() <= row_length)
+        row_length_counts.resize(row_length + 1);
+      row_length_counts[row_length] += 1;
+
+      if (row_length == 0)
+        ++stats.empty_rows;
+
+      for (unsigned int j = row_buffer[i]; j < row_buffer[i+1]; ++j)
+        stats.bandwidth = std::max(stats.bandwidth, (col_buffer[j] > i) ? col_buffer[j] - i : i - col_buffer[j]);
+
+      // sliced ELL: each slice is padded to its longest row
+      if (i % slice_size == 0)
+      {
+        vcl_size_t slice_max = 0;
+        for (vcl_size_t k = i; k < std::min(i + slice_size, size1); ++k)
+          slice_max = std::max<vcl_size_t>(slice_max, row_buffer[k+1] - row_buffer[k]);
+        sliced_ell_entries += slice_max * slice_size;
+      }
+    }
+
+    stats.mean_row_length   = double(stats.nnz) / double(size1);
+    stats.row_length_stddev = std::sqrt(std::max(0.0, sum_squares / double(size1) - stats.mean_row_length * stats.mean_row_length));
+
+    // HYB: ELL width is the smallest row length covering the requested fraction of rows, remaining entries go to the CSR part
+    vcl_size_t rows_covered = 0;
+    for (vcl_size_t k = 0; k < row_length_counts.size(); ++k)
+    {
+      rows_covered += row_length_counts[k];
+      if (double(rows_covered) >= hyb_threshold * double(size1))
+      {
+        stats.hyb_ell_width = k;
+        break;
+      }
+    }
+    vcl_size_t hyb_entries = size1 * stats.hyb_ell_width;
+    for (vcl_size_t k = stats.hyb_ell_width + 1; k < row_length_counts.size(); ++k)
+      hyb_entries += row_length_counts[k] * (k - stats.hyb_ell_width);
+
+    if (stats.nnz > 0)
+    {
+      stats.ell_padding_ratio        = double(size1 * stats.max_row_length) / double(stats.nnz);
+      stats.sliced_ell_padding_ratio = double(sliced_ell_entries) / double(stats.nnz);
+      stats.hyb_padding_ratio        = double(hyb_entries) / double(stats.nnz);
+    }
+
+    return stats;
+  }
+
+  /** @brief Reads the CSR arrays of A to the host. The column indices (and the values, if requested) hold at least one entry, so that their first element can be addressed. */
+  template<typename NumericT, unsigned int AlignmentV>
+  void read_csr_arrays(viennacl::compressed_matrix<NumericT, AlignmentV> const & A,
+                       std::vector<unsigned int> & row_buffer, std::vector<unsigned int> & col_buffer, std::vector<NumericT> * elements)
+  {
+    vcl_size_t nnz = 0;
+    row_buffer.resize(A.size1() + 1);
+    if (A.size1() > 0)
+    {
+      viennacl::backend::typesafe_host_array<unsigned int> host_row_buffer(A.handle1(), A.size1() + 1);
+      viennacl::backend::memory_read(A.handle1(), 0, host_row_buffer.raw_size(), host_row_buffer.get());
+      for (vcl_size_t i = 0; i <= A.size1(); ++i)
+        row_buffer[i] = host_row_buffer[i];
+      nnz = row_buffer[A.size1()];
+    }
+
+    col_buffer.resize(std::max<vcl_size_t>(nnz, 1));
+    if (elements)
+      elements->resize(std::max<vcl_size_t>(nnz, 1));
+    if (nnz > 0)
+    {
+      viennacl::backend::typesafe_host_array<unsigned int> host_col_buffer(A.handle2(), nnz);
+      viennacl::backend::memory_read(A.handle2(), 0, host_col_buffer.raw_size(), host_col_buffer.get());
+      for (vcl_size_t i = 0; i < nnz; ++i)
+        col_buffer[i] = host_col_buffer[i];
+      if (elements)
+        viennacl::backend::memory_read(A.handle(), 0, sizeof(NumericT) * nnz, &((*elements)[0]));
+    }
+  }
+}
+
+/** @brief Computes row length distribution, bandwidth, and padding ratios of the ELL-type formats for a sparse matrix.
+*
+* @param A            The sparse matrix
+* @param slice_size   Rows per slice assumed for the sliced ELL format
+*/
+template<typename NumericT, unsigned int AlignmentV>
+sparse_matrix_statistics compute_sparse_matrix_statistics(viennacl::compressed_matrix<NumericT, AlignmentV> const & A, vcl_size_t slice_size = 32)
+{
+  if (A.size1() == 0)
+    return sparse_matrix_statistics();
+
+  std::vector<unsigned int> row_buffer;
+  std::vector<unsigned int> col_buffer;
+  detail::read_csr_arrays(A, row_buffer, col_buffer, static_cast<std::vector<NumericT> *>(NULL));
+
+  return detail::compute_sparse_matrix_statistics(&(row_buffer[0]), &(col_buffer[0]), A.size1(), A.size2(), slice_size, 0.8);
+}
+
+/** @brief Predicts the storage format with the fastest sparse matrix-vector product on the host from the structure statistics.
+*
+* CSR is the robust default for the host-based kernels. The ELL formats are only preferred if their padding is small,
+* in which case their regular memory access pattern pays off. COO is never predicted, since its host kernel is not parallelized.
+*
+* The padding tolerated depends on the bandwidth: If the entries of x accessed by neighboring rows fit into the cache, the product is bound by streaming
+* the matrix entries, so each padded entry costs as much as a nonzero. With a large bandwidth, the gathers from x dominate, while the padded entries
+* only reference cached entries of x, hence more padding is tolerated.
+* HYB is predicted for matrices with a few long rows, for which it stores the regular part in ELL format and the excess entries of the long rows in CSR format.
+*
+* @param stats          The structure statistics, see compute_sparse_matrix_statistics()
+* @param cached_window  Number of entries of x assumed to stay in cache for a banded matrix
+*/
+inline viennacl::sparse_format predict_sparse_format(sparse_matrix_statistics const & stats, vcl_size_t cached_window = 16384)
+{
+  if (stats.nnz == 0)
+    return viennacl::SPARSE_FORMAT_CSR;
+
+  double padding_tolerance = (2 * stats.bandwidth + 1 <= cached_window) ? 1.1 : 1.25;
+
+  if (stats.ell_padding_ratio <= padding_tolerance)
+    return viennacl::SPARSE_FORMAT_ELL;
+
+  if (stats.sliced_ell_padding_ratio <= padding_tolerance + 0.1 && stats.mean_row_length >= 8)
+    return viennacl::SPARSE_FORMAT_SLICED_ELL;
+
+  if (stats.hyb_ell_width > 0 && stats.max_row_length > 2 * stats.hyb_ell_width && stats.hyb_padding_ratio <= padding_tolerance)
+    return viennacl::SPARSE_FORMAT_HYB;
+
+  return viennacl::SPARSE_FORMAT_CSR;
+}
+
+} //namespace tools
+
+
+/** @brief A tag for the configuration of the automatic format selection in sparse_operator.
+*/
+class sparse_format_tag
+{
+public:
+  /** @brief The constructor.
+  *
+  * @param use_timed_trial    If true, the candidate formats with moderate padding are set up and timed, otherwise the format is predicted from the structure statistics only
+  * @param trial_iterations   Number of sparse matrix-vector products per candidate format in the timed trial
+  */
+  sparse_format_tag(bool use_timed_trial = false, vcl_size_t trial_iterations = 10) : timed_trial_(use_timed_trial), trial_iterations_(trial_iterations), max_trial_padding_(2.0) {}
+
+  /** @brief Returns true if the formats are timed rather than predicted */
+  bool timed_trial() const { return timed_trial_; }
+  /** @brief Sets whether the formats are timed rather than predicted */
+  void timed_trial(bool b) { timed_trial_ = b; }
+
+  /** @brief Returns the number of sparse matrix-vector products per candidate format in the timed trial */
+  vcl_size_t trial_iterations() const { return trial_iterations_; }
+  /** @brief Sets the number of sparse matrix-vector products per candidate format in the timed trial */
+  void trial_iterations(vcl_size_t num) { trial_iterations_ = num; }
+
+  /** @brief Returns the maximum padding ratio of a format to be considered in the timed trial. ELL-type formats with more padding are skipped without timing, CSR is always timed. */
+  double max_trial_padding() const { return max_trial_padding_; }
+  /** @brief Sets the maximum padding ratio of a format to be considered in the timed trial */
+  void max_trial_padding(double ratio) { max_trial_padding_ = ratio; }
+
+private:
+  bool       timed_trial_;
+  vcl_size_t trial_iterations_;
+  double     max_trial_padding_;
+};
+
+
+/** @brief A sparse matrix in a storage format chosen at runtime, e.g. automatically from the structure of the matrix.
+*
+* The matrix is stored in one of compressed_matrix, coordinate_matrix, ell_matrix, sliced_ell_matrix, or hyb_matrix, and is used through the same interface
+* independent of the format. In particular, it can be passed to the iterative solvers and to viennacl::linalg::prod() for sparse matrix-vector products.
+*
+* @tparam NumericT    Floating point type
+*/
+template<class NumericT>
+class sparse_operator
+{
+  /** @brief Interface for the sparse matrix-vector product y = alpha * A * x + beta * y of the stored matrix */
+  class operator_interface
+  {
+  public:
+    virtual ~operator_interface() {}
+    virtual void apply(viennacl::vector_base<NumericT> const & x, NumericT alpha, viennacl::vector_base<NumericT> & y, NumericT beta) const = 0;
+  };
+
+  /** @brief Stores the matrix in the format given by MatrixT */
+  template<typename MatrixT>
+  class operator_impl : public operator_interface
+  {
+  public:
+    operator_impl(viennacl::tools::const_csr_matrix_adapter<NumericT> const & A, viennacl::context ctx) : matrix_(ctx)
+    {
+      copy(A, matrix_);
+    }
+
+    void apply(viennacl::vector_base<NumericT> const & x, NumericT alpha, viennacl::vector_base<NumericT> & y, NumericT beta) const
+    {
+      viennacl::linalg::prod_impl(matrix_, x, alpha, y, beta);
+    }
+
+  private:
+    MatrixT matrix_;
+  };
+
+public:
+  typedef scalar<typename viennacl::tools::CHECK_SCALAR_TEMPLATE_ARGUMENT<NumericT>::ResultType>   value_type;
+  typedef vcl_size_t                                                                                 size_type;
+
+  /** @brief Default construction. No matrix is stored. */
+  sparse_operator() : format_(viennacl::SPARSE_FORMAT_CSR) {}
+
+  /** @brief Analyzes the structure of A and stores A in the format with the fastest sparse matrix-vector product. The matrix is kept in the memory domain of A.
+  *
+  * @param A     The sparse matrix
+  * @param tag   Configuration of the format selection (prediction from structure statistics or timed trial)
+  */
+  template<unsigned int AlignmentV>
+  explicit sparse_operator(viennacl::compressed_matrix<NumericT, AlignmentV> const & A, sparse_format_tag const & tag = sparse_format_tag()) : format_(viennacl::SPARSE_FORMAT_CSR)
+  {
+    init(A, tag, false, viennacl::SPARSE_FORMAT_CSR);
+  }
+
+  /** @brief Stores A in the given format. The matrix is kept in the memory domain of A.
+  *
+  * @param A        The sparse matrix
+  * @param format   The storage format
+  */
+  template<unsigned int AlignmentV>
+  sparse_operator(viennacl::compressed_matrix<NumericT, AlignmentV> const & A, viennacl::sparse_format format) : format_(format)
+  {
+    init(A, sparse_format_tag(), true, format);
+  }
+
+  /** @brief Returns the number of rows */
+  vcl_size_t size1() const { return stats_.size1; }
+  /** @brief Returns the number of columns */
+  vcl_size_t size2() const { return stats_.size2; }
+  /** @brief Returns the number of nonzero entries */
+  vcl_size_t nnz() const { return stats_.nnz; }
+
+  /** @brief Returns the storage format in use */
+  viennacl::sparse_format format() const { return format_; }
+  /** @brief Returns the structure statistics of the matrix */
+  viennacl::tools::sparse_matrix_statistics const & statistics() const { return stats_; }
+
+  /** @brief Computes y = alpha * A * x + beta * y using the format in use */
+  void apply(viennacl::vector_base<NumericT> const & x, NumericT alpha, viennacl::vector_base<NumericT> & y, NumericT beta) const
+  {
+    assert(impl_.get() != NULL && bool("Error in sparse_operator::apply(): Operator not initialized!"));
+    impl_->apply(x, alpha, y, beta);
+  }
+
+private:
+  template<unsigned int AlignmentV>
+  void init(viennacl::compressed_matrix<NumericT, AlignmentV> const & A, sparse_format_tag const & tag, bool use_given_format, viennacl::sparse_format given_format)
+  {
+    // bring CSR arrays to the host:
+    std::vector<unsigned int> row_buffer;
+    std::vector<unsigned int> col_buffer;
+    std::vector<NumericT>     elements;
+    viennacl::tools::detail::read_csr_arrays(A, row_buffer, col_buffer, &elements);
+    vcl_size_t nnz = row_buffer[A.size1()];
+
+    stats_ = viennacl::tools::detail::compute_sparse_matrix_statistics(&(row_buffer[0]), &(col_buffer[0]), A.size1(), A.size2(), 32, 0.8);
+
+    viennacl::tools::const_csr_matrix_adapter<NumericT> csr_A(&(row_buffer[0]), &(col_buffer[0]), &(elements[0]), A.size1(), A.size2());
+    viennacl::context ctx = viennacl::traits::context(A);
+
+    if (use_given_format)
+      impl_ = create(given_format, csr_A, ctx);
+    else if (!tag.timed_trial() || nnz == 0)
+    {
+      format_ = viennacl::tools::predict_sparse_format(stats_);
+      impl_ = create(format_, csr_A, ctx);
+    }
+    else
+    {
+      viennacl::vector<NumericT> x = viennacl::scalar_vector<NumericT>(A.size2(), NumericT(1), ctx);
+      viennacl::vector<NumericT> y(A.size1(), ctx);
+
+      viennacl::sparse_format candidates[4] = { viennacl::SPARSE_FORMAT_CSR, viennacl::SPARSE_FORMAT_ELL, viennacl::SPARSE_FORMAT_SLICED_ELL, viennacl::SPARSE_FORMAT_HYB };
+      double                  paddings[4]   = { 1.0, stats_.ell_padding_ratio, stats_.sliced_ell_padding_ratio, stats_.hyb_padding_ratio };
+
+      // CSR is always timed, so that a format is selected even if all ELL-type formats exceed the padding limit:
+      double best_time = -1;
+      for (vcl_size_t i = 0; i < 4; ++i)
+      {
+        if (i > 0 && paddings[i] > tag.max_trial_padding())
+          continue;
+
+        viennacl::tools::shared_ptr<operator_interface> candidate = create(candidates[i], csr_A, ctx);
+        candidate->apply(x, NumericT(1), y, NumericT(0)); // warm-up
+        viennacl::backend::finish();
+
+        viennacl::tools::timer timer;
+        timer.start();
+        for (vcl_size_t k = 0; k < tag.trial_iterations(); ++k)
+          candidate->apply(x, NumericT(1), y, NumericT(0));
+        viennacl::backend::finish();
+        double exec_time = timer.get();
+
+        if (best_time < 0 || exec_time < best_time)
+        {
+          best_time = exec_time;
+          format_ = candidates[i];
+          impl_ = candidate;
+        }
+      }
+    }
+  }
+
+  static viennacl::tools::shared_ptr<operator_interface> create(viennacl::sparse_format format, viennacl::tools::const_csr_matrix_adapter<NumericT> const & A, viennacl::context ctx)
+  {
+    switch (format)
+    {
+      case viennacl::SPARSE_FORMAT_COO:
+        return viennacl::tools::shared_ptr<operator_interface>(new operator_impl<viennacl::coordinate_matrix<NumericT> >(A, ctx));
+      case viennacl::SPARSE_FORMAT_ELL:
+        return viennacl::tools::shared_ptr<operator_interface>(new operator_impl<viennacl::ell_matrix<NumericT> >(A, ctx));
+      case viennacl::SPARSE_FORMAT_SLICED_ELL:
+        return viennacl::tools::shared_ptr<operator_interface>(new operator_impl<viennacl::sliced_ell_matrix<NumericT> >(A, ctx));
+      case viennacl::SPARSE_FORMAT_HYB:
+        return viennacl::tools::shared_ptr<operator_interface>(new operator_impl<viennacl::hyb_matrix<NumericT> >(A, ctx));
+      default:
+        return viennacl::tools::shared_ptr<operator_interface>(new operator_impl<viennacl::compressed_matrix<NumericT> >(A, ctx));
+    }
+  }
+
+  viennacl::sparse_format                          format_;
+  viennacl::tools::sparse_matrix_statistics        stats_;
+  viennacl::tools::shared_ptr<operator_interface>  impl_;
+};
+
+
+//
+// Specify available operations:
+//
+
+/** \cond */
+
+namespace linalg
+{
+  /** @brief Carries out matrix-vector multiplication with a sparse_operator using the storage format in use.
+  *
+  * Implementation of the convenience expression result = prod(mat, vec);
+  *
+  * @param mat    The matrix
+  * @param vec    The vector
+  * @param alpha  Scaling factor for the product
+  * @param result The result vector
+  * @param beta   Scaling factor for the previous value of the result vector
+  */
+  template<typename NumericT>
+  void prod_impl(const viennacl::sparse_operator<NumericT> & mat,
+                 const viennacl::vector_base<NumericT> & vec,
+                 NumericT alpha,
+                       viennacl::vector_base<NumericT> & result,
+                 NumericT beta)
+  {
+    assert( (mat.size1() == result.size()) && bool("Size check failed for sparse matrix-vector product: size1(mat) != size(result)"));
+    assert( (mat.size2() == vec.size())    && bool("Size check failed for sparse matrix-vector product: size2(mat) != size(x)"));
+
+    mat.apply(vec, alpha, result, beta);
+  }
+
+namespace detail
+{
+  // x = A * y
+  template<typename T>
+  struct op_executor<vector_base<T>, op_assign, vector_expression<const sparse_operator<T>, const vector_base<T>, op_prod> >
+  {
+    static void apply(vector_base<T> & lhs, vector_expression<const sparse_operator<T>, const vector_base<T>, op_prod> const & rhs)
+    {
+      // check for the special case x = A * x
+      if (viennacl::traits::handle(lhs) == viennacl::traits::handle(rhs.rhs()))
+      {
+        viennacl::vector<T> temp(lhs);
+        viennacl::linalg::prod_impl(rhs.lhs(), rhs.rhs(), T(1), temp, T(0));
+        lhs = temp;
+      }
+      else
+        viennacl::linalg::prod_impl(rhs.lhs(), rhs.rhs(), T(1), lhs, T(0));
+    }
+  };
+
+  template<typename T>
+  struct op_executor<vector_base<T>, op_inplace_add, vector_expression<const sparse_operator<T>, const vector_base<T>, op_prod> >
+  {
+    static void apply(vector_base<T> & lhs, vector_expression<const sparse_operator<T>, const vector_base<T>, op_prod> const & rhs)
+    {
+      // check for the special case x += A * x
+      if (viennacl::traits::handle(lhs) == viennacl::traits::handle(rhs.rhs()))
+      {
+        viennacl::vector<T> temp(lhs);
+        viennacl::linalg::prod_impl(rhs.lhs(), rhs.rhs(), T(1), temp, T(0));
+        lhs += temp;
+      }
+      else
+        viennacl::linalg::prod_impl(rhs.lhs(), rhs.rhs(), T(1), lhs, T(1));
+    }
+  };
+
+  template<typename T>
+  struct op_executor<vector_base<T>, op_inplace_sub, vector_expression<const sparse_operator<T>, const vector_base<T>, op_prod> >
+  {
+    static void apply(vector_base<T> & lhs, vector_expression<const sparse_operator<T>, const vector_base<T>, op_prod> const & rhs)
+    {
+      // check for the special case x -= A * x
+      if (viennacl::traits::handle(lhs) == viennacl::traits::handle(rhs.rhs()))
+      {
+        viennacl::vector<T> temp(lhs);
+        viennacl::linalg::prod_impl(rhs.lhs(), rhs.rhs(), T(1), temp, T(0));
+        lhs -= temp;
+      }
+      else
+        viennacl::linalg::prod_impl(rhs.lhs(), rhs.rhs(), T(-1), lhs, T(1));
+    }
+  };
+
+
+  // x = A * vec_op
+  template<typename T, typename LHS, typename RHS, typename OP>
+  struct op_executor<vector_base<T>, op_assign, vector_expression<const sparse_operator<T>, const vector_expression<const LHS, const RHS, OP>, op_prod> >
+  {
+    static void apply(vector_base<T> & lhs, vector_expression<const sparse_operator<T>, const vector_expression<const LHS, const RHS, OP>, op_prod> const & rhs)
+    {
+      viennacl::vector<T> temp(rhs.rhs());
+      viennacl::linalg::prod_impl(rhs.lhs(), temp, T(1), lhs, T(0));
+    }
+  };
+
+  // x += A * vec_op
+  template<typename T, typename LHS, typename RHS, typename OP>
+  struct op_executor<vector_base<T>, op_inplace_add, vector_expression<const sparse_operator<T>, const vector_expression<const LHS, const RHS, OP>, op_prod> >
+  {
+    static void apply(vector_base<T> & lhs, vector_expression<const sparse_operator<T>, const vector_expression<const LHS, const RHS, OP>, op_prod> const & rhs)
+    {
+      viennacl::vector<T> temp(rhs.rhs());
+      viennacl::linalg::prod_impl(rhs.lhs(), temp, T(1), lhs, T(1));
+    }
+  };
+
+  // x -= A * vec_op
+  template<typename T, typename LHS, typename RHS, typename OP>
+  struct op_executor<vector_base<T>, op_inplace_sub, vector_expression<const sparse_operator<T>, const vector_expression<const LHS, const RHS, OP>, op_prod> >
+  {
+    static void apply(vector_base<T> & lhs, vector_expression<const sparse_operator<T>, const vector_expression<const LHS, const RHS, OP>, op_prod> const & rhs)
+    {
+      viennacl::vector<T> temp(rhs.rhs());
+      viennacl::linalg::prod_impl(rhs.lhs(), temp, T(-1), lhs, T(1));
+    }
+  };
+
+} // namespace detail
+} // namespace linalg
+
+/** \endcond */
+}
+
+#endif
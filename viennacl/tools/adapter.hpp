@@ -19,7 +19,7 @@
 ============================================================================= */
 
 /** @file viennacl/tools/adapter.hpp
-    @brief Adapter classes for sparse matrices made of the STL type std::vector<std::map<SizeT, NumericT> >
+    @brief Adapter classes for sparse matrices made of the STL type std::vector<std::map<SizeT, NumericT> > or of plain CSR arrays
 */
 
 #include <string>
@@ -416,6 +416,97 @@ private:
   size_type size2_;
 };
 
+
+/** @brief A const iterator for sparse matrices given by plain CSR arrays (row array, column array, value array).
+*
+*  @tparam NumericT       either float or double
+*  @tparam is_iterator1   if true, this iterator iterates along increasing row indices, otherwise along the nonzeros of a row
+*/
+template<typename NumericT, bool is_iterator1>
+class const_csr_matrix_adapted_iterator
+{
+  typedef const_csr_matrix_adapted_iterator<NumericT, is_iterator1>    self_type;
+
+public:
+  typedef vcl_size_t   size_type;
+
+  const_csr_matrix_adapted_iterator(unsigned int const * row_buffer, unsigned int const * col_buffer, NumericT const * elements, size_type i, size_type k)
+    : row_buffer_(row_buffer), col_buffer_(col_buffer), elements_(elements), i_(i), k_(k) {}
+
+  NumericT operator*(void) const { return elements_[k_]; }
+
+  self_type & operator++(void)
+  {
+    bool flag_iterator1 = is_iterator1; // avoid unreachable code warnings without specializing template
+    if (flag_iterator1)
+      ++i_;
+    else
+      ++k_;
+    return *this;
+  }
+  self_type operator++(int) { self_type tmp = *this; ++(*this); return tmp; }
+
+  bool operator==(self_type const & other) const
+  {
+    bool flag_iterator1 = is_iterator1; // avoid unreachable code warnings without specializing template
+    return flag_iterator1 ? (i_ == other.i_) : (k_ == other.k_);
+  }
+
+  bool operator!=(self_type const & other) const { return !(*this == other); }
+
+  size_type index1() const { return i_; }
+  size_type index2() const { return col_buffer_[k_]; }
+
+  const_csr_matrix_adapted_iterator<NumericT, !is_iterator1> begin() const
+  {
+    return const_csr_matrix_adapted_iterator<NumericT, !is_iterator1>(row_buffer_, col_buffer_, elements_, i_, row_buffer_[i_]);
+  }
+  const_csr_matrix_adapted_iterator<NumericT, !is_iterator1> end() const
+  {
+    return const_csr_matrix_adapted_iterator<NumericT, !is_iterator1>(row_buffer_, col_buffer_, elements_, i_, row_buffer_[i_+1]);
+  }
+
+private:
+  unsigned int const * row_buffer_;
+  unsigned int const * col_buffer_;
+  NumericT     const * elements_;
+  size_type i_;
+  size_type k_;
+};
+
+/** @brief Adapts plain CSR arrays in host memory to basic ublas-compatibility, so that they can be passed to the viennacl::copy() routines of all sparse matrix types.
+*
+*  The arrays are not copied, hence they need to remain valid during the lifetime of the adapter.
+*
+*  @tparam NumericT   either float or double
+*/
+template<typename NumericT>
+class const_csr_matrix_adapter
+{
+public:
+  typedef const_csr_matrix_adapted_iterator<NumericT, true>      const_iterator1;
+  typedef const_csr_matrix_adapted_iterator<NumericT, false>     const_iterator2;
+
+  typedef NumericT    value_type;
+  typedef vcl_size_t   size_type;
+
+  const_csr_matrix_adapter(unsigned int const * row_buffer, unsigned int const * col_buffer, NumericT const * elements, size_type num_rows, size_type num_cols)
+    : row_buffer_(row_buffer), col_buffer_(col_buffer), elements_(elements), size1_(num_rows), size2_(num_cols) {}
+
+  size_type size1() const { return size1_; }
+  size_type size2() const { return size2_; }
+
+  const_iterator1 begin1() const { return const_iterator1(row_buffer_, col_buffer_, elements_, 0, 0); }
+  const_iterator1 end1() const   { return const_iterator1(row_buffer_, col_buffer_, elements_, size1_, 0); }
+
+private:
+  unsigned int const * row_buffer_;
+  unsigned int const * col_buffer_;
+  NumericT     const * elements_;
+  size_type size1_;
+  size_type size2_;
+};
+
 }
 }
 #endif